@@ -0,0 +1,190 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "route_table.h"
+
+class RouteTableTestSuite : public ::testing::Test {
+public:
+    RouteTableTestSuite() : routes{celix_arrayList_create()} {}
+
+    ~RouteTableTestSuite() override {
+        for (int i = 0; i < celix_arrayList_size(routes); ++i) {
+            httpRoute_release(static_cast<http_route_t*>(celix_arrayList_get(routes, i)));
+        }
+        celix_arrayList_destroy(routes);
+    }
+
+    RouteTableTestSuite(RouteTableTestSuite&&) = delete;
+    RouteTableTestSuite(const RouteTableTestSuite&) = delete;
+    RouteTableTestSuite& operator=(RouteTableTestSuite&&) = delete;
+    RouteTableTestSuite& operator=(const RouteTableTestSuite&) = delete;
+
+    void addRoute(const char *uri) {
+        celix_arrayList_add(routes, httpRoute_create(uri, (void*)uri));
+    }
+
+    static std::string find(const http_route_table_t *table, const char *uri) {
+        http_route_t *route = httpRouteTable_find(table, uri);
+        return route == nullptr ? std::string{"<none>"} : std::string{httpRoute_getUri(route)};
+    }
+
+    celix_array_list_t *routes;
+};
+
+TEST_F(RouteTableTestSuite, EmptyTable) {
+    http_route_table_t *table = httpRouteTable_create(routes);
+    EXPECT_EQ("<none>", find(table, "/"));
+    EXPECT_EQ("<none>", find(table, "/foo"));
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, LongestSegmentPrefixMatch) {
+    addRoute("/foo");
+    addRoute("/foo/bar");
+    addRoute("/foobar");
+    addRoute("/fo");
+    addRoute("/api/v1/users");
+    addRoute("/api/v2");
+    http_route_table_t *table = httpRouteTable_create(routes);
+
+    EXPECT_EQ("/foo", find(table, "/foo"));
+    EXPECT_EQ("/foo", find(table, "/foo/"));
+    EXPECT_EQ("/foo", find(table, "/foo/baz"));
+    EXPECT_EQ("/foo/bar", find(table, "/foo/bar"));
+    EXPECT_EQ("/foo/bar", find(table, "/foo/bar/baz/index.html"));
+    EXPECT_EQ("/foo", find(table, "/foo/barbaz"));
+    EXPECT_EQ("/foobar", find(table, "/foobar"));
+    EXPECT_EQ("/fo", find(table, "/fo/o"));
+    EXPECT_EQ("<none>", find(table, "/foob"));
+    EXPECT_EQ("<none>", find(table, "/f"));
+    EXPECT_EQ("<none>", find(table, "/api"));
+    EXPECT_EQ("<none>", find(table, "/api/v1"));
+    EXPECT_EQ("/api/v1/users", find(table, "/api/v1/users/42"));
+    EXPECT_EQ("/api/v2", find(table, "/api/v2/users/42"));
+    EXPECT_EQ("<none>", find(table, "/api/v3/users"));
+
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, RootRouteMatchesAll) {
+    addRoute("/");
+    addRoute("/foo");
+    http_route_table_t *table = httpRouteTable_create(routes);
+
+    EXPECT_EQ("/", find(table, "/"));
+    EXPECT_EQ("/", find(table, "/bar"));
+    EXPECT_EQ("/", find(table, "/fo"));
+    EXPECT_EQ("/foo", find(table, "/foo/bar"));
+
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, IgnoreEmptySegments) {
+    addRoute("/foo//bar/");
+    http_route_table_t *table = httpRouteTable_create(routes);
+
+    EXPECT_EQ("/foo//bar/", find(table, "/foo/bar"));
+    EXPECT_EQ("/foo//bar/", find(table, "//foo///bar//"));
+    EXPECT_EQ("/foo//bar/", find(table, "foo/bar/baz"));
+    EXPECT_EQ("<none>", find(table, "/foo"));
+
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, FirstRegisteredRouteWins) {
+    addRoute("/foo");
+    addRoute("/foo/"); //same normalized URI
+    http_route_table_t *table = httpRouteTable_create(routes);
+    EXPECT_EQ("/foo", find(table, "/foo"));
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, ManyRoutes) {
+    std::vector<std::string> uris{};
+    for (int i = 0; i < 500; ++i) {
+        uris.emplace_back("/service" + std::to_string(i) + "/endpoint" + std::to_string(i % 7));
+    }
+    for (const auto &uri : uris) {
+        addRoute(uri.c_str());
+    }
+    http_route_table_t *table = httpRouteTable_create(routes);
+    for (const auto &uri : uris) {
+        EXPECT_EQ(uri, find(table, (uri + "/resource").c_str()));
+    }
+    EXPECT_EQ("<none>", find(table, "/service500/endpoint3"));
+    EXPECT_EQ("<none>", find(table, "/service1/endpoint2"));
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, RouteMetrics) {
+    addRoute("/foo");
+    http_route_table_t *table = httpRouteTable_create(routes);
+    http_route_t *route = httpRouteTable_find(table, "/foo");
+    ASSERT_NE(nullptr, route);
+
+    struct timespec start1{};
+    struct timespec start2{};
+    httpRoute_beginRequest(route, &start1);
+    httpRoute_beginRequest(route, &start2);
+    http_route_metrics_t metrics{};
+    httpRoute_getMetrics(route, &metrics);
+    EXPECT_EQ(2u, metrics.nrOfInFlightRequests);
+    EXPECT_EQ(2u, httpRoute_getNrOfInFlightRequests(route));
+    EXPECT_EQ(0u, metrics.nrOfRequests);
+
+    httpRoute_endRequest(route, &start1);
+    EXPECT_EQ(1u, httpRoute_getNrOfInFlightRequests(route));
+    start2.tv_sec -= 2; //simulate a slow request
+    httpRoute_endRequest(route, &start2);
+    httpRoute_getMetrics(route, &metrics);
+    EXPECT_EQ(0u, metrics.nrOfInFlightRequests);
+    EXPECT_EQ(2u, metrics.nrOfRequests);
+    EXPECT_EQ(1u, metrics.latencyBuckets[HTTP_ROUTE_NR_OF_LATENCY_BUCKETS - 1]);
+    EXPECT_GE(metrics.totalLatencyInUs, 2000000u);
+
+    httpRouteTable_destroy(table);
+}
+
+TEST_F(RouteTableTestSuite, WaitForInFlightRequests) {
+    addRoute("/foo");
+    auto* route = static_cast<http_route_t*>(celix_arrayList_get(routes, 0));
+    httpRoute_waitForInFlightRequests(route); //no requests, returns directly
+
+    struct timespec start{};
+    httpRoute_beginRequest(route, &start);
+    std::atomic<bool> done{false};
+    std::thread waiter{[&] {
+        httpRoute_waitForInFlightRequests(route);
+        done = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_FALSE(done);
+
+    httpRoute_endRequest(route, &start);
+    waiter.join();
+    EXPECT_TRUE(done);
+    EXPECT_EQ(0u, httpRoute_getNrOfInFlightRequests(route));
+}
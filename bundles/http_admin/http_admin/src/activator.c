@@ -29,6 +29,7 @@
 
 #include "celix_api.h"
 #include "celix_types.h"
+#include "celix_shell_command.h"
 
 #include "http_admin.h"
 #include "websocket_admin.h"
@@ -48,9 +49,13 @@ typedef struct http_admin_activator {
     bool useWebsockets;
 
     long bundleTrackerId;
+
+    celix_shell_command_t cmdSvc;
+    long cmdSvcId;
 } http_admin_activator_t;
 
 static int http_admin_start(http_admin_activator_t *act, celix_bundle_context_t *ctx) {
+    act->cmdSvcId = -1L;
     celix_bundle_t *bundle = celix_bundleContext_getBundle(ctx);
     char* root = celix_bundle_getEntry(bundle, "root");
 
@@ -107,6 +112,15 @@ static int http_admin_start(http_admin_activator_t *act, celix_bundle_context_t
             opts.onStopped = http_admin_stopBundle;
             act->bundleTrackerId = celix_bundleContext_trackBundlesWithOptions(ctx, &opts);
         }
+        {
+            act->cmdSvc.handle = act->httpManager;
+            act->cmdSvc.executeCommand = http_admin_executeCommand;
+            celix_properties_t *props = celix_properties_create();
+            celix_properties_set(props, CELIX_SHELL_COMMAND_NAME, "celix::http_admin");
+            celix_properties_set(props, CELIX_SHELL_COMMAND_USAGE, "http_admin");
+            celix_properties_set(props, CELIX_SHELL_COMMAND_DESCRIPTION, "Print the HTTP routes with their request metrics");
+            act->cmdSvcId = celix_bundleContext_registerService(ctx, &act->cmdSvc, CELIX_SHELL_COMMAND_SERVICE_NAME, props);
+        }
 
         //Websockets are dependent from the http admin, which starts the server.
         if(act->useWebsockets) {
@@ -128,6 +142,7 @@ static int http_admin_start(http_admin_activator_t *act, celix_bundle_context_t
 }
 
 static int http_admin_stop(http_admin_activator_t *act, celix_bundle_context_t *ctx) {
+    celix_bundleContext_unregisterService(ctx, act->cmdSvcId);
     celix_bundleContext_stopTracker(ctx, act->httpAdminSvcId);
     celix_bundleContext_stopTracker(ctx, act->sockAdminSvcId);
     celix_bundleContext_stopTracker(ctx, act->bundleTrackerId);
@@ -31,12 +31,13 @@
 
 #include "http_admin.h"
 #include "http_admin/api.h"
-#include "service_tree.h"
+#include "route_table.h"
 
 #include "civetweb.h"
 
 #include "celix_api.h"
 #include "celix_utils_api.h"
+#include "celix_epoch.h"
 
 
 struct http_admin_manager {
@@ -49,7 +50,10 @@ struct http_admin_manager {
     celix_http_info_service_t infoSvc;
     long infoSvcId;
     celix_array_list_t *aliasList;      //Array list of http_alias_t
-    service_tree_t http_svc_tree;
+    celix_array_list_t *routes;         //Array list of http_route_t, registration order
+
+    http_route_table_t *routeTable;     //atomic, immutable table used by the request handlers
+    celix_epoch_t routeEpoch;           //reclamation of the route tables loaded by the request handlers
 };
 
 
@@ -65,6 +69,8 @@ static int http_request_handle(struct mg_connection *connection);
 static void httpAdmin_updateInfoSvc(http_admin_manager_t *admin);
 static void createAliasesSymlink(const char *aliases, const char *admin_root, const char *bundle_root, long bundle_id, celix_array_list_t *alias_list);
 static bool aliasList_containsAlias(celix_array_list_t *alias_list, const char *alias);
+static http_route_t* httpAdmin_beginRequest(http_admin_manager_t *admin, const char *uri, struct timespec *startTime);
+static void httpAdmin_publishRouteTable(http_admin_manager_t *admin);
 
 
 http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *root, const char **svr_opts) {
@@ -79,6 +85,9 @@ http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *ro
 
     status = celixThreadMutex_create(&admin->admin_lock, NULL);
     admin->aliasList = celix_arrayList_create();
+    admin->routes = celix_arrayList_create();
+    admin->routeTable = httpRouteTable_create(NULL);
+    celix_epoch_init(&admin->routeEpoch);
 
     if (status == CELIX_SUCCESS) {
         //Use only begin_request callback
@@ -103,6 +112,9 @@ http_admin_manager_t *httpAdmin_create(celix_bundle_context_t *context, char *ro
         celixThreadMutex_destroy(&admin->admin_lock);
 
         celix_arrayList_destroy(admin->aliasList);
+        celix_arrayList_destroy(admin->routes);
+        httpRouteTable_destroy(admin->routeTable);
+        celix_epoch_destroy(&admin->routeEpoch);
         free(admin);
         admin = NULL;
     }
@@ -118,7 +130,11 @@ void httpAdmin_destroy(http_admin_manager_t *admin) {
 
     celix_bundleContext_unregisterService(admin->context, admin->infoSvcId);
 
-    destroyServiceTree(&admin->http_svc_tree);
+    httpRouteTable_destroy(admin->routeTable);
+    for (int i = 0; i < celix_arrayList_size(admin->routes); ++i) {
+        httpRoute_release(celix_arrayList_get(admin->routes, i));
+    }
+    celix_arrayList_destroy(admin->routes);
 
     //Destroy alias map by removing symbolic links first.
     unsigned int size = celix_arrayList_size(admin->aliasList);
@@ -138,6 +154,7 @@ void httpAdmin_destroy(http_admin_manager_t *admin) {
 
     celixThreadMutex_unlock(&(admin->admin_lock));
     celixThreadMutex_destroy(&(admin->admin_lock));
+    celix_epoch_destroy(&admin->routeEpoch);
 
     free(admin->root);
     free(admin);
@@ -155,41 +172,103 @@ void http_admin_addHttpService(void *handle, void *svc, const celix_properties_t
 
     if(uri != NULL) {
         celixThreadMutex_lock(&(admin->admin_lock));
-        if(!addServiceNode(&admin->http_svc_tree, uri, httpSvc)) {
-            printf("HTTP service with URI %s already exists!\n", uri);
+        http_route_t *route = httpRoute_create(uri, httpSvc);
+        for (int i = 0; i < celix_arrayList_size(admin->routes); ++i) {
+            if (httpRoute_hasSameUri(celix_arrayList_get(admin->routes, i), route)) {
+                printf("HTTP service with URI %s already exists!\n", uri);
+                break;
+            }
         }
+        //Note a route with an existing URI is still added, it becomes active when the existing route is removed.
+        celix_arrayList_add(admin->routes, route);
+        httpAdmin_publishRouteTable(admin);
         celixThreadMutex_unlock(&(admin->admin_lock));
     }
 }
 
-void http_admin_removeHttpService(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+void http_admin_removeHttpService(void *handle, void *svc, const celix_properties_t *props) {
     http_admin_manager_t *admin = (http_admin_manager_t *) handle;
 
     const char *uri = celix_properties_get(props, HTTP_ADMIN_URI, NULL);
 
     if(uri != NULL) {
         celixThreadMutex_lock(&(admin->admin_lock));
-        service_tree_node_t *node = NULL;
-
-        node = findServiceNodeInTree(&admin->http_svc_tree, uri);
+        http_route_t *removed = NULL;
+        http_route_t *lookup = httpRoute_create(uri, svc);
+        for (int i = 0; i < celix_arrayList_size(admin->routes); ++i) {
+            http_route_t *route = celix_arrayList_get(admin->routes, i);
+            if (httpRoute_getService(route) == svc && httpRoute_hasSameUri(route, lookup)) {
+                removed = route;
+                celix_arrayList_removeAt(admin->routes, i);
+                break;
+            }
+        }
+        httpRoute_release(lookup);
 
-        if(node != NULL){
-            destroyServiceNode(&admin->http_svc_tree, node, &admin->http_svc_tree.tree_node_count, &admin->http_svc_tree.tree_svc_count);
+        if(removed != NULL){
+            httpAdmin_publishRouteTable(admin);
         } else {
             printf("Couldn't remove HTTP service with URI: %s, it doesn't exist\n", uri);
         }
 
         celixThreadMutex_unlock(&(admin->admin_lock));
+
+        if (removed != NULL) {
+            //The route is not in the published table anymore, so no new requests can begin. Wait till the requests
+            //in flight are done, because the http service can be gone after this call.
+            httpRoute_waitForInFlightRequests(removed);
+            httpRoute_release(removed);
+        }
     }
 }
 
+/**
+ * Looks up and retains the route for the requested URI and marks the start of the request on the route.
+ * The lookup does not lock; the route table is only destroyed after all lookups that could have loaded it are done
+ * (see httpAdmin_publishRouteTable). Because the request is started inside the read section, a removed route has
+ * counted all its requests in flight once the table without the route is published.
+ */
+static http_route_t* httpAdmin_beginRequest(http_admin_manager_t *admin, const char *uri, struct timespec *startTime) {
+    size_t *readers = celix_epoch_enterRead(&admin->routeEpoch);
+    http_route_table_t *table = __atomic_load_n(&admin->routeTable, __ATOMIC_SEQ_CST);
+    http_route_t *route = httpRouteTable_find(table, uri);
+    if (route != NULL) {
+        httpRoute_retain(route);
+        httpRoute_beginRequest(route, startTime);
+    }
+    celix_epoch_exitRead(readers);
+    return route;
+}
+
+/**
+ * Rebuilds the route table from the registered routes, publishes it and destroys the previous table when no
+ * request handler can use it anymore.
+ * Should be called with the admin_lock locked.
+ */
+static void httpAdmin_publishRouteTable(http_admin_manager_t *admin) {
+    http_route_table_t *table = httpRouteTable_create(admin->routes);
+    http_route_table_t *old = __atomic_exchange_n(&admin->routeTable, table, __ATOMIC_SEQ_CST);
+    celix_epoch_synchronize(&admin->routeEpoch);
+    httpRouteTable_destroy(old);
+}
+
+bool http_admin_executeCommand(void *handle, const char *commandLine __attribute__((unused)), FILE *outStream, FILE *errStream __attribute__((unused))) {
+    http_admin_manager_t *admin = handle;
+    celixThreadMutex_lock(&admin->admin_lock);
+    fprintf(outStream, "HTTP Admin routes:\n");
+    httpRouteTable_print(admin->routeTable, outStream);
+    celixThreadMutex_unlock(&admin->admin_lock);
+    return true;
+}
+
 int http_request_handle(struct mg_connection *connection) {
     int ret_status = 400; //Default bad request
 
     if(connection != NULL) {
         const struct mg_request_info *ri = mg_get_request_info(connection);
         http_admin_manager_t *admin = (http_admin_manager_t *) ri->user_data;
-        service_tree_node_t *node = NULL;
+        http_route_t *route = NULL;
+        struct timespec startTime;
 
         if(mg_get_header(connection, "Upgrade") != NULL) {
             //Assume this is a websocket request...
@@ -197,11 +276,11 @@ int http_request_handle(struct mg_connection *connection) {
         }
         else {
             const char *req_uri = ri->request_uri;
-            node = findServiceNodeInTree(&admin->http_svc_tree, req_uri);
+            route = httpAdmin_beginRequest(admin, req_uri, &startTime);
 
-            if(node != NULL) {
-                //Requested URI with node exists, now obtain the http service and call the requested function.
-                celix_http_service_t *httpSvc = (celix_http_service_t *) node->svc_data->service;
+            if(route != NULL) {
+                //Requested URI with route exists, now obtain the http service and call the requested function.
+                celix_http_service_t *httpSvc = (celix_http_service_t *) httpRoute_getService(route);
 
                 if (strcmp("GET", ri->request_method) == 0) {
                     if (httpSvc->doGet != NULL) {
@@ -346,6 +425,8 @@ int http_request_handle(struct mg_connection *connection) {
                     mg_send_http_error(connection, 501, "%s", "Not found");
                     ret_status = 501; //Not implemented...
                 }
+                httpRoute_endRequest(route, &startTime);
+                httpRoute_release(route);
             } else {
                 ret_status = 0; //Not found requested URI, let civetweb handle this situation
             }
@@ -0,0 +1,363 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * route_table.c
+ *
+ * Immutable radix trie used to dispatch HTTP requests. The trie is keyed on the normalized URI (the path segments
+ * joined by a single '/', without leading or trailing slash) and stored in a single node array. The children of a node
+ * are stored next to each other and sorted on the first character of their label, so that a lookup is a walk over
+ * the request URI without tokenizing, locking or allocating.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "celix_threads.h"
+#include "celix_utils.h"
+#include "route_table.h"
+
+struct http_route {
+    char *uri;
+    char *key; //normalized uri
+    void *svc;
+    size_t refCount; //atomic
+
+    bool draining; //atomic, true if a thread waits for the in flight requests
+    celix_thread_mutex_t drainMutex;
+    celix_thread_cond_t drainCond;
+
+    //metrics, atomic
+    uint64_t nrOfRequests;
+    uint64_t nrOfInFlightRequests;
+    uint64_t totalLatencyInUs;
+    uint64_t latencyBuckets[HTTP_ROUTE_NR_OF_LATENCY_BUCKETS];
+};
+
+typedef struct http_route_node {
+    const char *label; //points in the key of a route retained by the table
+    size_t labelLen;
+    size_t firstChild;
+    size_t nrOfChildren;
+    http_route_t *route; //NULL if no route ends at this node
+} http_route_node_t;
+
+struct http_route_table {
+    size_t nrOfRoutes;
+    http_route_t **routes;
+    size_t nrOfNodes;
+    http_route_node_t *nodes; //nodes[0] is the root (empty label)
+};
+
+typedef struct http_route_sort_entry {
+    http_route_t *route;
+    size_t index;
+} http_route_sort_entry_t;
+
+static const uint64_t g_latencyBucketBoundsInUs[] = HTTP_ROUTE_LATENCY_BUCKET_BOUNDS_US;
+
+static char* httpRoute_normalize(const char *uri) {
+    size_t len = strlen(uri);
+    char *key = malloc(len + 1);
+    size_t n = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (uri[i] != '/') {
+            if (i > 0 && uri[i-1] == '/' && n > 0) {
+                key[n++] = '/';
+            }
+            key[n++] = uri[i];
+        }
+    }
+    key[n] = '\0';
+    return key;
+}
+
+http_route_t* httpRoute_create(const char *uri, void *svc) {
+    http_route_t *route = calloc(1, sizeof(*route));
+    route->uri = celix_utils_strdup(uri);
+    route->key = httpRoute_normalize(uri);
+    route->svc = svc;
+    route->refCount = 1;
+    celixThreadMutex_create(&route->drainMutex, NULL);
+    celixThreadCondition_init(&route->drainCond, NULL);
+    return route;
+}
+
+void httpRoute_retain(http_route_t *route) {
+    __atomic_add_fetch(&route->refCount, 1, __ATOMIC_RELAXED);
+}
+
+void httpRoute_release(http_route_t *route) {
+    if (route != NULL && __atomic_sub_fetch(&route->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        celixThreadCondition_destroy(&route->drainCond);
+        celixThreadMutex_destroy(&route->drainMutex);
+        free(route->uri);
+        free(route->key);
+        free(route);
+    }
+}
+
+const char* httpRoute_getUri(const http_route_t *route) {
+    return route->uri;
+}
+
+void* httpRoute_getService(const http_route_t *route) {
+    return route->svc;
+}
+
+bool httpRoute_hasSameUri(const http_route_t *route1, const http_route_t *route2) {
+    return strcmp(route1->key, route2->key) == 0;
+}
+
+void httpRoute_beginRequest(http_route_t *route, struct timespec *startTime) {
+    __atomic_add_fetch(&route->nrOfInFlightRequests, 1, __ATOMIC_SEQ_CST);
+    clock_gettime(CLOCK_MONOTONIC, startTime);
+}
+
+void httpRoute_endRequest(http_route_t *route, const struct timespec *startTime) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double diff = celix_difftime(startTime, &now);
+    uint64_t latencyInUs = diff > 0 ? (uint64_t)(diff * 1000000.0) : 0;
+
+    int bucket = 0;
+    while (bucket < HTTP_ROUTE_NR_OF_LATENCY_BUCKETS - 1 && latencyInUs > g_latencyBucketBoundsInUs[bucket]) {
+        ++bucket;
+    }
+    __atomic_add_fetch(&route->latencyBuckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&route->totalLatencyInUs, latencyInUs, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&route->nrOfRequests, 1, __ATOMIC_RELAXED);
+    uint64_t inFlight = __atomic_sub_fetch(&route->nrOfInFlightRequests, 1, __ATOMIC_SEQ_CST);
+    if (inFlight == 0 && __atomic_load_n(&route->draining, __ATOMIC_SEQ_CST)) {
+        //note only locks if a thread is waiting, so the request path stays lock free
+        celixThreadMutex_lock(&route->drainMutex);
+        celixThreadCondition_broadcast(&route->drainCond);
+        celixThreadMutex_unlock(&route->drainMutex);
+    }
+}
+
+void httpRoute_waitForInFlightRequests(http_route_t *route) {
+    __atomic_store_n(&route->draining, true, __ATOMIC_SEQ_CST);
+    celixThreadMutex_lock(&route->drainMutex);
+    while (__atomic_load_n(&route->nrOfInFlightRequests, __ATOMIC_SEQ_CST) > 0) {
+        celixThreadCondition_wait(&route->drainCond, &route->drainMutex);
+    }
+    celixThreadMutex_unlock(&route->drainMutex);
+}
+
+uint64_t httpRoute_getNrOfInFlightRequests(const http_route_t *route) {
+    return __atomic_load_n(&route->nrOfInFlightRequests, __ATOMIC_ACQUIRE);
+}
+
+void httpRoute_getMetrics(const http_route_t *route, http_route_metrics_t *metrics) {
+    metrics->nrOfRequests = __atomic_load_n(&route->nrOfRequests, __ATOMIC_RELAXED);
+    metrics->nrOfInFlightRequests = __atomic_load_n(&route->nrOfInFlightRequests, __ATOMIC_RELAXED);
+    metrics->totalLatencyInUs = __atomic_load_n(&route->totalLatencyInUs, __ATOMIC_RELAXED);
+    for (int i = 0; i < HTTP_ROUTE_NR_OF_LATENCY_BUCKETS; ++i) {
+        metrics->latencyBuckets[i] = __atomic_load_n(&route->latencyBuckets[i], __ATOMIC_RELAXED);
+    }
+}
+
+static int httpRouteTable_compareEntries(const void *a, const void *b) {
+    const http_route_sort_entry_t *entryA = a;
+    const http_route_sort_entry_t *entryB = b;
+    int cmp = strcmp(entryA->route->key, entryB->route->key);
+    if (cmp == 0) {
+        //keep the registration order for equal keys, the first one wins
+        cmp = entryA->index < entryB->index ? -1 : 1;
+    }
+    return cmp;
+}
+
+/**
+ * Builds the children of nodes[nodeIndex]. All keys in entries[lo, hi) start with the key of the node, which has
+ * length depth.
+ */
+static void httpRouteTable_build(http_route_table_t *table, size_t nodeIndex, const http_route_sort_entry_t *entries, size_t lo, size_t hi, size_t depth) {
+    while (lo < hi && entries[lo].route->key[depth] == '\0') {
+        if (table->nodes[nodeIndex].route == NULL) {
+            table->nodes[nodeIndex].route = entries[lo].route;
+        }
+        ++lo;
+    }
+
+    size_t nrOfGroups = 0;
+    for (size_t i = lo; i < hi; ++i) {
+        if (i == lo || entries[i].route->key[depth] != entries[i-1].route->key[depth]) {
+            ++nrOfGroups;
+        }
+    }
+    size_t childIndex = table->nrOfNodes;
+    table->nodes[nodeIndex].firstChild = childIndex;
+    table->nodes[nodeIndex].nrOfChildren = nrOfGroups;
+    table->nrOfNodes += nrOfGroups;
+
+    size_t groupLo = lo;
+    while (groupLo < hi) {
+        const char *firstKey = entries[groupLo].route->key;
+        size_t groupHi = groupLo + 1;
+        while (groupHi < hi && entries[groupHi].route->key[depth] == firstKey[depth]) {
+            ++groupHi;
+        }
+
+        //sorted keys, so the common prefix of the first and last key is the common prefix of the group
+        const char *lastKey = entries[groupHi - 1].route->key;
+        size_t prefixLen = depth + 1;
+        while (firstKey[prefixLen] != '\0' && firstKey[prefixLen] == lastKey[prefixLen]) {
+            ++prefixLen;
+        }
+
+        http_route_node_t *child = &table->nodes[childIndex];
+        child->label = firstKey + depth;
+        child->labelLen = prefixLen - depth;
+        httpRouteTable_build(table, childIndex, entries, groupLo, groupHi, prefixLen);
+
+        ++childIndex;
+        groupLo = groupHi;
+    }
+}
+
+http_route_table_t* httpRouteTable_create(celix_array_list_t *routes) {
+    http_route_table_t *table = calloc(1, sizeof(*table));
+    size_t size = routes == NULL ? 0 : (size_t)celix_arrayList_size(routes);
+
+    table->nrOfRoutes = size;
+    table->routes = calloc(size == 0 ? 1 : size, sizeof(*table->routes));
+    http_route_sort_entry_t *entries = calloc(size == 0 ? 1 : size, sizeof(*entries));
+    for (size_t i = 0; i < size; ++i) {
+        http_route_t *route = celix_arrayList_get(routes, (int)i);
+        httpRoute_retain(route);
+        table->routes[i] = route;
+        entries[i].route = route;
+        entries[i].index = i;
+    }
+    qsort(entries, size, sizeof(*entries), httpRouteTable_compareEntries);
+
+    //every key adds at most one leaf and one split node
+    table->nodes = calloc(2 * size + 1, sizeof(*table->nodes));
+    table->nodes[0].label = "";
+    table->nrOfNodes = 1;
+    httpRouteTable_build(table, 0, entries, 0, size, 0);
+
+    free(entries);
+    return table;
+}
+
+void httpRouteTable_destroy(http_route_table_t *table) {
+    if (table != NULL) {
+        for (size_t i = 0; i < table->nrOfRoutes; ++i) {
+            httpRoute_release(table->routes[i]);
+        }
+        free(table->routes);
+        free(table->nodes);
+        free(table);
+    }
+}
+
+/**
+ * Returns the next character of the normalized URI, i.e. repeated slashes are read as one slash and a trailing
+ * slash is read as the end of the URI.
+ */
+static inline char httpRouteTable_nextChar(const char **pos) {
+    const char *p = *pos;
+    while (p[0] == '/' && p[1] == '/') {
+        ++p;
+    }
+    char c = (p[0] == '/' && p[1] == '\0') ? '\0' : p[0];
+    *pos = c == '\0' ? p : p + 1;
+    return c;
+}
+
+static inline char httpRouteTable_peekChar(const char *pos) {
+    return httpRouteTable_nextChar(&pos);
+}
+
+static inline const http_route_node_t* httpRouteTable_findChild(const http_route_table_t *table, const http_route_node_t *node, char c) {
+    size_t lo = node->firstChild;
+    size_t hi = node->firstChild + node->nrOfChildren;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        unsigned char first = (unsigned char)table->nodes[mid].label[0];
+        if (first == (unsigned char)c) {
+            return &table->nodes[mid];
+        } else if (first < (unsigned char)c) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+http_route_t* httpRouteTable_find(const http_route_table_t *table, const char *uri) {
+    if (table == NULL || uri == NULL) {
+        return NULL;
+    }
+
+    const char *pos = uri;
+    while (*pos == '/') {
+        ++pos;
+    }
+
+    const http_route_node_t *node = &table->nodes[0];
+    http_route_t *found = node->route;
+    char c = httpRouteTable_nextChar(&pos);
+    while (c != '\0') {
+        node = httpRouteTable_findChild(table, node, c);
+        if (node == NULL) {
+            break;
+        }
+        for (size_t i = 1; i < node->labelLen; ++i) {
+            c = httpRouteTable_nextChar(&pos);
+            if (c != node->label[i]) {
+                return found;
+            }
+        }
+        char next = httpRouteTable_peekChar(pos);
+        if (node->route != NULL && (next == '/' || next == '\0')) {
+            found = node->route;
+        }
+        c = httpRouteTable_nextChar(&pos);
+    }
+    return found;
+}
+
+void httpRouteTable_print(const http_route_table_t *table, FILE *out) {
+    for (size_t i = 0; table != NULL && i < table->nrOfNodes; ++i) {
+        const http_route_t *route = table->nodes[i].route;
+        if (route == NULL) {
+            continue;
+        }
+        http_route_metrics_t metrics;
+        httpRoute_getMetrics(route, &metrics);
+        double avgInMs = metrics.nrOfRequests == 0 ? 0.0 : (double)metrics.totalLatencyInUs / (double)metrics.nrOfRequests / 1000.0;
+        fprintf(out, "|- Route %s\n", route->uri);
+        fprintf(out, "   |- nr of requests           = %lu\n", (unsigned long)metrics.nrOfRequests);
+        fprintf(out, "   |- nr of in flight requests = %lu\n", (unsigned long)metrics.nrOfInFlightRequests);
+        fprintf(out, "   |- avg latency              = %.3f ms\n", avgInMs);
+        fprintf(out, "   |- latency histogram        =");
+        for (int b = 0; b < HTTP_ROUTE_NR_OF_LATENCY_BUCKETS; ++b) {
+            if (b < HTTP_ROUTE_NR_OF_LATENCY_BUCKETS - 1) {
+                fprintf(out, " <=%luus:%lu", (unsigned long)g_latencyBucketBoundsInUs[b], (unsigned long)metrics.latencyBuckets[b]);
+            } else {
+                fprintf(out, " >%luus:%lu", (unsigned long)g_latencyBucketBoundsInUs[b-1], (unsigned long)metrics.latencyBuckets[b]);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,122 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_HTTP_ROUTE_TABLE_H
+#define CELIX_HTTP_ROUTE_TABLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "celix_array_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Upper bounds (in us) of the request latency buckets of a route. The last bucket counts the requests slower
+ * than the last upper bound.
+ */
+#define HTTP_ROUTE_LATENCY_BUCKET_BOUNDS_US     {100, 1000, 10000, 100000, 1000000}
+#define HTTP_ROUTE_NR_OF_LATENCY_BUCKETS        6
+
+typedef struct http_route http_route_t;
+typedef struct http_route_table http_route_table_t;
+
+typedef struct http_route_metrics {
+    uint64_t nrOfRequests;
+    uint64_t nrOfInFlightRequests;
+    uint64_t totalLatencyInUs;
+    uint64_t latencyBuckets[HTTP_ROUTE_NR_OF_LATENCY_BUCKETS];
+} http_route_metrics_t;
+
+/**
+ * Creates a route for the provided URI and (http) service. The route is created with a ref count of 1.
+ * Paths are matched per segment; empty segments (e.g. "//") and trailing slashes are ignored.
+ */
+http_route_t* httpRoute_create(const char *uri, void *svc);
+
+void httpRoute_retain(http_route_t *route);
+
+/**
+ * Decreases the ref count of the route and destroys the route when it reaches 0.
+ */
+void httpRoute_release(http_route_t *route);
+
+const char* httpRoute_getUri(const http_route_t *route);
+void* httpRoute_getService(const http_route_t *route);
+
+/**
+ * Returns whether both routes have the same (normalized) URI.
+ */
+bool httpRoute_hasSameUri(const http_route_t *route1, const http_route_t *route2);
+
+/**
+ * Marks the start of a request on the route. Can be called concurrently.
+ */
+void httpRoute_beginRequest(http_route_t *route, struct timespec *startTime);
+
+/**
+ * Marks the end of a request on the route and updates the request count and latency histogram.
+ */
+void httpRoute_endRequest(http_route_t *route, const struct timespec *startTime);
+
+/**
+ * Waits until all requests which began on the route have ended. New requests should not begin on the route anymore,
+ * e.g. because the route is removed from the published route table.
+ */
+void httpRoute_waitForInFlightRequests(http_route_t *route);
+
+/**
+ * Returns the nr of requests which began, but did not end yet on the route.
+ */
+uint64_t httpRoute_getNrOfInFlightRequests(const http_route_t *route);
+
+/**
+ * Copies the (relaxed loaded) metrics of the route.
+ */
+void httpRoute_getMetrics(const http_route_t *route, http_route_metrics_t *metrics);
+
+/**
+ * Creates an immutable radix trie of the provided routes (value = http_route_t*). The table retains the routes.
+ * If multiple routes have the same (normalized) URI, the first one is used.
+ */
+http_route_table_t* httpRouteTable_create(celix_array_list_t *routes);
+
+void httpRouteTable_destroy(http_route_table_t *table);
+
+/**
+ * Returns the route with the longest URI matching the requested URI on segment boundaries or NULL if no route
+ * matches. A route for "/" matches all requests. Does not allocate and can be called concurrently.
+ * The returned route is only valid as long as the table is valid.
+ */
+http_route_t* httpRouteTable_find(const http_route_table_t *table, const char *uri);
+
+/**
+ * Prints the routes of the table with their metrics.
+ */
+void httpRouteTable_print(const http_route_table_t *table, FILE *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CELIX_HTTP_ROUTE_TABLE_H
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory>
+
+#include "celix_api.h"
+#include "celix_log_helper.h"
+#include "pubsub_admin.h"
+#include "pubsub_endpoint.h"
+#include "pubsub_serializer.h"
+#include "pubsub_shm_admin.h"
+#include "pubsub_psa_shm_constants.h"
+
+class ShmAdminTestSuite : public ::testing::Test {
+public:
+    static constexpr double hostLocalScore = 80.0;
+    static constexpr double defaultScore = 20.0;
+
+    ShmAdminTestSuite() {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".pubsub_shm_admin_cache");
+        celix_properties_set(props, PSA_SHM_HOST_ID_KEY, "test-host");
+        celix_properties_setDouble(props, PSA_SHM_HOST_LOCAL_SCORE_KEY, hostLocalScore);
+        celix_properties_setDouble(props, PSA_SHM_DEFAULT_SCORE_KEY, defaultScore);
+        auto* fwPtr = celix_frameworkFactory_createFramework(props);
+        auto* ctxPtr = celix_framework_getFrameworkContext(fwPtr);
+        fw = std::shared_ptr<celix_framework_t>{fwPtr, [](auto* f) {celix_frameworkFactory_destroyFramework(f);}};
+        ctx = std::shared_ptr<celix_bundle_context_t>{ctxPtr, [](auto*){/*nop*/}};
+
+        bndId = celix_bundleContext_installBundle(ctx.get(), TOPICS_BUNDLE, true);
+
+        //note the serializer is only needed to match, it is not used
+        auto* serProps = celix_properties_create();
+        celix_properties_set(serProps, PUBSUB_SERIALIZER_TYPE_KEY, "json");
+        serializerSvcId = celix_bundleContext_registerService(ctx.get(), &serializerSvc, PUBSUB_SERIALIZER_SERVICE_NAME, serProps);
+
+        logHelper = celix_logHelper_create(ctx.get(), "test_psa_shm");
+        psa = pubsub_shmAdmin_create(ctx.get(), logHelper);
+    }
+
+    ~ShmAdminTestSuite() override {
+        pubsub_shmAdmin_destroy(psa);
+        celix_logHelper_destroy(logHelper);
+        celix_bundleContext_unregisterService(ctx.get(), serializerSvcId);
+        celix_bundleContext_uninstallBundle(ctx.get(), bndId);
+    }
+
+    ShmAdminTestSuite(const ShmAdminTestSuite&) = delete;
+    ShmAdminTestSuite& operator=(const ShmAdminTestSuite&) = delete;
+
+    double matchSubscriber(const char* topic) {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_SUBSCRIBER_TOPIC, topic);
+        double score = -1;
+        long serId = -1L;
+        EXPECT_EQ(CELIX_SUCCESS, pubsub_shmAdmin_matchSubscriber(psa, bndId, props, nullptr, &score, &serId, nullptr));
+        EXPECT_EQ(serializerSvcId, serId);
+        celix_properties_destroy(props);
+        return score;
+    }
+
+    double matchPublisher(const char* topic) {
+        std::string filterStr = std::string{"(&(objectClass=" PUBSUB_PUBLISHER_SERVICE_NAME ")(topic="} + topic + "))";
+        celix_filter_t* filter = celix_filter_create(filterStr.c_str());
+        double score = -1;
+        long serId = -1L;
+        EXPECT_EQ(CELIX_SUCCESS, pubsub_shmAdmin_matchPublisher(psa, bndId, filter, nullptr, &score, &serId, nullptr));
+        celix_filter_destroy(filter);
+        return score;
+    }
+
+    bool matchEndpoint(const char* adminType, const char* hostId) {
+        auto* ep = celix_properties_create();
+        celix_properties_set(ep, PUBSUB_ENDPOINT_ADMIN_TYPE, adminType);
+        celix_properties_set(ep, PUBSUB_ENDPOINT_SERIALIZER, "json");
+        if (hostId != nullptr) {
+            celix_properties_set(ep, PUBSUB_SHM_HOST_ID_ENDPOINT_KEY, hostId);
+        }
+        bool match = false;
+        EXPECT_EQ(CELIX_SUCCESS, pubsub_shmAdmin_matchDiscoveredEndpoint(psa, ep, &match));
+        celix_properties_destroy(ep);
+        return match;
+    }
+
+    std::shared_ptr<celix_framework_t> fw{};
+    std::shared_ptr<celix_bundle_context_t> ctx{};
+    long bndId{-1L};
+    pubsub_serializer_service_t serializerSvc{};
+    long serializerSvcId{-1L};
+    celix_log_helper_t* logHelper{nullptr};
+    pubsub_shm_admin_t* psa{nullptr};
+};
+
+TEST_F(ShmAdminTestSuite, HostAndLocalVisibilityUseTheHostLocalScore) {
+    EXPECT_DOUBLE_EQ(hostLocalScore, matchSubscriber("host"));
+    EXPECT_DOUBLE_EQ(hostLocalScore, matchSubscriber("local"));
+    EXPECT_DOUBLE_EQ(hostLocalScore, matchPublisher("host"));
+}
+
+TEST_F(ShmAdminTestSuite, SystemVisibilityUsesTheDefaultScore) {
+    EXPECT_DOUBLE_EQ(defaultScore, matchSubscriber("system"));
+    EXPECT_DOUBLE_EQ(defaultScore, matchPublisher("system"));
+}
+
+TEST_F(ShmAdminTestSuite, RequestedAdminOverrulesTheHostLocalScore) {
+    //another admin requested, no match even if the visibility is host
+    EXPECT_DOUBLE_EQ(PUBSUB_ADMIN_NO_MATCH_SCORE, matchSubscriber("tcp"));
+    //shm requested, full match which is not lowered to the host local score
+    EXPECT_DOUBLE_EQ(PUBSUB_ADMIN_FULL_MATCH_SCORE, matchSubscriber("shm"));
+}
+
+TEST_F(ShmAdminTestSuite, NoSerializerIsNoMatch) {
+    celix_bundleContext_unregisterService(ctx.get(), serializerSvcId);
+    serializerSvcId = -1L;
+    EXPECT_DOUBLE_EQ(PUBSUB_ADMIN_NO_MATCH_SCORE, matchSubscriber("host"));
+}
+
+TEST_F(ShmAdminTestSuite, DiscoveredEndpointsOnlyMatchOnTheSameHost) {
+    EXPECT_TRUE(matchEndpoint(PUBSUB_SHM_ADMIN_TYPE, "test-host"));
+    EXPECT_FALSE(matchEndpoint(PUBSUB_SHM_ADMIN_TYPE, "other-host"));
+    EXPECT_FALSE(matchEndpoint(PUBSUB_SHM_ADMIN_TYPE, nullptr));
+    EXPECT_FALSE(matchEndpoint("tcp", "test-host"));
+}
@@ -0,0 +1,244 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "pubsub_shm_ring.h"
+
+class ShmRingTestSuite : public ::testing::Test {
+public:
+    ShmRingTestSuite() : name{"/celix_shm_ring_test_" + std::to_string(getpid())},
+            writer{pubsub_shmRing_create(name.c_str(), 4096)}, reader{pubsub_shmRing_open(name.c_str())} {
+        pubsub_shmRing_initReader(reader, &readerState);
+    }
+
+    ~ShmRingTestSuite() override {
+        pubsub_shmRing_destroy(reader);
+        pubsub_shmRing_destroy(writer);
+    }
+
+    ShmRingTestSuite(const ShmRingTestSuite&) = delete;
+    ShmRingTestSuite& operator=(const ShmRingTestSuite&) = delete;
+
+    static std::vector<char> createMsg(size_t size, int seed) {
+        std::vector<char> msg(size);
+        for (size_t i = 0; i < size; ++i) {
+            msg[i] = (char)((i + (size_t)seed) % 251);
+        }
+        return msg;
+    }
+
+    celix_status_t write(std::vector<char>& msg, unsigned int msgTypeId = 1) {
+        //note split the payload in 2 io vectors
+        struct iovec iov[2];
+        iov[0].iov_base = msg.data();
+        iov[0].iov_len = msg.size() / 2;
+        iov[1].iov_base = msg.data() + msg.size() / 2;
+        iov[1].iov_len = msg.size() - msg.size() / 2;
+        return pubsub_shmRing_write(writer, msgTypeId, 1, 2, iov, 2, nullptr, 0);
+    }
+
+    bool readAndCheck(const std::vector<char>& expected, int timeoutInMs = 0) {
+        const pubsub_shm_msg_header_t *hdr = nullptr;
+        const void *payload = nullptr;
+        if (!pubsub_shmRing_read(reader, &readerState, timeoutInMs, &hdr, &payload)) {
+            return false;
+        }
+        EXPECT_EQ(expected.size(), hdr->payloadSize);
+        EXPECT_EQ(0, hdr->metadataSize);
+        EXPECT_EQ(1, hdr->major);
+        EXPECT_EQ(2, hdr->minor);
+        bool equal = hdr->payloadSize == expected.size() && memcmp(payload, expected.data(), expected.size()) == 0;
+        EXPECT_TRUE(pubsub_shmRing_isValid(reader, &readerState));
+        return equal;
+    }
+
+    const std::string name;
+    pubsub_shm_ring_t *writer;
+    pubsub_shm_ring_t *reader;
+    pubsub_shm_ring_reader_t readerState{};
+};
+
+TEST_F(ShmRingTestSuite, CreateAndOpen) {
+    ASSERT_NE(nullptr, writer);
+    ASSERT_NE(nullptr, reader);
+    EXPECT_EQ(4096, pubsub_shmRing_capacity(writer));
+    EXPECT_EQ(4096, pubsub_shmRing_capacity(reader));
+    EXPECT_EQ(nullptr, pubsub_shmRing_open("/celix_shm_ring_test_does_not_exist"));
+
+    //only the creator can write
+    std::vector<char> msg = createMsg(10, 0);
+    struct iovec iov{msg.data(), msg.size()};
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, pubsub_shmRing_write(reader, 1, 1, 2, &iov, 1, nullptr, 0));
+}
+
+TEST_F(ShmRingTestSuite, WriteAndReadInPlace) {
+    std::vector<char> msg1 = createMsg(100, 1);
+    std::vector<char> msg2 = createMsg(1, 2);
+    std::vector<char> msg3 = createMsg(0, 3);
+    EXPECT_EQ(CELIX_SUCCESS, write(msg1));
+    EXPECT_EQ(CELIX_SUCCESS, write(msg2));
+    EXPECT_EQ(CELIX_SUCCESS, write(msg3));
+
+    EXPECT_TRUE(readAndCheck(msg1));
+    EXPECT_TRUE(readAndCheck(msg2));
+    EXPECT_TRUE(readAndCheck(msg3));
+    EXPECT_FALSE(readAndCheck(msg3)); //no more messages
+    EXPECT_EQ(3, readerState.nrOfMessagesRead);
+    EXPECT_EQ(0, readerState.nrOfMessagesLost);
+}
+
+TEST_F(ShmRingTestSuite, WrapAround) {
+    //note the different sizes result in explicit, implicit and no padding at the end of the ring
+    for (int i = 0; i < 500; ++i) {
+        std::vector<char> msg = createMsg((size_t)(i * 7) % (pubsub_shmRing_maxPayloadSize(writer) + 1), i);
+        ASSERT_EQ(CELIX_SUCCESS, write(msg));
+        ASSERT_TRUE(readAndCheck(msg)) << "message " << i;
+    }
+    EXPECT_EQ(500, readerState.nrOfMessagesRead);
+    EXPECT_EQ(0, readerState.nrOfMessagesLost);
+}
+
+TEST_F(ShmRingTestSuite, TooLargeMessage) {
+    std::vector<char> msg = createMsg(pubsub_shmRing_maxPayloadSize(writer) + 1, 0);
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, write(msg));
+    msg.resize(pubsub_shmRing_maxPayloadSize(writer));
+    EXPECT_EQ(CELIX_SUCCESS, write(msg));
+    EXPECT_TRUE(readAndCheck(msg));
+}
+
+TEST_F(ShmRingTestSuite, MetadataFollowsPayload) {
+    std::vector<char> msg = createMsg(13, 0);
+    const std::string metadata = "encoded metadata";
+    struct iovec iov{msg.data(), msg.size()};
+    EXPECT_EQ(CELIX_SUCCESS, pubsub_shmRing_write(writer, 1, 1, 2, &iov, 1, metadata.data(), metadata.size()));
+
+    const pubsub_shm_msg_header_t *hdr = nullptr;
+    const void *payload = nullptr;
+    ASSERT_TRUE(pubsub_shmRing_read(reader, &readerState, 0, &hdr, &payload));
+    EXPECT_EQ(msg.size(), hdr->payloadSize);
+    EXPECT_EQ(metadata.size(), hdr->metadataSize);
+    EXPECT_EQ(0, memcmp(payload, msg.data(), msg.size()));
+    EXPECT_EQ(metadata, std::string(static_cast<const char*>(payload) + hdr->payloadSize, hdr->metadataSize));
+    EXPECT_TRUE(pubsub_shmRing_isValid(reader, &readerState));
+
+    //the metadata counts for the max message size
+    msg.resize(pubsub_shmRing_maxPayloadSize(writer) - metadata.size() + 1);
+    iov = {msg.data(), msg.size()};
+    EXPECT_EQ(CELIX_ILLEGAL_ARGUMENT, pubsub_shmRing_write(writer, 1, 1, 2, &iov, 1, metadata.data(), metadata.size()));
+}
+
+TEST_F(ShmRingTestSuite, OvertakenReaderCountsLostMessages) {
+    //write more than the capacity, without reading
+    std::vector<std::vector<char>> msgs;
+    for (int i = 0; i < 20; ++i) {
+        msgs.push_back(createMsg(500, i));
+        ASSERT_EQ(CELIX_SUCCESS, write(msgs.back()));
+    }
+
+    //the reader continues at the write position, the overwritten messages are counted as lost with the next message
+    EXPECT_FALSE(readAndCheck(msgs.front()));
+    EXPECT_EQ(0, readerState.nrOfMessagesRead);
+
+    std::vector<char> msg = createMsg(10, 42);
+    ASSERT_EQ(CELIX_SUCCESS, write(msg));
+    EXPECT_TRUE(readAndCheck(msg));
+    EXPECT_EQ(1, readerState.nrOfMessagesRead);
+    EXPECT_EQ(20, readerState.nrOfMessagesLost);
+}
+
+TEST_F(ShmRingTestSuite, OverwrittenMessageIsNotValid) {
+    std::vector<char> msg = createMsg(500, 0);
+    ASSERT_EQ(CELIX_SUCCESS, write(msg));
+
+    const pubsub_shm_msg_header_t *hdr = nullptr;
+    const void *payload = nullptr;
+    ASSERT_TRUE(pubsub_shmRing_read(reader, &readerState, 0, &hdr, &payload));
+    EXPECT_TRUE(pubsub_shmRing_isValid(reader, &readerState));
+
+    //overwrite the read message while "deserializing"
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(CELIX_SUCCESS, write(msg));
+    }
+    EXPECT_FALSE(pubsub_shmRing_isValid(reader, &readerState));
+    EXPECT_FALSE(pubsub_shmRing_isValid(reader, &readerState));
+    EXPECT_EQ(0, readerState.nrOfMessagesRead);
+    EXPECT_EQ(1, readerState.nrOfMessagesLost); //note only counted once
+}
+
+TEST_F(ShmRingTestSuite, WaitingReaderIsWokenUp) {
+    std::vector<char> msg = createMsg(100, 0);
+    auto start = std::chrono::steady_clock::now();
+    std::thread writeThread{[this, &msg]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        write(msg);
+    }};
+
+    bool read = false;
+    while (!read && std::chrono::steady_clock::now() - start < std::chrono::seconds{5}) {
+        read = readAndCheck(msg, 5000);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    writeThread.join();
+    EXPECT_TRUE(read);
+    EXPECT_LT(elapsed, std::chrono::seconds{2});
+}
+
+TEST_F(ShmRingTestSuite, ConcurrentWriterAndReaders) {
+    const int nrOfMsgs = 20000;
+    bool done = false;
+    std::thread writeThread{[this, &done]{
+        for (int i = 0; i < nrOfMsgs; ++i) {
+            std::vector<char> msg = createMsg(64 + (size_t)i % 300, i);
+            write(msg);
+            if (i % 100 == 0) {
+                std::this_thread::yield();
+            }
+        }
+        __atomic_store_n(&done, true, __ATOMIC_RELEASE);
+    }};
+
+    //every read message must be intact or detected as overwritten
+    uint64_t nrOfCorrupt = 0;
+    bool read = true;
+    while (read || !__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+        const pubsub_shm_msg_header_t *hdr = nullptr;
+        const void *payload = nullptr;
+        read = pubsub_shmRing_read(reader, &readerState, 100, &hdr, &payload);
+        if (read) {
+            int i = (int)(hdr->seqNr - 1);
+            std::vector<char> expected = createMsg(64 + (size_t)i % 300, i);
+            bool equal = hdr->payloadSize == expected.size() && memcmp(payload, expected.data(), expected.size()) == 0;
+            if (pubsub_shmRing_isValid(reader, &readerState) && !equal) {
+                nrOfCorrupt += 1;
+            }
+        }
+    }
+    writeThread.join();
+    EXPECT_EQ(0, nrOfCorrupt);
+    EXPECT_GT(readerState.nrOfMessagesRead, 0);
+    EXPECT_LE(readerState.nrOfMessagesRead + readerState.nrOfMessagesLost, (uint64_t)nrOfMsgs);
+}
@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PUBSUB_PSA_SHM_CONSTANTS_H_
+#define PUBSUB_PSA_SHM_CONSTANTS_H_
+
+#define PUBSUB_SHM_ADMIN_TYPE                       "shm"
+
+/**
+ * The shm admin can only connect publishers and subscribers on the same host. The default scores are therefore low,
+ * so that topics without a host local configuration are handled by a network admin (if available).
+ */
+#define PSA_SHM_DEFAULT_QOS_SAMPLE_SCORE            20
+#define PSA_SHM_DEFAULT_QOS_CONTROL_SCORE           20
+#define PSA_SHM_DEFAULT_SCORE                       20
+
+/**
+ * The score used if the topic properties configure a host or local endpoint visibility
+ * (pubsub.endpoint.visibility=host or local). Note that a topic explicitly configured for another admin
+ * (pubsub.config=<admin>) still results in a full match score (100) for that admin.
+ */
+#define PSA_SHM_DEFAULT_HOST_LOCAL_SCORE            90
+
+#define PSA_SHM_QOS_SAMPLE_SCORE_KEY                "PSA_SHM_QOS_SAMPLE_SCORE"
+#define PSA_SHM_QOS_CONTROL_SCORE_KEY               "PSA_SHM_QOS_CONTROL_SCORE"
+#define PSA_SHM_DEFAULT_SCORE_KEY                   "PSA_SHM_DEFAULT_SCORE"
+#define PSA_SHM_HOST_LOCAL_SCORE_KEY                "PSA_SHM_HOST_LOCAL_SCORE"
+
+/**
+ * The size in bytes of the shared memory ring of a topic sender. Rounded up to a power of 2.
+ * The max size of a single (serialized) message is a quarter of the ring size.
+ */
+#define PSA_SHM_RING_SIZE_KEY                       "PSA_SHM_RING_SIZE"
+#define PSA_SHM_RING_SIZE_DEFAULT                   (4 * 1024 * 1024)
+
+/**
+ * The id of the host, used to only connect to endpoints of the same host.
+ * Default the hostname is used.
+ */
+#define PSA_SHM_HOST_ID_KEY                         "PSA_SHM_HOST_ID"
+
+#define PUBSUB_SHM_VERBOSE_KEY                      "PSA_SHM_VERBOSE"
+#define PUBSUB_SHM_VERBOSE_DEFAULT                  false
+
+/**
+ * Endpoint properties: the (shm_open) name of the ring of a publisher endpoint and the host id of the endpoint.
+ */
+#define PUBSUB_SHM_RING_NAME_KEY                    "shm.ring.name"
+#define PUBSUB_SHM_HOST_ID_ENDPOINT_KEY             "shm.host.id"
+
+#endif /* PUBSUB_PSA_SHM_CONSTANTS_H_ */
@@ -0,0 +1,640 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <memory.h>
+#include <unistd.h>
+#include <pubsub_endpoint.h>
+#include <pubsub_serializer.h>
+
+#include "pubsub_utils.h"
+#include "pubsub_admin.h"
+#include "pubsub_shm_admin.h"
+#include "pubsub_psa_shm_constants.h"
+#include "pubsub_shm_topic_sender.h"
+#include "pubsub_shm_topic_receiver.h"
+
+#define L_DEBUG(...) \
+    celix_logHelper_log(psa->log, CELIX_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    celix_logHelper_log(psa->log, CELIX_LOG_LEVEL_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    celix_logHelper_log(psa->log, CELIX_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    celix_logHelper_log(psa->log, CELIX_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+struct pubsub_shm_admin {
+    celix_bundle_context_t *ctx;
+    celix_log_helper_t *log;
+    const char *fwUUID;
+    char *hostId;
+    size_t ringSize;
+    long nextRingId; //protected by topicSenders.mutex
+
+    double qosSampleScore;
+    double qosControlScore;
+    double defaultScore;
+    double hostLocalScore;
+
+    bool verbose;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = svcId, value = psa_shm_serializer_entry_t*
+    } serializers;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope:topic key, value = pubsub_shm_topic_sender_t*
+    } topicSenders;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope:topic key, value = pubsub_shm_topic_receiver_t*
+    } topicReceivers;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = endpoint uuid, value = celix_properties_t* (endpoint)
+    } discoveredEndpoints;
+};
+
+typedef struct psa_shm_serializer_entry {
+    const char *serType;
+    long svcId;
+    pubsub_serializer_service_t *svc;
+} psa_shm_serializer_entry_t;
+
+static void pubsub_shmAdmin_connectEndpointToReceiver(pubsub_shm_admin_t* psa, pubsub_shm_topic_receiver_t *receiver, const celix_properties_t *endpoint);
+static void pubsub_shmAdmin_disconnectEndpointFromReceiver(pubsub_shm_admin_t* psa, pubsub_shm_topic_receiver_t *receiver, const celix_properties_t *endpoint);
+
+pubsub_shm_admin_t* pubsub_shmAdmin_create(celix_bundle_context_t *ctx, celix_log_helper_t *logHelper) {
+    pubsub_shm_admin_t *psa = calloc(1, sizeof(*psa));
+    psa->ctx = ctx;
+    psa->log = logHelper;
+    psa->verbose = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_SHM_VERBOSE_KEY, PUBSUB_SHM_VERBOSE_DEFAULT);
+    psa->fwUUID = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+    psa->ringSize = (size_t)celix_bundleContext_getPropertyAsLong(ctx, PSA_SHM_RING_SIZE_KEY, PSA_SHM_RING_SIZE_DEFAULT);
+
+    const char *hostId = celix_bundleContext_getProperty(ctx, PSA_SHM_HOST_ID_KEY, NULL);
+    if (hostId != NULL) {
+        psa->hostId = strndup(hostId, 1024);
+    } else {
+        char hostname[256];
+        if (gethostname(hostname, sizeof(hostname)) == 0) {
+            hostname[sizeof(hostname) - 1] = '\0';
+            psa->hostId = strndup(hostname, sizeof(hostname));
+        } else {
+            psa->hostId = strndup("localhost", 1024);
+        }
+    }
+
+    psa->defaultScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_SHM_DEFAULT_SCORE_KEY, PSA_SHM_DEFAULT_SCORE);
+    psa->qosSampleScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_SHM_QOS_SAMPLE_SCORE_KEY, PSA_SHM_DEFAULT_QOS_SAMPLE_SCORE);
+    psa->qosControlScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_SHM_QOS_CONTROL_SCORE_KEY, PSA_SHM_DEFAULT_QOS_CONTROL_SCORE);
+    psa->hostLocalScore = celix_bundleContext_getPropertyAsDouble(ctx, PSA_SHM_HOST_LOCAL_SCORE_KEY, PSA_SHM_DEFAULT_HOST_LOCAL_SCORE);
+
+    celixThreadMutex_create(&psa->serializers.mutex, NULL);
+    psa->serializers.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    celixThreadMutex_create(&psa->topicSenders.mutex, NULL);
+    psa->topicSenders.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    celixThreadMutex_create(&psa->topicReceivers.mutex, NULL);
+    psa->topicReceivers.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    celixThreadMutex_create(&psa->discoveredEndpoints.mutex, NULL);
+    psa->discoveredEndpoints.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    return psa;
+}
+
+void pubsub_shmAdmin_destroy(pubsub_shm_admin_t *psa) {
+    if (psa == NULL) {
+        return;
+    }
+
+    //note assuming al psa register services and service tracker are removed.
+
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
+        pubsub_shmTopicSender_destroy(sender);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    iter = hashMapIterator_construct(psa->topicReceivers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_receiver_t *recv = hashMapIterator_nextValue(&iter);
+        pubsub_shmTopicReceiver_destroy(recv);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+    celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
+    iter = hashMapIterator_construct(psa->discoveredEndpoints.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_properties_t *ep = hashMapIterator_nextValue(&iter);
+        celix_properties_destroy(ep);
+    }
+    celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    iter = hashMapIterator_construct(psa->serializers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_shm_serializer_entry_t *entry = hashMapIterator_nextValue(&iter);
+        free(entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    celixThreadMutex_destroy(&psa->topicSenders.mutex);
+    hashMap_destroy(psa->topicSenders.map, true, false);
+
+    celixThreadMutex_destroy(&psa->topicReceivers.mutex);
+    hashMap_destroy(psa->topicReceivers.map, true, false);
+
+    celixThreadMutex_destroy(&psa->discoveredEndpoints.mutex);
+    hashMap_destroy(psa->discoveredEndpoints.map, false, false);
+
+    celixThreadMutex_destroy(&psa->serializers.mutex);
+    hashMap_destroy(psa->serializers.map, false, false);
+
+    free(psa->hostId);
+    free(psa);
+}
+
+void pubsub_shmAdmin_addSerializerSvc(void *handle, void *svc, const celix_properties_t *props) {
+    pubsub_shm_admin_t *psa = handle;
+
+    const char *serType = celix_properties_get(props, PUBSUB_SERIALIZER_TYPE_KEY, NULL);
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+    if (serType == NULL) {
+        L_INFO("[PSA_SHM] Ignoring serializer service without %s property", PUBSUB_SERIALIZER_TYPE_KEY);
+        return;
+    }
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    psa_shm_serializer_entry_t *entry = hashMap_get(psa->serializers.map, (void*)svcId);
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        entry->serType = serType;
+        entry->svcId = svcId;
+        entry->svc = svc;
+        hashMap_put(psa->serializers.map, (void*)svcId, entry);
+    }
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+}
+
+void pubsub_shmAdmin_removeSerializerSvc(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+    pubsub_shm_admin_t *psa = handle;
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+
+    //remove serializer
+    // 1) First find entry and
+    // 2) loop and destroy all topic sender using the serializer and
+    // 3) loop and destroy all topic receivers using the serializer
+    // Note that it is the responsibility of the topology manager to create new topic senders/receivers
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    psa_shm_serializer_entry_t *entry = hashMap_remove(psa->serializers.map, (void*)svcId);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (entry != NULL) {
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *senderEntry = hashMapIterator_nextEntry(&iter);
+            pubsub_shm_topic_sender_t *sender = hashMapEntry_getValue(senderEntry);
+            if (sender != NULL && entry->svcId == pubsub_shmTopicSender_serializerSvcId(sender)) {
+                char *key = hashMapEntry_getKey(senderEntry);
+                hashMapIterator_remove(&iter);
+                pubsub_shmTopicSender_destroy(sender);
+                free(key);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        iter = hashMapIterator_construct(psa->topicReceivers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            hash_map_entry_t *receiverEntry = hashMapIterator_nextEntry(&iter);
+            pubsub_shm_topic_receiver_t *receiver = hashMapEntry_getValue(receiverEntry);
+            if (receiver != NULL && entry->svcId == pubsub_shmTopicReceiver_serializerSvcId(receiver)) {
+                char *key = hashMapEntry_getKey(receiverEntry);
+                hashMapIterator_remove(&iter);
+                pubsub_shmTopicReceiver_destroy(receiver);
+                free(key);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+        free(entry);
+    }
+}
+
+/**
+ * Raises the score to the host local score if the topic properties configure a host or local endpoint visibility and
+ * no specific admin.
+ */
+static double pubsub_shmAdmin_hostLocalScore(pubsub_shm_admin_t *psa, const celix_properties_t *topicProperties, double score) {
+    const char *requestedAdmin = celix_properties_get(topicProperties, PUBSUB_ENDPOINT_ADMIN_TYPE, NULL);
+    const char *visibility = celix_properties_get(topicProperties, PUBSUB_ENDPOINT_VISIBILITY, NULL);
+    bool hostLocal = visibility != NULL &&
+            (strcmp(visibility, PUBSUB_ENDPOINT_HOST_VISIBILITY) == 0 || strcmp(visibility, PUBSUB_ENDPOINT_LOCAL_VISIBILITY) == 0);
+    if (requestedAdmin == NULL && hostLocal && score > PUBSUB_ADMIN_NO_MATCH_SCORE && score < psa->hostLocalScore) {
+        score = psa->hostLocalScore;
+    }
+    return score;
+}
+
+celix_status_t pubsub_shmAdmin_matchPublisher(void *handle, long svcRequesterBndId, const celix_filter_t *svcFilter, celix_properties_t **topicProperties, double *outScore, long *outSerializerSvcId, long *outProtocolSvcId) {
+    pubsub_shm_admin_t *psa = handle;
+    L_DEBUG("[PSA_SHM] pubsub_shmAdmin_matchPublisher");
+    celix_properties_t *props = NULL;
+    double score = pubsubEndpoint_matchPublisher(psa->ctx, svcRequesterBndId, svcFilter->filterStr, PUBSUB_SHM_ADMIN_TYPE,
+                                                 psa->qosSampleScore, psa->qosControlScore, psa->defaultScore,
+                                                 false, &props, outSerializerSvcId, outProtocolSvcId);
+    score = pubsub_shmAdmin_hostLocalScore(psa, props, score);
+    if (topicProperties != NULL) {
+        *topicProperties = props;
+    } else if (props != NULL) {
+        celix_properties_destroy(props);
+    }
+    *outScore = score;
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_matchSubscriber(void *handle, long svcProviderBndId, const celix_properties_t *svcProperties, celix_properties_t **topicProperties, double *outScore, long *outSerializerSvcId, long *outProtocolSvcId) {
+    pubsub_shm_admin_t *psa = handle;
+    L_DEBUG("[PSA_SHM] pubsub_shmAdmin_matchSubscriber");
+    celix_properties_t *props = NULL;
+    double score = pubsubEndpoint_matchSubscriber(psa->ctx, svcProviderBndId, svcProperties, PUBSUB_SHM_ADMIN_TYPE,
+                                                  psa->qosSampleScore, psa->qosControlScore, psa->defaultScore,
+                                                  false, &props, outSerializerSvcId, outProtocolSvcId);
+    score = pubsub_shmAdmin_hostLocalScore(psa, props, score);
+    if (topicProperties != NULL) {
+        *topicProperties = props;
+    } else if (props != NULL) {
+        celix_properties_destroy(props);
+    }
+    if (outScore != NULL) {
+        *outScore = score;
+    }
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_matchDiscoveredEndpoint(void *handle, const celix_properties_t *endpoint, bool *outMatch) {
+    pubsub_shm_admin_t *psa = handle;
+    L_DEBUG("[PSA_SHM] pubsub_shmAdmin_matchEndpoint");
+    bool match = pubsubEndpoint_match(psa->ctx, psa->log, endpoint, PUBSUB_SHM_ADMIN_TYPE, false, NULL, NULL);
+    if (match) {
+        //shared memory rings can only be read on the same host
+        const char *hostId = celix_properties_get(endpoint, PUBSUB_SHM_HOST_ID_ENDPOINT_KEY, NULL);
+        match = hostId != NULL && strcmp(hostId, psa->hostId) == 0;
+    }
+    if (outMatch != NULL) {
+        *outMatch = match;
+    }
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_setupTopicSender(void *handle, const char *scope, const char *topic, const celix_properties_t *topicProperties __attribute__((unused)), long serializerSvcId, long protocolSvcId __attribute__((unused)), celix_properties_t **outPublisherEndpoint) {
+    pubsub_shm_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    //1) Create TopicSender (and shared memory ring)
+    //2) Store TopicSender
+    //3) set outPublisherEndpoint
+
+    celix_properties_t *newEndpoint = NULL;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    pubsub_shm_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, key);
+    if (sender == NULL) {
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
+        if (serEntry != NULL) {
+            char *ringName = NULL;
+            asprintf(&ringName, "/celix_psa_shm_%s_%li", psa->fwUUID, psa->nextRingId++);
+            sender = pubsub_shmTopicSender_create(psa->ctx, psa->log, scope, topic, ringName, psa->ringSize, serializerSvcId, serEntry->svc);
+            free(ringName);
+        }
+        if (sender != NULL) {
+            const char *psaType = PUBSUB_SHM_ADMIN_TYPE;
+            const char *serType = serEntry->serType;
+            newEndpoint = pubsubEndpoint_create(psa->fwUUID, scope, topic, PUBSUB_PUBLISHER_ENDPOINT_TYPE, psaType,
+                                                serType, NULL, NULL);
+            celix_properties_set(newEndpoint, PUBSUB_SHM_RING_NAME_KEY, pubsub_shmTopicSender_ringName(sender));
+            celix_properties_set(newEndpoint, PUBSUB_SHM_HOST_ID_ENDPOINT_KEY, psa->hostId);
+
+            //Set endpoint visibility to system, so that the endpoint is discovered by the other processes.
+            //Endpoints of other hosts are ignored (see matchDiscoveredEndpoint).
+            celix_properties_set(newEndpoint, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_SYSTEM_VISIBILITY);
+
+            //if available also set container name
+            const char *cn = celix_bundleContext_getProperty(psa->ctx, "CELIX_CONTAINER_NAME", NULL);
+            if (cn != NULL) {
+                celix_properties_set(newEndpoint, "container_name", cn);
+            }
+            hashMap_put(psa->topicSenders.map, key, sender);
+
+            //Receivers in this framework do not need discovery to find the ring of a local sender.
+            celixThreadMutex_lock(&psa->topicReceivers.mutex);
+            pubsub_shm_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, key);
+            if (receiver != NULL) {
+                pubsub_shmTopicReceiver_connectTo(receiver, pubsub_shmTopicSender_ringName(sender));
+            }
+            celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+        } else {
+            L_ERROR("[PSA_SHM] Error creating a TopicSender");
+            free(key);
+        }
+    } else {
+        free(key);
+        L_ERROR("[PSA_SHM] Cannot setup already existing TopicSender for scope/topic %s/%s!", scope == NULL ? "(null)" : scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (newEndpoint != NULL && outPublisherEndpoint != NULL) {
+        *outPublisherEndpoint = newEndpoint;
+    }
+
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_teardownTopicSender(void *handle, const char *scope, const char *topic) {
+    pubsub_shm_admin_t *psa = handle;
+    celix_status_t  status = CELIX_SUCCESS;
+
+    //1) Find and remove TopicSender from map
+    //2) destroy topic sender
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_entry_t *entry = hashMap_getEntry(psa->topicSenders.map, key);
+    if (entry != NULL) {
+        char *mapKey = hashMapEntry_getKey(entry);
+        pubsub_shm_topic_sender_t *sender = hashMap_remove(psa->topicSenders.map, key);
+        free(mapKey);
+
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        pubsub_shm_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, key);
+        if (receiver != NULL) {
+            pubsub_shmTopicReceiver_disconnectFrom(receiver, pubsub_shmTopicSender_ringName(sender));
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+        pubsub_shmTopicSender_destroy(sender);
+    } else {
+        L_ERROR("[PSA_SHM] Cannot teardown TopicSender with scope/topic %s/%s. Does not exists", scope == NULL ? "(null)" : scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    free(key);
+
+    return status;
+}
+
+celix_status_t pubsub_shmAdmin_setupTopicReceiver(void *handle, const char *scope, const char *topic, const celix_properties_t *topicProperties __attribute__((unused)), long serializerSvcId, long protocolSvcId __attribute__((unused)), celix_properties_t **outSubscriberEndpoint) {
+    pubsub_shm_admin_t *psa = handle;
+
+    celix_properties_t *newEndpoint = NULL;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    pubsub_shm_topic_receiver_t *receiver = hashMap_get(psa->topicReceivers.map, key);
+    if (receiver == NULL) {
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
+        if (serEntry != NULL) {
+            receiver = pubsub_shmTopicReceiver_create(psa->ctx, psa->log, scope, topic, serializerSvcId, serEntry->svc);
+        } else {
+            L_ERROR("[PSA_SHM] Cannot find serializer for TopicReceiver %s/%s", scope == NULL ? "(null)" : scope, topic);
+        }
+        if (receiver != NULL) {
+            const char *psaType = PUBSUB_SHM_ADMIN_TYPE;
+            const char *serType = serEntry->serType;
+            newEndpoint = pubsubEndpoint_create(psa->fwUUID, scope, topic,
+                                                PUBSUB_SUBSCRIBER_ENDPOINT_TYPE, psaType, serType, NULL, NULL);
+            celix_properties_set(newEndpoint, PUBSUB_SHM_HOST_ID_ENDPOINT_KEY, psa->hostId);
+            celix_properties_set(newEndpoint, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_SYSTEM_VISIBILITY);
+
+            //if available also set container name
+            const char *cn = celix_bundleContext_getProperty(psa->ctx, "CELIX_CONTAINER_NAME", NULL);
+            if (cn != NULL) {
+                celix_properties_set(newEndpoint, "container_name", cn);
+            }
+            hashMap_put(psa->topicReceivers.map, key, receiver);
+        } else {
+            L_ERROR("[PSA_SHM] Error creating a TopicReceiver.");
+            free(key);
+        }
+    } else {
+        free(key);
+        L_ERROR("[PSA_SHM] Cannot setup already existing TopicReceiver for scope/topic %s/%s!", scope == NULL ? "(null)" : scope, topic);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    if (receiver != NULL && newEndpoint != NULL) {
+        //note topicSenders.mutex is taken before topicReceivers.mutex, so only lock it after the receivers are unlocked
+        celixThreadMutex_lock(&psa->topicSenders.mutex);
+        char *senderKey = pubsubEndpoint_createScopeTopicKey(scope, topic);
+        pubsub_shm_topic_sender_t *sender = hashMap_get(psa->topicSenders.map, senderKey);
+        if (sender != NULL) {
+            pubsub_shmTopicReceiver_connectTo(receiver, pubsub_shmTopicSender_ringName(sender));
+        }
+        free(senderKey);
+        celixThreadMutex_unlock(&psa->topicSenders.mutex);
+
+        celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->discoveredEndpoints.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_properties_t *endpoint = hashMapIterator_nextValue(&iter);
+            const char *type = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TYPE, NULL);
+            if (type != NULL && strncmp(PUBSUB_PUBLISHER_ENDPOINT_TYPE, type, strlen(PUBSUB_PUBLISHER_ENDPOINT_TYPE)) == 0 && pubsubEndpoint_matchWithTopicAndScope(endpoint, topic, scope)) {
+                pubsub_shmAdmin_connectEndpointToReceiver(psa, receiver, endpoint);
+            }
+        }
+        celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+    }
+
+    if (newEndpoint != NULL && outSubscriberEndpoint != NULL) {
+        *outSubscriberEndpoint = newEndpoint;
+    }
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_teardownTopicReceiver(void *handle, const char *scope, const char *topic) {
+    pubsub_shm_admin_t *psa = handle;
+
+    char *key = pubsubEndpoint_createScopeTopicKey(scope, topic);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    hash_map_entry_t *entry = hashMap_getEntry(psa->topicReceivers.map, key);
+    free(key);
+    if (entry != NULL) {
+        char *receiverKey = hashMapEntry_getKey(entry);
+        pubsub_shm_topic_receiver_t *receiver = hashMapEntry_getValue(entry);
+        hashMap_remove(psa->topicReceivers.map, receiverKey);
+
+        free(receiverKey);
+        pubsub_shmTopicReceiver_destroy(receiver);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+
+    return CELIX_SUCCESS;
+}
+
+static void pubsub_shmAdmin_connectEndpointToReceiver(pubsub_shm_admin_t* psa, pubsub_shm_topic_receiver_t *receiver, const celix_properties_t *endpoint) {
+    //note can be called with discoveredEndpoint.mutex lock
+    const char *ringName = celix_properties_get(endpoint, PUBSUB_SHM_RING_NAME_KEY, NULL);
+    const char *hostId = celix_properties_get(endpoint, PUBSUB_SHM_HOST_ID_ENDPOINT_KEY, NULL);
+    if (ringName == NULL) {
+        L_WARN("[PSA_SHM] Error got publisher endpoint without shm ring name. Properties:");
+        const char *key = NULL;
+        CELIX_PROPERTIES_FOR_EACH(endpoint, key) {
+            L_WARN("[PSA_SHM] |- %s=%s\n", key, celix_properties_get(endpoint, key, NULL));
+        }
+    } else if (hostId != NULL && strcmp(hostId, psa->hostId) == 0) {
+        pubsub_shmTopicReceiver_connectTo(receiver, ringName);
+    }
+}
+
+static void pubsub_shmAdmin_disconnectEndpointFromReceiver(pubsub_shm_admin_t* psa __attribute__((unused)), pubsub_shm_topic_receiver_t *receiver, const celix_properties_t *endpoint) {
+    //note can be called with discoveredEndpoint.mutex lock
+    const char *ringName = celix_properties_get(endpoint, PUBSUB_SHM_RING_NAME_KEY, NULL);
+    if (ringName != NULL && pubsubEndpoint_matchWithTopicAndScope(endpoint, pubsub_shmTopicReceiver_topic(receiver), pubsub_shmTopicReceiver_scope(receiver))) {
+        pubsub_shmTopicReceiver_disconnectFrom(receiver, ringName);
+    }
+}
+
+celix_status_t pubsub_shmAdmin_addDiscoveredEndpoint(void *handle, const celix_properties_t *endpoint) {
+    pubsub_shm_admin_t *psa = handle;
+
+    const char *type = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TYPE, NULL);
+
+    if (type != NULL && strncmp(PUBSUB_PUBLISHER_ENDPOINT_TYPE, type, strlen(PUBSUB_PUBLISHER_ENDPOINT_TYPE)) == 0) {
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->topicReceivers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            pubsub_shm_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
+            if (pubsubEndpoint_matchWithTopicAndScope(endpoint, pubsub_shmTopicReceiver_topic(receiver), pubsub_shmTopicReceiver_scope(receiver))) {
+                pubsub_shmAdmin_connectEndpointToReceiver(psa, receiver, endpoint);
+            }
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    }
+
+    celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
+    celix_properties_t *cpy = celix_properties_copy(endpoint);
+    const char *uuid = celix_properties_get(cpy, PUBSUB_ENDPOINT_UUID, NULL);
+    hashMap_put(psa->discoveredEndpoints.map, (void*)uuid, cpy);
+    celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+    return CELIX_SUCCESS;
+}
+
+celix_status_t pubsub_shmAdmin_removeDiscoveredEndpoint(void *handle, const celix_properties_t *endpoint) {
+    pubsub_shm_admin_t *psa = handle;
+
+    const char *type = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TYPE, NULL);
+
+    if (type != NULL && strncmp(PUBSUB_PUBLISHER_ENDPOINT_TYPE, type, strlen(PUBSUB_PUBLISHER_ENDPOINT_TYPE)) == 0) {
+        celixThreadMutex_lock(&psa->topicReceivers.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(psa->topicReceivers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            pubsub_shm_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
+            pubsub_shmAdmin_disconnectEndpointFromReceiver(psa, receiver, endpoint);
+        }
+        celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    }
+
+    celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
+    const char *uuid = celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, NULL);
+    celix_properties_t *found = hashMap_remove(psa->discoveredEndpoints.map, (void*)uuid);
+    celixThreadMutex_unlock(&psa->discoveredEndpoints.mutex);
+
+    if (found != NULL) {
+        celix_properties_destroy(found);
+    }
+
+    return CELIX_SUCCESS;
+}
+
+bool pubsub_shmAdmin_executeCommand(void *handle, const char *commandLine __attribute__((unused)), FILE *out, FILE *errStream __attribute__((unused))) {
+    pubsub_shm_admin_t *psa = handle;
+
+    fprintf(out, "\n");
+    fprintf(out, "Host id: %s\n", psa->hostId);
+    fprintf(out, "\n");
+    fprintf(out, "Topic Senders:\n");
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicSenders.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(psa->topicSenders.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_sender_t *sender = hashMapIterator_nextValue(&iter);
+        long serSvcId = pubsub_shmTopicSender_serializerSvcId(sender);
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serSvcId);
+        const char *serType = serEntry == NULL ? "!Error!" : serEntry->serType;
+        const char *scope = pubsub_shmTopicSender_scope(sender);
+        const char *topic = pubsub_shmTopicSender_topic(sender);
+        fprintf(out, "|- Topic Sender %s/%s\n", scope == NULL ? "(null)" : scope, topic);
+        fprintf(out, "   |- serializer type = %s\n", serType);
+        fprintf(out, "   |- ring            = %s\n", pubsub_shmTopicSender_ringName(sender));
+        fprintf(out, "   |- ring size       = %zu\n", pubsub_shmTopicSender_ringSize(sender));
+        fprintf(out, "   |- messages send   = %lu\n", pubsub_shmTopicSender_nrOfMessagesSend(sender));
+    }
+    celixThreadMutex_unlock(&psa->topicSenders.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+
+    fprintf(out, "\n");
+    fprintf(out, "\nTopic Receivers:\n");
+    celixThreadMutex_lock(&psa->serializers.mutex);
+    celixThreadMutex_lock(&psa->topicReceivers.mutex);
+    iter = hashMapIterator_construct(psa->topicReceivers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pubsub_shm_topic_receiver_t *receiver = hashMapIterator_nextValue(&iter);
+        long serSvcId = pubsub_shmTopicReceiver_serializerSvcId(receiver);
+        psa_shm_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serSvcId);
+        const char *serType = serEntry == NULL ? "!Error!" : serEntry->serType;
+        const char *scope = pubsub_shmTopicReceiver_scope(receiver);
+        const char *topic = pubsub_shmTopicReceiver_topic(receiver);
+
+        celix_array_list_t *connections = celix_arrayList_create();
+        pubsub_shmTopicReceiver_listConnections(receiver, connections);
+
+        fprintf(out, "|- Topic Receiver %s/%s\n", scope == NULL ? "(null)" : scope, topic);
+        fprintf(out, "   |- serializer type = %s\n", serType);
+        for (int i = 0; i < celix_arrayList_size(connections); ++i) {
+            char *desc = celix_arrayList_get(connections, i);
+            fprintf(out, "   |- ring            = %s\n", desc);
+            free(desc);
+        }
+        celix_arrayList_destroy(connections);
+    }
+    celixThreadMutex_unlock(&psa->topicReceivers.mutex);
+    celixThreadMutex_unlock(&psa->serializers.mutex);
+    fprintf(out, "\n");
+
+    return true;
+}
@@ -0,0 +1,354 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "pubsub_shm_ring.h"
+
+#define PUBSUB_SHM_RING_MAGIC               0x43534852 //"CSHR"
+#define PUBSUB_SHM_RING_VERSION             2
+#define PUBSUB_SHM_RING_MIN_CAPACITY        4096
+#define PUBSUB_SHM_RING_ALIGNMENT           8
+#define PUBSUB_SHM_RING_CACHE_LINE_SIZE     64
+
+#define PUBSUB_SHM_MSG_FLAG_PADDING         0x1
+
+/**
+ * The control block at the start of the shared memory segment, followed by the data (capacity bytes).
+ * Positions are absolute (never wrapping) byte positions; the offset in the data is position & (capacity - 1).
+ *
+ * The writer first reserves the space of a new record (reservePos), then writes the record and then publishes it
+ * (writePos). Readers read records in place and afterwards check with the reservePos whether the record has been
+ * overwritten while reading (comparable with a seqlock).
+ */
+typedef struct pubsub_shm_ring_control {
+    uint32_t magic; //set last by the creator, a ring is only valid if the magic is set
+    uint32_t version;
+    uint64_t capacity;
+    uint64_t nextSeqNr; //only changed by the writer
+    char pad1[PUBSUB_SHM_RING_CACHE_LINE_SIZE - 24];
+
+    uint64_t reservePos;
+    uint64_t writePos;
+    uint32_t notifySeq; //futex word, incremented for every write
+    char pad2[PUBSUB_SHM_RING_CACHE_LINE_SIZE - 20];
+
+    uint32_t nrOfWaiters; //nr of readers waiting on the futex
+    char pad3[PUBSUB_SHM_RING_CACHE_LINE_SIZE - 4];
+} pubsub_shm_ring_control_t;
+
+struct pubsub_shm_ring {
+    char *name;
+    bool owner;
+    size_t segmentSize;
+    uint64_t capacity;
+    uint64_t mask;
+    pubsub_shm_ring_control_t *control;
+    char *data;
+};
+
+static inline uint64_t pubsub_shmRing_align(uint64_t size) {
+    return (size + PUBSUB_SHM_RING_ALIGNMENT - 1) & ~((uint64_t)PUBSUB_SHM_RING_ALIGNMENT - 1);
+}
+
+static void pubsub_shmRing_futexWait(uint32_t *addr, uint32_t val, int timeoutInMs) {
+#if defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = timeoutInMs / 1000;
+    ts.tv_nsec = (timeoutInMs % 1000) * 1000000L;
+    syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else
+    //no process shared futex, poll instead
+    (void)addr;
+    (void)val;
+    usleep(timeoutInMs < 1 ? 0 : 1000);
+#endif
+}
+
+static void pubsub_shmRing_futexWake(uint32_t *addr) {
+#if defined(__linux__)
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)addr;
+#endif
+}
+
+static pubsub_shm_ring_t* pubsub_shmRing_map(const char *name, int fd, size_t segmentSize, bool owner) {
+    void *addr = mmap(NULL, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        return NULL;
+    }
+    pubsub_shm_ring_t *ring = calloc(1, sizeof(*ring));
+    ring->name = strndup(name, 1024);
+    ring->owner = owner;
+    ring->segmentSize = segmentSize;
+    ring->control = addr;
+    ring->data = (char*)addr + sizeof(pubsub_shm_ring_control_t);
+    return ring;
+}
+
+pubsub_shm_ring_t* pubsub_shmRing_create(const char *name, size_t capacity) {
+    uint64_t cap = PUBSUB_SHM_RING_MIN_CAPACITY;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+    size_t segmentSize = sizeof(pubsub_shm_ring_control_t) + cap;
+
+    shm_unlink(name); //remove stale ring (e.g. of a crashed process)
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+    pubsub_shm_ring_t *ring = NULL;
+    if (ftruncate(fd, (off_t)segmentSize) == 0) {
+        ring = pubsub_shmRing_map(name, fd, segmentSize, true);
+    }
+    close(fd);
+    if (ring == NULL) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    ring->capacity = cap;
+    ring->mask = cap - 1;
+    ring->control->version = PUBSUB_SHM_RING_VERSION;
+    ring->control->capacity = cap;
+    ring->control->nextSeqNr = 1;
+    __atomic_store_n(&ring->control->magic, PUBSUB_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+    return ring;
+}
+
+pubsub_shm_ring_t* pubsub_shmRing_open(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    pubsub_shm_ring_t *ring = NULL;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size > sizeof(pubsub_shm_ring_control_t)) {
+        ring = pubsub_shmRing_map(name, fd, (size_t)st.st_size, false);
+    }
+    close(fd);
+
+    if (ring != NULL) {
+        uint32_t magic = __atomic_load_n(&ring->control->magic, __ATOMIC_ACQUIRE);
+        uint64_t cap = ring->control->capacity;
+        bool valid = magic == PUBSUB_SHM_RING_MAGIC &&
+                     ring->control->version == PUBSUB_SHM_RING_VERSION &&
+                     cap >= PUBSUB_SHM_RING_MIN_CAPACITY &&
+                     (cap & (cap - 1)) == 0 &&
+                     sizeof(pubsub_shm_ring_control_t) + cap <= ring->segmentSize;
+        if (valid) {
+            ring->capacity = cap;
+            ring->mask = cap - 1;
+        } else {
+            pubsub_shmRing_destroy(ring);
+            ring = NULL;
+        }
+    }
+    return ring;
+}
+
+void pubsub_shmRing_destroy(pubsub_shm_ring_t *ring) {
+    if (ring != NULL) {
+        munmap(ring->control, ring->segmentSize);
+        if (ring->owner) {
+            shm_unlink(ring->name);
+        }
+        free(ring->name);
+        free(ring);
+    }
+}
+
+const char* pubsub_shmRing_name(const pubsub_shm_ring_t *ring) {
+    return ring->name;
+}
+
+size_t pubsub_shmRing_capacity(const pubsub_shm_ring_t *ring) {
+    return ring->capacity;
+}
+
+size_t pubsub_shmRing_maxPayloadSize(const pubsub_shm_ring_t *ring) {
+    //limit a message to a quarter of the ring, so that a reader has some time to read it
+    return ring->capacity / 4 - sizeof(pubsub_shm_msg_header_t);
+}
+
+celix_status_t pubsub_shmRing_write(pubsub_shm_ring_t *ring, unsigned int msgTypeId, uint8_t major, uint8_t minor, const struct iovec *payload, size_t payloadLen, const void *metadata, size_t metadataSize) {
+    size_t payloadSize = 0;
+    for (size_t i = 0; i < payloadLen; ++i) {
+        payloadSize += payload[i].iov_len;
+    }
+    if (!ring->owner || payloadSize + metadataSize > pubsub_shmRing_maxPayloadSize(ring)) {
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    pubsub_shm_ring_control_t *control = ring->control;
+    uint64_t writePos = control->writePos; //only changed by this writer
+    uint64_t recordSize = pubsub_shmRing_align(sizeof(pubsub_shm_msg_header_t) + payloadSize + metadataSize);
+    uint64_t offset = writePos & ring->mask;
+    uint64_t remaining = ring->capacity - offset;
+    uint64_t paddingSize = remaining < recordSize ? remaining : 0;
+
+    //1) reserve, the reserve position must be visible before the data is (over)written.
+    __atomic_store_n(&control->reservePos, writePos + paddingSize + recordSize, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    //2) write the record (and if needed a padding record to skip the end of the data)
+    if (paddingSize >= sizeof(pubsub_shm_msg_header_t)) {
+        pubsub_shm_msg_header_t padding;
+        memset(&padding, 0, sizeof(padding));
+        padding.size = (uint32_t)paddingSize;
+        padding.flags = PUBSUB_SHM_MSG_FLAG_PADDING;
+        memcpy(ring->data + offset, &padding, sizeof(padding));
+    } //note a smaller padding is implicit; readers skip the end of the data if no header fits.
+    offset = (writePos + paddingSize) & ring->mask;
+
+    pubsub_shm_msg_header_t hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.seqNr = control->nextSeqNr;
+    __atomic_store_n(&control->nextSeqNr, hdr.seqNr + 1, __ATOMIC_RELAXED);
+    hdr.size = (uint32_t)recordSize;
+    hdr.payloadSize = (uint32_t)payloadSize;
+    hdr.msgTypeId = msgTypeId;
+    hdr.major = major;
+    hdr.minor = minor;
+    hdr.metadataSize = (uint32_t)metadataSize;
+    memcpy(ring->data + offset, &hdr, sizeof(hdr));
+    char *dst = ring->data + offset + sizeof(hdr);
+    for (size_t i = 0; i < payloadLen; ++i) {
+        memcpy(dst, payload[i].iov_base, payload[i].iov_len);
+        dst += payload[i].iov_len;
+    }
+    if (metadataSize > 0) {
+        memcpy(dst, metadata, metadataSize);
+    }
+
+    //3) publish and notify the waiting readers
+    __atomic_store_n(&control->writePos, writePos + paddingSize + recordSize, __ATOMIC_RELEASE);
+    pubsub_shmRing_wakeupReaders(ring);
+    return CELIX_SUCCESS;
+}
+
+void pubsub_shmRing_wakeupReaders(pubsub_shm_ring_t *ring) {
+    __atomic_add_fetch(&ring->control->notifySeq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring->control->nrOfWaiters, __ATOMIC_SEQ_CST) > 0) {
+        pubsub_shmRing_futexWake(&ring->control->notifySeq);
+    }
+}
+
+void pubsub_shmRing_initReader(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader) {
+    memset(reader, 0, sizeof(*reader));
+    reader->readPos = __atomic_load_n(&ring->control->writePos, __ATOMIC_ACQUIRE);
+    reader->msgPos = reader->readPos;
+    reader->nextSeqNr = __atomic_load_n(&ring->control->nextSeqNr, __ATOMIC_RELAXED);
+}
+
+static bool pubsub_shmRing_isOverwritten(pubsub_shm_ring_t *ring, uint64_t pos) {
+    //note the acquire fence orders the (in place) reads of the record before the load of the reserve position
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t reservePos = __atomic_load_n(&ring->control->reservePos, __ATOMIC_RELAXED);
+    return reservePos - pos > ring->capacity;
+}
+
+static bool pubsub_shmRing_tryRead(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader, const pubsub_shm_msg_header_t **header, const void **payload) {
+    while (true) {
+        uint64_t writePos = __atomic_load_n(&ring->control->writePos, __ATOMIC_ACQUIRE);
+        if (writePos == reader->readPos) {
+            return false;
+        }
+        if (writePos - reader->readPos > ring->capacity) {
+            //overtaken by the writer, continue at the write position. The lost messages are counted with the seq nr.
+            reader->readPos = writePos;
+            continue;
+        }
+
+        uint64_t offset = reader->readPos & ring->mask;
+        uint64_t remaining = ring->capacity - offset;
+        if (remaining < sizeof(pubsub_shm_msg_header_t)) {
+            reader->readPos += remaining; //implicit padding
+            continue;
+        }
+
+        pubsub_shm_msg_header_t hdr;
+        memcpy(&hdr, ring->data + offset, sizeof(hdr));
+        bool sane = hdr.size >= sizeof(hdr) &&
+                    hdr.size <= remaining &&
+                    (hdr.size % PUBSUB_SHM_RING_ALIGNMENT) == 0 &&
+                    (uint64_t)hdr.payloadSize + hdr.metadataSize <= hdr.size - sizeof(hdr);
+        if (pubsub_shmRing_isOverwritten(ring, reader->readPos) || !sane) {
+            reader->readPos = __atomic_load_n(&ring->control->writePos, __ATOMIC_ACQUIRE);
+            continue;
+        }
+        if ((hdr.flags & PUBSUB_SHM_MSG_FLAG_PADDING) != 0) {
+            reader->readPos += hdr.size;
+            continue;
+        }
+
+        if (reader->nextSeqNr != 0 && hdr.seqNr > reader->nextSeqNr) {
+            reader->nrOfMessagesLost += hdr.seqNr - reader->nextSeqNr;
+        }
+        reader->nextSeqNr = hdr.seqNr + 1;
+        reader->msgPos = reader->readPos;
+        reader->msgValid = true;
+        reader->readPos += hdr.size;
+        reader->nrOfMessagesRead += 1;
+        reader->header = hdr;
+        *header = &reader->header;
+        *payload = ring->data + offset + sizeof(hdr);
+        return true;
+    }
+}
+
+bool pubsub_shmRing_read(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader, int timeoutInMs, const pubsub_shm_msg_header_t **header, const void **payload) {
+    uint32_t seq = __atomic_load_n(&ring->control->notifySeq, __ATOMIC_SEQ_CST);
+    if (pubsub_shmRing_tryRead(ring, reader, header, payload)) {
+        return true;
+    }
+    if (timeoutInMs > 0) {
+        __atomic_add_fetch(&ring->control->nrOfWaiters, 1, __ATOMIC_SEQ_CST);
+        pubsub_shmRing_futexWait(&ring->control->notifySeq, seq, timeoutInMs);
+        __atomic_sub_fetch(&ring->control->nrOfWaiters, 1, __ATOMIC_SEQ_CST);
+        return pubsub_shmRing_tryRead(ring, reader, header, payload);
+    }
+    return false;
+}
+
+bool pubsub_shmRing_isValid(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader) {
+    if (!reader->msgValid) {
+        return false;
+    }
+    bool valid = !pubsub_shmRing_isOverwritten(ring, reader->msgPos);
+    if (!valid) {
+        reader->msgValid = false;
+        reader->nrOfMessagesRead -= 1;
+        reader->nrOfMessagesLost += 1;
+    }
+    return valid;
+}
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SHM_RING_H
+#define CELIX_PUBSUB_SHM_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+
+#include "celix_errno.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A single producer, multiple consumer ring buffer in POSIX shared memory.
+ *
+ * The writer (the process creating the ring) writes every message once and all readers (in any process on the same
+ * host) read the messages in place. Readers do not hold back the writer; a reader which is overtaken by the writer
+ * skips the overwritten messages and counts them as lost.
+ * Readers are woken up with a (process shared) futex.
+ */
+typedef struct pubsub_shm_ring pubsub_shm_ring_t;
+
+typedef struct pubsub_shm_msg_header {
+    uint64_t seqNr;
+    uint32_t size; //size of the record, including header and alignment padding
+    uint32_t payloadSize;
+    uint32_t msgTypeId;
+    uint8_t major;
+    uint8_t minor;
+    uint16_t flags;
+    uint32_t metadataSize; //size of the encoded metadata, stored directly after the payload
+} pubsub_shm_msg_header_t;
+
+typedef struct pubsub_shm_ring_reader {
+    uint64_t readPos;
+    uint64_t msgPos; //position of the last message returned by pubsub_shmRing_read
+    bool msgValid; //false if the last message is detected as overwritten
+    uint64_t nextSeqNr;
+    uint64_t nrOfMessagesRead;
+    uint64_t nrOfMessagesLost;
+    pubsub_shm_msg_header_t header; //copy of the header of the last message returned by pubsub_shmRing_read
+} pubsub_shm_ring_reader_t;
+
+/**
+ * Creates a new shared memory ring with the provided (shm_open) name. An existing (stale) ring with the same name is
+ * removed. The capacity is rounded up to a power of 2. The ring is removed when the creator destroys it.
+ */
+pubsub_shm_ring_t* pubsub_shmRing_create(const char *name, size_t capacity);
+
+/**
+ * Opens an existing shared memory ring created by another process (or the same process).
+ * Returns NULL if the ring does not exist (yet) or is not a valid ring.
+ */
+pubsub_shm_ring_t* pubsub_shmRing_open(const char *name);
+
+void pubsub_shmRing_destroy(pubsub_shm_ring_t *ring);
+
+const char* pubsub_shmRing_name(const pubsub_shm_ring_t *ring);
+size_t pubsub_shmRing_capacity(const pubsub_shm_ring_t *ring);
+
+/**
+ * The max size of the payload and metadata of a single message.
+ */
+size_t pubsub_shmRing_maxPayloadSize(const pubsub_shm_ring_t *ring);
+
+/**
+ * Writes a message with the payload of the provided io vectors and the (optional) encoded metadata and wakes up the
+ * waiting readers. Only the creator of the ring can write and writes must be serialized by the caller.
+ *
+ * @return CELIX_SUCCESS or CELIX_ILLEGAL_ARGUMENT if the payload and metadata are larger than the max payload size.
+ */
+celix_status_t pubsub_shmRing_write(pubsub_shm_ring_t *ring, unsigned int msgTypeId, uint8_t major, uint8_t minor, const struct iovec *payload, size_t payloadLen, const void *metadata, size_t metadataSize);
+
+/**
+ * Initializes a reader at the current write position of the ring; only messages written after this call are read.
+ */
+void pubsub_shmRing_initReader(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader);
+
+/**
+ * Reads the next message. Waits max timeoutInMs if no message is available.
+ * The returned header is a copy owned by the reader. The returned payload points into the shared memory and can be
+ * overwritten by the writer at any time; the metadata (if any, see header->metadataSize) directly follows the payload.
+ * The caller must check with pubsub_shmRing_isValid whether the message was intact after using (e.g. deserializing)
+ * the payload.
+ *
+ * @return true if a message is returned.
+ */
+bool pubsub_shmRing_read(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader, int timeoutInMs, const pubsub_shm_msg_header_t **header, const void **payload);
+
+/**
+ * Returns whether the message returned by the last pubsub_shmRing_read call is not (partially) overwritten.
+ * If not, the message is counted as lost (once).
+ */
+bool pubsub_shmRing_isValid(pubsub_shm_ring_t *ring, pubsub_shm_ring_reader_t *reader);
+
+/**
+ * Wakes up all readers waiting on the ring.
+ */
+void pubsub_shmRing_wakeupReaders(pubsub_shm_ring_t *ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CELIX_PUBSUB_SHM_RING_H
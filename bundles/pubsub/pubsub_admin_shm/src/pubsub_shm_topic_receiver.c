@@ -0,0 +1,490 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <memory.h>
+#include <unistd.h>
+#include <pubsub_serializer.h>
+#include <pubsub/subscriber.h>
+#include <pubsub_constants.h>
+#include <pubsub_endpoint.h>
+#include <celix_log_helper.h>
+#include <pubsub_shared_message.h>
+#include <celix_api.h>
+#include "pubsub_interceptors_handler.h"
+#include "pubsub_shm_topic_receiver.h"
+#include "pubsub_psa_shm_constants.h"
+#include "pubsub_shm_ring.h"
+
+#define RECV_THREAD_TIMEOUT_IN_MS       1000
+#define OPEN_RING_RETRY_INTERVAL_IN_MS  200
+
+#define L_DEBUG(...) \
+    celix_logHelper_log(receiver->logHelper, CELIX_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    celix_logHelper_log(receiver->logHelper, CELIX_LOG_LEVEL_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    celix_logHelper_log(receiver->logHelper, CELIX_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    celix_logHelper_log(receiver->logHelper, CELIX_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+struct pubsub_shm_topic_receiver {
+    celix_bundle_context_t *ctx;
+    celix_log_helper_t *logHelper;
+    long serializerSvcId;
+    pubsub_serializer_service_t *serializer;
+    pubsub_interceptors_handler_t *interceptorsHandler;
+    char *scope;
+    char *topic;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = ring name, value = psa_shm_connection_entry_t*
+    } connections;
+
+    long subscriberTrackerId;
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = bnd id, value = psa_shm_subscriber_entry_t
+        bool allInitialized;
+    } subscribers;
+};
+
+/**
+ * A connection to the ring of a publisher. The ring is opened and read by the thread of the connection,
+ * because a thread can only wait on the futex of a single ring.
+ */
+typedef struct psa_shm_connection_entry {
+    pubsub_shm_topic_receiver_t *receiver;
+    char *ringName;
+    celix_thread_t thread;
+    bool running; //atomic
+    bool connected; //atomic, true if the ring is opened
+
+    pubsub_shm_ring_t *ring; //only used by the connection thread
+    pubsub_shm_ring_reader_t reader; //only used by the connection thread
+    unsigned long nrOfMessagesRead; //atomic copy of the reader stats
+    unsigned long nrOfMessagesLost; //atomic copy of the reader stats
+} psa_shm_connection_entry_t;
+
+typedef struct psa_shm_subscriber_entry {
+    hash_map_t *msgTypes; //map from serializer svc
+    hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
+    hash_map_t *sharedSubscriberServices; //key = service id, value = pubsub_subscriber_t*, subset of subscriberServices using shared messages
+    bool initialized; //true if the init function is called through the receive thread
+} psa_shm_subscriber_entry_t;
+
+static void pubsub_shmTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
+static void pubsub_shmTopicReceiver_removeSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner);
+static void* psa_shm_recvThread(void *data);
+static void psa_shm_processMsg(pubsub_shm_topic_receiver_t *receiver, psa_shm_connection_entry_t *conn, const pubsub_shm_msg_header_t *hdr, const void *payload);
+static void psa_shm_initializeAllSubscribers(pubsub_shm_topic_receiver_t *receiver);
+static void psa_shm_stopConnection(psa_shm_connection_entry_t *conn);
+
+pubsub_shm_topic_receiver_t* pubsub_shmTopicReceiver_create(celix_bundle_context_t *ctx,
+                                                            celix_log_helper_t *logHelper,
+                                                            const char *scope,
+                                                            const char *topic,
+                                                            long serializerSvcId,
+                                                            pubsub_serializer_service_t *serializer) {
+    pubsub_shm_topic_receiver_t *receiver = calloc(1, sizeof(*receiver));
+    receiver->ctx = ctx;
+    receiver->logHelper = logHelper;
+    receiver->serializerSvcId = serializerSvcId;
+    receiver->serializer = serializer;
+    receiver->scope = scope == NULL ? NULL : strndup(scope, 1024 * 1024);
+    receiver->topic = strndup(topic, 1024 * 1024);
+    pubsubInterceptorsHandler_create(ctx, scope, topic, &receiver->interceptorsHandler);
+
+    celixThreadMutex_create(&receiver->subscribers.mutex, NULL);
+    celixThreadMutex_create(&receiver->connections.mutex, NULL);
+    receiver->subscribers.map = hashMap_create(NULL, NULL, NULL, NULL);
+    receiver->subscribers.allInitialized = false;
+    receiver->connections.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+    //track subscribers
+    {
+        int size = snprintf(NULL, 0, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
+        char buf[size+1];
+        snprintf(buf, (size_t)size+1, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, topic);
+        celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+        opts.filter.ignoreServiceLanguage = true;
+        opts.filter.serviceName = PUBSUB_SUBSCRIBER_SERVICE_NAME;
+        opts.filter.filter = buf;
+        opts.callbackHandle = receiver;
+        opts.addWithOwner = pubsub_shmTopicReceiver_addSubscriber;
+        opts.removeWithOwner = pubsub_shmTopicReceiver_removeSubscriber;
+
+        receiver->subscriberTrackerId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    }
+
+    return receiver;
+}
+
+void pubsub_shmTopicReceiver_destroy(pubsub_shm_topic_receiver_t *receiver) {
+    if (receiver != NULL) {
+        celix_bundleContext_stopTracker(receiver->ctx, receiver->subscriberTrackerId);
+
+        celixThreadMutex_lock(&receiver->connections.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(receiver->connections.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_connection_entry_t *conn = hashMapIterator_nextValue(&iter);
+            psa_shm_stopConnection(conn);
+        }
+        celixThreadMutex_unlock(&receiver->connections.mutex);
+        hashMap_destroy(receiver->connections.map, false, false);
+
+        celixThreadMutex_lock(&receiver->subscribers.mutex);
+        iter = hashMapIterator_construct(receiver->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry != NULL) {
+                if (receiver->serializer != NULL && entry->msgTypes != NULL) {
+                    receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+                }
+                hashMap_destroy(entry->subscriberServices, false, false);
+                hashMap_destroy(entry->sharedSubscriberServices, false, false);
+                free(entry);
+            }
+        }
+        celixThreadMutex_unlock(&receiver->subscribers.mutex);
+        hashMap_destroy(receiver->subscribers.map, false, false);
+
+        celixThreadMutex_destroy(&receiver->subscribers.mutex);
+        celixThreadMutex_destroy(&receiver->connections.mutex);
+        pubsubInterceptorsHandler_destroy(receiver->interceptorsHandler);
+
+        free(receiver->scope);
+        free(receiver->topic);
+    }
+    free(receiver);
+}
+
+const char* pubsub_shmTopicReceiver_scope(pubsub_shm_topic_receiver_t *receiver) {
+    return receiver->scope;
+}
+
+const char* pubsub_shmTopicReceiver_topic(pubsub_shm_topic_receiver_t *receiver) {
+    return receiver->topic;
+}
+
+long pubsub_shmTopicReceiver_serializerSvcId(pubsub_shm_topic_receiver_t *receiver) {
+    return receiver->serializerSvcId;
+}
+
+void pubsub_shmTopicReceiver_listConnections(pubsub_shm_topic_receiver_t *receiver, celix_array_list_t *connections) {
+    celixThreadMutex_lock(&receiver->connections.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->connections.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_shm_connection_entry_t *conn = hashMapIterator_nextValue(&iter);
+        char *desc = NULL;
+        asprintf(&desc, "%s (%s, read %lu, lost %lu)", conn->ringName,
+                 __atomic_load_n(&conn->connected, __ATOMIC_RELAXED) ? "connected" : "not connected",
+                 __atomic_load_n(&conn->nrOfMessagesRead, __ATOMIC_RELAXED),
+                 __atomic_load_n(&conn->nrOfMessagesLost, __ATOMIC_RELAXED));
+        celix_arrayList_add(connections, desc);
+    }
+    celixThreadMutex_unlock(&receiver->connections.mutex);
+}
+
+void pubsub_shmTopicReceiver_connectTo(pubsub_shm_topic_receiver_t *receiver, const char *ringName) {
+    L_DEBUG("[PSA_SHM_TR] TopicReceiver %s/%s connect to ring %s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic, ringName);
+
+    celixThreadMutex_lock(&receiver->connections.mutex);
+    psa_shm_connection_entry_t *conn = hashMap_get(receiver->connections.map, ringName);
+    if (conn == NULL) {
+        conn = calloc(1, sizeof(*conn));
+        conn->receiver = receiver;
+        conn->ringName = strndup(ringName, 1024);
+        conn->running = true;
+        hashMap_put(receiver->connections.map, conn->ringName, conn);
+        celixThread_create(&conn->thread, NULL, psa_shm_recvThread, conn);
+    }
+    celixThreadMutex_unlock(&receiver->connections.mutex);
+}
+
+void pubsub_shmTopicReceiver_disconnectFrom(pubsub_shm_topic_receiver_t *receiver, const char *ringName) {
+    L_DEBUG("[PSA_SHM_TR] TopicReceiver %s/%s disconnect from ring %s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic, ringName);
+
+    celixThreadMutex_lock(&receiver->connections.mutex);
+    psa_shm_connection_entry_t *conn = hashMap_remove(receiver->connections.map, ringName);
+    celixThreadMutex_unlock(&receiver->connections.mutex);
+
+    if (conn != NULL) {
+        psa_shm_stopConnection(conn);
+    }
+}
+
+static void psa_shm_stopConnection(psa_shm_connection_entry_t *conn) {
+    __atomic_store_n(&conn->running, false, __ATOMIC_RELEASE);
+    //note the thread wakes up at least every RECV_THREAD_TIMEOUT_IN_MS
+    celixThread_join(conn->thread, NULL);
+    pubsub_shmRing_destroy(conn->ring);
+    free(conn->ringName);
+    free(conn);
+}
+
+static void pubsub_shmTopicReceiver_addSubscriber(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *bnd) {
+    pubsub_shm_topic_receiver_t *receiver = handle;
+
+    long bndId = celix_bundle_getId(bnd);
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1);
+    const char *subScope = celix_properties_get(props, PUBSUB_SUBSCRIBER_SCOPE, NULL);
+    if (receiver->scope == NULL) {
+        if (subScope != NULL) {
+            return;
+        }
+    } else if (subScope != NULL) {
+        if (strncmp(subScope, receiver->scope, strlen(receiver->scope)) != 0) {
+            //not the same scope. ignore
+            return;
+        }
+    } else {
+        //receiver scope is not NULL, but subScope is NULL -> ignore
+        return;
+    }
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_shm_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    bool shared = pubsub_sharedMessage_isSharedSubscriber(svc, props);
+    if (entry != NULL) {
+        hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
+    } else {
+        //new create entry
+        entry = calloc(1, sizeof(*entry));
+        entry->subscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->sharedSubscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->initialized = false;
+        receiver->subscribers.allInitialized = false;
+        hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
+
+        int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
+        if (rc == 0) {
+            hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
+        } else {
+            hashMap_destroy(entry->subscriberServices, false, false);
+            hashMap_destroy(entry->sharedSubscriberServices, false, false);
+            free(entry);
+            L_ERROR("[PSA_SHM_TR] Cannot find serializer for TopicReceiver %s/%s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void pubsub_shmTopicReceiver_removeSubscriber(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props, const celix_bundle_t *bnd) {
+    pubsub_shm_topic_receiver_t *receiver = handle;
+
+    long bndId = celix_bundle_getId(bnd);
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1);
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    psa_shm_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    if (entry != NULL) {
+        hashMap_remove(entry->subscriberServices, (void*)svcId);
+        hashMap_remove(entry->sharedSubscriberServices, (void*)svcId);
+    }
+    if (entry != NULL && hashMap_size(entry->subscriberServices) == 0) {
+        //remove entry
+        hashMap_remove(receiver->subscribers.map, (void*)bndId);
+        int rc = receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
+        if (rc != 0) {
+            L_ERROR("[PSA_SHM_TR] Cannot find serializer for TopicReceiver %s/%s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
+        }
+        hashMap_destroy(entry->subscriberServices, false, false);
+        hashMap_destroy(entry->sharedSubscriberServices, false, false);
+        free(entry);
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
+
+static void* psa_shm_recvThread(void *data) {
+    psa_shm_connection_entry_t *conn = data;
+    pubsub_shm_topic_receiver_t *receiver = conn->receiver;
+
+    while (__atomic_load_n(&conn->running, __ATOMIC_ACQUIRE)) {
+        if (conn->ring == NULL) {
+            conn->ring = pubsub_shmRing_open(conn->ringName);
+            if (conn->ring == NULL) {
+                //ring not (yet) available, retry
+                usleep(OPEN_RING_RETRY_INTERVAL_IN_MS * 1000);
+                continue;
+            }
+            pubsub_shmRing_initReader(conn->ring, &conn->reader);
+            __atomic_store_n(&conn->connected, true, __ATOMIC_RELAXED);
+            L_DEBUG("[PSA_SHM_TR] Connected to ring %s", conn->ringName);
+        }
+
+        psa_shm_initializeAllSubscribers(receiver);
+
+        const pubsub_shm_msg_header_t *hdr = NULL;
+        const void *payload = NULL;
+        if (pubsub_shmRing_read(conn->ring, &conn->reader, RECV_THREAD_TIMEOUT_IN_MS, &hdr, &payload)) {
+            psa_shm_processMsg(receiver, conn, hdr, payload);
+            __atomic_store_n(&conn->nrOfMessagesRead, conn->reader.nrOfMessagesRead, __ATOMIC_RELAXED);
+            __atomic_store_n(&conn->nrOfMessagesLost, conn->reader.nrOfMessagesLost, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+static bool psa_shm_checkVersion(version_pt msgVersion, const pubsub_shm_msg_header_t *hdr) {
+    bool check = false;
+    if (msgVersion != NULL) {
+        int major = 0, minor = 0;
+        version_getMajor(msgVersion, &major);
+        version_getMinor(msgVersion, &minor);
+        if (hdr->major == ((unsigned char) major)) { /* Different major means incompatible */
+            check = (hdr->minor >= ((unsigned char) minor)); /* Compatible only if the provider has a minor equals or greater (means compatible update) */
+        }
+    }
+    return check;
+}
+
+/**
+ * Decodes the metadata (a sequence of null terminated key and value strings) stored after the payload.
+ */
+static celix_properties_t* psa_shm_decodeMetadata(const char *buffer, size_t size) {
+    if (size == 0) {
+        return NULL;
+    }
+    celix_properties_t *metadata = celix_properties_create();
+    const char *key = buffer;
+    const char *end = buffer + size;
+    while (key < end) {
+        const char *keyEnd = memchr(key, '\0', (size_t)(end - key));
+        const char *val = keyEnd == NULL ? NULL : keyEnd + 1;
+        const char *valEnd = val == NULL || val >= end ? NULL : memchr(val, '\0', (size_t)(end - val));
+        if (valEnd == NULL) {
+            break; //incomplete entry
+        }
+        celix_properties_set(metadata, key, val);
+        key = valEnd + 1;
+    }
+    return metadata;
+}
+
+static void psa_shm_processMsg(pubsub_shm_topic_receiver_t *receiver, psa_shm_connection_entry_t *conn, const pubsub_shm_msg_header_t *hdr, const void *payload) {
+    //copy the payload and metadata out of the shared memory and validate the copy once, so that either all subscribers
+    //get the message or (if overwritten by the writer meanwhile) none of them.
+    size_t size = (size_t)hdr->payloadSize + hdr->metadataSize;
+    char *buffer = malloc(size == 0 ? 1 : size);
+    if (buffer == NULL) {
+        L_ERROR("[PSA_SHM_TR] Cannot allocate %zu bytes for message %d", size, hdr->msgTypeId);
+        return;
+    }
+    memcpy(buffer, payload, size);
+    if (!pubsub_shmRing_isValid(conn->ring, &conn->reader)) {
+        //note counted as lost by the ring reader
+        L_DEBUG("[PSA_SHM_TR] Message %d overwritten while reading from ring %s", hdr->msgTypeId, conn->ringName);
+        free(buffer);
+        return;
+    }
+    celix_properties_t *metadata = psa_shm_decodeMetadata(buffer + hdr->payloadSize, hdr->metadataSize);
+    struct iovec deSerializeBuffer;
+    deSerializeBuffer.iov_base = buffer;
+    deSerializeBuffer.iov_len  = hdr->payloadSize;
+
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        psa_shm_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+
+        pubsub_msg_serializer_t *msgSer = NULL;
+        if (entry->msgTypes != NULL) {
+            msgSer = hashMap_get(entry->msgTypes, (void *) (uintptr_t) hdr->msgTypeId);
+        }
+        if (msgSer == NULL) {
+            L_WARN("[PSA_SHM_TR] Serializer not available for message %d.\n", hdr->msgTypeId);
+        } else if (!psa_shm_checkVersion(msgSer->msgVersion, hdr)) {
+            int major = 0, minor = 0;
+            version_getMajor(msgSer->msgVersion, &major);
+            version_getMinor(msgSer->msgVersion, &minor);
+            L_WARN("[PSA_SHM_TR] Version mismatch for primary message '%s' (have %d.%d, received %u.%u). NOT sending any part of the whole message.\n",
+                   msgSer->msgName, major, minor, hdr->major, hdr->minor);
+        } else {
+            void *msgInst = NULL;
+            celix_status_t status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 1, &msgInst);
+            if (status == CELIX_SUCCESS) {
+                bool cont = pubsubInterceptorHandler_invokePreReceive(receiver->interceptorsHandler, msgSer->msgName, hdr->msgTypeId, msgInst, &metadata);
+                if (cont) {
+                    pubsub_shared_message_delivery_t delivery = {
+                            .msgFqn = msgSer->msgName,
+                            .msgId = hdr->msgTypeId,
+                            .metadata = metadata,
+                            .serializerHandle = msgSer->handle,
+                            .deserialize = msgSer->deserialize,
+                            .freeDeserializedMsg = msgSer->freeDeserializeMsg,
+                            .input = &deSerializeBuffer,
+                            .inputIovLen = 1,
+                            .interceptorsHandler = receiver->interceptorsHandler
+                    };
+                    status = pubsub_sharedMessage_deliver(&delivery, entry->subscriberServices, entry->sharedSubscriberServices, msgInst);
+                } else {
+                    msgSer->freeDeserializeMsg(msgSer->handle, msgInst);
+                }
+            }
+            if (status != CELIX_SUCCESS) {
+                L_WARN("[PSA_SHM_TR] Cannot deserialize msgType %s.\n", msgSer->msgName);
+            }
+        }
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+
+    if (metadata != NULL) {
+        celix_properties_destroy(metadata);
+    }
+    free(buffer);
+}
+
+static void psa_shm_initializeAllSubscribers(pubsub_shm_topic_receiver_t *receiver) {
+    celixThreadMutex_lock(&receiver->subscribers.mutex);
+    if (!receiver->subscribers.allInitialized) {
+        bool allInitialized = true;
+        hash_map_iterator_t iter = hashMapIterator_construct(receiver->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (!entry->initialized) {
+                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->subscriberServices);
+                while (hashMapIterator_hasNext(&iter2)) {
+                    pubsub_subscriber_t *svc = hashMapIterator_nextValue(&iter2);
+                    int rc = 0;
+                    if (svc != NULL && svc->init != NULL) {
+                        rc = svc->init(svc->handle);
+                    }
+                    if (rc == 0) {
+                        //note now only initialized on first subscriber entries added.
+                        entry->initialized = true;
+                    } else {
+                        L_WARN("[PSA_SHM_TR] Cannot initialize subscriber svc. Got rc %i", rc);
+                        allInitialized = false;
+                    }
+                }
+            }
+        }
+        receiver->subscribers.allInitialized = allInitialized;
+    }
+    celixThreadMutex_unlock(&receiver->subscribers.mutex);
+}
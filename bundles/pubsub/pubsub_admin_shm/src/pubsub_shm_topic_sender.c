@@ -0,0 +1,358 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <memory.h>
+#include <pubsub_constants.h>
+#include <pubsub/publisher.h>
+#include <utils.h>
+#include <celix_log_helper.h>
+#include "celix_constants.h"
+#include "pubsub_interceptors_handler.h"
+#include "pubsub_shm_topic_sender.h"
+#include "pubsub_psa_shm_constants.h"
+#include "pubsub_shm_ring.h"
+
+#define L_DEBUG(...) \
+    celix_logHelper_log(sender->logHelper, CELIX_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    celix_logHelper_log(sender->logHelper, CELIX_LOG_LEVEL_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    celix_logHelper_log(sender->logHelper, CELIX_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    celix_logHelper_log(sender->logHelper, CELIX_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+struct pubsub_shm_topic_sender {
+    celix_bundle_context_t *ctx;
+    celix_log_helper_t *logHelper;
+    long serializerSvcId;
+    pubsub_serializer_service_t *serializer;
+    pubsub_interceptors_handler_t *interceptorsHandler;
+
+    char *scope;
+    char *topic;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects the ring writes (single writer)
+        pubsub_shm_ring_t *ring;
+        unsigned long nrOfMessagesSend;
+    } ring;
+
+    struct {
+        long svcId;
+        celix_service_factory_t factory;
+    } publisher;
+
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map;  //key = bndId, value = psa_shm_bounded_service_entry_t
+    } boundedServices;
+};
+
+typedef struct psa_shm_send_msg_entry {
+    pubsub_msg_serializer_t *msgSer;
+    uint8_t major;
+    uint8_t minor;
+} psa_shm_send_msg_entry_t;
+
+typedef struct psa_shm_bounded_service_entry {
+    pubsub_shm_topic_sender_t *parent;
+    pubsub_publisher_t service;
+    long bndId;
+    hash_map_t *msgTypes; //key = msg type id, value = pubsub_msg_serializer_t
+    hash_map_t *msgTypeIds; //key = msg name, value = msg type id
+    hash_map_t *msgEntries; //key = msg type id, value = psa_shm_send_msg_entry_t
+    int getCount;
+} psa_shm_bounded_service_entry_t;
+
+static int psa_shm_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId);
+static void* psa_shm_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static void psa_shm_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
+static int psa_shm_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *msg, celix_properties_t *metadata);
+
+pubsub_shm_topic_sender_t* pubsub_shmTopicSender_create(
+        celix_bundle_context_t *ctx,
+        celix_log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        const char *ringName,
+        size_t ringSize,
+        long serializerSvcId,
+        pubsub_serializer_service_t *ser) {
+    pubsub_shm_topic_sender_t *sender = calloc(1, sizeof(*sender));
+    sender->ctx = ctx;
+    sender->logHelper = logHelper;
+    sender->serializerSvcId = serializerSvcId;
+    sender->serializer = ser;
+
+    sender->ring.ring = pubsub_shmRing_create(ringName, ringSize);
+    if (sender->ring.ring == NULL) {
+        L_ERROR("[PSA_SHM_TS] Cannot create shared memory ring %s for topic %s/%s: %s", ringName, scope == NULL ? "(null)" : scope, topic, strerror(errno));
+        free(sender);
+        return NULL;
+    }
+
+    sender->scope = scope == NULL ? NULL : strndup(scope, 1024 * 1024);
+    sender->topic = strndup(topic, 1024 * 1024);
+    pubsubInterceptorsHandler_create(ctx, scope, topic, &sender->interceptorsHandler);
+    celixThreadMutex_create(&sender->ring.mutex, NULL);
+    celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
+    sender->boundedServices.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+    //register publisher services using a service factory
+    {
+        sender->publisher.factory.handle = sender;
+        sender->publisher.factory.getService = psa_shm_getPublisherService;
+        sender->publisher.factory.ungetService = psa_shm_ungetPublisherService;
+
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_PUBLISHER_TOPIC, sender->topic);
+        if (sender->scope != NULL) {
+            celix_properties_set(props, PUBSUB_PUBLISHER_SCOPE, sender->scope);
+        }
+
+        celix_service_registration_options_t opts = CELIX_EMPTY_SERVICE_REGISTRATION_OPTIONS;
+        opts.factory = &sender->publisher.factory;
+        opts.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+        opts.serviceVersion = PUBSUB_PUBLISHER_SERVICE_VERSION;
+        opts.properties = props;
+
+        sender->publisher.svcId = celix_bundleContext_registerServiceWithOptions(ctx, &opts);
+    }
+
+    return sender;
+}
+
+void pubsub_shmTopicSender_destroy(pubsub_shm_topic_sender_t *sender) {
+    if (sender != NULL) {
+        celix_bundleContext_unregisterService(sender->ctx, sender->publisher.svcId);
+
+        celixThreadMutex_lock(&sender->boundedServices.mutex);
+        hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_bounded_service_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry != NULL) {
+                sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
+
+                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->msgEntries);
+                while (hashMapIterator_hasNext(&iter2)) {
+                    psa_shm_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter2);
+                    free(msgEntry);
+                }
+                hashMap_destroy(entry->msgEntries, false, false);
+                hashMap_destroy(entry->msgTypeIds, true, false);
+                free(entry);
+            }
+        }
+        hashMap_destroy(sender->boundedServices.map, false, false);
+        celixThreadMutex_unlock(&sender->boundedServices.mutex);
+        celixThreadMutex_destroy(&sender->boundedServices.mutex);
+
+        pubsub_shmRing_destroy(sender->ring.ring);
+        celixThreadMutex_destroy(&sender->ring.mutex);
+        pubsubInterceptorsHandler_destroy(sender->interceptorsHandler);
+
+        free(sender->scope);
+        free(sender->topic);
+        free(sender);
+    }
+}
+
+long pubsub_shmTopicSender_serializerSvcId(pubsub_shm_topic_sender_t *sender) {
+    return sender->serializerSvcId;
+}
+
+const char* pubsub_shmTopicSender_scope(pubsub_shm_topic_sender_t *sender) {
+    return sender->scope;
+}
+
+const char* pubsub_shmTopicSender_topic(pubsub_shm_topic_sender_t *sender) {
+    return sender->topic;
+}
+
+const char* pubsub_shmTopicSender_ringName(pubsub_shm_topic_sender_t *sender) {
+    return pubsub_shmRing_name(sender->ring.ring);
+}
+
+size_t pubsub_shmTopicSender_ringSize(pubsub_shm_topic_sender_t *sender) {
+    return pubsub_shmRing_capacity(sender->ring.ring);
+}
+
+unsigned long pubsub_shmTopicSender_nrOfMessagesSend(pubsub_shm_topic_sender_t *sender) {
+    celixThreadMutex_lock(&sender->ring.mutex);
+    unsigned long result = sender->ring.nrOfMessagesSend;
+    celixThreadMutex_unlock(&sender->ring.mutex);
+    return result;
+}
+
+static int psa_shm_localMsgTypeIdForMsgType(void* handle, const char* msgType, unsigned int* msgTypeId) {
+    psa_shm_bounded_service_entry_t *entry = (psa_shm_bounded_service_entry_t *) handle;
+    *msgTypeId = (unsigned int)(uintptr_t) hashMap_get(entry->msgTypeIds, msgType);
+    return 0;
+}
+
+static void* psa_shm_getPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    pubsub_shm_topic_sender_t *sender = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    psa_shm_bounded_service_entry_t *entry = hashMap_get(sender->boundedServices.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->getCount += 1;
+    } else {
+        entry = calloc(1, sizeof(*entry));
+        entry->getCount = 1;
+        entry->parent = sender;
+        entry->bndId = bndId;
+        entry->msgEntries = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+
+        int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
+        if (rc == 0) {
+            hash_map_iterator_t iter = hashMapIterator_construct(entry->msgTypes);
+            while (hashMapIterator_hasNext(&iter)) {
+                hash_map_entry_t *hashMapEntry = hashMapIterator_nextEntry(&iter);
+                void *key = hashMapEntry_getKey(hashMapEntry);
+                psa_shm_send_msg_entry_t *sendEntry = calloc(1, sizeof(*sendEntry));
+                sendEntry->msgSer = hashMapEntry_getValue(hashMapEntry);
+                int major;
+                int minor;
+                version_getMajor(sendEntry->msgSer->msgVersion, &major);
+                version_getMinor(sendEntry->msgSer->msgVersion, &minor);
+                sendEntry->major = (uint8_t)major;
+                sendEntry->minor = (uint8_t)minor;
+                hashMap_put(entry->msgEntries, key, sendEntry);
+                hashMap_put(entry->msgTypeIds, strndup(sendEntry->msgSer->msgName, 1024), (void *)(uintptr_t) sendEntry->msgSer->msgId);
+            }
+            entry->service.handle = entry;
+            entry->service.localMsgTypeIdForMsgType = psa_shm_localMsgTypeIdForMsgType;
+            entry->service.send = psa_shm_topicPublicationSend;
+            hashMap_put(sender->boundedServices.map, (void*)bndId, entry);
+        } else {
+            L_ERROR("Error creating serializer map for shm TopicSender %s/%s", sender->scope == NULL ? "(null)" : sender->scope, sender->topic);
+        }
+    }
+    celixThreadMutex_unlock(&sender->boundedServices.mutex);
+
+    return &entry->service;
+}
+
+static void psa_shm_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties __attribute__((unused))) {
+    pubsub_shm_topic_sender_t *sender = handle;
+    long bndId = celix_bundle_getId(requestingBundle);
+
+    celixThreadMutex_lock(&sender->boundedServices.mutex);
+    psa_shm_bounded_service_entry_t *entry = hashMap_get(sender->boundedServices.map, (void*)bndId);
+    if (entry != NULL) {
+        entry->getCount -= 1;
+    }
+    if (entry != NULL && entry->getCount == 0) {
+        //free entry
+        hashMap_remove(sender->boundedServices.map, (void*)bndId);
+        int rc = sender->serializer->destroySerializerMap(sender->serializer->handle, entry->msgTypes);
+        if (rc != 0) {
+            L_ERROR("Error destroying publisher service, serializer not available / cannot get msg serializer map\n");
+        }
+
+        hash_map_iterator_t iter = hashMapIterator_construct(entry->msgEntries);
+        while (hashMapIterator_hasNext(&iter)) {
+            psa_shm_send_msg_entry_t *msgEntry = hashMapIterator_nextValue(&iter);
+            free(msgEntry);
+        }
+        hashMap_destroy(entry->msgEntries, false, false);
+
+        hashMap_destroy(entry->msgTypeIds, true, false);
+        free(entry);
+    }
+    celixThreadMutex_unlock(&sender->boundedServices.mutex);
+}
+
+/**
+ * Encodes the metadata as a sequence of null terminated key and value strings, which is stored after the payload.
+ */
+static char* psa_shm_encodeMetadata(const celix_properties_t *metadata, size_t *size) {
+    size_t len = 0;
+    const char *key;
+    CELIX_PROPERTIES_FOR_EACH(metadata, key) {
+        len += strlen(key) + strlen(celix_properties_get(metadata, key, "")) + 2;
+    }
+    char *buffer = malloc(len);
+    if (buffer != NULL) {
+        char *dst = buffer;
+        CELIX_PROPERTIES_FOR_EACH(metadata, key) {
+            const char *val = celix_properties_get(metadata, key, "");
+            size_t keyLen = strlen(key) + 1;
+            size_t valLen = strlen(val) + 1;
+            memcpy(dst, key, keyLen);
+            memcpy(dst + keyLen, val, valLen);
+            dst += keyLen + valLen;
+        }
+    }
+    *size = buffer == NULL ? 0 : len;
+    return buffer;
+}
+
+static int psa_shm_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *inMsg, celix_properties_t *metadata) {
+    int status = CELIX_SERVICE_EXCEPTION;
+    psa_shm_bounded_service_entry_t *bound = handle;
+    pubsub_shm_topic_sender_t *sender = bound->parent;
+    psa_shm_send_msg_entry_t *entry = hashMap_get(bound->msgEntries, (void *) (uintptr_t) (msgTypeId));
+
+    if (entry != NULL) {
+        size_t serializedOutputLen = 0;
+        struct iovec* serializedOutput = NULL;
+        status = entry->msgSer->serialize(entry->msgSer->handle, inMsg, &serializedOutput, &serializedOutputLen);
+        if (status == CELIX_SUCCESS) {
+            bool cont = pubsubInterceptorHandler_invokePreSend(sender->interceptorsHandler, entry->msgSer->msgName, msgTypeId, inMsg, &metadata);
+            if (cont) {
+                size_t metadataSize = 0;
+                char *encodedMetadata = NULL;
+                if (metadata != NULL && celix_properties_size(metadata) > 0) {
+                    encodedMetadata = psa_shm_encodeMetadata(metadata, &metadataSize);
+                }
+
+                //note the serialized message is written once in the ring and read in place by all subscribers
+                celixThreadMutex_lock(&sender->ring.mutex);
+                status = pubsub_shmRing_write(sender->ring.ring, msgTypeId, entry->major, entry->minor, serializedOutput, serializedOutputLen, encodedMetadata, metadataSize);
+                if (status == CELIX_SUCCESS) {
+                    sender->ring.nrOfMessagesSend += 1;
+                }
+                celixThreadMutex_unlock(&sender->ring.mutex);
+                if (status != CELIX_SUCCESS) {
+                    L_WARN("[PSA_SHM_TS] Error sending message of type %s for scope/topic %s/%s, message and metadata larger than the max message size (%zu bytes)",
+                           entry->msgSer->msgName, sender->scope == NULL ? "(null)" : sender->scope, sender->topic, pubsub_shmRing_maxPayloadSize(sender->ring.ring));
+                }
+                free(encodedMetadata);
+                pubsubInterceptorHandler_invokePostSend(sender->interceptorsHandler, entry->msgSer->msgName, msgTypeId, inMsg, metadata);
+            }
+            entry->msgSer->freeSerializeMsg(entry->msgSer->handle, serializedOutput, serializedOutputLen);
+        } else {
+            L_WARN("[PSA_SHM_TS] Error serialize message of type %s for scope/topic %s/%s",
+                   entry->msgSer->msgName, sender->scope == NULL ? "(null)" : sender->scope, sender->topic);
+        }
+    } else {
+        L_WARN("[PSA_SHM_TS] Error sending message with msg type id %i for scope/topic %s/%s", msgTypeId, sender->scope == NULL ? "(null)" : sender->scope, sender->topic);
+    }
+
+    if (metadata != NULL) {
+        celix_properties_destroy(metadata);
+    }
+    return status;
+}
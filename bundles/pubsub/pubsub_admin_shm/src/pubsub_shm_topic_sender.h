@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SHM_TOPIC_SENDER_H
+#define CELIX_PUBSUB_SHM_TOPIC_SENDER_H
+
+#include "celix_bundle_context.h"
+#include "celix_log_helper.h"
+#include "pubsub_serializer.h"
+
+typedef struct pubsub_shm_topic_sender pubsub_shm_topic_sender_t;
+
+pubsub_shm_topic_sender_t* pubsub_shmTopicSender_create(
+        celix_bundle_context_t *ctx,
+        celix_log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        const char *ringName,
+        size_t ringSize,
+        long serializerSvcId,
+        pubsub_serializer_service_t *ser);
+void pubsub_shmTopicSender_destroy(pubsub_shm_topic_sender_t *sender);
+
+const char* pubsub_shmTopicSender_scope(pubsub_shm_topic_sender_t *sender);
+const char* pubsub_shmTopicSender_topic(pubsub_shm_topic_sender_t *sender);
+const char* pubsub_shmTopicSender_ringName(pubsub_shm_topic_sender_t *sender);
+size_t pubsub_shmTopicSender_ringSize(pubsub_shm_topic_sender_t *sender);
+unsigned long pubsub_shmTopicSender_nrOfMessagesSend(pubsub_shm_topic_sender_t *sender);
+long pubsub_shmTopicSender_serializerSvcId(pubsub_shm_topic_sender_t *sender);
+
+#endif //CELIX_PUBSUB_SHM_TOPIC_SENDER_H
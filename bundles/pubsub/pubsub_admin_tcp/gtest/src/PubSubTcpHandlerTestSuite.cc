@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <celix_api.h>
+#include "celix_log_helper.h"
+#include "pubsub_tcp_handler.h"
+#include "pubsub_wire_v2_protocol_impl.h"
+
+class PubSubTcpHandlerTestSuite : public ::testing::Test {
+public:
+    PubSubTcpHandlerTestSuite() {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".pubsub_tcp_handler_cache");
+        auto* fwPtr = celix_frameworkFactory_createFramework(props);
+        auto* ctxPtr = celix_framework_getFrameworkContext(fwPtr);
+        fw = std::shared_ptr<celix_framework_t>{fwPtr, [](auto* f) {celix_frameworkFactory_destroyFramework(f);}};
+        ctx = std::shared_ptr<celix_bundle_context_t>{ctxPtr, [](auto*){/*nop*/}};
+        logHelper = std::shared_ptr<celix_log_helper_t>{celix_logHelper_create(ctxPtr, "test_pubsub_tcp_handler"), [](auto* l) {celix_logHelper_destroy(l);}};
+
+        pubsubProtocol_wire_v2_create(&wireProtocol);
+        protocolSvc.handle = wireProtocol;
+        protocolSvc.getHeaderSize = pubsubProtocol_wire_v2_getHeaderSize;
+        protocolSvc.getHeaderBufferSize = pubsubProtocol_wire_v2_getHeaderBufferSize;
+        protocolSvc.getSyncHeaderSize = pubsubProtocol_wire_v2_getSyncHeaderSize;
+        protocolSvc.getSyncHeader = pubsubProtocol_wire_v2_getSyncHeader;
+        protocolSvc.getFooterSize = pubsubProtocol_wire_v2_getFooterSize;
+        protocolSvc.isMessageSegmentationSupported = pubsubProtocol_wire_v2_isMessageSegmentationSupported;
+        protocolSvc.encodeHeader = pubsubProtocol_wire_v2_encodeHeader;
+        protocolSvc.encodePayload = pubsubProtocol_wire_v2_encodePayload;
+        protocolSvc.encodeMetadata = pubsubProtocol_wire_v2_encodeMetadata;
+        protocolSvc.encodeFooter = pubsubProtocol_wire_v2_encodeFooter;
+        protocolSvc.decodeHeader = pubsubProtocol_wire_v2_decodeHeader;
+        protocolSvc.decodePayload = pubsubProtocol_wire_v2_decodePayload;
+        protocolSvc.decodeMetadata = pubsubProtocol_wire_v2_decodeMetadata;
+        protocolSvc.decodeFooter = pubsubProtocol_wire_v2_decodeFooter;
+    }
+
+    ~PubSubTcpHandlerTestSuite() override {
+        pubsubProtocol_wire_v2_destroy(wireProtocol);
+    }
+
+    PubSubTcpHandlerTestSuite(PubSubTcpHandlerTestSuite&&) = delete;
+    PubSubTcpHandlerTestSuite(const PubSubTcpHandlerTestSuite&) = delete;
+    PubSubTcpHandlerTestSuite& operator=(PubSubTcpHandlerTestSuite&&) = delete;
+    PubSubTcpHandlerTestSuite& operator=(const PubSubTcpHandlerTestSuite&) = delete;
+
+    struct receiver_state {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<uint32_t> seqNrs{};
+        std::vector<std::string> payloads{};
+        std::vector<std::string> metadataValues{};
+    };
+
+    static void processMsg(void *handle, const pubsub_protocol_message_t *msg, bool * /*release*/, struct timespec * /*receiveTime*/) {
+        auto* state = static_cast<receiver_state*>(handle);
+        {
+            std::lock_guard<std::mutex> lck{state->mutex};
+            state->seqNrs.push_back(msg->header.seqNr);
+            state->payloads.emplace_back(static_cast<const char*>(msg->payload.payload), msg->payload.length);
+            const char* val = msg->metadata.metadata != nullptr ? celix_properties_get(msg->metadata.metadata, "key", "") : "";
+            state->metadataValues.emplace_back(val);
+        }
+        state->cond.notify_all();
+    }
+
+    static void acceptConnection(void *handle, const char * /*url*/) {
+        auto* suite = static_cast<PubSubTcpHandlerTestSuite*>(handle);
+        std::lock_guard<std::mutex> lck{suite->mutex};
+        suite->nrOfAcceptedConnections += 1;
+        suite->cond.notify_all();
+    }
+
+    /**
+     * Creates a sender handler listening on a dynamic port and the provided nr of receiver handlers connected to it.
+     */
+    void setupConnections(size_t nrOfReceivers, size_t sendQueueSize) {
+        sender = pubsub_tcpHandler_create(&protocolSvc, logHelper.get());
+        pubsub_tcpHandler_setTimeout(sender, 100);
+        pubsub_tcpHandler_setSendQueueSize(sender, sendQueueSize);
+        pubsub_tcpHandler_addAcceptConnectionCallback(sender, this, acceptConnection, nullptr);
+        char listenUrl[] = "tcp://127.0.0.1:0";
+        ASSERT_GE(pubsub_tcpHandler_listen(sender, listenUrl), 0);
+        char* url = pubsub_tcpHandler_get_interface_url(sender);
+        ASSERT_NE(nullptr, url);
+
+        for (size_t i = 0; i < nrOfReceivers; ++i) {
+            states.emplace_back(new receiver_state{});
+            pubsub_tcpHandler_t* receiver = pubsub_tcpHandler_create(&protocolSvc, logHelper.get());
+            pubsub_tcpHandler_setTimeout(receiver, 100);
+            pubsub_tcpHandler_addMessageHandler(receiver, states.back().get(), processMsg);
+            EXPECT_GE(pubsub_tcpHandler_connect(receiver, url), 0);
+            receivers.push_back(receiver);
+        }
+        free(url);
+
+        std::unique_lock<std::mutex> lck{mutex};
+        ASSERT_TRUE(cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return nrOfAcceptedConnections == nrOfReceivers; }));
+    }
+
+    void teardownConnections() {
+        for (auto* receiver : receivers) {
+            pubsub_tcpHandler_destroy(receiver);
+        }
+        receivers.clear();
+        pubsub_tcpHandler_destroy(sender);
+        sender = nullptr;
+    }
+
+    int write(uint32_t seqNr, const std::string& payload) {
+        pubsub_protocol_message_t message{};
+        message.header.msgId = 42;
+        message.header.seqNr = seqNr;
+        message.metadata.metadata = celix_properties_create();
+        celix_properties_set(message.metadata.metadata, "key", std::to_string(seqNr).c_str());
+        struct iovec iov{};
+        iov.iov_base = (void*)payload.c_str();
+        iov.iov_len = payload.size();
+        message.payload.payload = iov.iov_base;
+        message.payload.length = iov.iov_len;
+        int rc = pubsub_tcpHandler_write(sender, &message, &iov, 1, 0);
+        celix_properties_destroy(message.metadata.metadata);
+        return rc;
+    }
+
+    static bool waitForMessages(receiver_state* state, size_t count) {
+        std::unique_lock<std::mutex> lck{state->mutex};
+        state->cond.wait_for(lck, std::chrono::seconds{10}, [&]{ return state->seqNrs.size() >= count; });
+        return state->seqNrs.size() == count;
+    }
+
+    std::shared_ptr<celix_framework_t> fw{};
+    std::shared_ptr<celix_bundle_context_t> ctx{};
+    std::shared_ptr<celix_log_helper_t> logHelper{};
+    pubsub_protocol_wire_v2_t* wireProtocol{nullptr};
+    pubsub_protocol_service_t protocolSvc{};
+
+    std::mutex mutex{}; //protects nrOfAcceptedConnections
+    std::condition_variable cond{};
+    size_t nrOfAcceptedConnections{0};
+
+    pubsub_tcpHandler_t* sender{nullptr};
+    std::vector<pubsub_tcpHandler_t*> receivers{};
+    std::vector<std::unique_ptr<receiver_state>> states{};
+};
+
+TEST_F(PubSubTcpHandlerTestSuite, EncodeOnceForAllConnections) {
+    setupConnections(3, 0);
+
+    //note the encoded header, metadata and footer are shared by all connections, so every receiver should get
+    //the same message
+    constexpr uint32_t nrOfMessages = 10;
+    for (uint32_t i = 0; i < nrOfMessages; ++i) {
+        EXPECT_GE(write(i, "payload" + std::to_string(i)), 0);
+    }
+
+    for (auto& state : states) {
+        EXPECT_TRUE(waitForMessages(state.get(), nrOfMessages));
+        std::lock_guard<std::mutex> lck{state->mutex};
+        for (uint32_t i = 0; i < state->seqNrs.size(); ++i) {
+            EXPECT_EQ(i, state->seqNrs[i]);
+            EXPECT_EQ("payload" + std::to_string(i), state->payloads[i]);
+            EXPECT_EQ(std::to_string(i), state->metadataValues[i]);
+        }
+    }
+
+    teardownConnections();
+}
+
+TEST_F(PubSubTcpHandlerTestSuite, EncodeOnceWithSendQueue) {
+    setupConnections(2, 16 * 1024 * 1024);
+
+    //note big messages, so that the non blocking writes will not complete and the remaining data is queued
+    //and flushed by the socket thread
+    constexpr uint32_t nrOfMessages = 8;
+    const std::string bigPayload(1024 * 1024, 'x');
+    for (uint32_t i = 0; i < nrOfMessages; ++i) {
+        EXPECT_GE(write(i, bigPayload + std::to_string(i)), 0);
+    }
+
+    for (auto& state : states) {
+        EXPECT_TRUE(waitForMessages(state.get(), nrOfMessages));
+        std::lock_guard<std::mutex> lck{state->mutex};
+        for (uint32_t i = 0; i < state->seqNrs.size(); ++i) {
+            EXPECT_EQ(i, state->seqNrs[i]);
+            EXPECT_EQ(bigPayload + std::to_string(i), state->payloads[i]);
+        }
+    }
+
+    teardownConnections();
+}
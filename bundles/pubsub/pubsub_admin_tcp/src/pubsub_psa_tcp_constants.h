@@ -54,6 +54,38 @@
 #define PUBSUB_TCP_PUBLISHER_RETRY_CNT_KEY      "PUBSUB_TCP_PUBLISHER_RETRY_COUNT"
 #define PUBSUB_TCP_PUBLISHER_RETRY_CNT_DEFAULT  5
 
+/**
+ * The max nr of bytes which can be queued per subscriber connection, if the connection cannot be written
+ * without blocking (e.g. a slow subscriber). If the queue is full, sending the message to that subscriber fails.
+ * If 0 the publisher writes blocking (see PUBSUB_TCP_PUBLISHER_SEND_TIMEOUT).
+ */
+#define PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_KEY     "PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE"
+#define PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_DEFAULT (4 * 1024 * 1024)
+
+/**
+ * If true the publisher only serializes the message and queues it. A sender thread writes the queued messages in
+ * batches to the subscribers.
+ * Can be set in the topic properties.
+ */
+#define PUBSUB_TCP_PUBLISHER_ASYNC_SEND_KEY             "PUBSUB_TCP_PUBLISHER_ASYNC_SEND"
+#define PUBSUB_TCP_PUBLISHER_ASYNC_SEND_DEFAULT         false
+
+/**
+ * The max nr of messages queued for the async send mode and the max nr of messages written in a single batch.
+ * Can be set in the topic properties.
+ */
+#define PUBSUB_TCP_PUBLISHER_ASYNC_QUEUE_SIZE_KEY       "PUBSUB_TCP_PUBLISHER_ASYNC_QUEUE_SIZE"
+#define PUBSUB_TCP_PUBLISHER_ASYNC_QUEUE_SIZE_DEFAULT   1024
+#define PUBSUB_TCP_PUBLISHER_ASYNC_BATCH_SIZE_KEY       "PUBSUB_TCP_PUBLISHER_ASYNC_BATCH_SIZE"
+#define PUBSUB_TCP_PUBLISHER_ASYNC_BATCH_SIZE_DEFAULT   64
+
+/**
+ * The backpressure policy for the async send mode when the queue is full: block, drop-oldest or drop-newest.
+ * Can be set in the topic properties.
+ */
+#define PUBSUB_TCP_PUBLISHER_ASYNC_BACKPRESSURE_KEY     "PUBSUB_TCP_PUBLISHER_ASYNC_BACKPRESSURE"
+#define PUBSUB_TCP_PUBLISHER_ASYNC_BACKPRESSURE_DEFAULT "block"
+
 #define PUBSUB_TCP_SUBSCRIBER_RETRY_CNT_KEY     "PUBSUB_TCP_SUBSCRIBER_RETRY_COUNT"
 #define PUBSUB_TCP_SUBSCRIBER_RETRY_CNT_DEFAULT 5
 
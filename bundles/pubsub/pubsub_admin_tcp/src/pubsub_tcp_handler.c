@@ -52,6 +52,7 @@
 
 #define MAX_EVENTS   64
 #define MAX_DEFAULT_BUFFER_SIZE 4u
+#define DEFAULT_MAX_SEND_QUEUE_SIZE (4u * 1024u * 1024u)
 
 #if defined(__APPLE__)
 #define MSG_NOSIGNAL (0)
@@ -90,6 +91,15 @@ typedef struct psa_tcp_connection_entry {
     unsigned int metaBufferSize;
     void *metaBuffer;
     unsigned int retryCount;
+
+    celix_thread_mutex_t writeLock; // protects the send queue and retryCount and serializes writes to fd
+    struct {
+        char *buffer;
+        size_t capacity;
+        size_t offset; // pending bytes are buffer[offset..size)
+        size_t size;
+        bool writeEventEnabled; // true if the socket thread is notified when fd is writable
+    } sendQueue;
 } psa_tcp_connection_entry_t;
 
 //
@@ -119,6 +129,7 @@ struct pubsub_tcpHandler {
     unsigned int maxRcvRetryCount;
     double sendTimeout;
     double rcvTimeout;
+    size_t maxSendQueueSize; // max queued bytes per connection, 0 -> blocking writes
     celix_thread_t thread;
     bool running;
 };
@@ -146,6 +157,8 @@ static inline void pubsub_tcpHandler_connectionHandler(pubsub_tcpHandler_t *hand
 
 static inline void pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle);
 
+static inline bool pubsub_tcpHandler_writeHandler(pubsub_tcpHandler_t *handle, int fd);
+
 static void *pubsub_tcpHandler_thread(void *data);
 
 //
@@ -168,6 +181,7 @@ pubsub_tcpHandler_t *pubsub_tcpHandler_create(pubsub_protocol_service_t *protoco
         handle->protocol = protocol;
         handle->bufferSize = MAX_DEFAULT_BUFFER_SIZE;
         handle->maxNofBuffer = 1; // Reserved for future Use;
+        handle->maxSendQueueSize = DEFAULT_MAX_SEND_QUEUE_SIZE;
         celixThreadRwlock_create(&handle->dbLock, 0);
         handle->running = true;
         celixThread_create(&handle->thread, NULL, pubsub_tcpHandler_thread, handle);
@@ -333,6 +347,7 @@ pubsub_tcpHandler_createEntry(pubsub_tcpHandler_t *handle, int fd, char *url, ch
         entry->footerSize = size;
         entry->bufferSize = handle->bufferSize;
         entry->connected = false;
+        celixThreadMutex_create(&entry->writeLock, NULL);
         if (entry->headerBufferSize) {
             entry->headerBuffer = calloc(sizeof(char), entry->headerSize);
         }
@@ -381,6 +396,8 @@ pubsub_tcpHandler_freeEntry(psa_tcp_connection_entry_t *entry) {
             entry->metaBuffer = NULL;
             entry->metaBufferSize = 0;
         }
+        free(entry->sendQueue.buffer);
+        celixThreadMutex_destroy(&entry->writeLock);
         entry->connected = false;
         free(entry);
     }
@@ -744,6 +761,14 @@ void pubsub_tcpHandler_setSendTimeOut(pubsub_tcpHandler_t *handle, double timeou
     }
 }
 
+void pubsub_tcpHandler_setSendQueueSize(pubsub_tcpHandler_t *handle, size_t size) {
+    if (handle != NULL) {
+        celixThreadRwlock_writeLock(&handle->dbLock);
+        handle->maxSendQueueSize = size;
+        celixThreadRwlock_unlock(&handle->dbLock);
+    }
+}
+
 void pubsub_tcpHandler_setReceiveTimeOut(pubsub_tcpHandler_t *handle, double timeout) {
     if (handle != NULL) {
         celixThreadRwlock_writeLock(&handle->dbLock);
@@ -1002,6 +1027,154 @@ int pubsub_tcpHandler_writeSocket(pubsub_tcpHandler_t *handle, psa_tcp_connectio
   if (nbytes <=0)  msgSize = nbytes;
   return msgSize;
 }
+//
+// Skips nbytes of the (partly) written msg iovecs
+//
+static inline void pubsub_tcpHandler_advanceIoVec(struct msghdr *msg, size_t nbytes) {
+    while (nbytes > 0 && msg->msg_iovlen > 0) {
+        if (nbytes < msg->msg_iov->iov_len) {
+            msg->msg_iov->iov_base = (char *) msg->msg_iov->iov_base + nbytes;
+            msg->msg_iov->iov_len -= nbytes;
+            nbytes = 0;
+        } else {
+            nbytes -= msg->msg_iov->iov_len;
+            msg->msg_iov++;
+            msg->msg_iovlen--;
+        }
+    }
+}
+
+//
+// Enable/disable notification of the socket thread when the connection is writable (again)
+//
+static inline void pubsub_tcpHandler_setWriteEvent(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry, bool enable) {
+    if (handle->efd < 0 || entry->sendQueue.writeEventEnabled == enable) {
+        return;
+    }
+#if defined(__APPLE__)
+    struct kevent ev;
+    EV_SET (&ev, entry->fd, EVFILT_WRITE, enable ? EV_ADD | EV_ENABLE : EV_DELETE, 0, 0, 0);
+    int rc = kevent (handle->efd, &ev, 1, NULL, 0, NULL);
+#else
+    struct epoll_event event;
+    bzero(&event, sizeof(event)); // zero the struct
+    event.events = EPOLLIN | EPOLLRDHUP | EPOLLERR | (enable ? EPOLLOUT : 0);
+    event.data.fd = entry->fd;
+    int rc = epoll_ctl(handle->efd, EPOLL_CTL_MOD, entry->fd, &event);
+#endif
+    if (rc < 0) {
+        L_ERROR("[TCP Socket] Cannot update poll event for fd %d: %s\n", entry->fd, strerror(errno));
+    } else {
+        entry->sendQueue.writeEventEnabled = enable;
+    }
+}
+
+//
+// Appends the msg iovecs to the send queue of the connection
+//
+static inline void pubsub_tcpHandler_enqueue(psa_tcp_connection_entry_t *entry, const struct msghdr *msg, size_t size) {
+    if (entry->sendQueue.offset > 0) {
+        size_t pending = entry->sendQueue.size - entry->sendQueue.offset;
+        memmove(entry->sendQueue.buffer, entry->sendQueue.buffer + entry->sendQueue.offset, pending);
+        entry->sendQueue.offset = 0;
+        entry->sendQueue.size = pending;
+    }
+    size_t needed = entry->sendQueue.size + size;
+    if (needed > entry->sendQueue.capacity) {
+        size_t capacity = MAX(needed, entry->sendQueue.capacity * 2);
+        entry->sendQueue.buffer = realloc(entry->sendQueue.buffer, capacity);
+        entry->sendQueue.capacity = capacity;
+    }
+    for (size_t i = 0; i < msg->msg_iovlen; i++) {
+        memcpy(entry->sendQueue.buffer + entry->sendQueue.size, msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        entry->sendQueue.size += msg->msg_iov[i].iov_len;
+    }
+}
+
+//
+// Writes the send queue of the connection, without blocking.
+// Returns -1 on error
+//
+static inline int pubsub_tcpHandler_flushSendQueue(psa_tcp_connection_entry_t *entry) {
+    while (entry->sendQueue.offset < entry->sendQueue.size) {
+        ssize_t nbytes = send(entry->fd, entry->sendQueue.buffer + entry->sendQueue.offset,
+                              entry->sendQueue.size - entry->sendQueue.offset, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (nbytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        entry->sendQueue.offset += nbytes;
+    }
+    entry->sendQueue.offset = 0;
+    entry->sendQueue.size = 0;
+    return 0;
+}
+
+//
+// Writes the (shared) message iovecs to a single connection.
+// If the handle has a send queue, the connection is written without blocking. The part of the message which
+// cannot be written directly is queued and written by the socket thread, so that a slow connection does not
+// stall the other connections.
+//
+static inline long pubsub_tcpHandler_writeConnection(pubsub_tcpHandler_t *handle, psa_tcp_connection_entry_t *entry,
+                                                     const struct iovec *msgIoVec, size_t msg_iov_len, size_t msgSize, int flags) {
+    struct iovec msg_iov[IOV_MAX];
+    struct msghdr msg;
+    memset(&msg, 0x00, sizeof(struct msghdr));
+    memcpy(msg_iov, msgIoVec, msg_iov_len * sizeof(struct iovec));
+    msg.msg_iov = msg_iov;
+    msg.msg_iovlen = msg_iov_len;
+
+    long result = 0;
+    celixThreadMutex_lock(&entry->writeLock);
+    if (handle->maxSendQueueSize == 0) {
+        msg.msg_name = &entry->addr;
+        msg.msg_namelen = entry->len;
+        msg.msg_flags = flags;
+        result = pubsub_tcpHandler_writeSocket(handle, entry, &msg, msgSize, flags);
+    } else if (pubsub_tcpHandler_flushSendQueue(entry) < 0) {
+        result = -1;
+    } else if (entry->sendQueue.size > 0) {
+        // still pending data, keep message order by queueing the complete message
+        if (entry->sendQueue.size - entry->sendQueue.offset + msgSize <= handle->maxSendQueueSize) {
+            pubsub_tcpHandler_enqueue(entry, &msg, msgSize);
+            result = (long) msgSize;
+        } else {
+            errno = ENOBUFS;
+            result = -1;
+        }
+    } else {
+        size_t written = 0;
+        while (written < msgSize) {
+            ssize_t nbytes = sendmsg(entry->fd, &msg, flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (nbytes < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            written += nbytes;
+            pubsub_tcpHandler_advanceIoVec(&msg, nbytes);
+        }
+        if (written == msgSize) {
+            result = (long) msgSize;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // note a partly written message must always be completed
+            pubsub_tcpHandler_enqueue(entry, &msg, msgSize - written);
+            result = (long) msgSize;
+        } else {
+            result = -1;
+        }
+    }
+    if (handle->maxSendQueueSize > 0) {
+        pubsub_tcpHandler_setWriteEvent(handle, entry, entry->sendQueue.size > 0);
+    }
+    celixThreadMutex_unlock(&entry->writeLock);
+    return result;
+}
+
 //
 // Write large data to TCP. .
 //
@@ -1012,116 +1185,109 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
     int connFdCloseQueue[hashMap_size(handle->connection_fd_map)];
     int nofConnToClose = 0;
     if (handle) {
-        hash_map_iterator_t iter = hashMapIterator_construct(handle->connection_fd_map);
-        while (hashMapIterator_hasNext(&iter)) {
-            psa_tcp_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
-            if (!entry->connected) continue;
-            void *payloadData = NULL;
-            size_t payloadSize = 0;
-            if (msg_iov_len == 1) {
-                handle->protocol->encodePayload(handle->protocol->handle, message, &payloadData, &payloadSize);
-            } else {
-                for (size_t i = 0; i < msg_iov_len; i++) {
-                    payloadSize += msgIoVec[i].iov_len;
-                }
-            }
-            message->header.convertEndianess = 0;
-            message->header.payloadSize = payloadSize;
-            message->header.payloadPartSize = payloadSize;
-            message->header.payloadOffset = 0;
-            message->header.isLastSegment = 1;
-
-            void *metadataData = NULL;
-            size_t metadataSize = 0;
-            if (message->metadata.metadata) {
-                metadataData = entry->metaBuffer;
-                handle->protocol->encodeMetadata(handle->protocol->handle, message,
-                                                 &metadataData,
-                                                 &metadataSize);
-                entry->metaBufferSize = metadataSize;
-            }
-            message->header.metadataSize = metadataSize;
-
-            void *footerData = NULL;
-            size_t footerDataSize = 0;
-            if (entry->footerSize) {
-                footerData = entry->footerBuffer;
-                handle->protocol->encodeFooter(handle->protocol->handle, message,
-                                                 &footerData,
-                                                 &footerDataSize);
-                entry->footerSize = footerDataSize;
+        // Encode the message once, the encoded iovecs are shared by all connections
+        void *payloadData = NULL;
+        size_t payloadSize = 0;
+        if (msg_iov_len == 1) {
+            handle->protocol->encodePayload(handle->protocol->handle, message, &payloadData, &payloadSize);
+        } else {
+            for (size_t i = 0; i < msg_iov_len; i++) {
+                payloadSize += msgIoVec[i].iov_len;
             }
+        }
+        message->header.convertEndianess = 0;
+        message->header.payloadSize = payloadSize;
+        message->header.payloadPartSize = payloadSize;
+        message->header.payloadOffset = 0;
+        message->header.isLastSegment = 1;
+
+        void *metadataData = NULL;
+        size_t metadataSize = 0;
+        if (message->metadata.metadata) {
+            handle->protocol->encodeMetadata(handle->protocol->handle, message,
+                                             &metadataData,
+                                             &metadataSize);
+        }
+        message->header.metadataSize = metadataSize;
+
+        void *footerData = NULL;
+        size_t footerDataSize = 0;
+        size_t footerSize = 0;
+        handle->protocol->getFooterSize(handle->protocol->handle, &footerSize);
+        if (footerSize) {
+            handle->protocol->encodeFooter(handle->protocol->handle, message,
+                                           &footerData,
+                                           &footerDataSize);
+        }
 
-            size_t msgSize = 0;
-            struct msghdr msg;
-            struct iovec msg_iov[IOV_MAX];
-            memset(&msg, 0x00, sizeof(struct msghdr));
-            msg.msg_name = &entry->addr;
-            msg.msg_namelen = entry->len;
-            msg.msg_flags = flags;
-            msg.msg_iov = msg_iov;
-
-            // Write generic seralized payload in vector buffer
-            if (payloadSize && payloadData) {
-                msg.msg_iovlen++;
-                msg.msg_iov[msg.msg_iovlen].iov_base = payloadData;
-                msg.msg_iov[msg.msg_iovlen].iov_len = payloadSize;
-                msgSize += msg.msg_iov[msg.msg_iovlen].iov_len;
-            } else {
-                // copy serialized vector into vector buffer
-                for (size_t i = 0; i < MIN(msg_iov_len, IOV_MAX - 2); i++) {
-                    msg.msg_iovlen++;
-                    msg.msg_iov[msg.msg_iovlen].iov_base = msgIoVec[i].iov_base;
-                    msg.msg_iov[msg.msg_iovlen].iov_len = msgIoVec[i].iov_len;
-                    msgSize += msg.msg_iov[msg.msg_iovlen].iov_len;
-                }
-            }
+        size_t msgSize = 0;
+        struct iovec msg_iov[IOV_MAX];
+        size_t msg_iovlen = 1; // msg_iov[0] is reserved for the header
 
-            // Write optional metadata in vector buffer
-            if (metadataSize && metadataData) {
-                msg.msg_iovlen++;
-                msg.msg_iov[msg.msg_iovlen].iov_base = metadataData;
-                msg.msg_iov[msg.msg_iovlen].iov_len = metadataSize;
-                msgSize += msg.msg_iov[msg.msg_iovlen].iov_len;
+        // Write generic seralized payload in vector buffer
+        if (payloadSize && payloadData) {
+            msg_iov[msg_iovlen].iov_base = payloadData;
+            msg_iov[msg_iovlen].iov_len = payloadSize;
+            msgSize += msg_iov[msg_iovlen++].iov_len;
+        } else {
+            // copy serialized vector into vector buffer
+            for (size_t i = 0; i < MIN(msg_iov_len, IOV_MAX - 2); i++) {
+                msg_iov[msg_iovlen].iov_base = msgIoVec[i].iov_base;
+                msg_iov[msg_iovlen].iov_len = msgIoVec[i].iov_len;
+                msgSize += msg_iov[msg_iovlen++].iov_len;
             }
+        }
 
-            // Write optional footerData in vector buffer
-            if (footerData && footerDataSize) {
-                msg.msg_iovlen++;
-                msg.msg_iov[msg.msg_iovlen].iov_base = footerData;
-                msg.msg_iov[msg.msg_iovlen].iov_len = footerDataSize;
-                msgSize += msg.msg_iov[msg.msg_iovlen].iov_len;
-            }
+        // Write optional metadata in vector buffer
+        if (metadataSize && metadataData) {
+            msg_iov[msg_iovlen].iov_base = metadataData;
+            msg_iov[msg_iovlen].iov_len = metadataSize;
+            msgSize += msg_iov[msg_iovlen++].iov_len;
+        }
 
-            void *headerData = NULL;
-            size_t headerSize = 0;
-            // check if header is not part of the payload (=> headerBufferSize = 0)s
-            if (entry->headerBufferSize) {
-              headerData = entry->headerBuffer;
-              // Encode the header, with payload size and metadata size
-              handle->protocol->encodeHeader(handle->protocol->handle, message,
-                                             &headerData,
-                                             &headerSize);
-              entry->headerBufferSize = headerSize;
-            }
-            if (!entry->headerBufferSize) {
-              // Skip header buffer, when header is part of payload;
-              msg.msg_iov = &msg_iov[1];
-            } else if (headerSize && headerData) {
-              // Write header in 1st vector buffer item
-                msg.msg_iov[0].iov_base = headerData;
-                msg.msg_iov[0].iov_len = headerSize;
-                msgSize += msg.msg_iov[0].iov_len;
-                msg.msg_iovlen++;
+        // Write optional footerData in vector buffer
+        if (footerData && footerDataSize) {
+            msg_iov[msg_iovlen].iov_base = footerData;
+            msg_iov[msg_iovlen].iov_len = footerDataSize;
+            msgSize += msg_iov[msg_iovlen++].iov_len;
+        }
+
+        void *headerData = NULL;
+        size_t headerSize = 0;
+        size_t headerBufferSize = 0;
+        handle->protocol->getHeaderBufferSize(handle->protocol->handle, &headerBufferSize);
+        struct iovec *iov = msg_iov;
+        // check if header is not part of the payload (=> headerBufferSize = 0)
+        if (!headerBufferSize) {
+            // Skip header buffer, when header is part of payload;
+            iov = &msg_iov[1];
+            msg_iovlen--;
+        } else {
+            // Encode the header, with payload size and metadata size
+            handle->protocol->encodeHeader(handle->protocol->handle, message,
+                                           &headerData,
+                                           &headerSize);
+            if (headerSize && headerData) {
+                // Write header in 1st vector buffer item
+                msg_iov[0].iov_base = headerData;
+                msg_iov[0].iov_len = headerSize;
+                msgSize += msg_iov[0].iov_len;
             } else {
-              L_ERROR("[TCP Socket] No header buffer is generated");
-              msg.msg_iovlen = 0;
+                L_ERROR("[TCP Socket] No header buffer is generated");
+                msg_iovlen = 0;
             }
-            long int nbytes = pubsub_tcpHandler_writeSocket(handle, entry, &msg, msgSize, flags);
+        }
+
+        hash_map_iterator_t iter = hashMapIterator_construct(handle->connection_fd_map);
+        while (hashMapIterator_hasNext(&iter) && msg_iovlen > 0) {
+            psa_tcp_connection_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (!entry->connected || entry->fd < 0) continue;
+            long int nbytes = pubsub_tcpHandler_writeConnection(handle, entry, iov, msg_iovlen, msgSize, flags);
             //  When a specific socket keeps reporting errors can indicate a subscriber
             //  which is not active anymore, the connection will remain until the retry
             //  counter exceeds the maximum retry count.
             //  Btw, also, SIGSTOP issued by a debugging tool can result in EINTR error.
+            celixThreadMutex_lock(&entry->writeLock);
             if (nbytes == -1) {
                 if (entry->retryCount < handle->maxSendRetryCount) {
                     entry->retryCount++;
@@ -1141,21 +1307,17 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
                     L_ERROR("[TCP Socket] seq: %d MsgSize not correct: %d != %d (%s)\n", message->header.seqNr, msgSize, nbytes,  strerror(errno));
                 }
             }
-            // Release data
-            if (headerData && headerData != entry->headerBuffer) {
-                free(headerData);
-            }
-            // Note: serialized Payload is deleted by serializer
-            if (payloadData && (payloadData != message->payload.payload)) {
-                free(payloadData);
-            }
-            if (metadataData && metadataData != entry->metaBuffer) {
-                free(metadataData);
-            }
-            if (footerData && footerData != entry->footerBuffer) {
-                free(footerData);
-            }
+            celixThreadMutex_unlock(&entry->writeLock);
+        }
+
+        // Release data
+        free(headerData);
+        // Note: serialized Payload is deleted by serializer
+        if (payloadData && (payloadData != message->payload.payload)) {
+            free(payloadData);
         }
+        free(metadataData);
+        free(footerData);
     }
     celixThreadRwlock_unlock(&handle->dbLock);
     //Force close all connections that are queued in a list, done outside of locking handle->dbLock to prevent deadlock
@@ -1165,6 +1327,32 @@ int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle, pubsub_protocol_message
     return result;
 }
 
+//
+// Writes the queued data of a connection, when the socket is writable again (sender)
+// Returns true if the connection is closed.
+//
+static inline
+bool pubsub_tcpHandler_writeHandler(pubsub_tcpHandler_t *handle, int fd) {
+    bool closeConnection = false;
+    celixThreadRwlock_readLock(&handle->dbLock);
+    psa_tcp_connection_entry_t *entry = hashMap_get(handle->connection_fd_map, (void *) (intptr_t) fd);
+    if (entry) {
+        celixThreadMutex_lock(&entry->writeLock);
+        if (pubsub_tcpHandler_flushSendQueue(entry) < 0) {
+            L_ERROR("[TCP Socket] Failed to send queued data (fd: %d), error: %s. Closing connection...", fd, strerror(errno));
+            closeConnection = true;
+        } else {
+            pubsub_tcpHandler_setWriteEvent(handle, entry, entry->sendQueue.size > 0);
+        }
+        celixThreadMutex_unlock(&entry->writeLock);
+    }
+    celixThreadRwlock_unlock(&handle->dbLock);
+    if (closeConnection) {
+        pubsub_tcpHandler_close(handle, fd);
+    }
+    return closeConnection;
+}
+
 //
 // get interface URL
 //
@@ -1286,6 +1474,8 @@ void pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
       if (pendingConnectionEntry) {
         int fd = pubsub_tcpHandler_acceptHandler(handle, pendingConnectionEntry);
         pubsub_tcpHandler_connectionHandler(handle, fd);
+      } else if (events[i].filter == EVFILT_WRITE) {
+        pubsub_tcpHandler_writeHandler(handle, events[i].ident);
       } else if (events[i].filter & EVFILT_READ) {
         int rc = pubsub_tcpHandler_read(handle, events[i].ident);
         if (rc == 0) pubsub_tcpHandler_close(handle, events[i].ident);
@@ -1333,6 +1523,11 @@ void pubsub_tcpHandler_handler(pubsub_tcpHandler_t *handle) {
                 if (events[i].data.fd == entry->fd)
                     pendingConnectionEntry = entry;
             }
+            if (!pendingConnectionEntry && (events[i].events & EPOLLOUT)) {
+                if (pubsub_tcpHandler_writeHandler(handle, events[i].data.fd)) {
+                    continue; //connection closed, the fd is no longer valid for the other events
+                }
+            }
             if (pendingConnectionEntry) {
                int fd = pubsub_tcpHandler_acceptHandler(handle, pendingConnectionEntry);
                pubsub_tcpHandler_connectionHandler(handle, fd);
@@ -37,6 +37,10 @@
 #include "pubsub_utils_url.h"
 #include <pubsub_protocol.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #ifndef MIN
 #define MIN(a, b) ((a<b) ? (a) : (b))
 #endif
@@ -67,6 +71,7 @@ void pubsub_tcpHandler_setSendRetryCnt(pubsub_tcpHandler_t *handle, unsigned int
 void pubsub_tcpHandler_setReceiveRetryCnt(pubsub_tcpHandler_t *handle, unsigned int count);
 void pubsub_tcpHandler_setSendTimeOut(pubsub_tcpHandler_t *handle, double timeout);
 void pubsub_tcpHandler_setReceiveTimeOut(pubsub_tcpHandler_t *handle, double timeout);
+void pubsub_tcpHandler_setSendQueueSize(pubsub_tcpHandler_t *handle, size_t size);
 
 int pubsub_tcpHandler_read(pubsub_tcpHandler_t *handle, int fd);
 int pubsub_tcpHandler_write(pubsub_tcpHandler_t *handle,
@@ -89,4 +94,8 @@ char *pubsub_tcpHandler_get_interface_url(pubsub_tcpHandler_t *handle);
 void pubsub_tcpHandler_setThreadPriority(pubsub_tcpHandler_t *handle, long prio, const char *sched);
 void pubsub_tcpHandler_setThreadName(pubsub_tcpHandler_t *handle, const char *topic, const char *scope);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* _PUBSUB_TCP_BUFFER_HANDLER_H_ */
@@ -38,6 +38,7 @@
 #include <uuid/uuid.h>
 #include <pubsub_admin_metrics.h>
 #include <pubsub_utils.h>
+#include <pubsub_shared_message.h>
 #include <celix_api.h>
 
 #define MAX_EPOLL_EVENTS     16
@@ -115,6 +116,7 @@ typedef struct psa_tcp_subscriber_entry {
     hash_map_t *msgTypes; //map from serializer svc
     hash_map_t *metrics; //key = msg type id, value = hash_map (key = origin uuid, value = psa_tcp_subscriber_metrics_entry_t*
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
+    hash_map_t *sharedSubscriberServices; //key = service id, value = pubsub_subscriber_t*, subset of subscriberServices using shared messages
     bool initialized; //true if the init function is called through the receive thread
 } psa_tcp_subscriber_entry_t;
 
@@ -310,15 +312,16 @@ void pubsub_tcpTopicReceiver_destroy(pubsub_tcp_topic_receiver_t *receiver) {
             if (entry != NULL) {
                 receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
                 hashMap_destroy(entry->subscriberServices, false, false);
-                free(entry);
-            }
+                hashMap_destroy(entry->sharedSubscriberServices, false, false);
 
-            hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
-            while (hashMapIterator_hasNext(&iter2)) {
-                hash_map_t *origins = hashMapIterator_nextValue(&iter2);
-                hashMap_destroy(origins, true, true);
+                hash_map_iterator_t iter2 = hashMapIterator_construct(entry->metrics);
+                while (hashMapIterator_hasNext(&iter2)) {
+                    hash_map_t *origins = hashMapIterator_nextValue(&iter2);
+                    hashMap_destroy(origins, true, true);
+                }
+                hashMap_destroy(entry->metrics, false, false);
+                free(entry);
             }
-            hashMap_destroy(entry->metrics, false, false);
         }
         hashMap_destroy(receiver->subscribers.map, false, false);
 
@@ -455,16 +458,24 @@ static void pubsub_tcpTopicReceiver_addSubscriber(void *handle, void *svc, const
 
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     psa_tcp_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void *) bndId);
+    bool shared = pubsub_sharedMessage_isSharedSubscriber(svc, props);
     if (entry != NULL) {
         hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
     } else {
         //new create entry
         entry = calloc(1, sizeof(*entry));
         entry->subscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->sharedSubscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
         entry->initialized = false;
         receiver->subscribers.allInitialized = false;
 
         hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
 
         int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t *) bnd,
                                                            &entry->msgTypes);
@@ -485,6 +496,8 @@ static void pubsub_tcpTopicReceiver_addSubscriber(void *handle, void *svc, const
             L_ERROR("[PSA_TCP] Cannot create msg serializer map for TopicReceiver %s/%s",
                     receiver->scope == NULL ? "(null)" : receiver->scope,
                     receiver->topic);
+            hashMap_destroy(entry->subscriberServices, false, false);
+            hashMap_destroy(entry->sharedSubscriberServices, false, false);
             free(entry);
         }
     }
@@ -503,6 +516,7 @@ static void pubsub_tcpTopicReceiver_removeSubscriber(void *handle, void *svc, co
     psa_tcp_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void *) bndId);
     if (entry != NULL) {
         hashMap_remove(entry->subscriberServices, (void*)svcId);
+        hashMap_remove(entry->sharedSubscriberServices, (void*)svcId);
     }
     if (entry != NULL && hashMap_size(entry->subscriberServices) == 0) {
         //remove entry
@@ -520,6 +534,7 @@ static void pubsub_tcpTopicReceiver_removeSubscriber(void *handle, void *svc, co
         }
         hashMap_destroy(entry->metrics, false, false);
         hashMap_destroy(entry->subscriberServices, false, false);
+        hashMap_destroy(entry->sharedSubscriberServices, false, false);
         free(entry);
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
@@ -559,29 +574,20 @@ processMsgForSubscriberEntry(pubsub_tcp_topic_receiver_t *receiver, psa_tcp_subs
             }
 
             if (status == CELIX_SUCCESS) {
-                hash_map_iterator_t iter = hashMapIterator_construct(entry->subscriberServices);
-                bool release = true;
-                while (hashMapIterator_hasNext(&iter)) {
-                    pubsub_subscriber_t *svc = hashMapIterator_nextValue(&iter);
-                    svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deSerializedMsg, message->metadata.metadata,
-                                 &release);
-                    if (!release && hashMapIterator_hasNext(&iter)) {
-                        //receive function has taken ownership and still more receive function to come ..
-                        //deserialize again for new message
-                        status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 1, &deSerializedMsg);
-                        if (status != CELIX_SUCCESS) {
-                            L_WARN("[PSA_TCP_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgSer->msgName,
-                                   receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
-                            break;
-                        }
-                        release = true;
-                    }
-                }
-                if (release) {
-                    msgSer->freeDeserializeMsg(msgSer->handle, deSerializedMsg);
-                }
-                if (message->metadata.metadata) {
-                    celix_properties_destroy(message->metadata.metadata);
+                pubsub_shared_message_delivery_t delivery = {
+                        .msgFqn = msgSer->msgName,
+                        .msgId = msgSer->msgId,
+                        .metadata = message->metadata.metadata,
+                        .serializerHandle = msgSer->handle,
+                        .deserialize = msgSer->deserialize,
+                        .freeDeserializedMsg = msgSer->freeDeserializeMsg,
+                        .input = &deSerializeBuffer,
+                        .inputIovLen = 1
+                };
+                status = pubsub_sharedMessage_deliver(&delivery, entry->subscriberServices, entry->sharedSubscriberServices, deSerializedMsg);
+                if (status != CELIX_SUCCESS) {
+                    L_WARN("[PSA_TCP_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgSer->msgName,
+                           receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
                 }
                 updateReceiveCount += 1;
             } else {
@@ -607,6 +613,10 @@ processMsg(void *handle, const pubsub_protocol_message_t *message, bool *release
         }
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
+    //note the metadata is shared by all subscriber entries
+    if (message->metadata.metadata) {
+        celix_properties_destroy(message->metadata.metadata);
+    }
 }
 
 static void *psa_tcp_recvThread(void *data) {
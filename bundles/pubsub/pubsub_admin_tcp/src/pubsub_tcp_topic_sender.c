@@ -34,11 +34,20 @@
 #include <uuid/uuid.h>
 #include "celix_constants.h"
 #include <signal.h>
+#include <sys/socket.h>
 #include <pubsub_utils.h>
+#include <pubsub_send_queue.h>
 
 #define FIRST_SEND_DELAY_IN_SECONDS              2
 #define TCP_BIND_MAX_RETRY                      10
 
+//Note for async send batches, the socket is corked until the last message of the batch
+#ifdef MSG_MORE
+#define PSA_TCP_BATCH_MSG_FLAGS                 MSG_MORE
+#else
+#define PSA_TCP_BATCH_MSG_FLAGS                 0
+#endif
+
 #define L_DEBUG(...) \
     celix_logHelper_log(sender->logHelper, CELIX_LOG_LEVEL_DEBUG, __VA_ARGS__)
 #define L_INFO(...) \
@@ -76,8 +85,18 @@ struct pubsub_tcp_topic_sender {
         celix_thread_mutex_t mutex;
         hash_map_t *map;  //key = bndId, value = psa_tcp_bounded_service_entry_t
     } boundedServices;
+
+    struct {
+        pubsub_send_queue_t *queue; //entry type = psa_tcp_async_send_msg_t, NULL if async send is disabled
+        size_t batchSize;
+        celix_thread_t thread;
+    } async;
 };
 
+typedef struct psa_tcp_async_send_msg {
+    pubsub_protocol_message_t message; //note message owns the metadata and payload
+} psa_tcp_async_send_msg_t;
+
 typedef struct psa_tcp_send_msg_entry {
     uint32_t type; //msg type id (hash of fqn)
     uint8_t major;
@@ -119,6 +138,10 @@ static void psa_tcp_ungetPublisherService(void *handle, const celix_bundle_t *re
 
 static void delay_first_send_for_late_joiners(pubsub_tcp_topic_sender_t *sender);
 
+static void *psa_tcp_asyncSendThread(void *data);
+
+static void psa_tcp_freeAsyncSendMsg(void *handle, void *msg);
+
 static int
 psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *msg, celix_properties_t *metadata);
 
@@ -206,6 +229,9 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
         pubsub_tcpHandler_setThreadPriority(sender->socketHandler, prio, sched);
         pubsub_tcpHandler_setSendRetryCnt(sender->socketHandler, (unsigned int) retryCnt);
         pubsub_tcpHandler_setSendTimeOut(sender->socketHandler, timeout);
+        long sendQueueSize = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_KEY,
+                                                        PUBSUB_TCP_PUBLISHER_SEND_QUEUE_SIZE_DEFAULT);
+        pubsub_tcpHandler_setSendQueueSize(sender->socketHandler, sendQueueSize > 0 ? (size_t) sendQueueSize : 0);
     }
 
     //setting up tcp socket for TCP TopicSender
@@ -253,6 +279,25 @@ pubsub_tcp_topic_sender_t *pubsub_tcpTopicSender_create(
 
         celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
         sender->boundedServices.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+        bool async = topicProperties == NULL ? PUBSUB_TCP_PUBLISHER_ASYNC_SEND_DEFAULT :
+                     celix_properties_getAsBool(topicProperties, PUBSUB_TCP_PUBLISHER_ASYNC_SEND_KEY, PUBSUB_TCP_PUBLISHER_ASYNC_SEND_DEFAULT);
+        if (async) {
+            long queueSize = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_PUBLISHER_ASYNC_QUEUE_SIZE_KEY,
+                                                        PUBSUB_TCP_PUBLISHER_ASYNC_QUEUE_SIZE_DEFAULT);
+            long batchSize = celix_properties_getAsLong(topicProperties, PUBSUB_TCP_PUBLISHER_ASYNC_BATCH_SIZE_KEY,
+                                                        PUBSUB_TCP_PUBLISHER_ASYNC_BATCH_SIZE_DEFAULT);
+            const char *policy = celix_properties_get(topicProperties, PUBSUB_TCP_PUBLISHER_ASYNC_BACKPRESSURE_KEY,
+                                                      PUBSUB_TCP_PUBLISHER_ASYNC_BACKPRESSURE_DEFAULT);
+            sender->async.batchSize = batchSize > 0 ? (size_t) batchSize : 1;
+            sender->async.queue = pubsub_sendQueue_create(queueSize > 0 ? (size_t) queueSize : PUBSUB_TCP_PUBLISHER_ASYNC_QUEUE_SIZE_DEFAULT,
+                                                          pubsub_sendQueue_parsePolicy(policy, PUBSUB_SEND_QUEUE_BLOCK),
+                                                          sender, psa_tcp_freeAsyncSendMsg);
+            celixThread_create(&sender->async.thread, NULL, psa_tcp_asyncSendThread, sender);
+            char name[64];
+            snprintf(name, 64, "TCP TS %s/%s", scope == NULL ? "(null)" : scope, topic);
+            celixThread_setName(&sender->async.thread, name);
+        }
     }
 
     //register publisher services using a service factory
@@ -289,6 +334,14 @@ void pubsub_tcpTopicSender_destroy(pubsub_tcp_topic_sender_t *sender) {
 
         celix_bundleContext_unregisterService(sender->ctx, sender->publisher.svcId);
 
+        if (sender->async.queue != NULL) {
+            //note the async send thread writes the queued messages before it stops
+            pubsub_sendQueue_close(sender->async.queue);
+            celixThread_join(sender->async.thread, NULL);
+            pubsub_sendQueue_destroy(sender->async.queue);
+            sender->async.queue = NULL;
+        }
+
         celixThreadMutex_lock(&sender->boundedServices.mutex);
         hash_map_iterator_t iter = hashMapIterator_construct(sender->boundedServices.map);
         while (hashMapIterator_hasNext(&iter)) {
@@ -496,9 +549,85 @@ pubsub_admin_sender_metrics_t *pubsub_tcpTopicSender_metrics(pubsub_tcp_topic_se
 
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
     result->nrOfmsgMetrics = (int) count;
+
+    if (sender->async.queue != NULL) {
+        pubsub_send_queue_stats_t stats;
+        pubsub_sendQueue_getStats(sender->async.queue, &stats);
+        result->asyncSendEnabled = true;
+        result->sendQueueCapacity = stats.capacity;
+        result->sendQueueDepth = stats.size;
+        result->maxSendQueueDepth = stats.maxSize;
+        result->nrOfDroppedMessages = stats.nrOfDroppedMessages;
+        result->nrOfSendBatches = stats.nrOfBatches;
+    }
     return result;
 }
 
+static void psa_tcp_freeAsyncSendMsg(void *handle __attribute__((unused)), void *msg) {
+    psa_tcp_async_send_msg_t *asyncMsg = msg;
+    if (asyncMsg->message.metadata.metadata) {
+        celix_properties_destroy(asyncMsg->message.metadata.metadata);
+    }
+    free(asyncMsg->message.payload.payload);
+    free(asyncMsg);
+}
+
+//
+// Queues a copy of the serialized message for the async send thread.
+// On success the ownership of the message metadata is moved to the queue.
+//
+static int psa_tcp_queueMessage(pubsub_tcp_topic_sender_t *sender, pubsub_protocol_message_t *message,
+                                const struct iovec *serializedIoVecOutput, size_t serializedIoVecOutputLen) {
+    psa_tcp_async_send_msg_t *msg = calloc(1, sizeof(*msg));
+    msg->message = *message;
+    size_t size = 0;
+    for (size_t i = 0; i < serializedIoVecOutputLen; ++i) {
+        size += serializedIoVecOutput[i].iov_len;
+    }
+    msg->message.payload.payload = NULL;
+    msg->message.payload.length = size;
+    if (size > 0) {
+        //note a multi iovec payload is written as a single payload, on the wire this is the same
+        char *payload = malloc(size);
+        size_t offset = 0;
+        for (size_t i = 0; i < serializedIoVecOutputLen; ++i) {
+            memcpy(payload + offset, serializedIoVecOutput[i].iov_base, serializedIoVecOutput[i].iov_len);
+            offset += serializedIoVecOutput[i].iov_len;
+        }
+        msg->message.payload.payload = payload;
+    }
+
+    if (pubsub_sendQueue_push(sender->async.queue, msg)) {
+        message->metadata.metadata = NULL;
+        return 0;
+    }
+    //dropped (drop-newest) or closed queue, metadata stays with the caller
+    msg->message.metadata.metadata = NULL;
+    psa_tcp_freeAsyncSendMsg(sender, msg);
+    errno = ENOBUFS;
+    return -1;
+}
+
+static void *psa_tcp_asyncSendThread(void *data) {
+    pubsub_tcp_topic_sender_t *sender = data;
+    void **msgs = calloc(sender->async.batchSize, sizeof(void *));
+    size_t count;
+    while ((count = pubsub_sendQueue_popBatch(sender->async.queue, msgs, sender->async.batchSize)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            psa_tcp_async_send_msg_t *msg = msgs[i];
+            struct iovec payload = {.iov_base = msg->message.payload.payload, .iov_len = msg->message.payload.length};
+            int flags = (i + 1 < count) ? PSA_TCP_BATCH_MSG_FLAGS : 0;
+            int rc = pubsub_tcpHandler_write(sender->socketHandler, &msg->message, &payload, 1, flags);
+            if (rc < 0) {
+                L_WARN("[PSA_TCP_TS] Error sending queued msg. %s", strerror(errno));
+            }
+            psa_tcp_freeAsyncSendMsg(sender, msg);
+        }
+    }
+    free(msgs);
+    return NULL;
+}
+
 static int
 psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *inMsg, celix_properties_t *metadata) {
     int status = CELIX_SUCCESS;
@@ -555,8 +684,13 @@ psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *i
             entry->seqNr++;
             bool sendOk = true;
             {
-                int rc = pubsub_tcpHandler_write(sender->socketHandler, &message, serializedIoVecOutput,
+                int rc;
+                if (sender->async.queue != NULL) {
+                    rc = psa_tcp_queueMessage(sender, &message, serializedIoVecOutput, serializedIoVecOutputLen);
+                } else {
+                    rc = pubsub_tcpHandler_write(sender->socketHandler, &message, serializedIoVecOutput,
                                                  serializedIoVecOutputLen, 0);
+                }
                 if (rc < 0) {
                     status = -1;
                     sendOk = false;
@@ -575,7 +709,10 @@ psa_tcp_topicPublicationSend(void *handle, unsigned int msgTypeId, const void *i
                 sendCountUpdate = 1;
             } else {
                 sendErrorUpdate = 1;
-                L_WARN("[PSA_TCP_TS] Error sending msg. %s", strerror(errno));
+                if (sender->async.queue == NULL) {
+                    //note for async send, dropped messages are part of the sender metrics
+                    L_WARN("[PSA_TCP_TS] Error sending msg. %s", strerror(errno));
+                }
             }
         } else {
             serializationErrorUpdate = 1;
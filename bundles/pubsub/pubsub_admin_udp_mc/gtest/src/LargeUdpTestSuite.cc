@@ -0,0 +1,258 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "large_udp.h"
+
+class LargeUdpTestSuite : public ::testing::Test {
+public:
+    LargeUdpTestSuite() : sendFd{createSocket(&sendAddr)}, proxyFd{createSocket(&proxyAddr)},
+            recvFd{createSocket(&recvAddr)}, sender{largeUdp_create(1)}, receiver{largeUdp_create(4)} {
+        largeUdp_setRetransmitHistory(sender, 4);
+    }
+
+    ~LargeUdpTestSuite() override {
+        largeUdp_destroy(sender);
+        largeUdp_destroy(receiver);
+        close(sendFd);
+        close(proxyFd);
+        close(recvFd);
+    }
+
+    static int createSocket(struct sockaddr_in *addr) {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        EXPECT_GE(fd, 0);
+        int bufSize = 1024 * 1024;
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufSize, sizeof(bufSize));
+        memset(addr, 0, sizeof(*addr));
+        addr->sin_family = AF_INET;
+        addr->sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr->sin_port = 0;
+        EXPECT_EQ(0, bind(fd, (struct sockaddr*)addr, sizeof(*addr)));
+        socklen_t len = sizeof(*addr);
+        EXPECT_EQ(0, getsockname(fd, (struct sockaddr*)addr, &len));
+        return fd;
+    }
+
+    static std::vector<char> createMsg(size_t size) {
+        std::vector<char> msg(size);
+        for (size_t i = 0; i < size; ++i) {
+            msg[i] = (char)(i % 251);
+        }
+        return msg;
+    }
+
+    static bool waitForData(int fd, int timeoutInMs = 100) {
+        struct pollfd pfd{};
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        return poll(&pfd, 1, timeoutInMs) > 0;
+    }
+
+    int send(std::vector<char>& msg, struct sockaddr_in *dest) {
+        struct iovec iov{};
+        iov.iov_base = msg.data();
+        iov.iov_len = msg.size();
+        return largeUdp_sendmsg(sender, sendFd, &iov, 1, 0, dest, sizeof(*dest));
+    }
+
+    /**
+     * Forwards the udp packets received on the proxy socket to the receiver socket, except the packets for which
+     * drop returns true. Returns the nr of received packets.
+     */
+    int forward(const std::function<bool(int)>& drop) {
+        int n = 0;
+        while (waitForData(proxyFd)) {
+            ssize_t len = recv(proxyFd, buf.data(), buf.size(), 0);
+            EXPECT_GT(len, 0);
+            if (!drop(n)) {
+                sendto(proxyFd, buf.data(), (size_t)len, 0, (struct sockaddr*)&recvAddr, sizeof(recvAddr));
+            }
+            ++n;
+        }
+        return n;
+    }
+
+    /**
+     * Forwards a NAK received on the proxy socket to the sender and lets the sender handle it.
+     */
+    void forwardNak() {
+        ASSERT_TRUE(waitForData(proxyFd));
+        ssize_t len = recv(proxyFd, buf.data(), buf.size(), 0);
+        ASSERT_GT(len, 0);
+        sendto(proxyFd, buf.data(), (size_t)len, 0, (struct sockaddr*)&sendAddr, sizeof(sendAddr));
+        ASSERT_TRUE(waitForData(sendFd));
+        largeUdp_handleNaks(sender, sendFd);
+    }
+
+    bool receive() {
+        bool available = false;
+        while (!available && waitForData(recvFd)) {
+            available = largeUdp_dataAvailable(receiver, recvFd);
+        }
+        return available;
+    }
+
+    void expectMsg(const std::vector<char>& expected) {
+        void *data = nullptr;
+        unsigned int size = 0;
+        ASSERT_EQ(0, largeUdp_read(receiver, &data, &size));
+        ASSERT_EQ(expected.size(), size);
+        EXPECT_EQ(0, memcmp(expected.data(), data, size));
+        largeUdp_releaseBuffer(receiver, data);
+    }
+
+    LargeUdpTestSuite(LargeUdpTestSuite&&) = delete;
+    LargeUdpTestSuite(const LargeUdpTestSuite&) = delete;
+    LargeUdpTestSuite& operator=(LargeUdpTestSuite&&) = delete;
+    LargeUdpTestSuite& operator=(const LargeUdpTestSuite&) = delete;
+
+    struct sockaddr_in sendAddr{};
+    struct sockaddr_in proxyAddr{};
+    struct sockaddr_in recvAddr{};
+    int sendFd = -1;
+    int proxyFd = -1;
+    int recvFd = -1;
+    largeUdp_t *sender = nullptr;
+    largeUdp_t *receiver = nullptr;
+    std::vector<char> buf = std::vector<char>(65536);
+};
+
+TEST_F(LargeUdpTestSuite, SendAndReassemble) {
+    auto msg = createMsg(150000); //3 fragments
+    EXPECT_GT(send(msg, &recvAddr), 150000);
+    ASSERT_TRUE(receive());
+    expectMsg(msg);
+
+    //multiple small messages read in a single batch
+    std::vector<std::vector<char>> msgs{};
+    for (int i = 0; i < 5; ++i) {
+        msgs.emplace_back(createMsg(100 + i));
+        send(msgs.back(), &recvAddr);
+    }
+    ASSERT_TRUE(receive());
+    for (auto& m : msgs) {
+        expectMsg(m);
+    }
+
+    largeUdp_metrics_t metrics{};
+    largeUdp_getMetrics(sender, &metrics);
+    EXPECT_EQ(6, metrics.nrOfMessagesSend);
+    EXPECT_EQ(8, metrics.nrOfFragmentsSend);
+    largeUdp_getMetrics(receiver, &metrics);
+    EXPECT_EQ(6, metrics.nrOfMessagesReceived);
+    EXPECT_EQ(0, metrics.nrOfMessagesLost);
+}
+
+TEST_F(LargeUdpTestSuite, RetransmitDroppedFragment) {
+    auto msg = createMsg(150000); //3 fragments
+    send(msg, &proxyAddr);
+    EXPECT_EQ(3, forward([](int n) { return n == 1; }));
+    EXPECT_FALSE(receive());
+
+    //no new fragments -> NAK for the missing fragment
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    EXPECT_GE(largeUdp_checkIncompleteMessages(receiver), 0);
+    forwardNak();
+    EXPECT_EQ(1, forward([](int) { return false; }));
+    ASSERT_TRUE(receive());
+    expectMsg(msg);
+    EXPECT_EQ(-1, largeUdp_checkIncompleteMessages(receiver));
+
+    largeUdp_metrics_t metrics{};
+    largeUdp_getMetrics(sender, &metrics);
+    EXPECT_EQ(1, metrics.nrOfNaksReceived);
+    EXPECT_EQ(1, metrics.nrOfFragmentsRetransmitted);
+    EXPECT_EQ(0, metrics.nrOfUnservedNaks);
+    largeUdp_getMetrics(receiver, &metrics);
+    EXPECT_EQ(1, metrics.nrOfNaksSend);
+    EXPECT_EQ(1, metrics.nrOfMessagesReceived);
+    EXPECT_EQ(0, metrics.nrOfMessagesLost);
+}
+
+TEST_F(LargeUdpTestSuite, DropMessageAfterUnansweredNaks) {
+    auto msg = createMsg(150000); //3 fragments
+    send(msg, &proxyAddr);
+    EXPECT_EQ(3, forward([](int n) { return n == 2; }));
+    EXPECT_FALSE(receive());
+
+    int nextCheck = 0;
+    for (int i = 0; i < 100 && nextCheck >= 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{nextCheck});
+        nextCheck = largeUdp_checkIncompleteMessages(receiver);
+    }
+    EXPECT_EQ(-1, nextCheck);
+
+    largeUdp_metrics_t metrics{};
+    largeUdp_getMetrics(receiver, &metrics);
+    EXPECT_GE(metrics.nrOfNaksSend, 1);
+    EXPECT_EQ(0, metrics.nrOfMessagesReceived);
+    EXPECT_EQ(1, metrics.nrOfMessagesLost);
+    EXPECT_EQ(1, metrics.nrOfFragmentsLost);
+}
+
+TEST_F(LargeUdpTestSuite, PaceSending) {
+    largeUdp_setPacing(sender, 1024 * 1024, 0); //1MB/s, burst of a single udp packet
+    auto msg = createMsg(200000); //3 full fragments and a small one
+    auto start = std::chrono::steady_clock::now();
+    send(msg, &recvAddr);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    //note the first fragment uses the initial burst, the other 2 full fragments are paced (~62ms each)
+    EXPECT_GE(elapsed, std::chrono::milliseconds{100});
+    ASSERT_TRUE(receive());
+    expectMsg(msg);
+}
+
+TEST_F(LargeUdpTestSuite, PaceSmallMessagesByTheirSize) {
+    largeUdp_setPacing(sender, 1024 * 1024, 0); //1MB/s, burst of a single udp packet
+    auto msg = createMsg(1000);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 64; ++i) {
+        send(msg, &recvAddr);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    //~65KB in total, which mostly fits in the burst. Charging a full udp packet per message would take ~4s
+    EXPECT_LT(elapsed, std::chrono::milliseconds{1000});
+}
+
+TEST_F(LargeUdpTestSuite, PacingDoesNotBlockMetrics) {
+    largeUdp_setPacing(sender, 1024 * 1024, 0); //1MB/s, burst of a single udp packet
+    auto msg = createMsg(400000); //~350ms paced
+    std::thread sendThread{[&]{ send(msg, &recvAddr); }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    auto start = std::chrono::steady_clock::now();
+    largeUdp_metrics_t metrics{};
+    largeUdp_getMetrics(sender, &metrics);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    sendThread.join();
+    EXPECT_LT(elapsed, std::chrono::milliseconds{50});
+    largeUdp_getMetrics(sender, &metrics);
+    EXPECT_EQ(1, metrics.nrOfMessagesSend);
+    EXPECT_EQ(7, metrics.nrOfFragmentsSend);
+}
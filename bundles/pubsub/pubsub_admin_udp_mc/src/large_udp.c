@@ -24,14 +24,23 @@
  *  \copyright  Apache License, Version 2.0
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE //sendmmsg / recvmmsg
+#endif
+
 #include "large_udp.h"
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
+#include <time.h>
 #include <array_list.h>
+#include <celix_array_list.h>
+#include <celix_utils.h>
 #include <pthread.h>
 
 #define MAX_UDP_MSG_SIZE        65535 /* 2^16 -1 */
@@ -41,19 +50,75 @@
 #define MTU_SIZE                8000
 #define MAX_MSG_VECTOR_LEN      64
 
+#define SEND_BATCH_SIZE         16 /* max nr of fragments sent with a single sendmmsg call */
+#define RECV_BATCH_SIZE         8  /* max nr of fragments read with a single recvmmsg call */
+#define MAX_RECV_BATCHES        8  /* max nr of recvmmsg calls for a single largeUdp_dataAvailable call */
+#define MAX_NAK_PARTS           64 /* max nr of missing fragments requested with a single NAK */
+#define NAK_INTERVAL_MS         10 /* time without new fragments before missing fragments are requested */
+#define MAX_NR_OF_NAKS          5  /* nr of NAKs sent before an incomplete message is dropped */
+#define NAK_MAGIC               0x4e414b31 /* "NAK1" */
+#define NR_OF_RECENT_IDENTS     64 /* nr of completed messages for which (retransmitted) fragments are ignored */
+#define MIN_POOL_BUFFER_SIZE    4096
+
 //#define NO_IP_FRAGMENTATION
 
+#if defined(__APPLE__)
+struct mmsghdr {
+    struct msghdr msg_hdr;
+    unsigned int msg_len;
+};
+#endif
+
+typedef struct largeUdp_buffer {
+    size_t capacity;
+    char data[];
+} largeUdp_buffer_t;
+
+typedef struct largeUdp_sent_msg {
+    unsigned int msg_ident;
+    unsigned int msg_size;
+    struct sockaddr_in dest_addr;
+    size_t addrlen;
+    size_t capacity;
+    char *data; //copy of the message, NULL if not used yet
+} largeUdp_sent_msg_t;
+
 struct largeUdp {
     unsigned int maxNrLists;
-    array_list_pt udpPartLists;
-    pthread_mutex_t dbLock;
+    array_list_pt udpPartLists; //incomplete messages, oldest first
+    celix_array_list_t *completeLists; //value = udpPartList_t*, complete messages not read yet
+    celix_array_list_t *bufferPool; //value = largeUdp_buffer_t*, reassembly buffers for reuse
+    char *recvBuffers; //RECV_BATCH_SIZE buffers of MAX_UDP_MSG_SIZE, allocated on first use
+    unsigned int recentIdents[NR_OF_RECENT_IDENTS];
+    unsigned int recentIdentsIndex;
+    pthread_mutex_t dbLock; //protects the receive side
+
+    pthread_mutex_t sendLock; //protects the retransmit history and the send side metrics, not held while sending
+    struct {
+        pthread_mutex_t lock; //protects the token bucket, not held while waiting for tokens
+        double rate; //bytes per second, 0 is unpaced
+        double burst;
+        double tokens; //negative if tokens are reserved by senders waiting for the refill
+        struct timespec lastRefill;
+    } pacing;
+    unsigned int historySize;
+    unsigned int historyIndex;
+    largeUdp_sent_msg_t *history;
+
+    largeUdp_metrics_t metrics; //send side protected by sendLock, receive side protected by dbLock
 };
 
 typedef struct udpPartList {
     unsigned int msg_ident;
     unsigned int msg_size;
+    unsigned int nrOfParts;
     unsigned int nrPartsRemaining;
-    char *data;
+    uint64_t *receivedParts; //bitmap of received parts
+    largeUdp_buffer_t *buffer;
+    int fd; //socket the parts are received on, used to send NAKs
+    struct sockaddr_in sender;
+    struct timespec lastPartTime; //time of the last received part or the last sent NAK
+    unsigned int nrOfNaks;
 } udpPartList_t;
 
 
@@ -64,6 +129,16 @@ typedef struct msg_part_header {
     unsigned int offset;
 } msg_part_header_t;
 
+//
+// Negative acknowledgement, sent (unicast) by a receiver to the sender to request missing parts of a message.
+//
+typedef struct largeUdp_nak {
+    unsigned int magic;
+    unsigned int msg_ident;
+    unsigned int nrOfParts;
+    unsigned int parts[MAX_NAK_PARTS]; //only nrOfParts entries are sent
+} largeUdp_nak_t;
+
 #ifdef NO_IP_FRAGMENTATION
 #define MAX_PART_SIZE   (MTU_SIZE - (IP_HEADER_SIZE + UDP_HEADER_SIZE + sizeof(struct msg_part_header) ))
 #else
@@ -81,14 +156,20 @@ largeUdp_t *largeUdp_create(unsigned int maxNrUdpReceptions)
         handle->maxNrLists = maxNrUdpReceptions;
         if (arrayList_create(&handle->udpPartLists) != CELIX_SUCCESS) {
             free(handle);
-            handle = NULL;
+            return NULL;
         }
+        handle->completeLists = celix_arrayList_create();
+        handle->bufferPool = celix_arrayList_create();
         pthread_mutex_init(&handle->dbLock, 0);
+        pthread_mutex_init(&handle->sendLock, 0);
+        pthread_mutex_init(&handle->pacing.lock, 0);
     }
 
     return handle;
 }
 
+static void largeUdp_destroyPartList(largeUdp_t *handle, udpPartList_t *udpPartList);
+
 //
 // Destroys the handle
 //
@@ -100,94 +181,261 @@ void largeUdp_destroy(largeUdp_t *handle)
         int nrUdpLists = arrayList_size(handle->udpPartLists);
         int i;
         for (i=0; i < nrUdpLists; i++) {
-            udpPartList_t *udpPartList = arrayList_remove(handle->udpPartLists, i);
-            if (udpPartList) {
-                if (udpPartList->data) {
-                    free(udpPartList->data);
-                    udpPartList->data = NULL;
-                }
-                free(udpPartList);
-            }
+            largeUdp_destroyPartList(handle, arrayList_get(handle->udpPartLists, i));
         }
         arrayList_destroy(handle->udpPartLists);
         handle->udpPartLists = NULL;
+        for (i = 0; i < celix_arrayList_size(handle->completeLists); i++) {
+            largeUdp_destroyPartList(handle, celix_arrayList_get(handle->completeLists, i));
+        }
+        celix_arrayList_destroy(handle->completeLists);
+        for (i = 0; i < celix_arrayList_size(handle->bufferPool); i++) {
+            free(celix_arrayList_get(handle->bufferPool, i));
+        }
+        celix_arrayList_destroy(handle->bufferPool);
+        free(handle->recvBuffers);
         pthread_mutex_unlock(&handle->dbLock);
         pthread_mutex_destroy(&handle->dbLock);
+
+        for (unsigned int n = 0; n < handle->historySize; n++) {
+            free(handle->history[n].data);
+        }
+        free(handle->history);
+        pthread_mutex_destroy(&handle->sendLock);
+        pthread_mutex_destroy(&handle->pacing.lock);
         free(handle);
     }
 }
 
+void largeUdp_setPacing(largeUdp_t *handle, unsigned long rateInBytesPerSec, unsigned long burstInBytes) {
+    pthread_mutex_lock(&handle->pacing.lock);
+    handle->pacing.rate = (double)rateInBytesPerSec;
+    //the bucket should at least contain a complete udp packet
+    handle->pacing.burst = burstInBytes < MAX_UDP_MSG_SIZE ? MAX_UDP_MSG_SIZE : (double)burstInBytes;
+    handle->pacing.tokens = handle->pacing.burst;
+    clock_gettime(CLOCK_MONOTONIC, &handle->pacing.lastRefill);
+    pthread_mutex_unlock(&handle->pacing.lock);
+}
+
+void largeUdp_setRetransmitHistory(largeUdp_t *handle, unsigned int nrOfMessages) {
+    pthread_mutex_lock(&handle->sendLock);
+    for (unsigned int n = 0; n < handle->historySize; n++) {
+        free(handle->history[n].data);
+    }
+    free(handle->history);
+    handle->history = nrOfMessages > 0 ? calloc(nrOfMessages, sizeof(*handle->history)) : NULL;
+    handle->historySize = nrOfMessages;
+    handle->historyIndex = 0;
+    pthread_mutex_unlock(&handle->sendLock);
+}
+
+void largeUdp_getMetrics(largeUdp_t *handle, largeUdp_metrics_t *metrics) {
+    pthread_mutex_lock(&handle->sendLock);
+    pthread_mutex_lock(&handle->dbLock);
+    *metrics = handle->metrics;
+    pthread_mutex_unlock(&handle->dbLock);
+    pthread_mutex_unlock(&handle->sendLock);
+}
+
+static void largeUdp_refillTokens(largeUdp_t *handle) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    handle->pacing.tokens += celix_difftime(&handle->pacing.lastRefill, &now) * handle->pacing.rate;
+    if (handle->pacing.tokens > handle->pacing.burst) {
+        handle->pacing.tokens = handle->pacing.burst;
+    }
+    handle->pacing.lastRefill = now;
+}
+
 //
-// Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+// Takes tokens from the pacing token bucket for (at most) nrOfParts parts, charging the wire size of each part.
+// At least one part is taken, if the bucket does not contain enough tokens the tokens are reserved (negative bucket)
+// and waitInSeconds is set to the time till the reservation is refilled. The caller should wait that long before
+// sending, without holding a lock. Returns the nr of parts which can be sent.
 //
-int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
-{
-    int n;
-    int result = 0;
-    msg_part_header_t header;
+static unsigned int largeUdp_takeTokens(largeUdp_t *handle, const size_t *partSizes, unsigned int nrOfParts, double *waitInSeconds) {
+    *waitInSeconds = 0.0;
+    pthread_mutex_lock(&handle->pacing.lock);
+    if (handle->pacing.rate <= 0) {
+        pthread_mutex_unlock(&handle->pacing.lock);
+        return nrOfParts;
+    }
+    largeUdp_refillTokens(handle);
+    double cost = (double)partSizes[0];
+    unsigned int nrOfAllowedParts = 1;
+    while (nrOfAllowedParts < nrOfParts && cost + (double)partSizes[nrOfAllowedParts] <= handle->pacing.tokens) {
+        cost += (double)partSizes[nrOfAllowedParts];
+        nrOfAllowedParts += 1;
+    }
+    handle->pacing.tokens -= cost;
+    if (handle->pacing.tokens < 0) {
+        *waitInSeconds = -handle->pacing.tokens / handle->pacing.rate;
+    }
+    pthread_mutex_unlock(&handle->pacing.lock);
+    return nrOfAllowedParts;
+}
+
+//
+// Fills in msg_iovec[1..] with the data of a part from the input iovec in such a way that all UDP frames are filled maximal.
+// msg_iovec[0] is reserved for the header. Returns the iovec length.
+//
+static size_t largeUdp_fillPart(struct iovec *msg_iovec, const struct iovec *largeMsg_iovec, int len, unsigned int offset, unsigned int size) {
+    size_t remainingOffset = offset;
+    int recvPart = 0;
+    // find the start of the part
+    while (recvPart < len && remainingOffset >= largeMsg_iovec[recvPart].iov_len) {
+        remainingOffset -= largeMsg_iovec[recvPart].iov_len;
+        recvPart++;
+    }
+    size_t remainingData = size;
+    size_t sendPart = 1;
+    while (remainingData > 0 && recvPart < len && sendPart < MAX_MSG_VECTOR_LEN) {
+        size_t available = largeMsg_iovec[recvPart].iov_len - remainingOffset;
+        size_t partLen = available <= remainingData ? available : remainingData;
+        msg_iovec[sendPart].iov_base = (char*)largeMsg_iovec[recvPart].iov_base + remainingOffset;
+        msg_iovec[sendPart].iov_len = partLen;
+        remainingData -= partLen;
+        remainingOffset = 0;
+        sendPart++;
+        recvPart++;
+    }
+    return sendPart;
+}
 
+//
+// Sends a batch of udp packets, using sendmmsg if available. Returns the nr of written bytes or -1.
+//
+static int largeUdp_sendBatch(int fd, struct mmsghdr *msgs, unsigned int nrOfMsgs) {
     int written = 0;
-    header.msg_ident = (unsigned int)random();
-    header.total_msg_size = 0;
-    for (n = 0; n < len ;n++) {
-        header.total_msg_size += largeMsg_iovec[n].iov_len;
-    }
-    int nr_buffers = (header.total_msg_size / MAX_PART_SIZE) + 1;
-
-    struct iovec msg_iovec[MAX_MSG_VECTOR_LEN];
-    struct msghdr msg;
-    msg.msg_name = dest_addr;
-    msg.msg_namelen = addrlen;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_iovec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
-
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
-
-    for (n = 0; n < nr_buffers; n++) {
-
-        header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
-        header.offset = n * MAX_PART_SIZE;
-        int remainingOffset = header.offset;
-        int recvPart = 0;
-        // find the start of the part
-        while (remainingOffset > largeMsg_iovec[recvPart].iov_len) {
-            remainingOffset -= largeMsg_iovec[recvPart].iov_len;
-            recvPart++;
-        }
-        int remainingData = header.part_msg_size;
-        int sendPart = 1;
-        msg.msg_iovlen = 1;
-
-        // fill in the output iovec from the input iovec in such a way that all UDP frames are filled maximal.
-        while (remainingData > 0) {
-            int partLen = ( (largeMsg_iovec[recvPart].iov_len - remainingOffset) <= remainingData ? (largeMsg_iovec[recvPart].iov_len -remainingOffset) : remainingData);
-            msg.msg_iov[sendPart].iov_base = largeMsg_iovec[recvPart].iov_base + remainingOffset;
-            msg.msg_iov[sendPart].iov_len = partLen;
-            remainingData -= partLen;
-            remainingOffset = 0;
-            sendPart++;
-            recvPart++;
-            msg.msg_iovlen++;
-        }
-        int tmp, tmptot;
-        for (tmp = 0, tmptot=0; tmp < msg.msg_iovlen; tmp++) {
-            tmptot += msg.msg_iov[tmp].iov_len;
-        }
-
-        int w = sendmsg(fd, &msg, 0);
+    unsigned int sent = 0;
+    while (sent < nrOfMsgs) {
+#if defined(__APPLE__)
+        ssize_t w = sendmsg(fd, &msgs[sent].msg_hdr, 0);
+        if (w == -1) {
+            return -1;
+        }
+        msgs[sent].msg_len = (unsigned int)w;
+        int n = 1;
+#else
+        int n = sendmmsg(fd, &msgs[sent], nrOfMsgs - sent, 0);
+        if (n == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+#endif
+        for (int i = 0; i < n; i++) {
+            written += (int)msgs[sent + i].msg_len;
+        }
+        sent += (unsigned int)n;
+    }
+    return written;
+}
+
+//
+// Sends parts of a message, the parts to send are provided by index. If parts is NULL, the parts 0..nrOfParts-1 are sent.
+// Should be called without the sendLock locked, because pacing can wait.
+//
+static int largeUdp_sendParts(largeUdp_t *handle, int fd, unsigned int msg_ident, const struct iovec *largeMsg_iovec, int len, unsigned int total_msg_size, const unsigned int *parts, unsigned int nrOfParts, struct sockaddr_in *dest_addr, size_t addrlen) {
+    msg_part_header_t headers[SEND_BATCH_SIZE];
+    size_t partSizes[SEND_BATCH_SIZE];
+    struct iovec msg_iovecs[SEND_BATCH_SIZE][MAX_MSG_VECTOR_LEN];
+    struct mmsghdr msgs[SEND_BATCH_SIZE];
+
+    int written = 0;
+    unsigned int n = 0;
+    while (n < nrOfParts) {
+        unsigned int batchSize = nrOfParts - n < SEND_BATCH_SIZE ? nrOfParts - n : SEND_BATCH_SIZE;
+        for (unsigned int i = 0; i < batchSize; i++) {
+            unsigned int part = parts == NULL ? n + i : parts[n + i];
+            msg_part_header_t *header = &headers[i];
+            header->msg_ident = msg_ident;
+            header->total_msg_size = total_msg_size;
+            header->offset = part * MAX_PART_SIZE;
+            header->part_msg_size = (((total_msg_size - header->offset) > MAX_PART_SIZE) ? MAX_PART_SIZE : (total_msg_size - header->offset));
+            partSizes[i] = IP_HEADER_SIZE + UDP_HEADER_SIZE + sizeof(*header) + header->part_msg_size;
+        }
+
+        double waitInSeconds;
+        batchSize = largeUdp_takeTokens(handle, partSizes, batchSize, &waitInSeconds);
+        if (waitInSeconds > 0) {
+            struct timespec wait;
+            wait.tv_sec = (time_t)waitInSeconds;
+            wait.tv_nsec = (long)((waitInSeconds - (double)wait.tv_sec) * 1000000000.0);
+            while (nanosleep(&wait, &wait) == -1 && errno == EINTR) {
+                //continue with the remaining time
+            }
+        }
+
+        memset(msgs, 0, sizeof(msgs));
+        for (unsigned int i = 0; i < batchSize; i++) {
+            msg_part_header_t *header = &headers[i];
+            msg_iovecs[i][0].iov_base = header;
+            msg_iovecs[i][0].iov_len = sizeof(*header);
+            msgs[i].msg_hdr.msg_name = dest_addr;
+            msgs[i].msg_hdr.msg_namelen = addrlen;
+            msgs[i].msg_hdr.msg_iov = msg_iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = largeUdp_fillPart(msg_iovecs[i], largeMsg_iovec, len, header->offset, header->part_msg_size);
+        }
+
+        int w = largeUdp_sendBatch(fd, msgs, batchSize);
         if (w == -1) {
             perror("send()");
-            result =  -1;
-            break;
+            return -1;
         }
         written += w;
+        pthread_mutex_lock(&handle->sendLock);
+        handle->metrics.nrOfFragmentsSend += batchSize;
+        pthread_mutex_unlock(&handle->sendLock);
+        n += batchSize;
     }
+    return written;
+}
 
-    return (result == 0 ? written : result);
+//
+// Write large data to UDP. This function splits the data in chunks and sends these chunks with a header over UDP.
+// The chunks are paced (if configured) and sent in batches. Messages with multiple chunks are kept in the
+// retransmit history (if configured), so that missing chunks can be requested by the receivers.
+//
+int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags __attribute__((unused)), struct sockaddr_in *dest_addr, size_t addrlen)
+{
+    unsigned int total_msg_size = 0;
+    for (int n = 0; n < len; n++) {
+        total_msg_size += largeMsg_iovec[n].iov_len;
+    }
+    unsigned int nr_buffers = (total_msg_size / MAX_PART_SIZE) + 1;
+
+    pthread_mutex_lock(&handle->sendLock);
+    unsigned int msg_ident = (unsigned int)random();
+    if (nr_buffers > 1 && handle->historySize > 0) {
+        largeUdp_sent_msg_t *sent = &handle->history[handle->historyIndex];
+        handle->historyIndex = (handle->historyIndex + 1) % handle->historySize;
+        if (sent->capacity < total_msg_size) {
+            free(sent->data);
+            sent->data = malloc(total_msg_size);
+            sent->capacity = total_msg_size;
+        }
+        size_t offset = 0;
+        for (int n = 0; n < len; n++) {
+            memcpy(sent->data + offset, largeMsg_iovec[n].iov_base, largeMsg_iovec[n].iov_len);
+            offset += largeMsg_iovec[n].iov_len;
+        }
+        sent->msg_ident = msg_ident;
+        sent->msg_size = total_msg_size;
+        sent->dest_addr = *dest_addr;
+        sent->addrlen = addrlen;
+    }
+    pthread_mutex_unlock(&handle->sendLock);
+
+    int written = largeUdp_sendParts(handle, fd, msg_ident, largeMsg_iovec, len, total_msg_size, NULL, nr_buffers, dest_addr, addrlen);
+    if (written >= 0) {
+        pthread_mutex_lock(&handle->sendLock);
+        handle->metrics.nrOfMessagesSend += 1;
+        pthread_mutex_unlock(&handle->sendLock);
+    }
+
+    return written;
 }
 
 //
@@ -195,172 +443,342 @@ int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, i
 //
 int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen)
 {
-    int n;
-    int nr_buffers = (count / MAX_PART_SIZE) + 1;
-    int result = 0;
-    msg_part_header_t header;
+    struct iovec msg_iovec;
+    msg_iovec.iov_base = buf;
+    msg_iovec.iov_len = count;
+    return largeUdp_sendmsg(handle, fd, &msg_iovec, 1, flags, dest_addr, addrlen);
+}
 
-    int written = 0;
-    header.msg_ident = (unsigned int)random();
-    header.total_msg_size = count;
-    char *databuf = buf;
-
-    struct iovec msg_iovec[2];
-    struct msghdr msg;
-    msg.msg_name = dest_addr;
-    msg.msg_namelen = addrlen;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_iovec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
-
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
-
-    for (n = 0; n < nr_buffers; n++) {
-
-        header.part_msg_size = (((header.total_msg_size - n * MAX_PART_SIZE) >  MAX_PART_SIZE) ?  MAX_PART_SIZE  : (header.total_msg_size - n * MAX_PART_SIZE));
-        header.offset = n * MAX_PART_SIZE;
-        msg.msg_iov[1].iov_base = &databuf[header.offset];
-        msg.msg_iov[1].iov_len = header.part_msg_size;
-        int w = sendmsg(fd, &msg, 0);
-        if (w == -1) {
-            perror("send()");
-            result =  -1;
-            break;
+void largeUdp_handleNaks(largeUdp_t *handle, int fd) {
+    largeUdp_nak_t nak;
+    const size_t nakHeaderSize = offsetof(largeUdp_nak_t, parts);
+
+    ssize_t received;
+    while ((received = recv(fd, &nak, sizeof(nak), MSG_DONTWAIT)) >= 0) {
+        if ((size_t)received < nakHeaderSize || nak.magic != NAK_MAGIC || nak.nrOfParts > MAX_NAK_PARTS ||
+                (size_t)received < nakHeaderSize + nak.nrOfParts * sizeof(nak.parts[0])) {
+            continue; //not a NAK
         }
-        written += w;
-        //usleep(1000); // TODO: If not slept a UDP buffer overflow occurs and parts are missing at the reception side (at least via localhost)
+
+        //copy the requested message, the parts are (paced) sent without holding the sendLock
+        pthread_mutex_lock(&handle->sendLock);
+        handle->metrics.nrOfNaksReceived += 1;
+        largeUdp_sent_msg_t *sent = NULL;
+        for (unsigned int i = 0; i < handle->historySize; i++) {
+            if (handle->history[i].data != NULL && handle->history[i].msg_ident == nak.msg_ident) {
+                sent = &handle->history[i];
+                break;
+            }
+        }
+        largeUdp_sent_msg_t copy;
+        memset(&copy, 0, sizeof(copy));
+        if (sent == NULL) {
+            handle->metrics.nrOfUnservedNaks += 1;
+        } else {
+            copy = *sent;
+            copy.data = malloc(sent->msg_size);
+            if (copy.data != NULL) {
+                memcpy(copy.data, sent->data, sent->msg_size);
+            }
+        }
+        pthread_mutex_unlock(&handle->sendLock);
+
+        if (copy.data != NULL) {
+            unsigned int nrOfParts = copy.msg_size / MAX_PART_SIZE + 1;
+            unsigned int parts[MAX_NAK_PARTS];
+            unsigned int nrOfRequested = 0;
+            for (unsigned int i = 0; i < nak.nrOfParts; i++) {
+                if (nak.parts[i] < nrOfParts) {
+                    parts[nrOfRequested++] = nak.parts[i];
+                }
+            }
+            struct iovec msg_iovec;
+            msg_iovec.iov_base = copy.data;
+            msg_iovec.iov_len = copy.msg_size;
+            if (largeUdp_sendParts(handle, fd, copy.msg_ident, &msg_iovec, 1, copy.msg_size, parts, nrOfRequested, &copy.dest_addr, copy.addrlen) >= 0) {
+                pthread_mutex_lock(&handle->sendLock);
+                handle->metrics.nrOfFragmentsRetransmitted += nrOfRequested;
+                pthread_mutex_unlock(&handle->sendLock);
+            }
+            free(copy.data);
+        }
+    }
+}
+
+static largeUdp_buffer_t* largeUdp_takeBuffer(largeUdp_t *handle, size_t size) {
+    for (int i = 0; i < celix_arrayList_size(handle->bufferPool); i++) {
+        largeUdp_buffer_t *buffer = celix_arrayList_get(handle->bufferPool, i);
+        if (buffer->capacity >= size) {
+            celix_arrayList_removeAt(handle->bufferPool, i);
+            return buffer;
+        }
+    }
+    size_t capacity = MIN_POOL_BUFFER_SIZE;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    largeUdp_buffer_t *buffer = malloc(sizeof(*buffer) + capacity);
+    if (buffer != NULL) {
+        buffer->capacity = capacity;
     }
+    return buffer;
+}
+
+static void largeUdp_returnBuffer(largeUdp_t *handle, largeUdp_buffer_t *buffer) {
+    if (buffer != NULL && celix_arrayList_size(handle->bufferPool) < (int)handle->maxNrLists + 2) {
+        celix_arrayList_add(handle->bufferPool, buffer);
+    } else {
+        free(buffer);
+    }
+}
+
+static void largeUdp_destroyPartList(largeUdp_t *handle, udpPartList_t *udpPartList) {
+    largeUdp_returnBuffer(handle, udpPartList->buffer);
+    free(udpPartList->receivedParts);
+    free(udpPartList);
+}
+
+static void largeUdp_dropPartList(largeUdp_t *handle, udpPartList_t *udpPartList) {
+    handle->metrics.nrOfMessagesLost += 1;
+    handle->metrics.nrOfFragmentsLost += udpPartList->nrPartsRemaining;
+    largeUdp_destroyPartList(handle, udpPartList);
+}
 
-    return (result == 0 ? written : result);
+static bool largeUdp_isRecentlyCompleted(largeUdp_t *handle, unsigned int msg_ident) {
+    for (int i = 0; i < NR_OF_RECENT_IDENTS; i++) {
+        if (handle->recentIdents[i] == msg_ident) {
+            return true;
+        }
+    }
+    return false;
 }
 
 //
-// Reads data from the filedescriptor which has date (determined by epoll()) and stores it in the internal structure
-// If the message is completely reassembled true is returned and the index and size have valid values
+// Stores a received part in the reassembly administration. Should be called with the dbLock locked.
 //
-bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, unsigned int *size) {
+static void largeUdp_handlePart(largeUdp_t *handle, int fd, const struct sockaddr_in *sender, const char *data, size_t len) {
     msg_part_header_t header;
-    int result = false;
-    // Only read the header, we don't know yet where to store the payload
-    if (recv(fd, &header, sizeof(header), MSG_PEEK) < 0) {
-        perror("read()");
-        return false;
-    }
-
-    struct iovec msg_vec[2];
-    struct msghdr msg;
-    msg.msg_name = NULL;
-    msg.msg_namelen = 0;
-    msg.msg_flags = 0;
-    msg.msg_iov = msg_vec;
-    msg.msg_iovlen = 2; // header and payload;
-    msg.msg_control = NULL;
-    msg.msg_controllen = 0;
-
-    msg.msg_iov[0].iov_base = &header;
-    msg.msg_iov[0].iov_len = sizeof(header);
-
-    pthread_mutex_lock(&handle->dbLock);
+    if (len < sizeof(header)) {
+        return;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.part_msg_size != len - sizeof(header) || header.offset % MAX_PART_SIZE != 0 ||
+            header.offset > header.total_msg_size || header.part_msg_size > header.total_msg_size - header.offset) {
+        fprintf(stderr, "ERROR: Ignoring invalid udp part for id %u\n", header.msg_ident);
+        return;
+    }
+    handle->metrics.nrOfFragmentsReceived += 1;
+    if (largeUdp_isRecentlyCompleted(handle, header.msg_ident)) {
+        //e.g. retransmitted on request of another receiver
+        handle->metrics.nrOfDuplicateFragments += 1;
+        return;
+    }
 
+    int index = -1;
+    udpPartList_t *udpPartList = NULL;
     int nrUdpLists = arrayList_size(handle->udpPartLists);
-    int i;
-    bool found = false;
-    for (i = 0; i < nrUdpLists; i++) {
-        udpPartList_t *udpPartList = arrayList_get(handle->udpPartLists, i);
-        if (udpPartList->msg_ident == header.msg_ident) {
-            found = true;
-
-            //sanity check
-            if (udpPartList->msg_size != header.total_msg_size) {
+    for (int i = 0; i < nrUdpLists; i++) {
+        udpPartList_t *list = arrayList_get(handle->udpPartLists, i);
+        if (list->msg_ident == header.msg_ident) {
+            if (list->msg_size != header.total_msg_size) {
                 // Corruption occurred. Remove the existing administration and build up a new one.
                 arrayList_remove(handle->udpPartLists, i);
-                free(udpPartList->data);
-                free(udpPartList);
-                found = false;
-                break;
+                largeUdp_dropPartList(handle, list);
+            } else {
+                index = i;
+                udpPartList = list;
             }
+            break;
+        }
+    }
 
-            msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-            msg.msg_iov[1].iov_len = header.part_msg_size;
-            if (recvmsg(fd, &msg, 0)<0) {
-                found=true;
-                result=false;
-                break;
-            }
+    if (udpPartList == NULL) {
+        if (arrayList_size(handle->udpPartLists) >= handle->maxNrLists) {
+            // remove the oldest list
+            udpPartList_t *oldest = arrayList_remove(handle->udpPartLists, 0);
+            fprintf(stderr, "ERROR: Removing entry for id %u: %u parts not received\n", oldest->msg_ident, oldest->nrPartsRemaining);
+            largeUdp_dropPartList(handle, oldest);
+        }
+        udpPartList = calloc(1, sizeof(*udpPartList));
+        udpPartList->msg_ident = header.msg_ident;
+        udpPartList->msg_size = header.total_msg_size;
+        udpPartList->nrOfParts = header.total_msg_size / MAX_PART_SIZE + 1;
+        udpPartList->nrPartsRemaining = udpPartList->nrOfParts;
+        udpPartList->receivedParts = calloc((udpPartList->nrOfParts + 63) / 64, sizeof(uint64_t));
+        udpPartList->buffer = largeUdp_takeBuffer(handle, header.total_msg_size);
+        udpPartList->fd = fd;
+        udpPartList->sender = *sender;
+        if (udpPartList->receivedParts == NULL || udpPartList->buffer == NULL) {
+            largeUdp_destroyPartList(handle, udpPartList);
+            return;
+        }
+        arrayList_add(handle->udpPartLists, udpPartList);
+        index = arrayList_size(handle->udpPartLists) - 1;
+    }
 
-            udpPartList->nrPartsRemaining--;
-            if (udpPartList->nrPartsRemaining == 0) {
-                *index = i;
-                *size = udpPartList->msg_size;
-                result = true;
-                break;
-            } else {
-                result = false; // not complete
-                break;
-            }
+    unsigned int part = header.offset / MAX_PART_SIZE;
+    uint64_t mask = ((uint64_t)1) << (part % 64);
+    if ((udpPartList->receivedParts[part / 64] & mask) != 0) {
+        handle->metrics.nrOfDuplicateFragments += 1;
+    } else {
+        udpPartList->receivedParts[part / 64] |= mask;
+        memcpy(&udpPartList->buffer->data[header.offset], data + sizeof(header), header.part_msg_size);
+        udpPartList->nrPartsRemaining--;
+        udpPartList->nrOfNaks = 0;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &udpPartList->lastPartTime);
+
+    if (udpPartList->nrPartsRemaining == 0) {
+        arrayList_remove(handle->udpPartLists, (unsigned int)index);
+        celix_arrayList_add(handle->completeLists, udpPartList);
+        handle->recentIdents[handle->recentIdentsIndex] = udpPartList->msg_ident;
+        handle->recentIdentsIndex = (handle->recentIdentsIndex + 1) % NR_OF_RECENT_IDENTS;
+        handle->metrics.nrOfMessagesReceived += 1;
+    }
+}
+
+//
+// Reads a batch of udp packets without blocking, using recvmmsg if available. Returns the nr of read packets or -1.
+//
+static int largeUdp_recvBatch(int fd, struct mmsghdr *msgs, unsigned int nrOfMsgs) {
+#if defined(__APPLE__)
+    unsigned int n;
+    for (n = 0; n < nrOfMsgs; n++) {
+        ssize_t r = recvmsg(fd, &msgs[n].msg_hdr, MSG_DONTWAIT);
+        if (r < 0) {
+            break;
         }
+        msgs[n].msg_len = (unsigned int)r;
     }
+    return n > 0 ? (int)n : -1;
+#else
+    return recvmmsg(fd, msgs, nrOfMsgs, MSG_DONTWAIT, NULL);
+#endif
+}
 
-    if (found == false) {
-        udpPartList_t *udpPartList = NULL;
-        if (nrUdpLists == handle->maxNrLists) {
-            // remove list at index 0
-            udpPartList = arrayList_remove(handle->udpPartLists, 0);
-            fprintf(stderr, "ERROR: Removing entry for id %d: %d parts not received\n",udpPartList->msg_ident, udpPartList->nrPartsRemaining );
-            free(udpPartList->data);
-            free(udpPartList);
-            nrUdpLists--;
-        }
-        udpPartList = calloc(sizeof(*udpPartList), 1);
-        udpPartList->msg_ident =  header.msg_ident;
-        udpPartList->msg_size =  header.total_msg_size;
-        udpPartList->nrPartsRemaining = header.total_msg_size / MAX_PART_SIZE;
-        udpPartList->data = calloc(sizeof(char), header.total_msg_size);
-
-        msg.msg_iov[1].iov_base = &udpPartList->data[header.offset];
-        msg.msg_iov[1].iov_len = header.part_msg_size;
-        if (recvmsg(fd, &msg, 0)<0) {
-            free(udpPartList->data);
-            free(udpPartList);
-            result=false;
-        } else {
-            arrayList_add(handle->udpPartLists, udpPartList);
+//
+// Reads data from the filedescriptor which has date (determined by epoll()) and stores it in the internal structure
+// If one or more messages are completely reassembled true is returned and the messages can be read with largeUdp_read
+//
+bool largeUdp_dataAvailable(largeUdp_t *handle, int fd) {
+    struct mmsghdr msgs[RECV_BATCH_SIZE];
+    struct iovec msg_vecs[RECV_BATCH_SIZE];
+    struct sockaddr_in senders[RECV_BATCH_SIZE];
 
-            if (udpPartList->nrPartsRemaining == 0) {
-                *index = nrUdpLists;
-                *size = udpPartList->msg_size;
-                result = true;
-            } else {
-                result = false;
+    pthread_mutex_lock(&handle->dbLock);
+    if (handle->recvBuffers == NULL) {
+        handle->recvBuffers = malloc(RECV_BATCH_SIZE * MAX_UDP_MSG_SIZE);
+    }
+
+    for (int batch = 0; handle->recvBuffers != NULL && batch < MAX_RECV_BATCHES; batch++) {
+        memset(msgs, 0, sizeof(msgs));
+        for (int i = 0; i < RECV_BATCH_SIZE; i++) {
+            msg_vecs[i].iov_base = &handle->recvBuffers[i * MAX_UDP_MSG_SIZE];
+            msg_vecs[i].iov_len = MAX_UDP_MSG_SIZE;
+            msgs[i].msg_hdr.msg_name = &senders[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+            msgs[i].msg_hdr.msg_iov = &msg_vecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int n = largeUdp_recvBatch(fd, msgs, RECV_BATCH_SIZE);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("read()");
             }
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            largeUdp_handlePart(handle, fd, &senders[i], msg_vecs[i].iov_base, msgs[i].msg_len);
+        }
+        if (n < RECV_BATCH_SIZE) {
+            break;
         }
-
     }
 
+    bool result = celix_arrayList_size(handle->completeLists) > 0;
     pthread_mutex_unlock(&handle->dbLock);
 
     return result;
 }
 
 //
-// Read out the message which is indicated available by the largeUdp_dataAvailable function
+// Read out a message which is indicated available by the largeUdp_dataAvailable function
 //
-int largeUdp_read(largeUdp_t *handle, unsigned int index, void ** buffer, unsigned int size)
+int largeUdp_read(largeUdp_t *handle, void **buffer, unsigned int *size)
 {
-    int result = 0;
+    int result = -1;
     pthread_mutex_lock(&handle->dbLock);
-
-    udpPartList_t *udpPartList = arrayList_remove(handle->udpPartLists, index);
-    if (udpPartList) {
-        *buffer = udpPartList->data;
-        free(udpPartList);
-    } else {
-        result = -1;
+    if (celix_arrayList_size(handle->completeLists) > 0) {
+        udpPartList_t *udpPartList = celix_arrayList_get(handle->completeLists, 0);
+        celix_arrayList_removeAt(handle->completeLists, 0);
+        *buffer = udpPartList->buffer->data;
+        *size = udpPartList->msg_size;
+        udpPartList->buffer = NULL; //owned by the caller till released
+        largeUdp_destroyPartList(handle, udpPartList);
+        result = 0;
     }
     pthread_mutex_unlock(&handle->dbLock);
 
     return result;
 }
+
+void largeUdp_releaseBuffer(largeUdp_t *handle, void *buffer) {
+    if (buffer != NULL) {
+        largeUdp_buffer_t *poolBuffer = (largeUdp_buffer_t*)((char*)buffer - offsetof(largeUdp_buffer_t, data));
+        pthread_mutex_lock(&handle->dbLock);
+        largeUdp_returnBuffer(handle, poolBuffer);
+        pthread_mutex_unlock(&handle->dbLock);
+    }
+}
+
+static void largeUdp_sendNak(largeUdp_t *handle, udpPartList_t *udpPartList) {
+    largeUdp_nak_t nak;
+    nak.magic = NAK_MAGIC;
+    nak.msg_ident = udpPartList->msg_ident;
+    nak.nrOfParts = 0;
+    for (unsigned int part = 0; part < udpPartList->nrOfParts && nak.nrOfParts < MAX_NAK_PARTS; part++) {
+        if ((udpPartList->receivedParts[part / 64] & (((uint64_t)1) << (part % 64))) == 0) {
+            nak.parts[nak.nrOfParts++] = part;
+        }
+    }
+    size_t size = offsetof(largeUdp_nak_t, parts) + nak.nrOfParts * sizeof(nak.parts[0]);
+    if (sendto(udpPartList->fd, &nak, size, MSG_DONTWAIT, (struct sockaddr*)&udpPartList->sender, sizeof(udpPartList->sender)) >= 0) {
+        handle->metrics.nrOfNaksSend += 1;
+    }
+}
+
+int largeUdp_checkIncompleteMessages(largeUdp_t *handle) {
+    int nextCheckInMs = -1;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pthread_mutex_lock(&handle->dbLock);
+    unsigned int i = 0;
+    while (i < arrayList_size(handle->udpPartLists)) {
+        udpPartList_t *udpPartList = arrayList_get(handle->udpPartLists, i);
+        double idleInMs = celix_difftime(&udpPartList->lastPartTime, &now) * 1000.0;
+        if (idleInMs >= NAK_INTERVAL_MS) {
+            if (udpPartList->nrOfNaks >= MAX_NR_OF_NAKS) {
+                arrayList_remove(handle->udpPartLists, i);
+                fprintf(stderr, "ERROR: Removing entry for id %u: %u parts not received after %u retransmission requests\n", udpPartList->msg_ident, udpPartList->nrPartsRemaining, udpPartList->nrOfNaks);
+                largeUdp_dropPartList(handle, udpPartList);
+                continue;
+            }
+            largeUdp_sendNak(handle, udpPartList);
+            udpPartList->nrOfNaks += 1;
+            udpPartList->lastPartTime = now;
+            idleInMs = 0;
+        }
+        int remainingInMs = NAK_INTERVAL_MS - (int)idleInMs;
+        if (remainingInMs < 1) {
+            remainingInMs = 1;
+        }
+        if (nextCheckInMs < 0 || remainingInMs < nextCheckInMs) {
+            nextCheckInMs = remainingInMs;
+        }
+        i++;
+    }
+    pthread_mutex_unlock(&handle->dbLock);
+
+    return nextCheckInMs;
+}
@@ -33,14 +33,77 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 typedef struct largeUdp largeUdp_t;
 
+typedef struct largeUdp_metrics {
+    //send side
+    unsigned long nrOfMessagesSend;
+    unsigned long nrOfFragmentsSend;
+    unsigned long nrOfNaksReceived;
+    unsigned long nrOfFragmentsRetransmitted;
+    unsigned long nrOfUnservedNaks; //NAKs for messages which are no longer in the retransmit history
+
+    //receive side
+    unsigned long nrOfMessagesReceived;
+    unsigned long nrOfFragmentsReceived;
+    unsigned long nrOfDuplicateFragments;
+    unsigned long nrOfNaksSend;
+    unsigned long nrOfMessagesLost; //incomplete messages dropped
+    unsigned long nrOfFragmentsLost; //missing fragments of the dropped messages
+} largeUdp_metrics_t;
+
 largeUdp_t *largeUdp_create(unsigned int maxNrUdpReceptions);
 void largeUdp_destroy(largeUdp_t *handle);
 
+/**
+ * Paces the sending of fragments with a token bucket of burstInBytes which is filled with rateInBytesPerSec.
+ * Every fragment is charged with its size on the wire (IP, UDP and fragment headers included).
+ * A rate of 0 (default) disables pacing.
+ */
+void largeUdp_setPacing(largeUdp_t *handle, unsigned long rateInBytesPerSec, unsigned long burstInBytes);
+
+/**
+ * Sets the nr of (multi fragment) messages kept for retransmission of fragments requested by receivers (NAK).
+ * 0 disables retransmission.
+ */
+void largeUdp_setRetransmitHistory(largeUdp_t *handle, unsigned int nrOfMessages);
+
 int largeUdp_sendto(largeUdp_t *handle, int fd, void *buf, size_t count, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
 int largeUdp_sendmsg(largeUdp_t *handle, int fd, struct iovec *largeMsg_iovec, int len, int flags, struct sockaddr_in *dest_addr, size_t addrlen);
-bool largeUdp_dataAvailable(largeUdp_t *handle, int fd, unsigned int *index, unsigned int *size);
-int largeUdp_read(largeUdp_t *handle, unsigned int index, void ** buffer, unsigned int size);
+
+/**
+ * Reads the NAKs available on the (send) socket fd and retransmits the requested fragments. Does not block.
+ */
+void largeUdp_handleNaks(largeUdp_t *handle, int fd);
+
+/**
+ * Reads the fragments available on fd (without blocking) and reassembles them.
+ * Returns true if one or more messages are complete, these can be read with largeUdp_read.
+ */
+bool largeUdp_dataAvailable(largeUdp_t *handle, int fd);
+
+/**
+ * Takes the next completely reassembled message. Returns 0 if a message is read.
+ * The buffer should be released with largeUdp_releaseBuffer.
+ */
+int largeUdp_read(largeUdp_t *handle, void **buffer, unsigned int *size);
+void largeUdp_releaseBuffer(largeUdp_t *handle, void *buffer);
+
+/**
+ * Sends NAKs for the missing fragments of incomplete messages which did not receive a fragment for a while and drops
+ * incomplete messages for which the retransmission failed.
+ * Returns the time in ms till the next check is needed or -1 if there are no incomplete messages.
+ */
+int largeUdp_checkIncompleteMessages(largeUdp_t *handle);
+
+void largeUdp_getMetrics(largeUdp_t *handle, largeUdp_metrics_t *metrics);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* _LARGE_UDP_H_ */
@@ -45,6 +45,22 @@
 #define PUBSUB_UDPMC_MULTICAST_IP_DEFAULT           "224.100.1.1"
 #define PUBSUB_UDPMC_VERBOSE_DEFAULT                true
 
+/**
+ * Max send rate in bytes per second of the UDP multicast send socket. The fragments of large messages are paced with
+ * a token bucket of PSA_UDPMC_SEND_BURST bytes. Default 0 is not paced.
+ */
+#define PUBSUB_UDPMC_SEND_RATE_KEY                  "PSA_UDPMC_SEND_RATE"
+#define PUBSUB_UDPMC_SEND_RATE_DEFAULT              0
+#define PUBSUB_UDPMC_SEND_BURST_KEY                 "PSA_UDPMC_SEND_BURST"
+#define PUBSUB_UDPMC_SEND_BURST_DEFAULT             (256 * 1024)
+
+/**
+ * Nr of sent multi fragment messages kept to retransmit fragments requested (NAK) by receivers missing them.
+ * 0 disables retransmission.
+ */
+#define PUBSUB_UDPMC_RETRANSMIT_HISTORY_KEY         "PSA_UDPMC_RETRANSMIT_HISTORY"
+#define PUBSUB_UDPMC_RETRANSMIT_HISTORY_DEFAULT     16
+
 /**
  * If set true on the endpoint, the udp mc TopicSender bind and/or discovery url is statically configured.
  */
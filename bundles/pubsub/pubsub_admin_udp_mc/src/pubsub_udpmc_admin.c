@@ -18,6 +18,8 @@
  */
 
 #include <memory.h>
+#include <poll.h>
+#include <unistd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
@@ -32,6 +34,9 @@
 #include "pubsub_psa_udpmc_constants.h"
 #include "pubsub_udpmc_topic_sender.h"
 #include "pubsub_udpmc_topic_receiver.h"
+#include "large_udp.h"
+
+#define NAK_THREAD_TIMEOUT_MS   100
 
 
 #define L_DEBUG(...) \
@@ -49,6 +54,7 @@ struct pubsub_udpmc_admin {
     char *ifIpAddress; // The local interface which is used for multicast communication
     char *mcIpAddress; // The multicast IP address
     int sendSocket;
+    largeUdp_t *largeUdpHandle; //fragmentation, pacing and retransmission for the send socket
     double qosSampleScore;
     double qosControlScore;
     double defaultScore;
@@ -75,6 +81,12 @@ struct pubsub_udpmc_admin {
         hash_map_t *map; //key = endpoint uuid, value = celix_properties_t*
     } discoveredEndpoints;
 
+    struct {
+        celix_thread_t thread;
+        celix_thread_mutex_t mutex;
+        bool running;
+    } nakThread; //handles retransmission requests (NAKs) of receivers
+
 };
 
 typedef struct psa_udpmc_serializer_entry {
@@ -87,6 +99,8 @@ static celix_status_t udpmc_getIpAddress(const char* interface, char** ip);
 static celix_status_t pubsub_udpmcAdmin_connectEndpointToReceiver(pubsub_udpmc_admin_t* psa, pubsub_udpmc_topic_receiver_t *receiver, const celix_properties_t *endpoint);
 static celix_status_t pubsub_udpmcAdmin_disconnectEndpointFromReceiver(pubsub_udpmc_admin_t* psa, pubsub_udpmc_topic_receiver_t *receiver, const celix_properties_t *endpoint);
 
+static void* psa_udpmc_nakThread(void *data);
+
 static bool pubsub_udpmcAdmin_endpointIsPublisher(const celix_properties_t *endpoint) {
     const char *type = celix_properties_get(endpoint, PUBSUB_ENDPOINT_TYPE, NULL);
     return type != NULL && strncmp(PUBSUB_PUBLISHER_ENDPOINT_TYPE, type, strlen(PUBSUB_PUBLISHER_ENDPOINT_TYPE)) == 0;
@@ -99,6 +113,7 @@ pubsub_udpmc_admin_t* pubsub_udpmcAdmin_create(celix_bundle_context_t *ctx, celi
     psa->log = logHelper;
     psa->verbose = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_UDPMC_VERBOSE_KEY, PUBSUB_UDPMC_VERBOSE_DEFAULT);
     psa->fwUUID = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+    psa->sendSocket = -1;
 
     int b0 = 0, b1 = 0, b2 = 0, b3 = 0;
 
@@ -195,6 +210,23 @@ pubsub_udpmc_admin_t* pubsub_udpmcAdmin_create(celix_bundle_context_t *ctx, celi
     celixThreadMutex_create(&psa->discoveredEndpoints.mutex, NULL);
     psa->discoveredEndpoints.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
+    psa->largeUdpHandle = largeUdp_create(1);
+    long sendRate = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_SEND_RATE_KEY, PUBSUB_UDPMC_SEND_RATE_DEFAULT);
+    long sendBurst = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_SEND_BURST_KEY, PUBSUB_UDPMC_SEND_BURST_DEFAULT);
+    long history = celix_bundleContext_getPropertyAsLong(ctx, PUBSUB_UDPMC_RETRANSMIT_HISTORY_KEY, PUBSUB_UDPMC_RETRANSMIT_HISTORY_DEFAULT);
+    largeUdp_setPacing(psa->largeUdpHandle, sendRate > 0 ? (unsigned long)sendRate : 0, sendBurst > 0 ? (unsigned long)sendBurst : 0);
+    largeUdp_setRetransmitHistory(psa->largeUdpHandle, history > 0 ? (unsigned int)history : 0);
+    if (psa->verbose && sendRate > 0) {
+        L_INFO("[PSA_UDPMC] Pacing send socket at %li bytes/s (burst %li bytes)", sendRate, sendBurst);
+    }
+
+    celixThreadMutex_create(&psa->nakThread.mutex, NULL);
+    psa->nakThread.running = psa->sendSocket >= 0 && history > 0;
+    if (psa->nakThread.running) {
+        celixThread_create(&psa->nakThread.thread, NULL, psa_udpmc_nakThread, psa);
+        celixThread_setName(&psa->nakThread.thread, "CelixPsaUdpMcNak");
+    }
+
     return psa;
 }
 
@@ -221,6 +253,16 @@ void pubsub_udpmcAdmin_destroy(pubsub_udpmc_admin_t *psa) {
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
 
+    celixThreadMutex_lock(&psa->nakThread.mutex);
+    bool nakThreadRunning = psa->nakThread.running;
+    psa->nakThread.running = false;
+    celixThreadMutex_unlock(&psa->nakThread.mutex);
+    if (nakThreadRunning) {
+        celixThread_join(psa->nakThread.thread, NULL);
+    }
+    celixThreadMutex_destroy(&psa->nakThread.mutex);
+    largeUdp_destroy(psa->largeUdpHandle);
+
     celixThreadMutex_lock(&psa->discoveredEndpoints.mutex);
     iter = hashMapIterator_construct(psa->discoveredEndpoints.map);
     while (hashMapIterator_hasNext(&iter)) {
@@ -306,7 +348,7 @@ celix_status_t pubsub_udpmcAdmin_setupTopicSender(void *handle, const char *scop
     if (sender == NULL) {
         psa_udpmc_serializer_entry_t *serEntry = hashMap_get(psa->serializers.map, (void*)serializerSvcId);
         if (serEntry != NULL) {
-            sender = pubsub_udpmcTopicSender_create(psa->ctx, scope, topic, serializerSvcId, serEntry->svc, psa->sendSocket, psa->mcIpAddress, topicProps);
+            sender = pubsub_udpmcTopicSender_create(psa->ctx, scope, topic, serializerSvcId, serEntry->svc, psa->sendSocket, psa->largeUdpHandle, psa->mcIpAddress, topicProps);
         }
         if (sender != NULL) {
             const char *psaType = PSA_UDPMC_PUBSUB_ADMIN_TYPE;
@@ -562,6 +604,16 @@ bool pubsub_udpmcAdmin_executeCommand(void *handle, const char *commandLine __at
     celixThreadMutex_unlock(&psa->topicSenders.mutex);
     celixThreadMutex_unlock(&psa->serializers.mutex);
 
+    largeUdp_metrics_t metrics;
+    largeUdp_getMetrics(psa->largeUdpHandle, &metrics);
+    fprintf(out, "\n");
+    fprintf(out, "Send Socket:\n");
+    fprintf(out, "|- messages send          = %lu\n", metrics.nrOfMessagesSend);
+    fprintf(out, "|- fragments send         = %lu\n", metrics.nrOfFragmentsSend);
+    fprintf(out, "|- NAKs received          = %lu\n", metrics.nrOfNaksReceived);
+    fprintf(out, "|- fragments retransmitted= %lu\n", metrics.nrOfFragmentsRetransmitted);
+    fprintf(out, "|- unserved NAKs          = %lu\n", metrics.nrOfUnservedNaks);
+
     fprintf(out, "\n");
     fprintf(out, "\nTopic Receivers:\n");
     celixThreadMutex_lock(&psa->serializers.mutex);
@@ -586,6 +638,13 @@ bool pubsub_udpmcAdmin_executeCommand(void *handle, const char *commandLine __at
             free(conn);
         }
         celix_arrayList_destroy(connections);
+        pubsub_udpmcTopicReceiver_largeUdpMetrics(receiver, &metrics);
+        fprintf(out, "   |- messages received   = %lu\n", metrics.nrOfMessagesReceived);
+        fprintf(out, "   |- fragments received  = %lu\n", metrics.nrOfFragmentsReceived);
+        fprintf(out, "   |- duplicate fragments = %lu\n", metrics.nrOfDuplicateFragments);
+        fprintf(out, "   |- NAKs send           = %lu\n", metrics.nrOfNaksSend);
+        fprintf(out, "   |- messages lost       = %lu\n", metrics.nrOfMessagesLost);
+        fprintf(out, "   |- fragments lost      = %lu\n", metrics.nrOfFragmentsLost);
     }
     celixThreadMutex_unlock(&psa->topicReceivers.mutex);
     celixThreadMutex_unlock(&psa->serializers.mutex);
@@ -696,3 +755,27 @@ static celix_status_t udpmc_getIpAddress(const char* interface, char** ip) {
     return status;
 }
 #endif
+
+static void* psa_udpmc_nakThread(void *data) {
+    pubsub_udpmc_admin_t *psa = data;
+
+    celixThreadMutex_lock(&psa->nakThread.mutex);
+    bool running = psa->nakThread.running;
+    celixThreadMutex_unlock(&psa->nakThread.mutex);
+
+    while (running) {
+        struct pollfd pfd;
+        pfd.fd = psa->sendSocket;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, NAK_THREAD_TIMEOUT_MS) > 0) {
+            largeUdp_handleNaks(psa->largeUdpHandle, psa->sendSocket);
+        }
+
+        celixThreadMutex_lock(&psa->nakThread.mutex);
+        running = psa->nakThread.running;
+        celixThreadMutex_unlock(&psa->nakThread.mutex);
+    }
+
+    return NULL;
+}
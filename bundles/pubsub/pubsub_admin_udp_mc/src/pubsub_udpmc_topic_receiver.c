@@ -34,6 +34,7 @@
 #include <arpa/inet.h>
 #include <celix_log_helper.h>
 #include <pubsub_utils.h>
+#include <pubsub_shared_message.h>
 #include <celix_api.h>
 #include "pubsub_udpmc_topic_receiver.h"
 #include "pubsub_psa_udpmc_constants.h"
@@ -98,6 +99,7 @@ typedef struct psa_udpmc_requested_connection_entry {
 typedef struct psa_udpmc_subscriber_entry {
     hash_map_t *msgTypes; //map from serializer svc
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
+    hash_map_t *sharedSubscriberServices; //key = service id, value = pubsub_subscriber_t*, subset of subscriberServices using shared messages
     bool initialized; //true if the init function is called through the receive thread
 } psa_udpmc_subscriber_entry_t;
 
@@ -239,6 +241,7 @@ void pubsub_udpmcTopicReceiver_destroy(pubsub_udpmc_topic_receiver_t *receiver)
                     receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
                 }
                 hashMap_destroy(entry->subscriberServices, false, false);
+                hashMap_destroy(entry->sharedSubscriberServices, false, false);
                 free(entry);
             }
         }
@@ -350,20 +353,30 @@ static void pubsub_udpmcTopicReceiver_addSubscriber(void *handle, void *svc, con
 
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     psa_udpmc_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    bool shared = pubsub_sharedMessage_isSharedSubscriber(svc, props);
     if (entry != NULL) {
         hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
     } else {
         //new create entry
         entry = calloc(1, sizeof(*entry));
         entry->subscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->sharedSubscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
         entry->initialized = false;
         receiver->subscribers.allInitialized = false;
         hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
 
         int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
         if (rc == 0) {
             hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
         } else {
+            hashMap_destroy(entry->subscriberServices, false, false);
+            hashMap_destroy(entry->sharedSubscriberServices, false, false);
             free(entry);
             fprintf(stderr, "Cannot find serializer for TopicReceiver %s/%s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
         }
@@ -381,6 +394,7 @@ static void pubsub_udpmcTopicReceiver_removeSubscriber(void *handle, void *svc,
     psa_udpmc_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
     if (entry != NULL) {
         hashMap_remove(entry->subscriberServices, (void*)svcId);
+        hashMap_remove(entry->sharedSubscriberServices, (void*)svcId);
     }
     if (entry != NULL && hashMap_size(entry->subscriberServices) == 0) {
         //remove entry
@@ -390,6 +404,7 @@ static void pubsub_udpmcTopicReceiver_removeSubscriber(void *handle, void *svc,
             fprintf(stderr, "Cannot find serializer for TopicReceiver %s/%s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
         }
         hashMap_destroy(entry->subscriberServices, false, false);
+        hashMap_destroy(entry->sharedSubscriberServices, false, false);
         free(entry);
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
@@ -419,6 +434,10 @@ static void* psa_udpmc_recvThread(void * data) {
         }
 
         unsigned int timeout = RECV_THREAD_TIMEOUT * 1000;
+        int nakTimeout = largeUdp_checkIncompleteMessages(receiver->largeUdpHandle);
+        if (nakTimeout >= 0 && (unsigned int)nakTimeout < timeout) {
+            timeout = (unsigned int)nakTimeout;
+        }
 #if defined(__APPLE__)
         struct kevent events[MAX_EVENTS];
         struct timespec ts = {timeout / 1000, (timeout  % 1000) * 1000000};
@@ -429,24 +448,19 @@ static void* psa_udpmc_recvThread(void * data) {
 #endif
         int i;
         for (i = 0; i < nfds; i++ ) {
-            unsigned int index;
-            unsigned int size;
 #if defined(__APPLE__)
             int fd = events[i].ident;
 #else
             int fd = events[i].data.fd;
 #endif
-            if (largeUdp_dataAvailable(receiver->largeUdpHandle, fd, &index, &size) == true) {
+            if (largeUdp_dataAvailable(receiver->largeUdpHandle, fd) == true) {
                 // Handle data
                 pubsub_udp_msg_t *udpMsg = NULL;
-                if (largeUdp_read(receiver->largeUdpHandle, index, (void**) &udpMsg, size) != 0) {
-                    printf("[PSA_UDPMC]: ERROR largeUdp_read with index %d\n", index);
-                    continue;
+                unsigned int size = 0;
+                while (largeUdp_read(receiver->largeUdpHandle, (void**) &udpMsg, &size) == 0) {
+                    psa_udpmc_processMsg(receiver, udpMsg);
+                    largeUdp_releaseBuffer(receiver->largeUdpHandle, udpMsg);
                 }
-
-                psa_udpmc_processMsg(receiver, udpMsg);
-
-                free(udpMsg);
             }
         }
 
@@ -489,24 +503,19 @@ static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub
                 celix_status_t status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 0, &msgInst);
 
                 if (status == CELIX_SUCCESS) {
-                    hash_map_iterator_t iter2 = hashMapIterator_construct(entry->subscriberServices);
-                    bool release = true;
-                    while (hashMapIterator_hasNext(&iter2)) {
-                        pubsub_subscriber_t *svc = hashMapIterator_nextValue(&iter2);
-                        svc->receive(svc->handle, msgSer->msgName, msg->header.type, msgInst, NULL, &release);
-                        if (!release && hashMapIterator_hasNext(&iter2)) {
-                            //receive function has taken ownership and still more receive function to come ..
-                            //deserialize again for new message
-                            status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 0, &msgInst);
-                            if (status != CELIX_SUCCESS) {
-                                L_WARN("[PSA_UDPMC] Cannot deserialize msgType %s.\n",msgSer->msgName);
-                                break;
-                            }
-                            release = true;
-                        }
-                    }
-                    if (release) {
-                        msgSer->freeDeserializeMsg(msgSer->handle, msgInst);
+                    pubsub_shared_message_delivery_t delivery = {
+                            .msgFqn = msgSer->msgName,
+                            .msgId = msg->header.type,
+                            .metadata = NULL,
+                            .serializerHandle = msgSer->handle,
+                            .deserialize = msgSer->deserialize,
+                            .freeDeserializedMsg = msgSer->freeDeserializeMsg,
+                            .input = &deSerializeBuffer,
+                            .inputIovLen = 0
+                    };
+                    status = pubsub_sharedMessage_deliver(&delivery, entry->subscriberServices, entry->sharedSubscriberServices, msgInst);
+                    if (status != CELIX_SUCCESS) {
+                        L_WARN("[PSA_UDPMC] Cannot deserialize msgType %s.\n",msgSer->msgName);
                     }
                 } else {
                     L_WARN("[PSA_UDPMC] Cannot deserialize msgType %s.\n",msgSer->msgName);
@@ -525,6 +534,10 @@ static void psa_udpmc_processMsg(pubsub_udpmc_topic_receiver_t *receiver, pubsub
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
+void pubsub_udpmcTopicReceiver_largeUdpMetrics(pubsub_udpmc_topic_receiver_t *receiver, largeUdp_metrics_t *metrics) {
+    largeUdp_getMetrics(receiver->largeUdpHandle, metrics);
+}
+
 void pubsub_udpmcTopicReceiver_listConnections(pubsub_udpmc_topic_receiver_t *receiver, celix_array_list_t *connections) {
     celixThreadMutex_lock(&receiver->requestedConnections.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(receiver->requestedConnections.map);
@@ -23,6 +23,7 @@
 #include "celix_bundle_context.h"
 #include "pubsub_serializer.h"
 #include "celix_log_helper.h"
+#include "large_udp.h"
 
 typedef struct pubsub_udpmc_topic_receiver pubsub_udpmc_topic_receiver_t;
 
@@ -40,6 +41,7 @@ const char* pubsub_udpmcTopicReceiver_scope(pubsub_udpmc_topic_receiver_t *recei
 const char* pubsub_udpmcTopicReceiver_topic(pubsub_udpmc_topic_receiver_t *receiver);
 const char* pubsub_udpmcTopicReceiver_socketAddress(pubsub_udpmc_topic_receiver_t *receiver);
 void pubsub_udpmcTopicReceiver_listConnections(pubsub_udpmc_topic_receiver_t *receiver, celix_array_list_t *connections);
+void pubsub_udpmcTopicReceiver_largeUdpMetrics(pubsub_udpmc_topic_receiver_t *receiver, largeUdp_metrics_t *metrics);
 
 long pubsub_udpmcTopicReceiver_serializerSvcId(pubsub_udpmc_topic_receiver_t *receiver);
 
@@ -50,6 +50,7 @@ struct pubsub_udpmc_topic_sender {
     bool staticallyConfigured;
 
     int sendSocket;
+    largeUdp_t *largeUdpHandle; //shared by all topic senders using the send socket
     struct sockaddr_in destAddr;
 
     struct {
@@ -70,7 +71,6 @@ typedef struct psa_udpmc_bounded_service_entry {
     hash_map_t *msgTypes;
     hash_map_t *msgTypeIds;
     int getCount;
-    largeUdp_t *largeUdpHandle;
 } psa_udpmc_bounded_service_entry_t;
 
 typedef struct pubsub_msg {
@@ -93,6 +93,7 @@ pubsub_udpmc_topic_sender_t* pubsub_udpmcTopicSender_create(
         long serializerSvcId,
         pubsub_serializer_service_t *serializer,
         int sendSocket,
+        largeUdp_t *largeUdpHandle,
         const char *bindIP,
         const celix_properties_t *topicProperties) {
     pubsub_udpmc_topic_sender_t *sender = calloc(1, sizeof(*sender));
@@ -131,6 +132,7 @@ pubsub_udpmc_topic_sender_t* pubsub_udpmcTopicSender_create(
     //setting up socket for UDPMC TopicSender
     {
         sender->sendSocket = sendSocket;
+        sender->largeUdpHandle = largeUdpHandle;
         sender->destAddr.sin_family = AF_INET;
         sender->destAddr.sin_addr.s_addr = inet_addr(bindIP);
         sender->destAddr.sin_port = htons((uint16_t)port);
@@ -235,7 +237,6 @@ static void* psa_udpmc_getPublisherService(void *handle, const celix_bundle_t *r
         entry->getCount = 1;
         entry->parent = sender;
         entry->bndId = bndId;
-        entry->largeUdpHandle = largeUdp_create(1);
         entry->msgTypeIds = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
         int rc = sender->serializer->createSerializerMap(sender->serializer->handle, (celix_bundle_t*)requestingBundle, &entry->msgTypes);
@@ -280,7 +281,6 @@ static void psa_udpmc_ungetPublisherService(void *handle, const celix_bundle_t *
         }
 
         hashMap_destroy(entry->msgTypeIds, true, false);
-        largeUdp_destroy(entry->largeUdpHandle);
         free(entry);
     }
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
@@ -358,7 +358,7 @@ static bool psa_udpmc_sendMsg(psa_udpmc_bounded_service_entry_t *entry, pubsub_u
 
     delay_first_send_for_late_joiners();
 
-    if (largeUdp_sendmsg(entry->largeUdpHandle, entry->parent->sendSocket, msg_iovec, iovec_len, 0, &entry->parent->destAddr, sizeof(entry->parent->destAddr)) == -1) {
+    if (largeUdp_sendmsg(entry->parent->largeUdpHandle, entry->parent->sendSocket, msg_iovec, iovec_len, 0, &entry->parent->destAddr, sizeof(entry->parent->destAddr)) == -1) {
         perror("send_pubsub_msg:sendSocket");
         ret = false;
     }
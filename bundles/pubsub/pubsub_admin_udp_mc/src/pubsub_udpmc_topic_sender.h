@@ -22,6 +22,7 @@
 
 #include "celix_bundle_context.h"
 #include "pubsub_serializer.h"
+#include "large_udp.h"
 
 typedef struct pubsub_udpmc_topic_sender pubsub_udpmc_topic_sender_t;
 
@@ -32,6 +33,7 @@ pubsub_udpmc_topic_sender_t* pubsub_udpmcTopicSender_create(
         long serializerSvcId,
         pubsub_serializer_service_t *serializer,
         int sendSocket,
+        largeUdp_t *largeUdpHandle,
         const char *bindIP,
         const celix_properties_t *topicProperties);
 void pubsub_udpmcTopicSender_destroy(pubsub_udpmc_topic_sender_t *sender);
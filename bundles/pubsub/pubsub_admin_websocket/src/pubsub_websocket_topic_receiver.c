@@ -35,6 +35,7 @@
 #include <http_admin/api.h>
 #include <jansson.h>
 #include <pubsub_utils.h>
+#include <pubsub_shared_message.h>
 #include <celix_api.h>
 
 #ifndef UUID_STR_LEN
@@ -111,6 +112,7 @@ typedef struct psa_websocket_requested_connection_entry {
 typedef struct psa_websocket_subscriber_entry {
     hash_map_t *msgTypes; //key = msg type id, value = pubsub_msg_serializer_t
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
+    hash_map_t *sharedSubscriberServices; //key = service id, value = pubsub_subscriber_t*, subset of subscriberServices using shared messages
     bool initialized; //true if the init function is called through the receive thread
 } psa_websocket_subscriber_entry_t;
 
@@ -268,6 +270,7 @@ void pubsub_websocketTopicReceiver_destroy(pubsub_websocket_topic_receiver_t *re
             if (entry != NULL)  {
                 receiver->serializer->destroySerializerMap(receiver->serializer->handle, entry->msgTypes);
                 hashMap_destroy(entry->subscriberServices, false, false);
+                hashMap_destroy(entry->sharedSubscriberServices, false, false);
                 free(entry);
             }
 
@@ -417,14 +420,22 @@ static void pubsub_websocketTopicReceiver_addSubscriber(void *handle, void *svc,
 
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     psa_websocket_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
+    bool shared = pubsub_sharedMessage_isSharedSubscriber(svc, props);
     if (entry != NULL) {
         hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
     } else {
         //new create entry
         entry = calloc(1, sizeof(*entry));
         entry->subscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->sharedSubscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
         entry->initialized = false;
         hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+        if (shared) {
+            hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+        }
 
         int rc = receiver->serializer->createSerializerMap(receiver->serializer->handle, (celix_bundle_t*)bnd, &entry->msgTypes);
 
@@ -432,6 +443,8 @@ static void pubsub_websocketTopicReceiver_addSubscriber(void *handle, void *svc,
             hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
         } else {
             L_ERROR("[PSA_WEBSOCKET] Cannot create msg serializer map for TopicReceiver %s/%s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
+            hashMap_destroy(entry->subscriberServices, false, false);
+            hashMap_destroy(entry->sharedSubscriberServices, false, false);
             free(entry);
         }
     }
@@ -449,6 +462,7 @@ static void pubsub_websocketTopicReceiver_removeSubscriber(void *handle, void *s
     psa_websocket_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
     if (entry != NULL) {
         hashMap_remove(entry->subscriberServices, (void*)svcId);
+        hashMap_remove(entry->sharedSubscriberServices, (void*)svcId);
     }
     if (entry != NULL && hashMap_size(entry->subscriberServices) == 0) {
         //remove entry
@@ -458,6 +472,7 @@ static void pubsub_websocketTopicReceiver_removeSubscriber(void *handle, void *s
             L_ERROR("[PSA_WEBSOCKET] Cannot destroy msg serializers map for TopicReceiver %s/%s", receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
         }
         hashMap_destroy(entry->subscriberServices, false, false);
+        hashMap_destroy(entry->sharedSubscriberServices, false, false);
         free(entry);
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
@@ -495,24 +510,19 @@ static inline void processMsgForSubscriberEntry(pubsub_websocket_topic_receiver_
             celix_status_t status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 0, &deSerializedMsg);
 
             if (status == CELIX_SUCCESS) {
-                hash_map_iterator_t iter = hashMapIterator_construct(entry->subscriberServices);
-                bool release = true;
-                while (hashMapIterator_hasNext(&iter)) {
-                    pubsub_subscriber_t *svc = hashMapIterator_nextValue(&iter);
-                    svc->receive(svc->handle, msgSer->msgName, msgSer->msgId, deSerializedMsg, NULL, &release);
-                    if (!release && hashMapIterator_hasNext(&iter)) {
-                        //receive function has taken ownership and still more receive function to come ..
-                        //deserialize again for new message
-                        status = msgSer->deserialize(msgSer->handle, &deSerializeBuffer, 0, &deSerializedMsg);
-                        if (status != CELIX_SUCCESS) {
-                            L_WARN("[PSA_WEBSOCKET_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgSer->msgName, receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
-                            break;
-                        }
-                        release = true;
-                    }
-                }
-                if (release) {
-                    msgSer->freeDeserializeMsg(msgSer->handle, deSerializedMsg);
+                pubsub_shared_message_delivery_t delivery = {
+                        .msgFqn = msgSer->msgName,
+                        .msgId = msgSer->msgId,
+                        .metadata = NULL,
+                        .serializerHandle = msgSer->handle,
+                        .deserialize = msgSer->deserialize,
+                        .freeDeserializedMsg = msgSer->freeDeserializeMsg,
+                        .input = &deSerializeBuffer,
+                        .inputIovLen = 0
+                };
+                status = pubsub_sharedMessage_deliver(&delivery, entry->subscriberServices, entry->sharedSubscriberServices, deSerializedMsg);
+                if (status != CELIX_SUCCESS) {
+                    L_WARN("[PSA_WEBSOCKET_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgSer->msgName, receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
                 }
             } else {
                 L_WARN("[PSA_WEBSOCKET_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgSer->msgName, receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
@@ -109,4 +109,28 @@
  */
 #define PUBSUB_ZMQ_HWM                      "zmq.hwm"
 
+/**
+ * If true the publisher only serializes the message and queues it. A sender thread encodes and sends the queued
+ * messages, so that the ZMQ socket is only used by a single thread.
+ * Can be set in the topic properties.
+ */
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_SEND                 "zmq.publisher.async.send"
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_SEND_DEFAULT         false
+
+/**
+ * The max nr of messages queued for the async send mode and the max nr of messages sent in a single batch.
+ * Can be set in the topic properties.
+ */
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_QUEUE_SIZE           "zmq.publisher.async.queue.size"
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_QUEUE_SIZE_DEFAULT   1024
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_BATCH_SIZE           "zmq.publisher.async.batch.size"
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_BATCH_SIZE_DEFAULT   64
+
+/**
+ * The backpressure policy for the async send mode when the queue is full: block, drop-oldest or drop-newest.
+ * Can be set in the topic properties.
+ */
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_BACKPRESSURE         "zmq.publisher.async.backpressure"
+#define PUBSUB_ZMQ_PUBLISHER_ASYNC_BACKPRESSURE_DEFAULT "block"
+
 #endif /* PUBSUB_PSA_ZMQ_CONSTANTS_H_ */
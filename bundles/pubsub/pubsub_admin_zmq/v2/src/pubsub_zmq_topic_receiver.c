@@ -37,6 +37,7 @@
 #include <uuid/uuid.h>
 #include <pubsub_admin_metrics.h>
 #include <pubsub_utils.h>
+#include <pubsub_shared_message.h>
 #include <celix_api.h>
 #include <celix_version.h>
 
@@ -107,6 +108,7 @@ typedef struct psa_zmq_requested_connection_entry {
 
 typedef struct psa_zmq_subscriber_entry {
     hash_map_t *subscriberServices; //key = servide id, value = pubsub_subscriber_t*
+    hash_map_t *sharedSubscriberServices; //key = service id, value = pubsub_subscriber_t*, subset of subscriberServices using shared messages
     bool initialized; //true if the init function is called through the receive thread
 } psa_zmq_subscriber_entry_t;
 
@@ -283,6 +285,7 @@ void pubsub_zmqTopicReceiver_destroy(pubsub_zmq_topic_receiver_t *receiver) {
             psa_zmq_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
             if (entry != NULL)  {
                 hashMap_destroy(entry->subscriberServices, false, false);
+                hashMap_destroy(entry->sharedSubscriberServices, false, false);
                 free(entry);
             }
         }
@@ -409,16 +412,18 @@ static void pubsub_zmqTopicReceiver_addSubscriber(void *handle, void *svc, const
 
     celixThreadMutex_lock(&receiver->subscribers.mutex);
     psa_zmq_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
-    if (entry != NULL) {
-        hashMap_put(entry->subscriberServices, (void*)svcId, svc);
-    } else {
+    if (entry == NULL) {
         //new create entry
         entry = calloc(1, sizeof(*entry));
         entry->subscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
+        entry->sharedSubscriberServices = hashMap_create(NULL, NULL, NULL, NULL);
         entry->initialized = false;
-        hashMap_put(entry->subscriberServices, (void*)svcId, svc);
         hashMap_put(receiver->subscribers.map, (void*)bndId, entry);
     }
+    hashMap_put(entry->subscriberServices, (void*)svcId, svc);
+    if (pubsub_sharedMessage_isSharedSubscriber(svc, props)) {
+        hashMap_put(entry->sharedSubscriberServices, (void*)svcId, svc);
+    }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
 }
 
@@ -432,11 +437,13 @@ static void pubsub_zmqTopicReceiver_removeSubscriber(void *handle, void *svc, co
     psa_zmq_subscriber_entry_t *entry = hashMap_get(receiver->subscribers.map, (void*)bndId);
     if (entry != NULL) {
         hashMap_remove(entry->subscriberServices, (void*)svcId);
+        hashMap_remove(entry->sharedSubscriberServices, (void*)svcId);
     }
     if (entry != NULL && hashMap_size(entry->subscriberServices) == 0) {
         //remove entry
         hashMap_remove(receiver->subscribers.map, (void*)bndId);
         hashMap_destroy(entry->subscriberServices, false, false);
+        hashMap_destroy(entry->sharedSubscriberServices, false, false);
         free(entry);
     }
     celixThreadMutex_unlock(&receiver->subscribers.mutex);
@@ -474,26 +481,21 @@ static inline void processMsgForSubscriberEntry(pubsub_zmq_topic_receiver_t *rec
                 uint32_t msgId = message->header.msgId;
                 celix_properties_t *metadata = message->metadata.metadata;
                 bool cont = pubsubInterceptorHandler_invokePreReceive(receiver->interceptorsHandler, msgFqn, msgId, deserializedMsg, &metadata);
-                bool release = true;
                 if (cont) {
-                    hash_map_iterator_t iter2 = hashMapIterator_construct(entry->subscriberServices);
-                    while (hashMapIterator_hasNext(&iter2)) {
-                        pubsub_subscriber_t *svc = hashMapIterator_nextValue(&iter2);
-                        svc->receive(svc->handle, msgFqn, message->header.msgId, deserializedMsg, metadata, &release);
-                        pubsubInterceptorHandler_invokePostReceive(receiver->interceptorsHandler, msgFqn, msgId, deserializedMsg, metadata);
-                        if (!release && hashMapIterator_hasNext(&iter2)) {
-                            //receive function has taken ownership and still more receive function to come ..
-                            //deserialize again for new message
-                            status = msgSer->svc->deserialize(msgSer->svc->handle, &deSerializeBuffer, 0, &deserializedMsg);
-                            if (status != CELIX_SUCCESS) {
-                                L_WARN("[PSA_ZMQ_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgFqn, receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
-                                break;
-                            }
-                            release = true;
-                        }
-                    }
-                    if (release) {
-                        msgSer->svc->freeDeserializedMsg(msgSer->svc->handle, deserializedMsg);
+                    pubsub_shared_message_delivery_t delivery = {
+                            .msgFqn = msgFqn,
+                            .msgId = msgId,
+                            .metadata = metadata,
+                            .serializerHandle = msgSer->svc->handle,
+                            .deserialize = msgSer->svc->deserialize,
+                            .freeDeserializedMsg = msgSer->svc->freeDeserializedMsg,
+                            .input = &deSerializeBuffer,
+                            .inputIovLen = 0,
+                            .interceptorsHandler = receiver->interceptorsHandler
+                    };
+                    status = pubsub_sharedMessage_deliver(&delivery, entry->subscriberServices, entry->sharedSubscriberServices, deserializedMsg);
+                    if (status != CELIX_SUCCESS) {
+                        L_WARN("[PSA_ZMQ_TR] Cannot deserialize msg type %s for scope/topic %s/%s", msgFqn, receiver->scope == NULL ? "(null)" : receiver->scope, receiver->topic);
                     }
                     updateReceiveCount += 1;
                 }
@@ -35,6 +35,7 @@
 #include "celix_constants.h"
 #include "pubsub_interceptors_handler.h"
 #include "pubsub_zmq_admin.h"
+#include "pubsub_send_queue.h"
 
 #define FIRST_SEND_DELAY_IN_SECONDS             2
 #define ZMQ_BIND_MAX_RETRY                      10
@@ -80,6 +81,19 @@ struct pubsub_zmq_topic_sender {
         celix_thread_mutex_t mutex;
         hash_map_t *map;  //key = bndId, value = psa_zmq_bounded_service_entry_t
     } boundedServices;
+
+    struct {
+        pubsub_send_queue_t *queue; //entry type = psa_zmq_async_send_msg_t, NULL if async send is disabled
+        size_t batchSize;
+        celix_thread_t thread;
+        //encode buffers, only used by the async send thread
+        void *headerBuffer;
+        size_t headerBufferSize;
+        void *metadataBuffer;
+        size_t metadataBufferSize;
+        void *footerBuffer;
+        size_t footerBufferSize;
+    } async;
 };
 
 typedef struct psa_zmq_send_msg_entry {
@@ -116,6 +130,14 @@ typedef struct psa_zmq_bounded_service_entry {
     int getCount;
 } psa_zmq_bounded_service_entry_t;
 
+typedef struct psa_zmq_async_send_msg {
+    unsigned int msgTypeId;
+    unsigned int seqNr;
+    void *payload;
+    size_t payloadLength;
+    celix_properties_t *metadata;
+} psa_zmq_async_send_msg_t;
+
 typedef struct psa_zmq_zerocopy_free_entry {
     psa_zmq_serializer_entry_t *msgSer;
     struct iovec *serializedOutput;
@@ -127,6 +149,8 @@ static void* psa_zmq_getPublisherService(void *handle, const celix_bundle_t *req
 static void psa_zmq_ungetPublisherService(void *handle, const celix_bundle_t *requestingBundle, const celix_properties_t *svcProperties);
 static unsigned int rand_range(unsigned int min, unsigned int max);
 static void delay_first_send_for_late_joiners(pubsub_zmq_topic_sender_t *sender);
+static void* psa_zmq_asyncSendThread(void *data);
+static void psa_zmq_freeAsyncSendMsg(void *handle, void *msg);
 
 static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, const void *msg, celix_properties_t *metadata);
 
@@ -135,6 +159,7 @@ pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
         celix_log_helper_t *logHelper,
         const char *scope,
         const char *topic,
+        const celix_properties_t *topicProperties,
         const char* serializerType,
         void *admin,
         long protocolSvcId,
@@ -274,6 +299,22 @@ pubsub_zmq_topic_sender_t* pubsub_zmqTopicSender_create(
 
         celixThreadMutex_create(&sender->boundedServices.mutex, NULL);
         sender->boundedServices.map = hashMap_create(NULL, NULL, NULL, NULL);
+
+        bool async = topicProperties == NULL ? PUBSUB_ZMQ_PUBLISHER_ASYNC_SEND_DEFAULT :
+                     celix_properties_getAsBool(topicProperties, PUBSUB_ZMQ_PUBLISHER_ASYNC_SEND, PUBSUB_ZMQ_PUBLISHER_ASYNC_SEND_DEFAULT);
+        if (async) {
+            long queueSize = celix_properties_getAsLong(topicProperties, PUBSUB_ZMQ_PUBLISHER_ASYNC_QUEUE_SIZE, PUBSUB_ZMQ_PUBLISHER_ASYNC_QUEUE_SIZE_DEFAULT);
+            long batchSize = celix_properties_getAsLong(topicProperties, PUBSUB_ZMQ_PUBLISHER_ASYNC_BATCH_SIZE, PUBSUB_ZMQ_PUBLISHER_ASYNC_BATCH_SIZE_DEFAULT);
+            const char *policy = celix_properties_get(topicProperties, PUBSUB_ZMQ_PUBLISHER_ASYNC_BACKPRESSURE, PUBSUB_ZMQ_PUBLISHER_ASYNC_BACKPRESSURE_DEFAULT);
+            sender->async.batchSize = batchSize > 0 ? (size_t)batchSize : 1;
+            sender->async.queue = pubsub_sendQueue_create(queueSize > 0 ? (size_t)queueSize : PUBSUB_ZMQ_PUBLISHER_ASYNC_QUEUE_SIZE_DEFAULT,
+                                                          pubsub_sendQueue_parsePolicy(policy, PUBSUB_SEND_QUEUE_BLOCK),
+                                                          sender, psa_zmq_freeAsyncSendMsg);
+            celixThread_create(&sender->async.thread, NULL, psa_zmq_asyncSendThread, sender);
+            char name[64];
+            snprintf(name, 64, "ZMQ TS %s/%s", scope == NULL ? "(null)" : scope, topic);
+            celixThread_setName(&sender->async.thread, name);
+        }
     }
 
     //register publisher services using a service factory
@@ -323,6 +364,16 @@ void pubsub_zmqTopicSender_destroy(pubsub_zmq_topic_sender_t *sender) {
     if (sender != NULL) {
         celix_bundleContext_unregisterService(sender->ctx, sender->publisher.svcId);
 
+        if (sender->async.queue != NULL) {
+            //note the async send thread sends the queued messages before it stops
+            pubsub_sendQueue_close(sender->async.queue);
+            celixThread_join(sender->async.thread, NULL);
+            pubsub_sendQueue_destroy(sender->async.queue);
+            free(sender->async.headerBuffer);
+            free(sender->async.metadataBuffer);
+            free(sender->async.footerBuffer);
+        }
+
         zsock_destroy(&sender->zmq.socket);
 
         celixThreadMutex_lock(&sender->boundedServices.mutex);
@@ -487,9 +538,115 @@ pubsub_admin_sender_metrics_t* pubsub_zmqTopicSender_metrics(pubsub_zmq_topic_se
 
     celixThreadMutex_unlock(&sender->boundedServices.mutex);
     result->nrOfmsgMetrics = (int)count;
+
+    if (sender->async.queue != NULL) {
+        pubsub_send_queue_stats_t stats;
+        pubsub_sendQueue_getStats(sender->async.queue, &stats);
+        result->asyncSendEnabled = true;
+        result->sendQueueCapacity = stats.capacity;
+        result->sendQueueDepth = stats.size;
+        result->maxSendQueueDepth = stats.maxSize;
+        result->nrOfDroppedMessages = stats.nrOfDroppedMessages;
+        result->nrOfSendBatches = stats.nrOfBatches;
+    }
     return result;
 }
 
+static void psa_zmq_freeAsyncSendMsg(void *handle __attribute__((unused)), void *msg) {
+    psa_zmq_async_send_msg_t *asyncMsg = msg;
+    if (asyncMsg->metadata != NULL) {
+        celix_properties_destroy(asyncMsg->metadata);
+    }
+    free(asyncMsg->payload);
+    free(asyncMsg);
+}
+
+/**
+ * Queues a copy of the serialized message for the async send thread. Returns false if the message is dropped.
+ */
+static bool psa_zmq_queueMessage(pubsub_zmq_topic_sender_t *sender, psa_zmq_send_msg_entry_t *entry, unsigned int msgTypeId, const struct iovec *serializedOutput, celix_properties_t *metadata) {
+    psa_zmq_async_send_msg_t *msg = calloc(1, sizeof(*msg));
+    msg->msgTypeId = msgTypeId;
+    msg->seqNr = __atomic_fetch_add(&entry->seqNr, 1, __ATOMIC_RELAXED);
+    msg->payloadLength = serializedOutput->iov_len;
+    if (msg->payloadLength > 0) {
+        msg->payload = malloc(msg->payloadLength);
+        memcpy(msg->payload, serializedOutput->iov_base, msg->payloadLength);
+    }
+    msg->metadata = metadata;
+    bool queued = pubsub_sendQueue_push(sender->async.queue, msg);
+    if (!queued) {
+        psa_zmq_freeAsyncSendMsg(sender, msg);
+    }
+    return queued;
+}
+
+static bool psa_zmq_sendQueuedMessage(pubsub_zmq_topic_sender_t *sender, psa_zmq_async_send_msg_t *msg) {
+    pubsub_protocol_service_t *protSer = sender->protocol;
+    pubsub_protocol_message_t message;
+    message.payload.payload = msg->payload;
+    message.payload.length = msg->payloadLength;
+
+    void *payloadData = NULL;
+    size_t payloadLength = 0;
+    protSer->encodePayload(protSer->handle, &message, &payloadData, &payloadLength);
+
+    size_t metadataSize = 0;
+    message.metadata.metadata = msg->metadata;
+    if (msg->metadata != NULL) {
+        protSer->encodeMetadata(protSer->handle, &message, &sender->async.metadataBuffer, &sender->async.metadataBufferSize);
+        metadataSize = sender->async.metadataBufferSize;
+    }
+    protSer->encodeFooter(protSer->handle, &message, &sender->async.footerBuffer, &sender->async.footerBufferSize);
+
+    message.header.msgId = msg->msgTypeId;
+    message.header.seqNr = msg->seqNr;
+    message.header.msgMajorVersion = 0;
+    message.header.msgMinorVersion = 0;
+    message.header.payloadSize = payloadLength;
+    message.header.metadataSize = metadataSize;
+    message.header.payloadPartSize = payloadLength;
+    message.header.payloadOffset = 0;
+    message.header.isLastSegment = 1;
+    message.header.convertEndianess = 0;
+    protSer->encodeHeader(protSer->handle, &message, &sender->async.headerBuffer, &sender->async.headerBufferSize);
+
+    zmsg_t *zmsg = zmsg_new();
+    zmsg_addmem(zmsg, sender->async.headerBuffer, sender->async.headerBufferSize);
+    zmsg_addmem(zmsg, payloadData, payloadLength);
+    if (metadataSize > 0) {
+        zmsg_addmem(zmsg, sender->async.metadataBuffer, metadataSize);
+    }
+    if (sender->async.footerBufferSize > 0) {
+        zmsg_addmem(zmsg, sender->async.footerBuffer, sender->async.footerBufferSize);
+    }
+    int rc = zmsg_send(&zmsg, sender->zmq.socket);
+    if (rc != 0) {
+        zmsg_destroy(&zmsg); //if send was not ok, no owner change -> destroy msg
+    }
+    if (payloadData && (payloadData != message.payload.payload)) {
+        free(payloadData);
+    }
+    return rc == 0;
+}
+
+static void* psa_zmq_asyncSendThread(void *data) {
+    pubsub_zmq_topic_sender_t *sender = data;
+    void **msgs = calloc(sender->async.batchSize, sizeof(void*));
+    size_t count;
+    while ((count = pubsub_sendQueue_popBatch(sender->async.queue, msgs, sender->async.batchSize)) > 0) {
+        for (size_t i = 0; i < count; ++i) {
+            psa_zmq_async_send_msg_t *msg = msgs[i];
+            if (!psa_zmq_sendQueuedMessage(sender, msg)) {
+                L_WARN("[PSA_ZMQ_TS] Error sending queued zmg. %s", strerror(errno));
+            }
+            psa_zmq_freeAsyncSendMsg(sender, msg);
+        }
+    }
+    free(msgs);
+    return NULL;
+}
+
 static void psa_zmq_freeMsg(void *msg, void *hint) {
     psa_zmq_zerocopy_free_entry *entry = hint;
     entry->msgSer->svc->freeSerializedMsg(entry->msgSer->svc->handle, entry->serializedOutput, entry->serializedOutputLen);
@@ -553,7 +710,25 @@ static int psa_zmq_topicPublicationSend(void* handle, unsigned int msgTypeId, co
         clock_gettime(CLOCK_REALTIME, &serializationEnd);
     }
 
-    if (status == CELIX_SUCCESS /*ser ok*/) {
+    if (status == CELIX_SUCCESS && sender->async.queue != NULL) {
+        //async send, the ZMQ socket is only used by the async send thread
+        bool cont = pubsubInterceptorHandler_invokePreSend(sender->interceptorsHandler, serializer->fqn, msgTypeId, inMsg, &metadata);
+        if (cont) {
+            //note post send is invoked before queueing, because the queue takes ownership of the metadata
+            pubsubInterceptorHandler_invokePostSend(sender->interceptorsHandler, serializer->fqn, msgTypeId, inMsg, metadata);
+            bool queued = psa_zmq_queueMessage(sender, entry, msgTypeId, serializedOutput, metadata);
+            if (queued) {
+                sendCountUpdate = 1;
+            } else {
+                //note dropped messages are part of the sender metrics
+                sendErrorUpdate = 1;
+                status = CELIX_ILLEGAL_STATE;
+            }
+        } else if (metadata != NULL) {
+            celix_properties_destroy(metadata);
+        }
+        serializer->svc->freeSerializedMsg(serializer->svc->handle, serializedOutput, serializedOutputLen);
+    } else if (status == CELIX_SUCCESS /*ser ok*/) {
         // Some ZMQ functions are not thread-safe, but this atomic compare exchange ensures one access at a time.
         bool expected = false;
         while(!__atomic_compare_exchange_n(&entry->dataLocked, &expected, true, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
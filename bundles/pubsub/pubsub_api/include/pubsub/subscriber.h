@@ -32,13 +32,43 @@
 #include "celix_properties.h"
 
 #define PUBSUB_SUBSCRIBER_SERVICE_NAME          "pubsub.subscriber"
-#define PUBSUB_SUBSCRIBER_SERVICE_VERSION       "3.0.0"
+#define PUBSUB_SUBSCRIBER_SERVICE_VERSION       "3.1.0"
  
 //properties
 #define PUBSUB_SUBSCRIBER_TOPIC                "topic"
 #define PUBSUB_SUBSCRIBER_SCOPE                "scope"
 #define PUBSUB_SUBSCRIBER_CONFIG               "pubsub.config"
 
+/**
+ * If set to true, messages are delivered to the subscriber with the receiveShared function instead of the receive
+ * function. Note the receiveShared function is only used if this property is set.
+ */
+#define PUBSUB_SUBSCRIBER_SHARED_MESSAGES      "pubsub.shared.messages"
+
+typedef struct pubsub_shared_message pubsub_shared_message_t;
+
+/**
+ * A deserialized message which is shared between all shared subscribers of a topic. The message is immutable and
+ * reference counted. The message is only valid during the receiveShared call, unless the subscriber retains it.
+ */
+struct pubsub_shared_message {
+    /**
+     * The immutable deserialized message.
+     */
+    const void *msg;
+
+    /**
+     * Retains the shared message, after this the message stays valid until a matching release call.
+     * A retained message must be released before the subscriber service is unregistered.
+     */
+    void (*retain)(pubsub_shared_message_t *sharedMsg);
+
+    /**
+     * Releases a retained shared message.
+     */
+    void (*release)(pubsub_shared_message_t *sharedMsg);
+};
+
 struct pubsub_subscriber_struct {
     void *handle;
 
@@ -72,6 +102,23 @@ struct pubsub_subscriber_struct {
       */
     int (*receive)(void *handle, const char *msgType, unsigned int msgTypeId, void *msg, const celix_properties_t *metadata, bool *release);
 
+    /**
+     * When a new message for a topic is available the receiveShared will be called, if the subscriber service is
+     * registered with the PUBSUB_SUBSCRIBER_SHARED_MESSAGES property set to true.
+     *
+     * The message is deserialized once and the same shared message is delivered to all shared subscribers.
+     * The message cannot be changed. Use the retain function of the shared message to keep the message after the
+     * receiveShared call.
+     *
+     * @param handle       The subscriber handle
+     * @param msgType      The fully qualified type name
+     * @param msgTypeId    The local type id of the type.
+     * @param msg          The shared message.
+     * @param metadata     The meta data provided with the data. Can be NULL. Only valid during the receiveShared call.
+     * @return Return 0 implies a successful handling.
+     */
+    int (*receiveShared)(void *handle, const char *msgType, unsigned int msgTypeId, pubsub_shared_message_t *msg, const celix_properties_t *metadata);
+
 };
 typedef struct pubsub_subscriber_struct pubsub_subscriber_t;
 
@@ -83,6 +83,10 @@ pubsub_discovery_t* pubsub_discovery_create(celix_bundle_context_t *context, cel
     disc->sleepInsecBetweenTTLRefresh = (int)(((float)ttl)/2.0);
     disc->pubsubPath = celix_bundleContext_getProperty(context, PUBSUB_DISCOVERY_SERVER_PATH_KEY, PUBSUB_DISCOVERY_SERVER_PATH_DEFAULT);
     disc->fwUUID = celix_bundleContext_getProperty(context, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+    disc->batchRefresh = celix_bundleContext_getPropertyAsBool(context, PUBSUB_DISCOVERY_ETCD_BATCH_REFRESH_KEY, PUBSUB_DISCOVERY_ETCD_BATCH_REFRESH_DEFAULT);
+    if (disc->batchRefresh) {
+        asprintf(&disc->fwDirectory, "/pubsub/%s", disc->fwUUID);
+    }
 
     return disc;
 }
@@ -120,6 +124,7 @@ celix_status_t pubsub_discovery_destroy(pubsub_discovery_t *ps_discovery) {
         ps_discovery->etcdlib = NULL;
     }
 
+    free(ps_discovery->fwDirectory);
     free(ps_discovery);
 
     return status;
@@ -149,43 +154,77 @@ static void psd_watchSetupConnection(pubsub_discovery_t *disc, bool *connectedPt
     }
 }
 
+static void psd_removeDiscoveredEndpointsOfFramework(pubsub_discovery_t *disc, const char *fwUUID) {
+    celix_array_list_t *uuids = celix_arrayList_create();
+    celixThreadMutex_lock(&disc->discoveredEndpointsMutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(disc->discoveredEndpoints);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_properties_t *endpoint = hashMapIterator_nextValue(&iter);
+        const char *epFwUUID = celix_properties_get(endpoint, PUBSUB_ENDPOINT_FRAMEWORK_UUID, NULL);
+        if (epFwUUID != NULL && strcmp(epFwUUID, fwUUID) == 0) {
+            celix_arrayList_add(uuids, strdup(celix_properties_get(endpoint, PUBSUB_ENDPOINT_UUID, "")));
+        }
+    }
+    celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
+
+    for (int i = 0; i < celix_arrayList_size(uuids); ++i) {
+        char *uuid = celix_arrayList_get(uuids, i);
+        pubsub_discovery_removeDiscoveredEndpoint(disc, uuid);
+        free(uuid);
+    }
+    celix_arrayList_destroy(uuids);
+}
+
+static bool psd_handleWatchEvents(const etcdlib_watch_event_t *events, int nrOfEvents, void *data) {
+    pubsub_discovery_t *disc = data;
+    for (int i = 0; i < nrOfEvents; ++i) {
+        const etcdlib_watch_event_t *event = &events[i];
+        if (event->action == NULL || event->key == NULL) {
+            continue;
+        }
+        const char *action = event->action;
+        bool isDelete = strncmp(ETCDLIB_ACTION_DELETE, action, strlen(ETCDLIB_ACTION_DELETE)) == 0 ||
+                        strncmp(ETCDLIB_ACTION_EXPIRE, action, strlen(ETCDLIB_ACTION_EXPIRE)) == 0;
+        const char *lastPart = strrchr(event->key, '/');
+        lastPart = lastPart == NULL ? event->key : lastPart + 1;
+        if (event->dir) {
+            //a deleted or expired framework directory (see PUBSUB_DISCOVERY_ETCD_BATCH_REFRESH) does not produce
+            //events for the endpoints in the directory
+            if (isDelete) {
+                psd_removeDiscoveredEndpointsOfFramework(disc, lastPart);
+            }
+        } else if (strncmp(ETCDLIB_ACTION_CREATE, action, strlen(ETCDLIB_ACTION_CREATE)) == 0 ||
+                   strncmp(ETCDLIB_ACTION_SET, action, strlen(ETCDLIB_ACTION_SET)) == 0 ||
+                   strncmp(ETCDLIB_ACTION_UPDATE, action, strlen(ETCDLIB_ACTION_UPDATE)) == 0) {
+            if (event->value != NULL) {
+                celix_properties_t *props = pubsub_discovery_parseEndpoint(disc, event->key, event->value);
+                if (props != NULL) {
+                    pubsub_discovery_addDiscoveredEndpoint(disc, props);
+                }
+            }
+        } else if (isDelete) {
+            pubsub_discovery_removeDiscoveredEndpoint(disc, lastPart);
+        } else {
+            //ETCDLIB_ACTION_GET -> nop
+        }
+    }
+
+    celixThreadMutex_lock(&disc->runningMutex);
+    bool running = disc->running;
+    celixThreadMutex_unlock(&disc->runningMutex);
+    return running;
+}
+
 static void psd_watchForChange(pubsub_discovery_t *disc, bool *connectedPtr, long long *mIndex) {
     bool connected = *connectedPtr;
     if (connected) {
         long long watchIndex = *mIndex + 1;
 
-        char *action = NULL;
-        char *value = NULL;
-        char *readKey = NULL;
-        //TODO add interruptable etcdlib_watch -> which returns a handle to interrupt and a can be used for a wait call
-        int rc = etcdlib_watch(disc->etcdlib, disc->pubsubPath, watchIndex, &action, NULL, &value, &readKey, mIndex);
+        //streaming watch, returns when etcd ends the stream, on an error or when interrupted (see pubsub_discovery_stop)
+        int rc = etcdlib_watch_stream(disc->etcdlib, disc->pubsubPath, watchIndex, psd_handleWatchEvents, disc, mIndex);
         if (rc == ETCDLIB_RC_ERROR) {
-            L_ERROR("[PSD] Communicating with etcd. rc is %i, action value is %s\n", rc, action);
+            L_ERROR("[PSD] Communicating with etcd. rc is %i\n", rc);
             *connectedPtr = false;
-        } else if (rc == ETCDLIB_RC_TIMEOUT || action == NULL) {
-            //nop
-        } else {
-            if (strncmp(ETCDLIB_ACTION_CREATE, action, strlen(ETCDLIB_ACTION_CREATE)) == 0 ||
-                       strncmp(ETCDLIB_ACTION_SET, action, strlen(ETCDLIB_ACTION_SET)) == 0 ||
-                       strncmp(ETCDLIB_ACTION_UPDATE, action, strlen(ETCDLIB_ACTION_UPDATE)) == 0) {
-                celix_properties_t *props = pubsub_discovery_parseEndpoint(disc, readKey, value);
-                if (props != NULL) {
-                    pubsub_discovery_addDiscoveredEndpoint(disc, props);
-                }
-            } else if (strncmp(ETCDLIB_ACTION_DELETE, action, strlen(ETCDLIB_ACTION_DELETE)) == 0 ||
-                       strncmp(ETCDLIB_ACTION_EXPIRE, action, strlen(ETCDLIB_ACTION_EXPIRE)) == 0) {
-                char *uuid = strrchr(readKey, '/');
-                if (uuid != NULL) {
-                    uuid = uuid + 1;
-                    pubsub_discovery_removeDiscoveredEndpoint(disc, uuid);
-                }
-            } else {
-                //ETCDLIB_ACTION_GET -> nop
-            }
-
-            free(action);
-            free(value);
-            free(readKey);
         }
     } else {
         if (disc->verbose) {
@@ -249,6 +288,37 @@ void* psd_watch(void *data) {
     return NULL;
 }
 
+/**
+ * Creates or refreshes (a single request for all announced endpoints) the framework directory.
+ * If the directory was expired, all announced endpoints are marked as not set.
+ * Should be called with the announcedEndpointsMutex locked.
+ */
+static void psd_refreshFrameworkDirectory(pubsub_discovery_t *disc) {
+    bool wasSet = disc->fwDirectorySet;
+    int rc = ETCDLIB_RC_ERROR;
+    if (wasSet) {
+        rc = etcdlib_refresh_directory(disc->etcdlib, disc->fwDirectory, disc->ttlForEntries);
+    }
+    if (rc != ETCDLIB_RC_OK) {
+        rc = etcdlib_set_directory(disc->etcdlib, disc->fwDirectory, disc->ttlForEntries, false);
+    }
+    disc->fwDirectorySet = rc == ETCDLIB_RC_OK;
+
+    if (!disc->fwDirectorySet || !wasSet) {
+        if (wasSet) {
+            L_WARN("[PSD] Warning: Cannot refresh etcd directory %s\n", disc->fwDirectory);
+        }
+        hash_map_iterator_t iter = hashMapIterator_construct(disc->announcedEndpoints);
+        while (hashMapIterator_hasNext(&iter)) {
+            pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (entry->isSet) {
+                entry->isSet = false;
+                entry->errorCount += 1;
+            }
+        }
+    }
+}
+
 void* psd_refresh(void *data) {
     pubsub_discovery_t *disc = data;
 
@@ -261,10 +331,18 @@ void* psd_refresh(void *data) {
         clock_gettime(CLOCK_MONOTONIC, &start);
 
         celixThreadMutex_lock(&disc->announcedEndpointsMutex);
+        if (disc->batchRefresh) {
+            psd_refreshFrameworkDirectory(disc);
+        }
         hash_map_iterator_t iter = hashMapIterator_construct(disc->announcedEndpoints);
         while (hashMapIterator_hasNext(&iter)) {
             pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
-            if (entry->isSet) {
+            if (disc->batchRefresh && !disc->fwDirectorySet) {
+                //cannot set endpoints without framework directory, retry next period
+                continue;
+            } else if (disc->batchRefresh && entry->isSet) {
+                entry->refreshCount += 1;
+            } else if (entry->isSet) {
                 //only refresh ttl -> no index update -> no watch trigger
                 int rc = etcdlib_refresh(disc->etcdlib, entry->key, disc->ttlForEntries);
                 if (rc != ETCDLIB_RC_OK) {
@@ -276,7 +354,8 @@ void* psd_refresh(void *data) {
                 }
             } else {
                 char *str = pubsub_discovery_createJsonEndpoint(entry->properties);
-                int rc = etcdlib_set(disc->etcdlib, entry->key, str, disc->ttlForEntries, false);
+                //note in batch refresh mode the entries expire with the framework directory
+                int rc = etcdlib_set(disc->etcdlib, entry->key, str, disc->batchRefresh ? 0 : disc->ttlForEntries, false);
                 if (rc == ETCDLIB_RC_OK) {
                     entry->isSet = true;
                     entry->setCount += 1;
@@ -315,6 +394,7 @@ celix_status_t pubsub_discovery_stop(pubsub_discovery_t *disc) {
     disc->running = false;
     celixThreadCondition_broadcast(&disc->waitCond);
     celixThreadMutex_unlock(&disc->runningMutex);
+    etcdlib_interrupt_watch(disc->etcdlib);
 
     celixThread_join(disc->watchThread, NULL);
     celixThread_join(disc->refreshTTLThread, NULL);
@@ -338,10 +418,15 @@ celix_status_t pubsub_discovery_stop(pubsub_discovery_t *disc) {
     celixThreadMutex_unlock(&disc->discoveredEndpointsMutex);
 
     celixThreadMutex_lock(&disc->announcedEndpointsMutex);
+    if (disc->batchRefresh && disc->fwDirectorySet) {
+        //removes all announced endpoints
+        etcdlib_del(disc->etcdlib, disc->fwDirectory);
+        disc->fwDirectorySet = false;
+    }
     iter = hashMapIterator_construct(disc->announcedEndpoints);
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_announce_entry_t *entry = hashMapIterator_nextValue(&iter);
-        if (entry->isSet) {
+        if (entry->isSet && !disc->batchRefresh) {
             etcdlib_del(disc->etcdlib, entry->key);
         }
         free(entry->key);
@@ -398,7 +483,11 @@ celix_status_t pubsub_discovery_announceEndpoint(void *handle, const celix_prope
         clock_gettime(CLOCK_MONOTONIC, &entry->createTime);
         entry->isSet = false;
         entry->properties = celix_properties_copy(endpoint);
-        asprintf(&entry->key, "/pubsub/%s/%s/%s/%s", config, scope == NULL ? PUBSUB_DEFAULT_ENDPOINT_SCOPE : scope, topic, uuid);
+        if (disc->batchRefresh) {
+            asprintf(&entry->key, "%s/%s/%s/%s/%s", disc->fwDirectory, config, scope == NULL ? PUBSUB_DEFAULT_ENDPOINT_SCOPE : scope, topic, uuid);
+        } else {
+            asprintf(&entry->key, "/pubsub/%s/%s/%s/%s", config, scope == NULL ? PUBSUB_DEFAULT_ENDPOINT_SCOPE : scope, topic, uuid);
+        }
 
         const char *hashKey = celix_properties_get(entry->properties, PUBSUB_ENDPOINT_UUID, NULL);
         celixThreadMutex_lock(&disc->announcedEndpointsMutex);
@@ -581,6 +670,7 @@ bool pubsub_discovery_executeCommand(void *handle, const char * commandLine __at
     fprintf(os, "   |- entries ttl              = %i seconds\n", disc->ttlForEntries);
     fprintf(os, "   |- entries refresh time     = %i seconds\n", disc->sleepInsecBetweenTTLRefresh);
     fprintf(os, "   |- pubsub discovery path    = %s\n", disc->pubsubPath);
+    fprintf(os, "   |- batch refresh            = %s\n", disc->batchRefresh ? "true" : "false");
 
     fprintf(os, "\n");
     fprintf(os, "Discovered Endpoints:\n");
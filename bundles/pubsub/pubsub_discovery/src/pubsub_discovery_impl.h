@@ -38,11 +38,18 @@
 #define PUBSUB_DISCOVERY_SERVER_PATH_KEY        "PUBSUB_DISCOVERY_ETCD_ROOT_PATH"
 #define PUBSUB_DISCOVERY_ETCD_TTL_KEY           "PUBSUB_DISCOVERY_ETCD_TTL"
 
+/**
+ * If true, the endpoints are announced in a framework directory (/pubsub/<framework uuid>/...) with a TTL and the TTL
+ * of all announced endpoints is refreshed with a single directory refresh, instead of a refresh per endpoint.
+ */
+#define PUBSUB_DISCOVERY_ETCD_BATCH_REFRESH_KEY "PUBSUB_DISCOVERY_ETCD_BATCH_REFRESH"
+
 
 #define PUBSUB_DISCOVERY_SERVER_IP_DEFAULT      "127.0.0.1"
 #define PUBSUB_DISCOVERY_SERVER_PORT_DEFAULT    2379
 #define PUBSUB_DISCOVERY_SERVER_PATH_DEFAULT    "pubsub/"
 #define PUBSUB_DISCOVERY_ETCD_TTL_DEFAULT       30
+#define PUBSUB_DISCOVERY_ETCD_BATCH_REFRESH_DEFAULT false
 
 typedef struct pubsub_discovery {
     celix_bundle_context_t *context;
@@ -70,6 +77,9 @@ typedef struct pubsub_discovery {
     int ttlForEntries;
     int sleepInsecBetweenTTLRefresh;
     const char *fwUUID;
+    bool batchRefresh;
+    char *fwDirectory; //etcd directory of the announced endpoints if batchRefresh is enabled
+    bool fwDirectorySet; //protected by announcedEndpointsMutex
 } pubsub_discovery_t;
 
 typedef struct pubsub_announce_entry {
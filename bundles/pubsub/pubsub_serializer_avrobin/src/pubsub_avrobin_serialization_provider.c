@@ -90,9 +90,7 @@ celix_status_t pubsub_avrobinSerializationProvider_deserialize(pubsub_serializat
     dyn_type* dynType;
     dynMessage_getMessageType(entry->msgType, &dynType);
 
-    assert(inputIovLen == 1);
-
-    if (avrobinSerializer_deserialize(dynType, (uint8_t *)input->iov_base, input->iov_len, &msg) != 0) {
+    if (avrobinSerializer_deserializeIoVec(dynType, input, inputIovLen, &msg) != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
     } else{
         *out = msg;
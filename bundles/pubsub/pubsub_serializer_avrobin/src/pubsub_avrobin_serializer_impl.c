@@ -32,6 +32,7 @@
 #include "celix_log_helper.h"
 
 #include "avrobin_serializer.h"
+#include "dyn_cache.h"
 
 #include "pubsub_avrobin_serializer_impl.h"
 
@@ -145,7 +146,7 @@ celix_status_t pubsubAvrobinSerializer_destroySerializerMap(void *handle, hash_m
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_msg_serializer_t* msgSerializer = hashMapIterator_nextValue(&iter);
         pubsub_avrobin_msg_serializer_impl_t *impl = msgSerializer->handle;
-        dynMessage_destroy(impl->msgType);
+        dynCache_releaseMessage(impl->msgType);
         free(msgSerializer); //also contains the service struct.
         free(impl);
     }
@@ -207,7 +208,7 @@ void pubsubMsgAvrobinSerializer_freeSerializeMsg(void* handle, struct iovec* inp
 }
 
 
-static celix_status_t pubsubMsgAvrobinSerializer_deserialize(void *handle, const struct iovec* input, size_t inputIovLen __attribute__((unused)), void **out) {
+static celix_status_t pubsubMsgAvrobinSerializer_deserialize(void *handle, const struct iovec* input, size_t inputIovLen, void **out) {
     celix_status_t status = CELIX_SUCCESS;
     if (input == NULL) return CELIX_BUNDLE_EXCEPTION;
     pubsub_avrobin_msg_serializer_impl_t *impl = handle;
@@ -216,7 +217,7 @@ static celix_status_t pubsubMsgAvrobinSerializer_deserialize(void *handle, const
     dyn_type *dynType = NULL;
     dynMessage_getMessageType(impl->msgType, &dynType);
 
-    if (avrobinSerializer_deserialize(dynType, (const uint8_t*)input->iov_base, input->iov_len, &msg) != 0) {
+    if (avrobinSerializer_deserializeIoVec(dynType, input, inputIovLen, &msg) != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
     } else {
         *out = msg;
@@ -306,12 +307,12 @@ static void pubsubAvrobinSerializer_addMsgSerializerFromBundle(const char *root,
         // serializer has been constructed, try to put in the map
         if (hashMap_containsKey(msgTypesMap, (void *) (uintptr_t) msgSerializer->msgId)) {
             printf("Cannot add msg %s. clash in msg id %d!!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
+            dynCache_releaseMessage(impl->msgType);
             free(msgSerializer);
             free(impl);
         } else if (msgSerializer->msgId == 0) {
             printf("Cannot add msg %s. clash in msg id %d!!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
+            dynCache_releaseMessage(impl->msgType);
             free(msgSerializer);
             free(impl);
         }
@@ -421,7 +422,14 @@ static bool readPropertiesFile(const char* properties_file_name, const char* roo
 
 static int pubsubMsgAvrobinSerializer_convertDescriptor(FILE* file_ptr, pubsub_msg_serializer_t* serializer) {
     dyn_message_type* msgType = NULL;
-    int rc = dynMessage_parse(file_ptr, &msgType);
+    char *descriptor = NULL;
+    size_t descriptorLength = 0;
+    int rc = dynCache_readDescriptor(file_ptr, &descriptor, &descriptorLength);
+    if (rc == 0) {
+        //note identical descriptors (e.g. the same message in multiple bundles) are parsed only once
+        rc = dynCache_getMessage(descriptor, descriptorLength, &msgType);
+        free(descriptor);
+    }
     if (rc != 0 || msgType == NULL) {
         printf("DMU: cannot parse message from descriptor.\n");
         return -1;
@@ -435,6 +443,7 @@ static int pubsubMsgAvrobinSerializer_convertDescriptor(FILE* file_ptr, pubsub_m
 
     if (rc != 0 || msgName == NULL || msgVersion == NULL) {
         printf("DMU: cannot retrieve name and/or version from msg\n");
+        dynCache_releaseMessage(msgType);
         return -1;
     }
 
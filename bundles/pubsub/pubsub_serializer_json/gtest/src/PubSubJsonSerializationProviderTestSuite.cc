@@ -23,12 +23,22 @@
 
 #include <celix_api.h>
 #include "pubsub_message_serialization_service.h"
+#include "pubsub_serializer.h"
+
+struct poi1 {
+    struct {
+        double lat;
+        double lon;
+    } location;
+    const char *name;
+};
 
 class PubSubJsonSerializationProviderTestSuite : public ::testing::Test {
 public:
-    PubSubJsonSerializationProviderTestSuite() {
+    explicit PubSubJsonSerializationProviderTestSuite(bool usePlans = true) {
         auto* props = celix_properties_create();
         celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".pubsub_json_serializer_cache");
+        celix_properties_setBool(props, "PUBSUB_JSON_SERIALIZER_USE_PLANS", usePlans);
         auto* fwPtr = celix_frameworkFactory_createFramework(props);
         auto* ctxPtr = celix_framework_getFrameworkContext(fwPtr);
         fw = std::shared_ptr<celix_framework_t>{fwPtr, [](auto* f) {celix_frameworkFactory_destroyFramework(f);}};
@@ -38,15 +48,71 @@ public:
         const char* serBundleFile = SERIALIZATION_BUNDLE;
         long bndId;
 
-        bndId = celix_bundleContext_installBundle(ctx.get(), descBundleFile, true);
-        EXPECT_TRUE(bndId >= 0);
+        descBndId = celix_bundleContext_installBundle(ctx.get(), descBundleFile, true);
+        EXPECT_TRUE(descBndId >= 0);
 
         bndId = celix_bundleContext_installBundle(ctx.get(), serBundleFile, true);
         EXPECT_TRUE(bndId >= 0);
     }
 
+    /**
+     * Serializes and deserializes a poi1 message with the (deprecated) serializer service and checks the result.
+     */
+    void serializerServiceRoundTrip() {
+        celix_service_use_options_t opts{};
+        opts.filter.serviceName = PUBSUB_SERIALIZER_SERVICE_NAME;
+        opts.callbackHandle = this;
+        opts.use = [](void *handle, void *svc) {
+            auto* suite = static_cast<PubSubJsonSerializationProviderTestSuite*>(handle);
+            auto* serSvc = static_cast<pubsub_serializer_service_t*>(svc);
+            struct use_data {
+                pubsub_serializer_service_t* svc;
+                hash_map_pt map;
+            } data{serSvc, nullptr};
+            celix_bundleContext_useBundle(suite->ctx.get(), suite->descBndId, &data, [](void *handle, const celix_bundle_t *bnd) {
+                auto* d = static_cast<use_data*>(handle);
+                d->svc->createSerializerMap(d->svc->handle, bnd, &d->map);
+            });
+            ASSERT_NE(nullptr, data.map);
+            ASSERT_EQ(1, hashMap_size(data.map));
+            hash_map_iterator_t iter = hashMapIterator_construct(data.map);
+            auto* msgSer = static_cast<pubsub_msg_serializer_t*>(hashMapIterator_nextValue(&iter));
+            EXPECT_STREQ("poi1", msgSer->msgName);
+
+            poi1 in{};
+            in.location.lat = 42;
+            in.location.lon = 43;
+            in.name = "test";
+            struct iovec* outVec = nullptr;
+            size_t outSize = 0;
+            EXPECT_EQ(CELIX_SUCCESS, msgSer->serialize(msgSer->handle, &in, &outVec, &outSize));
+            ASSERT_NE(nullptr, outVec);
+
+            poi1 *out = nullptr;
+            EXPECT_EQ(CELIX_SUCCESS, msgSer->deserialize(msgSer->handle, outVec, outSize, (void**)&out));
+            ASSERT_NE(nullptr, out);
+            EXPECT_NE(&in, out);
+            EXPECT_EQ(42, out->location.lat);
+            EXPECT_EQ(43, out->location.lon);
+            ASSERT_NE(nullptr, out->name);
+            EXPECT_STREQ("test", out->name);
+
+            msgSer->freeDeserializeMsg(msgSer->handle, out);
+            msgSer->freeSerializeMsg(msgSer->handle, outVec, outSize);
+            serSvc->destroySerializerMap(serSvc->handle, data.map);
+        };
+        bool called = celix_bundleContext_useServiceWithOptions(ctx.get(), &opts);
+        EXPECT_TRUE(called);
+    }
+
     std::shared_ptr<celix_framework_t> fw{};
     std::shared_ptr<celix_bundle_context_t> ctx{};
+    long descBndId{-1L};
+};
+
+class PubSubJsonSerializationProviderWithoutPlansTestSuite : public PubSubJsonSerializationProviderTestSuite {
+public:
+    PubSubJsonSerializationProviderWithoutPlansTestSuite() : PubSubJsonSerializationProviderTestSuite{false} {}
 };
 
 
@@ -60,14 +126,6 @@ TEST_F(PubSubJsonSerializationProviderTestSuite, FindSerializationServices) {
     celix_arrayList_destroy(services);
 }
 
-struct poi1 {
-    struct {
-        double lat;
-        double lon;
-    } location;
-    const char *name;
-};
-
 TEST_F(PubSubJsonSerializationProviderTestSuite, SerializeTest) {
     poi1 p;
     p.location.lat = 42;
@@ -113,3 +171,13 @@ TEST_F(PubSubJsonSerializationProviderTestSuite, DeserializeTest) {
     bool called = celix_bundleContext_useServiceWithOptions(ctx.get(), &opts);
     EXPECT_TRUE(called);
 }
+
+TEST_F(PubSubJsonSerializationProviderTestSuite, SerializerServiceRoundTripTest) {
+    //note uses the precompiled plans
+    serializerServiceRoundTrip();
+}
+
+TEST_F(PubSubJsonSerializationProviderWithoutPlansTestSuite, SerializerServiceRoundTripTest) {
+    //note uses the DOM based (jansson) path
+    serializerServiceRoundTrip();
+}
@@ -27,6 +27,10 @@
 #include "dyn_message.h"
 #include "celix_log_helper.h"
 #include "pubsub_message_serialization_service.h"
+#include "pubsub_serializer_impl.h"
+
+//note serialization entries have no handle to the provider, the plans themselves are cached in the dyn types
+static bool usePlans = PUBSUB_JSON_SERIALIZER_USE_PLANS_DEFAULT;
 
 static void dfi_log(void *handle, int level, const char *file, int line, const char *msg, ...) {
     va_list ap;
@@ -51,16 +55,24 @@ static celix_status_t pubsub_jsonSerializationProvider_serialize(pubsub_serializ
     }
 
     char *jsonOutput = NULL;
+    size_t jsonOutputLen = 0;
     dyn_type* dynType;
     dynMessage_getMessageType(entry->msgType, &dynType);
 
-    if (jsonSerializer_serialize(dynType, msg, &jsonOutput) != 0) {
+    if (usePlans) {
+        json_serializer_plan_t *plan = NULL;
+        if (jsonSerializer_getPlan(dynType, &plan) != 0 || jsonSerializer_serializeWithPlan(plan, msg, &jsonOutput, &jsonOutputLen) != 0) {
+            status = CELIX_BUNDLE_EXCEPTION;
+        }
+    } else if (jsonSerializer_serialize(dynType, msg, &jsonOutput) != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
+    } else {
+        jsonOutputLen = strlen(jsonOutput);
     }
 
     if (status == CELIX_SUCCESS) {
         (**output).iov_base = (void*)jsonOutput;
-        (**output).iov_len  = strlen(jsonOutput);
+        (**output).iov_len  = jsonOutputLen;
     }
 
     return status;
@@ -88,7 +100,18 @@ static celix_status_t pubsub_jsonSerializationProvider_deserialize(pubsub_serial
     dyn_type* dynType;
     dynMessage_getMessageType(entry->msgType, &dynType);
 
-    if (jsonSerializer_deserialize(dynType, (const char*)input->iov_base, input->iov_len, &msg) != 0) {
+    int rc;
+    if (usePlans) {
+        json_serializer_plan_t *plan = NULL;
+        rc = jsonSerializer_getPlan(dynType, &plan);
+        if (rc == 0) {
+            rc = jsonSerializer_deserializeWithPlan(plan, (const char*)input->iov_base, input->iov_len, &msg);
+        }
+    } else {
+        rc = jsonSerializer_deserialize(dynType, (const char*)input->iov_base, input->iov_len, &msg);
+    }
+
+    if (rc != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
     } else{
         *out = msg;
@@ -108,6 +131,7 @@ static void pubsub_jsonSerializationProvider_freeDeserializeMsg(pubsub_serializa
 pubsub_serialization_provider_t* pubsub_jsonSerializationProvider_create(celix_bundle_context_t* ctx)  {
     pubsub_serialization_provider_t* provider = pubsub_serializationProvider_create(ctx, "json", 0, pubsub_jsonSerializationProvider_serialize, pubsub_jsonSerializationProvider_freeSerializeMsg, pubsub_jsonSerializationProvider_deserialize, pubsub_jsonSerializationProvider_freeDeserializeMsg);
     jsonSerializer_logSetup(dfi_log, pubsub_serializationProvider_getLogHelper(provider), 1);;
+    usePlans = celix_bundleContext_getPropertyAsBool(ctx, PUBSUB_JSON_SERIALIZER_USE_PLANS, PUBSUB_JSON_SERIALIZER_USE_PLANS_DEFAULT);
     return provider;
 }
 
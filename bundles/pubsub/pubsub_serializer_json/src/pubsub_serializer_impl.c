@@ -31,6 +31,7 @@
 #include "celix_log_helper.h"
 
 #include "json_serializer.h"
+#include "dyn_cache.h"
 
 #include "pubsub_serializer_impl.h"
 
@@ -48,6 +49,7 @@ FILE_INPUT_TYPE;
 struct pubsub_json_serializer {
     celix_bundle_context_t *bundle_context;
     celix_log_helper_t *log;
+    bool usePlans;
 };
 
 #define L_DEBUG(...) \
@@ -76,6 +78,7 @@ typedef struct pubsub_json_msg_serializer_impl {
     unsigned int msgId;
     const char* msgName;
     version_pt msgVersion;
+    bool usePlans;
 } pubsub_json_msg_serializer_impl_t;
 
 static char* pubsubSerializer_getMsgDescriptionDir(const celix_bundle_t *bundle);
@@ -106,6 +109,7 @@ celix_status_t pubsubSerializer_create(celix_bundle_context_t *context, pubsub_j
     } else {
         (*serializer)->bundle_context= context;
         (*serializer)->log = celix_logHelper_create(context, "celix_psa_serializer_json");
+        (*serializer)->usePlans = celix_bundleContext_getPropertyAsBool(context, PUBSUB_JSON_SERIALIZER_USE_PLANS, PUBSUB_JSON_SERIALIZER_USE_PLANS_DEFAULT);
         jsonSerializer_logSetup(dfi_log, (*serializer), 1);
         dynFunction_logSetup(dfi_log, (*serializer), 1);
         dynType_logSetup(dfi_log, (*serializer), 1);
@@ -146,7 +150,7 @@ celix_status_t pubsubSerializer_destroySerializerMap(void* handle __attribute__(
     while (hashMapIterator_hasNext(&iter)) {
         pubsub_msg_serializer_t* msgSerializer = hashMapIterator_nextValue(&iter);
         pubsub_json_msg_serializer_impl_t *impl = msgSerializer->handle;
-        dynMessage_destroy(impl->msgType);
+        dynCache_releaseMessage(impl->msgType);
         free(msgSerializer); //also contains the service struct.
         free(impl);
     }
@@ -168,16 +172,24 @@ celix_status_t pubsubMsgSerializer_serialize(void *handle, const void* msg, stru
     }
 
     char *jsonOutput = NULL;
+    size_t jsonOutputLen = 0;
     dyn_type* dynType;
     dynMessage_getMessageType(impl->msgType, &dynType);
 
-    if (jsonSerializer_serialize(dynType, msg, &jsonOutput) != 0) {
+    if (impl->usePlans) {
+        json_serializer_plan_t *plan = NULL;
+        if (jsonSerializer_getPlan(dynType, &plan) != 0 || jsonSerializer_serializeWithPlan(plan, msg, &jsonOutput, &jsonOutputLen) != 0) {
+            status = CELIX_BUNDLE_EXCEPTION;
+        }
+    } else if (jsonSerializer_serialize(dynType, msg, &jsonOutput) != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
+    } else {
+        jsonOutputLen = strlen(jsonOutput);
     }
 
     if (status == CELIX_SUCCESS) {
         (**output).iov_base = (void*)jsonOutput;
-        (**output).iov_len  = strlen(jsonOutput);
+        (**output).iov_len  = jsonOutputLen;
         if (outputIovLen) *outputIovLen = 1;
     }
 
@@ -192,10 +204,16 @@ celix_status_t pubsubMsgSerializer_deserialize(void* handle, const struct iovec*
     dyn_type* dynType;
     dynMessage_getMessageType(impl->msgType, &dynType);
 
-    if (jsonSerializer_deserialize(dynType, (const char*)input->iov_base, input->iov_len, &msg) != 0) {
+    if (impl->usePlans) {
+        json_serializer_plan_t *plan = NULL;
+        if (jsonSerializer_getPlan(dynType, &plan) != 0 || jsonSerializer_deserializeWithPlan(plan, (const char*)input->iov_base, input->iov_len, &msg) != 0) {
+            status = CELIX_BUNDLE_EXCEPTION;
+        }
+    } else if (jsonSerializer_deserialize(dynType, (const char*)input->iov_base, input->iov_len, &msg) != 0) {
         status = CELIX_BUNDLE_EXCEPTION;
     }
-    else{
+
+    if (status == CELIX_SUCCESS) {
         *out = msg;
     }
 
@@ -300,6 +318,7 @@ static void pubsubSerializer_addMsgSerializerFromBundle(pubsub_json_serializer_t
         }
 
         pubsub_json_msg_serializer_impl_t *impl = calloc(1, sizeof(*impl));
+        impl->usePlans = serializer->usePlans;
         pubsub_msg_serializer_t *msgSerializer = calloc(1,sizeof(*msgSerializer));
         msgSerializer->handle = impl;
 
@@ -322,12 +341,12 @@ static void pubsubSerializer_addMsgSerializerFromBundle(pubsub_json_serializer_t
         // serializer has been constructed, try to put in the map
         if (hashMap_containsKey(msgSerializers, (void *) (uintptr_t) msgSerializer->msgId)) {
             L_WARN("Cannot add msg %s. Clash is msg id %d!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
+            dynCache_releaseMessage(impl->msgType);
             free(msgSerializer);
             free(impl);
         } else if (msgSerializer->msgId == 0) {
             L_WARN("Cannot add msg %s. Clash is msg id %d!\n", msgSerializer->msgName, msgSerializer->msgId);
-            dynMessage_destroy(impl->msgType);
+            dynCache_releaseMessage(impl->msgType);
             free(msgSerializer);
             free(impl);
         }
@@ -417,7 +436,14 @@ static bool readPropertiesFile(pubsub_json_serializer_t* serializer, const char*
 
 static int pubsubMsgSerializer_convertDescriptor(pubsub_json_serializer_t* serializer, FILE* file_ptr, pubsub_msg_serializer_t* msgSerializer) {
     dyn_message_type *msgType = NULL;
-    int rc = dynMessage_parse(file_ptr, &msgType);
+    char *descriptor = NULL;
+    size_t descriptorLength = 0;
+    int rc = dynCache_readDescriptor(file_ptr, &descriptor, &descriptorLength);
+    if (rc == 0) {
+        //note identical descriptors (e.g. the same message in multiple bundles) are parsed only once
+        rc = dynCache_getMessage(descriptor, descriptorLength, &msgType);
+        free(descriptor);
+    }
     if (rc != 0 || msgType == NULL) {
         L_WARN("[json serializer] Cannot parse message from descriptor.\n");
         return -1;
@@ -431,6 +457,7 @@ static int pubsubMsgSerializer_convertDescriptor(pubsub_json_serializer_t* seria
 
     if (rc != 0 || msgName == NULL || msgVersion == NULL) {
         L_WARN("[json serializer] Cannot retrieve name and/or version from msg\n");
+        dynCache_releaseMessage(msgType);
         return -1;
     }
 
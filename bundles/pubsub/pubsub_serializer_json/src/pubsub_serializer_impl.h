@@ -29,6 +29,13 @@
 
 #define PUBSUB_JSON_SERIALIZER_TYPE "json"
 
+/**
+ * Whether messages are (de)serialized with precompiled json serializer plans (streaming, no jansson DOM)
+ * instead of the DOM based json serializer. Both produce the same json.
+ */
+#define PUBSUB_JSON_SERIALIZER_USE_PLANS "PUBSUB_JSON_SERIALIZER_USE_PLANS"
+#define PUBSUB_JSON_SERIALIZER_USE_PLANS_DEFAULT true
+
 typedef struct pubsub_json_serializer pubsub_json_serializer_t;
 
 celix_status_t pubsubSerializer_create(celix_bundle_context_t *context, pubsub_json_serializer_t **serializer);
@@ -20,10 +20,15 @@
 #ifndef PUBSUB_ADMIN_METRICS_H_
 #define PUBSUB_ADMIN_METRICS_H_
 
+#include <stdbool.h>
 #include <uuid/uuid.h>
 #include <sys/time.h>
 #include "celix_array_list.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define PUBSUB_ADMIN_METRICS_SERVICE_NAME   "pubsub_admin_metrics"
 
 #define PUBSUB_AMDIN_METRICS_NAME_MAX       1024
@@ -46,6 +51,14 @@ typedef struct pubsub_admin_sender_metrics {
     unsigned long nrOfUnknownMessagesRetrieved;
     unsigned int nrOfmsgMetrics;
     pubsub_admin_sender_msg_type_metrics_t *msgMetrics; //size = nrOfMessageTypes
+
+    //async send mode metrics, only valid if asyncSendEnabled is true
+    bool asyncSendEnabled;
+    unsigned long sendQueueCapacity;
+    unsigned long sendQueueDepth;
+    unsigned long maxSendQueueDepth;
+    unsigned long nrOfDroppedMessages;
+    unsigned long nrOfSendBatches;
 } pubsub_admin_sender_metrics_t;
 
 typedef struct pubsub_admin_receiver_metrics {
@@ -101,6 +114,10 @@ void pubsub_freePubSubAdminMetrics(pubsub_admin_metrics_t *metrics);
 
 typedef struct pubsub_admin_metrics_service pubsub_admin_metrics_service_t;
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* PUBSUB_ADMIN_METRICS_H_ */
 
 
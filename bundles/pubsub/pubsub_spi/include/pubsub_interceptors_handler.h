@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include "celix_errno.h"
+#include "celix_bundle_context.h"
 #include "celix_array_list.h"
 #include "pubsub_interceptor.h"
 #include "celix_properties.h"
@@ -46,6 +46,9 @@ typedef struct pstm_activator {
     celix_shell_command_t shellCmdSvc;
     long shellCmdSvcId;
 
+    pubsub_admin_metrics_service_t localMetricsSvc;
+    long localMetricsSvcId;
+
     celix_log_helper_t *loghelper;
 } pstm_activator_t;
 
@@ -60,6 +63,7 @@ static int pstm_start(pstm_activator_t *act, celix_bundle_context_t *ctx) {
     act->pubsubPublishServiceTrackerId = -1L;
     act->pubsubPSAMetricsTrackerId = -1L;
     act->shellCmdSvcId = -1L;
+    act->localMetricsSvcId = -1L;
 
     act->loghelper = celix_logHelper_create(ctx, "celix_psa_topology_manager");
 
@@ -135,6 +139,15 @@ static int pstm_start(pstm_activator_t *act, celix_bundle_context_t *ctx) {
         act->shellCmdSvcId = celix_bundleContext_registerService(ctx, &act->shellCmdSvc, CELIX_SHELL_COMMAND_SERVICE_NAME, props);
     }
 
+    //register metrics service for the local channels, so that these are part of the pstm metrics command
+    if (status == CELIX_SUCCESS) {
+        act->localMetricsSvc.handle = act->manager;
+        act->localMetricsSvc.metrics = pubsub_topologyManager_localChannelMetrics;
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_ADMIN_SERVICE_TYPE, PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE);
+        act->localMetricsSvcId = celix_bundleContext_registerService(ctx, &act->localMetricsSvc, PUBSUB_ADMIN_METRICS_SERVICE_NAME, props);
+    }
+
     //TODO add tracker for pubsub_serializer and
     //1) on remove reset sender/receivers entries
     //2) on add indicate that topic/senders should be reevaluated.
@@ -156,6 +169,7 @@ static int pstm_stop(pstm_activator_t *act, celix_bundle_context_t *ctx) {
     celix_bundleContext_stopTracker(ctx, act->pubsubPSAMetricsTrackerId);
     celix_bundleContext_unregisterService(ctx, act->discListenerSvcId);
     celix_bundleContext_unregisterService(ctx, act->shellCmdSvcId);
+    celix_bundleContext_unregisterService(ctx, act->localMetricsSvcId);
 
     pubsub_topologyManager_destroy(act->manager);
 
@@ -0,0 +1,816 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "pstm_local_channel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <uuid/uuid.h>
+
+#include "celix_api.h"
+#include "celix_utils.h"
+#include "hash_map.h"
+#include "pubsub_endpoint.h"
+#include "pubsub/publisher.h"
+#include "pubsub/subscriber.h"
+#include "pubsub_interceptors_handler.h"
+#include "pubsub_serializer_handler.h"
+#include "pubsub_send_queue.h"
+#include "pubsub_shared_message.h"
+
+#define PSTM_LOCAL_MAX_BATCH_SIZE   64
+
+#define L_DEBUG(...) \
+    celix_logHelper_log(channel->logHelper, CELIX_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define L_INFO(...) \
+    celix_logHelper_log(channel->logHelper, CELIX_LOG_LEVEL_INFO, __VA_ARGS__)
+#define L_WARN(...) \
+    celix_logHelper_log(channel->logHelper, CELIX_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define L_ERROR(...) \
+    celix_logHelper_log(channel->logHelper, CELIX_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+typedef struct pstm_local_msg_type_entry {
+    pstm_local_channel_t *channel;
+    unsigned int msgId;
+    char *fqn;
+    int major;
+    int minor;
+
+    //send metrics
+    unsigned long nrOfMessagesSend;
+    unsigned long nrOfMessagesSendFailed;
+    unsigned long nrOfSerializationErrors;
+    struct timespec lastMessageSend;
+    double averageTimeBetweenMessagesSendInSeconds;
+    double averageSerializationTimeInSeconds;
+
+    //receive metrics
+    unsigned long nrOfMessagesReceived;
+    unsigned long nrOfDeserializationErrors;
+    struct timespec lastMessageReceived;
+    double averageTimeBetweenMessagesReceivedInSeconds;
+    double averageDeserializationTimeInSeconds;
+    double averageDelayInSeconds;
+    double minDelayInSeconds;
+    double maxDelayInSeconds;
+} pstm_local_msg_type_entry_t;
+
+typedef struct pstm_local_msg {
+    pstm_local_msg_type_entry_t *type;
+    celix_properties_t *metadata;
+    struct timespec sendTime;
+    struct iovec serializedMsg; //clone policy, single buffer owned by the msg
+    const void *msg; //reference policy, owned by the publisher
+    bool done; //reference policy, true if the publisher can continue. Protected by dispatcher.mutex
+} pstm_local_msg_t;
+
+typedef struct pstm_local_subscriber_entry {
+    pubsub_subscriber_t *svc;
+    bool shared;
+    bool initialized; //true if the init function is called through the dispatcher thread
+} pstm_local_subscriber_entry_t;
+
+struct pstm_local_channel {
+    celix_bundle_context_t *ctx;
+    celix_log_helper_t *logHelper;
+    char *scope;
+    char *topic;
+    char *serializerType;
+    bool cloneMessages;
+    uuid_t fwUUID;
+
+    pubsub_serializer_handler_t *serializerHandler;
+    pubsub_interceptors_handler_t *interceptorsHandler;
+    pubsub_send_queue_t *queue;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects svcId and bndId
+        long svcId;
+        long bndId;
+        pubsub_publisher_t svc;
+    } publisher;
+
+    struct {
+        celix_thread_mutex_t mutex; //recursive, a subscriber can send on the same channel from the receive callback
+        long trackerId;
+        hash_map_t *map; //key = svc id, value = pstm_local_subscriber_entry_t*
+        hash_map_t *services; //key = svc id, value = pubsub_subscriber_t*
+        hash_map_t *sharedServices; //key = svc id, value = pubsub_subscriber_t*, subset of services
+        bool allInitialized;
+    } subscribers;
+
+    struct {
+        celix_thread_mutex_t mutex; //protects map and the metrics of the entries
+        hash_map_t *map; //key = msg id, value = pstm_local_msg_type_entry_t*
+    } msgTypes;
+
+    struct {
+        celix_thread_t thread;
+        bool started;
+        celix_thread_mutex_t mutex; //protects the done flag of reference messages
+        celix_thread_cond_t cond;
+    } dispatcher;
+};
+
+static int pstm_localChannel_localMsgTypeIdForMsgType(void *handle, const char *msgType, unsigned int *msgTypeId);
+static int pstm_localChannel_send(void *handle, unsigned int msgTypeId, const void *msg, celix_properties_t *metadata);
+static void pstm_localChannel_addSubscriber(void *handle, void *svc, const celix_properties_t *props);
+static void pstm_localChannel_removeSubscriber(void *handle, void *svc, const celix_properties_t *props);
+static void pstm_localChannel_dropMsg(void *handle, void *msg);
+static void pstm_localChannel_deliver(pstm_local_channel_t *channel, pstm_local_msg_t *msg);
+static void* pstm_localChannel_dispatchThread(void *data);
+
+pstm_local_channel_t* pstm_localChannel_create(
+        celix_bundle_context_t *ctx,
+        celix_log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        const char *serializerType,
+        bool cloneMessages,
+        size_t queueCapacity) {
+    pstm_local_channel_t *channel = calloc(1, sizeof(*channel));
+    channel->ctx = ctx;
+    channel->logHelper = logHelper;
+    channel->scope = celix_utils_strdup(scope);
+    channel->topic = celix_utils_strdup(topic);
+    channel->serializerType = celix_utils_strdup(serializerType);
+    channel->cloneMessages = cloneMessages;
+    channel->publisher.svcId = -1L;
+    channel->publisher.bndId = -1L;
+    channel->subscribers.trackerId = -1L;
+
+    const char *fwUUID = celix_bundleContext_getProperty(ctx, OSGI_FRAMEWORK_FRAMEWORK_UUID, NULL);
+    if (fwUUID == NULL || uuid_parse(fwUUID, channel->fwUUID) != 0) {
+        uuid_clear(channel->fwUUID);
+    }
+
+    channel->serializerHandler = pubsub_serializerHandler_create(ctx, serializerType, true);
+    pubsubInterceptorsHandler_create(ctx, scope, topic, &channel->interceptorsHandler);
+    channel->queue = pubsub_sendQueue_create(queueCapacity, PUBSUB_SEND_QUEUE_BLOCK, channel, pstm_localChannel_dropMsg);
+
+    celixThreadMutex_create(&channel->publisher.mutex, NULL);
+    celix_thread_mutexattr_t attr;
+    celixThreadMutexAttr_create(&attr);
+    celixThreadMutexAttr_settype(&attr, CELIX_THREAD_MUTEX_RECURSIVE);
+    celixThreadMutex_create(&channel->subscribers.mutex, &attr);
+    celixThreadMutexAttr_destroy(&attr);
+    channel->subscribers.map = hashMap_create(NULL, NULL, NULL, NULL);
+    channel->subscribers.services = hashMap_create(NULL, NULL, NULL, NULL);
+    channel->subscribers.sharedServices = hashMap_create(NULL, NULL, NULL, NULL);
+    channel->subscribers.allInitialized = true;
+    celixThreadMutex_create(&channel->msgTypes.mutex, NULL);
+    channel->msgTypes.map = hashMap_create(NULL, NULL, NULL, NULL);
+    celixThreadMutex_create(&channel->dispatcher.mutex, NULL);
+    celixThreadCondition_init(&channel->dispatcher.cond, NULL);
+
+    channel->publisher.svc.handle = channel;
+    channel->publisher.svc.localMsgTypeIdForMsgType = pstm_localChannel_localMsgTypeIdForMsgType;
+    channel->publisher.svc.send = pstm_localChannel_send;
+
+    if (channel->serializerHandler == NULL || channel->interceptorsHandler == NULL || channel->queue == NULL) {
+        L_ERROR("[PSTM] Cannot create local channel for %s/%s", scope == NULL ? "(null)" : scope, topic);
+        pstm_localChannel_destroy(channel);
+        return NULL;
+    }
+
+    celixThread_create(&channel->dispatcher.thread, NULL, pstm_localChannel_dispatchThread, channel);
+    celixThread_setName(&channel->dispatcher.thread, "PSTM Local");
+    channel->dispatcher.started = true;
+    return channel;
+}
+
+void pstm_localChannel_destroy(pstm_local_channel_t *channel) {
+    if (channel == NULL) {
+        return;
+    }
+    pstm_localChannel_setPublisherEnabled(channel, false, -1L);
+
+    if (channel->dispatcher.started) {
+        //note the dispatcher thread delivers the already queued messages before returning
+        pubsub_sendQueue_close(channel->queue);
+        celixThread_join(channel->dispatcher.thread, NULL);
+    }
+
+    pstm_localChannel_setSubscribersEnabled(channel, false);
+
+    if (channel->queue != NULL) {
+        pubsub_sendQueue_destroy(channel->queue);
+    }
+    if (channel->serializerHandler != NULL) {
+        pubsub_serializerHandler_destroy(channel->serializerHandler);
+    }
+    if (channel->interceptorsHandler != NULL) {
+        pubsubInterceptorsHandler_destroy(channel->interceptorsHandler);
+    }
+
+    hash_map_iterator_t iter = hashMapIterator_construct(channel->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        free(hashMapIterator_nextValue(&iter));
+    }
+    hashMap_destroy(channel->subscribers.map, false, false);
+    hashMap_destroy(channel->subscribers.services, false, false);
+    hashMap_destroy(channel->subscribers.sharedServices, false, false);
+    iter = hashMapIterator_construct(channel->msgTypes.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pstm_local_msg_type_entry_t *type = hashMapIterator_nextValue(&iter);
+        free(type->fqn);
+        free(type);
+    }
+    hashMap_destroy(channel->msgTypes.map, false, false);
+
+    celixThreadMutex_destroy(&channel->publisher.mutex);
+    celixThreadMutex_destroy(&channel->subscribers.mutex);
+    celixThreadMutex_destroy(&channel->msgTypes.mutex);
+    celixThreadMutex_destroy(&channel->dispatcher.mutex);
+    celixThreadCondition_destroy(&channel->dispatcher.cond);
+
+    free(channel->scope);
+    free(channel->topic);
+    free(channel->serializerType);
+    free(channel);
+}
+
+void pstm_localChannel_setPublisherEnabled(pstm_local_channel_t *channel, bool enabled, long bndId) {
+    celixThreadMutex_lock(&channel->publisher.mutex);
+    long svcId = channel->publisher.svcId;
+    bool registerSvc = enabled && svcId < 0;
+    channel->publisher.bndId = bndId;
+    if (!enabled) {
+        channel->publisher.svcId = -1L;
+    }
+    celixThreadMutex_unlock(&channel->publisher.mutex);
+
+    if (registerSvc) {
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_PUBLISHER_TOPIC, channel->topic);
+        if (channel->scope != NULL) {
+            celix_properties_set(props, PUBSUB_PUBLISHER_SCOPE, channel->scope);
+        }
+
+        celix_service_registration_options_t opts = CELIX_EMPTY_SERVICE_REGISTRATION_OPTIONS;
+        opts.svc = &channel->publisher.svc;
+        opts.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+        opts.serviceVersion = PUBSUB_PUBLISHER_SERVICE_VERSION;
+        opts.properties = props;
+        svcId = celix_bundleContext_registerServiceWithOptions(channel->ctx, &opts);
+
+        celixThreadMutex_lock(&channel->publisher.mutex);
+        channel->publisher.svcId = svcId;
+        celixThreadMutex_unlock(&channel->publisher.mutex);
+    } else if (!enabled && svcId >= 0) {
+        celix_bundleContext_unregisterService(channel->ctx, svcId);
+    }
+}
+
+void pstm_localChannel_setSubscribersEnabled(pstm_local_channel_t *channel, bool enabled) {
+    //note the tracker id is only updated from the pstm handling thread
+    if (enabled && channel->subscribers.trackerId < 0) {
+        int size = snprintf(NULL, 0, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, channel->topic);
+        char buf[size+1];
+        snprintf(buf, (size_t)size+1, "(%s=%s)", PUBSUB_SUBSCRIBER_TOPIC, channel->topic);
+        celix_service_tracking_options_t opts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+        opts.filter.ignoreServiceLanguage = true;
+        opts.filter.serviceName = PUBSUB_SUBSCRIBER_SERVICE_NAME;
+        opts.filter.filter = buf;
+        opts.callbackHandle = channel;
+        opts.addWithProperties = pstm_localChannel_addSubscriber;
+        opts.removeWithProperties = pstm_localChannel_removeSubscriber;
+        long trackerId = celix_bundleContext_trackServicesWithOptions(channel->ctx, &opts);
+        celixThreadMutex_lock(&channel->subscribers.mutex);
+        channel->subscribers.trackerId = trackerId;
+        celixThreadMutex_unlock(&channel->subscribers.mutex);
+    } else if (!enabled && channel->subscribers.trackerId >= 0) {
+        celixThreadMutex_lock(&channel->subscribers.mutex);
+        long trackerId = channel->subscribers.trackerId;
+        channel->subscribers.trackerId = -1L;
+        celixThreadMutex_unlock(&channel->subscribers.mutex);
+        celix_bundleContext_stopTracker(channel->ctx, trackerId);
+    }
+}
+
+bool pstm_localChannel_isPublisherEnabled(pstm_local_channel_t *channel) {
+    celixThreadMutex_lock(&channel->publisher.mutex);
+    bool enabled = channel->publisher.svcId >= 0;
+    celixThreadMutex_unlock(&channel->publisher.mutex);
+    return enabled;
+}
+
+bool pstm_localChannel_isSubscribersEnabled(pstm_local_channel_t *channel) {
+    celixThreadMutex_lock(&channel->subscribers.mutex);
+    bool enabled = channel->subscribers.trackerId >= 0;
+    celixThreadMutex_unlock(&channel->subscribers.mutex);
+    return enabled;
+}
+
+const char* pstm_localChannel_serializerType(pstm_local_channel_t *channel) {
+    return channel->serializerType;
+}
+
+static void pstm_localChannel_addSubscriber(void *handle, void *svc, const celix_properties_t *props) {
+    pstm_local_channel_t *channel = handle;
+
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1);
+    const char *subScope = celix_properties_get(props, PUBSUB_SUBSCRIBER_SCOPE, NULL);
+    if (channel->scope == NULL) {
+        if (subScope != NULL) {
+            return;
+        }
+    } else if (subScope == NULL || strncmp(subScope, channel->scope, strlen(channel->scope)) != 0) {
+        //not the same scope. ignore
+        return;
+    }
+
+    pstm_local_subscriber_entry_t *entry = calloc(1, sizeof(*entry));
+    entry->svc = svc;
+    entry->shared = pubsub_sharedMessage_isSharedSubscriber(svc, props);
+    entry->initialized = false;
+
+    celixThreadMutex_lock(&channel->subscribers.mutex);
+    hashMap_put(channel->subscribers.map, (void*)svcId, entry);
+    hashMap_put(channel->subscribers.services, (void*)svcId, svc);
+    if (entry->shared) {
+        hashMap_put(channel->subscribers.sharedServices, (void*)svcId, svc);
+    }
+    channel->subscribers.allInitialized = false;
+    celixThreadMutex_unlock(&channel->subscribers.mutex);
+}
+
+static void pstm_localChannel_removeSubscriber(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+    pstm_local_channel_t *channel = handle;
+    long svcId = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1);
+
+    celixThreadMutex_lock(&channel->subscribers.mutex);
+    pstm_local_subscriber_entry_t *entry = hashMap_remove(channel->subscribers.map, (void*)svcId);
+    hashMap_remove(channel->subscribers.services, (void*)svcId);
+    hashMap_remove(channel->subscribers.sharedServices, (void*)svcId);
+    celixThreadMutex_unlock(&channel->subscribers.mutex);
+    free(entry);
+}
+
+static void pstm_localChannel_initializeAllSubscribers(pstm_local_channel_t *channel) {
+    celixThreadMutex_lock(&channel->subscribers.mutex);
+    if (!channel->subscribers.allInitialized) {
+        bool allInitialized = true;
+        hash_map_iterator_t iter = hashMapIterator_construct(channel->subscribers.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            pstm_local_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+            if (!entry->initialized) {
+                int rc = 0;
+                if (entry->svc->init != NULL) {
+                    rc = entry->svc->init(entry->svc->handle);
+                }
+                if (rc == 0) {
+                    entry->initialized = true;
+                } else {
+                    L_WARN("[PSTM] Cannot initialize subscriber svc. Got rc %i", rc);
+                    allInitialized = false;
+                }
+            }
+        }
+        channel->subscribers.allInitialized = allInitialized;
+    }
+    celixThreadMutex_unlock(&channel->subscribers.mutex);
+}
+
+static pstm_local_msg_type_entry_t* pstm_localChannel_addMsgType(pstm_local_channel_t *channel, unsigned int msgId, char *fqn) {
+    //NOTE channel->msgTypes.mutex locked, taking ownership of fqn
+    pstm_local_msg_type_entry_t *type = calloc(1, sizeof(*type));
+    type->channel = channel;
+    type->msgId = msgId;
+    type->fqn = fqn;
+    type->major = pubsub_serializerHandler_getMsgMajorVersion(channel->serializerHandler, msgId);
+    type->minor = pubsub_serializerHandler_getMsgMinorVersion(channel->serializerHandler, msgId);
+    hashMap_put(channel->msgTypes.map, (void*)(uintptr_t)msgId, type);
+    return type;
+}
+
+static int pstm_localChannel_localMsgTypeIdForMsgType(void *handle, const char *msgType, unsigned int *msgTypeId) {
+    pstm_local_channel_t *channel = handle;
+    unsigned int msgId = pubsub_serializerHandler_getMsgId(channel->serializerHandler, msgType);
+    if (msgId == 0 && !channel->cloneMessages) {
+        //note messages delivered by reference do not need a serializer
+        msgId = celix_utils_stringHash(msgType);
+    }
+    if (msgId == 0) {
+        L_WARN("[PSTM] Cannot find a %s serializer for msg type %s", channel->serializerType, msgType);
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    celixThreadMutex_lock(&channel->msgTypes.mutex);
+    if (!hashMap_containsKey(channel->msgTypes.map, (void*)(uintptr_t)msgId)) {
+        pstm_localChannel_addMsgType(channel, msgId, celix_utils_strdup(msgType));
+    }
+    celixThreadMutex_unlock(&channel->msgTypes.mutex);
+    *msgTypeId = msgId;
+    return CELIX_SUCCESS;
+}
+
+static pstm_local_msg_type_entry_t* pstm_localChannel_findMsgType(pstm_local_channel_t *channel, unsigned int msgId) {
+    celixThreadMutex_lock(&channel->msgTypes.mutex);
+    pstm_local_msg_type_entry_t *type = hashMap_get(channel->msgTypes.map, (void*)(uintptr_t)msgId);
+    if (type == NULL && channel->cloneMessages) {
+        //msg id not requested through this publisher, but it can still be known by the serializer
+        char *fqn = pubsub_serializerHandler_getMsgFqn(channel->serializerHandler, msgId);
+        if (fqn != NULL) {
+            type = pstm_localChannel_addMsgType(channel, msgId, fqn);
+        }
+    }
+    celixThreadMutex_unlock(&channel->msgTypes.mutex);
+    return type;
+}
+
+static void pstm_localChannel_markDone(pstm_local_channel_t *channel, pstm_local_msg_t *msg) {
+    celixThreadMutex_lock(&channel->dispatcher.mutex);
+    msg->done = true;
+    celixThreadCondition_broadcast(&channel->dispatcher.cond);
+    celixThreadMutex_unlock(&channel->dispatcher.mutex);
+}
+
+static void pstm_localChannel_freeMsg(pstm_local_channel_t *channel, pstm_local_msg_t *msg) {
+    //NOTE for the reference policy the msg is freed by the publisher
+    if (msg->metadata != NULL) {
+        celix_properties_destroy(msg->metadata);
+        msg->metadata = NULL;
+    }
+    if (channel->cloneMessages) {
+        free(msg->serializedMsg.iov_base);
+        free(msg);
+    }
+}
+
+static void pstm_localChannel_dropMsg(void *handle, void *m) {
+    pstm_local_channel_t *channel = handle;
+    pstm_local_msg_t *msg = m;
+    pstm_localChannel_freeMsg(channel, msg);
+    if (!channel->cloneMessages) {
+        pstm_localChannel_markDone(channel, msg);
+    }
+}
+
+static void pstm_localChannel_updateSendMetrics(pstm_local_channel_t *channel, pstm_local_msg_type_entry_t *type, celix_status_t status, bool serializationError, const struct timespec *begin, const struct timespec *end) {
+    celixThreadMutex_lock(&channel->msgTypes.mutex);
+    if (serializationError) {
+        type->nrOfSerializationErrors += 1;
+    } else if (status != CELIX_SUCCESS) {
+        type->nrOfMessagesSendFailed += 1;
+    } else {
+        type->nrOfMessagesSend += 1;
+        double n = (double)type->nrOfMessagesSend;
+        double serTime = celix_difftime(begin, end);
+        type->averageSerializationTimeInSeconds += (serTime - type->averageSerializationTimeInSeconds) / n;
+        if (type->nrOfMessagesSend > 1) {
+            double timeBetween = celix_difftime(&type->lastMessageSend, end);
+            type->averageTimeBetweenMessagesSendInSeconds += (timeBetween - type->averageTimeBetweenMessagesSendInSeconds) / (n - 1);
+        }
+        type->lastMessageSend = *end;
+    }
+    celixThreadMutex_unlock(&channel->msgTypes.mutex);
+}
+
+//note the delay is the time between the send call and the start of the delivery on the dispatcher thread
+static void pstm_localChannel_updateReceiveMetrics(pstm_local_channel_t *channel, pstm_local_msg_type_entry_t *type, bool deserializationError, const struct timespec *sendTime, const struct timespec *begin, const struct timespec *end) {
+    celixThreadMutex_lock(&channel->msgTypes.mutex);
+    if (deserializationError) {
+        type->nrOfDeserializationErrors += 1;
+    } else {
+        type->nrOfMessagesReceived += 1;
+        double n = (double)type->nrOfMessagesReceived;
+        double delay = celix_difftime(sendTime, begin);
+        double deserTime = celix_difftime(begin, end);
+        type->averageDeserializationTimeInSeconds += (deserTime - type->averageDeserializationTimeInSeconds) / n;
+        type->averageDelayInSeconds += (delay - type->averageDelayInSeconds) / n;
+        if (type->nrOfMessagesReceived == 1 || delay < type->minDelayInSeconds) {
+            type->minDelayInSeconds = delay;
+        }
+        if (type->nrOfMessagesReceived == 1 || delay > type->maxDelayInSeconds) {
+            type->maxDelayInSeconds = delay;
+        }
+        if (type->nrOfMessagesReceived > 1) {
+            double timeBetween = celix_difftime(&type->lastMessageReceived, end);
+            type->averageTimeBetweenMessagesReceivedInSeconds += (timeBetween - type->averageTimeBetweenMessagesReceivedInSeconds) / (n - 1);
+        }
+        type->lastMessageReceived = *end;
+    }
+    celixThreadMutex_unlock(&channel->msgTypes.mutex);
+}
+
+static int pstm_localChannel_send(void *handle, unsigned int msgTypeId, const void *inMsg, celix_properties_t *metadata) {
+    pstm_local_channel_t *channel = handle;
+
+    pstm_local_msg_type_entry_t *type = pstm_localChannel_findMsgType(channel, msgTypeId);
+    if (type == NULL) {
+        L_WARN("[PSTM] Unknown msg type id 0x%X for local channel %s/%s", msgTypeId, channel->scope == NULL ? "(null)" : channel->scope, channel->topic);
+        celix_properties_destroy(metadata);
+        return CELIX_ILLEGAL_ARGUMENT;
+    }
+
+    bool cont = pubsubInterceptorHandler_invokePreSend(channel->interceptorsHandler, type->fqn, msgTypeId, inMsg, &metadata);
+    if (!cont) {
+        celix_properties_destroy(metadata);
+        return CELIX_SUCCESS;
+    }
+
+    celix_status_t status = CELIX_SUCCESS;
+    pstm_local_msg_t *msg = calloc(1, sizeof(*msg));
+    msg->type = type;
+    msg->metadata = metadata;
+    msg->msg = inMsg;
+
+    struct timespec begin;
+    struct timespec end;
+    clock_gettime(CLOCK_REALTIME, &begin);
+    if (channel->cloneMessages) {
+        //note the serialized msg is copied in a single buffer, so that the serializer output can be freed directly
+        struct iovec *serializedOutput = NULL;
+        size_t serializedOutputLen = 0;
+        status = pubsub_serializerHandler_serialize(channel->serializerHandler, msgTypeId, inMsg, &serializedOutput, &serializedOutputLen);
+        if (status == CELIX_SUCCESS) {
+            size_t size = 0;
+            for (size_t i = 0; i < serializedOutputLen; ++i) {
+                size += serializedOutput[i].iov_len;
+            }
+            char *buf = malloc(size > 0 ? size : 1);
+            size_t offset = 0;
+            for (size_t i = 0; i < serializedOutputLen; ++i) {
+                memcpy(buf + offset, serializedOutput[i].iov_base, serializedOutput[i].iov_len);
+                offset += serializedOutput[i].iov_len;
+            }
+            msg->serializedMsg.iov_base = buf;
+            msg->serializedMsg.iov_len = size;
+            pubsub_serializerHandler_freeSerializedMsg(channel->serializerHandler, msgTypeId, serializedOutput, serializedOutputLen);
+        }
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+    msg->sendTime = end;
+
+    if (status != CELIX_SUCCESS) {
+        L_WARN("[PSTM] Error serializing msg type %s for local channel %s/%s", type->fqn, channel->scope == NULL ? "(null)" : channel->scope, channel->topic);
+        pstm_localChannel_updateSendMetrics(channel, type, status, true, &begin, &end);
+        celix_properties_destroy(msg->metadata);
+        free(msg);
+        return status;
+    }
+
+    //note called before queueing, because the dispatcher thread takes ownership of the metadata
+    pubsubInterceptorHandler_invokePostSend(channel->interceptorsHandler, type->fqn, msgTypeId, inMsg, msg->metadata);
+
+    bool queued = true;
+    if (celixThread_equals(celixThread_self(), channel->dispatcher.thread)) {
+        //send from a subscriber callback, deliver directly. The dispatcher thread cannot wait for itself.
+        pstm_localChannel_deliver(channel, msg);
+    } else {
+        queued = pubsub_sendQueue_push(channel->queue, msg);
+    }
+
+    if (!queued) {
+        status = CELIX_ILLEGAL_STATE;
+        celix_properties_destroy(msg->metadata);
+        free(msg->serializedMsg.iov_base);
+        free(msg);
+    } else if (!channel->cloneMessages) {
+        //the message is owned by the publisher, wait until all subscribers are done with it.
+        celixThreadMutex_lock(&channel->dispatcher.mutex);
+        while (!msg->done) {
+            celixThreadCondition_wait(&channel->dispatcher.cond, &channel->dispatcher.mutex);
+        }
+        celixThreadMutex_unlock(&channel->dispatcher.mutex);
+        free(msg);
+    }
+
+    pstm_localChannel_updateSendMetrics(channel, type, status, false, &begin, &end);
+    return status;
+}
+
+static celix_status_t pstm_localChannel_deserialize(void *handle, const struct iovec *input, size_t inputIovLen, void **deserializedMsg) {
+    pstm_local_msg_type_entry_t *type = handle;
+    return pubsub_serializerHandler_deserialize(type->channel->serializerHandler, type->msgId, type->major, type->minor, input, inputIovLen, deserializedMsg);
+}
+
+static void pstm_localChannel_freeDeserializedMsg(void *handle, void *deserializedMsg) {
+    pstm_local_msg_type_entry_t *type = handle;
+    pubsub_serializerHandler_freeDeserializedMsg(type->channel->serializerHandler, type->msgId, deserializedMsg);
+}
+
+static void pstm_localChannel_referenceReleased(void *handle, void *deserializedMsg __attribute__((unused))) {
+    pstm_local_msg_t *msg = handle;
+    pstm_localChannel_markDone(msg->type->channel, msg);
+}
+
+static void pstm_localChannel_deliverClone(pstm_local_channel_t *channel, pstm_local_msg_t *msg, void *deserializedMsg) {
+    //NOTE channel->subscribers.mutex locked
+    pubsub_shared_message_delivery_t delivery = {
+            .msgFqn = msg->type->fqn,
+            .msgId = msg->type->msgId,
+            .metadata = msg->metadata,
+            .serializerHandle = msg->type,
+            .deserialize = pstm_localChannel_deserialize,
+            .freeDeserializedMsg = pstm_localChannel_freeDeserializedMsg,
+            .input = &msg->serializedMsg,
+            .inputIovLen = 1,
+            .interceptorsHandler = channel->interceptorsHandler
+    };
+    celix_status_t status = pubsub_sharedMessage_deliver(&delivery, channel->subscribers.services, channel->subscribers.sharedServices, deserializedMsg);
+    if (status != CELIX_SUCCESS) {
+        L_WARN("[PSTM] Cannot deserialize msg type %s for local channel %s/%s", msg->type->fqn, channel->scope == NULL ? "(null)" : channel->scope, channel->topic);
+    }
+}
+
+static pubsub_shared_message_t* pstm_localChannel_deliverReference(pstm_local_channel_t *channel, pstm_local_msg_t *msg) {
+    //NOTE channel->subscribers.mutex locked
+    const char *msgFqn = msg->type->fqn;
+    unsigned int msgId = msg->type->msgId;
+    pubsub_shared_message_t *sharedMsg = NULL;
+    hash_map_iterator_t iter = hashMapIterator_construct(channel->subscribers.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pstm_local_subscriber_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry->shared) {
+            if (sharedMsg == NULL) {
+                //note the publisher waits until the last reference of the shared message is released
+                sharedMsg = pubsub_sharedMessage_create((void*)msg->msg, msg, pstm_localChannel_referenceReleased);
+            }
+            entry->svc->receiveShared(entry->svc->handle, msgFqn, msgId, sharedMsg, msg->metadata);
+        } else {
+            bool release = true;
+            entry->svc->receive(entry->svc->handle, msgFqn, msgId, (void*)msg->msg, msg->metadata, &release);
+            if (!release) {
+                L_ERROR("[PSTM] Subscriber tried to take ownership of msg type %s delivered by reference for local channel %s/%s. The msg is owned by the publisher.",
+                        msgFqn, channel->scope == NULL ? "(null)" : channel->scope, channel->topic);
+            }
+        }
+        pubsubInterceptorHandler_invokePostReceive(channel->interceptorsHandler, msgFqn, msgId, msg->msg, msg->metadata);
+    }
+    return sharedMsg;
+}
+
+static void pstm_localChannel_deliver(pstm_local_channel_t *channel, pstm_local_msg_t *msg) {
+    pstm_local_msg_type_entry_t *type = msg->type;
+    void *deserializedMsg = (void*)msg->msg;
+    pubsub_shared_message_t *sharedMsg = NULL;
+
+    struct timespec begin;
+    struct timespec end;
+    clock_gettime(CLOCK_REALTIME, &begin);
+    celix_status_t status = CELIX_SUCCESS;
+    if (channel->cloneMessages) {
+        status = pubsub_serializerHandler_deserialize(channel->serializerHandler, type->msgId, type->major, type->minor, &msg->serializedMsg, 1, &deserializedMsg);
+    }
+    clock_gettime(CLOCK_REALTIME, &end);
+
+    if (status == CELIX_SUCCESS) {
+        bool cont = pubsubInterceptorHandler_invokePreReceive(channel->interceptorsHandler, type->fqn, type->msgId, deserializedMsg, &msg->metadata);
+        if (cont) {
+            celixThreadMutex_lock(&channel->subscribers.mutex);
+            if (channel->cloneMessages) {
+                pstm_localChannel_deliverClone(channel, msg, deserializedMsg);
+            } else {
+                sharedMsg = pstm_localChannel_deliverReference(channel, msg);
+            }
+            celixThreadMutex_unlock(&channel->subscribers.mutex);
+        } else if (channel->cloneMessages) {
+            pubsub_serializerHandler_freeDeserializedMsg(channel->serializerHandler, type->msgId, deserializedMsg);
+        }
+        pstm_localChannel_updateReceiveMetrics(channel, type, false, &msg->sendTime, &begin, &end);
+    } else {
+        L_WARN("[PSTM] Cannot deserialize msg type %s for local channel %s/%s", type->fqn, channel->scope == NULL ? "(null)" : channel->scope, channel->topic);
+        pstm_localChannel_updateReceiveMetrics(channel, type, true, &msg->sendTime, &begin, &end);
+    }
+
+    pstm_localChannel_freeMsg(channel, msg);
+    if (sharedMsg != NULL) {
+        //note the publisher continues when the last reference is released
+        pubsub_sharedMessage_release(sharedMsg);
+    } else if (!channel->cloneMessages) {
+        pstm_localChannel_markDone(channel, msg);
+    }
+}
+
+static void* pstm_localChannel_dispatchThread(void *data) {
+    pstm_local_channel_t *channel = data;
+    void *msgs[PSTM_LOCAL_MAX_BATCH_SIZE];
+    size_t nrOfMsgs = pubsub_sendQueue_popBatch(channel->queue, msgs, PSTM_LOCAL_MAX_BATCH_SIZE);
+    while (nrOfMsgs > 0) {
+        pstm_localChannel_initializeAllSubscribers(channel);
+        for (size_t i = 0; i < nrOfMsgs; ++i) {
+            pstm_localChannel_deliver(channel, msgs[i]);
+        }
+        nrOfMsgs = pubsub_sendQueue_popBatch(channel->queue, msgs, PSTM_LOCAL_MAX_BATCH_SIZE);
+    }
+    return NULL;
+}
+
+void pstm_localChannel_printInfo(pstm_local_channel_t *channel, bool verbose, FILE *os) {
+    celixThreadMutex_lock(&channel->subscribers.mutex);
+    int nrOfSubscribers = hashMap_size(channel->subscribers.map);
+    celixThreadMutex_unlock(&channel->subscribers.mutex);
+    pubsub_send_queue_stats_t stats;
+    pubsub_sendQueue_getStats(channel->queue, &stats);
+
+    fprintf(os, "|- Local Channel for %s/%s:\n", channel->scope == NULL ? "(null)" : channel->scope, channel->topic);
+    fprintf(os, "   |- delivery    = %s\n", channel->cloneMessages ? "clone" : "reference");
+    fprintf(os, "   |- serializer  = %s\n", channel->serializerType);
+    fprintf(os, "   |- publisher   = %s\n", pstm_localChannel_isPublisherEnabled(channel) ? "registered" : "not registered");
+    fprintf(os, "   |- subscribers = %i\n", nrOfSubscribers);
+    if (verbose) {
+        fprintf(os, "   |- queue depth = %lu (max %lu, capacity %lu)\n", (unsigned long)stats.size, (unsigned long)stats.maxSize, (unsigned long)stats.capacity);
+        fprintf(os, "   |- batches     = %lu\n", stats.nrOfBatches);
+    }
+}
+
+pubsub_admin_sender_metrics_t* pstm_localChannel_senderMetrics(pstm_local_channel_t *channel) {
+    celixThreadMutex_lock(&channel->publisher.mutex);
+    bool enabled = channel->publisher.svcId >= 0;
+    long bndId = channel->publisher.bndId;
+    celixThreadMutex_unlock(&channel->publisher.mutex);
+    if (!enabled) {
+        return NULL;
+    }
+
+    pubsub_admin_sender_metrics_t *metrics = calloc(1, sizeof(*metrics));
+    snprintf(metrics->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", channel->scope == NULL ? PUBSUB_DEFAULT_ENDPOINT_SCOPE : channel->scope);
+    snprintf(metrics->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", channel->topic);
+
+    pubsub_send_queue_stats_t stats;
+    pubsub_sendQueue_getStats(channel->queue, &stats);
+    metrics->asyncSendEnabled = true;
+    metrics->sendQueueCapacity = stats.capacity;
+    metrics->sendQueueDepth = stats.size;
+    metrics->maxSendQueueDepth = stats.maxSize;
+    metrics->nrOfDroppedMessages = stats.nrOfDroppedMessages;
+    metrics->nrOfSendBatches = stats.nrOfBatches;
+
+    celixThreadMutex_lock(&channel->msgTypes.mutex);
+    metrics->nrOfmsgMetrics = (unsigned int)hashMap_size(channel->msgTypes.map);
+    metrics->msgMetrics = calloc(metrics->nrOfmsgMetrics, sizeof(*metrics->msgMetrics));
+    int i = 0;
+    hash_map_iterator_t iter = hashMapIterator_construct(channel->msgTypes.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pstm_local_msg_type_entry_t *type = hashMapIterator_nextValue(&iter);
+        metrics->msgMetrics[i].bndId = bndId;
+        snprintf(metrics->msgMetrics[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", type->fqn);
+        metrics->msgMetrics[i].typeId = type->msgId;
+        metrics->msgMetrics[i].nrOfMessagesSend = type->nrOfMessagesSend;
+        metrics->msgMetrics[i].nrOfMessagesSendFailed = type->nrOfMessagesSendFailed;
+        metrics->msgMetrics[i].nrOfSerializationErrors = type->nrOfSerializationErrors;
+        metrics->msgMetrics[i].lastMessageSend = type->lastMessageSend;
+        metrics->msgMetrics[i].averageTimeBetweenMessagesInSeconds = type->averageTimeBetweenMessagesSendInSeconds;
+        metrics->msgMetrics[i].averageSerializationTimeInSeconds = type->averageSerializationTimeInSeconds;
+        i += 1;
+    }
+    celixThreadMutex_unlock(&channel->msgTypes.mutex);
+    return metrics;
+}
+
+pubsub_admin_receiver_metrics_t* pstm_localChannel_receiverMetrics(pstm_local_channel_t *channel) {
+    if (!pstm_localChannel_isSubscribersEnabled(channel)) {
+        return NULL;
+    }
+
+    pubsub_admin_receiver_metrics_t *metrics = calloc(1, sizeof(*metrics));
+    snprintf(metrics->scope, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", channel->scope == NULL ? PUBSUB_DEFAULT_ENDPOINT_SCOPE : channel->scope);
+    snprintf(metrics->topic, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", channel->topic);
+
+    celixThreadMutex_lock(&channel->msgTypes.mutex);
+    metrics->nrOfMsgTypes = (unsigned long)hashMap_size(channel->msgTypes.map);
+    metrics->msgTypes = calloc(metrics->nrOfMsgTypes, sizeof(*metrics->msgTypes));
+    int i = 0;
+    hash_map_iterator_t iter = hashMapIterator_construct(channel->msgTypes.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pstm_local_msg_type_entry_t *type = hashMapIterator_nextValue(&iter);
+        metrics->msgTypes[i].typeId = type->msgId;
+        snprintf(metrics->msgTypes[i].typeFqn, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", type->fqn);
+        //note only one origin, the local framework
+        metrics->msgTypes[i].nrOfOrigins = 1;
+        metrics->msgTypes[i].origins = calloc(1, sizeof(*metrics->msgTypes[i].origins));
+        uuid_copy(metrics->msgTypes[i].origins[0].originUUID, channel->fwUUID);
+        metrics->msgTypes[i].origins[0].nrOfMessagesReceived = type->nrOfMessagesReceived;
+        metrics->msgTypes[i].origins[0].nrOfSerializationErrors = type->nrOfDeserializationErrors;
+        metrics->msgTypes[i].origins[0].nrOfMissingSeqNumbers = 0;
+        metrics->msgTypes[i].origins[0].lastMessageReceived = type->lastMessageReceived;
+        metrics->msgTypes[i].origins[0].averageTimeBetweenMessagesInSeconds = type->averageTimeBetweenMessagesReceivedInSeconds;
+        metrics->msgTypes[i].origins[0].averageSerializationTimeInSeconds = type->averageDeserializationTimeInSeconds;
+        metrics->msgTypes[i].origins[0].averageDelayInSeconds = type->averageDelayInSeconds;
+        metrics->msgTypes[i].origins[0].minDelayInSeconds = type->minDelayInSeconds;
+        metrics->msgTypes[i].origins[0].maxDelayInSeconds = type->maxDelayInSeconds;
+        i += 1;
+    }
+    celixThreadMutex_unlock(&channel->msgTypes.mutex);
+    return metrics;
+}
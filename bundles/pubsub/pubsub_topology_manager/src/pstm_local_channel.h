@@ -0,0 +1,89 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_PSTM_LOCAL_CHANNEL_H
+#define CELIX_PSTM_LOCAL_CHANNEL_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "celix_bundle_context.h"
+#include "celix_log_helper.h"
+#include "pubsub_admin_metrics.h"
+
+/**
+ * A local channel delivers messages from a publisher to the subscribers of the same scope/topic in the same
+ * framework, without a pubsub admin (no protocol encoding and no sockets).
+ *
+ * The channel provides the publisher service and tracks the subscriber services. Messages are handed over to a
+ * dispatcher thread which calls the subscribers, so publishers and subscribers see the same threading as with a
+ * pubsub admin.
+ *
+ * Two delivery policies are supported:
+ *  - clone: the message is serialized in the send call and deserialized on the dispatcher thread, so subscribers
+ *    get their own copy and the publisher can reuse the message when send returns.
+ *  - reference: the message pointer of the publisher is delivered, send blocks until all subscribers are called and
+ *    all shared messages are released. Subscribers cannot take ownership of the message.
+ */
+typedef struct pstm_local_channel pstm_local_channel_t; //opaque type
+
+pstm_local_channel_t* pstm_localChannel_create(
+        celix_bundle_context_t *ctx,
+        celix_log_helper_t *logHelper,
+        const char *scope,
+        const char *topic,
+        const char *serializerType,
+        bool cloneMessages,
+        size_t queueCapacity);
+
+void pstm_localChannel_destroy(pstm_local_channel_t *channel);
+
+/**
+ * Registers (enabled) or unregisters (disabled) the publisher service of the channel.
+ * @param bndId The bundle requesting the publisher, used for the metrics.
+ */
+void pstm_localChannel_setPublisherEnabled(pstm_local_channel_t *channel, bool enabled, long bndId);
+
+/**
+ * Starts (enabled) or stops (disabled) tracking the subscriber services of the channel.
+ */
+void pstm_localChannel_setSubscribersEnabled(pstm_local_channel_t *channel, bool enabled);
+
+bool pstm_localChannel_isPublisherEnabled(pstm_local_channel_t *channel);
+bool pstm_localChannel_isSubscribersEnabled(pstm_local_channel_t *channel);
+const char* pstm_localChannel_serializerType(pstm_local_channel_t *channel);
+
+/**
+ * Prints the channel info for the pstm shell command.
+ */
+void pstm_localChannel_printInfo(pstm_local_channel_t *channel, bool verbose, FILE *os);
+
+/**
+ * Creates the sender metrics of the channel. Returns NULL if the publisher service is not enabled.
+ * The metrics are freed as part of pubsub_freePubSubAdminMetrics.
+ */
+pubsub_admin_sender_metrics_t* pstm_localChannel_senderMetrics(pstm_local_channel_t *channel);
+
+/**
+ * Creates the receiver metrics of the channel. Returns NULL if the subscribers are not enabled.
+ * The metrics are freed as part of pubsub_freePubSubAdminMetrics.
+ */
+pubsub_admin_receiver_metrics_t* pstm_localChannel_receiverMetrics(pstm_local_channel_t *channel);
+
+#endif //CELIX_PSTM_LOCAL_CHANNEL_H
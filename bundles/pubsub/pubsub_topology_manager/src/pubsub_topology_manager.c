@@ -37,9 +37,13 @@
 #include "pubsub_listeners.h"
 #include "pubsub_topology_manager.h"
 #include "pubsub_admin.h"
+#include "pubsub_message_serialization_service.h"
+#include "pubsub_matching.h"
+#include "pstm_local_channel.h"
 #include "../../pubsub_admin_udp_mc/src/pubsub_udpmc_topic_sender.h"
 
 #define PSTM_PSA_HANDLING_DEFAULT_SLEEPTIME_IN_SECONDS       30L
+#define PSTM_LOCAL_CHANNEL_DEFAULT_SERIALIZER                "json"
 
 #ifndef UUID_STR_LEN
 #define UUID_STR_LEN    37
@@ -47,6 +51,19 @@
 
 static void *pstm_psaHandlingThread(void *data);
 
+static bool pstm_isCloneDeliveryPolicy(pubsub_topology_manager_t *manager, const char *policy, bool defaultClone) {
+    if (policy == NULL) {
+        return defaultClone;
+    } else if (strncmp(policy, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_CLONE, strlen(PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_CLONE) + 1) == 0) {
+        return true;
+    } else if (strncmp(policy, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_REFERENCE, strlen(PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_REFERENCE) + 1) == 0) {
+        return false;
+    }
+    celix_logHelper_warning(manager->loghelper, "Unknown local delivery policy '%s', expected '%s' or '%s'",
+                            policy, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_CLONE, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_REFERENCE);
+    return defaultClone;
+}
+
 celix_status_t pubsub_topologyManager_create(celix_bundle_context_t *context, celix_log_helper_t *logHelper, pubsub_topology_manager_t **out) {
     celix_status_t status = CELIX_SUCCESS;
 
@@ -66,6 +83,7 @@ celix_status_t pubsub_topologyManager_create(celix_bundle_context_t *context, ce
     status |= celixThreadMutex_create(&manager->topicReceivers.mutex, NULL);
     status |= celixThreadMutex_create(&manager->topicSenders.mutex, NULL);
     status |= celixThreadMutex_create(&manager->psaMetrics.mutex, NULL);
+    status |= celixThreadMutex_create(&manager->localChannels.mutex, NULL);
     status |= celixThreadMutex_create(&manager->psaHandling.mutex, NULL);
 
     status |= celixThreadCondition_init(&manager->psaHandling.cond, NULL);
@@ -76,11 +94,18 @@ celix_status_t pubsub_topologyManager_create(celix_bundle_context_t *context, ce
     manager->topicReceivers.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
     manager->psaMetrics.map = hashMap_create(NULL, NULL, NULL, NULL);
     manager->topicSenders.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    manager->localChannels.map = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
 
     manager->loghelper = logHelper;
     manager->verbose = celix_bundleContext_getPropertyAsBool(context, PUBSUB_TOPOLOGY_MANAGER_VERBOSE_KEY, PUBSUB_TOPOLOGY_MANAGER_DEFAULT_VERBOSE);
     manager->handlingThreadSleepTime = celix_bundleContext_getPropertyAsLong(context, PUBSUB_TOPOLOGY_MANAGER_HANDLING_THREAD_SLEEPTIME_SECONDS_KEY, PSTM_PSA_HANDLING_DEFAULT_SLEEPTIME_IN_SECONDS);
 
+    manager->localChannels.enabled = celix_bundleContext_getPropertyAsBool(context, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_ENABLED_KEY, PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_ENABLED);
+    const char *policy = celix_bundleContext_getProperty(context, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_POLICY_KEY, PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_POLICY);
+    manager->localChannels.cloneMessages = pstm_isCloneDeliveryPolicy(manager, policy, true);
+    long queueCapacity = celix_bundleContext_getPropertyAsLong(context, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_QUEUE_CAPACITY_KEY, PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_QUEUE_CAPACITY);
+    manager->localChannels.queueCapacity = queueCapacity > 0 ? (size_t)queueCapacity : PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_QUEUE_CAPACITY;
+
     manager->psaHandling.running = true;
     celixThread_create(&manager->psaHandling.thread, NULL, pstm_psaHandlingThread, manager);
     celixThread_setName(&manager->psaHandling.thread, "PubSub TopologyManager");
@@ -97,13 +122,24 @@ celix_status_t pubsub_topologyManager_destroy(pubsub_topology_manager_t *manager
     celixThreadMutex_unlock(&manager->psaHandling.mutex);
     celixThread_join(manager->psaHandling.thread, NULL);
 
+    celixThreadMutex_lock(&manager->localChannels.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(manager->localChannels.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_t *mapEntry = hashMapIterator_nextEntry(&iter);
+        pstm_localChannel_destroy(hashMapEntry_getValue(mapEntry));
+        free(hashMapEntry_getKey(mapEntry));
+    }
+    hashMap_destroy(manager->localChannels.map, false, false);
+    celixThreadMutex_unlock(&manager->localChannels.mutex);
+    celixThreadMutex_destroy(&manager->localChannels.mutex);
+
     celixThreadMutex_lock(&manager->pubsubadmins.mutex);
     hashMap_destroy(manager->pubsubadmins.map, false, false);
     celixThreadMutex_unlock(&manager->pubsubadmins.mutex);
     celixThreadMutex_destroy(&manager->pubsubadmins.mutex);
 
     celixThreadMutex_lock(&manager->discoveredEndpoints.mutex);
-    hash_map_iterator_t iter = hashMapIterator_construct(manager->discoveredEndpoints.map);
+    iter = hashMapIterator_construct(manager->discoveredEndpoints.map);
     while (hashMapIterator_hasNext(&iter)) {
         pstm_discovered_endpoint_entry_t *entry = hashMapIterator_nextValue(&iter);
         if (entry != NULL) {
@@ -195,20 +231,25 @@ void pubsub_topologyManager_psaAdded(void *handle, void *svc, const celix_proper
     //This is needed because the new PSA can be a better match than currently used.
     int needsRematchCount = 0;
 
+    //NOTE entries connected through a local channel do not use a PSA, so these do not need a rematch.
     celixThreadMutex_lock(&manager->topicSenders.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(manager->topicSenders.map);
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
-        entry->matching.needsMatch = true;
-        ++needsRematchCount;
+        if (!entry->matching.localDelivery) {
+            entry->matching.needsMatch = true;
+            ++needsRematchCount;
+        }
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
     iter = hashMapIterator_construct(manager->topicReceivers.map);
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
-        entry->matching.needsMatch = true;
-        ++needsRematchCount;
+        if (!entry->matching.localDelivery) {
+            entry->matching.needsMatch = true;
+            ++needsRematchCount;
+        }
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
 
@@ -646,6 +687,126 @@ struct pstm_teardown_entry {
     long psaSvcId;
 };
 
+struct pstm_local_setup_entry {
+    char* scope;
+    char* topic;
+    char* key;
+    char* serializerType;
+    bool cloneMessages;
+    long bndId;
+};
+
+static void pstm_getSerializerTypeCallback(void *handle, void *svc __attribute__((unused)), const celix_properties_t *props) {
+    char **serType = handle;
+    *serType = celix_utils_strdup(celix_properties_get(props, PUBSUB_MESSAGE_SERIALIZATION_SERVICE_SERIALIZATION_TYPE_PROPERTY, NULL));
+}
+
+/**
+ * Checks whether the topic can be connected through a local channel, i.e. the topic has a local visibility and no other
+ * pubsub admin is requested (or the local admin type is requested).
+ * @return A local setup entry if the topic should use a local channel, otherwise NULL.
+ */
+static struct pstm_local_setup_entry* pstm_matchLocalChannel(pubsub_topology_manager_t *manager, pstm_topic_receiver_or_sender_entry_t *entry, const celix_properties_t *topicProperties, long serializerSvcId) {
+    if (!manager->localChannels.enabled || topicProperties == NULL) {
+        return NULL;
+    }
+    const char *requestedAdmin = celix_properties_get(topicProperties, PUBSUB_ADMIN_TYPE_KEY, NULL);
+    const char *visibility = celix_properties_get(topicProperties, PUBSUB_ENDPOINT_VISIBILITY, PUBSUB_ENDPOINT_VISIBILITY_DEFAULT);
+    bool localAdminRequested = requestedAdmin != NULL && strncmp(requestedAdmin, PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE, strlen(PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE) + 1) == 0;
+    bool localVisibility = strncmp(visibility, PUBSUB_ENDPOINT_LOCAL_VISIBILITY, strlen(PUBSUB_ENDPOINT_LOCAL_VISIBILITY) + 1) == 0;
+    if (!localAdminRequested && (requestedAdmin != NULL || !localVisibility)) {
+        return NULL;
+    }
+
+    char *serType = celix_utils_strdup(celix_properties_get(topicProperties, PUBSUB_SERIALIZER_TYPE_KEY, NULL));
+    if (serType == NULL && serializerSvcId >= 0) {
+        char filter[64];
+        snprintf(filter, sizeof(filter), "(%s=%li)", OSGI_FRAMEWORK_SERVICE_ID, serializerSvcId);
+        celix_service_use_options_t opts = CELIX_EMPTY_SERVICE_USE_OPTIONS;
+        opts.filter.serviceName = PUBSUB_MESSAGE_SERIALIZATION_SERVICE_NAME;
+        opts.filter.filter = filter;
+        opts.filter.ignoreServiceLanguage = true;
+        opts.callbackHandle = &serType;
+        opts.useWithProperties = pstm_getSerializerTypeCallback;
+        celix_bundleContext_useServiceWithOptions(manager->context, &opts);
+    }
+
+    struct pstm_local_setup_entry *setupEntry = malloc(sizeof(*setupEntry));
+    setupEntry->scope = celix_utils_strdup(entry->scope);
+    setupEntry->topic = celix_utils_strdup(entry->topic);
+    setupEntry->key = celix_utils_strdup(entry->scopeAndTopicKey);
+    setupEntry->serializerType = serType != NULL ? serType : celix_utils_strdup(PSTM_LOCAL_CHANNEL_DEFAULT_SERIALIZER);
+    setupEntry->cloneMessages = pstm_isCloneDeliveryPolicy(manager, celix_properties_get(topicProperties, PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_TOPIC_PROPERTY, NULL), manager->localChannels.cloneMessages);
+    setupEntry->bndId = entry->bndId;
+    return setupEntry;
+}
+
+//Note called on pstm update thread, the local channels map is only updated on the pstm update thread.
+static void pstm_setupLocalChannels(pubsub_topology_manager_t *manager, celix_array_list_t *setupEntries, bool publisher) {
+    for (int i = 0; i < celix_arrayList_size(setupEntries); ++i) {
+        struct pstm_local_setup_entry *setupEntry = celix_arrayList_get(setupEntries, i);
+        celixThreadMutex_lock(&manager->localChannels.mutex);
+        pstm_local_channel_t *channel = hashMap_get(manager->localChannels.map, setupEntry->key);
+        celixThreadMutex_unlock(&manager->localChannels.mutex);
+
+        if (channel == NULL) {
+            channel = pstm_localChannel_create(manager->context, manager->loghelper, setupEntry->scope, setupEntry->topic,
+                                               setupEntry->serializerType, setupEntry->cloneMessages, manager->localChannels.queueCapacity);
+            if (channel != NULL) {
+                celixThreadMutex_lock(&manager->localChannels.mutex);
+                hashMap_put(manager->localChannels.map, celix_utils_strdup(setupEntry->key), channel);
+                celixThreadMutex_unlock(&manager->localChannels.mutex);
+            }
+        } else if (strncmp(pstm_localChannel_serializerType(channel), setupEntry->serializerType, 1024) != 0) {
+            celix_logHelper_warning(manager->loghelper, "Local channel for %s/%s uses serializer %s, ignoring requested serializer %s",
+                                    setupEntry->scope == NULL ? "(null)" : setupEntry->scope, setupEntry->topic,
+                                    pstm_localChannel_serializerType(channel), setupEntry->serializerType);
+        }
+
+        if (channel == NULL) {
+            celix_logHelper_warning(manager->loghelper, "Cannot setup local channel for %s/%s\n", setupEntry->scope == NULL ? "(null)" : setupEntry->scope, setupEntry->topic);
+        } else if (publisher) {
+            pstm_localChannel_setPublisherEnabled(channel, true, setupEntry->bndId);
+        } else {
+            pstm_localChannel_setSubscribersEnabled(channel, true);
+        }
+
+        free(setupEntry->scope);
+        free(setupEntry->topic);
+        free(setupEntry->key);
+        free(setupEntry->serializerType);
+        free(setupEntry);
+    }
+}
+
+//Note called on pstm update thread
+static void pstm_teardownLocalChannels(pubsub_topology_manager_t *manager, celix_array_list_t *keys, bool publisher) {
+    for (int i = 0; i < celix_arrayList_size(keys); ++i) {
+        char *key = celix_arrayList_get(keys, i);
+        celixThreadMutex_lock(&manager->localChannels.mutex);
+        pstm_local_channel_t *channel = hashMap_get(manager->localChannels.map, key);
+        celixThreadMutex_unlock(&manager->localChannels.mutex);
+
+        if (channel != NULL) {
+            if (publisher) {
+                pstm_localChannel_setPublisherEnabled(channel, false, -1L);
+            } else {
+                pstm_localChannel_setSubscribersEnabled(channel, false);
+            }
+            if (!pstm_localChannel_isPublisherEnabled(channel) && !pstm_localChannel_isSubscribersEnabled(channel)) {
+                celixThreadMutex_lock(&manager->localChannels.mutex);
+                hash_map_entry_t *mapEntry = hashMap_getEntry(manager->localChannels.map, key);
+                char *mapKey = hashMapEntry_getKey(mapEntry);
+                hashMap_remove(manager->localChannels.map, key);
+                free(mapKey);
+                celixThreadMutex_unlock(&manager->localChannels.mutex);
+                pstm_localChannel_destroy(channel);
+            }
+        }
+        free(key);
+    }
+}
+
 static void pstm_teardownTopicSenderCallback(void *handle, void *svc) {
     struct pstm_teardown_entry* entry = handle;
     pubsub_admin_service_t *psa = svc;
@@ -656,6 +817,7 @@ static void pstm_teardownTopicSenderCallback(void *handle, void *svc) {
 static void pstm_teardownTopicSenders(pubsub_topology_manager_t *manager) {
     celix_array_list_t* revokeEndpoints = celix_arrayList_create();
     celix_array_list_t* teardownEntries = celix_arrayList_create();
+    celix_array_list_t* localTeardownKeys = celix_arrayList_create();
 
     celixThreadMutex_lock(&manager->topicSenders.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(manager->topicSenders.map);
@@ -663,6 +825,10 @@ static void pstm_teardownTopicSenders(pubsub_topology_manager_t *manager) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
 
         if (entry != NULL && (entry->usageCount <= 0 || entry->matching.needsMatch)) {
+            if (entry->matching.localDelivery) {
+                celix_arrayList_add(localTeardownKeys, celix_utils_strdup(entry->scopeAndTopicKey));
+                entry->matching.localDelivery = false;
+            }
             if (manager->verbose && entry->endpoint != NULL) {
                 celix_logHelper_log(manager->loghelper, CELIX_LOG_LEVEL_DEBUG,
                               "Tearing down TopicSender for scope/topic %s/%s\n", entry->scope == NULL ? "(null)" : entry->scope, entry->topic);
@@ -709,7 +875,8 @@ static void pstm_teardownTopicSenders(pubsub_topology_manager_t *manager) {
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
 
-
+    pstm_teardownLocalChannels(manager, localTeardownKeys, true);
+    celix_arrayList_destroy(localTeardownKeys);
 
     celixThreadMutex_lock(&manager->announceEndpointListeners.mutex);
     for (int i = 0; i < celix_arrayList_size(manager->announceEndpointListeners.list); ++i) {
@@ -745,12 +912,17 @@ static void pstm_teardownTopicReceiverCallback(void *handle, void *svc) {
 static void pstm_teardownTopicReceivers(pubsub_topology_manager_t *manager) {
     celix_array_list_t* revokeEndpoints = celix_arrayList_create();
     celix_array_list_t* teardownEntries = celix_arrayList_create();
+    celix_array_list_t* localTeardownKeys = celix_arrayList_create();
 
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(manager->topicReceivers.map);
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
         if (entry != NULL && (entry->usageCount <= 0 || entry->matching.needsMatch)) {
+            if (entry->matching.localDelivery) {
+                celix_arrayList_add(localTeardownKeys, celix_utils_strdup(entry->scopeAndTopicKey));
+                entry->matching.localDelivery = false;
+            }
             if (manager->verbose && entry->endpoint != NULL) {
                 const char *adminType = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_ADMIN_TYPE, "!Error!");
                 const char *serType = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_SERIALIZER, "!Error!");
@@ -801,6 +973,9 @@ static void pstm_teardownTopicReceivers(pubsub_topology_manager_t *manager) {
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
 
+    pstm_teardownLocalChannels(manager, localTeardownKeys, false);
+    celix_arrayList_destroy(localTeardownKeys);
+
     celixThreadMutex_lock(&manager->announceEndpointListeners.mutex);
     for (int i = 0; i < celix_arrayList_size(manager->announceEndpointListeners.list); ++i) {
         pubsub_announce_endpoint_listener_t *listener;
@@ -889,11 +1064,33 @@ static void pstm_setupTopicSenderCallback(void *handle, void *svc) {
 
 static void pstm_setupTopicSenders(pubsub_topology_manager_t *manager) {
     celix_array_list_t* setupEntries = celix_arrayList_create();
+    celix_array_list_t* localSetupEntries = celix_arrayList_create();
 
     celixThreadMutex_lock(&manager->topicSenders.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(manager->topicSenders.map);
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry != NULL && entry->matching.needsMatch && entry->usageCount > 0 && manager->localChannels.enabled) {
+            //first check if the publisher can be connected through a local channel
+            celix_properties_t *topicProps = NULL;
+            long serSvcId = -1L;
+            pubsub_utils_matchPublisher(manager->context, entry->bndId, entry->publisherFilter->filterStr, PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE,
+                                        0.0, 0.0, 0.0, false, &topicProps, &serSvcId, NULL);
+            struct pstm_local_setup_entry *localSetupEntry = pstm_matchLocalChannel(manager, entry, topicProps, serSvcId);
+            if (localSetupEntry != NULL) {
+                entry->matching.needsMatch = false;
+                entry->matching.localDelivery = true;
+                entry->matching.selectedSerializerSvcId = serSvcId;
+                if (entry->topicProperties != NULL) {
+                    celix_properties_destroy(entry->topicProperties);
+                }
+                entry->topicProperties = topicProps;
+                celix_arrayList_add(localSetupEntries, localSetupEntry);
+                continue;
+            } else if (topicProps != NULL) {
+                celix_properties_destroy(topicProps);
+            }
+        }
         if (entry != NULL && entry->matching.needsMatch && entry->usageCount > 0) {
             //new topic sender needed, requesting match with current psa
             double highestScore = PUBSUB_ADMIN_NO_MATCH_SCORE;
@@ -950,6 +1147,9 @@ static void pstm_setupTopicSenders(pubsub_topology_manager_t *manager) {
     }
     celixThreadMutex_unlock(&manager->topicSenders.mutex);
 
+    pstm_setupLocalChannels(manager, localSetupEntries, true);
+    celix_arrayList_destroy(localSetupEntries);
+
     for (int i = 0; i < celix_arrayList_size(setupEntries); ++i) {
         struct pstm_setup_entry* setupEntry = celix_arrayList_get(setupEntries, i);
         bool called = celix_bundleContext_useServiceWithId(manager->context, setupEntry->psaSvcId, PUBSUB_ADMIN_SERVICE_NAME, setupEntry, pstm_setupTopicSenderCallback);
@@ -992,11 +1192,33 @@ static void pstm_setupTopicReceiverCallback(void *handle, void *svc) {
 
 static void pstm_setupTopicReceivers(pubsub_topology_manager_t *manager) {
     celix_array_list_t* setupEntries = celix_arrayList_create();
+    celix_array_list_t* localSetupEntries = celix_arrayList_create();
 
     celixThreadMutex_lock(&manager->topicReceivers.mutex);
     hash_map_iterator_t iter = hashMapIterator_construct(manager->topicReceivers.map);
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
+        if (entry != NULL && entry->matching.needsMatch && entry->usageCount > 0 && manager->localChannels.enabled) {
+            //first check if the subscribers can be connected through a local channel
+            celix_properties_t *topicProps = NULL;
+            long serSvcId = -1L;
+            pubsub_utils_matchSubscriber(manager->context, entry->bndId, entry->subscriberProperties, PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE,
+                                         0.0, 0.0, 0.0, false, &topicProps, &serSvcId, NULL);
+            struct pstm_local_setup_entry *localSetupEntry = pstm_matchLocalChannel(manager, entry, topicProps, serSvcId);
+            if (localSetupEntry != NULL) {
+                entry->matching.needsMatch = false;
+                entry->matching.localDelivery = true;
+                entry->matching.selectedSerializerSvcId = serSvcId;
+                if (entry->topicProperties != NULL) {
+                    celix_properties_destroy(entry->topicProperties);
+                }
+                entry->topicProperties = topicProps;
+                celix_arrayList_add(localSetupEntries, localSetupEntry);
+                continue;
+            } else if (topicProps != NULL) {
+                celix_properties_destroy(topicProps);
+            }
+        }
         if (entry != NULL && entry->matching.needsMatch && entry->usageCount > 0) {
 
             double highestScore = PUBSUB_ADMIN_NO_MATCH_SCORE;
@@ -1053,7 +1275,8 @@ static void pstm_setupTopicReceivers(pubsub_topology_manager_t *manager) {
     }
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
 
-
+    pstm_setupLocalChannels(manager, localSetupEntries, false);
+    celix_arrayList_destroy(localSetupEntries);
 
     for (int i = 0; i < celix_arrayList_size(setupEntries); ++i) {
         struct pstm_setup_entry* setupEntry = celix_arrayList_get(setupEntries, i);
@@ -1173,7 +1396,9 @@ static celix_status_t pubsub_topologyManager_topology(pubsub_topology_manager_t
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
         if (entry->endpoint == NULL) {
-            ++countPendingSenders;
+            if (!entry->matching.localDelivery) {
+                ++countPendingSenders;
+            }
             continue;
         }
         const char *uuid = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_UUID, "!Error!");
@@ -1203,7 +1428,9 @@ static celix_status_t pubsub_topologyManager_topology(pubsub_topology_manager_t
     while (hashMapIterator_hasNext(&iter)) {
         pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
         if (entry->endpoint == NULL) {
-            ++countPendingReceivers;
+            if (!entry->matching.localDelivery) {
+                ++countPendingReceivers;
+            }
             continue;
         }
         const char *uuid = celix_properties_get(entry->endpoint, PUBSUB_ENDPOINT_UUID, "!Error!");
@@ -1226,13 +1453,25 @@ static celix_status_t pubsub_topologyManager_topology(pubsub_topology_manager_t
     celixThreadMutex_unlock(&manager->topicReceivers.mutex);
     fprintf(os, "\n");
 
+    celixThreadMutex_lock(&manager->localChannels.mutex);
+    if (hashMap_size(manager->localChannels.map) > 0) {
+        fprintf(os, "Local Channels:\n");
+        iter = hashMapIterator_construct(manager->localChannels.map);
+        while (hashMapIterator_hasNext(&iter)) {
+            pstm_local_channel_t *channel = hashMapIterator_nextValue(&iter);
+            pstm_localChannel_printInfo(channel, manager->verbose, os);
+        }
+        fprintf(os, "\n");
+    }
+    celixThreadMutex_unlock(&manager->localChannels.mutex);
+
     if (countPendingSenders > 0) {
         fprintf(os, "Pending Topic Senders:\n");
         celixThreadMutex_lock(&manager->topicSenders.mutex);
         iter = hashMapIterator_construct(manager->topicSenders.map);
         while (hashMapIterator_hasNext(&iter)) {
             pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
-            if (entry->endpoint == NULL) {
+            if (entry->endpoint == NULL && !entry->matching.localDelivery) {
                 fprintf(os, "|- Pending Topic Sender for %s/%s:\n", entry->scope == NULL ? "(null)" : entry->scope, entry->topic);
                 const char *requestedQos = celix_properties_get(entry->topicProperties, PUBSUB_UTILS_QOS_ATTRIBUTE_KEY, "(None)");
                 const char *requestedConfig = celix_properties_get(entry->topicProperties, PUBSUB_ADMIN_TYPE_KEY, "(None)");
@@ -1257,7 +1496,7 @@ static celix_status_t pubsub_topologyManager_topology(pubsub_topology_manager_t
         iter = hashMapIterator_construct(manager->topicReceivers.map);
         while (hashMapIterator_hasNext(&iter)) {
             pstm_topic_receiver_or_sender_entry_t *entry = hashMapIterator_nextValue(&iter);
-            if (entry->endpoint == NULL) {
+            if (entry->endpoint == NULL && !entry->matching.localDelivery) {
                 fprintf(os, "|- Topic Receiver for %s/%s:\n", entry->scope == NULL ? "(null)" : entry->scope, entry->topic);
                 const char *requestedQos = celix_properties_get(entry->topicProperties, PUBSUB_UTILS_QOS_ATTRIBUTE_KEY, "(None)");
                 const char *requestedConfig = celix_properties_get(entry->topicProperties, PUBSUB_ADMIN_TYPE_KEY, "(None)");
@@ -1280,6 +1519,31 @@ static celix_status_t pubsub_topologyManager_topology(pubsub_topology_manager_t
     return CELIX_SUCCESS;
 }
 
+pubsub_admin_metrics_t* pubsub_topologyManager_localChannelMetrics(void *handle) {
+    pubsub_topology_manager_t *manager = handle;
+    pubsub_admin_metrics_t *result = calloc(1, sizeof(*result));
+    snprintf(result->psaType, PUBSUB_AMDIN_METRICS_NAME_MAX, "%s", PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE);
+    result->senders = celix_arrayList_create();
+    result->receivers = celix_arrayList_create();
+
+    celixThreadMutex_lock(&manager->localChannels.mutex);
+    hash_map_iterator_t iter = hashMapIterator_construct(manager->localChannels.map);
+    while (hashMapIterator_hasNext(&iter)) {
+        pstm_local_channel_t *channel = hashMapIterator_nextValue(&iter);
+        pubsub_admin_sender_metrics_t *sm = pstm_localChannel_senderMetrics(channel);
+        if (sm != NULL) {
+            celix_arrayList_add(result->senders, sm);
+        }
+        pubsub_admin_receiver_metrics_t *rm = pstm_localChannel_receiverMetrics(channel);
+        if (rm != NULL) {
+            celix_arrayList_add(result->receivers, rm);
+        }
+    }
+    celixThreadMutex_unlock(&manager->localChannels.mutex);
+
+    return result;
+}
+
 static void fetchBundleName(void *handle, const bundle_t *bundle) {
     const char **out = handle;
     *out = celix_bundle_getSymbolicName(bundle);
@@ -1302,6 +1566,11 @@ static celix_status_t pubsub_topologyManager_metrics(pubsub_topology_manager_t *
         for (int k = 0; k < celix_arrayList_size(metrics->senders); ++k) {
             pubsub_admin_sender_metrics_t *sm = celix_arrayList_get(metrics->senders, k);
             fprintf(os, "|- Topic Sender %s/%s\n", sm->scope, sm->topic);
+            if (sm->asyncSendEnabled) {
+                fprintf(os, "   |- send queue depth = %lu (max %lu, capacity %lu)\n", sm->sendQueueDepth, sm->maxSendQueueDepth, sm->sendQueueCapacity);
+                fprintf(os, "   |- dropped messages = %lu\n", sm->nrOfDroppedMessages);
+                fprintf(os, "   |- send batches = %lu\n", sm->nrOfSendBatches);
+            }
             for (int j = 0; j < sm->nrOfmsgMetrics; ++j) {
                 if (sm->msgMetrics[j].nrOfMessagesSend == 0 && sm->msgMetrics[j].nrOfMessagesSendFailed == 0 && sm->msgMetrics[j].nrOfSerializationErrors == 0) {
                     continue;
@@ -29,11 +29,40 @@
 #include "pubsub_endpoint.h"
 #include "pubsub/publisher.h"
 #include "pubsub/subscriber.h"
+#include "pubsub_admin_metrics.h"
 
 #define PUBSUB_TOPOLOGY_MANAGER_VERBOSE_KEY         "PUBSUB_TOPOLOGY_MANAGER_VERBOSE"
 #define PUBSUB_TOPOLOGY_MANAGER_HANDLING_THREAD_SLEEPTIME_SECONDS_KEY         "PUBSUB_TOPOLOGY_MANAGER_HANDLING_THREAD_SLEEPTIME_SECONDS"
 #define PUBSUB_TOPOLOGY_MANAGER_DEFAULT_VERBOSE     false
 
+/**
+ * Whether publishers and subscribers of a topic with local visibility (pubsub.endpoint.visibility=local in the topic
+ * properties) and without a requested pubsub admin (pubsub.config) are connected directly through an in-process
+ * local channel, instead of through a pubsub admin.
+ */
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_ENABLED_KEY          "PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_ENABLED"
+#define PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_ENABLED      true
+
+/**
+ * The delivery policy of local channels: "clone" or "reference".
+ * With clone the subscribers get a copy of the message (using the serializer), with reference the subscribers get the
+ * message of the publisher and the send call blocks until the message is delivered.
+ * Can be overridden per topic with the PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_TOPIC_PROPERTY topic property.
+ */
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_POLICY_KEY           "PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_POLICY"
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_TOPIC_PROPERTY       "pubsub.local.delivery"
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_CLONE                "clone"
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_REFERENCE            "reference"
+#define PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_POLICY       PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_CLONE
+
+/**
+ * The capacity of the queue between the publisher and the dispatcher thread of a local channel.
+ */
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_QUEUE_CAPACITY_KEY   "PUBSUB_TOPOLOGY_MANAGER_LOCAL_DELIVERY_QUEUE_CAPACITY"
+#define PUBSUB_TOPOLOGY_MANAGER_DEFAULT_LOCAL_DELIVERY_QUEUE_CAPACITY   1024
+
+#define PUBSUB_TOPOLOGY_MANAGER_LOCAL_ADMIN_TYPE    "local"
+
 
 typedef struct pubsub_topology_manager {
     celix_bundle_context_t *context;
@@ -68,6 +97,14 @@ typedef struct pubsub_topology_manager {
         hash_map_t *map; //key = svcId, value = pubsub_admin_metrics_service_t*
     } psaMetrics;
 
+    struct {
+        celix_thread_mutex_t mutex;
+        hash_map_t *map; //key = scope/topic key, value = pstm_local_channel_t*
+        bool enabled;
+        bool cloneMessages;
+        size_t queueCapacity;
+    } localChannels;
+
     struct {
         celix_thread_t thread;
         celix_thread_mutex_t mutex; //protect running and condition
@@ -108,6 +145,7 @@ typedef struct pstm_topic_receiver_or_sender_entry {
         long selectedPsaSvcId;
         long selectedSerializerSvcId;
         long selectedProtocolSvcId;
+        bool localDelivery; //true if connected through a local channel instead of a psa
     } matching;
 } pstm_topic_receiver_or_sender_entry_t;
 
@@ -134,4 +172,9 @@ bool pubsub_topologyManager_shellCommand(void *handle, const char * commandLine,
 void pubsub_topologyManager_addMetricsService(void * handle, void *svc, const celix_properties_t *props);
 void pubsub_topologyManager_removeMetricsService(void * handle, void *svc, const celix_properties_t *props);
 
+/**
+ * Creates the metrics of the local channels, used for the metrics service of the topology manager.
+ */
+pubsub_admin_metrics_t* pubsub_topologyManager_localChannelMetrics(void *handle);
+
 #endif /* PUBSUB_TOPOLOGY_MANAGER_H_ */
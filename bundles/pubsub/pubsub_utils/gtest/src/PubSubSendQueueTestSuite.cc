@@ -0,0 +1,166 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "pubsub_send_queue.h"
+
+class PubSubSendQueueTestSuite : public ::testing::Test {
+public:
+    static void countDropped(void* handle, void* /*msg*/) {
+        auto* count = static_cast<std::atomic<int>*>(handle);
+        count->fetch_add(1);
+    }
+
+    static void* toMsg(uintptr_t val) {
+        return reinterpret_cast<void*>(val);
+    }
+
+    std::atomic<int> dropped{0};
+};
+
+TEST_F(PubSubSendQueueTestSuite, ParsePolicy) {
+    EXPECT_EQ(PUBSUB_SEND_QUEUE_BLOCK, pubsub_sendQueue_parsePolicy("block", PUBSUB_SEND_QUEUE_DROP_NEWEST));
+    EXPECT_EQ(PUBSUB_SEND_QUEUE_DROP_OLDEST, pubsub_sendQueue_parsePolicy("drop-oldest", PUBSUB_SEND_QUEUE_BLOCK));
+    EXPECT_EQ(PUBSUB_SEND_QUEUE_DROP_NEWEST, pubsub_sendQueue_parsePolicy("DROP-NEWEST", PUBSUB_SEND_QUEUE_BLOCK));
+    EXPECT_EQ(PUBSUB_SEND_QUEUE_BLOCK, pubsub_sendQueue_parsePolicy("unknown", PUBSUB_SEND_QUEUE_BLOCK));
+    EXPECT_EQ(PUBSUB_SEND_QUEUE_DROP_OLDEST, pubsub_sendQueue_parsePolicy(nullptr, PUBSUB_SEND_QUEUE_DROP_OLDEST));
+}
+
+TEST_F(PubSubSendQueueTestSuite, DropNewest) {
+    EXPECT_EQ(nullptr, pubsub_sendQueue_create(0, PUBSUB_SEND_QUEUE_DROP_NEWEST, nullptr, nullptr));
+    auto* queue = pubsub_sendQueue_create(4, PUBSUB_SEND_QUEUE_DROP_NEWEST, &dropped, countDropped);
+    for (uintptr_t i = 1; i <= 4; ++i) {
+        EXPECT_TRUE(pubsub_sendQueue_push(queue, toMsg(i)));
+    }
+    EXPECT_FALSE(pubsub_sendQueue_push(queue, toMsg(5))); //full, caller keeps ownership
+    EXPECT_EQ(0, dropped.load());
+
+    void* msgs[8];
+    ASSERT_EQ(4, pubsub_sendQueue_popBatch(queue, msgs, 8));
+    for (uintptr_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(toMsg(i + 1), msgs[i]);
+    }
+
+    pubsub_send_queue_stats_t stats;
+    pubsub_sendQueue_getStats(queue, &stats);
+    EXPECT_EQ(4, stats.capacity);
+    EXPECT_EQ(0, stats.size);
+    EXPECT_EQ(4, stats.maxSize);
+    EXPECT_EQ(1, stats.nrOfDroppedMessages);
+    EXPECT_EQ(1, stats.nrOfBatches);
+    pubsub_sendQueue_destroy(queue);
+}
+
+TEST_F(PubSubSendQueueTestSuite, DropOldest) {
+    auto* queue = pubsub_sendQueue_create(4, PUBSUB_SEND_QUEUE_DROP_OLDEST, &dropped, countDropped);
+    for (uintptr_t i = 1; i <= 6; ++i) {
+        EXPECT_TRUE(pubsub_sendQueue_push(queue, toMsg(i)));
+    }
+    EXPECT_EQ(2, dropped.load());
+
+    void* msgs[2];
+    ASSERT_EQ(2, pubsub_sendQueue_popBatch(queue, msgs, 2));
+    EXPECT_EQ(toMsg(3), msgs[0]);
+    EXPECT_EQ(toMsg(4), msgs[1]);
+
+    //remaining messages are dropped on destroy
+    pubsub_sendQueue_destroy(queue);
+    EXPECT_EQ(4, dropped.load());
+}
+
+TEST_F(PubSubSendQueueTestSuite, BlockAndClose) {
+    auto* queue = pubsub_sendQueue_create(2, PUBSUB_SEND_QUEUE_BLOCK, &dropped, countDropped);
+    EXPECT_TRUE(pubsub_sendQueue_push(queue, toMsg(1)));
+    EXPECT_TRUE(pubsub_sendQueue_push(queue, toMsg(2)));
+
+    std::atomic<bool> pushed{false};
+    std::thread producer{[&] {
+        EXPECT_TRUE(pubsub_sendQueue_push(queue, toMsg(3))); //blocks until a message is popped
+        pushed = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    EXPECT_FALSE(pushed.load());
+
+    void* msgs[1];
+    EXPECT_EQ(1, pubsub_sendQueue_popBatch(queue, msgs, 1));
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+
+    pubsub_sendQueue_close(queue);
+    EXPECT_FALSE(pubsub_sendQueue_push(queue, toMsg(4)));
+    void* remaining[4];
+    EXPECT_EQ(2, pubsub_sendQueue_popBatch(queue, remaining, 4)); //queued messages can still be popped
+    EXPECT_EQ(0, pubsub_sendQueue_popBatch(queue, remaining, 4));
+    pubsub_sendQueue_destroy(queue);
+    EXPECT_EQ(0, dropped.load());
+}
+
+TEST_F(PubSubSendQueueTestSuite, MultipleProducers) {
+    const int nrOfProducers = 4;
+    const int nrOfMessages = 10000;
+    auto* queue = pubsub_sendQueue_create(64, PUBSUB_SEND_QUEUE_BLOCK, &dropped, countDropped);
+
+    std::vector<uint64_t> received(nrOfProducers, 0);
+    std::vector<bool> inOrder(nrOfProducers, true);
+    std::thread consumer{[&] {
+        void* msgs[16];
+        size_t count;
+        while ((count = pubsub_sendQueue_popBatch(queue, msgs, 16)) > 0) {
+            for (size_t i = 0; i < count; ++i) {
+                auto val = reinterpret_cast<uintptr_t>(msgs[i]);
+                auto producerId = val % nrOfProducers;
+                auto seq = val / nrOfProducers;
+                if (seq != received[producerId]) {
+                    inOrder[producerId] = false;
+                }
+                received[producerId] = seq + 1;
+            }
+        }
+    }};
+
+    std::vector<std::thread> producers{};
+    for (int p = 0; p < nrOfProducers; ++p) {
+        producers.emplace_back([queue, p] {
+            for (int i = 0; i < nrOfMessages; ++i) {
+                pubsub_sendQueue_push(queue, toMsg((uintptr_t)i * nrOfProducers + p));
+            }
+        });
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+    pubsub_sendQueue_close(queue);
+    consumer.join();
+
+    for (int p = 0; p < nrOfProducers; ++p) {
+        EXPECT_EQ((uint64_t)nrOfMessages, received[p]);
+        EXPECT_TRUE(inOrder[p]);
+    }
+    pubsub_send_queue_stats_t stats;
+    pubsub_sendQueue_getStats(queue, &stats);
+    EXPECT_LE(stats.maxSize, stats.capacity);
+    EXPECT_EQ(0, stats.nrOfDroppedMessages);
+    pubsub_sendQueue_destroy(queue);
+}
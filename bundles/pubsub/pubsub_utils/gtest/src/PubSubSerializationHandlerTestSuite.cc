@@ -260,4 +260,23 @@ TEST_F(PubSubSerializationHandlerTestSuite, BackwardsCompatibleCall) {
 
     celix_bundleContext_unregisterService(ctx.get(), svcId1);
     pubsub_serializerHandler_destroy(handler);
-}
\ No newline at end of file
+}
+
+TEST_F(PubSubSerializationHandlerTestSuite, GetMsgInfo) {
+    auto *handler = pubsub_serializerHandler_create(ctx.get(), "json", true);
+
+    long svcId1 = registerSerSvc("json", 42, "example::Msg1", "1.3.0");
+
+    EXPECT_EQ(42, pubsub_serializerHandler_getMsgId(handler, "example::Msg1"));
+    EXPECT_EQ(0, pubsub_serializerHandler_getMsgId(handler, "example::Msg2"));
+    char* fqn = pubsub_serializerHandler_getMsgFqn(handler, 42);
+    EXPECT_STREQ("example::Msg1", fqn);
+    free(fqn);
+    EXPECT_EQ(1, pubsub_serializerHandler_getMsgMajorVersion(handler, 42));
+    EXPECT_EQ(3, pubsub_serializerHandler_getMsgMinorVersion(handler, 42));
+    EXPECT_EQ(-1, pubsub_serializerHandler_getMsgMajorVersion(handler, 43));
+    EXPECT_EQ(-1, pubsub_serializerHandler_getMsgMinorVersion(handler, 43));
+
+    celix_bundleContext_unregisterService(ctx.get(), svcId1);
+    pubsub_serializerHandler_destroy(handler);
+}
@@ -0,0 +1,162 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "pubsub_shared_message.h"
+
+class PubSubSharedMessageTestSuite : public ::testing::Test {
+public:
+    static void freeMsg(void* handle, void* msg) {
+        auto* count = static_cast<int*>(handle);
+        *count += 1;
+        free(msg);
+    }
+
+    int freeCount = 0;
+};
+
+TEST_F(PubSubSharedMessageTestSuite, RetainAndRelease) {
+    void* msg = malloc(16);
+    auto* shared = pubsub_sharedMessage_create(msg, &freeCount, freeMsg);
+    EXPECT_EQ(msg, shared->msg);
+
+    shared->retain(shared); //e.g. a subscriber keeps the message
+    pubsub_sharedMessage_release(shared); //receiver reference
+    EXPECT_EQ(0, freeCount);
+    shared->release(shared);
+    EXPECT_EQ(1, freeCount);
+}
+
+TEST_F(PubSubSharedMessageTestSuite, Reclaim) {
+    void* msg = malloc(16);
+    auto* shared = pubsub_sharedMessage_create(msg, &freeCount, freeMsg);
+    void* reclaimed = nullptr;
+    EXPECT_TRUE(pubsub_sharedMessage_reclaim(shared, &reclaimed));
+    EXPECT_EQ(msg, reclaimed);
+    EXPECT_EQ(0, freeCount);
+    free(reclaimed);
+
+    msg = malloc(16);
+    shared = pubsub_sharedMessage_create(msg, &freeCount, freeMsg);
+    shared->retain(shared);
+    reclaimed = nullptr;
+    EXPECT_FALSE(pubsub_sharedMessage_reclaim(shared, &reclaimed)); //retained, so the reference is released instead
+    EXPECT_EQ(nullptr, reclaimed);
+    EXPECT_EQ(0, freeCount);
+    shared->release(shared);
+    EXPECT_EQ(1, freeCount);
+}
+
+TEST_F(PubSubSharedMessageTestSuite, IsSharedSubscriber) {
+    pubsub_subscriber_t svc{};
+    svc.receiveShared = [](void*, const char*, unsigned int, pubsub_shared_message_t*, const celix_properties_t*) -> int {
+        return 0;
+    };
+    celix_properties_t* props = celix_properties_create();
+    EXPECT_FALSE(pubsub_sharedMessage_isSharedSubscriber(&svc, props));
+    celix_properties_setBool(props, PUBSUB_SUBSCRIBER_SHARED_MESSAGES, true);
+    EXPECT_TRUE(pubsub_sharedMessage_isSharedSubscriber(&svc, props));
+    svc.receiveShared = nullptr;
+    EXPECT_FALSE(pubsub_sharedMessage_isSharedSubscriber(&svc, props));
+    celix_properties_destroy(props);
+}
+
+TEST_F(PubSubSharedMessageTestSuite, Deliver) {
+    struct subscriber_handle {
+        pubsub_shared_message_t* retained = nullptr;
+        std::vector<void*> taken{};
+    } handle{};
+
+    //shared subscriber which retains the message
+    pubsub_subscriber_t sharedSvc{};
+    sharedSvc.handle = &handle;
+    sharedSvc.receiveShared = [](void* h, const char*, unsigned int, pubsub_shared_message_t* msg, const celix_properties_t*) -> int {
+        auto* sh = static_cast<subscriber_handle*>(h);
+        msg->retain(msg);
+        sh->retained = msg;
+        return 0;
+    };
+    //non shared subscribers which take over the ownership of the message
+    pubsub_subscriber_t svc{};
+    svc.handle = &handle;
+    svc.receive = [](void* h, const char*, unsigned int, void* msg, const celix_properties_t*, bool* release) -> int {
+        auto* sh = static_cast<subscriber_handle*>(h);
+        sh->taken.push_back(msg);
+        *release = false;
+        return 0;
+    };
+
+    hash_map_t* subscriberServices = hashMap_create(nullptr, nullptr, nullptr, nullptr);
+    hash_map_t* sharedSubscriberServices = hashMap_create(nullptr, nullptr, nullptr, nullptr);
+    hashMap_put(subscriberServices, (void*)1L, &sharedSvc);
+    hashMap_put(sharedSubscriberServices, (void*)1L, &sharedSvc);
+    hashMap_put(subscriberServices, (void*)2L, &svc);
+    hashMap_put(subscriberServices, (void*)3L, &svc);
+
+    static int deserializeCount;
+    deserializeCount = 0;
+    pubsub_shared_message_delivery_t delivery{};
+    delivery.msgFqn = "test";
+    delivery.msgId = 42;
+    delivery.serializerHandle = &freeCount;
+    delivery.deserialize = [](void*, const struct iovec*, size_t, void** out) -> celix_status_t {
+        deserializeCount += 1;
+        *out = malloc(16);
+        return CELIX_SUCCESS;
+    };
+    delivery.freeDeserializedMsg = freeMsg;
+
+    void* msg = malloc(16);
+    EXPECT_EQ(CELIX_SUCCESS, pubsub_sharedMessage_deliver(&delivery, subscriberServices, sharedSubscriberServices, msg));
+
+    //the shared message is retained and both other subscribers took over a message, so 2 additional deserializations
+    EXPECT_EQ(2, deserializeCount);
+    ASSERT_NE(nullptr, handle.retained);
+    EXPECT_EQ(msg, handle.retained->msg);
+    ASSERT_EQ(2, handle.taken.size());
+    EXPECT_NE(msg, handle.taken[0]);
+    EXPECT_NE(msg, handle.taken[1]);
+    EXPECT_NE(handle.taken[0], handle.taken[1]);
+    EXPECT_EQ(0, freeCount);
+
+    handle.retained->release(handle.retained);
+    EXPECT_EQ(1, freeCount);
+    for (auto* taken : handle.taken) {
+        free(taken);
+    }
+
+    //without a retain, the shared message is reclaimed and the deserialized message is freed after the delivery
+    sharedSvc.receiveShared = [](void*, const char*, unsigned int, pubsub_shared_message_t*, const celix_properties_t*) -> int {
+        return 0;
+    };
+    hashMap_remove(subscriberServices, (void*)3L);
+    svc.receive = [](void*, const char*, unsigned int, void*, const celix_properties_t*, bool*) -> int {
+        return 0;
+    };
+    deserializeCount = 0;
+    EXPECT_EQ(CELIX_SUCCESS, pubsub_sharedMessage_deliver(&delivery, subscriberServices, sharedSubscriberServices, malloc(16)));
+    EXPECT_EQ(0, deserializeCount);
+    EXPECT_EQ(2, freeCount);
+
+    hashMap_destroy(subscriberServices, false, false);
+    hashMap_destroy(sharedSubscriberServices, false, false);
+}
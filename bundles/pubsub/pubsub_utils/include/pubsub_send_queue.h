@@ -0,0 +1,110 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SEND_QUEUE_H
+#define CELIX_PUBSUB_SEND_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PUBSUB_SEND_QUEUE_POLICY_BLOCK          "block"
+#define PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST    "drop-oldest"
+#define PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST    "drop-newest"
+
+/**
+ * The backpressure policy of a send queue, i.e. what happens when a message is pushed on a full queue.
+ */
+typedef enum pubsub_send_queue_policy {
+    PUBSUB_SEND_QUEUE_BLOCK         = 0, //the publisher blocks until there is room in the queue
+    PUBSUB_SEND_QUEUE_DROP_OLDEST   = 1, //the oldest queued message is dropped
+    PUBSUB_SEND_QUEUE_DROP_NEWEST   = 2  //the pushed message is dropped
+} pubsub_send_queue_policy_e;
+
+typedef struct pubsub_send_queue_stats {
+    size_t capacity;
+    size_t size;
+    size_t maxSize;
+    unsigned long nrOfDroppedMessages;
+    unsigned long nrOfBatches;
+} pubsub_send_queue_stats_t;
+
+typedef struct pubsub_send_queue pubsub_send_queue_t; //opaque type
+
+/**
+ * Creates a bounded multi-producer queue used by pubsub admins to hand over messages from publishers to a sender thread.
+ * Pushing and popping messages is lock-free; a mutex and condition are only used to wait for an empty or full queue.
+ *
+ * @param capacity      The minimal capacity of the queue. The capacity is rounded up to a power of 2.
+ * @param policy        The backpressure policy used when a message is pushed on a full queue.
+ * @param handle        The handle for the dropMessage callback.
+ * @param dropMessage   Called when a queued message is dropped (drop-oldest policy) or still queued on destroy.
+ *                      Can be NULL.
+ * @return A newly created send queue or NULL if the capacity is 0.
+ */
+pubsub_send_queue_t* pubsub_sendQueue_create(size_t capacity, pubsub_send_queue_policy_e policy, void* handle, void (*dropMessage)(void* handle, void* msg));
+
+/**
+ * Destroys the send queue. Messages still queued are passed to the dropMessage callback.
+ */
+void pubsub_sendQueue_destroy(pubsub_send_queue_t* queue);
+
+/**
+ * Push a message on the queue.
+ * For the block policy this call waits until there is room in the queue or the queue is closed.
+ *
+ * @return True if the message is queued and ownership of the message is moved to the queue. False if the message
+ * is dropped (drop-newest policy) or the queue is closed, ownership stays with the caller.
+ */
+bool pubsub_sendQueue_push(pubsub_send_queue_t* queue, void* msg);
+
+/**
+ * Pops up to maxMessages from the queue, waiting until at least one message is queued or the queue is closed.
+ * Should be called from a single sender thread.
+ *
+ * @param msgs          The output array for the popped messages.
+ * @param maxMessages   The max number of messages to pop.
+ * @return The number of popped messages. 0 if the queue is closed and empty.
+ */
+size_t pubsub_sendQueue_popBatch(pubsub_send_queue_t* queue, void** msgs, size_t maxMessages);
+
+/**
+ * Closes the queue. Pushes will fail and blocked publishers and the sender thread are woken up.
+ * Messages which are already queued can still be popped.
+ */
+void pubsub_sendQueue_close(pubsub_send_queue_t* queue);
+
+/**
+ * Returns the current statistics of the queue.
+ */
+void pubsub_sendQueue_getStats(pubsub_send_queue_t* queue, pubsub_send_queue_stats_t* stats);
+
+/**
+ * Parses the backpressure policy (block, drop-oldest or drop-newest). Returns defaultPolicy for NULL or unknown values.
+ */
+pubsub_send_queue_policy_e pubsub_sendQueue_parsePolicy(const char* policy, pubsub_send_queue_policy_e defaultPolicy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CELIX_PUBSUB_SEND_QUEUE_H
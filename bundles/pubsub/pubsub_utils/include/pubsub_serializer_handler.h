@@ -125,6 +125,18 @@ char* pubsub_serializerHandler_getMsgFqn(pubsub_serializer_handler_t* handler, u
  */
 uint32_t pubsub_serializerHandler_getMsgId(pubsub_serializer_handler_t* handler, const char* msgFqn);
 
+/**
+ * Get the major version of the msg serialization service for the provided msg id.
+ * @return major version or -1 if msg id is not known.
+ */
+int pubsub_serializerHandler_getMsgMajorVersion(pubsub_serializer_handler_t* handler, uint32_t msgId);
+
+/**
+ * Get the minor version of the msg serialization service for the provided msg id.
+ * @return minor version or -1 if msg id is not known.
+ */
+int pubsub_serializerHandler_getMsgMinorVersion(pubsub_serializer_handler_t* handler, uint32_t msgId);
+
 /**
  * nr of serialization services found.
  */
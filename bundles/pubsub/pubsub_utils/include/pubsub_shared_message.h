@@ -0,0 +1,113 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#ifndef CELIX_PUBSUB_SHARED_MESSAGE_H
+#define CELIX_PUBSUB_SHARED_MESSAGE_H
+
+#include <stdbool.h>
+#include <sys/uio.h>
+
+#include "celix_errno.h"
+#include "celix_properties.h"
+#include "hash_map.h"
+#include "pubsub_interceptors_handler.h"
+#include "pubsub/subscriber.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Creates a shared message for a deserialized message, with a reference count of 1 (owned by the caller).
+ *
+ * @param msg       The deserialized message.
+ * @param handle    The handle for the freeMsg function.
+ * @param freeMsg   The function used to free the deserialized message when the last reference is released.
+ */
+pubsub_shared_message_t* pubsub_sharedMessage_create(void* msg, void* handle, void (*freeMsg)(void* handle, void* msg));
+
+/**
+ * Releases a reference of the shared message. If this is the last reference the deserialized message is freed.
+ */
+void pubsub_sharedMessage_release(pubsub_shared_message_t* sharedMsg);
+
+/**
+ * Tries to take the deserialized message back from the shared message.
+ * This only succeeds if the caller owns the last reference (no subscriber retained the message), in that case the
+ * shared message is destroyed without freeing the deserialized message.
+ * If not successful, the reference of the caller is released.
+ *
+ * @param msg   Output for the deserialized message.
+ * @return True if the deserialized message is owned by the caller.
+ */
+bool pubsub_sharedMessage_reclaim(pubsub_shared_message_t* sharedMsg, void** msg);
+
+/**
+ * Returns whether a subscriber service wants shared messages (see PUBSUB_SUBSCRIBER_SHARED_MESSAGES).
+ */
+bool pubsub_sharedMessage_isSharedSubscriber(const pubsub_subscriber_t* svc, const celix_properties_t* svcProperties);
+
+/**
+ * The message and serializer info needed to deliver a deserialized message to the subscribers of a topic.
+ */
+typedef struct pubsub_shared_message_delivery {
+    const char* msgFqn;
+    unsigned int msgId;
+    celix_properties_t* metadata;
+
+    /**
+     * The serializer used to deserialize the input again, if a deserialized message is retained by a shared subscriber
+     * or taken over by a receive function and more subscribers are to come.
+     */
+    void* serializerHandle;
+    celix_status_t (*deserialize)(void* handle, const struct iovec* input, size_t inputIovLen, void** out);
+    void (*freeDeserializedMsg)(void* handle, void* msg);
+    const struct iovec* input;
+    size_t inputIovLen;
+
+    /**
+     * Optional, if set the post receive interceptors are invoked after every receive/receiveShared call.
+     */
+    pubsub_interceptors_handler_t* interceptorsHandler;
+} pubsub_shared_message_delivery_t;
+
+/**
+ * Delivers a deserialized message to the subscribers of a topic.
+ *
+ * All shared subscribers receive the same deserialized message as shared message (receiveShared). The other
+ * subscribers receive the deserialized message itself (receive); the input is deserialized again if the message is
+ * retained by a shared subscriber or if a receive function took over the ownership.
+ *
+ * @param delivery                  The message and serializer info.
+ * @param subscriberServices        All subscriber services, key = svc id, value = pubsub_subscriber_t*.
+ * @param sharedSubscriberServices  The subset of the subscriber services using shared messages.
+ * @param msg                       The deserialized message, the ownership is moved to this function.
+ * @return CELIX_SUCCESS or the status of the failed deserialization. In case of a failure the remaining subscribers
+ * do not receive the message.
+ */
+celix_status_t pubsub_sharedMessage_deliver(const pubsub_shared_message_delivery_t* delivery,
+                                            hash_map_t* subscriberServices,
+                                            hash_map_t* sharedSubscriberServices,
+                                            void* msg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CELIX_PUBSUB_SHARED_MESSAGE_H
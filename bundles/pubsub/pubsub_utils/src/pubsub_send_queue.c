@@ -0,0 +1,248 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "pubsub_send_queue.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#include "celix_threads.h"
+
+/**
+ * Bounded MPMC ring (see D. Vyukov's bounded MPMC queue). Every cell has a sequence number which tells producers
+ * and consumers whether the cell is free for the current enqueue/dequeue round.
+ * Consumers are also producers for the drop-oldest policy, that is why a multi-consumer ring is used.
+ */
+typedef struct pubsub_send_queue_cell {
+    size_t seq;
+    void* msg;
+} pubsub_send_queue_cell_t;
+
+struct pubsub_send_queue {
+    pubsub_send_queue_policy_e policy;
+    void* handle;
+    void (*dropMessage)(void* handle, void* msg);
+
+    size_t mask;
+    pubsub_send_queue_cell_t* cells;
+    size_t enqueuePos; //atomic
+    size_t dequeuePos; //atomic
+
+    size_t maxSize; //atomic
+    unsigned long nrOfDroppedMessages; //atomic
+    unsigned long nrOfBatches; //atomic
+
+    bool closed; //atomic
+    unsigned int nrOfWaitingProducers; //atomic
+    unsigned int nrOfWaitingConsumers; //atomic
+    celix_thread_mutex_t mutex; //only used to wait on a full or empty queue
+    celix_thread_cond_t notFull;
+    celix_thread_cond_t notEmpty;
+};
+
+static bool pubsub_sendQueue_tryPush(pubsub_send_queue_t* queue, void* msg) {
+    size_t pos = __atomic_load_n(&queue->enqueuePos, __ATOMIC_RELAXED);
+    for (;;) {
+        pubsub_send_queue_cell_t* cell = &queue->cells[pos & queue->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueuePos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                cell->msg = msg;
+                __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; //full
+        } else {
+            pos = __atomic_load_n(&queue->enqueuePos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static bool pubsub_sendQueue_tryPop(pubsub_send_queue_t* queue, void** msg) {
+    size_t pos = __atomic_load_n(&queue->dequeuePos, __ATOMIC_RELAXED);
+    for (;;) {
+        pubsub_send_queue_cell_t* cell = &queue->cells[pos & queue->mask];
+        size_t seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->dequeuePos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *msg = cell->msg;
+                __atomic_store_n(&cell->seq, pos + queue->mask + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; //empty
+        } else {
+            pos = __atomic_load_n(&queue->dequeuePos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static size_t pubsub_sendQueue_size(pubsub_send_queue_t* queue) {
+    size_t dequeuePos = __atomic_load_n(&queue->dequeuePos, __ATOMIC_ACQUIRE);
+    size_t enqueuePos = __atomic_load_n(&queue->enqueuePos, __ATOMIC_ACQUIRE);
+    return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+}
+
+static void pubsub_sendQueue_notify(pubsub_send_queue_t* queue, unsigned int* nrOfWaiting, celix_thread_cond_t* cond) {
+    //note the seq cst fence pairs with the increment of the waiting counter, done before a waiter re-checks the queue
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(nrOfWaiting, __ATOMIC_RELAXED) > 0) {
+        celixThreadMutex_lock(&queue->mutex);
+        celixThreadCondition_broadcast(cond);
+        celixThreadMutex_unlock(&queue->mutex);
+    }
+}
+
+static void pubsub_sendQueue_updateMaxSize(pubsub_send_queue_t* queue) {
+    size_t size = pubsub_sendQueue_size(queue);
+    size_t max = __atomic_load_n(&queue->maxSize, __ATOMIC_RELAXED);
+    while (size > max && !__atomic_compare_exchange_n(&queue->maxSize, &max, size, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        //retry with updated max
+    }
+}
+
+pubsub_send_queue_t* pubsub_sendQueue_create(size_t capacity, pubsub_send_queue_policy_e policy, void* handle, void (*dropMessage)(void* handle, void* msg)) {
+    if (capacity == 0) {
+        return NULL;
+    }
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    pubsub_send_queue_t* queue = calloc(1, sizeof(*queue));
+    queue->policy = policy;
+    queue->handle = handle;
+    queue->dropMessage = dropMessage;
+    queue->mask = size - 1;
+    queue->cells = calloc(size, sizeof(*queue->cells));
+    for (size_t i = 0; i < size; ++i) {
+        queue->cells[i].seq = i;
+    }
+    celixThreadMutex_create(&queue->mutex, NULL);
+    celixThreadCondition_init(&queue->notFull, NULL);
+    celixThreadCondition_init(&queue->notEmpty, NULL);
+    return queue;
+}
+
+void pubsub_sendQueue_destroy(pubsub_send_queue_t* queue) {
+    if (queue != NULL) {
+        void* msg = NULL;
+        while (pubsub_sendQueue_tryPop(queue, &msg)) {
+            if (queue->dropMessage != NULL) {
+                queue->dropMessage(queue->handle, msg);
+            }
+        }
+        celixThreadCondition_destroy(&queue->notEmpty);
+        celixThreadCondition_destroy(&queue->notFull);
+        celixThreadMutex_destroy(&queue->mutex);
+        free(queue->cells);
+        free(queue);
+    }
+}
+
+bool pubsub_sendQueue_push(pubsub_send_queue_t* queue, void* msg) {
+    while (!__atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE)) {
+        if (pubsub_sendQueue_tryPush(queue, msg)) {
+            pubsub_sendQueue_updateMaxSize(queue);
+            pubsub_sendQueue_notify(queue, &queue->nrOfWaitingConsumers, &queue->notEmpty);
+            return true;
+        }
+        if (queue->policy == PUBSUB_SEND_QUEUE_DROP_NEWEST) {
+            __atomic_fetch_add(&queue->nrOfDroppedMessages, 1, __ATOMIC_RELAXED);
+            return false;
+        } else if (queue->policy == PUBSUB_SEND_QUEUE_DROP_OLDEST) {
+            void* oldest = NULL;
+            if (pubsub_sendQueue_tryPop(queue, &oldest)) {
+                __atomic_fetch_add(&queue->nrOfDroppedMessages, 1, __ATOMIC_RELAXED);
+                if (queue->dropMessage != NULL) {
+                    queue->dropMessage(queue->handle, oldest);
+                }
+            }
+        } else {
+            celixThreadMutex_lock(&queue->mutex);
+            __atomic_fetch_add(&queue->nrOfWaitingProducers, 1, __ATOMIC_SEQ_CST);
+            while (!__atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE) && pubsub_sendQueue_size(queue) > queue->mask) {
+                celixThreadCondition_wait(&queue->notFull, &queue->mutex);
+            }
+            __atomic_fetch_sub(&queue->nrOfWaitingProducers, 1, __ATOMIC_SEQ_CST);
+            celixThreadMutex_unlock(&queue->mutex);
+        }
+    }
+    return false;
+}
+
+static size_t pubsub_sendQueue_tryPopBatch(pubsub_send_queue_t* queue, void** msgs, size_t maxMessages) {
+    size_t count = 0;
+    while (count < maxMessages && pubsub_sendQueue_tryPop(queue, &msgs[count])) {
+        count += 1;
+    }
+    return count;
+}
+
+size_t pubsub_sendQueue_popBatch(pubsub_send_queue_t* queue, void** msgs, size_t maxMessages) {
+    size_t count = pubsub_sendQueue_tryPopBatch(queue, msgs, maxMessages);
+    if (count == 0 && maxMessages > 0) {
+        celixThreadMutex_lock(&queue->mutex);
+        __atomic_fetch_add(&queue->nrOfWaitingConsumers, 1, __ATOMIC_SEQ_CST);
+        while ((count = pubsub_sendQueue_tryPopBatch(queue, msgs, maxMessages)) == 0 && !__atomic_load_n(&queue->closed, __ATOMIC_ACQUIRE)) {
+            celixThreadCondition_wait(&queue->notEmpty, &queue->mutex);
+        }
+        __atomic_fetch_sub(&queue->nrOfWaitingConsumers, 1, __ATOMIC_SEQ_CST);
+        celixThreadMutex_unlock(&queue->mutex);
+    }
+    if (count > 0) {
+        __atomic_fetch_add(&queue->nrOfBatches, 1, __ATOMIC_RELAXED);
+        pubsub_sendQueue_notify(queue, &queue->nrOfWaitingProducers, &queue->notFull);
+    }
+    return count;
+}
+
+void pubsub_sendQueue_close(pubsub_send_queue_t* queue) {
+    celixThreadMutex_lock(&queue->mutex);
+    __atomic_store_n(&queue->closed, true, __ATOMIC_RELEASE);
+    celixThreadCondition_broadcast(&queue->notFull);
+    celixThreadCondition_broadcast(&queue->notEmpty);
+    celixThreadMutex_unlock(&queue->mutex);
+}
+
+void pubsub_sendQueue_getStats(pubsub_send_queue_t* queue, pubsub_send_queue_stats_t* stats) {
+    stats->capacity = queue->mask + 1;
+    stats->size = pubsub_sendQueue_size(queue);
+    stats->maxSize = __atomic_load_n(&queue->maxSize, __ATOMIC_RELAXED);
+    stats->nrOfDroppedMessages = __atomic_load_n(&queue->nrOfDroppedMessages, __ATOMIC_RELAXED);
+    stats->nrOfBatches = __atomic_load_n(&queue->nrOfBatches, __ATOMIC_RELAXED);
+}
+
+pubsub_send_queue_policy_e pubsub_sendQueue_parsePolicy(const char* policy, pubsub_send_queue_policy_e defaultPolicy) {
+    pubsub_send_queue_policy_e result = defaultPolicy;
+    if (policy != NULL) {
+        if (strcasecmp(policy, PUBSUB_SEND_QUEUE_POLICY_BLOCK) == 0) {
+            result = PUBSUB_SEND_QUEUE_BLOCK;
+        } else if (strcasecmp(policy, PUBSUB_SEND_QUEUE_POLICY_DROP_OLDEST) == 0) {
+            result = PUBSUB_SEND_QUEUE_DROP_OLDEST;
+        } else if (strcasecmp(policy, PUBSUB_SEND_QUEUE_POLICY_DROP_NEWEST) == 0) {
+            result = PUBSUB_SEND_QUEUE_DROP_NEWEST;
+        }
+    }
+    return result;
+}
@@ -23,6 +23,7 @@
 #include <stdarg.h>
 #include <dirent.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "celix_constants.h"
 #include "dyn_function.h"
@@ -30,6 +31,7 @@
 #include "celix_utils.h"
 #include "dyn_message.h"
 #include "dyn_interface.h"
+#include "dyn_cache.h"
 #include "pubsub_utils.h"
 #include "celix_log_helper.h"
 #include "pubsub_message_serialization_service.h"
@@ -186,9 +188,10 @@ static unsigned int pubsub_serializationProvider_getMsgId(pubsub_serialization_p
     return msgId;
 }
 
-static dyn_message_type* pubsub_serializationProvider_parseDfiDescriptor(pubsub_serialization_provider_t* provider, FILE* stream, const char* entryPath) {
+static dyn_message_type* pubsub_serializationProvider_parseDfiDescriptor(pubsub_serialization_provider_t* provider, const char* descriptor, size_t descriptorLength, const char* entryPath) {
     dyn_message_type *msg = NULL;
-    int rc = dynMessage_parse(stream, &msg);
+    //note identical descriptors (e.g. the same message in multiple bundles) are parsed only once
+    int rc = dynCache_getMessage(descriptor, descriptorLength, &msg);
     if (rc != 0 || msg == NULL) {
         L_WARN("Cannot parse message from descriptor from entry %s.\n", entryPath);
         return NULL;
@@ -202,25 +205,46 @@ static dyn_message_type* pubsub_serializationProvider_parseDfiDescriptor(pubsub_
 
     if (rc != 0 || msgName == NULL || msgVersion == NULL) {
         L_WARN("Cannot retrieve name and/or version from msg, using entry %s.\n", entryPath);
-        dynMessage_destroy(msg);
+        dynCache_releaseMessage(msg);
         return NULL;
     }
 
     return msg;
 }
 
-static bool pubsub_serializationProvider_isDescriptorInterface(pubsub_serialization_provider_t* provider, FILE* stream) {
-    dyn_interface_type *msg = NULL;
-    bool isInterface = false;
-
-    int rc = dynInterface_parse(stream, &msg);
-    if (rc == 0 && msg != NULL) {
-        isInterface = true;
+static bool pubsub_serializationProvider_isDescriptorInterface(const char* descriptor) {
+    //note only the header section is inspected, instead of parsing the complete descriptor as interface
+    static const char header[] = ":header";
+    static const char interfaceType[] = "type=interface";
+    const char* line = descriptor;
+    while (isspace((unsigned char)*line)) {
+        line += 1;
     }
-    dynInterface_destroy(msg);
-    fseek(stream, 0, SEEK_SET);
-
-    return isInterface;
+    if (strncmp(line, header, sizeof(header) - 1) != 0) {
+        return false;
+    }
+    line += sizeof(header) - 1;
+    if (*line == '\r') {
+        line += 1;
+    }
+    if (*line != '\n') {
+        return false;
+    }
+    line += 1;
+    while (*line != '\0' && *line != ':') {
+        if (strncmp(line, interfaceType, sizeof(interfaceType) - 1) == 0) {
+            char end = line[sizeof(interfaceType) - 1];
+            if (end == '\n' || end == '\r' || end == '\0') {
+                return true;
+            }
+        }
+        line = strchr(line, '\n');
+        if (line == NULL) {
+            break;
+        }
+        line += 1;
+    }
+    return false;
 }
 
 //TODO FIXME, see #158
@@ -383,10 +407,20 @@ static void pubsub_serializationProvider_parseDescriptors(pubsub_serialization_p
         char *entryPath = NULL;
         asprintf(&entryPath, "%s/%s", root, entry_name);
 
+        char *membuf = NULL;
+        size_t membufLength = 0;
+        if (dynCache_readDescriptor(stream, &membuf, &membufLength) != 0) {
+            L_WARN("Cannot read descriptor from entry %s.", entryPath);
+            free(entryPath);
+            fclose(stream);
+            continue;
+        }
+        fclose(stream);
+
         dyn_message_type *msgType = NULL;
         if (descriptorType == FIT_DESCRIPTOR) {
-            if(!pubsub_serializationProvider_isDescriptorInterface(provider, stream)) {
-                msgType = pubsub_serializationProvider_parseDfiDescriptor(provider, stream, entry_name);
+            if(!pubsub_serializationProvider_isDescriptorInterface(membuf)) {
+                msgType = pubsub_serializationProvider_parseDfiDescriptor(provider, membuf, membufLength, entry_name);
             } else {
                 L_DEBUG("Ignoring interface file");
             }
@@ -399,18 +433,10 @@ static void pubsub_serializationProvider_parseDescriptors(pubsub_serialization_p
 
         if (msgType == NULL) {
             free(entryPath);
-            fclose(stream);
+            free(membuf);
             continue;
         }
 
-        fseek(stream, 0L, SEEK_END);
-        long streamSize = ftell(stream);
-        char *membuf = malloc(streamSize + 1);
-        rewind(stream);
-        fread(membuf, streamSize, 1, stream);
-        fclose(stream);
-        membuf[streamSize] = '\0';
-
 
         celix_version_t *msgVersion = NULL;
         char *msgFqn = NULL;
@@ -443,7 +469,7 @@ static void pubsub_serializationProvider_parseDescriptors(pubsub_serialization_p
             free(serEntry->descriptorContent);
             free(serEntry->readFromEntryPath);
             free(serEntry->msgVersionStr);
-            dynMessage_destroy(serEntry->msgType);
+            dynCache_releaseMessage(serEntry->msgType);
             free(serEntry);
             continue;
         }
@@ -461,7 +487,7 @@ static void pubsub_serializationProvider_parseDescriptors(pubsub_serialization_p
             free(serEntry->descriptorContent);
             free(serEntry->readFromEntryPath);
             free(serEntry->msgVersionStr);
-            dynMessage_destroy(serEntry->msgType);
+            dynCache_releaseMessage(serEntry->msgType);
             free(serEntry);
         }
         celixThreadMutex_unlock(&provider->mutex);
@@ -660,7 +686,7 @@ void pubsub_serializationProvider_destroy(pubsub_serialization_provider_t* provi
             free(entry->descriptorContent);
             free(entry->readFromEntryPath);
             free(entry->msgVersionStr);
-            dynMessage_destroy(entry->msgType);
+            dynCache_releaseMessage(entry->msgType);
             free(entry);
         }
         celix_arrayList_destroy(provider->serializationSvcEntries);
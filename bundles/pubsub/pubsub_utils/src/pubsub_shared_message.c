@@ -0,0 +1,134 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "pubsub_shared_message.h"
+
+#include <stdlib.h>
+
+typedef struct pubsub_shared_message_entry {
+    pubsub_shared_message_t sharedMsg; //note must be the first member
+    void* msg;
+    void* handle;
+    void (*freeMsg)(void* handle, void* msg);
+    unsigned int refCount; //atomic
+} pubsub_shared_message_entry_t;
+
+static void pubsub_sharedMessage_retain(pubsub_shared_message_t* sharedMsg) {
+    pubsub_shared_message_entry_t* entry = (pubsub_shared_message_entry_t*)sharedMsg;
+    __atomic_fetch_add(&entry->refCount, 1, __ATOMIC_RELAXED);
+}
+
+pubsub_shared_message_t* pubsub_sharedMessage_create(void* msg, void* handle, void (*freeMsg)(void* handle, void* msg)) {
+    pubsub_shared_message_entry_t* entry = calloc(1, sizeof(*entry));
+    entry->sharedMsg.msg = msg;
+    entry->sharedMsg.retain = pubsub_sharedMessage_retain;
+    entry->sharedMsg.release = pubsub_sharedMessage_release;
+    entry->msg = msg;
+    entry->handle = handle;
+    entry->freeMsg = freeMsg;
+    entry->refCount = 1;
+    return &entry->sharedMsg;
+}
+
+void pubsub_sharedMessage_release(pubsub_shared_message_t* sharedMsg) {
+    pubsub_shared_message_entry_t* entry = (pubsub_shared_message_entry_t*)sharedMsg;
+    if (entry != NULL && __atomic_sub_fetch(&entry->refCount, 1, __ATOMIC_ACQ_REL) == 0) {
+        if (entry->freeMsg != NULL) {
+            entry->freeMsg(entry->handle, entry->msg);
+        }
+        free(entry);
+    }
+}
+
+bool pubsub_sharedMessage_reclaim(pubsub_shared_message_t* sharedMsg, void** msg) {
+    pubsub_shared_message_entry_t* entry = (pubsub_shared_message_entry_t*)sharedMsg;
+    //note if the caller owns the last reference, nobody else can retain the shared message anymore
+    if (__atomic_load_n(&entry->refCount, __ATOMIC_ACQUIRE) == 1) {
+        *msg = entry->msg;
+        free(entry);
+        return true;
+    }
+    pubsub_sharedMessage_release(sharedMsg);
+    return false;
+}
+
+bool pubsub_sharedMessage_isSharedSubscriber(const pubsub_subscriber_t* svc, const celix_properties_t* svcProperties) {
+    //note receiveShared is only part of the service struct if the shared messages property is set
+    return celix_properties_getAsBool(svcProperties, PUBSUB_SUBSCRIBER_SHARED_MESSAGES, false) && svc->receiveShared != NULL;
+}
+
+celix_status_t pubsub_sharedMessage_deliver(const pubsub_shared_message_delivery_t* delivery,
+                                            hash_map_t* subscriberServices,
+                                            hash_map_t* sharedSubscriberServices,
+                                            void* msg) {
+    celix_status_t status = CELIX_SUCCESS;
+    int nrOfShared = hashMap_size(sharedSubscriberServices);
+    int nrOfOthers = hashMap_size(subscriberServices) - nrOfShared;
+    bool release = true;
+    if (nrOfShared > 0) {
+        //deliver the same deserialized message to all shared subscribers
+        pubsub_shared_message_t* sharedMsg = pubsub_sharedMessage_create(msg, delivery->serializerHandle, delivery->freeDeserializedMsg);
+        hash_map_iterator_t iter = hashMapIterator_construct(sharedSubscriberServices);
+        while (hashMapIterator_hasNext(&iter)) {
+            pubsub_subscriber_t* svc = hashMapIterator_nextValue(&iter);
+            svc->receiveShared(svc->handle, delivery->msgFqn, delivery->msgId, sharedMsg, delivery->metadata);
+            if (delivery->interceptorsHandler != NULL) {
+                pubsubInterceptorHandler_invokePostReceive(delivery->interceptorsHandler, delivery->msgFqn, delivery->msgId, sharedMsg->msg, delivery->metadata);
+            }
+        }
+        if (nrOfOthers == 0) {
+            pubsub_sharedMessage_release(sharedMsg);
+            release = false;
+        } else if (!pubsub_sharedMessage_reclaim(sharedMsg, &msg)) {
+            //retained by a shared subscriber, deserialize again for the other subscribers
+            status = delivery->deserialize(delivery->serializerHandle, delivery->input, delivery->inputIovLen, &msg);
+            if (status != CELIX_SUCCESS) {
+                nrOfOthers = 0;
+                release = false;
+            }
+        }
+    }
+
+    hash_map_iterator_t iter = hashMapIterator_construct(subscriberServices);
+    while (nrOfOthers > 0 && hashMapIterator_hasNext(&iter)) {
+        hash_map_entry_t* entry = hashMapIterator_nextEntry(&iter);
+        if (hashMap_containsKey(sharedSubscriberServices, hashMapEntry_getKey(entry))) {
+            continue;
+        }
+        pubsub_subscriber_t* svc = hashMapEntry_getValue(entry);
+        nrOfOthers -= 1;
+        svc->receive(svc->handle, delivery->msgFqn, delivery->msgId, msg, delivery->metadata, &release);
+        if (delivery->interceptorsHandler != NULL) {
+            pubsubInterceptorHandler_invokePostReceive(delivery->interceptorsHandler, delivery->msgFqn, delivery->msgId, msg, delivery->metadata);
+        }
+        if (!release && nrOfOthers > 0) {
+            //receive function has taken ownership and still more receive function to come ..
+            //deserialize again for new message
+            status = delivery->deserialize(delivery->serializerHandle, delivery->input, delivery->inputIovLen, &msg);
+            if (status != CELIX_SUCCESS) {
+                break;
+            }
+            release = true;
+        }
+    }
+    if (release) {
+        delivery->freeDeserializedMsg(delivery->serializerHandle, msg);
+    }
+    return status;
+}
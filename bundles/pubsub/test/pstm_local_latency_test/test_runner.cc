@@ -0,0 +1,217 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "celix_api.h"
+#include "pubsub/api.h"
+#include "pubsub_admin.h"
+#include "pubsub_admin_metrics.h"
+#include "msg.h"
+
+/**
+ * Measures the publish -> receive latency of a topic which is only visible in the local framework.
+ * The same test runs in a container with the topology manager local delivery enabled (in-process channel) and
+ * in containers with local delivery disabled (tcp or shm admin), so that the results can be compared.
+ */
+
+constexpr const char *latencyResourcesBundleFile = LATENCY_RESOURCES_BUNDLE_FILE;
+constexpr const char *latencyTransport = LATENCY_TEST_TRANSPORT;
+constexpr bool localDeliveryEnabled = LATENCY_TEST_LOCAL_DELIVERY;
+constexpr int nrOfWarmupRounds = 1000;
+constexpr int nrOfRounds = 2000;
+
+class LatencyTestSuite : public ::testing::Test {
+public:
+    LatencyTestSuite() {
+        celixLauncher_launch("config.properties", &fw);
+        ctx = celix_framework_getFrameworkContext(fw);
+
+        //note topic properties of the framework bundle are not used, so publish and subscribe using a resource bundle
+        resourcesBundleId = celix_bundleContext_installBundle(ctx, latencyResourcesBundleFile, true);
+        celix_framework_useBundle(fw, true, resourcesBundleId, &resourcesCtx, [](void *handle, const celix_bundle_t *bnd) {
+            bundle_getContext(bnd, static_cast<celix_bundle_context_t**>(handle));
+        });
+    }
+
+    ~LatencyTestSuite() override {
+        celix_bundleContext_uninstallBundle(ctx, resourcesBundleId);
+        celixLauncher_stop(fw);
+        celixLauncher_waitForShutdown(fw);
+        celixLauncher_destroy(fw);
+    }
+
+    LatencyTestSuite(const LatencyTestSuite&) = delete;
+    LatencyTestSuite& operator=(const LatencyTestSuite&) = delete;
+
+    struct receive_state {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        uint32_t lastSeqNr{0};
+        long count{0};
+        std::chrono::steady_clock::time_point lastReceived{};
+    };
+
+    static int receive(void *handle, const char * /*msgType*/, unsigned int /*msgTypeId*/, void *voidMsg, const celix_properties_t * /*metadata*/, bool * /*release*/) {
+        auto now = std::chrono::steady_clock::now();
+        auto *state = static_cast<receive_state*>(handle);
+        auto *msg = static_cast<msg_t*>(voidMsg);
+        {
+            std::lock_guard<std::mutex> lck{state->mutex};
+            state->lastSeqNr = msg->seqNr;
+            state->count += 1;
+            state->lastReceived = now;
+        }
+        state->cond.notify_all();
+        return CELIX_SUCCESS;
+    }
+
+    struct publish_data {
+        receive_state *state;
+        celix_bundle_context_t *ctx;
+        const char *topic;
+        bool connected;
+        std::vector<double> latenciesInUs;
+    };
+
+    static bool sendAndWait(publish_data *data, pubsub_publisher_t *pub, unsigned int msgId, uint32_t seqNr, std::chrono::milliseconds timeout, std::chrono::steady_clock::time_point *sendTime) {
+        msg_t msg{seqNr};
+        *sendTime = std::chrono::steady_clock::now();
+        pub->send(pub->handle, msgId, &msg, nullptr);
+        std::unique_lock<std::mutex> lck{data->state->mutex};
+        return data->state->cond.wait_for(lck, timeout, [&]{ return data->state->lastSeqNr == seqNr; });
+    }
+
+    static void checkLocalMetrics(void *handle, void *svc) {
+        auto *topic = static_cast<const char*>(handle);
+        auto *metricsSvc = static_cast<pubsub_admin_metrics_service_t*>(svc);
+        pubsub_admin_metrics_t *metrics = metricsSvc->metrics(metricsSvc->handle);
+        ASSERT_NE(nullptr, metrics);
+        EXPECT_STREQ("local", metrics->psaType);
+
+        unsigned long nrOfMessagesSend = 0;
+        for (int i = 0; i < celix_arrayList_size(metrics->senders); ++i) {
+            auto *sender = static_cast<pubsub_admin_sender_metrics_t*>(celix_arrayList_get(metrics->senders, i));
+            if (strncmp(topic, sender->topic, sizeof(sender->topic)) == 0) {
+                for (unsigned int k = 0; k < sender->nrOfmsgMetrics; ++k) {
+                    nrOfMessagesSend += sender->msgMetrics[k].nrOfMessagesSend;
+                }
+            }
+        }
+        if (localDeliveryEnabled) {
+            EXPECT_GE(nrOfMessagesSend, (unsigned long)nrOfRounds);
+        } else {
+            EXPECT_EQ(0, nrOfMessagesSend);
+        }
+        pubsub_freePubSubAdminMetrics(metrics);
+    }
+
+    static void publish(void *handle, void *svc) {
+        auto *data = static_cast<publish_data*>(handle);
+        auto *pub = static_cast<pubsub_publisher_t*>(svc);
+        unsigned int msgId = 0;
+        ASSERT_EQ(0, pub->localMsgTypeIdForMsgType(pub->handle, MSG_NAME, &msgId));
+
+        //note subscribing after the publisher is available, so that the subscriber connects to an existing sender.
+        pubsub_subscriber_t sub{};
+        sub.handle = data->state;
+        sub.receive = receive;
+        celix_properties_t *props = celix_properties_create();
+        celix_properties_set(props, PUBSUB_SUBSCRIBER_TOPIC, data->topic);
+        long subId = celix_bundleContext_registerService(data->ctx, &sub, PUBSUB_SUBSCRIBER_SERVICE_NAME, props);
+
+        //wait until the connection is set up and warm up the path
+        std::chrono::steady_clock::time_point sendTime{};
+        uint32_t seqNr = 1;
+        auto start = std::chrono::steady_clock::now();
+        while (!data->connected && std::chrono::steady_clock::now() - start < std::chrono::seconds{10}) {
+            data->connected = sendAndWait(data, pub, msgId, seqNr++, std::chrono::milliseconds{10}, &sendTime);
+        }
+        for (int i = 0; data->connected && i < nrOfWarmupRounds; ++i) {
+            data->connected = sendAndWait(data, pub, msgId, seqNr++, std::chrono::seconds{5}, &sendTime);
+        }
+
+        for (int i = 0; data->connected && i < nrOfRounds; ++i) {
+            if (!sendAndWait(data, pub, msgId, seqNr++, std::chrono::seconds{5}, &sendTime)) {
+                break;
+            }
+            std::lock_guard<std::mutex> lck{data->state->mutex};
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(data->state->lastReceived - sendTime);
+            data->latenciesInUs.push_back((double)latency.count() / 1000.0);
+        }
+
+        //note checking the metrics while the publisher is still requested, otherwise the local channel is removed
+        celix_service_use_options_t metricsOpts{};
+        metricsOpts.filter.serviceName = PUBSUB_ADMIN_METRICS_SERVICE_NAME;
+        metricsOpts.filter.filter = "(" PUBSUB_ADMIN_SERVICE_TYPE "=local)";
+        metricsOpts.callbackHandle = (void*)data->topic;
+        metricsOpts.use = checkLocalMetrics;
+        EXPECT_TRUE(celix_bundleContext_useServiceWithOptions(data->ctx, &metricsOpts));
+
+        celix_bundleContext_unregisterService(data->ctx, subId);
+    }
+
+    void measure(const char *topic) {
+        receive_state state{};
+        ASSERT_NE(nullptr, resourcesCtx);
+        publish_data data{&state, resourcesCtx, topic, false, {}};
+
+        char filter[128];
+        snprintf(filter, sizeof(filter), "(%s=%s)", PUBSUB_PUBLISHER_TOPIC, topic);
+        celix_service_use_options_t opts{};
+        opts.filter.serviceName = PUBSUB_PUBLISHER_SERVICE_NAME;
+        opts.filter.filter = filter;
+        opts.waitTimeoutInSeconds = 10;
+        opts.callbackHandle = &data;
+        opts.use = publish;
+        ASSERT_TRUE(celix_bundleContext_useServiceWithOptions(resourcesCtx, &opts));
+        ASSERT_TRUE(data.connected);
+        ASSERT_EQ(nrOfRounds, data.latenciesInUs.size());
+
+        std::vector<double> sorted = data.latenciesInUs;
+        std::sort(sorted.begin(), sorted.end());
+        double total = 0;
+        for (double l : sorted) {
+            total += l;
+        }
+        printf("Latency for topic '%s' using %s delivery over %i messages: avg %.1f us, p50 %.1f us, p99 %.1f us, max %.1f us\n",
+               topic, latencyTransport, nrOfRounds, total / (double)sorted.size(), sorted[sorted.size() / 2],
+               sorted[(sorted.size() * 99) / 100], sorted.back());
+    }
+
+    celix_framework_t *fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    long resourcesBundleId = -1L;
+    celix_bundle_context_t *resourcesCtx = nullptr;
+};
+
+TEST_F(LatencyTestSuite, LatencyWithClonedMessages) {
+    measure("latency");
+}
+
+TEST_F(LatencyTestSuite, LatencyWithReferencedMessages) {
+    measure("latency_reference");
+}
@@ -0,0 +1,263 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "celix_api.h"
+
+extern "C" {
+#include "civetweb.h"
+#include "discovery.h"
+#include "endpoint_descriptor_writer.h"
+#include "remote_constants.h"
+}
+
+class EndpointDiscoveryTestSuite : public ::testing::Test {
+public:
+    struct Response {
+        long code{0};
+        std::string etag{};
+        std::string contentLength{};
+        std::string body{};
+    };
+
+    EndpointDiscoveryTestSuite() {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_FRAMEWORK_FRAMEWORK_STORAGE, ".rsa_discovery_common_cache");
+        celix_properties_set(props, DISCOVERY_SERVER_PORT, "9950");
+        celix_properties_set(props, "DISCOVERY_CFG_POLL_INTERVAL", "10");
+        celix_properties_set(props, "DISCOVERY_CFG_LONG_POLL_TIMEOUT", "5");
+        auto* fwPtr = celix_frameworkFactory_createFramework(props);
+        auto* ctxPtr = celix_framework_getFrameworkContext(fwPtr);
+        fw = std::shared_ptr<celix_framework_t>{fwPtr, [](auto* f) {celix_frameworkFactory_destroyFramework(f);}};
+        ctx = std::shared_ptr<celix_bundle_context_t>{ctxPtr, [](auto*){/*nop*/}};
+
+        discovery.context = ctx.get();
+        discovery.loghelper = celix_logHelper_create(ctx.get(), "test_rsa_discovery_common");
+        celixThreadMutex_create(&discovery.listenerReferencesMutex, nullptr);
+        celixThreadMutex_create(&discovery.discoveredServicesMutex, nullptr);
+        discovery.discoveredServices = hashMap_create(utils_stringHash, nullptr, utils_stringEquals, nullptr);
+
+        EXPECT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_create(&discovery, ctx.get(), "/test", "9950", "127.0.0.1", &discovery.server));
+        char buf[1024];
+        EXPECT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_getUrl(discovery.server, buf));
+        url = buf;
+        EXPECT_EQ(CELIX_SUCCESS, endpointDiscoveryPoller_create(&discovery, ctx.get(), "", &discovery.poller));
+    }
+
+    ~EndpointDiscoveryTestSuite() override {
+        endpointDiscoveryPoller_destroy(discovery.poller);
+        endpointDiscoveryServer_destroy(discovery.server);
+        for (auto* endpoint : endpoints) {
+            endpointDescription_destroy(endpoint);
+        }
+        hashMap_destroy(discovery.discoveredServices, false, false);
+        celixThreadMutex_destroy(&discovery.discoveredServicesMutex);
+        celixThreadMutex_destroy(&discovery.listenerReferencesMutex);
+        celix_logHelper_destroy(discovery.loghelper);
+    }
+
+    EndpointDiscoveryTestSuite(const EndpointDiscoveryTestSuite&) = delete;
+    EndpointDiscoveryTestSuite& operator=(const EndpointDiscoveryTestSuite&) = delete;
+
+    endpoint_description_t* createEndpoint(const char* id) {
+        auto* props = celix_properties_create();
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_FRAMEWORK_UUID, "test-framework");
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_ID, id);
+        celix_properties_set(props, OSGI_RSA_ENDPOINT_SERVICE_ID, "42");
+        celix_properties_set(props, OSGI_FRAMEWORK_OBJECTCLASS, "test_service");
+        endpoint_description_t* endpoint = nullptr;
+        EXPECT_EQ(CELIX_SUCCESS, endpointDescription_create(props, &endpoint));
+        endpoints.push_back(endpoint);
+        return endpoint;
+    }
+
+    void addEndpoint(const char* id) {
+        EXPECT_EQ(CELIX_SUCCESS, endpointDiscoveryServer_addEndpoint(discovery.server, createEndpoint(id)));
+    }
+
+    int nrOfDiscoveredEndpoints() {
+        celixThreadMutex_lock(&discovery.discoveredServicesMutex);
+        int size = hashMap_size(discovery.discoveredServices);
+        celixThreadMutex_unlock(&discovery.discoveredServicesMutex);
+        return size;
+    }
+
+    bool waitForDiscoveredEndpoints(int count, std::chrono::milliseconds timeout) {
+        auto end = std::chrono::steady_clock::now() + timeout;
+        while (nrOfDiscoveredEndpoints() != count && std::chrono::steady_clock::now() < end) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        return nrOfDiscoveredEndpoints() == count;
+    }
+
+    static size_t writeBody(char* data, size_t size, size_t nmemb, void* userdata) {
+        static_cast<Response*>(userdata)->body.append(data, size * nmemb);
+        return size * nmemb;
+    }
+
+    static size_t writeHeader(char* data, size_t size, size_t nmemb, void* userdata) {
+        auto* response = static_cast<Response*>(userdata);
+        std::string header{data, size * nmemb};
+        while (!header.empty() && (header.back() == '\r' || header.back() == '\n')) {
+            header.pop_back();
+        }
+        if (header.compare(0, 6, "ETag: ") == 0) {
+            response->etag = header.substr(6);
+        } else if (header.compare(0, 16, "Content-Length: ") == 0) {
+            response->contentLength = header.substr(16);
+        }
+        return size * nmemb;
+    }
+
+    static Response get(const std::string& requestUrl, const std::string& ifNoneMatch = {}) {
+        Response response{};
+        CURL* curl = curl_easy_init();
+        struct curl_slist* headers = nullptr;
+        if (!ifNoneMatch.empty()) {
+            headers = curl_slist_append(headers, ("If-None-Match: " + ifNoneMatch).c_str());
+        }
+        curl_easy_setopt(curl, CURLOPT_URL, requestUrl.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, 20L);
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeBody);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, writeHeader);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response);
+        EXPECT_EQ(CURLE_OK, curl_easy_perform(curl));
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.code);
+        curl_slist_free_all(headers);
+        curl_easy_cleanup(curl);
+        return response;
+    }
+
+    std::shared_ptr<celix_framework_t> fw{};
+    std::shared_ptr<celix_bundle_context_t> ctx{};
+    discovery_t discovery{};
+    std::string url{};
+    std::vector<endpoint_description_t*> endpoints{};
+};
+
+TEST_F(EndpointDiscoveryTestSuite, NotModifiedOnMatchingEtag) {
+    addEndpoint("endpoint1");
+    auto response = get(url);
+    EXPECT_EQ(200, response.code);
+    EXPECT_FALSE(response.etag.empty());
+    EXPECT_EQ(std::to_string(response.body.size()), response.contentLength);
+    EXPECT_NE(std::string::npos, response.body.find("endpoint1"));
+
+    auto notModified = get(url, response.etag);
+    EXPECT_EQ(304, notModified.code);
+    EXPECT_EQ(response.etag, notModified.etag);
+    EXPECT_TRUE(notModified.body.empty());
+
+    addEndpoint("endpoint2");
+    auto modified = get(url, response.etag);
+    EXPECT_EQ(200, modified.code);
+    EXPECT_NE(response.etag, modified.etag);
+    EXPECT_NE(std::string::npos, modified.body.find("endpoint2"));
+}
+
+TEST_F(EndpointDiscoveryTestSuite, LongPollIsWokenByAddEndpoint) {
+    auto response = get(url);
+    EXPECT_EQ(200, response.code);
+
+    std::thread adder{[this]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+        addEndpoint("endpoint1");
+    }};
+    auto start = std::chrono::steady_clock::now();
+    auto changed = get(url + "?wait=10", response.etag);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    adder.join();
+    EXPECT_EQ(200, changed.code);
+    EXPECT_NE(std::string::npos, changed.body.find("endpoint1"));
+    EXPECT_GE(elapsed, std::chrono::milliseconds{150});
+    EXPECT_LT(elapsed, std::chrono::seconds{5});
+
+    //without a change the request is held for the wait time
+    start = std::chrono::steady_clock::now();
+    auto notModified = get(url + "?wait=1", changed.etag);
+    elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(304, notModified.code);
+    EXPECT_GE(elapsed, std::chrono::milliseconds{900});
+}
+
+TEST_F(EndpointDiscoveryTestSuite, PollerPicksUpChangesWithLongPolling) {
+    addEndpoint("endpoint1");
+    endpointDiscoveryPoller_addDiscoveryEndpoint(discovery.poller, (char*)url.c_str());
+    EXPECT_EQ(1, nrOfDiscoveredEndpoints());
+
+    //picked up by the held request, long before the poll interval of 10s
+    addEndpoint("endpoint2");
+    EXPECT_TRUE(waitForDiscoveredEndpoints(2, std::chrono::seconds{3}));
+}
+
+TEST_F(EndpointDiscoveryTestSuite, PollerFallsBackToPollIntervalWithoutEtag) {
+    struct NoEtagServer {
+        std::string document{};
+        std::atomic<int> nrOfRequests{0};
+    } noEtagServer{};
+
+    endpoint_descriptor_writer_t* writer = nullptr;
+    ASSERT_EQ(CELIX_SUCCESS, endpointDescriptorWriter_create(&writer));
+    array_list_pt list = nullptr;
+    arrayList_create(&list);
+    arrayList_add(list, createEndpoint("endpoint1"));
+    char* document = nullptr;
+    ASSERT_EQ(CELIX_SUCCESS, endpointDescriptorWriter_writeDocument(writer, list, &document));
+    noEtagServer.document = document;
+    arrayList_destroy(list);
+    endpointDescriptorWriter_destroy(writer);
+
+    struct mg_callbacks callbacks{};
+    callbacks.begin_request = [](struct mg_connection* conn) -> int {
+        auto* server = static_cast<NoEtagServer*>(mg_get_request_info(conn)->user_data);
+        server->nrOfRequests += 1;
+        mg_printf(conn, "HTTP/1.1 200 OK\r\nContent-Type: application/xml\r\nContent-Length: %lu\r\n\r\n",
+                  (unsigned long)server->document.size());
+        mg_write(conn, server->document.c_str(), server->document.size());
+        return 1;
+    };
+    const char* options[] = {"listening_ports", "9970", nullptr};
+    auto* mgCtx = mg_start(&callbacks, &noEtagServer, options);
+    ASSERT_NE(nullptr, mgCtx);
+
+    std::string noEtagUrl = "http://127.0.0.1:9970/endpoints";
+    endpointDiscoveryPoller_addDiscoveryEndpoint(discovery.poller, (char*)noEtagUrl.c_str());
+    EXPECT_EQ(1, nrOfDiscoveredEndpoints());
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+
+    //the initial request and the first poll of the poller thread, the next poll is after the poll interval of 10s
+    EXPECT_LE(noEtagServer.nrOfRequests, 2);
+    EXPECT_EQ(1, nrOfDiscoveredEndpoints());
+
+    endpointDiscoveryPoller_removeDiscoveryEndpoint(discovery.poller, (char*)noEtagUrl.c_str());
+    mg_stop(mgCtx);
+}
@@ -43,6 +43,7 @@ struct endpoint_discovery_poller {
 
     unsigned int poll_interval;
     unsigned int poll_timeout;
+    unsigned int long_poll_timeout; // 0 disables long-polling
 
     volatile bool running;
 };
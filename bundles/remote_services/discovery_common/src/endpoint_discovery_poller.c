@@ -28,6 +28,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <strings.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <curl/curl.h>
@@ -35,6 +37,7 @@
 #include "bundle_context.h"
 #include "celix_log_helper.h"
 #include "utils.h"
+#include "celix_utils.h"
 
 #include "endpoint_descriptor_reader.h"
 #include "discovery.h"
@@ -46,9 +49,38 @@
 #define DISCOVERY_POLL_TIMEOUT "DISCOVERY_CFG_POLL_TIMEOUT"
 #define DEFAULT_POLL_TIMEOUT "10" // seconds
 
+#define DISCOVERY_LONG_POLL_TIMEOUT "DISCOVERY_CFG_LONG_POLL_TIMEOUT"
+#define DEFAULT_LONG_POLL_TIMEOUT "30" // seconds
+
+// max time the poller thread blocks before checking for stop or added/removed discovery endpoints
+#define POLLER_WAKEUP_INTERVAL_MS 500
+
+struct MemoryStruct {
+	char *memory;
+	size_t size;
+};
+
+/**
+ * A (reused) request for the endpoints of a discovery endpoint url. Only used by the poller thread.
+ */
+typedef struct endpoint_discovery_transfer {
+	char *url;
+	CURL *curl;
+	struct curl_slist *headers;
+	struct MemoryStruct chunk;
+	char *etag; // of the last processed response, NULL if not known
+	char *receivedEtag; // of the response in progress
+	bool active;
+	struct timespec start;
+	struct timespec nextPoll;
+} endpoint_discovery_transfer_t;
+
 static void *endpointDiscoveryPoller_performPeriodicPoll(void *data);
 celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller, char *url, array_list_pt currentEndpoints);
 static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_poller_t *poller, char *url, array_list_pt *updatedEndpoints);
+static celix_status_t endpointDiscoveryPoller_parseEndpoints(endpoint_discovery_poller_t *poller, const char *document, array_list_pt *updatedEndpoints);
+static celix_status_t endpointDiscoveryPoller_updateEndpoints(endpoint_discovery_poller_t *poller, array_list_pt currentEndpoints, array_list_pt updatedEndpoints);
+static size_t endpointDiscoveryPoller_writeMemory(void *contents, size_t size, size_t nmemb, void *memoryPtr);
 static celix_status_t endpointDiscoveryPoller_endpointDescriptionEquals(const void *endpointPtr, const void *comparePtr, bool *equals);
 
 /**
@@ -81,6 +113,12 @@ celix_status_t endpointDiscoveryPoller_create(discovery_t *discovery, celix_bund
 		timeout = DEFAULT_POLL_TIMEOUT;
 	}
 
+	const char* longPollTimeout = NULL;
+	status = bundleContext_getProperty(context, DISCOVERY_LONG_POLL_TIMEOUT, &longPollTimeout);
+	if (!longPollTimeout) {
+		longPollTimeout = DEFAULT_LONG_POLL_TIMEOUT;
+	}
+
 	const char* endpointsProp = NULL;
 	status = bundleContext_getProperty(context, DISCOVERY_POLL_ENDPOINTS, &endpointsProp);
 	if (!endpointsProp) {
@@ -91,6 +129,7 @@ celix_status_t endpointDiscoveryPoller_create(discovery_t *discovery, celix_bund
 
 	(*poller)->poll_interval = atoi(interval);
 	(*poller)->poll_timeout = atoi(timeout);
+	(*poller)->long_poll_timeout = atoi(longPollTimeout);
 	(*poller)->discovery = discovery;
 	(*poller)->running = false;
 	(*poller)->entries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
@@ -256,80 +295,288 @@ celix_status_t endpointDiscoveryPoller_poll(endpoint_discovery_poller_t *poller,
 	arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &updatedEndpoints);
 	status = endpointDiscoveryPoller_getEndpoints(poller, url, &updatedEndpoints);
 
-	if (status == CELIX_SUCCESS) {
-		if (updatedEndpoints != NULL) {
-			for (unsigned int i = arrayList_size(currentEndpoints); i > 0; i--) {
-				endpoint_description_t *endpoint = arrayList_get(currentEndpoints, i - 1);
+	if (status == CELIX_SUCCESS && updatedEndpoints != NULL) {
+		status = endpointDiscoveryPoller_updateEndpoints(poller, currentEndpoints, updatedEndpoints);
+	}
 
-				if (!arrayList_contains(updatedEndpoints, endpoint)) {
-					status = discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
-					arrayList_remove(currentEndpoints, i - 1);
-					endpointDescription_destroy(endpoint);
-				}
-			}
+	if (updatedEndpoints != NULL) {
+		arrayList_destroy(updatedEndpoints);
+	}
 
-			for (int i = arrayList_size(updatedEndpoints); i > 0; i--) {
-				endpoint_description_t *endpoint = arrayList_remove(updatedEndpoints, 0);
+	return status;
+}
 
-				if (!arrayList_contains(currentEndpoints, endpoint)) {
-					arrayList_add(currentEndpoints, endpoint);
-					status = discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
-				} else {
-					endpointDescription_destroy(endpoint);
+/**
+ * Removes the current endpoints which are not in the updated endpoints and adds the updated endpoints which are not
+ * yet in the current endpoints. Takes ownership of the endpoints in updatedEndpoints.
+ */
+static celix_status_t endpointDiscoveryPoller_updateEndpoints(endpoint_discovery_poller_t *poller, array_list_pt currentEndpoints, array_list_pt updatedEndpoints) {
+	celix_status_t status = CELIX_SUCCESS;
 
-				}
-			}
+	for (unsigned int i = arrayList_size(currentEndpoints); i > 0; i--) {
+		endpoint_description_t *endpoint = arrayList_get(currentEndpoints, i - 1);
+
+		if (!arrayList_contains(updatedEndpoints, endpoint)) {
+			status = discovery_removeDiscoveredEndpoint(poller->discovery, endpoint);
+			arrayList_remove(currentEndpoints, i - 1);
+			endpointDescription_destroy(endpoint);
 		}
 	}
 
-	if (updatedEndpoints != NULL) {
-		arrayList_destroy(updatedEndpoints);
+	for (int i = arrayList_size(updatedEndpoints); i > 0; i--) {
+		endpoint_description_t *endpoint = arrayList_remove(updatedEndpoints, 0);
+
+		if (!arrayList_contains(currentEndpoints, endpoint)) {
+			arrayList_add(currentEndpoints, endpoint);
+			status = discovery_addDiscoveredEndpoint(poller->discovery, endpoint);
+		} else {
+			endpointDescription_destroy(endpoint);
+
+		}
 	}
 
 	return status;
 }
 
-static void *endpointDiscoveryPoller_performPeriodicPoll(void *data) {
-	endpoint_discovery_poller_t *poller = (endpoint_discovery_poller_t *) data;
+static size_t endpointDiscoveryPoller_writeHeader(char *buffer, size_t size, size_t nitems, void *transferPtr) {
+	size_t realsize = size * nitems;
+	endpoint_discovery_transfer_t *transfer = transferPtr;
+	const size_t nameLen = strlen("ETag:");
+
+	if (realsize > nameLen && strncasecmp(buffer, "ETag:", nameLen) == 0) {
+		const char *value = buffer + nameLen;
+		size_t len = realsize - nameLen;
+		while (len > 0 && (*value == ' ' || *value == '\t')) {
+			value++;
+			len--;
+		}
+		while (len > 0 && (value[len - 1] == '\r' || value[len - 1] == '\n' || value[len - 1] == ' ')) {
+			len--;
+		}
+		free(transfer->receivedEtag);
+		transfer->receivedEtag = strndup(value, len);
+	}
 
-	useconds_t interval = (useconds_t) (poller->poll_interval * 1000000L);
+	return realsize;
+}
 
-	while (poller->running) {
-		usleep(interval);
-		celix_status_t status = celixThreadMutex_lock(&poller->pollerLock);
+static endpoint_discovery_transfer_t* endpointDiscoveryPoller_createTransfer(endpoint_discovery_poller_t *poller, const char *url, const struct timespec *now) {
+	endpoint_discovery_transfer_t *transfer = calloc(1, sizeof(*transfer));
+	transfer->url = strdup(url);
+	transfer->curl = curl_easy_init();
+	if (transfer->curl == NULL) {
+		free(transfer->url);
+		free(transfer);
+		return NULL;
+	}
 
-		if (status != CELIX_SUCCESS) {
-            celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: failed to obtain lock; retrying...");
-		} else {
-			hash_map_iterator_pt iterator = hashMapIterator_create(poller->entries);
+	char *requestUrl = NULL;
+	if (poller->long_poll_timeout > 0) {
+		asprintf(&requestUrl, "%s%swait=%u", url, strchr(url, '?') == NULL ? "?" : "&", poller->long_poll_timeout);
+	} else {
+		requestUrl = strdup(url);
+	}
 
-			while (hashMapIterator_hasNext(iterator)) {
-				hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
+	// the handle (and its options) is reused for every poll of the url
+	curl_easy_setopt(transfer->curl, CURLOPT_URL, requestUrl);
+	curl_easy_setopt(transfer->curl, CURLOPT_NOSIGNAL, 1);
+	curl_easy_setopt(transfer->curl, CURLOPT_WRITEFUNCTION, endpointDiscoveryPoller_writeMemory);
+	curl_easy_setopt(transfer->curl, CURLOPT_WRITEDATA, (void *)&transfer->chunk);
+	curl_easy_setopt(transfer->curl, CURLOPT_HEADERFUNCTION, endpointDiscoveryPoller_writeHeader);
+	curl_easy_setopt(transfer->curl, CURLOPT_HEADERDATA, (void *)transfer);
+	curl_easy_setopt(transfer->curl, CURLOPT_CONNECTTIMEOUT, 5L);
+	curl_easy_setopt(transfer->curl, CURLOPT_TIMEOUT, (long)(poller->poll_timeout + poller->long_poll_timeout));
+	curl_easy_setopt(transfer->curl, CURLOPT_PRIVATE, (void *)transfer);
+	free(requestUrl);
+
+	// the endpoints are already retrieved when the url was added; start long-polling right away
+	transfer->nextPoll = *now;
+	if (poller->long_poll_timeout == 0) {
+		transfer->nextPoll.tv_sec += poller->poll_interval;
+	}
+	return transfer;
+}
 
-				char *url = hashMapEntry_getKey(entry);
-				array_list_pt currentEndpoints = hashMapEntry_getValue(entry);
+static void endpointDiscoveryPoller_destroyTransfer(CURLM *multi, endpoint_discovery_transfer_t *transfer) {
+	if (transfer->active) {
+		curl_multi_remove_handle(multi, transfer->curl);
+	}
+	curl_easy_cleanup(transfer->curl);
+	curl_slist_free_all(transfer->headers);
+	free(transfer->chunk.memory);
+	free(transfer->etag);
+	free(transfer->receivedEtag);
+	free(transfer->url);
+	free(transfer);
+}
 
-				endpointDiscoveryPoller_poll(poller, url, currentEndpoints);
+static void endpointDiscoveryPoller_startTransfer(CURLM *multi, endpoint_discovery_transfer_t *transfer) {
+	curl_slist_free_all(transfer->headers);
+	transfer->headers = NULL;
+	if (transfer->etag != NULL) {
+		char *header = NULL;
+		asprintf(&header, "If-None-Match: %s", transfer->etag);
+		transfer->headers = curl_slist_append(NULL, header);
+		free(header);
+	}
+	curl_easy_setopt(transfer->curl, CURLOPT_HTTPHEADER, transfer->headers);
+
+	free(transfer->chunk.memory);
+	transfer->chunk.memory = malloc(1);
+	transfer->chunk.size = 0;
+	free(transfer->receivedEtag);
+	transfer->receivedEtag = NULL;
+
+	clock_gettime(CLOCK_MONOTONIC, &transfer->start);
+	transfer->active = true;
+	curl_multi_add_handle(multi, transfer->curl);
+}
+
+/**
+ * Creates/starts the transfers for the polled urls and destroys the transfers of removed urls.
+ * Should be called with the pollerLock locked.
+ */
+static void endpointDiscoveryPoller_syncTransfers(endpoint_discovery_poller_t *poller, CURLM *multi, hash_map_pt transfers, const struct timespec *now) {
+	hash_map_iterator_pt iterator = hashMapIterator_create(poller->entries);
+	while (hashMapIterator_hasNext(iterator)) {
+		char *url = hashMapIterator_nextKey(iterator);
+		endpoint_discovery_transfer_t *transfer = hashMap_get(transfers, url);
+		if (transfer == NULL) {
+			transfer = endpointDiscoveryPoller_createTransfer(poller, url, now);
+			if (transfer == NULL) {
+				celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: cannot create request for %s", url);
+				continue;
 			}
+			hashMap_put(transfers, transfer->url, transfer);
+		}
+		if (!transfer->active && celix_difftime(&transfer->nextPoll, now) >= 0) {
+			endpointDiscoveryPoller_startTransfer(multi, transfer);
+		}
+	}
+	hashMapIterator_destroy(iterator);
 
-			hashMapIterator_destroy(iterator);
+	iterator = hashMapIterator_create(transfers);
+	while (hashMapIterator_hasNext(iterator)) {
+		endpoint_discovery_transfer_t *transfer = hashMapIterator_nextValue(iterator);
+		if (!hashMap_containsKey(poller->entries, transfer->url)) {
+			hashMapIterator_remove(iterator);
+			endpointDiscoveryPoller_destroyTransfer(multi, transfer);
 		}
+	}
+	hashMapIterator_destroy(iterator);
+}
 
-		status = celixThreadMutex_unlock(&poller->pollerLock);
+/**
+ * Processes the response of a finished transfer and schedules the next poll.
+ * A poll is restarted immediately if the server supports long-polling (responds with an ETag), otherwise the next
+ * poll is done after the poll interval.
+ * Should be called with the pollerLock locked.
+ */
+static void endpointDiscoveryPoller_handleTransferDone(endpoint_discovery_poller_t *poller, endpoint_discovery_transfer_t *transfer, CURLcode res) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	transfer->active = false;
+	bool pollAgain = false;
+
+	long responseCode = 0;
+	curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &responseCode);
+	array_list_pt currentEndpoints = hashMap_get(poller->entries, transfer->url);
+
+	if (res != CURLE_OK) {
+		celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unable to read endpoints from %s, reason: %s", transfer->url, curl_easy_strerror(res));
+	} else if (responseCode == 200) {
+		array_list_pt updatedEndpoints = NULL;
+		arrayList_createWithEquals(endpointDiscoveryPoller_endpointDescriptionEquals, &updatedEndpoints);
+		celix_status_t status = endpointDiscoveryPoller_parseEndpoints(poller, transfer->chunk.memory, &updatedEndpoints);
+		if (status == CELIX_SUCCESS && currentEndpoints != NULL) {
+			endpointDiscoveryPoller_updateEndpoints(poller, currentEndpoints, updatedEndpoints);
+		}
+		// the updated endpoints not taken over (e.g. the url is already removed or the document was invalid)
+		for (unsigned int i = 0; i < arrayList_size(updatedEndpoints); i++) {
+			endpointDescription_destroy(arrayList_get(updatedEndpoints, i));
+		}
+		arrayList_destroy(updatedEndpoints);
+
+		free(transfer->etag);
+		transfer->etag = status == CELIX_SUCCESS ? transfer->receivedEtag : NULL;
 		if (status != CELIX_SUCCESS) {
-            celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: failed to release lock; retrying...");
+			free(transfer->receivedEtag);
 		}
+		transfer->receivedEtag = NULL;
+		pollAgain = poller->long_poll_timeout > 0 && transfer->etag != NULL;
+	} else if (responseCode == 304) {
+		// not modified; only poll again right away if the server held the request (i.e. supports long-polling)
+		pollAgain = poller->long_poll_timeout > 0 && celix_difftime(&transfer->start, &now) >= poller->long_poll_timeout / 2.0;
+	} else {
+		celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unexpected response code %li for %s", responseCode, transfer->url);
+		free(transfer->etag);
+		transfer->etag = NULL;
 	}
 
-	return NULL;
+	transfer->nextPoll = now;
+	if (!pollAgain) {
+		transfer->nextPoll.tv_sec += poller->poll_interval;
+	}
 }
 
+static void *endpointDiscoveryPoller_performPeriodicPoll(void *data) {
+	endpoint_discovery_poller_t *poller = (endpoint_discovery_poller_t *) data;
 
+	CURLM *multi = curl_multi_init();
+	hash_map_pt transfers = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL); //key = url, value = endpoint_discovery_transfer_t*
 
-struct MemoryStruct {
-	char *memory;
-	size_t size;
-};
+	while (poller->running && multi != NULL) {
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		celix_status_t status = celixThreadMutex_lock(&poller->pollerLock);
+		if (status != CELIX_SUCCESS) {
+            celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: failed to obtain lock; retrying...");
+		} else {
+			endpointDiscoveryPoller_syncTransfers(poller, multi, transfers, &now);
+			status = celixThreadMutex_unlock(&poller->pollerLock);
+			if (status != CELIX_SUCCESS) {
+                celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: failed to release lock; retrying...");
+			}
+		}
+
+		int nrOfActiveTransfers = 0;
+		curl_multi_perform(multi, &nrOfActiveTransfers);
+
+		CURLMsg *msg;
+		int msgsLeft;
+		while ((msg = curl_multi_info_read(multi, &msgsLeft)) != NULL) {
+			if (msg->msg == CURLMSG_DONE) {
+				endpoint_discovery_transfer_t *transfer = NULL;
+				CURL *curl = msg->easy_handle;
+				CURLcode res = msg->data.result;
+				curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char **)&transfer);
+				curl_multi_remove_handle(multi, curl);
+
+				celixThreadMutex_lock(&poller->pollerLock);
+				endpointDiscoveryPoller_handleTransferDone(poller, transfer, res);
+				celixThreadMutex_unlock(&poller->pollerLock);
+			}
+		}
+
+		if (nrOfActiveTransfers > 0) {
+			curl_multi_wait(multi, NULL, 0, POLLER_WAKEUP_INTERVAL_MS, NULL);
+		} else {
+			usleep(POLLER_WAKEUP_INTERVAL_MS * 1000);
+		}
+	}
+
+	hash_map_iterator_pt iterator = hashMapIterator_create(transfers);
+	while (hashMapIterator_hasNext(iterator)) {
+		endpointDiscoveryPoller_destroyTransfer(multi, hashMapIterator_nextValue(iterator));
+	}
+	hashMapIterator_destroy(iterator);
+	hashMap_destroy(transfers, false, false);
+	if (multi != NULL) {
+		curl_multi_cleanup(multi);
+	}
+
+	return NULL;
+}
 
 static size_t endpointDiscoveryPoller_writeMemory(void *contents, size_t size, size_t nmemb, void *memoryPtr) {
 	size_t realsize = size * nmemb;
@@ -376,16 +623,7 @@ static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_po
 
 	// process endpoints file
 	if (res == CURLE_OK) {
-		endpoint_descriptor_reader_t *reader = NULL;
-
-		status = endpointDescriptorReader_create(poller, &reader);
-		if (status == CELIX_SUCCESS) {
-			status = endpointDescriptorReader_parseDocument(reader, chunk.memory, updatedEndpoints);
-		}
-
-		if (reader) {
-			endpointDescriptorReader_destroy(reader);
-		}
+		status = endpointDiscoveryPoller_parseEndpoints(poller, chunk.memory, updatedEndpoints);
 	} else {
         celix_logHelper_warning(*poller->loghelper, "ENDPOINT_POLLER: unable to read endpoints from %s, reason: %s", url, curl_easy_strerror(res));
 	}
@@ -398,6 +636,21 @@ static celix_status_t endpointDiscoveryPoller_getEndpoints(endpoint_discovery_po
 	return status;
 }
 
+static celix_status_t endpointDiscoveryPoller_parseEndpoints(endpoint_discovery_poller_t *poller, const char *document, array_list_pt *updatedEndpoints) {
+	endpoint_descriptor_reader_t *reader = NULL;
+
+	celix_status_t status = endpointDescriptorReader_create(poller, &reader);
+	if (status == CELIX_SUCCESS) {
+		status = endpointDescriptorReader_parseDocument(reader, (char *)document, updatedEndpoints);
+	}
+
+	if (reader) {
+		endpointDescriptorReader_destroy(reader);
+	}
+
+	return status;
+}
+
 static celix_status_t endpointDiscoveryPoller_endpointDescriptionEquals(const void *endpointPtr, const void *comparePtr, bool *equals) {
 	endpoint_description_t *endpoint = (endpoint_description_t *) endpointPtr;
 	endpoint_description_t *compare = (endpoint_description_t *) comparePtr;
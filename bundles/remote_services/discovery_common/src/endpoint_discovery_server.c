@@ -24,8 +24,10 @@
  * \copyright   Apache License, Version 2.0
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #ifndef ANDROID
@@ -34,6 +36,7 @@
 #include "civetweb.h"
 #include "celix_errno.h"
 #include "utils.h"
+#include "celix_utils.h"
 #include "celix_log_helper.h"
 #include "discovery.h"
 #include "endpoint_descriptor_writer.h"
@@ -41,6 +44,9 @@
 // defines how often the webserver is restarted (with an increased port number)
 #define MAX_NUMBER_OF_RESTARTS     15
 #define DEFAULT_SERVER_THREADS     "5"
+// max time (in seconds) a request with a matching If-None-Match header waits for a change of the endpoints
+#define MAX_LONG_POLL_WAIT         60
+#define MAX_ETAG_LENGTH            64
 
 #define CIVETWEB_REQUEST_NOT_HANDLED 0
 #define CIVETWEB_REQUEST_HANDLED 1
@@ -49,6 +55,22 @@ static const char *response_headers =
         "HTTP/1.1 200 OK\r\n"
         "Cache: no-cache\r\n"
         "Content-Type: application/xml;charset=utf-8\r\n"
+        "Content-Length: %lu\r\n"
+        "\r\n";
+
+static const char *response_headers_with_etag =
+        "HTTP/1.1 200 OK\r\n"
+        "Cache: no-cache\r\n"
+        "Content-Type: application/xml;charset=utf-8\r\n"
+        "Content-Length: %lu\r\n"
+        "ETag: %s\r\n"
+        "\r\n";
+
+static const char *not_modified_headers =
+        "HTTP/1.1 304 Not Modified\r\n"
+        "Cache: no-cache\r\n"
+        "Content-Length: 0\r\n"
+        "ETag: %s\r\n"
         "\r\n";
 
 struct endpoint_discovery_server {
@@ -56,6 +78,13 @@ struct endpoint_discovery_server {
     hash_map_pt entries; // key = endpointId, value = endpoint_descriptor_pt
 
     celix_thread_mutex_t serverLock;
+    celix_thread_cond_t versionCond; // signalled when the version changes or the server stops
+
+    unsigned long long version; // incremented on every change of the exposed endpoints
+    char etagPrefix[MAX_ETAG_LENGTH / 2]; // makes the ETags unique per server instance
+    int nrOfWaitingRequests;
+    int maxNrOfWaitingRequests;
+    bool stopping;
 
     const char *path;
     const char *port;
@@ -84,6 +113,7 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     char *detectedIp = NULL;
     const char *path = NULL;
     const char *retries = NULL;
+    const char *threads = NULL;
 
     int max_ep_num = MAX_NUMBER_OF_RESTARTS;
 
@@ -102,6 +132,17 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     if (status != CELIX_SUCCESS) {
         return CELIX_BUNDLE_EXCEPTION;
     }
+    status = celixThreadCondition_init(&(*server)->versionCond, NULL);
+    if (status != CELIX_SUCCESS) {
+        return CELIX_BUNDLE_EXCEPTION;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    snprintf((*server)->etagPrefix, sizeof((*server)->etagPrefix), "%lx%lx", (long)now.tv_sec, now.tv_nsec);
+    (*server)->version = 0;
+    (*server)->nrOfWaitingRequests = 0;
+    (*server)->stopping = false;
 
     bundleContext_getProperty(context, DISCOVERY_SERVER_IP, &ip);
 #ifndef ANDROID
@@ -153,6 +194,13 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
         }
     }
 
+    bundleContext_getProperty(context, DISCOVERY_SERVER_THREADS, &threads);
+    if (threads == NULL || strtol(threads, NULL, 10) <= 0) {
+        threads = DEFAULT_SERVER_THREADS;
+    }
+    // keep at least one thread available for requests which are not waiting for a change
+    (*server)->maxNrOfWaitingRequests = (int)strtol(threads, NULL, 10) - 1;
+
     (*server)->path = format_path(path);
 
     const struct mg_callbacks callbacks = {
@@ -165,7 +213,7 @@ celix_status_t endpointDiscoveryServer_create(discovery_t *discovery,
     do {
         const char *options[] = {
                 "listening_ports", port,
-                "num_threads", DEFAULT_SERVER_THREADS,
+                "num_threads", threads,
                 NULL
         };
 
@@ -214,6 +262,12 @@ celix_status_t endpointDiscoveryServer_getUrl(endpoint_discovery_server_t *serve
 celix_status_t endpointDiscoveryServer_destroy(endpoint_discovery_server_t *server) {
     celix_status_t status;
 
+    // wake up the requests waiting for a change...
+    celixThreadMutex_lock(&server->serverLock);
+    server->stopping = true;
+    celixThreadCondition_broadcast(&server->versionCond);
+    celixThreadMutex_unlock(&server->serverLock);
+
     // stop & block until the actual server is shut down...
     if (server->ctx != NULL) {
         mg_stop(server->ctx);
@@ -226,6 +280,7 @@ celix_status_t endpointDiscoveryServer_destroy(endpoint_discovery_server_t *serv
 
     status = celixThreadMutex_unlock(&server->serverLock);
     status = celixThreadMutex_destroy(&server->serverLock);
+    celixThreadCondition_destroy(&server->versionCond);
 
     free((void*) server->path);
     free((void*) server->port);
@@ -251,6 +306,8 @@ celix_status_t endpointDiscoveryServer_addEndpoint(endpoint_discovery_server_t *
         celix_logHelper_info(*server->loghelper, "exposing new endpoint \"%s\"...", endpointId);
 
         hashMap_put(server->entries, endpointId, endpoint);
+        server->version += 1;
+        celixThreadCondition_broadcast(&server->versionCond);
     }
 
     status = celixThreadMutex_unlock(&server->serverLock);
@@ -279,6 +336,9 @@ celix_status_t endpointDiscoveryServer_removeEndpoint(endpoint_discovery_server_
 
         // we've made this key, see _addEndpoint above...
         free((void*) key);
+
+        server->version += 1;
+        celixThreadCondition_broadcast(&server->versionCond);
     }
 
     status = celixThreadMutex_unlock(&server->serverLock);
@@ -328,7 +388,12 @@ static celix_status_t endpointDiscoveryServer_getEndpoints(endpoint_discovery_se
     return status;
 }
 
-static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, array_list_pt endpoints) {
+static void endpointDiscoveryServer_getEtag(endpoint_discovery_server_t *server, char *etag) {
+    snprintf(etag, MAX_ETAG_LENGTH, "\"%s-%llu\"", server->etagPrefix, server->version);
+}
+
+// etag can be NULL
+static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, array_list_pt endpoints, const char *etag) {
     celix_status_t status;
     int rv = CIVETWEB_REQUEST_NOT_HANDLED;
 
@@ -339,8 +404,13 @@ static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, ar
         char *buffer = NULL;
         status = endpointDescriptorWriter_writeDocument(writer, endpoints, &buffer);
         if (buffer) {
-            mg_write(conn, response_headers, strlen(response_headers));
-            mg_write(conn, buffer, strlen(buffer));
+            unsigned long length = strlen(buffer);
+            if (etag != NULL) {
+                mg_printf(conn, response_headers_with_etag, length, etag);
+            } else {
+                mg_printf(conn, response_headers, length);
+            }
+            mg_write(conn, buffer, length);
         }
 
         rv = CIVETWEB_REQUEST_HANDLED;
@@ -353,18 +423,63 @@ static int endpointDiscoveryServer_writeEndpoints(struct mg_connection* conn, ar
     return rv;
 }
 
+/**
+ * Waits till the endpoints change, the server stops or the provided wait time (in seconds) has passed.
+ * Should be called with the serverLock locked.
+ */
+static void endpointDiscoveryServer_waitForChange(endpoint_discovery_server_t *server, long wait) {
+    unsigned long long version = server->version;
+    struct timespec start;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    now = start;
+
+    server->nrOfWaitingRequests += 1;
+    while (!server->stopping && server->version == version && celix_difftime(&start, &now) < wait) {
+        celixThreadCondition_timedwaitRelative(&server->versionCond, &server->serverLock, 1, 0);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+    server->nrOfWaitingRequests -= 1;
+}
+
 // returns all endpoints as XML...
+// If the request has an If-None-Match header matching the current ETag, a 304 (not modified) is returned instead.
+// With a "wait=<seconds>" query parameter, such a request is held until the endpoints change (long-polling).
 static int endpointDiscoveryServer_returnAllEndpoints(endpoint_discovery_server_t *server, struct mg_connection* conn) {
     int status = CIVETWEB_REQUEST_NOT_HANDLED;
 
     array_list_pt endpoints = NULL;
 
+    const struct mg_request_info *request_info = mg_get_request_info(conn);
+    const char *ifNoneMatch = mg_get_header(conn, "If-None-Match");
+    long wait = 0;
+    if (request_info->query_string != NULL) {
+        char waitStr[16];
+        if (mg_get_var(request_info->query_string, strlen(request_info->query_string), "wait", waitStr, sizeof(waitStr)) > 0) {
+            wait = strtol(waitStr, NULL, 10);
+        }
+    }
+    wait = wait < 0 ? 0 : (wait > MAX_LONG_POLL_WAIT ? MAX_LONG_POLL_WAIT : wait);
+
     if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
-        endpointDiscoveryServer_getEndpoints(server, NULL, &endpoints);
-        if (endpoints) {
-            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints);
+        char etag[MAX_ETAG_LENGTH];
+        endpointDiscoveryServer_getEtag(server, etag);
 
-            arrayList_destroy(endpoints);
+        if (ifNoneMatch != NULL && strcmp(ifNoneMatch, etag) == 0 && wait > 0 && server->nrOfWaitingRequests < server->maxNrOfWaitingRequests) {
+            endpointDiscoveryServer_waitForChange(server, wait);
+            endpointDiscoveryServer_getEtag(server, etag);
+        }
+
+        if (ifNoneMatch != NULL && strcmp(ifNoneMatch, etag) == 0) {
+            mg_printf(conn, not_modified_headers, etag);
+            status = CIVETWEB_REQUEST_HANDLED;
+        } else {
+            endpointDiscoveryServer_getEndpoints(server, NULL, &endpoints);
+            if (endpoints) {
+                status = endpointDiscoveryServer_writeEndpoints(conn, endpoints, etag);
+
+                arrayList_destroy(endpoints);
+            }
         }
 
 
@@ -383,7 +498,7 @@ static int endpointDiscoveryServer_returnEndpoint(endpoint_discovery_server_t *s
     if (celixThreadMutex_lock(&server->serverLock) == CELIX_SUCCESS) {
         endpointDiscoveryServer_getEndpoints(server, endpoint_id, &endpoints);
         if (endpoints) {
-            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints);
+            status = endpointDiscoveryServer_writeEndpoints(conn, endpoints, NULL);
 
             arrayList_destroy(endpoints);
         }
@@ -42,10 +42,12 @@ struct etcd_watcher {
     celix_log_helper_t **loghelper;
     hash_map_pt entries;
 
-    celix_thread_mutex_t watcherLock;
+    celix_thread_mutex_t watcherLock; //protects running
+    celix_thread_cond_t stopCond;
     celix_thread_t watcherThread;
+    celix_thread_t refreshThread;
 
-    volatile bool running;
+    bool running;
 };
 
 
@@ -170,12 +172,12 @@ static celix_status_t etcdWatcher_addOwnFramework(etcd_watcher_t *watcher)
 
 
 
-static celix_status_t etcdWatcher_addEntry(etcd_watcher_t *watcher, char* key, char* value) {
+static celix_status_t etcdWatcher_addEntry(etcd_watcher_t *watcher, const char* key, const char* value) {
 	celix_status_t status = CELIX_BUNDLE_EXCEPTION;
 	endpoint_discovery_poller_t *poller = watcher->discovery->poller;
 
 	if (!hashMap_containsKey(watcher->entries, key)) {
-		status = endpointDiscoveryPoller_addDiscoveryEndpoint(poller, value);
+		status = endpointDiscoveryPoller_addDiscoveryEndpoint(poller, (char*)value);
 
 		if (status == CELIX_SUCCESS) {
 			hashMap_put(watcher->entries, strdup(key), strdup(value));
@@ -185,7 +187,7 @@ static celix_status_t etcdWatcher_addEntry(etcd_watcher_t *watcher, char* key, c
 	return status;
 }
 
-static celix_status_t etcdWatcher_removeEntry(etcd_watcher_t *watcher, char* key, char* value) {
+static celix_status_t etcdWatcher_removeEntry(etcd_watcher_t *watcher, const char* key) {
 	celix_status_t status = CELIX_BUNDLE_EXCEPTION;
 	endpoint_discovery_poller_t *poller = watcher->discovery->poller;
 
@@ -220,13 +222,40 @@ static celix_status_t etcdWatcher_removeEntry(etcd_watcher_t *watcher, char* key
 }
 
 
+static bool etcdWatcher_isRunning(etcd_watcher_t *watcher) {
+	celixThreadMutex_lock(&watcher->watcherLock);
+	bool running = watcher->running;
+	celixThreadMutex_unlock(&watcher->watcherLock);
+	return running;
+}
+
+static bool etcdWatcher_handleWatchEvents(const etcdlib_watch_event_t *events, int nrOfEvents, void *arg) {
+	etcd_watcher_t *watcher = arg;
+	for (int i = 0; i < nrOfEvents; ++i) {
+		const etcdlib_watch_event_t *event = &events[i];
+		if (event->action == NULL || event->key == NULL) {
+			continue;
+		}
+		if (strcmp(event->action, ETCDLIB_ACTION_SET) == 0 || strcmp(event->action, ETCDLIB_ACTION_UPDATE) == 0) {
+			if (event->value != NULL) {
+				etcdWatcher_addEntry(watcher, event->key, event->value);
+			}
+		} else if (strcmp(event->action, ETCDLIB_ACTION_DELETE) == 0 || strcmp(event->action, ETCDLIB_ACTION_EXPIRE) == 0) {
+			etcdWatcher_removeEntry(watcher, event->key);
+		} else {
+			celix_logHelper_log(*watcher->loghelper, CELIX_LOG_LEVEL_INFO, "Unexpected action: %s", event->action);
+		}
+	}
+	return etcdWatcher_isRunning(watcher);
+}
+
 /*
- * performs (blocking) etcd_watch calls to check for
+ * performs (blocking) streaming etcd watches to check for
  * changing discovery endpoint information within etcd.
+ * The watch is interrupted by etcdWatcher_destroy.
  */
 static void* etcdWatcher_run(void* data) {
 	etcd_watcher_t *watcher = (etcd_watcher_t *) data;
-	time_t timeBeforeWatch = time(NULL);
 	char rootPath[MAX_ROOTNODE_LENGTH];
 	long long highestModified = 0;
 
@@ -235,43 +264,39 @@ static void* etcdWatcher_run(void* data) {
 	etcdWatcher_addAlreadyExistingWatchpoints(watcher, watcher->discovery, &highestModified);
 	etcdWatcher_getRootPath(context, rootPath);
 
-	while (watcher->running) {
+	bool running = etcdWatcher_isRunning(watcher);
+	while (running) {
+		int rc = etcdlib_watch_stream(watcher->etcdlib, rootPath, highestModified + 1, etcdWatcher_handleWatchEvents, watcher, &highestModified);
 
-		char *rkey = NULL;
-		char *value = NULL;
-		char *preValue = NULL;
-		char *action = NULL;
-		long long modIndex;
-
-        if (etcdlib_watch(watcher->etcdlib, rootPath, highestModified + 1, &action, &preValue, &value, &rkey, &modIndex) == 0 && action != NULL) {
-			if (strcmp(action, "set") == 0) {
-				etcdWatcher_addEntry(watcher, rkey, value);
-			} else if (strcmp(action, "delete") == 0) {
-				etcdWatcher_removeEntry(watcher, rkey, value);
-			} else if (strcmp(action, "expire") == 0) {
-				etcdWatcher_removeEntry(watcher, rkey, value);
-			} else if (strcmp(action, "update") == 0) {
-				etcdWatcher_addEntry(watcher, rkey, value);
-			} else {
-				celix_logHelper_log(*watcher->loghelper, CELIX_LOG_LEVEL_INFO, "Unexpected action: %s", action);
-			}
+		celixThreadMutex_lock(&watcher->watcherLock);
+		if (rc == ETCDLIB_RC_ERROR && watcher->running) {
+			//etcd not reachable, retry later
+			celixThreadCondition_timedwaitRelative(&watcher->stopCond, &watcher->watcherLock, watcher->ttl / 4, 0);
+		}
+		running = watcher->running;
+		celixThreadMutex_unlock(&watcher->watcherLock);
+	}
 
-			highestModified = modIndex;
-        } else if (time(NULL) - timeBeforeWatch <= (watcher->ttl / 4)) {
-			sleep(watcher->ttl / 4);
-        }
+	return NULL;
+}
 
-        FREE_MEM(action);
-        FREE_MEM(value);
-        FREE_MEM(preValue);
-        FREE_MEM(rkey);
+/*
+ * refreshes the own framework registration (and its ttl)
+ * within etcd every ttl/4 seconds.
+ */
+static void* etcdWatcher_refresh(void* data) {
+	etcd_watcher_t *watcher = (etcd_watcher_t *) data;
 
-		// update own framework uuid
-		if (time(NULL) - timeBeforeWatch > (watcher->ttl / 4)) {
+	celixThreadMutex_lock(&watcher->watcherLock);
+	while (watcher->running) {
+		celixThreadCondition_timedwaitRelative(&watcher->stopCond, &watcher->watcherLock, watcher->ttl / 4, 0);
+		if (watcher->running) {
+			celixThreadMutex_unlock(&watcher->watcherLock);
 			etcdWatcher_addOwnFramework(watcher);
-			timeBeforeWatch = time(NULL);
+			celixThreadMutex_lock(&watcher->watcherLock);
 		}
 	}
+	celixThreadMutex_unlock(&watcher->watcherLock);
 
 	return NULL;
 }
@@ -310,12 +335,16 @@ celix_status_t etcdWatcher_create(discovery_t *discovery, celix_bundle_context_t
         etcdWatcher_addOwnFramework(*watcher);
         status = celixThreadMutex_create(&(*watcher)->watcherLock, NULL);
     }
+    if (status == CELIX_SUCCESS) {
+        status = celixThreadCondition_init(&(*watcher)->stopCond, NULL);
+    }
 
     if (status == CELIX_SUCCESS) {
         if (celixThreadMutex_lock(&(*watcher)->watcherLock) == CELIX_SUCCESS) {
+            (*watcher)->running = true;
             status = celixThread_create(&(*watcher)->watcherThread, NULL, etcdWatcher_run, *watcher);
             if (status == CELIX_SUCCESS) {
-                (*watcher)->running = true;
+                status = celixThread_create(&(*watcher)->refreshThread, NULL, etcdWatcher_refresh, *watcher);
             }
             celixThreadMutex_unlock(&(*watcher)->watcherLock);
         }
@@ -331,9 +360,14 @@ celix_status_t etcdWatcher_destroy(etcd_watcher_t *watcher) {
 
 	celixThreadMutex_lock(&watcher->watcherLock);
 	watcher->running = false;
+	celixThreadCondition_broadcast(&watcher->stopCond);
 	celixThreadMutex_unlock(&watcher->watcherLock);
+	etcdlib_interrupt_watch(watcher->etcdlib);
 
 	celixThread_join(watcher->watcherThread, NULL);
+	celixThread_join(watcher->refreshThread, NULL);
+	celixThreadCondition_destroy(&watcher->stopCond);
+	celixThreadMutex_destroy(&watcher->watcherLock);
 
 	// register own framework
 	status = etcdWatcher_getLocalNodePath(watcher->discovery->context, localNodePath);
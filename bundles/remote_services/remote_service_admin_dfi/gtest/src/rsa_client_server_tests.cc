@@ -21,6 +21,7 @@
 #include <remote_constants.h>
 #include <tst_service.h>
 #include "celix_api.h"
+#include "celix_shell_command.h"
 
 extern "C" {
 
@@ -41,10 +42,13 @@ extern "C" {
     static celix_framework_t *clientFramework = NULL;
     static celix_bundle_context_t *clientContext = NULL;
 
-    static void setupFm(void) {
+    static void setupFm(const char *protocol) {
         //server
         celix_properties_t *serverProps = celix_properties_load("server.properties");
         ASSERT_TRUE(serverProps != NULL);
+        if (protocol != NULL) {
+            celix_properties_set(serverProps, "RSA_DFI_PROTOCOL", protocol);
+        }
         serverFramework = celix_frameworkFactory_createFramework(serverProps);
         ASSERT_TRUE(serverFramework != NULL);
         serverContext = celix_framework_getFrameworkContext(serverFramework);
@@ -164,7 +168,7 @@ static void test(F&& f) {
 class RsaDfiClientServerTests : public ::testing::Test {
 public:
     RsaDfiClientServerTests() {
-        setupFm();
+        setupFm(nullptr);
     }
     ~RsaDfiClientServerTests() override {
         teardownFm();
@@ -173,6 +177,20 @@ public:
 };
 
 
+/**
+ * Same setup, but the server exports its services with the binary avrobin protocol instead of json.
+ */
+class RsaDfiBinaryClientServerTests : public ::testing::Test {
+public:
+    RsaDfiBinaryClientServerTests() {
+        setupFm("avrobin");
+    }
+    ~RsaDfiBinaryClientServerTests() override {
+        teardownFm();
+    }
+
+};
+
 TEST_F(RsaDfiClientServerTests, TestRemoteCalculator) {
     test(testCalculator);
 }
@@ -208,3 +226,45 @@ TEST_F(RsaDfiClientServerTests, CreateDestroyComponentWithRemoteService) {
 TEST_F(RsaDfiClientServerTests, AddRemoteServiceInRemoteService) {
     test(testAddRemoteServiceInRemoteService);
 }
+
+TEST_F(RsaDfiClientServerTests, RemoteCallMetricsCommand) {
+    test(testCalculator);
+
+    char *buf = nullptr;
+    size_t bufLen = 0;
+    FILE *out = open_memstream(&buf, &bufLen);
+    celix_service_use_options_t opts{};
+    opts.filter.serviceName = CELIX_SHELL_COMMAND_SERVICE_NAME;
+    opts.filter.filter = "(" CELIX_SHELL_COMMAND_NAME "=celix::rsa_dfi)";
+    opts.callbackHandle = out;
+    opts.use = [](void *handle, void *svc) {
+        auto *cmd = static_cast<celix_shell_command_t *>(svc);
+        cmd->executeCommand(cmd->handle, "rsa_dfi", static_cast<FILE *>(handle), stderr);
+    };
+    bool called = celix_bundleContext_useServiceWithOptions(clientContext, &opts);
+    fclose(out);
+    ASSERT_TRUE(called);
+
+    //the calculator calls are done with (reused) pooled curl handles
+    std::string output{buf};
+    free(buf);
+    EXPECT_NE(std::string::npos, output.find("|- Endpoint http://")) << output;
+    EXPECT_NE(std::string::npos, output.find("latency histogram")) << output;
+    EXPECT_EQ(std::string::npos, output.find("calls            = 0\n")) << output;
+}
+
+TEST_F(RsaDfiBinaryClientServerTests, TestRemoteCalculator) {
+    test(testCalculator);
+}
+
+TEST_F(RsaDfiBinaryClientServerTests, TestRemoteComplex) {
+    test(testComplex);
+}
+
+TEST_F(RsaDfiBinaryClientServerTests, TestRemoteString) {
+    test(testString);
+}
+
+TEST_F(RsaDfiBinaryClientServerTests, TestRemoteEnum) {
+    test(testEnum);
+}
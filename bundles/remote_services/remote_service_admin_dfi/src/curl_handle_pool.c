@@ -0,0 +1,321 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "curl_handle_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "celix_threads.h"
+#include "hash_map.h"
+#include "utils.h"
+
+#define CURL_HANDLE_POOL_NR_OF_BUCKETS 10
+
+//upper bounds of the latency histogram buckets in us, the last bucket is unbounded
+static const long curlHandlePool_bucketBounds[CURL_HANDLE_POOL_NR_OF_BUCKETS - 1] = {
+        100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000
+};
+
+typedef struct curl_handle_pool_endpoint {
+    char *url;
+
+    celix_thread_mutex_t mutex; //protects below
+    CURL **idleHandles; //stack, most recently used handle on top
+    time_t *idleSince;
+    int nrOfIdleHandles;
+    int nrOfActiveCalls; //acquired and not yet released handles
+    bool removed; //true if the endpoint is removed, the entry is evicted when no call is active anymore
+
+    unsigned long nrOfCalls;
+    unsigned long nrOfErrors;
+    unsigned long nrOfNewHandles;
+    long maxDurationInUs;
+    double totalDurationInUs;
+    unsigned long histogram[CURL_HANDLE_POOL_NR_OF_BUCKETS];
+} curl_handle_pool_endpoint_t;
+
+struct curl_handle_pool {
+    int maxIdleHandles;
+    int idleTimeoutInSeconds;
+
+    celix_thread_rwlock_t lock; //protects endpoints. Note lock order is pool lock and then endpoint mutex
+    hash_map_t *endpoints; //key = url, value = curl_handle_pool_endpoint_t*
+};
+
+static time_t curlHandlePool_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec;
+}
+
+celix_status_t curlHandlePool_create(int maxIdleHandles, int idleTimeoutInSeconds, curl_handle_pool_t **out) {
+    curl_handle_pool_t *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return CELIX_ENOMEM;
+    }
+    pool->maxIdleHandles = maxIdleHandles < 0 ? 0 : maxIdleHandles;
+    pool->idleTimeoutInSeconds = idleTimeoutInSeconds;
+    celixThreadRwlock_create(&pool->lock, NULL);
+    pool->endpoints = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+    *out = pool;
+    return CELIX_SUCCESS;
+}
+
+static void curlHandlePool_destroyEndpoint(curl_handle_pool_endpoint_t *endpoint) {
+    for (int i = 0; i < endpoint->nrOfIdleHandles; ++i) {
+        curl_easy_cleanup(endpoint->idleHandles[i]);
+    }
+    celixThreadMutex_destroy(&endpoint->mutex);
+    free(endpoint->idleHandles);
+    free(endpoint->idleSince);
+    free(endpoint->url);
+    free(endpoint);
+}
+
+void curlHandlePool_destroy(curl_handle_pool_t *pool) {
+    if (pool != NULL) {
+        hash_map_iterator_t iter = hashMapIterator_construct(pool->endpoints);
+        while (hashMapIterator_hasNext(&iter)) {
+            curlHandlePool_destroyEndpoint(hashMapIterator_nextValue(&iter));
+        }
+        hashMap_destroy(pool->endpoints, false, false);
+        celixThreadRwlock_destroy(&pool->lock);
+        free(pool);
+    }
+}
+
+/**
+ * Returns the (created if needed) endpoint for the url with the endpoint mutex locked.
+ * The mutex is locked before the pool lock is released, so that the endpoint cannot be evicted in between.
+ */
+static curl_handle_pool_endpoint_t* curlHandlePool_lockEndpoint(curl_handle_pool_t *pool, const char *url) {
+    celixThreadRwlock_readLock(&pool->lock);
+    curl_handle_pool_endpoint_t *endpoint = hashMap_get(pool->endpoints, url);
+    if (endpoint != NULL) {
+        celixThreadMutex_lock(&endpoint->mutex);
+        celixThreadRwlock_unlock(&pool->lock);
+        return endpoint;
+    }
+    celixThreadRwlock_unlock(&pool->lock);
+
+    celixThreadRwlock_writeLock(&pool->lock);
+    endpoint = hashMap_get(pool->endpoints, url);
+    if (endpoint == NULL) {
+        endpoint = calloc(1, sizeof(*endpoint));
+        endpoint->url = strdup(url);
+        celixThreadMutex_create(&endpoint->mutex, NULL);
+        if (pool->maxIdleHandles > 0) {
+            endpoint->idleHandles = calloc(pool->maxIdleHandles, sizeof(*endpoint->idleHandles));
+            endpoint->idleSince = calloc(pool->maxIdleHandles, sizeof(*endpoint->idleSince));
+        }
+        hashMap_put(pool->endpoints, endpoint->url, endpoint);
+    }
+    celixThreadMutex_lock(&endpoint->mutex);
+    celixThreadRwlock_unlock(&pool->lock);
+    return endpoint;
+}
+
+/**
+ * Removes idle handles which are not used for the idle timeout. Handles on the bottom of the stack are idle the longest.
+ * Note endpoint->mutex should be locked. Returns a (malloc'ed) array of the expired handles or NULL if no handle expired,
+ * so that the handles can be cleaned up after unlocking.
+ */
+static CURL** curlHandlePool_removeExpired(curl_handle_pool_t *pool, curl_handle_pool_endpoint_t *endpoint, int *nrOfExpired) {
+    time_t now = curlHandlePool_now();
+    int count = 0;
+    while (count < endpoint->nrOfIdleHandles && now - endpoint->idleSince[count] >= pool->idleTimeoutInSeconds) {
+        count += 1;
+    }
+    *nrOfExpired = 0;
+    if (count == 0) {
+        return NULL;
+    }
+    CURL **expired = malloc(count * sizeof(*expired));
+    if (expired == NULL) {
+        //note keep the handles, they are retried on the next acquire or release
+        return NULL;
+    }
+    memcpy(expired, endpoint->idleHandles, count * sizeof(*expired));
+    endpoint->nrOfIdleHandles -= count;
+    memmove(endpoint->idleHandles, endpoint->idleHandles + count, endpoint->nrOfIdleHandles * sizeof(*endpoint->idleHandles));
+    memmove(endpoint->idleSince, endpoint->idleSince + count, endpoint->nrOfIdleHandles * sizeof(*endpoint->idleSince));
+    *nrOfExpired = count;
+    return expired;
+}
+
+static void curlHandlePool_cleanupHandles(CURL **handles, int nrOfHandles) {
+    for (int i = 0; i < nrOfHandles; ++i) {
+        curl_easy_cleanup(handles[i]);
+    }
+    free(handles);
+}
+
+/**
+ * Evicts the endpoint entry of the url if it is removed and has no active calls.
+ * Note should be called without locks, the url is looked up again because the endpoint could already be evicted.
+ */
+static void curlHandlePool_evictRemovedEndpoint(curl_handle_pool_t *pool, const char *url) {
+    curl_handle_pool_endpoint_t *evicted = NULL;
+    celixThreadRwlock_writeLock(&pool->lock);
+    curl_handle_pool_endpoint_t *endpoint = hashMap_get(pool->endpoints, url);
+    if (endpoint != NULL) {
+        celixThreadMutex_lock(&endpoint->mutex);
+        if (endpoint->removed && endpoint->nrOfActiveCalls == 0) {
+            hashMap_remove(pool->endpoints, url);
+            evicted = endpoint;
+        }
+        celixThreadMutex_unlock(&endpoint->mutex);
+    }
+    celixThreadRwlock_unlock(&pool->lock);
+
+    if (evicted != NULL) {
+        curlHandlePool_destroyEndpoint(evicted);
+    }
+}
+
+CURL* curlHandlePool_acquire(curl_handle_pool_t *pool, const char *url) {
+    CURL *handle = NULL;
+    curl_handle_pool_endpoint_t *endpoint = curlHandlePool_lockEndpoint(pool, url);
+    int nrOfExpired = 0;
+    CURL **expired = curlHandlePool_removeExpired(pool, endpoint, &nrOfExpired);
+    endpoint->removed = false;
+    endpoint->nrOfActiveCalls += 1;
+    if (endpoint->nrOfIdleHandles > 0) {
+        endpoint->nrOfIdleHandles -= 1;
+        handle = endpoint->idleHandles[endpoint->nrOfIdleHandles];
+    } else {
+        endpoint->nrOfNewHandles += 1;
+    }
+    celixThreadMutex_unlock(&endpoint->mutex);
+
+    curlHandlePool_cleanupHandles(expired, nrOfExpired);
+
+    if (handle != NULL) {
+        //note reset keeps the connection and dns cache of the handle
+        curl_easy_reset(handle);
+    } else {
+        handle = curl_easy_init();
+    }
+    return handle;
+}
+
+void curlHandlePool_release(curl_handle_pool_t *pool, const char *url, CURL *handle, CURLcode result, long durationInUs) {
+    int bucket = 0;
+    while (bucket < CURL_HANDLE_POOL_NR_OF_BUCKETS - 1 && durationInUs > curlHandlePool_bucketBounds[bucket]) {
+        bucket += 1;
+    }
+
+    curl_handle_pool_endpoint_t *endpoint = curlHandlePool_lockEndpoint(pool, url);
+    endpoint->nrOfCalls += 1;
+    endpoint->nrOfErrors += result == CURLE_OK ? 0 : 1;
+    endpoint->totalDurationInUs += (double)durationInUs;
+    if (durationInUs > endpoint->maxDurationInUs) {
+        endpoint->maxDurationInUs = durationInUs;
+    }
+    endpoint->histogram[bucket] += 1;
+    if (endpoint->nrOfActiveCalls > 0) {
+        endpoint->nrOfActiveCalls -= 1;
+    }
+
+    int nrOfExpired = 0;
+    CURL **expired = curlHandlePool_removeExpired(pool, endpoint, &nrOfExpired);
+    CURL *discarded = NULL;
+    if (result == CURLE_OK && !endpoint->removed && endpoint->nrOfIdleHandles < pool->maxIdleHandles) {
+        endpoint->idleHandles[endpoint->nrOfIdleHandles] = handle;
+        endpoint->idleSince[endpoint->nrOfIdleHandles] = curlHandlePool_now();
+        endpoint->nrOfIdleHandles += 1;
+    } else {
+        //failed calls could leave a broken connection, so do not reuse the handle
+        discarded = handle;
+    }
+    bool evict = endpoint->removed && endpoint->nrOfActiveCalls == 0;
+    celixThreadMutex_unlock(&endpoint->mutex);
+
+    curlHandlePool_cleanupHandles(expired, nrOfExpired);
+    if (discarded != NULL) {
+        curl_easy_cleanup(discarded);
+    }
+    if (evict) {
+        curlHandlePool_evictRemovedEndpoint(pool, url);
+    }
+}
+
+void curlHandlePool_removeEndpoint(curl_handle_pool_t *pool, const char *url) {
+    celixThreadRwlock_writeLock(&pool->lock);
+    curl_handle_pool_endpoint_t *endpoint = hashMap_get(pool->endpoints, url);
+    if (endpoint == NULL) {
+        celixThreadRwlock_unlock(&pool->lock);
+        return;
+    }
+
+    //note if a call is still in progress for the url, the entry is evicted when the last handle is released
+    CURL **idle = NULL;
+    int nrOfIdle = 0;
+    bool evict = false;
+    celixThreadMutex_lock(&endpoint->mutex);
+    if (endpoint->nrOfActiveCalls == 0) {
+        hashMap_remove(pool->endpoints, url);
+        evict = true;
+    } else if (endpoint->nrOfIdleHandles > 0) {
+        idle = malloc(endpoint->nrOfIdleHandles * sizeof(*idle));
+        if (idle != NULL) {
+            nrOfIdle = endpoint->nrOfIdleHandles;
+            memcpy(idle, endpoint->idleHandles, nrOfIdle * sizeof(*idle));
+            endpoint->nrOfIdleHandles = 0;
+        }
+    }
+    endpoint->removed = true;
+    celixThreadMutex_unlock(&endpoint->mutex);
+    celixThreadRwlock_unlock(&pool->lock);
+
+    if (evict) {
+        curlHandlePool_destroyEndpoint(endpoint);
+    }
+    curlHandlePool_cleanupHandles(idle, nrOfIdle);
+}
+
+void curlHandlePool_printMetrics(curl_handle_pool_t *pool, FILE *out) {
+    fprintf(out, "Remote calls (max idle handles per endpoint = %i, idle timeout = %is):\n", pool->maxIdleHandles, pool->idleTimeoutInSeconds);
+    celixThreadRwlock_readLock(&pool->lock);
+    hash_map_iterator_t iter = hashMapIterator_construct(pool->endpoints);
+    while (hashMapIterator_hasNext(&iter)) {
+        curl_handle_pool_endpoint_t *endpoint = hashMapIterator_nextValue(&iter);
+        celixThreadMutex_lock(&endpoint->mutex);
+        double avg = endpoint->nrOfCalls == 0 ? 0.0 : endpoint->totalDurationInUs / (double)endpoint->nrOfCalls;
+        fprintf(out, "|- Endpoint %s\n", endpoint->url);
+        fprintf(out, "   |- calls            = %lu\n", endpoint->nrOfCalls);
+        fprintf(out, "   |- errors           = %lu\n", endpoint->nrOfErrors);
+        fprintf(out, "   |- new handles      = %lu\n", endpoint->nrOfNewHandles);
+        fprintf(out, "   |- idle handles     = %i\n", endpoint->nrOfIdleHandles);
+        fprintf(out, "   |- avg latency      = %.1fus\n", avg);
+        fprintf(out, "   |- max latency      = %lius\n", endpoint->maxDurationInUs);
+        fprintf(out, "   |- latency histogram:\n");
+        for (int i = 0; i < CURL_HANDLE_POOL_NR_OF_BUCKETS; ++i) {
+            if (i < CURL_HANDLE_POOL_NR_OF_BUCKETS - 1) {
+                fprintf(out, "      |- <= %7lius : %lu\n", curlHandlePool_bucketBounds[i], endpoint->histogram[i]);
+            } else {
+                fprintf(out, "      |-  > %7lius : %lu\n", curlHandlePool_bucketBounds[i - 1], endpoint->histogram[i]);
+            }
+        }
+        celixThreadMutex_unlock(&endpoint->mutex);
+    }
+    celixThreadRwlock_unlock(&pool->lock);
+}
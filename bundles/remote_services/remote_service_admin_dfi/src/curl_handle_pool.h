@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CURL_HANDLE_POOL_H_
+#define CURL_HANDLE_POOL_H_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <curl/curl.h>
+
+#include "celix_errno.h"
+
+/**
+ * A pool of reusable curl easy handles per endpoint url.
+ *
+ * A reused easy handle keeps its connection cache, so subsequent calls to the same endpoint reuse the kept-alive
+ * connection instead of setting up a new handle and connection for every remote call.
+ * The pool also keeps a call latency histogram per endpoint url.
+ */
+typedef struct curl_handle_pool curl_handle_pool_t;
+
+/**
+ * Creates a curl handle pool.
+ *
+ * @param maxIdleHandles            The max number of idle handles kept per endpoint. 0 disables pooling.
+ * @param idleTimeoutInSeconds      Idle handles (and their connections) are cleaned up after this timeout.
+ */
+celix_status_t curlHandlePool_create(int maxIdleHandles, int idleTimeoutInSeconds, curl_handle_pool_t **out);
+void curlHandlePool_destroy(curl_handle_pool_t *pool);
+
+/**
+ * Acquires an (idle or new) curl handle for the provided url. The options of a reused handle are reset.
+ */
+CURL* curlHandlePool_acquire(curl_handle_pool_t *pool, const char *url);
+
+/**
+ * Releases a curl handle acquired for the provided url and records the call result and duration.
+ * The handle is kept for reuse if the call succeeded and the max number of idle handles is not reached.
+ */
+void curlHandlePool_release(curl_handle_pool_t *pool, const char *url, CURL *handle, CURLcode result, long durationInUs);
+
+/**
+ * Cleans up the idle handles (and their connections) and the metrics of the provided url. Called when the import of
+ * the endpoint is closed, because otherwise the entry for the url is kept until the pool is destroyed.
+ * If a call is still in progress for the url, the entry is evicted when the last handle is released.
+ */
+void curlHandlePool_removeEndpoint(curl_handle_pool_t *pool, const char *url);
+
+/**
+ * Prints the number of calls, errors, idle handles and the call latency histogram per endpoint url.
+ */
+void curlHandlePool_printMetrics(curl_handle_pool_t *pool, FILE *out);
+
+#endif
@@ -17,17 +17,21 @@
  * under the License.
  */
 
+#include <string.h>
 #include <jansson.h>
 #include <dyn_interface.h>
+#include <dyn_cache.h>
 #include <remote_constants.h>
 #include <remote_service_admin.h>
 #include <service_tracker_customizer.h>
 #include <service_tracker.h>
 #include <json_rpc.h>
+#include <avrobin_rpc.h>
 #include "celix_constants.h"
 #include "export_registration_dfi.h"
 #include "dfi_utils.h"
 #include "remote_interceptors_handler.h"
+#include "remote_service_admin_dfi_constants.h"
 
 struct export_reference {
     endpoint_description_t *endpoint; //owner
@@ -40,7 +44,7 @@ struct export_registration {
     struct export_reference exportReference;
     char *servId;
     dyn_interface_type *intf; //owner
-
+    bool binary; //true if the endpoint uses the avrobin protocol instead of json
 
     celix_thread_mutex_t mutex;
     celix_thread_cond_t  cond;
@@ -89,6 +93,8 @@ celix_status_t exportRegistration_create(celix_log_helper_t *helper, service_ref
         reg->servId = strndup(servId, 1024);
         reg->trackerId = -1L;
         reg->active = true;
+        const char *protocol = celix_properties_get(endpoint->properties, RSA_DFI_ENDPOINT_PROTOCOL, RSA_DFI_PROTOCOL_JSON);
+        reg->binary = strcmp(protocol, RSA_DFI_PROTOCOL_AVROBIN) == 0;
 
         remoteInterceptorsHandler_create(context, &reg->interceptorsHandler);
 
@@ -153,41 +159,65 @@ void exportRegistration_waitTillNotUsed(export_registration_t *export) {
     celixThreadMutex_unlock(&export->mutex);
 }
 
-celix_status_t exportRegistration_call(export_registration_t *export, char *data, int datalength, celix_properties_t *metadata, char **responseOut, int *responseLength) {
+bool exportRegistration_isBinary(export_registration_t *export) {
+    return export->binary;
+}
+
+celix_status_t exportRegistration_call(export_registration_t *export, char *data, size_t datalength, celix_properties_t *metadata, char **responseOut, size_t *responseLength) {
     int status = CELIX_SUCCESS;
 
-    *responseLength = -1;
-    json_error_t error;
-    json_t *js_request = json_loads(data, 0, &error);
-    const char *sig;
-    if (js_request) {
-        if (json_unpack(js_request, "{s:s}", "m", &sig) == 0) {
-            bool cont = remoteInterceptorHandler_invokePreExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, &metadata);
-            if (cont) {
-                celixThreadMutex_lock(&export->mutex);
-                if (export->active && export->service != NULL) {
-                    status = jsonRpc_call(export->intf, export->service, data, responseOut);
-                } else if (!export->active) {
-                    status = CELIX_ILLEGAL_STATE;
-                    celix_logHelper_warning(export->helper, "Cannot call an inactive service export");
+    *responseLength = 0;
+    json_t *js_request = NULL;
+    const char *sig = NULL;
+    if (export->binary) {
+        //note a method index with a mismatching signature hash is rejected as an illegal argument
+        struct method_entry *method = NULL;
+        if (avrobinRpc_getMethod(export->intf, (const uint8_t *) data, datalength, &method) == 0) {
+            sig = method->id;
+        }
+    } else {
+        json_error_t error;
+        js_request = json_loads(data, 0, &error);
+        if (js_request != NULL && json_unpack(js_request, "{s:s}", "m", &sig) != 0) {
+            sig = NULL;
+        }
+    }
+
+    if (sig != NULL) {
+        bool cont = remoteInterceptorHandler_invokePreExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, &metadata);
+        if (cont) {
+            celixThreadMutex_lock(&export->mutex);
+            if (export->active && export->service != NULL) {
+                if (export->binary) {
+                    status = avrobinRpc_call(export->intf, export->service, (const uint8_t *) data, datalength, (uint8_t **) responseOut, responseLength);
                 } else {
-                    status = CELIX_ILLEGAL_STATE;
-                    celix_logHelper_error(export->helper, "export service pointer is NULL");
+                    status = jsonRpc_call(export->intf, export->service, data, responseOut);
+                    *responseLength = *responseOut != NULL ? strlen(*responseOut) : 0;
                 }
-                celixThreadMutex_unlock(&export->mutex);
-
-                remoteInterceptorHandler_invokePostExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, metadata);
+            } else if (!export->active) {
+                status = CELIX_ILLEGAL_STATE;
+                celix_logHelper_warning(export->helper, "Cannot call an inactive service export");
+            } else {
+                status = CELIX_ILLEGAL_STATE;
+                celix_logHelper_error(export->helper, "export service pointer is NULL");
             }
+            celixThreadMutex_unlock(&export->mutex);
 
-            //printf("calling for '%s'\n");
-            if (export->logFile != NULL) {
-                static int callCount = 0;
-                char *name = NULL;
-                dynInterface_getName(export->intf, &name);
+            remoteInterceptorHandler_invokePostExportCall(export->interceptorsHandler, export->exportReference.endpoint->properties, sig, metadata);
+        }
+
+        //printf("calling for '%s'\n");
+        if (export->logFile != NULL) {
+            static int callCount = 0;
+            char *name = NULL;
+            dynInterface_getName(export->intf, &name);
+            if (export->binary) {
+                fprintf(export->logFile, "REMOTE CALL %i\n\tservice=%s\n\tservice_id=%s\n\tmethod=%s\n\trequest_payload=<%zu bytes>\n\tstatus=%i\n", callCount, name, export->servId, sig, datalength, status);
+            } else {
                 fprintf(export->logFile, "REMOTE CALL %i\n\tservice=%s\n\tservice_id=%s\n\trequest_payload=%s\n\tstatus=%i\n", callCount, name, export->servId, data, status);
-                fflush(export->logFile);
-                callCount += 1;
             }
+            fflush(export->logFile);
+            callCount += 1;
         }
     } else {
         status = CELIX_ILLEGAL_ARGUMENT;
@@ -203,8 +233,15 @@ static celix_status_t exportRegistration_findAndParseInterfaceDescriptor(celix_l
 
     celix_status_t status = dfi_findDescriptor(context, bundle, name, &descriptor);
     if (status == CELIX_SUCCESS && descriptor != NULL) {
-        int rc = dynInterface_parse(descriptor, out);
+        //note the exported interface is only used read only, so it can be shared with other exports of the same descriptor
+        char *content = NULL;
+        size_t length = 0;
+        int rc = dynCache_readDescriptor(descriptor, &content, &length);
         fclose(descriptor);
+        if (rc == 0) {
+            rc = dynCache_getInterface(content, length, out);
+            free(content);
+        }
         if (rc != 0) {
             celix_logHelper_log(helper, CELIX_LOG_LEVEL_WARNING, "RSA_DFI: Error parsing service descriptor for \"%s\", return code is %d.", name, rc);
             status = CELIX_BUNDLE_EXCEPTION;
@@ -231,7 +268,7 @@ void exportRegistration_destroy(export_registration_t *reg) {
         if (reg->intf != NULL) {
             dyn_interface_type *intf = reg->intf;
             reg->intf = NULL;
-            dynInterface_destroy(intf);
+            dynCache_releaseInterface(intf);
         }
 
         if (reg->exportReference.endpoint != NULL) {
@@ -32,7 +32,8 @@ celix_status_t exportRegistration_start(export_registration_t *registration);
 celix_status_t exportRegistration_stop(export_registration_t *registration);
 void exportRegistration_setActive(export_registration_t *registration, bool active);
 
-celix_status_t exportRegistration_call(export_registration_t *export, char *data, int datalength, celix_properties_t *metadata, char **response, int *responseLength);
+celix_status_t exportRegistration_call(export_registration_t *export, char *data, size_t datalength, celix_properties_t *metadata, char **response, size_t *responseLength);
+bool exportRegistration_isBinary(export_registration_t *export);
 
 void exportRegistration_increaseUsage(export_registration_t *export);
 void exportRegistration_decreaseUsage(export_registration_t *export);
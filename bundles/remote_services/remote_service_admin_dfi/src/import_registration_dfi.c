@@ -18,8 +18,10 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <jansson.h>
 #include <json_rpc.h>
+#include <avrobin_rpc.h>
 #include <assert.h>
 #include "version.h"
 #include "json_serializer.h"
@@ -35,6 +37,7 @@ struct import_registration {
     endpoint_description_t * endpoint; //TODO owner? -> free when destroyed
     const char *classObject; //NOTE owned by endpoint
     version_pt version;
+    bool binary; //true if the endpoint uses the avrobin protocol instead of json
 
     celix_thread_mutex_t mutex; //protects send & sendhandle
     send_func_type send;
@@ -64,7 +67,6 @@ static celix_status_t importRegistration_createProxy(import_registration_t *impo
 static void importRegistration_proxyFunc(void *userData, void *args[], void *returnVal);
 static void importRegistration_destroyProxy(struct service_proxy *proxy);
 static void importRegistration_clearProxies(import_registration_t *import);
-static const char* importRegistration_getUrl(import_registration_t *reg);
 static const char* importRegistration_getServiceName(import_registration_t *reg);
 
 celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoint_description_t *endpoint, const char *classObject, const char* serviceVersion, FILE *logFile, import_registration_t **out) {
@@ -79,6 +81,8 @@ celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoi
         reg->context = context;
         reg->endpoint = endpoint;
         reg->classObject = classObject;
+        const char *protocol = celix_properties_get(endpoint->properties, RSA_DFI_ENDPOINT_PROTOCOL, RSA_DFI_PROTOCOL_JSON);
+        reg->binary = strcmp(protocol, RSA_DFI_PROTOCOL_AVROBIN) == 0;
         reg->proxies = hashMap_create(NULL, NULL, NULL, NULL);
 
         remoteInterceptorsHandler_create(context, &reg->interceptorsHandler);
@@ -217,6 +221,7 @@ static celix_status_t importRegistration_findAndParseInterfaceDescriptor(celix_b
     FILE* descriptor = NULL;
     status = dfi_findDescriptor(context, bundle, name, &descriptor);
     if (status == CELIX_SUCCESS && descriptor != NULL) {
+        //note not shared using the dyn cache, the proxy creates closures which are stored in the dyn functions
         int rc = dynInterface_parse(descriptor, out);
         fclose(descriptor);
         if (rc != 0) {
@@ -330,14 +335,19 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
 
 
     char *invokeRequest = NULL;
-    if (status == CELIX_SUCCESS) {
+    size_t invokeRequestLength = 0;
+    if (status == CELIX_SUCCESS && import->binary) {
+        status = avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, (uint8_t **) &invokeRequest, &invokeRequestLength);
+    } else if (status == CELIX_SUCCESS) {
         status = jsonRpc_prepareInvokeRequest(entry->dynFunc, entry->id, args, &invokeRequest);
+        invokeRequestLength = invokeRequest != NULL ? strlen(invokeRequest) : 0;
         //printf("Need to send following json '%s'\n", invokeRequest);
     }
 
 
     if (status == CELIX_SUCCESS) {
         char *reply = NULL;
+        size_t replyLength = 0;
         int rc = 0;
         //printf("sending request\n");
         celix_properties_t *metadata = NULL;
@@ -345,14 +355,18 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
         if (cont) {
             celixThreadMutex_lock(&import->mutex);
             if (import->send != NULL) {
-                import->send(import->sendHandle, import->endpoint, invokeRequest, metadata, &reply, &rc);
+                import->send(import->sendHandle, import->endpoint, invokeRequest, invokeRequestLength, metadata, &reply, &replyLength, &rc);
             }
             celixThreadMutex_unlock(&import->mutex);
             //printf("request sended. got reply '%s' with status %i\n", reply, rc);
 
             if (rc == 0 && dynFunction_hasReturn(entry->dynFunc)) {
                 //fjprintf("Handling reply '%s'\n", reply);
-                status = jsonRpc_handleReply(entry->dynFunc, reply, args);
+                if (import->binary) {
+                    status = avrobinRpc_handleReply(entry->dynFunc, (const uint8_t *) reply, replyLength, args);
+                } else {
+                    status = jsonRpc_handleReply(entry->dynFunc, reply, args);
+                }
             }
 
             *(int *) returnVal = rc;
@@ -364,12 +378,17 @@ static void importRegistration_proxyFunc(void *userData, void *args[], void *ret
             static int callCount = 0;
             const char *url = importRegistration_getUrl(import);
             const char *svcName = importRegistration_getServiceName(import);
-            fprintf(import->logFile, "REMOTE CALL NR %i\n\turl=%s\n\tservice=%s\n\tpayload=%s\n\treturn_code=%i\n\treply=%s\n",
-                                       callCount, url, svcName, invokeRequest, rc, reply);
+            if (import->binary) {
+                fprintf(import->logFile, "REMOTE CALL NR %i\n\turl=%s\n\tservice=%s\n\tmethod=%s\n\tpayload=<%zu bytes>\n\treturn_code=%i\n\treply=<%zu bytes>\n",
+                                           callCount, url, svcName, entry->id, invokeRequestLength, rc, replyLength);
+            } else {
+                fprintf(import->logFile, "REMOTE CALL NR %i\n\turl=%s\n\tservice=%s\n\tpayload=%s\n\treturn_code=%i\n\treply=%s\n",
+                                           callCount, url, svcName, invokeRequest, rc, reply);
+            }
             fflush(import->logFile);
             callCount += 1;
         }
-        free(invokeRequest); //Allocated by json_dumps in jsonRpc_prepareInvokeRequest
+        free(invokeRequest); //Allocated by json_dumps in jsonRpc_prepareInvokeRequest or by avrobinRpc_prepareInvokeRequest
         free(reply); //Allocated by json_dumps in remoteServiceAdmin_send through curl call
     }
 
@@ -446,7 +465,7 @@ celix_status_t importReference_getImportedService(import_reference_t *reference)
     return status;
 }
 
-static const char* importRegistration_getUrl(import_registration_t *reg) {
+const char* importRegistration_getUrl(import_registration_t *reg) {
     return celix_properties_get(reg->endpoint->properties, RSA_DFI_ENDPOINT_URL, "!Error!");
 }
 
@@ -25,7 +25,7 @@
 
 #include <celix_errno.h>
 
-typedef void (*send_func_type)(void *handle, endpoint_description_t *endpointDescription, char *request, celix_properties_t *metadata, char **reply, int* replyStatus);
+typedef void (*send_func_type)(void *handle, endpoint_description_t *endpointDescription, char *request, size_t requestLength, celix_properties_t *metadata, char **reply, size_t *replyLength, int* replyStatus);
 
 celix_status_t importRegistration_create(celix_bundle_context_t *context, endpoint_description_t *description, const char *classObject, const char* serviceVersion, FILE *logFile,
                                          import_registration_t **import);
@@ -38,6 +38,11 @@ celix_status_t importRegistration_setSendFn(import_registration_t *reg,
 celix_status_t importRegistration_start(import_registration_t *import);
 celix_status_t importRegistration_stop(import_registration_t *import);
 
+/**
+ * Returns the endpoint url of the imported service.
+ */
+const char* importRegistration_getUrl(import_registration_t *import);
+
 celix_status_t importRegistration_getService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **service);
 celix_status_t importRegistration_ungetService(import_registration_t *import, celix_bundle_t *bundle, service_registration_t *registration, void **service);
 
@@ -24,6 +24,8 @@
 
 #include "bundle_activator.h"
 #include "service_registration.h"
+#include "celix_bundle_context.h"
+#include "celix_shell_command.h"
 
 #include "export_registration_dfi.h"
 #include "import_registration_dfi.h"
@@ -32,6 +34,8 @@ struct activator {
 	remote_service_admin_t *admin;
 	remote_service_admin_service_t *adminService;
 	service_registration_t *registration;
+	celix_shell_command_t cmdSvc;
+	long cmdSvcId;
 };
 
 celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **userData) {
@@ -44,6 +48,7 @@ celix_status_t bundleActivator_create(celix_bundle_context_t *context, void **us
 	} else {
 		activator->admin = NULL;
 		activator->registration = NULL;
+		activator->cmdSvcId = -1L;
 
 		*userData = activator;
 	}
@@ -88,6 +93,16 @@ celix_status_t bundleActivator_start(void * userData, celix_bundle_context_t *co
 		}
 	}
 
+	if (status == CELIX_SUCCESS) {
+		activator->cmdSvc.handle = activator->admin;
+		activator->cmdSvc.executeCommand = remoteServiceAdmin_executeCommand;
+		celix_properties_t *props = celix_properties_create();
+		celix_properties_set(props, CELIX_SHELL_COMMAND_NAME, "celix::rsa_dfi");
+		celix_properties_set(props, CELIX_SHELL_COMMAND_USAGE, "rsa_dfi");
+		celix_properties_set(props, CELIX_SHELL_COMMAND_DESCRIPTION, "Print the remote call metrics (per endpoint latency histogram) of the DFI RSA");
+		activator->cmdSvcId = celix_bundleContext_registerService(context, &activator->cmdSvc, CELIX_SHELL_COMMAND_SERVICE_NAME, props);
+	}
+
 	return status;
 }
 
@@ -95,6 +110,7 @@ celix_status_t bundleActivator_stop(void * userData, celix_bundle_context_t *con
     celix_status_t status = CELIX_SUCCESS;
     struct activator *activator = userData;
 
+    celix_bundleContext_unregisterService(context, activator->cmdSvcId);
     serviceRegistration_unregister(activator->registration);
     activator->registration = NULL;
 
@@ -25,6 +25,7 @@
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <string.h>
+#include <time.h>
 #include <uuid/uuid.h>
 #include <curl/curl.h>
 
@@ -35,7 +36,10 @@
 #include "import_registration_dfi.h"
 #include "export_registration_dfi.h"
 #include "remote_service_admin_dfi.h"
+#include "curl_handle_pool.h"
 #include "json_rpc.h"
+#include "avrobin_serializer.h"
+#include "avrobin_rpc.h"
 
 #include "remote_constants.h"
 #include "celix_constants.h"
@@ -94,6 +98,8 @@ struct remote_service_admin {
     pthread_mutex_t curlMutexConnect;
     pthread_mutex_t curlMutexCookie;
     pthread_mutex_t curlMutexDns;
+    curl_handle_pool_t *curlPool;
+    char *protocol;
 };
 
 struct post {
@@ -116,6 +122,13 @@ static const char *data_response_headers =
                 "Content-Type: application/json\r\n"
                 "\r\n";
 
+static const char *binary_data_response_headers =
+        "HTTP/1.1 200 OK\r\n"
+                "Cache: no-cache\r\n"
+                "Content-Type: application/octet-stream\r\n"
+                "Content-Length: %zu\r\n"
+                "\r\n";
+
 static const char *no_content_response_headers =
         "HTTP/1.1 204 OK\r\n";
 
@@ -123,7 +136,7 @@ static const unsigned int DEFAULT_TIMEOUT = 0;
 
 static int remoteServiceAdmin_callback(struct mg_connection *conn);
 static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *props, char *interface, endpoint_description_t **description);
-static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, celix_properties_t *metadata, char **reply, int* replyStatus);
+static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, size_t requestLength, celix_properties_t *metadata, char **reply, size_t *replyLength, int* replyStatus);
 static celix_status_t remoteServiceAdmin_getIpAddress(char* interface, char** ip);
 static size_t remoteServiceAdmin_readCallback(void *ptr, size_t size, size_t nmemb, void *userp);
 static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb, void *userp);
@@ -194,6 +207,8 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
         dynInterface_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
         jsonSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
         jsonRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+        avrobinSerializer_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
+        avrobinRpc_logSetup((void *)remoteServiceAdmin_log, *admin, 1);
 
         long port = celix_bundleContext_getPropertyAsLong(context, RSA_PORT_KEY, RSA_PORT_DEFAULT);
         const char *ip = celix_bundleContext_getProperty(context, RSA_IP_KEY, RSA_IP_DEFAULT);
@@ -216,8 +231,22 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
             free(detectedIp);
         }
 
+        const char *protocol = celix_bundleContext_getProperty(context, RSA_DFI_PROTOCOL_KEY, RSA_DFI_PROTOCOL_DEFAULT);
+        if (strcmp(protocol, RSA_DFI_PROTOCOL_JSON) != 0 && strcmp(protocol, RSA_DFI_PROTOCOL_AVROBIN) != 0) {
+            celix_logHelper_log((*admin)->loghelper, CELIX_LOG_LEVEL_WARNING, "RSA: Unknown protocol '%s', using %s", protocol, RSA_DFI_PROTOCOL_DEFAULT);
+            protocol = RSA_DFI_PROTOCOL_DEFAULT;
+        }
+        (*admin)->protocol = strdup(protocol);
+
+        long poolSize = celix_bundleContext_getPropertyAsLong(context, RSA_DFI_CURL_POOL_SIZE_KEY, RSA_DFI_CURL_POOL_SIZE_DEFAULT);
+        long idleTimeout = celix_bundleContext_getPropertyAsLong(context, RSA_DFI_CURL_IDLE_TIMEOUT_KEY, RSA_DFI_CURL_IDLE_TIMEOUT_DEFAULT);
+        status = curlHandlePool_create((int)poolSize, (int)idleTimeout, &(*admin)->curlPool);
+
         (*admin)->curlShare = curl_share_init();
-        curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        if (poolSize <= 0) {
+            //note pooled curl handles keep their own connection cache, sharing it would serialize all calls on curlMutexConnect
+            curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+        }
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
         curl_share_setopt((*admin)->curlShare, CURLSHOPT_USERDATA, *admin);
@@ -296,10 +325,12 @@ celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin)
 
     free((*admin)->ip);
     free((*admin)->port);
+    free((*admin)->protocol);
     curl_share_cleanup((*admin)->curlShare);
     pthread_mutex_destroy(&(*admin)->curlMutexConnect);
     pthread_mutex_destroy(&(*admin)->curlMutexCookie);
     pthread_mutex_destroy(&(*admin)->curlMutexDns);
+    curlHandlePool_destroy((*admin)->curlPool);
     free(*admin);
 
     *admin = NULL;
@@ -497,15 +528,19 @@ static int remoteServiceAdmin_callback(struct mg_connection *conn) {
             data[datalength] = '\0';
 
             char *response = NULL;
-            int responceLength = 0;
-            int rc = exportRegistration_call(export, data, -1, metadata, &response, &responceLength);
+            size_t responseLength = 0;
+            int rc = exportRegistration_call(export, data, datalength, metadata, &response, &responseLength);
             if (rc != CELIX_SUCCESS) {
                 RSA_LOG_ERROR(rsa, "Error trying to invoke remove service, got error %i\n", rc);
             }
 
             if (rc == CELIX_SUCCESS && response != NULL) {
-                mg_write(conn, data_response_headers, strlen(data_response_headers));
-                mg_write(conn, response, strlen(response));
+                if (exportRegistration_isBinary(export)) {
+                    mg_printf(conn, binary_data_response_headers, responseLength);
+                } else {
+                    mg_write(conn, data_response_headers, strlen(data_response_headers));
+                }
+                mg_write(conn, response, responseLength);
                 free(response);
             } else {
                 mg_write(conn, no_content_response_headers, strlen(no_content_response_headers));
@@ -674,10 +709,8 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
         }
     }
 
-    hash_map_entry_pt entry = hashMap_getEntry(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
-
-    char* key = hashMapEntry_getKey(entry);
-    char *serviceId = (char *) hashMap_remove(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
+    char *serviceId = strdup(celix_properties_get(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID, ""));
+    celix_properties_unset(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID);
     const char *uuid = NULL;
 
     char buf[512];
@@ -699,14 +732,15 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
     celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED, "true");
     celix_properties_set(endpointProperties, OSGI_RSA_SERVICE_IMPORTED_CONFIGS, (char*) RSA_DFI_CONFIGURATION_TYPE);
     celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_URL, url);
+    if (celix_properties_get(endpointProperties, RSA_DFI_ENDPOINT_PROTOCOL, NULL) == NULL) {
+        celix_properties_set(endpointProperties, RSA_DFI_ENDPOINT_PROTOCOL, admin->protocol);
+    }
 
     if (props != NULL) {
-        hash_map_iterator_pt propIter = hashMapIterator_create(props);
-        while (hashMapIterator_hasNext(propIter)) {
-            hash_map_entry_pt entry = hashMapIterator_nextEntry(propIter);
-            celix_properties_set(endpointProperties, (char*)hashMapEntry_getKey(entry), (char*)hashMapEntry_getValue(entry));
+        const char *propKey = NULL;
+        CELIX_PROPERTIES_FOR_EACH(props, propKey) {
+            celix_properties_set(endpointProperties, propKey, celix_properties_get(props, propKey, NULL));
         }
-        hashMapIterator_destroy(propIter);
     }
 
     *endpoint = calloc(1, sizeof(**endpoint));
@@ -722,7 +756,6 @@ static celix_status_t remoteServiceAdmin_createEndpointDescription(remote_servic
         (*endpoint)->properties = endpointProperties;
     }
 
-    free(key);
     free(serviceId);
     free(keys);
 
@@ -857,6 +890,7 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *
         current = arrayList_get(admin->importedServices, i);
         if (current == registration) {
             arrayList_remove(admin->importedServices, i);
+            curlHandlePool_removeEndpoint(admin->curlPool, importRegistration_getUrl(current));
             importRegistration_close(current);
             importRegistration_destroy(current);
             break;
@@ -867,11 +901,11 @@ celix_status_t remoteServiceAdmin_removeImportedService(remote_service_admin_t *
     return status;
 }
 
-static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, celix_properties_t *metadata, char **reply, int* replyStatus) {
+static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description_t *endpointDescription, char *request, size_t requestLength, celix_properties_t *metadata, char **reply, size_t *replyLength, int* replyStatus) {
     remote_service_admin_t * rsa = handle;
     struct post post;
     post.readptr = request;
-    post.size = strlen(request);
+    post.size = requestLength;
     post.read = 0;
 
     struct get get;
@@ -902,7 +936,7 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
     CURL *curl;
     CURLcode res;
 
-    curl = curl_easy_init();
+    curl = curlHandlePool_acquire(rsa->curlPool, url);
     if(!curl) {
         status = CELIX_ILLEGAL_STATE;
     } else {
@@ -923,6 +957,7 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
         }
 
         curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1);
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout);
         curl_easy_setopt(curl, CURLOPT_URL, url);
         curl_easy_setopt(curl, CURLOPT_POST, 1L);
@@ -933,12 +968,18 @@ static celix_status_t remoteServiceAdmin_send(void *handle, endpoint_description
         curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (curl_off_t)post.size);
         curl_easy_setopt(curl, CURLOPT_SHARE, rsa->curlShare);
         //celix_logHelper_log(rsa->loghelper, CELIX_LOG_LEVEL_DEBUG, "RSA: Performing curl post\n");
+        struct timespec start;
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
         res = curl_easy_perform(curl);
+        clock_gettime(CLOCK_MONOTONIC, &end);
 
         *reply = get.writeptr;
+        *replyLength = get.size;
         *replyStatus = res;
 
-        curl_easy_cleanup(curl);
+        long durationInUs = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_nsec - start.tv_nsec) / 1000L;
+        curlHandlePool_release(rsa->curlPool, url, curl, res, durationInUs);
         curl_slist_free_all(metadataHeader);
     }
 
@@ -962,12 +1003,14 @@ static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb
     size_t realsize = size * nmemb;
     struct get *mem = (struct get *)userp;
 
-    mem->writeptr =malloc(realsize + 1);
-    if (mem->writeptr == NULL) {
+    //note a reply can be received in multiple chunks
+    char *newptr = realloc(mem->writeptr, mem->size + realsize + 1);
+    if (newptr == NULL) {
         /* out of memory! */
-        fprintf(stderr, "not enough memory (malloc returned NULL)");
+        fprintf(stderr, "not enough memory (realloc returned NULL)");
         return 0;
     } else {
+        mem->writeptr = newptr;
         memcpy(&(mem->writeptr[mem->size]), contents, realsize);
         mem->size += realsize;
         mem->writeptr[mem->size] = 0;
@@ -976,6 +1019,14 @@ static size_t remoteServiceAdmin_write(void *contents, size_t size, size_t nmemb
 }
 
 
+bool remoteServiceAdmin_executeCommand(void *handle, const char *commandLine __attribute__((unused)), FILE *out, FILE *errStream __attribute__((unused))) {
+    remote_service_admin_t *admin = handle;
+    fprintf(out, "\n");
+    curlHandlePool_printMetrics(admin->curlPool, out);
+    fprintf(out, "\n");
+    return true;
+}
+
 static void remoteServiceAdmin_log(remote_service_admin_t *admin, int level, const char *file, int line, const char *msg, ...) {
     va_list ap;
     va_start(ap, msg);
@@ -21,6 +21,9 @@
 #define REMOTE_SERVICE_ADMIN_HTTP_IMPL_H_
 
 
+#include <stdio.h>
+#include <stdbool.h>
+
 #include "bundle_context.h"
 #include "endpoint_description.h"
 #include "export_registration_dfi.h"
@@ -50,4 +53,6 @@ celix_status_t importReference_getImportedService(import_reference_t *reference)
 
 celix_status_t remoteServiceAdmin_destroyEndpointDescription(endpoint_description_t **description);
 
+bool remoteServiceAdmin_executeCommand(void *handle, const char *commandLine, FILE *out, FILE *errStream);
+
 #endif /* REMOTE_SERVICE_ADMIN_HTTP_IMPL_H_ */
@@ -33,11 +33,38 @@
 #define RSA_LOG_CALLS_FILE_KEY          "RSA_LOG_CALLS_FILE"
 #define RSA_LOG_CALLS_FILE_DEFAULT      "stdout"
 
+/**
+ * The max number of idle curl handles (and kept-alive connections) kept per imported endpoint url.
+ * 0 disables pooling, a new curl handle is then created for every remote call.
+ */
+#define RSA_DFI_CURL_POOL_SIZE_KEY          "RSA_DFI_CURL_POOL_SIZE"
+#define RSA_DFI_CURL_POOL_SIZE_DEFAULT      8
+
+/**
+ * The time in seconds after which an idle curl handle and its connection is cleaned up.
+ */
+#define RSA_DFI_CURL_IDLE_TIMEOUT_KEY       "RSA_DFI_CURL_IDLE_TIMEOUT"
+#define RSA_DFI_CURL_IDLE_TIMEOUT_DEFAULT   30
+
+/**
+ * The wire protocol used for services exported by this rsa: "json" (json_rpc) or "avrobin" (avrobin_rpc).
+ * Can be overridden per service with the RSA_DFI_ENDPOINT_PROTOCOL service property.
+ */
+#define RSA_DFI_PROTOCOL_KEY                "RSA_DFI_PROTOCOL"
+#define RSA_DFI_PROTOCOL_DEFAULT            RSA_DFI_PROTOCOL_JSON
+
+#define RSA_DFI_PROTOCOL_JSON               "json"
+#define RSA_DFI_PROTOCOL_AVROBIN            "avrobin"
+
 
 
 
 #define RSA_DFI_CONFIGURATION_TYPE      "org.amdatu.remote.admin.http"
 #define RSA_DFI_ENDPOINT_URL            "org.amdatu.remote.admin.http.url"
+/**
+ * Endpoint property with the wire protocol of the endpoint. Endpoints without this property use json.
+ */
+#define RSA_DFI_ENDPOINT_PROTOCOL       "org.amdatu.remote.admin.http.protocol"
 
 
 
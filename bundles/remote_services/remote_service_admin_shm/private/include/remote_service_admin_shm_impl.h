@@ -29,16 +29,29 @@
 
 #include "remote_service_admin_impl.h"
 #include "log_helper.h"
+#include "rsa_shm_ring.h"
 
-#define RSA_SHM_MEMSIZE 1310720
 #define RSA_SHM_PATH_PROPERTYNAME "shmPath"
-#define RSA_SEM_PATH_PROPERTYNAME "semPath"
 #define RSA_SHM_FTOK_ID_PROPERTYNAME "shmFtokId"
-#define RSA_SEM_FTOK_ID_PROPERTYNAME "semFtokId"
+#define RSA_SHM_NR_OF_SLOTS_PROPERTYNAME "shmNrOfSlots"
+#define RSA_SHM_SLOT_SIZE_PROPERTYNAME "shmSlotSize"
 #define RSA_SHM_DEFAULTPATH "/dev/null"
-#define RSA_SEM_DEFAULTPATH "/dev/null"
 #define RSA_SHM_DEFAULT_FTOK_ID "52"
-#define RSA_SEM_DEFAULT_FTOK_ID "54"
+
+/**
+ * Config properties for the request/response ring of exported services.
+ * The nr of slots is the max nr of concurrent calls, requests and replies larger than the slot size are written in
+ * an overflow segment. The nr of threads is the nr of exporter threads handling calls per exported service.
+ * The call timeout (in ms) is the max time an importer waits for a free slot and the reply of a call.
+ */
+#define RSA_SHM_NR_OF_SLOTS_KEY "RSA_SHM_NR_OF_SLOTS"
+#define RSA_SHM_DEFAULT_NR_OF_SLOTS 16
+#define RSA_SHM_SLOT_SIZE_KEY "RSA_SHM_SLOT_SIZE"
+#define RSA_SHM_DEFAULT_SLOT_SIZE 65536
+#define RSA_SHM_NR_OF_THREADS_KEY "RSA_SHM_NR_OF_THREADS"
+#define RSA_SHM_DEFAULT_NR_OF_THREADS 4
+#define RSA_SHM_CALL_TIMEOUT_KEY "RSA_SHM_CALL_TIMEOUT"
+#define RSA_SHM_DEFAULT_CALL_TIMEOUT 30000
 
 #define RSA_FILEPATH_LENGTH 255
 
@@ -47,22 +60,17 @@
 #define P_tmpdir "/tmp"
 #endif
 
-union semun {
-    int val; /* Value for SETVAL */
-    struct semid_ds *buf; /* Buffer for IPC_STAT, IPC_SET */
-    unsigned short *array; /* Array for GETALL, SETALL */
-    struct seminfo *__buf; /* Buffer for IPC_INFO */
-};
-
 struct recv_shm_thread {
     remote_service_admin_t *admin;
     endpoint_description_t *endpointDescription;
+    export_registration_t *exportRegistration; //closed only after the receive threads are joined
+    unsigned int threadIndex;
 };
 
 struct ipc_segment {
-    int semId;
     int shmId;
     void *shmBaseAddress;
+    rsa_shm_ring_t *ring;
 };
 
 struct remote_service_admin {
@@ -78,9 +86,14 @@ struct remote_service_admin {
     hash_map_pt exportedIpcSegment;
     hash_map_pt importedIpcSegment;
 
-    hash_map_pt pollThread;
+    hash_map_pt pollThread; //value is an array of nrOfThreads threads
     hash_map_pt pollThreadRunning;
 
+    unsigned int nrOfSlots;
+    size_t slotSize;
+    unsigned int nrOfThreads;
+    unsigned int callTimeoutInMs;
+
     struct mg_context *ctx;
 };
 
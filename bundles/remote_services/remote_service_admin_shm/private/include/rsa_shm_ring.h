@@ -0,0 +1,98 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * rsa_shm_ring.h
+ *
+ * Request/response ring used by the shared memory remote service admin.
+ *
+ * The ring lives in the shared memory segment of an exported service and consists of a control block followed by a
+ * fixed number of slots. Every call claims a free slot, writes the request in the slot and waits (futex) on the slot
+ * until the exporter has written the reply in the same slot. Because every call has its own slot, multiple callers
+ * (threads or processes) can have a call in flight and multiple exporter threads can handle calls concurrently.
+ *
+ * Requests and replies which do not fit in a slot are written in a private overflow shared memory segment (only
+ * accessible for the same user), only the id of the overflow segment is written in the slot. Overflow segments are
+ * removed by the reader.
+ *
+ * Every call has a deadline. A caller gives up at its deadline, if the ring is stopped or if the exporter is gone (none
+ * of the exporter threads polled the ring for 10s). The slot of a caller which died is reclaimed by another caller
+ * when the deadline of the call has passed.
+ */
+
+#ifndef RSA_SHM_RING_H_
+#define RSA_SHM_RING_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "celix_errno.h"
+
+typedef struct rsa_shm_ring rsa_shm_ring_t; //opaque type, located at the start of the shared memory segment
+
+/**
+ * Handles a request, the reply must be allocated with malloc and is freed by the ring.
+ * @return The reply status, which is returned to the caller.
+ */
+typedef int (*rsa_shm_ring_handle_request_fp)(void *handle, const char *request, char **reply);
+
+/**
+ * The size of the shared memory segment needed for a ring with the provided nr of slots and slot size.
+ */
+size_t rsaShmRing_segmentSize(unsigned int nrOfSlots, size_t slotSize);
+
+/**
+ * Initializes a ring in the provided shared memory. Called by the exporter of the service.
+ * The shared memory should be at least rsaShmRing_segmentSize big.
+ */
+rsa_shm_ring_t* rsaShmRing_init(void *shmBaseAddress, unsigned int nrOfSlots, size_t slotSize);
+
+/**
+ * Returns the ring in the provided (attached) shared memory. Called by the importer of the service.
+ * Returns NULL if the shared memory does not contain an initialized ring with the provided nr of slots and slot size.
+ */
+rsa_shm_ring_t* rsaShmRing_attach(void *shmBaseAddress, unsigned int nrOfSlots, size_t slotSize);
+
+/**
+ * Sends a request and waits for the reply. Can be called concurrently, waits for a free slot if all slots are in use.
+ *
+ * @param timeoutInMs The max time to wait for a free slot and the reply.
+ * @param reply The reply, allocated with malloc. The caller is owner of the reply.
+ * @param replyStatus The reply status returned by the request handler of the exporter.
+ * @return CELIX_SUCCESS, CELIX_ILLEGAL_STATE if the ring is stopped, the exporter is gone or the call timed out, or
+ * CELIX_BUNDLE_EXCEPTION if an overflow segment could not be created or read.
+ */
+celix_status_t rsaShmRing_call(rsa_shm_ring_t *ring, const char *request, int timeoutInMs, char **reply, int *replyStatus);
+
+/**
+ * Handles the next pending request with the provided request handler. Waits max timeoutInMs if no request is pending.
+ * Can be called concurrently by multiple exporter threads. Every call signals that the exporter is alive, so the
+ * exporter threads should call this repeatedly with a timeout well below 10s.
+ *
+ * @param cursor The slot to start searching for a pending request, updated by the call. Every exporter thread should
+ * use its own cursor.
+ * @return true if a request is handled.
+ */
+bool rsaShmRing_handleRequest(rsa_shm_ring_t *ring, unsigned int *cursor, int timeoutInMs, rsa_shm_ring_handle_request_fp handleRequest, void *handle);
+
+/**
+ * Stops the ring. Wakes up all exporter threads and all callers; pending and new calls return CELIX_ILLEGAL_STATE.
+ */
+void rsaShmRing_stop(rsa_shm_ring_t *ring);
+
+#endif /* RSA_SHM_RING_H_ */
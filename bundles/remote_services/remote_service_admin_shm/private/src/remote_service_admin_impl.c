@@ -30,7 +30,6 @@
 #include <dirent.h>
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/sem.h>
 #include <sys/ipc.h>
 #include <sys/shm.h>
 #include <unistd.h>
@@ -49,9 +48,9 @@
 #include "service_reference.h"
 #include "service_registration.h"
 
-static celix_status_t remoteServiceAdmin_lock(int semId, int semNr);
-static celix_status_t remoteServiceAdmin_unlock(int semId, int semNr);
-static int remoteServiceAdmin_getCount(int semId, int semNr);
+#define RSA_SHM_POLL_TIMEOUT_IN_MS 1000
+
+static unsigned int remoteServiceAdmin_getConfig(celix_bundle_context_t *context, const char *key, unsigned int defaultValue);
 
 celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin, export_registration_t *registration, service_reference_pt reference, char *interface);
 celix_status_t remoteServiceAdmin_createEndpointDescription(remote_service_admin_t *admin, service_reference_pt reference, celix_properties_t *endpointProperties, char *interface, endpoint_description_t **description);
@@ -80,6 +79,10 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
 		(*admin)->importedIpcSegment = hashMap_create(NULL, NULL, NULL, NULL);
 		(*admin)->pollThread = hashMap_create(NULL, NULL, NULL, NULL);
 		(*admin)->pollThreadRunning = hashMap_create(NULL, NULL, NULL, NULL);
+		(*admin)->nrOfSlots = remoteServiceAdmin_getConfig(context, RSA_SHM_NR_OF_SLOTS_KEY, RSA_SHM_DEFAULT_NR_OF_SLOTS);
+		(*admin)->slotSize = remoteServiceAdmin_getConfig(context, RSA_SHM_SLOT_SIZE_KEY, RSA_SHM_DEFAULT_SLOT_SIZE);
+		(*admin)->nrOfThreads = remoteServiceAdmin_getConfig(context, RSA_SHM_NR_OF_THREADS_KEY, RSA_SHM_DEFAULT_NR_OF_THREADS);
+		(*admin)->callTimeoutInMs = remoteServiceAdmin_getConfig(context, RSA_SHM_CALL_TIMEOUT_KEY, RSA_SHM_DEFAULT_CALL_TIMEOUT);
 
 		if (logHelper_create(context, &(*admin)->loghelper) == CELIX_SUCCESS) {
 		}
@@ -88,6 +91,11 @@ celix_status_t remoteServiceAdmin_create(celix_bundle_context_t *context, remote
 	return status;
 }
 
+static unsigned int remoteServiceAdmin_getConfig(celix_bundle_context_t *context, const char *key, unsigned int defaultValue) {
+	long value = celix_bundleContext_getPropertyAsLong(context, key, defaultValue);
+	return value > 0 ? (unsigned int) value : defaultValue;
+}
+
 celix_status_t remoteServiceAdmin_destroy(remote_service_admin_t **admin) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -159,21 +167,23 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 	}
 	hashMapIterator_destroy(iter);
 
-	// release lock
+	// wake up the poll threads and the waiting callers
 	iter = hashMapIterator_create(admin->exportedIpcSegment);
 	while (hashMapIterator_hasNext(iter)) {
 		ipc_segment_pt ipc = hashMapIterator_nextValue(iter);
-		remoteServiceAdmin_unlock(ipc->semId, 1);
+		rsaShmRing_stop(ipc->ring);
 	}
 	hashMapIterator_destroy(iter);
 
 	// wait till threads has stopped
 	iter = hashMapIterator_create(admin->pollThread);
 	while (hashMapIterator_hasNext(iter)) {
-		celix_thread_t *pollThread = hashMapIterator_nextValue(iter);
+		celix_thread_t *pollThreads = hashMapIterator_nextValue(iter);
 
-		if (pollThread != NULL) {
-			status = celixThread_join(*pollThread, NULL);
+		if (pollThreads != NULL) {
+			for (unsigned int i = 0; i < admin->nrOfThreads; i++) {
+				status = celixThread_join(pollThreads[i], NULL);
+			}
 		}
 	}
 	hashMapIterator_destroy(iter);
@@ -200,96 +210,17 @@ celix_status_t remoteServiceAdmin_stop(remote_service_admin_t *admin) {
 	return status;
 }
 
-static int remoteServiceAdmin_getCount(int semId, int semNr) {
-	int token = -1;
-	unsigned short semVals[3];
-	union semun semArg;
-
-	semArg.array = semVals;
-
-	if (semctl(semId, 0, GETALL, semArg) == 0) {
-		token = semArg.array[semNr];
-	}
-
-	return token;
-}
-
-static celix_status_t remoteServiceAdmin_lock(int semId, int semNr) {
-	celix_status_t status = CELIX_SUCCESS;
-	int semOpStatus = 0;
-	struct sembuf semOperation;
-
-	semOperation.sem_num = semNr;
-	semOperation.sem_op = -1;
-	semOperation.sem_flg = 0;
-
-	do {
-		status = CELIX_SUCCESS;
-
-		if ((semOpStatus = semop(semId, &semOperation, 1)) != 0) {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} while (semOpStatus == -1 && errno == EINTR);
-
-	return status;
-}
-
-static celix_status_t remoteServiceAdmin_unlock(int semId, int semNr) {
-	celix_status_t status = CELIX_SUCCESS;
-	int semOpStatus = 0;
-	struct sembuf semOperation;
-
-	semOperation.sem_num = semNr;
-	semOperation.sem_op = 1;
-	semOperation.sem_flg = 0;
-
-	do {
-		status = CELIX_SUCCESS;
-
-		if ((semOpStatus = semop(semId, &semOperation, 1)) != 0) {
-			status = CELIX_BUNDLE_EXCEPTION;
-		}
-	} while (semOpStatus == -1 && errno == EINTR);
-
-	return status;
-}
-
 celix_status_t remoteServiceAdmin_send(remote_service_admin_t *admin, endpoint_description_t *recpEndpoint, char *request, char **reply, int *replyStatus) {
 	celix_status_t status = CELIX_SUCCESS;
 	ipc_segment_pt ipc = NULL;
 
 	if ((ipc = hashMap_get(admin->importedIpcSegment, recpEndpoint->service)) != NULL) {
-		int semid = ipc->semId;
+		/* claim a slot, write the request and wait for the reply */
+		status = rsaShmRing_call(ipc->ring, request, (int) admin->callTimeoutInMs, reply, replyStatus);
 
-		/* lock critical area */
-		remoteServiceAdmin_lock(semid, 0);
-
-		/* write method and data */
-		strcpy(ipc->shmBaseAddress, request);
-
-		/* Check the status of the send-receive semaphore and reset them if not correct */
-		if (remoteServiceAdmin_getCount(ipc->semId, 1) > 0) {
-			semctl(semid, 1, SETVAL, (int) 0);
-		}
-		if (remoteServiceAdmin_getCount(ipc->semId, 2) > 0) {
-			semctl(semid, 2, SETVAL, (int) 0);
+		if (status != CELIX_SUCCESS) {
+			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "Error while calling remote service %s.", recpEndpoint->service);
 		}
-
-		/* Inform receiver we are invoking the remote service */
-		remoteServiceAdmin_unlock(semid, 1);
-
-		/* Wait until the receiver finished his operations */
-		remoteServiceAdmin_lock(semid, 2);
-
-		/* read reply */
-		*reply = strdup(ipc->shmBaseAddress);
-
-		/* TODO: fix replyStatus */
-		*replyStatus = 0;
-
-		/* release critical area */
-		remoteServiceAdmin_unlock(semid, 0);
-
 	} else {
 		status = CELIX_ILLEGAL_STATE; /* could not find ipc segment */
 	}
@@ -297,6 +228,24 @@ celix_status_t remoteServiceAdmin_send(remote_service_admin_t *admin, endpoint_d
 	return status;
 }
 
+static int remoteServiceAdmin_handleRequest(void *handle, const char *request, char **reply) {
+	recv_shm_thread_pt thread_data = handle;
+	export_registration_t *export = thread_data->exportRegistration;
+	int replyStatus = CELIX_ILLEGAL_STATE;
+
+	// note the exportedServicesLock is not taken, removeExportedService holds it while joining the receive threads.
+	// The export registration of the thread is only closed after the receive threads are joined.
+	if (export->endpoint != NULL) {
+		char *data = strdup(request);
+		replyStatus = export->endpoint->handleRequest(export->endpoint->endpoint, data, reply);
+		free(data);
+	} else {
+		logHelper_log(thread_data->admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : No endpoint set for %s.", export->endpointDescription->service);
+	}
+
+	return replyStatus;
+}
+
 static void * remoteServiceAdmin_receiveFromSharedMemory(void *data) {
 	recv_shm_thread_pt thread_data = data;
 
@@ -307,49 +256,11 @@ static void * remoteServiceAdmin_receiveFromSharedMemory(void *data) {
 
 	if ((ipc = hashMap_get(admin->exportedIpcSegment, exportedEndpointDesc->service)) != NULL) {
 		bool *pollThreadRunning = hashMap_get(admin->pollThreadRunning, exportedEndpointDesc);
+		// note every thread starts searching for requests at a different slot
+		unsigned int cursor = thread_data->threadIndex;
 
 		while (*pollThreadRunning == true) {
-			if ((remoteServiceAdmin_lock(ipc->semId, 1) == CELIX_SUCCESS) && (*pollThreadRunning == true)) {
-
-				// TODO: align data size
-				char *data = calloc(1024, sizeof(*data));
-				strcpy(data, ipc->shmBaseAddress);
-
-				hash_map_iterator_pt iter = hashMapIterator_create(admin->exportedServices);
-
-				while (hashMapIterator_hasNext(iter)) {
-					hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-					array_list_pt exports = hashMapEntry_getValue(entry);
-					int expIt = 0;
-
-					for (expIt = 0; expIt < arrayList_size(exports); expIt++) {
-						export_registration_t *export = arrayList_get(exports, expIt);
-
-						if ((strcmp(exportedEndpointDesc->service, export->endpointDescription->service) == 0) && (export->endpoint != NULL)) {
-							char *reply = NULL;
-
-							/* TODO: fix handling of handleRequest return value*/
-									export->endpoint->handleRequest(export->endpoint->endpoint, data, &reply);
-
-									if (reply != NULL) {
-										if ((strlen(reply) * sizeof(char)) >= RSA_SHM_MEMSIZE) {
-											logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : size of message bigger than shared memory message. NOT SENDING.");
-										} else {
-											strcpy(ipc->shmBaseAddress, reply);
-										}
-										free(reply);
-									}
-						} else {
-							logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "receiveFromSharedMemory : No endpoint set for %s.", export->endpointDescription->service);
-						}
-					}
-				}
-				hashMapIterator_destroy(iter);
-				free(data);
-
-				remoteServiceAdmin_unlock(ipc->semId, 2);
-
-			}
+			rsaShmRing_handleRequest(ipc->ring, &cursor, RSA_SHM_POLL_TIMEOUT_IN_MS, remoteServiceAdmin_handleRequest, thread_data);
 		}
 	}
 
@@ -528,25 +439,29 @@ celix_status_t remoteServiceAdmin_exportService(remote_service_admin_t *admin, c
 				exportRegistration_startTracking(registration);
 
 				if (remoteServiceAdmin_createOrAttachShm(admin->exportedIpcSegment, admin, registration->endpointDescription, true) == CELIX_SUCCESS) {
-					recv_shm_thread_pt recvThreadData = NULL;
+					celix_thread_t* pollThreads = calloc(admin->nrOfThreads, sizeof(*pollThreads));
+					bool *pollThreadRunningPtr = calloc(1, sizeof(*pollThreadRunningPtr));
+					*pollThreadRunningPtr = true;
 
-					if ((recvThreadData = calloc(1, sizeof(*recvThreadData))) == NULL) {
-						status = CELIX_ENOMEM;
-					} else {
-						recvThreadData->admin = admin;
-						recvThreadData->endpointDescription = registration->endpointDescription;
+					hashMap_put(admin->pollThreadRunning, registration->endpointDescription, pollThreadRunningPtr);
 
-						celix_thread_t* pollThread = calloc(1, sizeof(*pollThread));
-						bool *pollThreadRunningPtr = calloc(1, sizeof(*pollThreadRunningPtr));
-						*pollThreadRunningPtr = true;
+					// start receiving threads, the calls in the slots of the ring are handled concurrently
+					for (unsigned int i = 0; i < admin->nrOfThreads; i++) {
+						recv_shm_thread_pt recvThreadData = NULL;
 
-						hashMap_put(admin->pollThreadRunning, registration->endpointDescription, pollThreadRunningPtr);
-
-						// start receiving thread
-						status = celixThread_create(pollThread, NULL, remoteServiceAdmin_receiveFromSharedMemory, recvThreadData);
+						if ((recvThreadData = calloc(1, sizeof(*recvThreadData))) == NULL) {
+							status = CELIX_ENOMEM;
+						} else {
+							recvThreadData->admin = admin;
+							recvThreadData->endpointDescription = registration->endpointDescription;
+							recvThreadData->exportRegistration = registration;
+							recvThreadData->threadIndex = i;
 
-						hashMap_put(admin->pollThread, registration->endpointDescription, pollThread);
+							status = celixThread_create(&pollThreads[i], NULL, remoteServiceAdmin_receiveFromSharedMemory, recvThreadData);
+						}
 					}
+
+					hashMap_put(admin->pollThread, registration->endpointDescription, pollThreads);
 				}
 			}
 
@@ -583,21 +498,23 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 			arrayList_destroy(exports);
 		}
 
-		exportRegistration_close(registration);
-
 		if ((pollThreadRunning = hashMap_get(admin->pollThreadRunning, registration->endpointDescription)) != NULL) {
 			*pollThreadRunning = false;
 
 			if ((ipc = hashMap_get(admin->exportedIpcSegment, registration->endpointDescription->service)) != NULL) {
-				celix_thread_t* pollThread;
+				celix_thread_t* pollThreads;
 
-				remoteServiceAdmin_unlock(ipc->semId, 1);
+				rsaShmRing_stop(ipc->ring);
 
-				if ((pollThread = hashMap_get(admin->pollThread, registration->endpointDescription)) != NULL) {
-					status = celixThread_join(*pollThread, NULL);
+				if ((pollThreads = hashMap_get(admin->pollThread, registration->endpointDescription)) != NULL) {
+					for (unsigned int i = 0; i < admin->nrOfThreads; i++) {
+						celix_status_t joinStatus = celixThread_join(pollThreads[i], NULL);
+						if (joinStatus != CELIX_SUCCESS) {
+							status = joinStatus;
+						}
+					}
 
 					if (status == CELIX_SUCCESS) {
-						semctl(ipc->semId, 1 , IPC_RMID);
 						shmctl(ipc->shmId, IPC_RMID, 0);
 
 						remoteServiceAdmin_removeSharedIdentityFile(admin, registration->endpointDescription->frameworkUUID, registration->endpointDescription->service);
@@ -607,12 +524,14 @@ celix_status_t remoteServiceAdmin_removeExportedService(remote_service_admin_t *
 						hashMap_remove(admin->pollThread, registration->endpointDescription);
 
 						free(pollThreadRunning);
-						free(pollThread);
+						free(pollThreads);
 						free(ipc);
 					}
 				}
 			}
 		}
+		// note closed after the receive threads are joined, the threads use the endpoint of the registration
+		exportRegistration_close(registration);
 		exportRegistration_destroy(&registration);
 	}
 
@@ -636,7 +555,7 @@ celix_status_t remoteServiceAdmin_detachIpcSegment(ipc_segment_pt ipc) {
 }
 
 celix_status_t remoteServiceAdmin_deleteIpcSegment(ipc_segment_pt ipc) {
-	return ((semctl(ipc->semId, 1 /*ignored*/, IPC_RMID) != -1) && (shmctl(ipc->shmId, IPC_RMID, 0) != -1)) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
+	return (shmctl(ipc->shmId, IPC_RMID, 0) != -1) ? CELIX_SUCCESS : CELIX_BUNDLE_EXCEPTION;
 }
 
 celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remote_service_admin_t *admin, endpoint_description_t *endpointDescription, bool createIfNotFound) {
@@ -650,8 +569,9 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 	char *shmPath = NULL;
 	char *shmFtokId = NULL;
 
-	char *semPath = NULL;
-	char *semFtokId = NULL;
+	long nrOfSlots = 0;
+	long slotSize = 0;
+	size_t shmSize = 0;
 
 	if ((shmPath = (char*)properties_get(endpointProperties, (char *) RSA_SHM_PATH_PROPERTYNAME)) == NULL) {
 		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SHM_PATH_PROPERTYNAME);
@@ -659,24 +579,25 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 	} else if ((shmFtokId = (char*)properties_get(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME)) == NULL) {
 		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SHM_FTOK_ID_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
-	} else if ((semPath = (char*)properties_get(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME)) == NULL) {
-		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SEM_PATH_PROPERTYNAME);
+	} else if ((nrOfSlots = celix_properties_getAsLong(endpointProperties, RSA_SHM_NR_OF_SLOTS_PROPERTYNAME, 0)) <= 0) {
+		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No valid value found for key %s in endpointProperties.", RSA_SHM_NR_OF_SLOTS_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
-	} else if ((semFtokId = (char*)properties_get(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME)) == NULL) {
-		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No value found for key %s in endpointProperties.", RSA_SEM_FTOK_ID_PROPERTYNAME);
+	} else if ((slotSize = celix_properties_getAsLong(endpointProperties, RSA_SHM_SLOT_SIZE_PROPERTYNAME, 0)) <= 0) {
+		logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "No valid value found for key %s in endpointProperties.", RSA_SHM_SLOT_SIZE_PROPERTYNAME);
 		status = CELIX_BUNDLE_EXCEPTION;
 	} else {
 		key_t shmKey = ftok(shmPath, atoi(shmFtokId));
+		shmSize = rsaShmRing_segmentSize((unsigned int) nrOfSlots, (size_t) slotSize);
 		ipc = calloc(1, sizeof(*ipc));
 		if(ipc == NULL){
 			return CELIX_ENOMEM;
 		}
 
-		if ((ipc->shmId = shmget(shmKey, RSA_SHM_MEMSIZE, 0666)) < 0) {
+		if ((ipc->shmId = shmget(shmKey, shmSize, 0666)) < 0) {
 			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_WARNING, "Could not attach to shared memory");
 
 			if (createIfNotFound == true) {
-				if ((ipc->shmId = shmget(shmKey, RSA_SHM_MEMSIZE, IPC_CREAT | 0666)) < 0) {
+				if ((ipc->shmId = shmget(shmKey, shmSize, IPC_CREAT | 0666)) < 0) {
 					logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "Creation of shared memory segment failed.");
 					status = CELIX_BUNDLE_EXCEPTION;
 				} else if ((ipc->shmBaseAddress = shmat(ipc->shmId, 0, 0)) == (char *) -1) {
@@ -685,6 +606,8 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 				} else {
 					logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_INFO, "shared memory segment successfully created at %p.", ipc->shmBaseAddress);
 				}
+			} else {
+				status = CELIX_BUNDLE_EXCEPTION;
 			}
 		} else if ((ipc->shmBaseAddress = shmat(ipc->shmId, 0, 0)) == (char *) -1) {
 			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "Attaching to shared memory segment failed.");
@@ -695,23 +618,19 @@ celix_status_t remoteServiceAdmin_createOrAttachShm(hash_map_pt ipcSegment, remo
 	}
 
 	if(ipc != NULL && status == CELIX_SUCCESS){
+		// only initialize the ring if a create was supposed, otherwise use the ring of the exporter
+		if (createIfNotFound == true) {
+			ipc->ring = rsaShmRing_init(ipc->shmBaseAddress, (unsigned int) nrOfSlots, (size_t) slotSize);
+		} else {
+			ipc->ring = rsaShmRing_attach(ipc->shmBaseAddress, (unsigned int) nrOfSlots, (size_t) slotSize);
+		}
 
-		key_t semkey = ftok(semPath, atoi(semFtokId));
-		int semflg = (createIfNotFound == true) ? (0666 | IPC_CREAT) : (0666);
-		int semid = semget(semkey, 3, semflg);
-
-		if (semid != -1) {
-			// only reset semaphores if a create was supposed
-			if ((createIfNotFound == true) && ((semctl(semid, 0, SETVAL, (int) 1) == -1) || (semctl(semid, 1, SETVAL, (int) 0) == -1) || (semctl(semid, 2, SETVAL, (int) 0) == -1))) {
-				logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "error while initialize semaphores.");
-			}
-
-			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "semaphores w/ key %s and id %i added.", endpointDescription->service, semid);
-			ipc->semId = semid;
-
+		if (ipc->ring != NULL) {
+			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_DEBUG, "ring w/ key %s, %li slots of %li bytes added.", endpointDescription->service, nrOfSlots, slotSize);
 			hashMap_put(ipcSegment, endpointDescription->service, ipc);
 		} else {
-			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "error getting semaphores.");
+			logHelper_log(admin->loghelper, CELIX_LOG_LEVEL_ERROR, "no valid ring in shared memory segment for %s.", endpointDescription->service);
+			remoteServiceAdmin_detachIpcSegment(ipc);
 			status = CELIX_BUNDLE_EXCEPTION;
 		}
 	}
@@ -740,10 +659,8 @@ celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin,
 		}
 	}
 
-	hash_map_entry_pt entry = hashMap_getEntry(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
-
-	char* key = hashMapEntry_getKey(entry);
-	char *serviceId = (char *) hashMap_remove(endpointProperties, (void *) OSGI_FRAMEWORK_SERVICE_ID);
+	char *serviceId = strdup(celix_properties_get(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID, ""));
+	celix_properties_unset(endpointProperties, OSGI_FRAMEWORK_SERVICE_ID);
 	const char *uuid = NULL;
 
 	uuid_t endpoint_uid;
@@ -771,24 +688,17 @@ celix_status_t remoteServiceAdmin_installEndpoint(remote_service_admin_t *admin,
 	if (celix_properties_get(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME, NULL) == NULL) {
 		celix_properties_set(endpointProperties, (char *) RSA_SHM_FTOK_ID_PROPERTYNAME, (char *) RSA_SHM_DEFAULT_FTOK_ID);
 	}
-	if (celix_properties_get(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, NULL) == NULL) {
-		char sharedIdentifierFile[RSA_FILEPATH_LENGTH];
-
-		if (remoteServiceAdmin_getSharedIdentifierFile(admin, (char*)uuid, interface, sharedIdentifierFile) == CELIX_SUCCESS) {
-			celix_properties_set(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, sharedIdentifierFile);
-		} else {
-			celix_properties_set(endpointProperties, (char *) RSA_SEM_PATH_PROPERTYNAME, (char *) RSA_SEM_DEFAULTPATH);
-		}
+	if (celix_properties_get(endpointProperties, (char *) RSA_SHM_NR_OF_SLOTS_PROPERTYNAME, NULL) == NULL) {
+		celix_properties_setLong(endpointProperties, RSA_SHM_NR_OF_SLOTS_PROPERTYNAME, admin->nrOfSlots);
 	}
-	if (celix_properties_get(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME, NULL) == NULL) {
-		celix_properties_set(endpointProperties, (char *) RSA_SEM_FTOK_ID_PROPERTYNAME, (char *) RSA_SEM_DEFAULT_FTOK_ID);
+	if (celix_properties_get(endpointProperties, (char *) RSA_SHM_SLOT_SIZE_PROPERTYNAME, NULL) == NULL) {
+		celix_properties_setLong(endpointProperties, RSA_SHM_SLOT_SIZE_PROPERTYNAME, (long) admin->slotSize);
 	}
 
 	endpoint_description_t *endpointDescription = NULL;
 	remoteServiceAdmin_createEndpointDescription(admin, reference, endpointProperties, interface, &endpointDescription);
 	exportRegistration_setEndpointDescription(registration, endpointDescription);
 
-	free(key);
 	free(serviceId);
 	free(keys);
 
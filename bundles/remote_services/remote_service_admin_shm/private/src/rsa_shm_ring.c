@@ -0,0 +1,466 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/**
+ * rsa_shm_ring.c
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include "rsa_shm_ring.h"
+
+#define RSA_SHM_RING_MAGIC			0x43525352 //"CRSR"
+#define RSA_SHM_RING_VERSION		2
+#define RSA_SHM_RING_CACHE_LINE_SIZE	64
+#define RSA_SHM_RING_WAIT_TIME_IN_MS	100
+//a slot of a caller is reclaimed if it is still in use this long after the deadline of the call (the caller died)
+#define RSA_SHM_RING_STALE_SLOT_TIME_IN_MS	1000
+//the exporter is considered gone if none of its threads polled the ring for this long
+#define RSA_SHM_RING_EXPORTER_TIMEOUT_IN_MS	10000
+
+#define RSA_SHM_RING_ALIGN(size) (((size) + RSA_SHM_RING_CACHE_LINE_SIZE - 1) & ~((size_t)RSA_SHM_RING_CACHE_LINE_SIZE - 1))
+
+//the state word of a slot contains the state in the low byte and the generation of the slot in the other bytes.
+//The generation is incremented for every claim, so that a caller cannot change a slot which is reclaimed (ABA).
+#define RSA_SHM_SLOT_STATE(word)		((word) & 0xFFu)
+#define RSA_SHM_SLOT_GEN(word)			((word) >> 8)
+#define RSA_SHM_SLOT_WORD(gen, state)	(((uint32_t)(gen) << 8) | (uint32_t)(state))
+
+typedef enum rsa_shm_slot_state {
+	RSA_SHM_SLOT_FREE = 0,
+	RSA_SHM_SLOT_CLAIMED = 1,		//claimed by a caller, request is being written
+	RSA_SHM_SLOT_REQUEST = 2,		//request written, waiting for an exporter thread
+	RSA_SHM_SLOT_PROCESSING = 3,	//request taken by an exporter thread
+	RSA_SHM_SLOT_REPLY = 4,			//reply written, waiting for the caller
+	RSA_SHM_SLOT_ABANDONED = 5,		//caller gave up while the request was processed, released by the exporter thread
+	RSA_SHM_SLOT_RECLAIMING = 6		//stale slot being reclaimed by another caller
+} rsa_shm_slot_state_e;
+
+typedef struct rsa_shm_slot {
+	uint32_t state; //futex word, see RSA_SHM_SLOT_WORD
+	int32_t replyStatus;
+	int32_t overflowShmId; //-1 if the data is written in the slot
+	uint32_t pad;
+	uint64_t size; //size of the request or reply, including the terminating '\0'
+	uint64_t deadline; //deadline (monotonic time in ms) of the call, UINT64_MAX if not known yet
+	char pad2[RSA_SHM_RING_CACHE_LINE_SIZE - 32];
+	//followed by slotSize bytes of data
+} rsa_shm_slot_t;
+
+struct rsa_shm_ring {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t nrOfSlots;
+	uint32_t running;
+	uint64_t slotSize;
+	uint64_t exporterHeartbeat; //monotonic time in ms of the last poll of an exporter thread
+	char pad[RSA_SHM_RING_CACHE_LINE_SIZE - 32];
+
+	uint32_t nextSlot; //slot where the next caller starts searching for a free slot
+	uint32_t requestSeq; //futex word, incremented for every request
+	uint32_t nrOfWaitingExporters;
+	char pad2[RSA_SHM_RING_CACHE_LINE_SIZE - 12];
+
+	uint32_t freeSlotSeq; //futex word, incremented for every released slot
+	uint32_t nrOfWaitingCallers;
+	char pad3[RSA_SHM_RING_CACHE_LINE_SIZE - 8];
+	//followed by nrOfSlots slots
+};
+
+static void rsaShmRing_futexWait(uint32_t *addr, uint32_t val, int timeoutInMs) {
+#if defined(__linux__)
+	struct timespec ts;
+	ts.tv_sec = timeoutInMs / 1000;
+	ts.tv_nsec = (timeoutInMs % 1000) * 1000000L;
+	//note not using FUTEX_PRIVATE_FLAG, the futex word is shared between processes
+	syscall(SYS_futex, addr, FUTEX_WAIT, val, &ts, NULL, 0);
+#else
+	//no process shared futex, poll instead
+	(void)addr;
+	(void)val;
+	usleep(timeoutInMs < 1 ? 0 : 1000);
+#endif
+}
+
+static void rsaShmRing_futexWake(uint32_t *addr) {
+#if defined(__linux__)
+	syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+#else
+	(void)addr;
+#endif
+}
+
+/**
+ * Returns the monotonic time in ms. Note the monotonic clock is shared by all processes of the host.
+ */
+static uint64_t rsaShmRing_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static int rsaShmRing_waitTime(uint64_t now, uint64_t deadline) {
+	uint64_t remaining = deadline > now ? deadline - now : 0;
+	return remaining < RSA_SHM_RING_WAIT_TIME_IN_MS ? (int)remaining : RSA_SHM_RING_WAIT_TIME_IN_MS;
+}
+
+static size_t rsaShmRing_slotStride(size_t slotSize) {
+	return sizeof(rsa_shm_slot_t) + RSA_SHM_RING_ALIGN(slotSize);
+}
+
+static rsa_shm_slot_t* rsaShmRing_slot(rsa_shm_ring_t *ring, unsigned int index) {
+	char *slots = (char*)ring + sizeof(*ring);
+	return (rsa_shm_slot_t*)(slots + index * rsaShmRing_slotStride(ring->slotSize));
+}
+
+static char* rsaShmRing_slotData(rsa_shm_slot_t *slot) {
+	return (char*)slot + sizeof(*slot);
+}
+
+static bool rsaShmRing_isRunning(rsa_shm_ring_t *ring) {
+	return __atomic_load_n(&ring->running, __ATOMIC_ACQUIRE) != 0;
+}
+
+static bool rsaShmRing_isExporterAlive(rsa_shm_ring_t *ring, uint64_t now) {
+	uint64_t heartbeat = __atomic_load_n(&ring->exporterHeartbeat, __ATOMIC_RELAXED);
+	return now < heartbeat || now - heartbeat <= RSA_SHM_RING_EXPORTER_TIMEOUT_IN_MS;
+}
+
+size_t rsaShmRing_segmentSize(unsigned int nrOfSlots, size_t slotSize) {
+	return sizeof(rsa_shm_ring_t) + nrOfSlots * rsaShmRing_slotStride(slotSize);
+}
+
+rsa_shm_ring_t* rsaShmRing_init(void *shmBaseAddress, unsigned int nrOfSlots, size_t slotSize) {
+	if (shmBaseAddress == NULL || nrOfSlots == 0 || slotSize == 0) {
+		return NULL;
+	}
+	rsa_shm_ring_t *ring = shmBaseAddress;
+	memset(ring, 0, rsaShmRing_segmentSize(nrOfSlots, slotSize));
+	ring->version = RSA_SHM_RING_VERSION;
+	ring->nrOfSlots = nrOfSlots;
+	ring->slotSize = RSA_SHM_RING_ALIGN(slotSize);
+	ring->exporterHeartbeat = rsaShmRing_now();
+	for (unsigned int i = 0; i < nrOfSlots; ++i) {
+		rsa_shm_slot_t *slot = rsaShmRing_slot(ring, i);
+		slot->state = RSA_SHM_SLOT_WORD(0, RSA_SHM_SLOT_FREE);
+		slot->overflowShmId = -1;
+		slot->deadline = UINT64_MAX;
+	}
+	ring->running = 1;
+	//note magic written last, importers only use an initialized ring
+	__atomic_store_n(&ring->magic, RSA_SHM_RING_MAGIC, __ATOMIC_RELEASE);
+	return ring;
+}
+
+rsa_shm_ring_t* rsaShmRing_attach(void *shmBaseAddress, unsigned int nrOfSlots, size_t slotSize) {
+	rsa_shm_ring_t *ring = shmBaseAddress;
+	if (ring == NULL || __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != RSA_SHM_RING_MAGIC) {
+		return NULL;
+	}
+	if (ring->version != RSA_SHM_RING_VERSION || ring->nrOfSlots != nrOfSlots || ring->slotSize != RSA_SHM_RING_ALIGN(slotSize)) {
+		return NULL;
+	}
+	return ring;
+}
+
+/**
+ * Writes the data in the slot or, if the data does not fit, in a new overflow segment.
+ */
+static celix_status_t rsaShmRing_writeData(rsa_shm_ring_t *ring, rsa_shm_slot_t *slot, const char *data, size_t size) {
+	if (size <= ring->slotSize) {
+		memcpy(rsaShmRing_slotData(slot), data, size);
+		slot->overflowShmId = -1;
+		slot->size = size;
+		return CELIX_SUCCESS;
+	}
+
+	//note only accessible for the user of the processes using the ring
+	int shmId = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+	if (shmId < 0) {
+		return CELIX_BUNDLE_EXCEPTION;
+	}
+	void *addr = shmat(shmId, NULL, 0);
+	if (addr == (void*)-1) {
+		shmctl(shmId, IPC_RMID, NULL);
+		return CELIX_BUNDLE_EXCEPTION;
+	}
+	memcpy(addr, data, size);
+	shmdt(addr);
+	slot->overflowShmId = shmId;
+	slot->size = size;
+	return CELIX_SUCCESS;
+}
+
+static void rsaShmRing_removeOverflow(rsa_shm_slot_t *slot) {
+	if (slot->overflowShmId >= 0) {
+		shmctl(slot->overflowShmId, IPC_RMID, NULL);
+		slot->overflowShmId = -1;
+	}
+}
+
+/**
+ * Copies the data of the slot, or of the overflow segment of the slot, in a new '\0' terminated string.
+ * The size in the slot is not trusted, it should fit in the slot or in the overflow segment.
+ * If removeOverflow is true, the overflow segment is removed, also if the data could not be read.
+ */
+static char* rsaShmRing_readData(rsa_shm_ring_t *ring, rsa_shm_slot_t *slot, bool removeOverflow) {
+	size_t size = slot->size;
+	int shmId = slot->overflowShmId;
+	char *data = NULL;
+
+	if (shmId < 0) {
+		if (size > 0 && size <= ring->slotSize) {
+			data = malloc(size);
+			if (data != NULL) {
+				memcpy(data, rsaShmRing_slotData(slot), size);
+			}
+		}
+	} else {
+		struct shmid_ds info;
+		void *addr = (void*)-1;
+		if (size > 0 && shmctl(shmId, IPC_STAT, &info) == 0 && size <= info.shm_segsz) {
+			addr = shmat(shmId, NULL, SHM_RDONLY);
+		}
+		if (addr != (void*)-1) {
+			data = malloc(size);
+			if (data != NULL) {
+				memcpy(data, addr, size);
+			}
+			shmdt(addr);
+		}
+		if (removeOverflow) {
+			rsaShmRing_removeOverflow(slot);
+		}
+	}
+
+	if (data != NULL) {
+		data[size - 1] = '\0';
+	}
+	return data;
+}
+
+static bool rsaShmRing_isStale(rsa_shm_slot_t *slot, uint32_t word, uint64_t now) {
+	uint32_t state = RSA_SHM_SLOT_STATE(word);
+	if (state != RSA_SHM_SLOT_CLAIMED && state != RSA_SHM_SLOT_REQUEST && state != RSA_SHM_SLOT_REPLY) {
+		//note processing and abandoned slots are owned by the exporter
+		return false;
+	}
+	uint64_t deadline = __atomic_load_n(&slot->deadline, __ATOMIC_SEQ_CST);
+	return deadline != UINT64_MAX && now > deadline + RSA_SHM_RING_STALE_SLOT_TIME_IN_MS;
+}
+
+/**
+ * Claims a free slot or reclaims the slot of a caller which did not finish its call long after its deadline (i.e.
+ * the caller died). Waits till the deadline if all slots are in use.
+ */
+static rsa_shm_slot_t* rsaShmRing_claimSlot(rsa_shm_ring_t *ring, uint64_t deadline, uint32_t *gen) {
+	uint64_t now = rsaShmRing_now();
+	while (rsaShmRing_isRunning(ring) && now < deadline) {
+		uint32_t freeSeq = __atomic_load_n(&ring->freeSlotSeq, __ATOMIC_SEQ_CST);
+		unsigned int start = __atomic_fetch_add(&ring->nextSlot, 1, __ATOMIC_RELAXED) % ring->nrOfSlots;
+		for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+			rsa_shm_slot_t *slot = rsaShmRing_slot(ring, (start + i) % ring->nrOfSlots);
+			uint32_t word = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST);
+			uint32_t claimed = RSA_SHM_SLOT_WORD(RSA_SHM_SLOT_GEN(word) + 1, RSA_SHM_SLOT_CLAIMED);
+			if (RSA_SHM_SLOT_STATE(word) == RSA_SHM_SLOT_FREE) {
+				if (__atomic_compare_exchange_n(&slot->state, &word, claimed, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+					__atomic_store_n(&slot->deadline, deadline, __ATOMIC_SEQ_CST);
+					*gen = RSA_SHM_SLOT_GEN(claimed);
+					return slot;
+				}
+			} else if (rsaShmRing_isStale(slot, word, now)) {
+				uint32_t reclaiming = RSA_SHM_SLOT_WORD(RSA_SHM_SLOT_GEN(word), RSA_SHM_SLOT_RECLAIMING);
+				if (__atomic_compare_exchange_n(&slot->state, &word, reclaiming, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+					//the pending request or reply is not read anymore. Note the overflow segment of a claimed slot
+					//is not removed, it is owned by the (late) caller which was still writing the request
+					if (RSA_SHM_SLOT_STATE(word) != RSA_SHM_SLOT_CLAIMED) {
+						rsaShmRing_removeOverflow(slot);
+					}
+					slot->overflowShmId = -1;
+					slot->size = 0;
+					//note the deadline is set before the slot is claimed, so that it is not seen as stale again
+					__atomic_store_n(&slot->deadline, deadline, __ATOMIC_SEQ_CST);
+					__atomic_store_n(&slot->state, claimed, __ATOMIC_SEQ_CST);
+					*gen = RSA_SHM_SLOT_GEN(claimed);
+					return slot;
+				}
+			}
+		}
+
+		//all slots in use, wait until a slot is released
+		__atomic_fetch_add(&ring->nrOfWaitingCallers, 1, __ATOMIC_SEQ_CST);
+		rsaShmRing_futexWait(&ring->freeSlotSeq, freeSeq, rsaShmRing_waitTime(now, deadline));
+		__atomic_fetch_sub(&ring->nrOfWaitingCallers, 1, __ATOMIC_SEQ_CST);
+		now = rsaShmRing_now();
+	}
+	return NULL;
+}
+
+/**
+ * Releases a slot owned by the calling thread.
+ */
+static void rsaShmRing_releaseSlot(rsa_shm_ring_t *ring, rsa_shm_slot_t *slot, uint32_t gen) {
+	slot->overflowShmId = -1;
+	slot->size = 0;
+	__atomic_store_n(&slot->deadline, UINT64_MAX, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&slot->state, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_FREE), __ATOMIC_SEQ_CST);
+	__atomic_fetch_add(&ring->freeSlotSeq, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->nrOfWaitingCallers, __ATOMIC_SEQ_CST) > 0) {
+		rsaShmRing_futexWake(&ring->freeSlotSeq);
+	}
+}
+
+celix_status_t rsaShmRing_call(rsa_shm_ring_t *ring, const char *request, int timeoutInMs, char **reply, int *replyStatus) {
+	uint64_t deadline = rsaShmRing_now() + (uint64_t)(timeoutInMs > 0 ? timeoutInMs : 0);
+	uint32_t gen = 0;
+	rsa_shm_slot_t *slot = rsaShmRing_claimSlot(ring, deadline, &gen);
+	if (slot == NULL) {
+		return CELIX_ILLEGAL_STATE;
+	}
+
+	celix_status_t status = rsaShmRing_writeData(ring, slot, request, strlen(request) + 1);
+	if (status != CELIX_SUCCESS) {
+		rsaShmRing_releaseSlot(ring, slot, gen);
+		return status;
+	}
+	int requestOverflowShmId = slot->overflowShmId;
+	slot->replyStatus = 0;
+
+	/* Inform the exporter threads, note the slot is reclaimed if writing the request took too long */
+	uint32_t expected = RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_CLAIMED);
+	if (!__atomic_compare_exchange_n(&slot->state, &expected, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_REQUEST), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		if (requestOverflowShmId >= 0) {
+			shmctl(requestOverflowShmId, IPC_RMID, NULL);
+		}
+		return CELIX_ILLEGAL_STATE;
+	}
+	__atomic_fetch_add(&ring->requestSeq, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&ring->nrOfWaitingExporters, __ATOMIC_SEQ_CST) > 0) {
+		rsaShmRing_futexWake(&ring->requestSeq);
+	}
+
+	/* Wait until the exporter has written the reply, the deadline has passed, the exporter is gone or the ring is stopped */
+	uint32_t word;
+	while ((word = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST)) != RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_REPLY)) {
+		if (RSA_SHM_SLOT_GEN(word) != gen || RSA_SHM_SLOT_STATE(word) == RSA_SHM_SLOT_RECLAIMING) {
+			return CELIX_ILLEGAL_STATE; //reclaimed
+		}
+		uint64_t now = rsaShmRing_now();
+		if (now < deadline && rsaShmRing_isExporterAlive(ring, now) && rsaShmRing_isRunning(ring)) {
+			rsaShmRing_futexWait(&slot->state, word, rsaShmRing_waitTime(now, deadline));
+		} else if (RSA_SHM_SLOT_STATE(word) == RSA_SHM_SLOT_REQUEST) {
+			//not taken by an exporter thread yet, withdraw the request
+			if (__atomic_compare_exchange_n(&slot->state, &word, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_CLAIMED), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+				rsaShmRing_removeOverflow(slot);
+				rsaShmRing_releaseSlot(ring, slot, gen);
+				return CELIX_ILLEGAL_STATE;
+			}
+		} else if (RSA_SHM_SLOT_STATE(word) == RSA_SHM_SLOT_PROCESSING) {
+			//the exporter thread releases the slot when it is done
+			if (__atomic_compare_exchange_n(&slot->state, &word, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_ABANDONED), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+				return CELIX_ILLEGAL_STATE;
+			}
+		}
+	}
+
+	*reply = rsaShmRing_readData(ring, slot, true);
+	*replyStatus = slot->replyStatus;
+	if (*reply == NULL) {
+		status = CELIX_BUNDLE_EXCEPTION;
+	}
+	//note the slot could have been reclaimed while the reply was read, only release it if it is still owned
+	expected = RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_REPLY);
+	if (__atomic_compare_exchange_n(&slot->state, &expected, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_CLAIMED), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+		rsaShmRing_releaseSlot(ring, slot, gen);
+	}
+	return status;
+}
+
+bool rsaShmRing_handleRequest(rsa_shm_ring_t *ring, unsigned int *cursor, int timeoutInMs, rsa_shm_ring_handle_request_fp handleRequest, void *handle) {
+	__atomic_store_n(&ring->exporterHeartbeat, rsaShmRing_now(), __ATOMIC_RELAXED);
+	uint32_t seq = __atomic_load_n(&ring->requestSeq, __ATOMIC_SEQ_CST);
+	for (unsigned int i = 0; i < ring->nrOfSlots && rsaShmRing_isRunning(ring); ++i) {
+		unsigned int index = (*cursor + i) % ring->nrOfSlots;
+		rsa_shm_slot_t *slot = rsaShmRing_slot(ring, index);
+		uint32_t word = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST);
+		if (RSA_SHM_SLOT_STATE(word) != RSA_SHM_SLOT_REQUEST) {
+			continue;
+		}
+		uint32_t gen = RSA_SHM_SLOT_GEN(word);
+		if (!__atomic_compare_exchange_n(&slot->state, &word, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_PROCESSING), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+			continue;
+		}
+		*cursor = (index + 1) % ring->nrOfSlots;
+
+		char *reply = NULL;
+		int replyStatus = CELIX_BUNDLE_EXCEPTION;
+		char *request = rsaShmRing_readData(ring, slot, true);
+		if (request != NULL) {
+			replyStatus = handleRequest(handle, request, &reply);
+		}
+		const char *replyData = reply != NULL ? reply : "";
+		if (rsaShmRing_writeData(ring, slot, replyData, strlen(replyData) + 1) != CELIX_SUCCESS) {
+			replyStatus = CELIX_BUNDLE_EXCEPTION;
+			rsaShmRing_writeData(ring, slot, "", 1);
+		}
+		slot->replyStatus = replyStatus;
+
+		/* Inform the caller, or release the slot if the caller gave up */
+		uint32_t expected = RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_PROCESSING);
+		if (__atomic_compare_exchange_n(&slot->state, &expected, RSA_SHM_SLOT_WORD(gen, RSA_SHM_SLOT_REPLY), false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+			rsaShmRing_futexWake(&slot->state);
+		} else {
+			rsaShmRing_removeOverflow(slot);
+			rsaShmRing_releaseSlot(ring, slot, gen);
+		}
+
+		free(request);
+		free(reply);
+		return true;
+	}
+
+	if (rsaShmRing_isRunning(ring)) {
+		__atomic_fetch_add(&ring->nrOfWaitingExporters, 1, __ATOMIC_SEQ_CST);
+		rsaShmRing_futexWait(&ring->requestSeq, seq, timeoutInMs);
+		__atomic_fetch_sub(&ring->nrOfWaitingExporters, 1, __ATOMIC_SEQ_CST);
+	}
+	return false;
+}
+
+void rsaShmRing_stop(rsa_shm_ring_t *ring) {
+	__atomic_store_n(&ring->running, 0, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&ring->requestSeq, 1, __ATOMIC_SEQ_CST);
+	rsaShmRing_futexWake(&ring->requestSeq);
+	__atomic_fetch_add(&ring->freeSlotSeq, 1, __ATOMIC_SEQ_CST);
+	rsaShmRing_futexWake(&ring->freeSlotSeq);
+	for (unsigned int i = 0; i < ring->nrOfSlots; ++i) {
+		rsaShmRing_futexWake(&rsaShmRing_slot(ring, i)->state);
+	}
+}
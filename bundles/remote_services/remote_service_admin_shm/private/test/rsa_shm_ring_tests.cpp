@@ -0,0 +1,169 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <CppUTest/TestHarness.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+extern "C" {
+
+	#include <signal.h>
+	#include <stdlib.h>
+	#include <string.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/wait.h>
+
+	#include "celix_errno.h"
+	#include "rsa_shm_ring.h"
+
+	static std::atomic<int> handlerDelayInMs{0};
+
+	static int echoRequest(void *handle, const char *request, char **reply) {
+		(void)handle;
+		if (handlerDelayInMs > 0) {
+			std::this_thread::sleep_for(std::chrono::milliseconds{handlerDelayInMs});
+		}
+		*reply = strdup(request);
+		return CELIX_SUCCESS;
+	}
+}
+
+TEST_GROUP(RsaShmRingTests) {
+	void *shm = NULL;
+	size_t shmSize = 0;
+	rsa_shm_ring_t *ring = NULL;
+	std::atomic<bool> exporterRunning{false};
+	std::thread exporter{};
+
+	void setup() {
+		handlerDelayInMs = 0;
+	}
+
+	void teardown() {
+		stopExporter();
+		if (shm != NULL) {
+			munmap(shm, shmSize);
+		}
+	}
+
+	void createRing(unsigned int nrOfSlots, size_t slotSize) {
+		//note shared, so that the ring can also be used by a forked process
+		shmSize = rsaShmRing_segmentSize(nrOfSlots, slotSize);
+		shm = mmap(NULL, shmSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+		CHECK(shm != MAP_FAILED);
+		ring = rsaShmRing_init(shm, nrOfSlots, slotSize);
+		CHECK(ring != NULL);
+	}
+
+	void startExporter() {
+		exporterRunning = true;
+		exporter = std::thread{[this]{
+			unsigned int cursor = 0;
+			while (exporterRunning) {
+				rsaShmRing_handleRequest(ring, &cursor, 10, echoRequest, NULL);
+			}
+		}};
+	}
+
+	void stopExporter() {
+		exporterRunning = false;
+		if (exporter.joinable()) {
+			exporter.join();
+		}
+	}
+
+	celix_status_t call(const std::string& request, int timeoutInMs, std::string *reply = NULL) {
+		char *replyData = NULL;
+		int replyStatus = -1;
+		celix_status_t status = rsaShmRing_call(ring, request.c_str(), timeoutInMs, &replyData, &replyStatus);
+		if (status == CELIX_SUCCESS) {
+			LONGS_EQUAL(CELIX_SUCCESS, replyStatus);
+			if (reply != NULL) {
+				*reply = replyData;
+			}
+		}
+		free(replyData);
+		return status;
+	}
+};
+
+TEST(RsaShmRingTests, callAndReply) {
+	createRing(4, 1024);
+	startExporter();
+	std::string reply{};
+	LONGS_EQUAL(CELIX_SUCCESS, call("hello", 1000, &reply));
+	STRCMP_EQUAL("hello", reply.c_str());
+}
+
+TEST(RsaShmRingTests, overflowRequestAndReply) {
+	createRing(2, 64);
+	startExporter();
+	std::string request(10000, 'x');
+	std::string reply{};
+	LONGS_EQUAL(CELIX_SUCCESS, call(request, 1000, &reply));
+	CHECK(request == reply);
+}
+
+TEST(RsaShmRingTests, callTimesOutWithoutExporter) {
+	createRing(1, 1024);
+	auto start = std::chrono::steady_clock::now();
+	LONGS_EQUAL(CELIX_ILLEGAL_STATE, call("hello", 100));
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds{1});
+
+	//the request is withdrawn, so the only slot can be used again
+	startExporter();
+	LONGS_EQUAL(CELIX_SUCCESS, call("hello", 1000));
+}
+
+TEST(RsaShmRingTests, abandonedSlotIsReleasedByTheExporter) {
+	createRing(1, 1024);
+	startExporter();
+	handlerDelayInMs = 300;
+	LONGS_EQUAL(CELIX_ILLEGAL_STATE, call("slow", 100));
+
+	handlerDelayInMs = 0;
+	LONGS_EQUAL(CELIX_SUCCESS, call("fast", 2000));
+}
+
+TEST(RsaShmRingTests, slotOfDeadCallerIsReclaimed) {
+	createRing(1, 64);
+	pid_t pid = fork();
+	if (pid == 0) {
+		//child: claims the only slot with an overflow request and is killed while waiting for the reply
+		std::string request(1000, 'x');
+		char *reply = NULL;
+		int replyStatus = 0;
+		rsaShmRing_call(ring, request.c_str(), 200, &reply, &replyStatus);
+		_exit(0);
+	}
+	CHECK(pid > 0);
+	std::this_thread::sleep_for(std::chrono::milliseconds{50});
+	kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+
+	//the slot of the killed caller is reclaimed shortly after the deadline of its call
+	startExporter();
+	std::string reply{};
+	LONGS_EQUAL(CELIX_SUCCESS, call("hello", 3000, &reply));
+	STRCMP_EQUAL("hello", reply.c_str());
+}
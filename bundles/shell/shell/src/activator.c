@@ -79,8 +79,9 @@ celix_status_t bundleActivator_create(celix_bundle_context_t* ctx, void **_pptr)
                         .name = "celix::lb",
                         .description = "list bundles. Default only the groupless bundles are listed. Use -a to list all bundles." \
                             "\nIf a group string is provided only bundles matching the group string will be listed." \
-                            "\nUse -l to print the bundle locations.\nUse -s to print the bundle symbolic names\nUse -u to print the bundle update location.",
-                        .usage = "lb [-l | -s | -u | -a] [group]"
+                            "\nUse -l to print the bundle locations.\nUse -s to print the bundle symbolic names\nUse -u to print the bundle update location." \
+                            "\nUse -t to print the bundle startup timing (install, library load and activator start durations).",
+                        .usage = "lb [-l | -s | -u | -a | -t] [group]"
                 };
         activator->std_commands[1] =
                 (struct celix_shell_command_register_entry) {
@@ -68,9 +68,8 @@ static void printFullInfo(FILE *out, bool colors, long bundleId, dm_component_in
         dm_interface_info_pt intfInfo = arrayList_get(compInfo->interfaces, interfCnt);
         fprintf(out, "   |- Interface: %s\n", intfInfo->name);
 
-        hash_map_iterator_t iter = hashMapIterator_construct((hash_map_pt) intfInfo->properties);
-        char *key = NULL;
-        while ((key = hashMapIterator_nextKey(&iter)) != NULL) {
+        const char *key = NULL;
+        CELIX_PROPERTIES_FOR_EACH(intfInfo->properties, key) {
             fprintf(out, "      | %15s = %s\n", key, properties_get(intfInfo->properties, key));
         }
     }
@@ -94,6 +93,10 @@ static void printFullInfo(FILE *out, bool colors, long bundleId, dm_component_in
                 dependency->available ? "true " : "false", depEndColors,
                 dependency->required ? "true " : "false", dependency->filter);
     }
+    fprintf(out, "|- Transitions: Count=%zu, Avg=%.3f ms, Max=%.3f ms\n", compInfo->nrOfTransitions,
+            compInfo->avgTransitionTimeInMs, compInfo->maxTransitionTimeInMs);
+    fprintf(out, "|- Tasks: Count=%zu, Avg latency=%.3f ms, Max latency=%.3f ms\n", compInfo->nrOfTasks,
+            compInfo->avgTaskLatencyInMs, compInfo->maxTaskLatencyInMs);
     fprintf(out, "\n");
 
 }
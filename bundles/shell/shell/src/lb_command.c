@@ -42,6 +42,7 @@ typedef struct lb_options {
     bool show_location;
     bool show_symbolic_name;
     bool show_update_location;
+    bool show_startup_timing;
 
     //use color
     bool useColors;
@@ -142,7 +143,11 @@ static void lbCommand_listBundles(celix_bundle_context_t *ctx, const lb_options_
         endColor = END_COLOR;
     }
     fprintf(out, "%s  Bundles:%s\n", startColor, endColor);
-    fprintf(out, "%s  %-5s %-12s %-40s %-20s%s\n", startColor, "ID", "State", message_str, "Group", endColor);
+    if (opts->show_startup_timing) {
+        fprintf(out, "%s  %-5s %-12s %-40s %-20s %12s %12s %12s %-8s%s\n", startColor, "ID", "State", message_str, "Group", "Install(ms)", "Load(ms)", "Start(ms)", "Parallel", endColor);
+    } else {
+        fprintf(out, "%s  %-5s %-12s %-40s %-20s%s\n", startColor, "ID", "State", message_str, "Group", endColor);
+    }
 
     array_list_t *bundles_ptr = NULL;
     bundleContext_getBundles(ctx, &bundles_ptr);
@@ -244,7 +249,13 @@ static void lbCommand_listBundles(celix_bundle_context_t *ctx, const lb_options_
 
             if (print) {
                 group_str = group_str == NULL ? NONE_GROUP : group_str;
-                fprintf(out, "%s  %-5li %-12s %-40s %-20s%s\n", startColor, id, state_str, name_str, group_str, endColor);
+                if (opts->show_startup_timing) {
+                    celix_bundle_startup_timing_t timing = celix_bundle_getStartupTiming(bundle_ptr);
+                    fprintf(out, "%s  %-5li %-12s %-40s %-20s %12.3f %12.3f %12.3f %-8s%s\n", startColor, id, state_str, name_str, group_str,
+                            timing.installDurationInMs, timing.loadDurationInMs, timing.startDurationInMs, timing.preparedInParallel ? "yes" : "no", endColor);
+                } else {
+                    fprintf(out, "%s  %-5li %-12s %-40s %-20s%s\n", startColor, id, state_str, name_str, group_str, endColor);
+                }
             }
 
         }
@@ -288,6 +299,8 @@ bool lbCommand_execute(void *handle, const char *const_command_line_str, FILE *o
             opts.show_update_location = true;
         } else if (strcmp(sub_str, "-a") == 0) {
             opts.listAllGroups = true;
+        } else if (strcmp(sub_str, "-t") == 0) {
+            opts.show_startup_timing = true;
         } else {
             opts.listGroup = strdup(sub_str);
         }
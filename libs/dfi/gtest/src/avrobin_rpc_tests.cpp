@@ -0,0 +1,305 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "dyn_common.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+#include "avrobin_serializer.h"
+#include "avrobin_rpc.h"
+}
+
+class AvrobinRpcTests : public ::testing::Test {
+public:
+    struct tst_seq {
+        uint32_t cap;
+        uint32_t len;
+        double *buf;
+    };
+
+    struct tst_StatsResult {
+        double average;
+        double min;
+        double max;
+        struct tst_seq input;
+    };
+
+    struct tst_serv {
+        void *handle;
+        int (*add)(void *, double, double, double *);
+        int (*sub)(void *, double, double, double *);
+        int (*sqrt)(void *, double, double *);
+        int (*stats)(void *, struct tst_seq, struct tst_StatsResult **);
+    };
+
+    struct tst_serv_example4 {
+        void *handle;
+        int (*getName)(void *, char** name);
+    };
+
+    static void stdLog(void*, int level, const char *file, int line, const char *msg, ...) {
+        va_list ap;
+        const char *levels[5] = {"NIL", "ERROR", "WARNING", "INFO", "DEBUG"};
+        fprintf(stderr, "%s: FILE:%s, LINE:%i, MSG:",levels[level], file, line);
+        va_start(ap, msg);
+        vfprintf(stderr, msg, ap);
+        fprintf(stderr, "\n");
+        va_end(ap);
+    }
+
+    static int add(void*, double a, double b, double *result) {
+        *result = a + b;
+        return 0;
+    }
+
+    static int sub(void*, double, double, double *) {
+        return 42; //remote error
+    }
+
+    static int stats(void*, struct tst_seq input, struct tst_StatsResult **out) {
+        auto *result = static_cast<tst_StatsResult*>(calloc(1, sizeof(tst_StatsResult)));
+        double total = 0.0;
+        for (uint32_t i = 0; i < input.len; ++i) {
+            total += input.buf[i];
+        }
+        result->average = input.len > 0 ? total / input.len : 0.0;
+        result->input.buf = static_cast<double*>(calloc(input.len, sizeof(double)));
+        memcpy(result->input.buf, input.buf, input.len * sizeof(double));
+        result->input.len = input.len;
+        result->input.cap = input.len;
+        *out = result;
+        return 0;
+    }
+
+    static int getName(void*, char** result) {
+        *result = strdup("allocatedInFunction");
+        return 0;
+    }
+
+    AvrobinRpcTests() {
+        int lvl = 1;
+        dynCommon_logSetup(stdLog, nullptr, lvl);
+        dynType_logSetup(stdLog, nullptr,lvl);
+        dynFunction_logSetup(stdLog, nullptr,lvl);
+        dynInterface_logSetup(stdLog, nullptr,lvl);
+        avrobinSerializer_logSetup(stdLog, nullptr, lvl);
+        avrobinRpc_logSetup(stdLog, nullptr, lvl);
+    }
+
+    static dyn_interface_type* parse(const char *file) {
+        dyn_interface_type *intf = nullptr;
+        FILE *desc = fopen(file, "r");
+        EXPECT_TRUE(desc != nullptr);
+        if (desc != nullptr) {
+            EXPECT_EQ(0, dynInterface_parse(desc, &intf));
+            fclose(desc);
+        }
+        return intf;
+    }
+
+    static struct method_entry* method(dyn_interface_type *intf, const char *name) {
+        struct methods_head *head = nullptr;
+        dynInterface_methods(intf, &head);
+        struct method_entry *entry = nullptr;
+        TAILQ_FOREACH(entry, head, entries) {
+            if (strcmp(entry->name, name) == 0) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+};
+
+TEST_F(AvrobinRpcTests, CallPreAllocatedOutput) {
+    dyn_interface_type *intf = parse("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = method(intf, "add");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = -1.0;
+    double *out = &result;
+    void *args[4] = {&handle, &a, &b, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    ASSERT_EQ(0, avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, &request, &requestLength));
+    EXPECT_EQ(1 + 4 + 2 * (1 + sizeof(double)), requestLength); //index + signature hash + 2 * (length + double)
+
+    tst_serv serv {nullptr, add, sub, nullptr, nullptr};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    ASSERT_EQ(0, avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength));
+
+    ASSERT_EQ(0, avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args));
+    EXPECT_EQ(3.0, result);
+
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, CallOutputWithSequence) {
+    dyn_interface_type *intf = parse("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = method(intf, "stats");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    double values[3] = {1.0, 2.0, 3.0};
+    tst_seq input {3, 3, values};
+    tst_StatsResult *result = nullptr;
+    void *out = &result;
+    void *args[3] = {&handle, &input, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    ASSERT_EQ(0, avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, &request, &requestLength));
+
+    tst_serv serv {nullptr, nullptr, nullptr, nullptr, stats};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    ASSERT_EQ(0, avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength));
+
+    ASSERT_EQ(0, avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args));
+    ASSERT_TRUE(result != nullptr);
+    EXPECT_EQ(2.0, result->average);
+    ASSERT_EQ(3, result->input.len);
+    EXPECT_EQ(3.0, result->input.buf[2]);
+
+    free(result->input.buf);
+    free(result);
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, CallOutputString) {
+    dyn_interface_type *intf = parse("descriptors/example4.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = method(intf, "getName");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    char *result = nullptr;
+    void *out = &result;
+    void *args[2] = {&handle, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    ASSERT_EQ(0, avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, &request, &requestLength));
+
+    tst_serv_example4 serv {nullptr, getName};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    ASSERT_EQ(0, avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength));
+
+    ASSERT_EQ(0, avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args));
+    EXPECT_STREQ("allocatedInFunction", result);
+
+    free(result);
+    free(request);
+    free(reply);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, RemoteErrorAndInvalidRequests) {
+    dyn_interface_type *intf = parse("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *entry = method(intf, "sub");
+    ASSERT_TRUE(entry != nullptr);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = -1.0;
+    double *out = &result;
+    void *args[4] = {&handle, &a, &b, &out};
+
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    ASSERT_EQ(0, avrobinRpc_prepareInvokeRequest(entry->dynFunc, entry->index, entry->id, args, &request, &requestLength));
+
+    tst_serv serv {nullptr, add, sub, nullptr, nullptr};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    ASSERT_EQ(0, avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength));
+    ASSERT_EQ(0, avrobinRpc_handleReply(entry->dynFunc, reply, replyLength, args));
+    EXPECT_EQ(-1.0, result); //no result for a remote error
+    free(reply);
+
+    //truncated request
+    EXPECT_NE(0, avrobinRpc_call(intf, &serv, request, requestLength - 1, &reply, &replyLength));
+
+    //unknown method index
+    uint8_t unknownMethod[] = {0x7E, 0x00, 0x00, 0x00, 0x00}; //zigzag encoded 63 + signature hash
+    EXPECT_NE(0, avrobinRpc_call(intf, &serv, unknownMethod, sizeof(unknownMethod), &reply, &replyLength));
+
+    free(request);
+    dynInterface_destroy(intf);
+}
+
+TEST_F(AvrobinRpcTests, MethodSignatureMismatch) {
+    dyn_interface_type *intf = parse("descriptors/example1.descriptor");
+    ASSERT_TRUE(intf != nullptr);
+    struct method_entry *addEntry = method(intf, "add");
+    struct method_entry *subEntry = method(intf, "sub");
+    ASSERT_TRUE(addEntry != nullptr);
+    ASSERT_TRUE(subEntry != nullptr);
+
+    void *handle = nullptr;
+    double a = 1.0;
+    double b = 2.0;
+    double result = -1.0;
+    double *out = &result;
+    void *args[4] = {&handle, &a, &b, &out};
+
+    //a peer with another descriptor version, which has the sub signature on the index of add
+    uint8_t *request = nullptr;
+    size_t requestLength = 0;
+    ASSERT_EQ(0, avrobinRpc_prepareInvokeRequest(addEntry->dynFunc, addEntry->index, subEntry->id, args, &request, &requestLength));
+
+    struct method_entry *found = nullptr;
+    EXPECT_NE(0, avrobinRpc_getMethod(intf, request, requestLength, &found));
+    EXPECT_EQ(nullptr, found);
+
+    tst_serv serv {nullptr, add, sub, nullptr, nullptr};
+    uint8_t *reply = nullptr;
+    size_t replyLength = 0;
+    EXPECT_NE(0, avrobinRpc_call(intf, &serv, request, requestLength, &reply, &replyLength));
+    EXPECT_EQ(nullptr, reply);
+    free(request);
+
+    //the matching signature is accepted
+    ASSERT_EQ(0, avrobinRpc_prepareInvokeRequest(addEntry->dynFunc, addEntry->index, addEntry->id, args, &request, &requestLength));
+    EXPECT_EQ(0, avrobinRpc_getMethod(intf, request, requestLength, &found));
+    EXPECT_EQ(addEntry, found);
+    free(request);
+
+    dynInterface_destroy(intf);
+}
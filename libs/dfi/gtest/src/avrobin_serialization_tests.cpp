@@ -610,3 +610,18 @@ public:
 TEST_F(AvrobinSerializerTests, GeneralTests) {
     generalTests();
 }
+
+TEST_F(AvrobinSerializerTests, TruncatedSequenceInComplex) {
+    dyn_type *type = nullptr;
+    int rc = dynType_parseWithStr("{I[I a b}", "truncated", nullptr, &type);
+    ASSERT_EQ(0, rc);
+
+    //a = 1, b = [1, 2, 3] -> 02 06 02 04 06 00, truncated after the second item of b
+    const uint8_t data[] = {0x02, 0x06, 0x02, 0x04};
+    void *inst = nullptr;
+    rc = avrobinSerializer_deserialize(type, data, sizeof(data), &inst);
+    EXPECT_NE(0, rc);
+    EXPECT_EQ(nullptr, inst);
+
+    dynType_destroy(type);
+}
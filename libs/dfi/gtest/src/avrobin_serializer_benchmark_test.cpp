@@ -0,0 +1,190 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <string.h>
+
+extern "C" {
+#include "dyn_type.h"
+#include "avrobin_serializer.h"
+}
+
+class AvrobinSerializerBenchmarkTests : public ::testing::Test {
+public:
+    struct point {
+        double x;
+        double y;
+        double z;
+    };
+
+    struct nested {
+        int32_t id;
+        int64_t timestamp;
+        struct point position;
+        struct point velocity;
+        bool valid;
+    };
+
+    struct double_seq {
+        uint32_t cap;
+        uint32_t len;
+        double *buf;
+    };
+
+    struct nested_seq {
+        uint32_t cap;
+        uint32_t len;
+        struct nested *buf;
+    };
+
+    struct strings {
+        char *name;
+        char *description;
+        char *location;
+    };
+
+    static dyn_type* parse(const char *descriptor) {
+        dyn_type *type = nullptr;
+        EXPECT_EQ(0, dynType_parseWithStr(descriptor, nullptr, nullptr, &type));
+        return type;
+    }
+
+    /**
+     * Serializes and deserializes the value nrOfRoundTrips times and prints the throughput.
+     * Returns the serialized size.
+     */
+    static size_t measure(const std::string &shape, dyn_type *type, const void *value, int nrOfRoundTrips) {
+        size_t serializedSize = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nrOfRoundTrips; ++i) {
+            uint8_t *out = nullptr;
+            size_t outLen = 0;
+            EXPECT_EQ(0, avrobinSerializer_serialize(type, value, &out, &outLen));
+            void *result = nullptr;
+            EXPECT_EQ(0, avrobinSerializer_deserialize(type, out, outLen, &result));
+            dynType_free(type, result);
+            free(out);
+            serializedSize = outLen;
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / nrOfRoundTrips;
+        double mbPerSec = ((double)serializedSize / (1024.0 * 1024.0)) / (ns / 1e9);
+        std::cout << "avrobin " << shape << ": " << serializedSize << " bytes, " << ns << " ns per round trip, "
+                  << mbPerSec << " MB/s" << std::endl;
+        return serializedSize;
+    }
+};
+
+TEST_F(AvrobinSerializerBenchmarkTests, NestedComplex) {
+    dyn_type *type = parse("{IJ{DDD x y z}{DDD x y z}Z id timestamp position velocity valid}");
+    ASSERT_TRUE(type != nullptr);
+    nested value{42, 1234567890123LL, {1.0, 2.0, 3.0}, {-1.0, -2.0, -3.0}, true};
+
+    measure("nested complex", type, &value, 100000);
+
+    void *result = nullptr;
+    uint8_t *out = nullptr;
+    size_t outLen = 0;
+    ASSERT_EQ(0, avrobinSerializer_serialize(type, &value, &out, &outLen));
+    ASSERT_EQ(0, avrobinSerializer_deserialize(type, out, outLen, &result));
+    auto *n = static_cast<nested*>(result);
+    EXPECT_EQ(42, n->id);
+    EXPECT_EQ(1234567890123LL, n->timestamp);
+    EXPECT_EQ(3.0, n->position.z);
+    EXPECT_EQ(-2.0, n->velocity.y);
+    EXPECT_TRUE(n->valid);
+    dynType_free(type, result);
+    free(out);
+    dynType_destroy(type);
+}
+
+TEST_F(AvrobinSerializerBenchmarkTests, Sequences) {
+    dyn_type *doublesType = parse("[D");
+    ASSERT_TRUE(doublesType != nullptr);
+    std::vector<double> doubles(1024);
+    for (size_t i = 0; i < doubles.size(); ++i) {
+        doubles[i] = (double)i * 0.5;
+    }
+    double_seq doubleSeq{(uint32_t)doubles.size(), (uint32_t)doubles.size(), doubles.data()};
+    measure("sequence of 1024 doubles", doublesType, &doubleSeq, 10000);
+
+    dyn_type *nestedType = parse("[{IJ{DDD x y z}{DDD x y z}Z id timestamp position velocity valid}");
+    ASSERT_TRUE(nestedType != nullptr);
+    std::vector<nested> items(256);
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = nested{(int32_t)i, (int64_t)i * 1000, {1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}, i % 2 == 0};
+    }
+    nested_seq nestedSeq{(uint32_t)items.size(), (uint32_t)items.size(), items.data()};
+    measure("sequence of 256 nested complex", nestedType, &nestedSeq, 2000);
+
+    dynType_destroy(doublesType);
+    dynType_destroy(nestedType);
+}
+
+TEST_F(AvrobinSerializerBenchmarkTests, Strings) {
+    dyn_type *type = parse("{ttt name description location}");
+    ASSERT_TRUE(type != nullptr);
+    std::string description(512, 'd');
+    strings value{(char*)"benchmark", (char*)description.c_str(), (char*)"somewhere"};
+
+    measure("strings", type, &value, 100000);
+    dynType_destroy(type);
+}
+
+TEST_F(AvrobinSerializerBenchmarkTests, SerializeToBufferAndDeserializeIoVec) {
+    dyn_type *type = parse("{ttt name description location}");
+    ASSERT_TRUE(type != nullptr);
+    strings value{(char*)"name", (char*)"a description", (char*)"location"};
+
+    uint8_t buf[64];
+    size_t len = 0;
+    ASSERT_EQ(0, avrobinSerializer_serializeToBuffer(type, &value, buf, sizeof(buf), &len));
+    EXPECT_EQ(3 + 4 + 13 + 8, len); //3 length bytes + strings
+
+    //too small buffer
+    size_t tooSmallLen = 0;
+    EXPECT_NE(0, avrobinSerializer_serializeToBuffer(type, &value, buf, len - 1, &tooSmallLen));
+
+    //message split over multiple iovecs
+    struct iovec iov[3];
+    iov[0].iov_base = buf;
+    iov[0].iov_len = 3;
+    iov[1].iov_base = buf + 3;
+    iov[1].iov_len = 10;
+    iov[2].iov_base = buf + 13;
+    iov[2].iov_len = len - 13;
+    void *result = nullptr;
+    ASSERT_EQ(0, avrobinSerializer_deserializeIoVec(type, iov, 3, &result));
+    auto *s = static_cast<strings*>(result);
+    EXPECT_STREQ("name", s->name);
+    EXPECT_STREQ("a description", s->description);
+    EXPECT_STREQ("location", s->location);
+    dynType_free(type, result);
+
+    //truncated input
+    result = nullptr;
+    EXPECT_NE(0, avrobinSerializer_deserializeIoVec(type, iov, 2, &result));
+
+    dynType_destroy(type);
+}
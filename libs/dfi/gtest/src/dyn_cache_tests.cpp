@@ -0,0 +1,104 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "dyn_cache.h"
+#include "dyn_message.h"
+#include "dyn_interface.h"
+}
+
+class DynCacheTests : public ::testing::Test {
+public:
+    static std::string read(const char *file) {
+        std::string result{};
+        FILE *stream = fopen(file, "r");
+        EXPECT_TRUE(stream != nullptr);
+        if (stream != nullptr) {
+            char *content = nullptr;
+            size_t length = 0;
+            EXPECT_EQ(0, dynCache_readDescriptor(stream, &content, &length));
+            EXPECT_EQ(strlen(content), length);
+            result = std::string{content, length};
+            free(content);
+            fclose(stream);
+        }
+        return result;
+    }
+};
+
+TEST_F(DynCacheTests, SharesMessagesWithTheSameContent) {
+    std::string descriptor = read("descriptors/msg_example1.descriptor");
+    std::string other = read("descriptors/msg_example2.descriptor");
+    size_t nrOfEntries = dynCache_nrOfEntries();
+
+    dyn_message_type *msg1 = nullptr;
+    dyn_message_type *msg2 = nullptr;
+    dyn_message_type *msg3 = nullptr;
+    ASSERT_EQ(0, dynCache_getMessage(descriptor.c_str(), descriptor.size(), &msg1));
+    ASSERT_EQ(0, dynCache_getMessage(descriptor.c_str(), descriptor.size(), &msg2));
+    ASSERT_EQ(0, dynCache_getMessage(other.c_str(), other.size(), &msg3));
+    EXPECT_EQ(msg1, msg2);
+    EXPECT_NE(msg1, msg3);
+    EXPECT_EQ(nrOfEntries + 2, dynCache_nrOfEntries());
+
+    char *name = nullptr;
+    ASSERT_EQ(0, dynMessage_getName(msg1, &name));
+    EXPECT_STREQ("poi", name);
+
+    dynCache_releaseMessage(msg1);
+    EXPECT_EQ(nrOfEntries + 2, dynCache_nrOfEntries()); //still used by msg2
+    dynCache_releaseMessage(msg2);
+    dynCache_releaseMessage(msg3);
+    EXPECT_EQ(nrOfEntries, dynCache_nrOfEntries());
+}
+
+TEST_F(DynCacheTests, InterfacesAndInvalidDescriptors) {
+    std::string descriptor = read("descriptors/example1.descriptor");
+    size_t nrOfEntries = dynCache_nrOfEntries();
+
+    dyn_interface_type *intf1 = nullptr;
+    dyn_interface_type *intf2 = nullptr;
+    ASSERT_EQ(0, dynCache_getInterface(descriptor.c_str(), descriptor.size(), &intf1));
+    ASSERT_EQ(0, dynCache_getInterface(descriptor.c_str(), descriptor.size(), &intf2));
+    EXPECT_EQ(intf1, intf2);
+    EXPECT_EQ(4, dynInterface_nrOfMethods(intf1));
+
+    //the same content as message is a different (invalid) entry
+    dyn_message_type *msg = nullptr;
+    EXPECT_NE(0, dynCache_getMessage(descriptor.c_str(), descriptor.size(), &msg));
+    EXPECT_EQ(nrOfEntries + 1, dynCache_nrOfEntries());
+
+    dynCache_releaseInterface(intf1);
+    dynCache_releaseInterface(intf2);
+    EXPECT_EQ(nrOfEntries, dynCache_nrOfEntries());
+
+    //not cached interfaces are destroyed directly
+    FILE *stream = fopen("descriptors/example1.descriptor", "r");
+    ASSERT_TRUE(stream != nullptr);
+    dyn_interface_type *uncached = nullptr;
+    ASSERT_EQ(0, dynInterface_parse(stream, &uncached));
+    fclose(stream);
+    dynCache_releaseInterface(uncached);
+    dynCache_releaseInterface(nullptr);
+}
@@ -0,0 +1,267 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <string.h>
+
+extern "C" {
+#include "dyn_type.h"
+#include "json_serializer.h"
+}
+
+class JsonSerializerPlanBenchmarkTests : public ::testing::Test {
+public:
+    struct point {
+        double x;
+        double y;
+        double z;
+    };
+
+    struct nested {
+        int32_t id;
+        int64_t timestamp;
+        struct point position;
+        struct point velocity;
+        bool valid;
+    };
+
+    struct double_seq {
+        uint32_t cap;
+        uint32_t len;
+        double *buf;
+    };
+
+    struct nested_seq {
+        uint32_t cap;
+        uint32_t len;
+        struct nested *buf;
+    };
+
+    struct strings {
+        char *name;
+        char *description;
+        char *location;
+    };
+
+    static dyn_type* parse(const char *descriptor) {
+        dyn_type *type = nullptr;
+        EXPECT_EQ(0, dynType_parseWithStr(descriptor, nullptr, nullptr, &type));
+        return type;
+    }
+
+    static std::string serializeDom(dyn_type *type, const void *value) {
+        char *out = nullptr;
+        EXPECT_EQ(0, jsonSerializer_serialize(type, value, &out));
+        std::string result = out != nullptr ? out : "";
+        free(out);
+        return result;
+    }
+
+    static std::string serializePlan(json_serializer_plan_t *plan, const void *value) {
+        char *out = nullptr;
+        size_t len = 0;
+        EXPECT_EQ(0, jsonSerializer_serializeWithPlan(plan, value, &out, &len));
+        std::string result = out != nullptr ? out : "";
+        EXPECT_EQ(result.size(), len);
+        free(out);
+        return result;
+    }
+
+    /**
+     * Serializes and deserializes the value nrOfRoundTrips times with the DOM and the plan based serializer and
+     * prints the throughput of both. Also checks that both produce the same json.
+     */
+    static void measure(const std::string &shape, dyn_type *type, const void *value, int nrOfRoundTrips) {
+        json_serializer_plan_t *plan = nullptr;
+        ASSERT_EQ(0, jsonSerializer_createPlan(type, &plan));
+        std::string json = serializeDom(type, value);
+        EXPECT_EQ(json, serializePlan(plan, value));
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nrOfRoundTrips; ++i) {
+            char *out = nullptr;
+            EXPECT_EQ(0, jsonSerializer_serialize(type, value, &out));
+            void *result = nullptr;
+            EXPECT_EQ(0, jsonSerializer_deserialize(type, out, strlen(out), &result));
+            dynType_free(type, result);
+            free(out);
+        }
+        auto end = std::chrono::steady_clock::now();
+        double domNs = std::chrono::duration<double, std::nano>(end - start).count() / nrOfRoundTrips;
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nrOfRoundTrips; ++i) {
+            char *out = nullptr;
+            size_t outLen = 0;
+            EXPECT_EQ(0, jsonSerializer_serializeWithPlan(plan, value, &out, &outLen));
+            void *result = nullptr;
+            EXPECT_EQ(0, jsonSerializer_deserializeWithPlan(plan, out, outLen, &result));
+            dynType_free(type, result);
+            free(out);
+        }
+        end = std::chrono::steady_clock::now();
+        double planNs = std::chrono::duration<double, std::nano>(end - start).count() / nrOfRoundTrips;
+
+        double mb = (double)json.size() / (1024.0 * 1024.0);
+        std::cout << "json " << shape << ": " << json.size() << " bytes, dom " << domNs << " ns ("
+                  << mb / (domNs / 1e9) << " MB/s), plan " << planNs << " ns (" << mb / (planNs / 1e9)
+                  << " MB/s) per round trip" << std::endl;
+        jsonSerializer_destroyPlan(plan);
+    }
+};
+
+TEST_F(JsonSerializerPlanBenchmarkTests, NestedComplex) {
+    dyn_type *type = parse("{IJ{DDD x y z}{DDD x y z}Z id timestamp position velocity valid}");
+    ASSERT_TRUE(type != nullptr);
+    nested value{42, 1234567890123LL, {1.0, 2.5, 0.1}, {-1.0, -2.0, 1e300}, true};
+
+    measure("nested complex", type, &value, 20000);
+
+    json_serializer_plan_t *plan = nullptr;
+    ASSERT_EQ(0, jsonSerializer_getPlan(type, &plan));
+    json_serializer_plan_t *cached = nullptr;
+    ASSERT_EQ(0, jsonSerializer_getPlan(type, &cached));
+    EXPECT_EQ(plan, cached);
+
+    //members in a different order and extra whitespace
+    const char *input = R"( { "valid" : true, "velocity": {"z": 3, "y": -2.0, "x": -1E0}, "id": 42,
+        "position": {"x": 1.0, "y": 2.0, "z": 3.0}, "timestamp": 1234567890123 } )";
+    void *result = nullptr;
+    ASSERT_EQ(0, jsonSerializer_deserializeWithPlan(plan, input, strlen(input), &result));
+    auto *n = static_cast<nested*>(result);
+    EXPECT_EQ(42, n->id);
+    EXPECT_EQ(1234567890123LL, n->timestamp);
+    EXPECT_EQ(3.0, n->position.z);
+    EXPECT_EQ(-1.0, n->velocity.x);
+    EXPECT_EQ(3.0, n->velocity.z);
+    EXPECT_TRUE(n->valid);
+    dynType_free(type, result);
+
+    //unknown member, trailing data and truncated input
+    const char *unknown = R"({"id": 1, "unknown": 2})";
+    EXPECT_NE(0, jsonSerializer_deserializeWithPlan(plan, unknown, strlen(unknown), &result));
+    const char *trailing = R"({"id": 1} {})";
+    EXPECT_NE(0, jsonSerializer_deserializeWithPlan(plan, trailing, strlen(trailing), &result));
+    const char *truncated = R"({"id": 1, "position": {"x": 1.0)";
+    EXPECT_NE(0, jsonSerializer_deserializeWithPlan(plan, truncated, strlen(truncated), &result));
+
+    dynType_destroy(type); //also destroys the cached plan
+}
+
+TEST_F(JsonSerializerPlanBenchmarkTests, Sequences) {
+    dyn_type *doublesType = parse("[D");
+    ASSERT_TRUE(doublesType != nullptr);
+    std::vector<double> doubles(1024);
+    for (size_t i = 0; i < doubles.size(); ++i) {
+        doubles[i] = (double)i * 0.5;
+    }
+    double_seq doubleSeq{(uint32_t)doubles.size(), (uint32_t)doubles.size(), doubles.data()};
+    measure("sequence of 1024 doubles", doublesType, &doubleSeq, 500);
+
+    dyn_type *nestedType = parse("[{IJ{DDD x y z}{DDD x y z}Z id timestamp position velocity valid}");
+    ASSERT_TRUE(nestedType != nullptr);
+    std::vector<nested> items(256);
+    for (size_t i = 0; i < items.size(); ++i) {
+        items[i] = nested{(int32_t)i, (int64_t)i * 1000, {1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}, i % 2 == 0};
+    }
+    nested_seq nestedSeq{(uint32_t)items.size(), (uint32_t)items.size(), items.data()};
+    measure("sequence of 256 nested complex", nestedType, &nestedSeq, 200);
+
+    dynType_destroy(doublesType);
+    dynType_destroy(nestedType);
+}
+
+TEST_F(JsonSerializerPlanBenchmarkTests, Strings) {
+    dyn_type *type = parse("{ttt name description location}");
+    ASSERT_TRUE(type != nullptr);
+    std::string description(512, 'd');
+    strings value{(char*)"benchmark", (char*)description.c_str(), (char*)"somewhere"};
+    measure("strings", type, &value, 20000);
+
+    json_serializer_plan_t *plan = nullptr;
+    ASSERT_EQ(0, jsonSerializer_getPlan(type, &plan));
+
+    //escaping and NULL strings are handled the same as the DOM path
+    strings escaped{(char*)"quote \" backslash \\ tab \t \x01 \xc3\xa9", nullptr, (char*)"/"};
+    std::string json = serializeDom(type, &escaped);
+    EXPECT_EQ(json, serializePlan(plan, &escaped));
+    void *result = nullptr;
+    ASSERT_EQ(0, jsonSerializer_deserializeWithPlan(plan, json.c_str(), json.size(), &result));
+    auto *s = static_cast<strings*>(result);
+    EXPECT_STREQ(escaped.name, s->name);
+    EXPECT_EQ(nullptr, s->description);
+    EXPECT_STREQ("/", s->location);
+    dynType_free(type, result);
+
+    const char *unicode = R"({"name": "é😀\/", "location": null})";
+    ASSERT_EQ(0, jsonSerializer_deserializeWithPlan(plan, unicode, strlen(unicode), &result));
+    s = static_cast<strings*>(result);
+    EXPECT_STREQ("\xc3\xa9\xf0\x9f\x98\x80/", s->name);
+    EXPECT_EQ(nullptr, s->location);
+    dynType_free(type, result);
+
+    const char *loneSurrogate = R"({"name": "\ud83d"})";
+    EXPECT_NE(0, jsonSerializer_deserializeWithPlan(plan, loneSurrogate, strlen(loneSurrogate), &result));
+
+    dynType_destroy(type);
+}
+
+TEST_F(JsonSerializerPlanBenchmarkTests, EnumsAndTypedPointers) {
+    struct sub {
+        int64_t a;
+        int64_t b;
+    };
+    struct example {
+        int32_t id;
+        char *name;
+        int32_t result;
+        struct sub *sub;
+    };
+    dyn_type *type = parse("{It#OK=0;#NOK=1;#MAYBE=2;E*{JJ a b} id name result sub}");
+    ASSERT_TRUE(type != nullptr);
+    json_serializer_plan_t *plan = nullptr;
+    ASSERT_EQ(0, jsonSerializer_createPlan(type, &plan));
+
+    sub subValue{-1, 9007199254740993LL};
+    example value{1, (char*)"example", 2, &subValue};
+    std::string json = serializeDom(type, &value);
+    EXPECT_EQ(json, serializePlan(plan, &value));
+
+    void *result = nullptr;
+    ASSERT_EQ(0, jsonSerializer_deserializeWithPlan(plan, json.c_str(), json.size(), &result));
+    auto *e = static_cast<example*>(result);
+    EXPECT_EQ(1, e->id);
+    EXPECT_STREQ("example", e->name);
+    EXPECT_EQ(2, e->result);
+    ASSERT_TRUE(e->sub != nullptr);
+    EXPECT_EQ(-1, e->sub->a);
+    EXPECT_EQ(9007199254740993LL, e->sub->b);
+    dynType_free(type, result);
+
+    const char *unknownEnum = R"({"result": "UNKNOWN"})";
+    EXPECT_NE(0, jsonSerializer_deserializeWithPlan(plan, unknownEnum, strlen(unknownEnum), &result));
+
+    jsonSerializer_destroyPlan(plan);
+    dynType_destroy(type);
+}
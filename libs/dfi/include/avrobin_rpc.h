@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __AVROBIN_RPC_H_
+#define __AVROBIN_RPC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "dfi_log_util.h"
+#include "dyn_type.h"
+#include "dyn_function.h"
+#include "dyn_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Binary counterpart of json_rpc. Values are encoded with the avrobin serializer.
+ *
+ * Request = int:methodIndex fixed(4):methodSignatureHash [bytes:argument]*   (only the standard input arguments)
+ * Reply   = int:functionReturnValue boolean:hasResult [bytes:result]
+ *
+ * where int and boolean are avro binary encoded and bytes is an avro long length followed by the avrobin
+ * encoded value. Methods are addressed by their index in the interface descriptor instead of their signature.
+ * The (little endian) hash of the method signature is sent with the index, so that a request of a peer with a
+ * different version of the descriptor is rejected instead of calling another method.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(avrobinRpc);
+
+/**
+ * Returns the FNV-1a hash of a method signature (the method id in the interface descriptor).
+ */
+uint32_t avrobinRpc_methodSignatureHash(const char *signature);
+
+/**
+ * Returns the method of an avrobin rpc request without decoding the arguments.
+ * Returns an error if the interface has no method for the index or if the method signature hash does not match.
+ */
+int avrobinRpc_getMethod(dyn_interface_type *intf, const uint8_t *request, size_t requestLength, struct method_entry **method);
+
+int avrobinRpc_call(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLength, uint8_t **out, size_t *outLength);
+
+int avrobinRpc_prepareInvokeRequest(dyn_function_type *func, int methodIndex, const char *methodSignature, void *args[], uint8_t **out, size_t *outLength);
+int avrobinRpc_handleReply(dyn_function_type *func, const uint8_t *reply, size_t replyLength, void *args[]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -19,6 +19,8 @@
 #ifndef __AVROBIN_SERIALIZER_H_
 #define __AVROBIN_SERIALIZER_H_
 
+#include <sys/uio.h>
+
 #include "dfi_log_util.h"
 #include "dyn_type.h"
 #include "dyn_function.h"
@@ -33,8 +35,18 @@ DFI_SETUP_LOG_HEADER(avrobinSerializer);
 
 int avrobinSerializer_deserialize(dyn_type *type, const uint8_t *input, size_t inlen, void **result);
 
+/**
+ * Deserializes a message provided as one or more iovecs (e.g. as received by a pubsub admin).
+ */
+int avrobinSerializer_deserializeIoVec(dyn_type *type, const struct iovec *input, size_t inputIovLen, void **result);
+
 int avrobinSerializer_serialize(dyn_type *type, const void *input, uint8_t **output, size_t *outlen);
 
+/**
+ * Serializes into a caller provided buffer, without any allocation. Returns an error if the buffer is too small.
+ */
+int avrobinSerializer_serializeToBuffer(dyn_type *type, const void *input, uint8_t *buf, size_t bufLen, size_t *outlen);
+
 int avrobinSerializer_generateSchema(dyn_type *type, char **output);
 
 int avrobinSerializer_saveFile(const char *filename, const char *schema, const uint8_t *serdata, size_t serdatalen);
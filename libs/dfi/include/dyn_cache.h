@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef __DYN_CACHE_H_
+#define __DYN_CACHE_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+#include "dfi_log_util.h"
+#include "dyn_message.h"
+#include "dyn_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Process wide, reference counted cache of parsed descriptors, keyed by (a hash of) the descriptor content.
+ *
+ * Parsing the same descriptor content again returns the already parsed message/interface and increases its
+ * reference count. A cached message/interface is shared and must be treated as read only; e.g. dyn function
+ * closures are stored in the dyn function and cannot be created on a shared interface.
+ */
+
+//logging
+DFI_SETUP_LOG_HEADER(dynCache);
+
+int dynCache_getMessage(const char *descriptor, size_t length, dyn_message_type **out);
+int dynCache_getInterface(const char *descriptor, size_t length, dyn_interface_type **out);
+
+/**
+ * Decreases the reference count and destroys the message/interface when no longer used.
+ * Messages/interfaces not created by the cache (e.g. parsed from an avpr) are destroyed directly.
+ */
+void dynCache_releaseMessage(dyn_message_type *msg);
+void dynCache_releaseInterface(dyn_interface_type *intf);
+
+/**
+ * Reads the remaining content of a descriptor stream. The content is NUL terminated and must be freed by the caller.
+ */
+int dynCache_readDescriptor(FILE *stream, char **content, size_t *length);
+
+size_t dynCache_nrOfEntries(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
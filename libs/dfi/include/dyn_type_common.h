@@ -42,6 +42,8 @@ struct _dyn_type {
     struct types_head *referenceTypes; //NOTE: not owned
     struct types_head nestedTypesHead;
     struct meta_properties_head metaProperties;
+    void *jsonSerializerPlan; //NOTE: lazily compiled by the json serializer, destroyed with jsonSerializerPlanDestroy
+    void (*jsonSerializerPlanDestroy)(void *plan);
     union {
         struct {
             struct complex_type_entries_head entriesHead;
@@ -64,6 +66,7 @@ struct _dyn_type {
 dyn_type * dynType_findType(dyn_type *type, char *name);
 ffi_type * dynType_ffiType(dyn_type * type);
 void dynType_prepCif(ffi_type *type);
+void dynType_deepFree(dyn_type *type, void *loc, bool alsoDeleteSelf);
 
 #ifdef __cplusplus
 }
@@ -39,6 +39,28 @@ int jsonSerializer_deserializeJson(dyn_type *type, json_t *input, void **result)
 int jsonSerializer_serialize(dyn_type *type, const void* input, char **output);
 int jsonSerializer_serializeJson(dyn_type *type, const void* input, json_t **out);
 
+/*
+ * Precompiled marshalling plans.
+ *
+ * A plan is compiled once per dyn_type and contains flat member arrays with precomputed offsets, field name
+ * hashes and pre-rendered member keys. Serializing and deserializing with a plan streams directly between the
+ * (C) value and the json text without building a jansson DOM. The produced json is identical to
+ * jsonSerializer_serialize.
+ */
+typedef struct json_serializer_plan json_serializer_plan_t;
+
+int jsonSerializer_createPlan(dyn_type *type, json_serializer_plan_t **plan);
+void jsonSerializer_destroyPlan(json_serializer_plan_t *plan);
+
+/**
+ * Returns the plan for the provided type. The plan is compiled on first use, cached in the type and destroyed
+ * together with the type.
+ */
+int jsonSerializer_getPlan(dyn_type *type, json_serializer_plan_t **plan);
+
+int jsonSerializer_deserializeWithPlan(json_serializer_plan_t *plan, const char *input, size_t length, void **result);
+int jsonSerializer_serializeWithPlan(json_serializer_plan_t *plan, const void* input, char **output, size_t *outputLength);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,466 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "avrobin_rpc.h"
+#include "avrobin_serializer.h"
+#include "dyn_type.h"
+#include "dyn_interface.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ffi.h>
+
+#define MAX_VARINT_BUF_SIZE 10
+#define METHOD_SIGNATURE_HASH_SIZE 4
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+DFI_SETUP_LOG(avrobinRpc);
+
+typedef void (*gen_func_type)(void);
+
+struct generic_service_layout {
+    void *handle;
+    gen_func_type methods[];
+};
+
+typedef struct avrobin_rpc_reader {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+} avrobin_rpc_reader_t;
+
+static int avrobinRpc_writeLong(FILE *stream, int64_t val) {
+    uint64_t uval = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+    while (uval & ~0x7FULL) {
+        if (fputc((int)((uval & 0x7F) | 0x80), stream) == EOF) {
+            return ERROR;
+        }
+        uval >>= 7;
+    }
+    return fputc((int)uval, stream) == EOF ? ERROR : OK;
+}
+
+static int avrobinRpc_writeFixed32(FILE *stream, uint32_t val) {
+    uint8_t buf[METHOD_SIGNATURE_HASH_SIZE];
+    for (int i = 0; i < METHOD_SIGNATURE_HASH_SIZE; ++i) {
+        buf[i] = (uint8_t)(val >> (8 * i));
+    }
+    return fwrite(buf, 1, sizeof(buf), stream) == sizeof(buf) ? OK : ERROR;
+}
+
+static int avrobinRpc_writeBytes(FILE *stream, const uint8_t *bytes, size_t len) {
+    int status = avrobinRpc_writeLong(stream, (int64_t)len);
+    if (status == OK && len > 0 && fwrite(bytes, 1, len, stream) != len) {
+        status = ERROR;
+    }
+    return status;
+}
+
+/**
+ * Serializes the value with the avrobin serializer and writes it as avro bytes.
+ */
+static int avrobinRpc_writeValue(FILE *stream, dyn_type *type, const void *loc) {
+    uint8_t *buf = NULL;
+    size_t len = 0;
+    int status = avrobinSerializer_serialize(type, loc, &buf, &len);
+    if (status == OK) {
+        status = avrobinRpc_writeBytes(stream, buf, len);
+        free(buf);
+    }
+    return status;
+}
+
+static int avrobinRpc_readLong(avrobin_rpc_reader_t *reader, int64_t *val) {
+    uint64_t uval = 0;
+    for (int i = 0; i < MAX_VARINT_BUF_SIZE; ++i) {
+        if (reader->pos >= reader->len) {
+            LOG_ERROR("Unexpected end of avrobin rpc message");
+            return ERROR;
+        }
+        uint8_t b = reader->buf[reader->pos++];
+        uval |= (uint64_t)(b & 0x7F) << (7 * i);
+        if ((b & 0x80) == 0) {
+            *val = (int64_t)(uval >> 1) ^ -(int64_t)(uval & 1);
+            return OK;
+        }
+    }
+    LOG_ERROR("Varint too long");
+    return ERROR;
+}
+
+static int avrobinRpc_readInt(avrobin_rpc_reader_t *reader, int *val) {
+    int64_t lval = 0;
+    int status = avrobinRpc_readLong(reader, &lval);
+    *val = (int)lval;
+    return status;
+}
+
+static int avrobinRpc_readFixed32(avrobin_rpc_reader_t *reader, uint32_t *val) {
+    if (reader->len - reader->pos < METHOD_SIGNATURE_HASH_SIZE) {
+        LOG_ERROR("Unexpected end of avrobin rpc message");
+        return ERROR;
+    }
+    uint32_t result = 0;
+    for (int i = 0; i < METHOD_SIGNATURE_HASH_SIZE; ++i) {
+        result |= (uint32_t)reader->buf[reader->pos++] << (8 * i);
+    }
+    *val = result;
+    return OK;
+}
+
+static int avrobinRpc_readBoolean(avrobin_rpc_reader_t *reader, bool *val) {
+    if (reader->pos >= reader->len) {
+        LOG_ERROR("Unexpected end of avrobin rpc message");
+        return ERROR;
+    }
+    *val = reader->buf[reader->pos++] != 0;
+    return OK;
+}
+
+/**
+ * Reads avro bytes from the reader and deserializes them with the avrobin serializer.
+ */
+static int avrobinRpc_readValue(avrobin_rpc_reader_t *reader, dyn_type *type, void **result) {
+    int64_t len = 0;
+    int status = avrobinRpc_readLong(reader, &len);
+    if (status == OK && (len < 0 || (size_t)len > reader->len - reader->pos)) {
+        LOG_ERROR("Invalid value length %li in avrobin rpc message", (long)len);
+        status = ERROR;
+    }
+    if (status == OK) {
+        status = avrobinSerializer_deserialize(type, reader->buf + reader->pos, (size_t)len, result);
+        reader->pos += (size_t)len;
+    }
+    return status;
+}
+
+uint32_t avrobinRpc_methodSignatureHash(const char *signature) {
+    uint32_t hash = 2166136261U;
+    for (const char *c = signature; *c != '\0'; ++c) {
+        hash ^= (uint8_t)*c;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+/**
+ * Reads the method index and signature hash of a request and returns the matching method of the interface.
+ */
+static int avrobinRpc_readMethod(dyn_interface_type *intf, avrobin_rpc_reader_t *reader, struct method_entry **out) {
+    int methodIndex = -1;
+    uint32_t signatureHash = 0;
+    int status = avrobinRpc_readInt(reader, &methodIndex);
+    if (status == OK) {
+        status = avrobinRpc_readFixed32(reader, &signatureHash);
+    }
+    if (status != OK) {
+        return status;
+    }
+
+    struct methods_head *methods = NULL;
+    dynInterface_methods(intf, &methods);
+    struct method_entry *entry = NULL;
+    TAILQ_FOREACH(entry, methods, entries) {
+        if (entry->index == methodIndex) {
+            break;
+        }
+    }
+    if (entry == NULL) {
+        LOG_ERROR("Cannot find method with index %i", methodIndex);
+        return ERROR;
+    }
+    if (avrobinRpc_methodSignatureHash(entry->id) != signatureHash) {
+        LOG_ERROR("Method signature hash mismatch for method %s with index %i. Different interface descriptor versions?", entry->id, methodIndex);
+        return ERROR;
+    }
+    *out = entry;
+    return OK;
+}
+
+int avrobinRpc_getMethod(dyn_interface_type *intf, const uint8_t *request, size_t requestLength, struct method_entry **method) {
+    avrobin_rpc_reader_t reader = {.buf = request, .len = requestLength, .pos = 0};
+    return avrobinRpc_readMethod(intf, &reader, method);
+}
+
+int avrobinRpc_call(dyn_interface_type *intf, void *service, const uint8_t *request, size_t requestLength, uint8_t **out, size_t *outLength) {
+    int status = OK;
+    avrobin_rpc_reader_t reader = {.buf = request, .len = requestLength, .pos = 0};
+
+    struct method_entry *method = NULL;
+    status = avrobinRpc_readMethod(intf, &reader, &method);
+
+    if (status == OK && dynType_descriptorType(dynFunction_returnType(method->dynFunc)) != 'N') {
+        //NOTE To be able to handle exception only N as returnType is supported
+        LOG_ERROR("Only interface methods with a native int are supported. Found type '%c'", (char)dynType_descriptorType(dynFunction_returnType(method->dynFunc)));
+        status = ERROR;
+    }
+
+    if (status != OK) {
+        return status;
+    }
+
+    struct generic_service_layout *serv = service;
+    void *handle = serv->handle;
+    void (*fp)(void) = serv->methods[method->index];
+    dyn_function_type *func = method->dynFunc;
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    void *args[nrOfArgs];
+    memset(args, 0, sizeof(args));
+
+    void *ptr = NULL;
+    void *ptrToPtr = &ptr;
+
+    //setup and deserialize input
+    int i;
+    for (i = 0; i < nrOfArgs; ++i) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+            status = avrobinRpc_readValue(&reader, argType, &args[i]);
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            void **instPtr = calloc(1, sizeof(void*));
+            void *inst = NULL;
+            dyn_type *subType = NULL;
+            dynType_typedPointer_getTypedType(argType, &subType);
+            dynType_alloc(subType, &inst);
+            *instPtr = inst;
+            args[i] = instPtr;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            args[i] = &ptrToPtr;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__HANDLE) {
+            args[i] = &handle;
+        }
+
+        if (status != OK) {
+            break;
+        }
+    }
+    int nrOfSetupArgs = status == OK ? nrOfArgs : i;
+
+    ffi_sarg returnVal = 1;
+    if (status == OK) {
+        status = dynFunction_call(func, fp, (void *) &returnVal, args);
+    }
+
+    int funcCallStatus = (int)returnVal;
+    if (status == OK && funcCallStatus != 0) {
+        LOG_WARNING("Error calling remote endpoint function, got error code %i", funcCallStatus);
+    }
+
+    //free input args
+    for (i = 0; i < nrOfSetupArgs; ++i) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD && args[i] != NULL) {
+            if (dynType_descriptorType(argType) == 't') {
+                const char* isConst = dynType_getMetaInfo(argType, "const");
+                if (isConst != NULL && strncmp("true", isConst, 5) == 0) {
+                    dynType_free(argType, args[i]);
+                } else {
+                    //char* -> callee is now owner, no free for char seq needed
+                    //will free the actual pointer
+                    free(args[i]);
+                }
+            } else {
+                dynType_free(argType, args[i]);
+            }
+        }
+    }
+
+    //serialize and free output
+    uint8_t *response = NULL;
+    size_t responseLength = 0;
+    FILE *stream = status == OK ? open_memstream((char**)&response, &responseLength) : NULL;
+    if (status == OK && stream == NULL) {
+        LOG_ERROR("Error initializing memory stream for writing");
+        status = ERROR;
+    }
+    if (status == OK) {
+        status = avrobinRpc_writeLong(stream, funcCallStatus);
+    }
+    bool resultWritten = false;
+    for (i = 0; i < nrOfSetupArgs; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        bool writeResult = status == OK && funcCallStatus == 0 && !resultWritten;
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            if (writeResult) {
+                status = fputc(1, stream) == EOF ? ERROR : avrobinRpc_writeValue(stream, argType, args[i]);
+                resultWritten = true;
+            }
+            dyn_type *subType = NULL;
+            dynType_typedPointer_getTypedType(argType, &subType);
+            void **ptrToInst = (void**)args[i];
+            dynType_free(subType, *ptrToInst);
+            free(ptrToInst);
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT && ptr != NULL) {
+            dyn_type *typedType = NULL;
+            dynType_typedPointer_getTypedType(argType, &typedType);
+            if (dynType_descriptorType(typedType) == 't') {
+                if (writeResult) {
+                    status = fputc(1, stream) == EOF ? ERROR : avrobinRpc_writeValue(stream, typedType, &ptr);
+                    resultWritten = true;
+                }
+                free(ptr);
+            } else {
+                dyn_type *typedTypedType = NULL;
+                dynType_typedPointer_getTypedType(typedType, &typedTypedType);
+                if (writeResult) {
+                    status = fputc(1, stream) == EOF ? ERROR : avrobinRpc_writeValue(stream, typedTypedType, ptr);
+                    resultWritten = true;
+                }
+                dynType_free(typedTypedType, ptr);
+            }
+            ptr = NULL;
+        }
+    }
+    if (status == OK && !resultWritten && fputc(0, stream) == EOF) {
+        status = ERROR;
+    }
+    if (stream != NULL) {
+        fclose(stream);
+    }
+
+    if (status == OK) {
+        *out = response;
+        *outLength = responseLength;
+    } else {
+        free(response);
+    }
+
+    return status;
+}
+
+int avrobinRpc_prepareInvokeRequest(dyn_function_type *func, int methodIndex, const char *methodSignature, void *args[], uint8_t **out, size_t *outLength) {
+    int status = OK;
+
+    LOG_DEBUG("Calling remote function with index %i\n", methodIndex);
+    uint8_t *request = NULL;
+    size_t requestLength = 0;
+    FILE *stream = open_memstream((char**)&request, &requestLength);
+    if (stream == NULL) {
+        LOG_ERROR("Error initializing memory stream for writing");
+        return ERROR;
+    }
+
+    status = avrobinRpc_writeLong(stream, methodIndex);
+    if (status == OK) {
+        status = avrobinRpc_writeFixed32(stream, avrobinRpc_methodSignatureHash(methodSignature));
+    }
+
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    for (int i = 0; i < nrOfArgs; i +=1) {
+        dyn_type *type = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__STD) {
+            if (status == OK) {
+                status = avrobinRpc_writeValue(stream, type, args[i]);
+            }
+            if (dynType_descriptorType(type) == 't') {
+                const char *metaArgument = dynType_getMetaInfo(type, "const");
+                if (metaArgument == NULL || strncmp("true", metaArgument, 5) != 0) {
+                    char **str = args[i];
+                    free(*str); //char * as input -> got ownership -> free it.
+                }
+            }
+        } else {
+            //skip handle / output types
+        }
+    }
+    fclose(stream);
+
+    if (status == OK) {
+        *out = request;
+        *outLength = requestLength;
+    } else {
+        free(request);
+    }
+
+    return status;
+}
+
+int avrobinRpc_handleReply(dyn_function_type *func, const uint8_t *reply, size_t replyLength, void *args[]) {
+    avrobin_rpc_reader_t reader = {.buf = reply, .len = replyLength, .pos = 0};
+
+    int funcCallStatus = 0;
+    bool hasResult = false;
+    int status = avrobinRpc_readInt(&reader, &funcCallStatus);
+    if (status == OK) {
+        status = avrobinRpc_readBoolean(&reader, &hasResult);
+    }
+    if (status == OK && funcCallStatus != 0) {
+        LOG_WARNING("Remote function returned error code %i", funcCallStatus);
+    }
+
+    bool replyHandled = false;
+    int nrOfArgs = dynFunction_nrOfArguments(func);
+    for (int i = 0; status == OK && hasResult && i < nrOfArgs; i += 1) {
+        dyn_type *argType = dynFunction_argumentTypeForIndex(func, i);
+        enum dyn_function_argument_meta meta = dynFunction_argumentMetaForIndex(func, i);
+        if (meta == DYN_FUNCTION_ARGUMENT_META__PRE_ALLOCATED_OUTPUT) {
+            void *tmp = NULL;
+            void **out = (void **) args[i];
+            if (dynType_descriptorType(argType) == 't') {
+                status = avrobinRpc_readValue(&reader, argType, &tmp);
+                if (tmp != NULL) {
+                    size_t size = strnlen(((char *) *(char**) tmp), 1024 * 1024);
+                    memcpy(*out, *(void**) tmp, size);
+                }
+            } else {
+                dynType_typedPointer_getTypedType(argType, &argType);
+                status = avrobinRpc_readValue(&reader, argType, &tmp);
+                if (tmp != NULL) {
+                    memcpy(*out, tmp, dynType_size(argType));
+                }
+            }
+            dynType_free(argType, tmp);
+            replyHandled = true;
+        } else if (meta == DYN_FUNCTION_ARGUMENT_META__OUTPUT) {
+            dyn_type *subType = NULL;
+            dynType_typedPointer_getTypedType(argType, &subType);
+            if (dynType_descriptorType(subType) == 't') {
+                char ***out = (char ***) args[i];
+                char **ptrToString = NULL;
+                status = avrobinRpc_readValue(&reader, subType, (void**)&ptrToString);
+                if (ptrToString != NULL) {
+                    **out = *ptrToString;
+                    free(ptrToString);
+                }
+            } else {
+                dyn_type *subSubType = NULL;
+                dynType_typedPointer_getTypedType(subType, &subSubType);
+                void ***out = (void ***) args[i];
+                status = avrobinRpc_readValue(&reader, subSubType, *out);
+            }
+            replyHandled = true;
+        }
+        if (replyHandled) {
+            break;
+        }
+    }
+
+    if (status == OK && hasResult && !replyHandled) {
+        LOG_WARNING("Reply has a result output, but this is not handled by the remote function!");
+    }
+
+    return status;
+}
@@ -25,36 +25,59 @@
 #include <jansson.h>
 
 #define MAX_VARINT_BUF_SIZE 10
+#define INITIAL_WRITE_BUF_SIZE 128
+
+/**
+ * Cursor over a (ptr, len) input buffer.
+ */
+typedef struct avrobin_reader {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+} avrobin_reader_t;
+
+/**
+ * Cursor over a growing (or fixed, caller provided) output buffer.
+ */
+typedef struct avrobin_writer {
+    uint8_t *buf;
+    size_t len;
+    size_t cap;
+    bool fixed;
+} avrobin_writer_t;
 
 static int generate_sync(uint8_t **result);
 static int generate_record_name(char **result);
 
-static int avrobin_read_boolean(FILE *stream,bool *val);
-static int avrobin_read_int(FILE *stream,int32_t *val);
-static int avrobin_read_long(FILE *stream,int64_t *val);
-static int avrobin_read_float(FILE *stream,float *val);
-static int avrobin_read_double(FILE *stream,double *val);
-static int avrobin_read_string(FILE *stream,char **val);
+static int avrobin_writer_grow(avrobin_writer_t *writer, size_t size);
 
-static int avrobin_write_boolean(FILE *stream,bool val);
-static int avrobin_write_int(FILE *stream,int32_t val);
-static int avrobin_write_long(FILE *stream,int64_t val);
-static int avrobin_write_float(FILE *stream,float val);
-static int avrobin_write_double(FILE *stream,double val);
-static int avrobin_write_string(FILE *stream,const char *val);
+static int avrobin_read_boolean(avrobin_reader_t *reader,bool *val);
+static int avrobin_read_int(avrobin_reader_t *reader,int32_t *val);
+static int avrobin_read_long(avrobin_reader_t *reader,int64_t *val);
+static int avrobin_read_float(avrobin_reader_t *reader,float *val);
+static int avrobin_read_double(avrobin_reader_t *reader,double *val);
+static int avrobin_read_string(avrobin_reader_t *reader,char **val);
+
+static int avrobin_write_boolean(avrobin_writer_t *writer,bool val);
+static int avrobin_write_int(avrobin_writer_t *writer,int32_t val);
+static int avrobin_write_long(avrobin_writer_t *writer,int64_t val);
+static int avrobin_write_float(avrobin_writer_t *writer,float val);
+static int avrobin_write_double(avrobin_writer_t *writer,double val);
+static int avrobin_write_string(avrobin_writer_t *writer,const char *val);
+static int avrobin_write_fixed(avrobin_writer_t *writer,const uint8_t *val,size_t len);
 
 static int avrobin_schema_primitive(const char *tname, json_t **output);
 
-static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **result);
-static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, FILE *stream);
+static int avrobinSerializer_createType(dyn_type *type, avrobin_reader_t *reader, void **result);
+static int avrobinSerializer_parseAny(dyn_type *type, void *loc, avrobin_reader_t *reader);
+static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, avrobin_reader_t *reader);
+static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, avrobin_reader_t *reader);
+static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, avrobin_reader_t *reader);
 
-static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stream);
-static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, FILE *stream);
+static int avrobinSerializer_writeAny(dyn_type *type, void *loc, avrobin_writer_t *writer);
+static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, avrobin_writer_t *writer);
+static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, avrobin_writer_t *writer);
+static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, avrobin_writer_t *writer);
 
 static int avrobinSerializer_generateAny(dyn_type *type, json_t **output);
 static int avrobinSerializer_generateComplex(dyn_type *type, json_t **output);
@@ -69,44 +92,69 @@ static uint32_t record_name_counter;
 DFI_SETUP_LOG(avrobinSerializer);
 
 int avrobinSerializer_deserialize(dyn_type *type, const uint8_t *input, size_t inlen, void **result) {
-    int status = OK;
-
-    FILE *stream = fmemopen((void*)input, inlen, "rb");
+    avrobin_reader_t reader = {.buf = input, .len = inlen, .pos = 0};
 
-    if (stream != NULL) {
-        status = avrobinSerializer_createType(type, stream, result);
+    int status = avrobinSerializer_createType(type, &reader, result);
+    if (status != OK) {
+        LOG_ERROR("Error cannot deserialize avrobin.");
+    }
 
-        fclose(stream);
+    return status;
+}
 
-        if (status != OK) {
-            LOG_ERROR("Error cannot deserialize avrobin.");
-        }
-    } else {
-        status = ERROR;
-        LOG_ERROR("Error initializing memory stream for reading. Length was %d.", inlen);
+int avrobinSerializer_deserializeIoVec(dyn_type *type, const struct iovec *input, size_t inputIovLen, void **result) {
+    if (inputIovLen == 1) {
+        return avrobinSerializer_deserialize(type, input[0].iov_base, input[0].iov_len, result);
     }
 
+    //note a message split over multiple iovecs is gathered first, so that the decoder works on a single cursor
+    size_t inlen = 0;
+    for (size_t i = 0; i < inputIovLen; ++i) {
+        inlen += input[i].iov_len;
+    }
+    uint8_t *buf = malloc(inlen == 0 ? 1 : inlen);
+    if (buf == NULL) {
+        LOG_ERROR("Error allocating %zu bytes for gathering avrobin input.", inlen);
+        return ERROR;
+    }
+    size_t offset = 0;
+    for (size_t i = 0; i < inputIovLen; ++i) {
+        memcpy(buf + offset, input[i].iov_base, input[i].iov_len);
+        offset += input[i].iov_len;
+    }
+    int status = avrobinSerializer_deserialize(type, buf, inlen, result);
+    free(buf);
     return status;
 }
 
 int avrobinSerializer_serialize(dyn_type *type, const void *input, uint8_t **output, size_t *outlen) {
-    int status = OK;
+    avrobin_writer_t writer = {.buf = NULL, .len = 0, .cap = 0, .fixed = false};
 
-    FILE *stream = open_memstream((char**)output, outlen);
+    int status = avrobinSerializer_writeAny(type, (void*)input, &writer);
+    if (status == OK && writer.buf == NULL) {
+        //note keep the open_memstream behaviour of always returning an allocated output
+        status = avrobin_writer_grow(&writer, 1);
+    }
 
-    if (stream != NULL) {
-        status = avrobinSerializer_writeAny(type, (void*)input, stream);
+    if (status == OK) {
+        *output = writer.buf;
+        *outlen = writer.len;
+    } else {
+        free(writer.buf);
+        LOG_ERROR("Error cannot serialize avrobin.");
+    }
 
-        fclose(stream);
+    return status;
+}
 
-        if (status != OK) {
-            free(*output);
+int avrobinSerializer_serializeToBuffer(dyn_type *type, const void *input, uint8_t *buf, size_t bufLen, size_t *outlen) {
+    avrobin_writer_t writer = {.buf = buf, .len = 0, .cap = bufLen, .fixed = true};
 
-            LOG_ERROR("Error cannot serialize avrobin.");
-        }
+    int status = avrobinSerializer_writeAny(type, (void*)input, &writer);
+    if (status == OK) {
+        *outlen = writer.len;
     } else {
-        status = ERROR;
-        LOG_ERROR("Error initializing memory stream for writing.");
+        LOG_ERROR("Error cannot serialize avrobin in a buffer of %zu bytes.", bufLen);
     }
 
     return status;
@@ -134,93 +182,60 @@ int avrobinSerializer_generateSchema(dyn_type *type, char **output) {
 }
 
 int avrobinSerializer_saveFile(const char *filename, const char *schema, const uint8_t *serdata, size_t serdatalen) {
-    int status = OK;
+    static const uint8_t magic[4] = {'O', 'b', 'j', 1};
+    avrobin_writer_t writer = {.buf = NULL, .len = 0, .cap = 0, .fixed = false};
+    uint8_t *sync = NULL;
 
-    FILE *file = fopen(filename, "wb");
+    int status = generate_sync(&sync);
+    if (status == OK) {
+        status = avrobin_write_fixed(&writer, magic, sizeof(magic));
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&writer, 1);
+    }
+    if (status == OK) {
+        status = avrobin_write_string(&writer, "avro.schema");
+    }
+    if (status == OK) {
+        status = avrobin_write_string(&writer, schema);
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&writer, 0);
+    }
+    if (status == OK) {
+        status = avrobin_write_fixed(&writer, sync, 16);
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&writer, 1);
+    }
+    if (status == OK) {
+        status = avrobin_write_long(&writer, serdatalen);
+    }
+    if (status == OK) {
+        status = avrobin_write_fixed(&writer, serdata, serdatalen);
+    }
+    if (status == OK) {
+        status = avrobin_write_fixed(&writer, sync, 16);
+    }
 
-    if (file != NULL) {
-        if (status == OK) {
-            if (fputc('O', file) == EOF) {
-                status = ERROR;
-            }
-        }
-        if (status == OK) {
-            if (fputc('b', file) == EOF) {
-                status = ERROR;
-            }
-        }
-        if (status == OK) {
-            if (fputc('j', file) == EOF) {
-                status = ERROR;
-            }
-        }
-        if (status == OK) {
-            if (fputc(1, file) == EOF) {
+    if (status == OK) {
+        FILE *file = fopen(filename, "wb");
+        if (file != NULL) {
+            if (fwrite(writer.buf, 1, writer.len, file) != writer.len) {
                 status = ERROR;
             }
+            fclose(file);
+        } else {
+            status = ERROR;
         }
-        if (status == OK) {
-            status = avrobin_write_long(file, 1);
-        }
-        if (status == OK) {
-            status = avrobin_write_string(file, "avro.schema");
-        }
-        if (status == OK) {
-            status = avrobin_write_string(file, schema);
-        }
-        if (status == OK) {
-            status = avrobin_write_long(file, 0);
-        }
-        if (status == OK) {
-            uint8_t *sync = NULL;
-            status = generate_sync(&sync);
-            if (status == OK) {
-                for (int i=0; i<16; i++) {
-                    if (status == OK) {
-                        if (fputc(sync[i], file) == EOF) {
-                            status = ERROR;
-                        }
-                    }
-                    if (status != OK) break;
-                }
-                if (status == OK) {
-                    status = avrobin_write_long(file, 1);
-                }
-                if (status == OK) {
-                    status = avrobin_write_long(file, serdatalen);
-                }
-                if (status == OK) {
-                    for (int i=0; i<serdatalen; i++) {
-                        if (status == OK) {
-                            if (fputc(serdata[i], file) == EOF) {
-                                status = ERROR;
-                            }
-                        }
-                        if (status != OK) break;
-                    }
-                }
-                for (int i=0; i<16; i++) {
-                    if (status == OK) {
-                        if (fputc(sync[i], file) == EOF) {
-                            status = ERROR;
-                        }
-                    }
-                    if (status != OK) break;
-                }
-
-                free(sync);
-            }
-        }
-
-        fclose(file);
-    } else {
-        status = ERROR;
     }
 
+    free(sync);
+    free(writer.buf);
     return status;
 }
 
-static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **result) {
+static int avrobinSerializer_createType(dyn_type *type, avrobin_reader_t *reader, void **result) {
     int status = OK;
     void *inst = NULL;
 
@@ -228,7 +243,7 @@ static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **res
 
     if (status == OK) {
         assert(inst != NULL);
-        status = avrobinSerializer_parseAny(type, inst, stream);
+        status = avrobinSerializer_parseAny(type, inst, reader);
 
         if (status == OK) {
             *result = inst;
@@ -241,7 +256,7 @@ static int avrobinSerializer_createType(dyn_type *type, FILE *stream, void **res
     return status;
 }
 
-static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseAny(dyn_type *type, void *loc, avrobin_reader_t *reader) {
     int status = OK;
 
     dyn_type *subType = NULL;
@@ -270,90 +285,90 @@ static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
     switch (c) {
         case 'Z' :
             z = loc;
-            status = avrobin_read_boolean(stream,&avro_boolean);
+            status = avrobin_read_boolean(reader,&avro_boolean);
             if (status == OK) {
                 *z = avro_boolean;
             }
             break;
         case 'F' :
             f = loc;
-            status = avrobin_read_float(stream,&avro_float);
+            status = avrobin_read_float(reader,&avro_float);
             if (status == OK) {
                 *f = avro_float;
             }
             break;
         case 'D' :
             d = loc;
-            status = avrobin_read_double(stream,&avro_double);
+            status = avrobin_read_double(reader,&avro_double);
             if (status == OK) {
                 *d = avro_double;
             }
             break;
         case 'N' :
             n = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *n = (int)avro_int;
             }
             break;
         case 'B' :
             b = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *b = (char)avro_int;
             }
             break;
         case 'S' :
             s = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *s = (int16_t)avro_int;
             }
             break;
         case 'I' :
             i = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *i = avro_int;
             }
             break;
         case 'J' :
             l = loc;
-            status = avrobin_read_long(stream,&avro_long);
+            status = avrobin_read_long(reader,&avro_long);
             if (status == OK) {
                 *l = avro_long;
             }
             break;
         case 'b' :
             ub = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *ub = (uint8_t)avro_int;
             }
             break;
         case 's' :
             us = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *us = (uint16_t)avro_int;
             }
             break;
         case 'i' :
             ui = loc;
-            status = avrobin_read_int(stream,&avro_int);
+            status = avrobin_read_int(reader,&avro_int);
             if (status == OK) {
                 *ui = (uint32_t)avro_int;
             }
             break;
         case 'j' :
             ul = loc;
-            status = avrobin_read_long(stream,&avro_long);
+            status = avrobin_read_long(reader,&avro_long);
             if (status == OK) {
                 *ul = (uint64_t)avro_long;
             }
             break;
         case 't' :
-            status = avrobin_read_string(stream,&avro_string);
+            status = avrobin_read_string(reader,&avro_string);
             if (status == OK) {
                 status = dynType_text_allocAndInit(type, loc, avro_string);
                 free(avro_string);
@@ -361,27 +376,27 @@ static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
             break;
         case '[' :
             if (status == OK) {
-                status = avrobinSerializer_parseSequence(type, loc, stream);
+                status = avrobinSerializer_parseSequence(type, loc, reader);
             }
             break;
         case '{' :
             if (status == OK) {
-                status = avrobinSerializer_parseComplex(type, loc, stream);
+                status = avrobinSerializer_parseComplex(type, loc, reader);
             }
             break;
         case '*' :
             status = dynType_typedPointer_getTypedType(type, &subType);
             if (status == OK) {
-                status = avrobinSerializer_createType(subType, stream, (void**)loc);
+                status = avrobinSerializer_createType(subType, reader, (void**)loc);
             }
             break;
         case 'E' :
             if (status == OK) {
-                status = avrobinSerializer_parseEnum(type, loc, stream);
+                status = avrobinSerializer_parseEnum(type, loc, reader);
             }
             break;
         case 'l':
-            status = avrobinSerializer_parseAny(type->ref.ref, loc, stream);
+            status = avrobinSerializer_parseAny(type->ref.ref, loc, reader);
             break;
         case 'P' :
             status = ERROR;
@@ -396,7 +411,7 @@ static int avrobinSerializer_parseAny(dyn_type *type, void *loc, FILE *stream) {
     return status;
 }
 
-static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, avrobin_reader_t *reader) {
     int status = OK;
 
     struct complex_type_entry *entry = NULL;
@@ -409,23 +424,16 @@ static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, FILE *strea
 
     if (status == OK) {
         TAILQ_FOREACH(entry, entries, entries) {
-            index = dynType_complex_indexForName(type, entry->name);
+            index += 1; //note entries are in member order, so no lookup by name needed
 
-            if (index < 0) {
-                status = ERROR;
-                LOG_ERROR("Cannot find index for member '%s'.", entry->name);
-            }
-
-            if (status == OK) {
-                status = dynType_complex_dynTypeAt(type, index, &subType);
-            }
+            status = dynType_complex_dynTypeAt(type, index, &subType);
 
             if (status == OK) {
                 status = dynType_complex_valLocAt(type, index, loc, &subLoc);
             }
 
             if (status == OK) {
-                status = avrobinSerializer_parseAny(subType, subLoc, stream);
+                status = avrobinSerializer_parseAny(subType, subLoc, reader);
             }
 
             if (status != OK) {
@@ -437,7 +445,7 @@ static int avrobinSerializer_parseComplex(dyn_type *type, void *loc, FILE *strea
     return status;
 }
 
-static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, avrobin_reader_t *reader) {
     /* Avro 1.8.1 Specification
      * Arrays
      * Arrays are encoded as a series of blocks. Each block consists of a long count value, followed by that many array items. A block with count zero indicates the end of the array. Each item is encoded per the array's item schema.
@@ -459,7 +467,7 @@ static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stre
     int64_t blockSize = 0;
 
     do {
-        status = avrobin_read_long(stream, &blockCount);
+        status = avrobin_read_long(reader, &blockCount);
         if (status != OK) {
             break;
         } else if (blockCount < 0) {
@@ -482,7 +490,10 @@ static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stre
                 if (status != OK) {
                     break;
                 }
-                avrobinSerializer_parseAny(itemType, itemLoc, stream);
+                status = avrobinSerializer_parseAny(itemType, itemLoc, reader);
+                if (status != OK) {
+                    break;
+                }
             }
             if (status != OK) {
                 break;
@@ -491,14 +502,16 @@ static int avrobinSerializer_parseSequence(dyn_type *type, void *loc, FILE *stre
     } while (blockCount != 0);
 
     if (status != OK) {
-        dynType_free(type, loc);
+        //note loc is part of the parent instance, so only free the content and reset the sequence
+        dynType_deepFree(type, loc, false);
+        dynType_sequence_init(type, loc);
     }
     return status;
 }
 
-static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, avrobin_reader_t *reader) {
     int32_t index;
-    if (avrobin_read_int(stream, &index) != OK) {
+    if (avrobin_read_int(reader, &index) != OK) {
         return ERROR;
     }
     if (index < 0) {
@@ -519,7 +532,7 @@ static int avrobinSerializer_parseEnum(dyn_type *type, void *loc, FILE *stream)
     return ERROR;
 }
 
-static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_writeAny(dyn_type *type, void *loc, avrobin_writer_t *writer) {
     int status = OK;
 
     int descriptor = dynType_descriptorType(type);
@@ -541,72 +554,72 @@ static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream) {
     switch (descriptor) {
         case 'Z' :
             z = loc;
-            status = avrobin_write_boolean(stream,*z);
+            status = avrobin_write_boolean(writer,*z);
             break;
         case 'B' :
             b = loc;
-            status = avrobin_write_int(stream,(int32_t)*b);
+            status = avrobin_write_int(writer,(int32_t)*b);
             break;
         case 'S' :
             s = loc;
-            status = avrobin_write_int(stream,(int32_t)*s);
+            status = avrobin_write_int(writer,(int32_t)*s);
             break;
         case 'I' :
             i = loc;
-            status = avrobin_write_int(stream,*i);
+            status = avrobin_write_int(writer,*i);
             break;
         case 'J' :
             l = loc;
-            status = avrobin_write_long(stream,*l);
+            status = avrobin_write_long(writer,*l);
             break;
         case 'b' :
             ub = loc;
-            status = avrobin_write_int(stream,(int32_t)*ub);
+            status = avrobin_write_int(writer,(int32_t)*ub);
             break;
         case 's' :
             us = loc;
-            status = avrobin_write_int(stream,(int32_t)*us);
+            status = avrobin_write_int(writer,(int32_t)*us);
             break;
         case 'i' :
             ui = loc;
-            status = avrobin_write_int(stream,(int32_t)*ui);
+            status = avrobin_write_int(writer,(int32_t)*ui);
             break;
         case 'j' :
             ul = loc;
-            status = avrobin_write_long(stream,(int64_t)*ul);
+            status = avrobin_write_long(writer,(int64_t)*ul);
             break;
         case 'N' :
             n = loc;
-            status = avrobin_write_int(stream,(int32_t)*n);
+            status = avrobin_write_int(writer,(int32_t)*n);
             break;
         case 'F' :
             f = loc;
-            status = avrobin_write_float(stream,*f);
+            status = avrobin_write_float(writer,*f);
             break;
         case 'D' :
             d = loc;
-            status = avrobin_write_double(stream,*d);
+            status = avrobin_write_double(writer,*d);
             break;
         case 't' :
-            status = avrobin_write_string(stream,*(const char**)loc);
+            status = avrobin_write_string(writer,*(const char**)loc);
             break;
         case '*' :
             status = dynType_typedPointer_getTypedType(type, &subType);
             if (status == OK) {
-                status = avrobinSerializer_writeAny(subType, *(void**)loc, stream);
+                status = avrobinSerializer_writeAny(subType, *(void**)loc, writer);
             }
             break;
         case '{' :
-            status = avrobinSerializer_writeComplex(type, loc, stream);
+            status = avrobinSerializer_writeComplex(type, loc, writer);
             break;
         case '[' :
-            status = avrobinSerializer_writeSequence(type, loc, stream);
+            status = avrobinSerializer_writeSequence(type, loc, writer);
             break;
         case 'E' :
-            status = avrobinSerializer_writeEnum(type, loc, stream);
+            status = avrobinSerializer_writeEnum(type, loc, writer);
             break;
         case 'l':
-            status = avrobinSerializer_writeAny(type->ref.ref, loc, stream);
+            status = avrobinSerializer_writeAny(type->ref.ref, loc, writer);
             break;
         case 'P' :
             status = ERROR;
@@ -621,7 +634,7 @@ static int avrobinSerializer_writeAny(dyn_type *type, void *loc, FILE *stream) {
     return status;
 }
 
-static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, avrobin_writer_t *writer) {
     int status = OK;
 
     struct complex_type_entry *entry = NULL;
@@ -634,23 +647,16 @@ static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, FILE *strea
 
     if (status == OK) {
         TAILQ_FOREACH(entry, entries, entries) {
-            index = dynType_complex_indexForName(type, entry->name);
-
-            if (index < 0) {
-                status = ERROR;
-                LOG_ERROR("Cannot find index for member '%s'.", entry->name);
-            }
+            index += 1; //note entries are in member order, so no lookup by name needed
 
-            if (status == OK) {
-                status = dynType_complex_dynTypeAt(type, index, &subType);
-            }
+            status = dynType_complex_dynTypeAt(type, index, &subType);
 
             if (status == OK) {
                 status = dynType_complex_valLocAt(type, index, loc, &subLoc);
             }
 
             if (status == OK) {
-                status = avrobinSerializer_writeAny(subType, subLoc, stream);
+                status = avrobinSerializer_writeAny(subType, subLoc, writer);
             }
 
             if (status != OK) {
@@ -662,13 +668,13 @@ static int avrobinSerializer_writeComplex(dyn_type *type, void *loc, FILE *strea
     return status;
 }
 
-static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, avrobin_writer_t *writer) {
     uint32_t arrayLen = dynType_sequence_length(loc);
 
     dyn_type *itemType = dynType_sequence_itemType(type);
     void *itemLoc = NULL;
 
-    if (avrobin_write_long(stream, arrayLen) != OK) {
+    if (avrobin_write_long(writer, arrayLen) != OK) {
         LOG_ERROR("Failed to write array block count.");
         return ERROR;
     }
@@ -677,12 +683,12 @@ static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stre
         if (dynType_sequence_locForIndex(type, loc, i, &itemLoc)) {
             return ERROR;
         }
-        if (avrobinSerializer_writeAny(itemType, itemLoc, stream) != OK) {
+        if (avrobinSerializer_writeAny(itemType, itemLoc, writer) != OK) {
             return ERROR;
         }
     }
 
-    if (avrobin_write_long(stream, 0) != OK) {
+    if (avrobin_write_long(writer, 0) != OK) {
         LOG_ERROR("Failed to write array block count.");
         return ERROR;
     }
@@ -690,7 +696,7 @@ static int avrobinSerializer_writeSequence(dyn_type *type, void *loc, FILE *stre
     return OK;
 }
 
-static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, FILE *stream) {
+static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, avrobin_writer_t *writer) {
     char enum_value_str[16];
     if (sprintf(enum_value_str, "%d", *(int32_t*)loc) < 0) {
         return ERROR;
@@ -701,7 +707,7 @@ static int avrobinSerializer_writeEnum(dyn_type *type, void *loc, FILE *stream)
 
     TAILQ_FOREACH(entry, &type->metaProperties, entries) {
         if (0 == strcmp(enum_value_str, entry->value)) {
-            return avrobin_write_int(stream, index);
+            return avrobin_write_int(writer, index);
         }
         index++;
     }
@@ -839,16 +845,9 @@ static int avrobinSerializer_generateComplex(dyn_type *type, json_t **output) {
 
     if (status == OK) {
         TAILQ_FOREACH(entry, entries, entries) {
-            index = dynType_complex_indexForName(type, entry->name);
+            index += 1; //note entries are in member order, so no lookup by name needed
 
-            if (index < 0) {
-                status = ERROR;
-                LOG_ERROR("Cannot find index for member '%s'.", entry->name);
-            }
-
-            if (status == OK) {
-                status = dynType_complex_dynTypeAt(type, index, &subType);
-            }
+            status = dynType_complex_dynTypeAt(type, index, &subType);
 
             if (status == OK) {
                 field_object = json_object();
@@ -1117,67 +1116,102 @@ static int generate_record_name(char **result) {
     return OK;
 }
 
-static int avrobin_read_boolean(FILE *stream,bool *val) {
-    int c = fgetc(stream);
-    if (c == EOF) {
-        LOG_ERROR("Unexpected end of file.");
+static int avrobin_writer_grow(avrobin_writer_t *writer, size_t size) {
+    size_t needed = writer->len + size;
+    if (writer->fixed) {
+        LOG_ERROR("Output buffer too small, need %zu bytes but buffer size is %zu.", needed, writer->cap);
+        return ERROR;
+    }
+    size_t newCap = writer->cap == 0 ? INITIAL_WRITE_BUF_SIZE : writer->cap * 2;
+    while (newCap < needed) {
+        newCap *= 2;
+    }
+    uint8_t *newBuf = realloc(writer->buf, newCap);
+    if (newBuf == NULL) {
+        LOG_ERROR("Failed to allocate memory for avrobin output.");
+        return ERROR;
+    }
+    writer->buf = newBuf;
+    writer->cap = newCap;
+    return OK;
+}
+
+/**
+ * Ensures the writer has room for size additional bytes. Only grows (realloc) when the buffer is full.
+ */
+static inline int avrobin_writer_reserve(avrobin_writer_t *writer, size_t size) {
+    if (writer->cap - writer->len >= size) {
+        return OK;
+    }
+    return avrobin_writer_grow(writer, size);
+}
+
+static inline int avrobin_reader_check(avrobin_reader_t *reader, size_t size) {
+    if (reader->len - reader->pos >= size) {
+        return OK;
+    }
+    LOG_ERROR("Unexpected end of input.");
+    return ERROR;
+}
+
+static int avrobin_read_boolean(avrobin_reader_t *reader,bool *val) {
+    if (avrobin_reader_check(reader, 1) != OK) {
         return ERROR;
     }
+    uint8_t c = reader->buf[reader->pos++];
     if (c!=0 && c!=1) {
         LOG_ERROR("Unexpected value for boolean.");
         return ERROR;
     }
-    if (c == 0) {
-        *val = false;
-    } else {
-        *val = true;
-    }
+    *val = c == 1;
     return OK;
 }
 
-static int avrobin_read_int(FILE *stream,int32_t *val) {
+static int avrobin_read_int(avrobin_reader_t *reader,int32_t *val) {
     int64_t lval;
-    int status = avrobin_read_long(stream,&lval);
+    int status = avrobin_read_long(reader,&lval);
     //TODO Do range check.
     *val = (int32_t)lval;
     return status;
 }
 
-static int avrobin_read_long(FILE *stream,int64_t *val) {
-    uint64_t uval = 0;
-    uint8_t b;
-    int c;
-    int offset = 0;
-    do {
-        if (offset == MAX_VARINT_BUF_SIZE) {
+static int avrobin_read_long(avrobin_reader_t *reader,int64_t *val) {
+    const uint8_t *p = reader->buf + reader->pos;
+    size_t avail = reader->len - reader->pos;
+    uint64_t uval;
+
+    if (avail > 0 && p[0] < 0x80) {
+        //single byte varint (-64..63), the common case for lengths, counts and small values
+        uval = p[0];
+        reader->pos += 1;
+    } else {
+        size_t max = avail < MAX_VARINT_BUF_SIZE ? avail : MAX_VARINT_BUF_SIZE;
+        size_t i = 0;
+        uval = 0;
+        for (; i < max; ++i) {
+            uval |= (uint64_t) (p[i] & 0x7F) << (7 * i);
+            if ((p[i] & 0x80) == 0) {
+                break;
+            }
+        }
+        if (i == MAX_VARINT_BUF_SIZE) {
             LOG_ERROR("Varint too long.");
             return ERROR;
-        }
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
+        } else if (i == max) {
+            LOG_ERROR("Unexpected end of input.");
             return ERROR;
         }
-        b = (uint8_t)c;
-        uval |= (uint64_t) (b & 0x7F) << (7 * offset);
-        ++offset;
+        reader->pos += i + 1;
     }
-    while (b & 0x80);
-    *val = ((uval >> 1) ^ -(uval & 1));
+    *val = (int64_t)((uval >> 1) ^ -(uval & 1));
     return OK;
 }
 
-static int avrobin_read_float(FILE *stream,float *val) {
-    uint8_t b[4];
-    int c;
-    for (int i=0;i<4;i++) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
-            return ERROR;
-        }
-        b[i] = (uint8_t)c;
+static int avrobin_read_float(avrobin_reader_t *reader,float *val) {
+    if (avrobin_reader_check(reader, 4) != OK) {
+        return ERROR;
     }
+    const uint8_t *b = reader->buf + reader->pos;
     union {
         float f;
         uint32_t i;
@@ -1188,20 +1222,15 @@ static int avrobin_read_float(FILE *stream,float *val) {
     ((uint32_t)b[2] << 16) |
     ((uint32_t)b[3] << 24);
     *val = v.f;
+    reader->pos += 4;
     return OK;
 }
 
-static int avrobin_read_double(FILE *stream,double *val) {
-    uint8_t b[8];
-    int c;
-    for (int i=0;i<8;i++) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
-            return ERROR;
-        }
-        b[i] = (uint8_t)c;
+static int avrobin_read_double(avrobin_reader_t *reader,double *val) {
+    if (avrobin_reader_check(reader, 8) != OK) {
+        return ERROR;
     }
+    const uint8_t *b = reader->buf + reader->pos;
     union {
         double d;
         uint64_t i;
@@ -1216,12 +1245,13 @@ static int avrobin_read_double(FILE *stream,double *val) {
     ((uint64_t)b[6] << 48) |
     ((uint64_t)b[7] << 56);
     *val = v.d;
+    reader->pos += 8;
     return OK;
 }
 
-static int avrobin_read_string(FILE *stream,char **val) {
+static int avrobin_read_string(avrobin_reader_t *reader,char **val) {
     int64_t len;
-    if (avrobin_read_long(stream,&len) != OK) {
+    if (avrobin_read_long(reader,&len) != OK) {
         LOG_ERROR("Failed to read string length.");
         return ERROR;
     }
@@ -1229,64 +1259,56 @@ static int avrobin_read_string(FILE *stream,char **val) {
         LOG_ERROR("Negative string length.");
         return ERROR;
     }
+    if (avrobin_reader_check(reader, (size_t)len) != OK) {
+        return ERROR;
+    }
     *val = (char*)malloc(sizeof(char) * (len+1));
     if (*val == NULL) {
         LOG_ERROR("Failed to allocate memory for avro string.");
         return ERROR;
     }
-    int c;
-    for (int64_t i=0;i<len;i++) {
-        c = fgetc(stream);
-        if (c == EOF) {
-            LOG_ERROR("Unexpected end of file.");
-            free(*val);
-            return ERROR;
-        }
-        (*val)[i] = (char)c;
-    }
+    memcpy(*val, reader->buf + reader->pos, (size_t)len);
     (*val)[len] = '\0';
+    reader->pos += (size_t)len;
     return OK;
 }
 
-static int avrobin_write_boolean(FILE *stream,bool val) {
-    int r;
-    if (val) {
-        r = fputc(1, stream);
-    } else {
-        r = fputc(0, stream);
-    }
-    if (r == EOF) {
-        LOG_ERROR("Write error.");
+static int avrobin_write_boolean(avrobin_writer_t *writer,bool val) {
+    if (avrobin_writer_reserve(writer, 1) != OK) {
         return ERROR;
     }
+    writer->buf[writer->len++] = val ? 1 : 0;
     return OK;
 }
 
-static int avrobin_write_int(FILE *stream,int32_t val) {
+static int avrobin_write_int(avrobin_writer_t *writer,int32_t val) {
     int64_t lval = val;
-    return avrobin_write_long(stream,lval);
+    return avrobin_write_long(writer,lval);
 }
 
-static int avrobin_write_long(FILE *stream,int64_t val) {
-    uint64_t uval = (val << 1) ^ (val >> 63);
-    uint8_t b[MAX_VARINT_BUF_SIZE];
-    int bytes_written = 0;
+static int avrobin_write_long(avrobin_writer_t *writer,int64_t val) {
+    uint64_t uval = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+    uint8_t tmp[MAX_VARINT_BUF_SIZE];
+    bool direct = writer->cap - writer->len >= MAX_VARINT_BUF_SIZE;
+    uint8_t *b = direct ? writer->buf + writer->len : tmp;
+    size_t bytes_written = 0;
     while (uval & ~0x7F) {
         b[bytes_written++] = (uint8_t)((uval & 0x7F) | 0x80);
         uval >>= 7;
     }
     b[bytes_written++] = (uint8_t)uval;
-    for (int i=0;i<bytes_written;i++) {
-        if (fputc(b[i],stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
+    if (direct) {
+        writer->len += bytes_written;
+        return OK;
     }
-    return OK;
+    return avrobin_write_fixed(writer, tmp, bytes_written);
 }
 
-static int avrobin_write_float(FILE *stream,float val) {
-    uint8_t b[4];
+static int avrobin_write_float(avrobin_writer_t *writer,float val) {
+    if (avrobin_writer_reserve(writer, 4) != OK) {
+        return ERROR;
+    }
+    uint8_t *b = writer->buf + writer->len;
     union {
         float f;
         uint32_t i;
@@ -1296,17 +1318,15 @@ static int avrobin_write_float(FILE *stream,float val) {
     b[1] = (uint8_t)((v.i & 0x0000FF00) >> 8);
     b[2] = (uint8_t)((v.i & 0x00FF0000) >> 16);
     b[3] = (uint8_t)((v.i & 0xFF000000) >> 24);
-    for (int i=0;i<4;i++) {
-        if (fputc(b[i],stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
-    }
+    writer->len += 4;
     return OK;
 }
 
-static int avrobin_write_double(FILE *stream,double val) {
-    uint8_t b[8];
+static int avrobin_write_double(avrobin_writer_t *writer,double val) {
+    if (avrobin_writer_reserve(writer, 8) != OK) {
+        return ERROR;
+    }
+    uint8_t *b = writer->buf + writer->len;
     union {
         double d;
         uint64_t i;
@@ -1320,28 +1340,29 @@ static int avrobin_write_double(FILE *stream,double val) {
     b[5] = (uint8_t)((v.i & 0x0000FF0000000000) >> 40);
     b[6] = (uint8_t)((v.i & 0x00FF000000000000) >> 48);
     b[7] = (uint8_t)((v.i & 0xFF00000000000000) >> 56);
-    for (int i=0;i<8;i++) {
-        if (fputc(b[i],stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
-    }
+    writer->len += 8;
     return OK;
 }
 
-static int avrobin_write_string(FILE *stream,const char *val) {
+static int avrobin_write_string(avrobin_writer_t *writer,const char *val) {
     assert(val != NULL);
     size_t len = strlen(val);
-    if (avrobin_write_long(stream, (int64_t)len) != OK) {
+    if (avrobin_write_long(writer, (int64_t)len) != OK) {
         LOG_ERROR("Failed to write string length.");
         return ERROR;
     }
-    for (size_t i=0;i<len;i++) {
-        if (fputc((unsigned char)(val[i]),stream) == EOF) {
-            LOG_ERROR("Write error.");
-            return ERROR;
-        }
+    return avrobin_write_fixed(writer, (const uint8_t*)val, len);
+}
+
+static int avrobin_write_fixed(avrobin_writer_t *writer,const uint8_t *val,size_t len) {
+    if (len == 0) {
+        return OK;
+    }
+    if (avrobin_writer_reserve(writer, len) != OK) {
+        return ERROR;
     }
+    memcpy(writer->buf + writer->len, val, len);
+    writer->len += len;
     return OK;
 }
 
@@ -0,0 +1,258 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "dyn_cache.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#define DYN_CACHE_READ_CHUNK_SIZE 4096
+
+static const int OK = 0;
+static const int ERROR = 1;
+
+DFI_SETUP_LOG(dynCache);
+
+enum dyn_cache_kind {
+    DYN_CACHE_MESSAGE,
+    DYN_CACHE_INTERFACE
+};
+
+struct dyn_cache_entry {
+    enum dyn_cache_kind kind;
+    uint64_t hash;
+    size_t length;
+    char *content;
+    void *parsed;
+    unsigned int refCount;
+    struct dyn_cache_entry *next;
+};
+
+static pthread_mutex_t g_cacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static struct dyn_cache_entry *g_cacheEntries = NULL; //protected by g_cacheMutex
+
+static uint64_t dynCache_hash(const char *content, size_t length) {
+    //FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= (uint8_t)content[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static void dynCache_destroyParsed(enum dyn_cache_kind kind, void *parsed) {
+    if (kind == DYN_CACHE_MESSAGE) {
+        dynMessage_destroy(parsed);
+    } else {
+        dynInterface_destroy(parsed);
+    }
+}
+
+static int dynCache_parse(enum dyn_cache_kind kind, const char *descriptor, size_t length, void **out) {
+    int status = OK;
+    FILE *stream = fmemopen((char*)descriptor, length, "r");
+    if (stream == NULL) {
+        LOG_ERROR("Error creating mem stream for descriptor");
+        return ERROR;
+    }
+
+    if (kind == DYN_CACHE_MESSAGE) {
+        dyn_message_type *msg = NULL;
+        status = dynMessage_parse(stream, &msg);
+        *out = msg;
+    } else {
+        dyn_interface_type *intf = NULL;
+        status = dynInterface_parse(stream, &intf);
+        *out = intf;
+    }
+    fclose(stream);
+
+    return status;
+}
+
+static struct dyn_cache_entry* dynCache_findLocked(enum dyn_cache_kind kind, uint64_t hash, const char *descriptor, size_t length) {
+    for (struct dyn_cache_entry *entry = g_cacheEntries; entry != NULL; entry = entry->next) {
+        if (entry->kind == kind && entry->hash == hash && entry->length == length && memcmp(entry->content, descriptor, length) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+static int dynCache_get(enum dyn_cache_kind kind, const char *descriptor, size_t length, void **out) {
+    uint64_t hash = dynCache_hash(descriptor, length);
+
+    pthread_mutex_lock(&g_cacheMutex);
+    struct dyn_cache_entry *entry = dynCache_findLocked(kind, hash, descriptor, length);
+    if (entry != NULL) {
+        entry->refCount += 1;
+        *out = entry->parsed;
+    }
+    pthread_mutex_unlock(&g_cacheMutex);
+    if (entry != NULL) {
+        return OK;
+    }
+
+    //note parsing is done outside the lock, so that different descriptors can be parsed concurrently
+    void *parsed = NULL;
+    int status = dynCache_parse(kind, descriptor, length, &parsed);
+    struct dyn_cache_entry *newEntry = NULL;
+    if (status == OK) {
+        newEntry = calloc(1, sizeof(*newEntry));
+        char *content = malloc(length);
+        if (newEntry != NULL && content != NULL) {
+            memcpy(content, descriptor, length);
+            newEntry->kind = kind;
+            newEntry->hash = hash;
+            newEntry->length = length;
+            newEntry->content = content;
+            newEntry->parsed = parsed;
+            newEntry->refCount = 1;
+        } else {
+            LOG_ERROR("Error allocating descriptor cache entry");
+            free(content);
+            free(newEntry);
+            dynCache_destroyParsed(kind, parsed);
+            status = ERROR;
+        }
+    }
+
+    if (status == OK) {
+        pthread_mutex_lock(&g_cacheMutex);
+        entry = dynCache_findLocked(kind, hash, descriptor, length);
+        if (entry != NULL) {
+            //parsed concurrently, use the existing entry
+            entry->refCount += 1;
+            *out = entry->parsed;
+        } else {
+            newEntry->next = g_cacheEntries;
+            g_cacheEntries = newEntry;
+            *out = newEntry->parsed;
+        }
+        pthread_mutex_unlock(&g_cacheMutex);
+
+        if (entry != NULL) {
+            dynCache_destroyParsed(kind, newEntry->parsed);
+            free(newEntry->content);
+            free(newEntry);
+        }
+    }
+
+    return status;
+}
+
+static void dynCache_release(enum dyn_cache_kind kind, void *parsed) {
+    if (parsed == NULL) {
+        return;
+    }
+
+    bool found = false;
+    struct dyn_cache_entry *remove = NULL;
+    pthread_mutex_lock(&g_cacheMutex);
+    struct dyn_cache_entry **prev = &g_cacheEntries;
+    for (struct dyn_cache_entry *entry = g_cacheEntries; entry != NULL; prev = &entry->next, entry = entry->next) {
+        if (entry->parsed == parsed) {
+            found = true;
+            entry->refCount -= 1;
+            if (entry->refCount == 0) {
+                *prev = entry->next;
+                remove = entry;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_cacheMutex);
+
+    if (!found) {
+        dynCache_destroyParsed(kind, parsed);
+    } else if (remove != NULL) {
+        dynCache_destroyParsed(remove->kind, remove->parsed);
+        free(remove->content);
+        free(remove);
+    }
+}
+
+int dynCache_getMessage(const char *descriptor, size_t length, dyn_message_type **out) {
+    void *parsed = NULL;
+    int status = dynCache_get(DYN_CACHE_MESSAGE, descriptor, length, &parsed);
+    if (status == OK) {
+        *out = parsed;
+    }
+    return status;
+}
+
+int dynCache_getInterface(const char *descriptor, size_t length, dyn_interface_type **out) {
+    void *parsed = NULL;
+    int status = dynCache_get(DYN_CACHE_INTERFACE, descriptor, length, &parsed);
+    if (status == OK) {
+        *out = parsed;
+    }
+    return status;
+}
+
+void dynCache_releaseMessage(dyn_message_type *msg) {
+    dynCache_release(DYN_CACHE_MESSAGE, msg);
+}
+
+void dynCache_releaseInterface(dyn_interface_type *intf) {
+    dynCache_release(DYN_CACHE_INTERFACE, intf);
+}
+
+int dynCache_readDescriptor(FILE *stream, char **out, size_t *outLength) {
+    size_t cap = DYN_CACHE_READ_CHUNK_SIZE;
+    size_t length = 0;
+    char *content = malloc(cap + 1);
+    while (content != NULL) {
+        length += fread(content + length, 1, cap - length, stream);
+        if (length < cap) {
+            break;
+        }
+        cap *= 2;
+        char *grown = realloc(content, cap + 1);
+        if (grown == NULL) {
+            free(content);
+        }
+        content = grown;
+    }
+
+    if (content == NULL || ferror(stream)) {
+        LOG_ERROR("Error reading descriptor");
+        free(content);
+        return ERROR;
+    }
+
+    content[length] = '\0';
+    *out = content;
+    *outLength = length;
+    return OK;
+}
+
+size_t dynCache_nrOfEntries(void) {
+    size_t count = 0;
+    pthread_mutex_lock(&g_cacheMutex);
+    for (struct dyn_cache_entry *entry = g_cacheEntries; entry != NULL; entry = entry->next) {
+        count += 1;
+    }
+    pthread_mutex_unlock(&g_cacheMutex);
+    return count;
+}
@@ -494,6 +494,11 @@ void dynType_destroy(dyn_type *type) {
 }
 
 static void dynType_clear(dyn_type *type) {
+    if (type->jsonSerializerPlan != NULL && type->jsonSerializerPlanDestroy != NULL) {
+        type->jsonSerializerPlanDestroy(type->jsonSerializerPlan);
+        type->jsonSerializerPlan = NULL;
+    }
+
     struct type_entry *entry = TAILQ_FIRST(&type->nestedTypesHead);
     struct type_entry *tmp = NULL;
     while (entry != NULL) {
@@ -26,6 +26,8 @@
 #include <assert.h>
 #include <stdint.h>
 #include <string.h>
+#include <stdlib.h>
+#include <math.h>
 
 static int jsonSerializer_createType(dyn_type *type, json_t *object, void **result);
 static int jsonSerializer_parseObject(dyn_type *type, json_t *object, void *inst);
@@ -546,3 +548,1312 @@ static int jsonSerializer_writeEnum(dyn_type *type, int32_t enum_value, json_t *
     LOG_ERROR("Could not find Enum value %s in enum type", enum_value_str);
     return ERROR;
 }
+
+/*
+ * Precompiled marshalling plans
+ */
+
+#define JSON_PLAN_MAX_DEPTH 2048
+#define JSON_PLAN_INITIAL_OUTPUT_SIZE 256
+#define JSON_PLAN_INITIAL_SEQUENCE_CAP 8
+
+typedef struct json_plan_node json_plan_node_t;
+
+struct json_plan_field {
+    const char *name;
+    size_t nameLength;
+    uint32_t hash;
+    char *key; //rendered member key, e.g. "name":
+    size_t keyLength;
+    size_t offset;
+    json_plan_node_t *node;
+};
+
+struct json_plan_enum_value {
+    int32_t value;
+    const char *name;
+    size_t nameLength;
+};
+
+struct json_plan_node {
+    dyn_type *type; //resolved type, never a reference
+    char descriptor;
+    size_t size;
+    unsigned int nrOfFields;
+    struct json_plan_field *fields; //complex members in declaration order
+    unsigned int nrOfEnumValues;
+    struct json_plan_enum_value *enumValues;
+    json_plan_node_t *sub; //sequence item or typed pointer target
+    json_plan_node_t *next; //all nodes of a plan, used for recursive types and cleanup
+};
+
+struct json_serializer_plan {
+    json_plan_node_t *root;
+    json_plan_node_t *nodes;
+};
+
+struct json_plan_sequence {
+    uint32_t cap;
+    uint32_t len;
+    void *buf;
+};
+
+typedef struct json_plan_writer {
+    char *buf;
+    size_t len;
+    size_t cap;
+} json_plan_writer_t;
+
+typedef struct json_plan_reader {
+    const char *cur;
+    const char *end;
+    unsigned int depth;
+} json_plan_reader_t;
+
+typedef struct json_plan_number {
+    bool isInteger;
+    bool negative;
+    uint64_t magnitude;
+    double real;
+} json_plan_number_t;
+
+static int jsonSerializer_compileNode(json_serializer_plan_t *plan, dyn_type *type, json_plan_node_t **out);
+static int jsonSerializer_writeNode(json_plan_node_t *node, const void *loc, json_plan_writer_t *writer, bool *written);
+static int jsonSerializer_readNode(json_plan_node_t *node, json_plan_reader_t *reader, void *loc);
+static int jsonSerializer_skipValue(json_plan_reader_t *reader);
+
+static uint32_t jsonSerializer_hash(const char *str, size_t len) {
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static int jsonSerializer_writerReserve(json_plan_writer_t *writer, size_t extra) {
+    if (writer->len + extra > writer->cap) {
+        size_t cap = writer->cap == 0 ? JSON_PLAN_INITIAL_OUTPUT_SIZE : writer->cap;
+        while (cap < writer->len + extra) {
+            cap *= 2;
+        }
+        char *buf = realloc(writer->buf, cap);
+        if (buf == NULL) {
+            LOG_ERROR("Error allocating %zu bytes for json output", cap);
+            return ERROR;
+        }
+        writer->buf = buf;
+        writer->cap = cap;
+    }
+    return OK;
+}
+
+static inline int jsonSerializer_writerAppend(json_plan_writer_t *writer, const char *data, size_t len) {
+    int status = jsonSerializer_writerReserve(writer, len);
+    if (status == OK) {
+        memcpy(writer->buf + writer->len, data, len);
+        writer->len += len;
+    }
+    return status;
+}
+
+static inline int jsonSerializer_writerPut(json_plan_writer_t *writer, char c) {
+    int status = jsonSerializer_writerReserve(writer, 1);
+    if (status == OK) {
+        writer->buf[writer->len++] = c;
+    }
+    return status;
+}
+
+static int jsonSerializer_writeUnsigned(json_plan_writer_t *writer, uint64_t val) {
+    char tmp[20];
+    size_t pos = sizeof(tmp);
+    do {
+        tmp[--pos] = (char)('0' + (val % 10));
+        val /= 10;
+    } while (val != 0);
+    return jsonSerializer_writerAppend(writer, tmp + pos, sizeof(tmp) - pos);
+}
+
+static int jsonSerializer_writeSigned(json_plan_writer_t *writer, int64_t val) {
+    int status = OK;
+    uint64_t magnitude = (uint64_t)val;
+    if (val < 0) {
+        status = jsonSerializer_writerPut(writer, '-');
+        magnitude = (uint64_t)0 - magnitude;
+    }
+    if (status == OK) {
+        status = jsonSerializer_writeUnsigned(writer, magnitude);
+    }
+    return status;
+}
+
+static int jsonSerializer_writeReal(json_plan_writer_t *writer, double val, bool *written) {
+    if (!isfinite(val)) {
+        //note jansson cannot represent nan and inf, the DOM path omits these values as well
+        *written = false;
+        return OK;
+    }
+    int status = jsonSerializer_writerReserve(writer, 32);
+    if (status == OK) {
+        char *start = writer->buf + writer->len;
+        int len = snprintf(start, 32, "%.17g", val);
+        if (len < 0 || len >= 30) {
+            LOG_ERROR("Error formatting real value");
+            return ERROR;
+        }
+        char *exponent = memchr(start, 'e', len);
+        if (exponent != NULL) {
+            //same as jansson, remove the '+' and leading zeros of the exponent
+            char *digits = exponent + 1;
+            if (*digits == '-') {
+                digits += 1;
+            }
+            char *from = digits;
+            while (*from == '+' || (*from == '0' && from[1] != '\0')) {
+                from += 1;
+            }
+            memmove(digits, from, (size_t)(start + len - from) + 1);
+            len -= (int)(from - digits);
+        } else if (memchr(start, '.', len) == NULL) {
+            //same as jansson, ensure the value is read back as real
+            start[len++] = '.';
+            start[len++] = '0';
+        }
+        writer->len += len;
+    }
+    return status;
+}
+
+static int jsonSerializer_writeString(json_plan_writer_t *writer, const char *str, size_t len) {
+    static const char hex[] = "0123456789ABCDEF";
+    int status = jsonSerializer_writerReserve(writer, len + 2);
+    if (status != OK) {
+        return status;
+    }
+    writer->buf[writer->len++] = '"';
+    size_t begin = 0;
+    for (size_t i = 0; i < len && status == OK; ++i) {
+        unsigned char c = (unsigned char)str[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        status = jsonSerializer_writerAppend(writer, str + begin, i - begin);
+        begin = i + 1;
+        char seq[6] = {'\\', 0, '0', '0', 0, 0};
+        size_t seqLen = 2;
+        switch (c) {
+            case '"' : seq[1] = '"'; break;
+            case '\\' : seq[1] = '\\'; break;
+            case '\b' : seq[1] = 'b'; break;
+            case '\f' : seq[1] = 'f'; break;
+            case '\n' : seq[1] = 'n'; break;
+            case '\r' : seq[1] = 'r'; break;
+            case '\t' : seq[1] = 't'; break;
+            default :
+                seq[1] = 'u';
+                seq[4] = hex[c >> 4];
+                seq[5] = hex[c & 0xF];
+                seqLen = 6;
+                break;
+        }
+        if (status == OK) {
+            status = jsonSerializer_writerAppend(writer, seq, seqLen);
+        }
+    }
+    if (status == OK) {
+        status = jsonSerializer_writerAppend(writer, str + begin, len - begin);
+    }
+    if (status == OK) {
+        status = jsonSerializer_writerPut(writer, '"');
+    }
+    return status;
+}
+
+static dyn_type* jsonSerializer_resolve(dyn_type *type) {
+    while (type != NULL && dynType_type(type) == DYN_TYPE_REF) {
+        type = type->ref.ref;
+    }
+    return type;
+}
+
+static int jsonSerializer_compileComplex(json_serializer_plan_t *plan, json_plan_node_t *node) {
+    struct complex_type_entries_head *entries = NULL;
+    int status = dynType_complex_entries(node->type, &entries);
+
+    struct complex_type_entry *entry = NULL;
+    unsigned int count = 0;
+    if (status == OK) {
+        TAILQ_FOREACH(entry, entries, entries) {
+            count += 1;
+        }
+        node->fields = calloc(count, sizeof(*node->fields));
+        if (count > 0 && node->fields == NULL) {
+            LOG_ERROR("Error allocating plan for complex type");
+            status = ERROR;
+        }
+    }
+
+    //note offsets are determined once using a (zeroed) instance of the complex type
+    void *inst = NULL;
+    if (status == OK) {
+        status = dynType_alloc(node->type, &inst);
+    }
+
+    unsigned int index = 0;
+    if (status == OK) {
+        TAILQ_FOREACH(entry, entries, entries) {
+            struct json_plan_field *field = &node->fields[index];
+            void *valLoc = NULL;
+            status = dynType_complex_valLocAt(node->type, (int)index, inst, &valLoc);
+            if (status == OK) {
+                field->name = entry->name;
+                field->nameLength = strlen(entry->name);
+                field->hash = jsonSerializer_hash(field->name, field->nameLength);
+                field->offset = (size_t)((char*)valLoc - (char*)inst);
+
+                json_plan_writer_t key = {NULL, 0, 0};
+                status = jsonSerializer_writeString(&key, field->name, field->nameLength);
+                if (status == OK) {
+                    status = jsonSerializer_writerPut(&key, ':');
+                }
+                field->key = key.buf;
+                field->keyLength = key.len;
+            }
+            if (status == OK) {
+                status = jsonSerializer_compileNode(plan, entry->type, &field->node);
+            }
+            if (status != OK) {
+                break;
+            }
+            index += 1;
+            node->nrOfFields = index;
+        }
+    }
+    free(inst);
+
+    return status;
+}
+
+static int jsonSerializer_compileEnum(json_plan_node_t *node) {
+    int status = OK;
+    struct meta_entry *entry = NULL;
+    unsigned int count = 0;
+    TAILQ_FOREACH(entry, &node->type->metaProperties, entries) {
+        count += 1;
+    }
+    node->enumValues = calloc(count, sizeof(*node->enumValues));
+    if (count > 0 && node->enumValues == NULL) {
+        LOG_ERROR("Error allocating plan for enum type");
+        status = ERROR;
+    }
+    if (status == OK) {
+        TAILQ_FOREACH(entry, &node->type->metaProperties, entries) {
+            struct json_plan_enum_value *val = &node->enumValues[node->nrOfEnumValues++];
+            val->value = atoi(entry->value);
+            val->name = entry->name;
+            val->nameLength = strlen(entry->name);
+        }
+    }
+    return status;
+}
+
+static int jsonSerializer_compileNode(json_serializer_plan_t *plan, dyn_type *type, json_plan_node_t **out) {
+    int status = OK;
+    dyn_type *resolved = jsonSerializer_resolve(type);
+    if (resolved == NULL) {
+        LOG_ERROR("Cannot compile plan for unresolved type reference");
+        return ERROR;
+    }
+
+    //reuse nodes for already compiled types, this also terminates recursive types
+    for (json_plan_node_t *node = plan->nodes; node != NULL; node = node->next) {
+        if (node->type == resolved) {
+            *out = node;
+            return OK;
+        }
+    }
+
+    json_plan_node_t *node = calloc(1, sizeof(*node));
+    if (node == NULL) {
+        LOG_ERROR("Error allocating plan node");
+        return ERROR;
+    }
+    node->type = resolved;
+    node->descriptor = dynType_descriptorType(resolved);
+    node->size = dynType_size(resolved);
+    node->next = plan->nodes;
+    plan->nodes = node;
+
+    dyn_type *subType = NULL;
+    switch (node->descriptor) {
+        case 'Z' :
+        case 'B' :
+        case 'S' :
+        case 'I' :
+        case 'J' :
+        case 'b' :
+        case 's' :
+        case 'i' :
+        case 'j' :
+        case 'N' :
+        case 'F' :
+        case 'D' :
+        case 't' :
+        case 'P' :
+            break;
+        case 'E' :
+            status = jsonSerializer_compileEnum(node);
+            break;
+        case '{' :
+            status = jsonSerializer_compileComplex(plan, node);
+            break;
+        case '[' :
+            status = jsonSerializer_compileNode(plan, dynType_sequence_itemType(resolved), &node->sub);
+            break;
+        case '*' :
+            status = dynType_typedPointer_getTypedType(resolved, &subType);
+            if (status == OK) {
+                status = jsonSerializer_compileNode(plan, subType, &node->sub);
+            }
+            break;
+        default :
+            LOG_ERROR("Error provided type '%c' not supported for JSON\n", node->descriptor);
+            status = ERROR;
+            break;
+    }
+
+    if (status == OK) {
+        *out = node;
+    }
+    return status;
+}
+
+int jsonSerializer_createPlan(dyn_type *type, json_serializer_plan_t **out) {
+    json_serializer_plan_t *plan = calloc(1, sizeof(*plan));
+    if (plan == NULL) {
+        LOG_ERROR("Error allocating json serializer plan");
+        return ERROR;
+    }
+
+    int status = jsonSerializer_compileNode(plan, type, &plan->root);
+    if (status == OK) {
+        *out = plan;
+    } else {
+        jsonSerializer_destroyPlan(plan);
+    }
+    return status;
+}
+
+void jsonSerializer_destroyPlan(json_serializer_plan_t *plan) {
+    if (plan != NULL) {
+        json_plan_node_t *node = plan->nodes;
+        while (node != NULL) {
+            json_plan_node_t *next = node->next;
+            for (unsigned int i = 0; i < node->nrOfFields; ++i) {
+                free(node->fields[i].key);
+            }
+            free(node->fields);
+            free(node->enumValues);
+            free(node);
+            node = next;
+        }
+        free(plan);
+    }
+}
+
+static void jsonSerializer_destroyCachedPlan(void *plan) {
+    jsonSerializer_destroyPlan(plan);
+}
+
+int jsonSerializer_getPlan(dyn_type *type, json_serializer_plan_t **out) {
+    int status = OK;
+    json_serializer_plan_t *plan = __atomic_load_n(&type->jsonSerializerPlan, __ATOMIC_ACQUIRE);
+    if (plan == NULL) {
+        json_serializer_plan_t *compiled = NULL;
+        status = jsonSerializer_createPlan(type, &compiled);
+        if (status == OK) {
+            void *expected = NULL;
+            __atomic_store_n(&type->jsonSerializerPlanDestroy, jsonSerializer_destroyCachedPlan, __ATOMIC_RELAXED);
+            if (__atomic_compare_exchange_n(&type->jsonSerializerPlan, &expected, compiled, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                plan = compiled;
+            } else {
+                //compiled concurrently by another thread
+                jsonSerializer_destroyPlan(compiled);
+                plan = expected;
+            }
+        }
+    }
+    if (status == OK) {
+        *out = plan;
+    }
+    return status;
+}
+
+static int jsonSerializer_writeComplexWithPlan(json_plan_node_t *node, const void *loc, json_plan_writer_t *writer) {
+    int status = jsonSerializer_writerPut(writer, '{');
+    bool first = true;
+    for (unsigned int i = 0; i < node->nrOfFields && status == OK; ++i) {
+        struct json_plan_field *field = &node->fields[i];
+        size_t mark = writer->len;
+        if (!first) {
+            status = jsonSerializer_writerPut(writer, ',');
+        }
+        if (status == OK) {
+            status = jsonSerializer_writerAppend(writer, field->key, field->keyLength);
+        }
+        bool written = true;
+        if (status == OK) {
+            status = jsonSerializer_writeNode(field->node, (const char*)loc + field->offset, writer, &written);
+        }
+        if (status == OK && !written) {
+            //member without json representation (e.g. a NULL string), omitted like the DOM path does
+            writer->len = mark;
+        } else {
+            first = false;
+        }
+    }
+    if (status == OK) {
+        status = jsonSerializer_writerPut(writer, '}');
+    }
+    return status;
+}
+
+static int jsonSerializer_writeSequenceWithPlan(json_plan_node_t *node, const void *loc, json_plan_writer_t *writer) {
+    const struct json_plan_sequence *seq = loc;
+    json_plan_node_t *item = node->sub;
+    int status = jsonSerializer_writerPut(writer, '[');
+    bool first = true;
+    for (uint32_t i = 0; i < seq->len && status == OK; ++i) {
+        size_t mark = writer->len;
+        if (!first) {
+            status = jsonSerializer_writerPut(writer, ',');
+        }
+        bool written = true;
+        if (status == OK) {
+            status = jsonSerializer_writeNode(item, (const char*)seq->buf + i * item->size, writer, &written);
+        }
+        if (status == OK && !written) {
+            writer->len = mark;
+        } else {
+            first = false;
+        }
+    }
+    if (status == OK) {
+        status = jsonSerializer_writerPut(writer, ']');
+    }
+    return status;
+}
+
+static int jsonSerializer_writeNode(json_plan_node_t *node, const void *loc, json_plan_writer_t *writer, bool *written) {
+    int status = OK;
+    const char *str = NULL;
+    const void *ptr = NULL;
+    int32_t enumValue;
+    unsigned int i;
+    *written = true;
+
+    switch (node->descriptor) {
+        case 'Z' :
+            status = *(const bool*)loc ? jsonSerializer_writerAppend(writer, "true", 4) : jsonSerializer_writerAppend(writer, "false", 5);
+            break;
+        case 'B' :
+            status = jsonSerializer_writeSigned(writer, *(const char*)loc);
+            break;
+        case 'S' :
+            status = jsonSerializer_writeSigned(writer, *(const int16_t*)loc);
+            break;
+        case 'I' :
+            status = jsonSerializer_writeSigned(writer, *(const int32_t*)loc);
+            break;
+        case 'J' :
+            status = jsonSerializer_writeSigned(writer, *(const int64_t*)loc);
+            break;
+        case 'N' :
+            status = jsonSerializer_writeSigned(writer, *(const int*)loc);
+            break;
+        case 'b' :
+            status = jsonSerializer_writeUnsigned(writer, *(const uint8_t*)loc);
+            break;
+        case 's' :
+            status = jsonSerializer_writeUnsigned(writer, *(const uint16_t*)loc);
+            break;
+        case 'i' :
+            status = jsonSerializer_writeUnsigned(writer, *(const uint32_t*)loc);
+            break;
+        case 'j' :
+            //note same as the DOM path, which uses a json_int_t (long long) value
+            status = jsonSerializer_writeSigned(writer, (int64_t)*(const uint64_t*)loc);
+            break;
+        case 'F' :
+            status = jsonSerializer_writeReal(writer, *(const float*)loc, written);
+            break;
+        case 'D' :
+            status = jsonSerializer_writeReal(writer, *(const double*)loc, written);
+            break;
+        case 't' :
+            str = *(const char**)loc;
+            if (str != NULL) {
+                status = jsonSerializer_writeString(writer, str, strlen(str));
+            } else {
+                *written = false;
+            }
+            break;
+        case 'E' :
+            enumValue = *(const int32_t*)loc;
+            for (i = 0; i < node->nrOfEnumValues; ++i) {
+                if (node->enumValues[i].value == enumValue) {
+                    status = jsonSerializer_writeString(writer, node->enumValues[i].name, node->enumValues[i].nameLength);
+                    break;
+                }
+            }
+            if (i == node->nrOfEnumValues) {
+                LOG_ERROR("Could not find Enum value %d in enum type", enumValue);
+                *written = false;
+            }
+            break;
+        case '*' :
+            ptr = *(void* const*)loc;
+            if (ptr != NULL) {
+                status = jsonSerializer_writeNode(node->sub, ptr, writer, written);
+            } else {
+                status = jsonSerializer_writerAppend(writer, "null", 4);
+            }
+            break;
+        case '{' :
+            status = jsonSerializer_writeComplexWithPlan(node, loc, writer);
+            break;
+        case '[' :
+            status = jsonSerializer_writeSequenceWithPlan(node, loc, writer);
+            break;
+        case 'P' :
+            LOG_WARNING("Untyped pointer not supported for serialization. ignoring");
+            *written = false;
+            break;
+        default :
+            LOG_ERROR("Unsupported descriptor '%c'", node->descriptor);
+            status = ERROR;
+            break;
+    }
+
+    return status;
+}
+
+int jsonSerializer_serializeWithPlan(json_serializer_plan_t *plan, const void* input, char **output, size_t *outputLength) {
+    json_plan_writer_t writer = {NULL, 0, 0};
+    bool written = true;
+    int status = jsonSerializer_writeNode(plan->root, input, &writer, &written);
+    if (status == OK && !written) {
+        LOG_ERROR("Error input has no json representation");
+        status = ERROR;
+    }
+    if (status == OK) {
+        status = jsonSerializer_writerPut(&writer, '\0');
+    }
+
+    if (status == OK) {
+        *output = writer.buf;
+        if (outputLength != NULL) {
+            *outputLength = writer.len - 1;
+        }
+    } else {
+        free(writer.buf);
+    }
+    return status;
+}
+
+static inline int jsonSerializer_peek(json_plan_reader_t *reader) {
+    while (reader->cur < reader->end) {
+        char c = *reader->cur;
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            return (unsigned char)c;
+        }
+        reader->cur += 1;
+    }
+    return -1;
+}
+
+static int jsonSerializer_readLiteral(json_plan_reader_t *reader, const char *literal, size_t len) {
+    if ((size_t)(reader->end - reader->cur) < len || memcmp(reader->cur, literal, len) != 0) {
+        LOG_ERROR("Invalid json token, expected '%s'", literal);
+        return ERROR;
+    }
+    reader->cur += len;
+    return OK;
+}
+
+/**
+ * Reads the raw (still escaped) content of a json string. The reader is positioned after the closing quote.
+ */
+static int jsonSerializer_readStringSpan(json_plan_reader_t *reader, const char **start, size_t *len, bool *escaped) {
+    const char *p = reader->cur + 1; //skip opening quote
+    *escaped = false;
+    while (p < reader->end) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"') {
+            *start = reader->cur + 1;
+            *len = (size_t)(p - *start);
+            reader->cur = p + 1;
+            return OK;
+        } else if (c == '\\') {
+            *escaped = true;
+            p += 2;
+        } else if (c < 0x20) {
+            LOG_ERROR("Control character in json string");
+            return ERROR;
+        } else {
+            p += 1;
+        }
+    }
+    LOG_ERROR("Unterminated json string");
+    return ERROR;
+}
+
+static int jsonSerializer_readHex4(const char *p, const char *end, uint32_t *out) {
+    if (end - p < 4) {
+        return ERROR;
+    }
+    uint32_t val = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        val <<= 4;
+        if (c >= '0' && c <= '9') {
+            val |= (uint32_t)(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            val |= (uint32_t)(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            val |= (uint32_t)(c - 'A' + 10);
+        } else {
+            return ERROR;
+        }
+    }
+    *out = val;
+    return OK;
+}
+
+/**
+ * Unescapes a json string span into out, which must be at least len + 1 bytes. An unescaped string is never longer
+ * than its escaped form.
+ */
+static int jsonSerializer_unescape(const char *str, size_t len, char *out, size_t *outLen) {
+    const char *p = str;
+    const char *end = str + len;
+    char *o = out;
+    while (p < end) {
+        if (*p != '\\') {
+            *o++ = *p++;
+            continue;
+        }
+        p += 1;
+        if (p >= end) {
+            return ERROR;
+        }
+        char c = *p++;
+        uint32_t cp = 0;
+        switch (c) {
+            case '"' : *o++ = '"'; break;
+            case '\\' : *o++ = '\\'; break;
+            case '/' : *o++ = '/'; break;
+            case 'b' : *o++ = '\b'; break;
+            case 'f' : *o++ = '\f'; break;
+            case 'n' : *o++ = '\n'; break;
+            case 'r' : *o++ = '\r'; break;
+            case 't' : *o++ = '\t'; break;
+            case 'u' :
+                if (jsonSerializer_readHex4(p, end, &cp) != OK) {
+                    return ERROR;
+                }
+                p += 4;
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t low = 0;
+                    if (end - p < 6 || p[0] != '\\' || p[1] != 'u' || jsonSerializer_readHex4(p + 2, end, &low) != OK || low < 0xDC00 || low > 0xDFFF) {
+                        return ERROR;
+                    }
+                    p += 6;
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                } else if ((cp >= 0xDC00 && cp <= 0xDFFF) || cp == 0) {
+                    return ERROR;
+                }
+                if (cp < 0x80) {
+                    *o++ = (char)cp;
+                } else if (cp < 0x800) {
+                    *o++ = (char)(0xC0 | (cp >> 6));
+                    *o++ = (char)(0x80 | (cp & 0x3F));
+                } else if (cp < 0x10000) {
+                    *o++ = (char)(0xE0 | (cp >> 12));
+                    *o++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *o++ = (char)(0x80 | (cp & 0x3F));
+                } else {
+                    *o++ = (char)(0xF0 | (cp >> 18));
+                    *o++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+                    *o++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+                    *o++ = (char)(0x80 | (cp & 0x3F));
+                }
+                break;
+            default :
+                return ERROR;
+        }
+    }
+    *o = '\0';
+    *outLen = (size_t)(o - out);
+    return OK;
+}
+
+static int jsonSerializer_readString(json_plan_reader_t *reader, char **out) {
+    const char *start = NULL;
+    size_t len = 0;
+    bool escaped = false;
+    int status = jsonSerializer_readStringSpan(reader, &start, &len, &escaped);
+    char *str = NULL;
+    if (status == OK) {
+        str = malloc(len + 1);
+        if (str == NULL) {
+            LOG_ERROR("Error allocating string");
+            status = ERROR;
+        }
+    }
+    if (status == OK) {
+        if (escaped) {
+            size_t strLen = 0;
+            status = jsonSerializer_unescape(start, len, str, &strLen);
+            if (status != OK) {
+                LOG_ERROR("Invalid escape sequence in json string");
+            }
+        } else {
+            memcpy(str, start, len);
+            str[len] = '\0';
+        }
+    }
+    if (status == OK) {
+        *out = str;
+    } else {
+        free(str);
+    }
+    return status;
+}
+
+static int jsonSerializer_readNumber(json_plan_reader_t *reader, json_plan_number_t *num) {
+    const char *p = reader->cur;
+    const char *end = reader->end;
+    const char *start = p;
+    num->isInteger = true;
+    num->negative = false;
+    num->magnitude = 0;
+    num->real = 0.0;
+
+    if (p < end && *p == '-') {
+        num->negative = true;
+        p += 1;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+        LOG_ERROR("Invalid json number");
+        return ERROR;
+    }
+    if (*p == '0' && p + 1 < end && p[1] >= '0' && p[1] <= '9') {
+        LOG_ERROR("Invalid json number, leading zeros are not allowed");
+        return ERROR;
+    }
+    bool overflow = false;
+    while (p < end && *p >= '0' && *p <= '9') {
+        uint64_t digit = (uint64_t)(*p - '0');
+        if (num->magnitude > (UINT64_MAX - digit) / 10) {
+            overflow = true;
+        }
+        num->magnitude = num->magnitude * 10 + digit;
+        p += 1;
+    }
+    if (p < end && *p == '.') {
+        num->isInteger = false;
+        p += 1;
+        if (p >= end || *p < '0' || *p > '9') {
+            LOG_ERROR("Invalid json number, expected fraction digits");
+            return ERROR;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            p += 1;
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        num->isInteger = false;
+        p += 1;
+        if (p < end && (*p == '+' || *p == '-')) {
+            p += 1;
+        }
+        if (p >= end || *p < '0' || *p > '9') {
+            LOG_ERROR("Invalid json number, expected exponent digits");
+            return ERROR;
+        }
+        while (p < end && *p >= '0' && *p <= '9') {
+            p += 1;
+        }
+    }
+
+    if (num->isInteger && overflow) {
+        LOG_ERROR("Json integer too big");
+        return ERROR;
+    }
+
+    if (num->isInteger) {
+        num->real = num->negative ? -(double)num->magnitude : (double)num->magnitude;
+    } else {
+        //note the input is not NUL terminated, copy the token for strtod
+        size_t len = (size_t)(p - start);
+        char tmp[64];
+        char *token = len < sizeof(tmp) ? tmp : malloc(len + 1);
+        if (token == NULL) {
+            LOG_ERROR("Error allocating number token");
+            return ERROR;
+        }
+        memcpy(token, start, len);
+        token[len] = '\0';
+        num->real = strtod(token, NULL);
+        if (token != tmp) {
+            free(token);
+        }
+        if (isinf(num->real)) {
+            LOG_ERROR("Json real number overflow");
+            return ERROR;
+        }
+    }
+
+    reader->cur = p;
+    return OK;
+}
+
+static int jsonSerializer_skipContainer(json_plan_reader_t *reader, char close, bool isObject) {
+    if (++reader->depth > JSON_PLAN_MAX_DEPTH) {
+        LOG_ERROR("Json input nested too deep");
+        return ERROR;
+    }
+    reader->cur += 1;
+    int status = OK;
+    if (jsonSerializer_peek(reader) == close) {
+        reader->cur += 1;
+    } else {
+        while (status == OK) {
+            if (isObject) {
+                const char *start = NULL;
+                size_t len = 0;
+                bool escaped = false;
+                status = jsonSerializer_peek(reader) == '"' ? jsonSerializer_readStringSpan(reader, &start, &len, &escaped) : ERROR;
+                if (status == OK && jsonSerializer_peek(reader) == ':') {
+                    reader->cur += 1;
+                } else {
+                    status = ERROR;
+                }
+            }
+            if (status == OK) {
+                status = jsonSerializer_skipValue(reader);
+            }
+            if (status == OK) {
+                int c = jsonSerializer_peek(reader);
+                reader->cur += 1;
+                if (c == close) {
+                    break;
+                } else if (c != ',') {
+                    status = ERROR;
+                }
+            }
+        }
+        if (status != OK) {
+            LOG_ERROR("Invalid json %s", isObject ? "object" : "array");
+        }
+    }
+    reader->depth -= 1;
+    return status;
+}
+
+static int jsonSerializer_skipValue(json_plan_reader_t *reader) {
+    int status = OK;
+    json_plan_number_t num;
+    const char *start = NULL;
+    size_t len = 0;
+    bool escaped = false;
+
+    int c = jsonSerializer_peek(reader);
+    switch (c) {
+        case '"' :
+            status = jsonSerializer_readStringSpan(reader, &start, &len, &escaped);
+            break;
+        case '{' :
+            status = jsonSerializer_skipContainer(reader, '}', true);
+            break;
+        case '[' :
+            status = jsonSerializer_skipContainer(reader, ']', false);
+            break;
+        case 't' :
+            status = jsonSerializer_readLiteral(reader, "true", 4);
+            break;
+        case 'f' :
+            status = jsonSerializer_readLiteral(reader, "false", 5);
+            break;
+        case 'n' :
+            status = jsonSerializer_readLiteral(reader, "null", 4);
+            break;
+        default :
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                status = jsonSerializer_readNumber(reader, &num);
+            } else {
+                LOG_ERROR("Unexpected %s in json input", c < 0 ? "end" : "character");
+                status = ERROR;
+            }
+            break;
+    }
+    return status;
+}
+
+static struct json_plan_field* jsonSerializer_findField(json_plan_node_t *node, const char *name, size_t len, unsigned int *expected) {
+    //members are normally in declaration order, so try the next expected member first
+    if (*expected < node->nrOfFields) {
+        struct json_plan_field *field = &node->fields[*expected];
+        if (field->nameLength == len && memcmp(field->name, name, len) == 0) {
+            *expected += 1;
+            return field;
+        }
+    }
+    uint32_t hash = jsonSerializer_hash(name, len);
+    for (unsigned int i = 0; i < node->nrOfFields; ++i) {
+        struct json_plan_field *field = &node->fields[i];
+        if (field->hash == hash && field->nameLength == len && memcmp(field->name, name, len) == 0) {
+            *expected = i + 1;
+            return field;
+        }
+    }
+    return NULL;
+}
+
+static int jsonSerializer_readComplexWithPlan(json_plan_node_t *node, json_plan_reader_t *reader, void *loc) {
+    if (++reader->depth > JSON_PLAN_MAX_DEPTH) {
+        LOG_ERROR("Json input nested too deep");
+        return ERROR;
+    }
+    reader->cur += 1;
+
+    int status = OK;
+    unsigned int expected = 0;
+    if (jsonSerializer_peek(reader) == '}') {
+        reader->cur += 1;
+        reader->depth -= 1;
+        return OK;
+    }
+
+    while (status == OK) {
+        const char *name = NULL;
+        size_t len = 0;
+        bool escaped = false;
+        char *unescaped = NULL;
+        if (jsonSerializer_peek(reader) != '"') {
+            LOG_ERROR("Expected json member name");
+            status = ERROR;
+        }
+        if (status == OK) {
+            status = jsonSerializer_readStringSpan(reader, &name, &len, &escaped);
+        }
+        if (status == OK && escaped) {
+            unescaped = malloc(len + 1);
+            status = unescaped != NULL ? jsonSerializer_unescape(name, len, unescaped, &len) : ERROR;
+            name = unescaped;
+        }
+
+        struct json_plan_field *field = NULL;
+        if (status == OK) {
+            field = jsonSerializer_findField(node, name, len, &expected);
+            if (field == NULL) {
+                LOG_ERROR("Cannot find index for member '%.*s'", (int)len, name);
+                status = ERROR;
+            }
+        }
+        free(unescaped);
+
+        if (status == OK) {
+            if (jsonSerializer_peek(reader) == ':') {
+                reader->cur += 1;
+            } else {
+                LOG_ERROR("Expected ':' after json member name");
+                status = ERROR;
+            }
+        }
+        if (status == OK) {
+            status = jsonSerializer_readNode(field->node, reader, (char*)loc + field->offset);
+        }
+        if (status == OK) {
+            int c = jsonSerializer_peek(reader);
+            reader->cur += 1;
+            if (c == '}') {
+                break;
+            } else if (c != ',') {
+                LOG_ERROR("Expected ',' or '}' in json object");
+                status = ERROR;
+            }
+        }
+    }
+
+    reader->depth -= 1;
+    return status;
+}
+
+static int jsonSerializer_readSequenceWithPlan(json_plan_node_t *node, json_plan_reader_t *reader, void *loc) {
+    if (++reader->depth > JSON_PLAN_MAX_DEPTH) {
+        LOG_ERROR("Json input nested too deep");
+        return ERROR;
+    }
+    reader->cur += 1;
+
+    struct json_plan_sequence *seq = loc;
+    if (seq->buf != NULL) {
+        //duplicate member, replace the previous value
+        dynType_deepFree(node->type, loc, false);
+        seq->buf = NULL;
+        seq->cap = 0;
+        seq->len = 0;
+    }
+
+    int status = OK;
+    json_plan_node_t *item = node->sub;
+    if (jsonSerializer_peek(reader) == ']') {
+        reader->cur += 1;
+        reader->depth -= 1;
+        return OK;
+    }
+
+    while (status == OK) {
+        if (seq->len == seq->cap) {
+            uint32_t cap = seq->cap == 0 ? JSON_PLAN_INITIAL_SEQUENCE_CAP : seq->cap * 2;
+            void *buf = seq->cap < UINT32_MAX / 2 ? realloc(seq->buf, cap * item->size) : NULL;
+            if (buf == NULL) {
+                LOG_ERROR("Error allocating memory for sequence");
+                status = ERROR;
+                break;
+            }
+            seq->buf = buf;
+            seq->cap = cap;
+        }
+        void *itemLoc = (char*)seq->buf + seq->len * item->size;
+        memset(itemLoc, 0, item->size);
+        seq->len += 1;
+
+        status = jsonSerializer_readNode(item, reader, itemLoc);
+        if (status == OK) {
+            int c = jsonSerializer_peek(reader);
+            reader->cur += 1;
+            if (c == ']') {
+                break;
+            } else if (c != ',') {
+                LOG_ERROR("Expected ',' or ']' in json array");
+                status = ERROR;
+            }
+        }
+    }
+
+    reader->depth -= 1;
+    return status;
+}
+
+static int jsonSerializer_createNode(json_plan_node_t *node, json_plan_reader_t *reader, void **result) {
+    int status = OK;
+    void *inst = NULL;
+
+    if (node->descriptor == 't') {
+        inst = calloc(1, sizeof(char*));
+        if (inst == NULL) {
+            status = ERROR;
+        } else if (jsonSerializer_peek(reader) == '"') {
+            status = jsonSerializer_readString(reader, (char**)inst);
+        } else {
+            LOG_ERROR("Expected json string");
+            status = ERROR;
+        }
+    } else {
+        status = dynType_alloc(node->type, &inst);
+        if (status == OK) {
+            status = jsonSerializer_readNode(node, reader, inst);
+        }
+    }
+
+    if (status == OK) {
+        *result = inst;
+    } else {
+        *result = NULL;
+        dynType_free(node->type, inst);
+    }
+    return status;
+}
+
+static int jsonSerializer_readInteger(json_plan_reader_t *reader, json_plan_number_t *num, bool *isInteger) {
+    //note same as the DOM path, non integer values are ignored and leave the value zero
+    int c = jsonSerializer_peek(reader);
+    int status = OK;
+    *isInteger = false;
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        status = jsonSerializer_readNumber(reader, num);
+        *isInteger = status == OK && num->isInteger;
+    } else {
+        status = jsonSerializer_skipValue(reader);
+    }
+    return status;
+}
+
+static int jsonSerializer_readNode(json_plan_node_t *node, json_plan_reader_t *reader, void *loc) {
+    int status = OK;
+    json_plan_number_t num;
+    bool isInteger = false;
+    int64_t ival = 0;
+    const char *start = NULL;
+    size_t len = 0;
+    bool escaped = false;
+    char *str = NULL;
+    unsigned int i;
+
+    int c = jsonSerializer_peek(reader);
+    if (c < 0) {
+        LOG_ERROR("Unexpected end of json input");
+        return ERROR;
+    }
+
+    switch (node->descriptor) {
+        case 'Z' :
+            if (c == 't') {
+                status = jsonSerializer_readLiteral(reader, "true", 4);
+                *(bool*)loc = status == OK;
+            } else {
+                status = jsonSerializer_skipValue(reader);
+                *(bool*)loc = false;
+            }
+            break;
+        case 'B' :
+        case 'S' :
+        case 'I' :
+        case 'J' :
+        case 'N' :
+        case 'b' :
+        case 's' :
+        case 'i' :
+        case 'j' :
+            status = jsonSerializer_readInteger(reader, &num, &isInteger);
+            if (status == OK && isInteger) {
+                ival = num.negative ? (int64_t)((uint64_t)0 - num.magnitude) : (int64_t)num.magnitude;
+                switch (node->descriptor) {
+                    case 'B' : *(char*)loc = (char)ival; break;
+                    case 'S' : *(int16_t*)loc = (int16_t)ival; break;
+                    case 'I' : *(int32_t*)loc = (int32_t)ival; break;
+                    case 'J' : *(int64_t*)loc = ival; break;
+                    case 'N' : *(int*)loc = (int)ival; break;
+                    case 'b' : *(uint8_t*)loc = (uint8_t)ival; break;
+                    case 's' : *(uint16_t*)loc = (uint16_t)ival; break;
+                    case 'i' : *(uint32_t*)loc = (uint32_t)ival; break;
+                    default : *(uint64_t*)loc = (uint64_t)ival; break;
+                }
+            }
+            break;
+        case 'F' :
+        case 'D' :
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                status = jsonSerializer_readNumber(reader, &num);
+                if (status == OK && node->descriptor == 'F') {
+                    *(float*)loc = (float)num.real;
+                } else if (status == OK) {
+                    *(double*)loc = num.real;
+                }
+            } else {
+                status = jsonSerializer_skipValue(reader);
+            }
+            break;
+        case 't' :
+            if (c == 'n') {
+                status = jsonSerializer_readLiteral(reader, "null", 4);
+            } else if (c == '"') {
+                status = jsonSerializer_readString(reader, &str);
+                if (status == OK) {
+                    free(*(char**)loc);
+                    *(char**)loc = str;
+                }
+            } else {
+                LOG_ERROR("Expected json string type");
+                status = ERROR;
+            }
+            break;
+        case 'E' :
+            if (c == 'n') {
+                status = jsonSerializer_readLiteral(reader, "null", 4);
+            } else if (c == '"') {
+                status = jsonSerializer_readStringSpan(reader, &start, &len, &escaped);
+                if (status == OK && escaped) {
+                    str = malloc(len + 1);
+                    status = str != NULL ? jsonSerializer_unescape(start, len, str, &len) : ERROR;
+                    start = str;
+                }
+                if (status == OK) {
+                    for (i = 0; i < node->nrOfEnumValues; ++i) {
+                        if (node->enumValues[i].nameLength == len && memcmp(node->enumValues[i].name, start, len) == 0) {
+                            *(int32_t*)loc = node->enumValues[i].value;
+                            break;
+                        }
+                    }
+                    if (i == node->nrOfEnumValues) {
+                        LOG_ERROR("Could not find Enum value %.*s in enum type", (int)len, start);
+                        status = ERROR;
+                    }
+                }
+                free(str);
+            } else {
+                LOG_ERROR("Expected json string for enum type");
+                status = ERROR;
+            }
+            break;
+        case '[' :
+            if (c == '[') {
+                status = jsonSerializer_readSequenceWithPlan(node, reader, loc);
+            } else {
+                LOG_ERROR("Expected json array type");
+                status = ERROR;
+            }
+            break;
+        case '{' :
+            if (c == '{') {
+                status = jsonSerializer_readComplexWithPlan(node, reader, loc);
+            } else {
+                //note same as the DOM path, a non object value leaves the complex value untouched
+                status = jsonSerializer_skipValue(reader);
+            }
+            break;
+        case '*' :
+            if (*(void**)loc != NULL) {
+                //duplicate member, replace the previous value
+                dynType_free(node->sub->type, *(void**)loc);
+                *(void**)loc = NULL;
+            }
+            status = jsonSerializer_createNode(node->sub, reader, (void**)loc);
+            break;
+        case 'P' :
+            LOG_WARNING("Untyped pointer are not supported for serialization");
+            status = ERROR;
+            break;
+        default :
+            LOG_ERROR("Error provided type '%c' not supported for JSON\n", node->descriptor);
+            status = ERROR;
+            break;
+    }
+
+    return status;
+}
+
+int jsonSerializer_deserializeWithPlan(json_serializer_plan_t *plan, const char *input, size_t length, void **result) {
+    json_plan_reader_t reader = {input, input + length, 0};
+    void *inst = NULL;
+    int status = jsonSerializer_createNode(plan->root, &reader, &inst);
+
+    if (status == OK && jsonSerializer_peek(&reader) >= 0) {
+        LOG_ERROR("Unexpected trailing data after json value");
+        dynType_free(plan->root->type, inst);
+        inst = NULL;
+        status = ERROR;
+    }
+
+    if (status == OK) {
+        *result = inst;
+    } else {
+        LOG_ERROR("Error cannot deserialize json. Input is '%.*s'\n", (int)length, input);
+    }
+    return status;
+}
@@ -89,6 +89,23 @@ int etcd_refresh(const char *key, int ttl) DEP_ATTRIBUTE;
  */
 int etcd_set_with_check(const char* key, const char* value, int ttl, bool always_write) DEP_ATTRIBUTE;
 
+/**
+ * @desc Creating an Etcd-directory
+ * @param const char* directory. The Etcd-directory (Note: a leading '/' should be avoided)
+ * @param int ttl. If non-zero this is used as the TTL value of the directory
+ * @param bool prevExist. If true the directory is only updated when it already exists, if false it is only created when it does not exist
+ * @return 0 on success, non zero otherwise
+ */
+int etcd_set_directory(const char* directory, int ttl, bool prevExist) DEP_ATTRIBUTE;
+
+/**
+ * @desc Refresh the ttl of an existing directory, the keys in the directory are kept.
+ * @param const char* directory. The Etcd-directory to refresh.
+ * @param int ttl. The ttl value to use.
+ * @return 0 on success, non zero otherwise.
+ */
+int etcd_refresh_directory(const char* directory, int ttl) DEP_ATTRIBUTE;
+
 /**
  * @desc Deleting an Etcd-key
  * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided)
@@ -109,6 +126,18 @@ int etcd_del(const char* key) DEP_ATTRIBUTE;
  */
 int etcd_watch(const char* key, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex) DEP_ATTRIBUTE;
 
+/**
+ * @desc Watching an etcd directory for changes using a stream; the changes are delivered in batches to the callback
+ * until the callback returns false, the stream is closed or the watch is interrupted. See etcdlib_watch_stream.
+ * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided)
+ * @param long long index. The Etcd-index which the watch has to be started on.
+ * @param etcdlib_watch_callback callback. Called with the received changes.
+ * @param void* arg. The argument passed to the callback.
+ * @param long long* modifiedIndex. If not NULL, the index of the last received modification is written.
+ * @return ETCDLIB_RC_OK (0) on success, non zero otherwise.
+ */
+int etcd_watch_stream(const char* key, long long index, etcdlib_watch_callback callback, void *arg, long long* modifiedIndex) DEP_ATTRIBUTE;
+
 #ifdef __cplusplus
 }
 #endif
@@ -45,11 +45,31 @@ extern "C"
 #define ETCDLIB_RC_OK           0
 #define ETCDLIB_RC_ERROR        1
 #define ETCDLIB_RC_TIMEOUT      2
+#define ETCDLIB_RC_INTERRUPTED  3
 
 typedef struct etcdlib_struct etcdlib_t; //opaque struct
 
 typedef void (*etcdlib_key_value_callback) (const char *key, const char *value, void* arg);
 
+/**
+ * A change received from a (streaming) watch. The strings are only valid during the watch callback and can be NULL
+ * (e.g. value for a delete action or prevValue for a create action).
+ */
+typedef struct etcdlib_watch_event {
+    const char *action;
+    const char *key;
+    const char *value;
+    const char *prevValue;
+    bool dir;
+    long long modifiedIndex;
+} etcdlib_watch_event_t;
+
+/**
+ * Called with the batch of events received in one read from the watch stream (in modifiedIndex order).
+ * Return false to stop the watch.
+ */
+typedef bool (*etcdlib_watch_callback) (const etcdlib_watch_event_t *events, int nrOfEvents, void* arg);
+
 /**
  * @desc Creates the ETCD-LIB  with the server/port where Etcd can be reached.
  * @param const char* server. String containing the IP-number of the server.
@@ -116,6 +136,27 @@ int etcdlib_set(etcdlib_t *etcdlib, const char* key, const char* value, int ttl,
  */
 int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl);
 
+/**
+ * @desc Creates or updates an Etcd-directory. If ttl is non-zero, the directory - including all keys in the
+ * directory - expires after ttl seconds, unless refreshed with etcdlib_refresh_directory. This makes it possible
+ * to keep many keys alive with a single request per ttl period.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param const char* directory. The Etcd-directory (Note: a leading '/' should be avoided)
+ * @param int ttl. If non-zero this is used as the TTL value of the directory
+ * @param bool prevExist. If true the directory is only updated when it already exists, if false it is only created when it does not exist
+ * @return 0 on success, non zero otherwise
+ */
+int etcdlib_set_directory(etcdlib_t *etcdlib, const char* directory, int ttl, bool prevExist);
+
+/**
+ * @desc Refresh the ttl of an existing directory (and thereby of all keys in the directory) without triggering watches.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param directory the etcd directory to refresh.
+ * @param ttl the ttl value to use.
+ * @return 0 on success, non zero otherwise (e.g. when the directory already expired).
+ */
+int etcdlib_refresh_directory(etcdlib_t *etcdlib, const char* directory, int ttl);
+
 /**
  * @desc Setting an Etcd-key/value and checks if there is a different previous value
  * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
@@ -149,6 +190,32 @@ int etcdlib_del(etcdlib_t *etcdlib, const char* key);
  */
 int etcdlib_watch(etcdlib_t *etcdlib, const char* key, long long index, char** action, char** prevValue, char** value, char** rkey, long long* modifiedIndex);
 
+/**
+ * @desc Continuously watching an etcd directory for changes using a single streaming request.
+ * Blocks and calls the callback with a batch of events every time changes are received, until the callback returns
+ * false, the server ends the stream, an error occurs or the watch is interrupted with etcdlib_interrupt_watch.
+ * Note that the streaming watch has its own connection, separate from the requests and from etcdlib_watch.
+ * Concurrent streaming watches on the same instance are serialized.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance (contains hostname and port info).
+ * @param const char* key. The Etcd-key (Note: a leading '/' should be avoided).
+ * @param long long index. The Etcd-index which the watch has to be started on.
+ * @param etcdlib_watch_callback callback. Callback called for every batch of received events.
+ * @param void *arg. Argument is passed to the callback function.
+ * @param long long* modifiedIndex. If not NULL, the index of the last received event is written, or index - 1 if no
+ * event is received. A next watch should start at *modifiedIndex + 1.
+ * @return ETCDLIB_RC_OK if the callback stopped the watch, ETCDLIB_RC_TIMEOUT if the server ended the stream,
+ * ETCDLIB_RC_INTERRUPTED if the watch is interrupted and ETCDLIB_RC_ERROR on a connection or etcd error
+ * (e.g. when the requested index is already cleared).
+ */
+int etcdlib_watch_stream(etcdlib_t *etcdlib, const char* key, long long index, etcdlib_watch_callback callback, void *arg, long long* modifiedIndex);
+
+/**
+ * @desc Interrupts the current streaming watch of the etcdlib instance. If no streaming watch is active, the next
+ * streaming watch returns ETCDLIB_RC_INTERRUPTED immediately. Can be called from any thread.
+ * @param const etcdlib_t* etcdlib. The ETCD-LIB instance.
+ */
+void etcdlib_interrupt_watch(etcdlib_t *etcdlib);
+
 #ifdef __cplusplus
 }
 #endif
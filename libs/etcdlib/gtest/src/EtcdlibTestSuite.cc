@@ -0,0 +1,697 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "etcdlib.h"
+
+/**
+ * Minimal stand-in for the etcd v2 keys api, supporting get (recursive), put (value, dir, ttl, prevExist, refresh),
+ * delete and (long poll and streaming) watches. TTLs are only stored, expiration is triggered with expire().
+ */
+class FakeEtcd {
+public:
+    FakeEtcd() {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+        addr.sin_port = 0;
+        bind(listenFd, (struct sockaddr*)&addr, sizeof(addr));
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, (struct sockaddr*)&addr, &len);
+        port = ntohs(addr.sin_port);
+        listen(listenFd, 16);
+        acceptThread = std::thread{[this]{ acceptConnections(); }};
+    }
+
+    ~FakeEtcd() {
+        {
+            std::lock_guard<std::mutex> lck{mutex};
+            stopped = true;
+        }
+        cond.notify_all();
+        shutdown(listenFd, SHUT_RDWR);
+        close(listenFd);
+        acceptThread.join();
+        std::vector<std::thread> threads{};
+        {
+            std::lock_guard<std::mutex> lck{mutex};
+            for (int fd : clientFds) {
+                shutdown(fd, SHUT_RDWR);
+            }
+            threads.swap(clientThreads);
+        }
+        for (auto &t : threads) {
+            t.join();
+        }
+    }
+
+    FakeEtcd(FakeEtcd&&) = delete;
+    FakeEtcd(const FakeEtcd&) = delete;
+    FakeEtcd& operator=(FakeEtcd&&) = delete;
+    FakeEtcd& operator=(const FakeEtcd&) = delete;
+
+    int getPort() const { return port; }
+    int getNrOfConnections() const { return nrOfConnections.load(); }
+    int getNrOfRequests() const { return nrOfRequests.load(); }
+    int getNrOfRefreshes() const { return nrOfRefreshes.load(); }
+    long long getIndex() {
+        std::lock_guard<std::mutex> lck{mutex};
+        return index;
+    }
+
+    /**
+     * Sets multiple keys in one go, so that a streaming watch receives the changes as one chunk.
+     */
+    void setBatch(const std::vector<std::pair<std::string, std::string>>& entries) {
+        {
+            std::lock_guard<std::mutex> lck{mutex};
+            for (const auto& entry : entries) {
+                putNode(entry.first, Node{entry.second, false, 0, ++index});
+                events.push_back(Event{"set", entry.first, entry.second, false, index});
+            }
+        }
+        cond.notify_all();
+    }
+
+    void expire(const std::string& key) {
+        {
+            std::lock_guard<std::mutex> lck{mutex};
+            auto it = nodes.find(key);
+            if (it == nodes.end()) {
+                return;
+            }
+            bool dir = it->second.dir;
+            removeRecursive(key);
+            events.push_back(Event{"expire", key, "", dir, ++index});
+        }
+        cond.notify_all();
+    }
+
+    /**
+     * Ends all active watch streams.
+     */
+    void endStreams() {
+        {
+            std::lock_guard<std::mutex> lck{mutex};
+            streamGeneration += 1;
+        }
+        cond.notify_all();
+    }
+
+    /**
+     * Forgets the events before the provided index, watches for older indices return etcd error 401.
+     */
+    void clearHistory(long long before) {
+        std::lock_guard<std::mutex> lck{mutex};
+        oldestIndex = before;
+    }
+
+private:
+    struct Node {
+        std::string value;
+        bool dir;
+        int ttl;
+        long long modifiedIndex;
+    };
+
+    struct Event {
+        std::string action;
+        std::string key;
+        std::string value;
+        bool dir;
+        long long index;
+    };
+
+    struct Request {
+        std::string method;
+        std::string key;
+        std::map<std::string, std::string> query;
+        std::map<std::string, std::string> form;
+    };
+
+    static std::string escape(const std::string& str) {
+        std::string result{};
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                result += '\\';
+            }
+            result += c;
+        }
+        return result;
+    }
+
+    static std::map<std::string, std::string> parseForm(const std::string& str) {
+        std::map<std::string, std::string> result{};
+        size_t pos = 0;
+        while (pos < str.size()) {
+            size_t end = str.find('&', pos);
+            if (end == std::string::npos) {
+                end = str.size();
+            }
+            std::string part = str.substr(pos, end - pos);
+            size_t eq = part.find('=');
+            if (eq != std::string::npos) {
+                result[part.substr(0, eq)] = part.substr(eq + 1);
+            }
+            pos = end + 1;
+        }
+        return result;
+    }
+
+    static std::string normalizeKey(const std::string& key) {
+        std::string result{};
+        for (char c : key) {
+            if (c != '/' || result.empty() || result.back() != '/') {
+                result += c;
+            }
+        }
+        if (result.empty() || result[0] != '/') {
+            result = "/" + result;
+        }
+        if (result.size() > 1 && result.back() == '/') {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    static bool isInDir(const std::string& key, const std::string& dir) {
+        return key == dir || (key.compare(0, dir.size(), dir) == 0 && key.size() > dir.size() && key[dir.size()] == '/') || dir == "/";
+    }
+
+    static std::string nodeJson(const std::string& key, const Node& node) {
+        std::string json = R"({"key":")" + escape(key) + R"(",)";
+        if (node.dir) {
+            json += R"("dir":true,)";
+        } else {
+            json += R"("value":")" + escape(node.value) + R"(",)";
+        }
+        if (node.ttl > 0) {
+            json += R"("ttl":)" + std::to_string(node.ttl) + ",";
+        }
+        json += R"("modifiedIndex":)" + std::to_string(node.modifiedIndex) + "}";
+        return json;
+    }
+
+    static std::string eventJson(const Event& event) {
+        Node node{event.value, event.dir, 0, event.index};
+        return R"({"action":")" + event.action + R"(","node":)" + nodeJson(event.key, node) + "}";
+    }
+
+    std::string errorJson(int code, const std::string& message, const std::string& key) const {
+        return R"({"errorCode":)" + std::to_string(code) + R"(,"message":")" + message + R"(","cause":")" +
+               escape(key) + R"(","index":)" + std::to_string(index) + "}";
+    }
+
+    void putNode(const std::string& key, const Node& node) {
+        auto result = nodes.insert(std::make_pair(key, node));
+        if (!result.second) {
+            result.first->second = node;
+        }
+    }
+
+    void removeRecursive(const std::string& key) {
+        for (auto it = nodes.begin(); it != nodes.end();) {
+            if (isInDir(it->first, key)) {
+                it = nodes.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void acceptConnections() {
+        while (true) {
+            int fd = accept(listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                break;
+            }
+            std::lock_guard<std::mutex> lck{mutex};
+            if (stopped) {
+                close(fd);
+                break;
+            }
+            nrOfConnections += 1;
+            clientFds.push_back(fd);
+            clientThreads.emplace_back([this, fd]{ handleConnection(fd); });
+        }
+    }
+
+    static bool sendAll(int fd, const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0) {
+                return false;
+            }
+            sent += (size_t)n;
+        }
+        return true;
+    }
+
+    static bool readRequest(int fd, std::string& buffer, Request& request) {
+        size_t headerEnd;
+        while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+            char tmp[4096];
+            ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(tmp, (size_t)n);
+        }
+        std::string header = buffer.substr(0, headerEnd);
+        size_t contentLength = 0;
+        size_t clPos = header.find("Content-Length: ");
+        if (clPos != std::string::npos) {
+            contentLength = std::stoul(header.substr(clPos + strlen("Content-Length: ")));
+        }
+        while (buffer.size() < headerEnd + 4 + contentLength) {
+            char tmp[4096];
+            ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(tmp, (size_t)n);
+        }
+        std::string body = buffer.substr(headerEnd + 4, contentLength);
+        buffer.erase(0, headerEnd + 4 + contentLength);
+
+        size_t methodEnd = header.find(' ');
+        size_t uriEnd = header.find(' ', methodEnd + 1);
+        request.method = header.substr(0, methodEnd);
+        std::string uri = header.substr(methodEnd + 1, uriEnd - methodEnd - 1);
+        size_t queryStart = uri.find('?');
+        std::string path = uri.substr(0, queryStart);
+        request.query = queryStart == std::string::npos ? std::map<std::string, std::string>{} : parseForm(uri.substr(queryStart + 1));
+        request.key = normalizeKey(path.substr(strlen("/v2/keys")));
+        request.form = parseForm(body);
+        return true;
+    }
+
+    bool respond(int fd, int code, const std::string& body) {
+        std::string reason = code == 200 ? "OK" : code == 201 ? "Created" : "Error";
+        std::string response = "HTTP/1.1 " + std::to_string(code) + " " + reason + "\r\n" +
+                               "Content-Type: application/json\r\n" +
+                               "X-Etcd-Index: " + std::to_string(index) + "\r\n" +
+                               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+        return sendAll(fd, response);
+    }
+
+    void handleConnection(int fd) {
+        std::string buffer{};
+        Request request{};
+        bool open = true;
+        while (open && readRequest(fd, buffer, request)) {
+            nrOfRequests += 1;
+            if (request.method == "GET" && request.query["stream"] == "true") {
+                open = streamWatch(fd, request);
+            } else if (request.method == "GET" && request.query["wait"] == "true") {
+                open = longPollWatch(fd, request);
+            } else {
+                std::unique_lock<std::mutex> lck{mutex};
+                open = handleRequest(fd, request, lck);
+            }
+        }
+        close(fd);
+    }
+
+    bool handleRequest(int fd, Request& request, std::unique_lock<std::mutex>& lck) {
+        const std::string& key = request.key;
+        auto it = nodes.find(key);
+        if (request.method == "GET") {
+            if (it == nodes.end()) {
+                return respond(fd, 404, errorJson(100, "Key not found", key));
+            }
+            if (!it->second.dir) {
+                return respond(fd, 200, R"({"action":"get","node":)" + nodeJson(key, it->second) + "}");
+            }
+            std::string children{};
+            for (const auto& node : nodes) {
+                if (node.first != key && isInDir(node.first, key) && !node.second.dir) {
+                    children += (children.empty() ? "" : ",") + nodeJson(node.first, node.second);
+                }
+            }
+            return respond(fd, 200, R"({"action":"get","node":{"key":")" + escape(key) + R"(","dir":true,"nodes":[)" + children + "]}}");
+        } else if (request.method == "PUT") {
+            bool exists = it != nodes.end();
+            auto prevExist = request.form.find("prevExist");
+            if (prevExist != request.form.end() && prevExist->second == "true" && !exists) {
+                return respond(fd, 404, errorJson(100, "Key not found", key));
+            }
+            if (prevExist != request.form.end() && prevExist->second == "false" && exists) {
+                return respond(fd, 412, errorJson(105, "Key already exists", key));
+            }
+            int ttl = request.form.count("ttl") ? std::stoi(request.form["ttl"]) : 0;
+            if (request.form["refresh"] == "true") {
+                if (!exists) {
+                    return respond(fd, 404, errorJson(100, "Key not found", key));
+                }
+                it->second.ttl = ttl;
+                nrOfRefreshes += 1;
+                return respond(fd, 200, R"({"action":"update","node":)" + nodeJson(key, it->second) + "}");
+            }
+            bool dir = request.form["dir"] == "true";
+            putNode(key, Node{request.form["value"], dir, ttl, ++index});
+            std::string action = exists ? "update" : (dir ? "create" : "set");
+            events.push_back(Event{action, key, request.form["value"], dir, index});
+            lck.unlock();
+            cond.notify_all();
+            lck.lock();
+            return respond(fd, exists ? 200 : 201, R"({"action":")" + action + R"(","node":)" + nodeJson(key, nodes.at(key)) + "}");
+        } else if (request.method == "DELETE") {
+            if (!exists(key)) {
+                return respond(fd, 404, errorJson(100, "Key not found", key));
+            }
+            bool dir = it->second.dir;
+            removeRecursive(key);
+            events.push_back(Event{"delete", key, "", dir, ++index});
+            lck.unlock();
+            cond.notify_all();
+            lck.lock();
+            return respond(fd, 200, R"({"action":"delete","node":{"key":")" + escape(key) + R"(","modifiedIndex":)" + std::to_string(index) + "}}");
+        }
+        return respond(fd, 405, errorJson(0, "Method not allowed", key));
+    }
+
+    bool exists(const std::string& key) const {
+        return nodes.find(key) != nodes.end();
+    }
+
+    /**
+     * Responds with the first event for the watched key, waits till the event is available.
+     */
+    bool longPollWatch(int fd, Request& request) {
+        std::unique_lock<std::mutex> lck{mutex};
+        long long nextIndex = request.query.count("waitIndex") ? std::stoll(request.query["waitIndex"]) : index + 1;
+        while (!stopped) {
+            for (const auto& event : events) {
+                if (event.index >= nextIndex && isInDir(event.key, request.key)) {
+                    return respond(fd, 200, eventJson(event));
+                }
+            }
+            cond.wait_for(lck, std::chrono::milliseconds{100});
+        }
+        return false;
+    }
+
+    /**
+     * Sends the events for the watched key as chunks, every chunk contains all events available at that moment.
+     */
+    bool streamWatch(int fd, Request& request) {
+        std::unique_lock<std::mutex> lck{mutex};
+        long long nextIndex = request.query.count("waitIndex") ? std::stoll(request.query["waitIndex"]) : index + 1;
+        if (nextIndex < oldestIndex) {
+            return respond(fd, 400, errorJson(401, "The event in requested index is outdated and cleared", request.key));
+        }
+        std::string header = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nX-Etcd-Index: " +
+                             std::to_string(index) + "\r\nTransfer-Encoding: chunked\r\n\r\n";
+        if (!sendAll(fd, header)) {
+            return false;
+        }
+        int generation = streamGeneration;
+        while (true) {
+            std::string chunk{};
+            for (const auto& event : events) {
+                if (event.index >= nextIndex && isInDir(event.key, request.key)) {
+                    chunk += eventJson(event) + "\n";
+                }
+            }
+            if (!events.empty()) {
+                nextIndex = std::max(nextIndex, events.back().index + 1);
+            }
+            if (!chunk.empty()) {
+                char size[32];
+                snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+                if (!sendAll(fd, size + chunk + "\r\n")) {
+                    return false;
+                }
+            }
+            if (stopped) {
+                return false;
+            }
+            if (generation != streamGeneration) {
+                return sendAll(fd, "0\r\n\r\n");
+            }
+            cond.wait_for(lck, std::chrono::milliseconds{100});
+        }
+    }
+
+    int listenFd{-1};
+    int port{0};
+    std::thread acceptThread{};
+    std::atomic<int> nrOfConnections{0};
+    std::atomic<int> nrOfRequests{0};
+    std::atomic<int> nrOfRefreshes{0};
+
+    std::mutex mutex{}; //protects below
+    std::condition_variable cond{};
+    bool stopped{false};
+    int streamGeneration{0};
+    long long index{1};
+    long long oldestIndex{0};
+    std::map<std::string, Node> nodes{};
+    std::vector<Event> events{};
+    std::vector<int> clientFds{};
+    std::vector<std::thread> clientThreads{};
+};
+
+class EtcdlibTestSuite : public ::testing::Test {
+public:
+    EtcdlibTestSuite() : etcd{}, lib{etcdlib_create("127.0.0.1", etcd.getPort(), 0)} {}
+
+    ~EtcdlibTestSuite() override {
+        etcdlib_destroy(lib);
+    }
+
+    EtcdlibTestSuite(EtcdlibTestSuite&&) = delete;
+    EtcdlibTestSuite(const EtcdlibTestSuite&) = delete;
+    EtcdlibTestSuite& operator=(EtcdlibTestSuite&&) = delete;
+    EtcdlibTestSuite& operator=(const EtcdlibTestSuite&) = delete;
+
+    struct WatchResult {
+        std::mutex mutex{};
+        std::condition_variable cond{};
+        std::vector<int> batchSizes{};
+        std::vector<std::string> keys{};
+        std::vector<std::string> actions{};
+        std::vector<bool> dirs{};
+        size_t stopAfter{0}; //0 is never
+    };
+
+    static bool watchCallback(const etcdlib_watch_event_t *events, int nrOfEvents, void *arg) {
+        auto* result = static_cast<WatchResult*>(arg);
+        std::lock_guard<std::mutex> lck{result->mutex};
+        result->batchSizes.push_back(nrOfEvents);
+        for (int i = 0; i < nrOfEvents; ++i) {
+            result->keys.emplace_back(events[i].key);
+            result->actions.emplace_back(events[i].action);
+            result->dirs.push_back(events[i].dir);
+        }
+        result->cond.notify_all();
+        return result->stopAfter == 0 || result->keys.size() < result->stopAfter;
+    }
+
+    static bool waitForEvents(WatchResult& result, size_t count) {
+        std::unique_lock<std::mutex> lck{result.mutex};
+        return result.cond.wait_for(lck, std::chrono::seconds{5}, [&]{ return result.keys.size() >= count; });
+    }
+
+    FakeEtcd etcd;
+    etcdlib_t* lib;
+};
+
+TEST_F(EtcdlibTestSuite, ReuseConnection) {
+    for (int i = 0; i < 20; ++i) {
+        std::string key = "test/key" + std::to_string(i);
+        EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, key.c_str(), "value", 10, false));
+        char *value = nullptr;
+        EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_get(lib, key.c_str(), &value, nullptr));
+        EXPECT_STREQ("value", value);
+        free(value);
+        EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_refresh(lib, key.c_str(), 10));
+    }
+    EXPECT_EQ(60, etcd.getNrOfRequests());
+    EXPECT_EQ(1, etcd.getNrOfConnections());
+}
+
+TEST_F(EtcdlibTestSuite, KeyTtlRefresh) {
+    EXPECT_NE(ETCDLIB_RC_OK, etcdlib_set(lib, "test/key", "value", 10, true)); //prevExist, but not yet created
+    EXPECT_NE(ETCDLIB_RC_OK, etcdlib_refresh(lib, "test/key", 10)); //not yet created
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, "test/key", "value", 10, false));
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_refresh(lib, "test/key", 10));
+    EXPECT_EQ(1, etcd.getNrOfRefreshes());
+
+    char *value = nullptr;
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_get(lib, "test/key", &value, nullptr));
+    EXPECT_STREQ("value", value); //a refresh does not change the value
+    free(value);
+}
+
+TEST_F(EtcdlibTestSuite, DirectoryTtlRefresh) {
+    EXPECT_NE(ETCDLIB_RC_OK, etcdlib_refresh_directory(lib, "fw1", 10)); //not yet created
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set_directory(lib, "fw1", 10, false));
+    EXPECT_NE(ETCDLIB_RC_OK, etcdlib_set_directory(lib, "fw1", 10, false)); //already exists
+    for (int i = 0; i < 100; ++i) {
+        std::string key = "fw1/endpoint" + std::to_string(i);
+        EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, key.c_str(), "value", 0, false));
+    }
+
+    //one request to keep all 100 keys alive
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_refresh_directory(lib, "fw1", 10));
+    EXPECT_EQ(1, etcd.getNrOfRefreshes());
+
+    int count = 0;
+    etcdlib_get_directory(lib, "fw1", [](const char*, const char*, void* arg) { *static_cast<int*>(arg) += 1; }, &count, nullptr);
+    EXPECT_EQ(100, count);
+
+    etcd.expire("/fw1");
+    EXPECT_NE(ETCDLIB_RC_OK, etcdlib_refresh_directory(lib, "fw1", 10));
+}
+
+TEST_F(EtcdlibTestSuite, StreamingWatchDeliversBatches) {
+    WatchResult result{};
+    long long startIndex = etcd.getIndex() + 1;
+    long long lastIndex = 0;
+    int rc = -1;
+    std::thread watchThread{[&]{
+        rc = etcdlib_watch_stream(lib, "pubsub", startIndex, watchCallback, &result, &lastIndex);
+    }};
+
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, "pubsub/a", "1", 0, false));
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, "other/b", "1", 0, false)); //not watched
+    EXPECT_TRUE(waitForEvents(result, 1));
+    etcd.setBatch({{"/pubsub/b", "2"}, {"/pubsub/c", "3"}, {"/pubsub/d", "4"}});
+    EXPECT_TRUE(waitForEvents(result, 4));
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_del(lib, "pubsub/a"));
+    EXPECT_TRUE(waitForEvents(result, 5));
+
+    etcdlib_interrupt_watch(lib);
+    watchThread.join();
+    EXPECT_EQ(ETCDLIB_RC_INTERRUPTED, rc);
+    EXPECT_EQ(etcd.getIndex(), lastIndex);
+
+    std::lock_guard<std::mutex> lck{result.mutex};
+    ASSERT_EQ(3u, result.batchSizes.size());
+    EXPECT_EQ(1, result.batchSizes[0]);
+    EXPECT_EQ(3, result.batchSizes[1]);
+    EXPECT_EQ(1, result.batchSizes[2]);
+    EXPECT_EQ((std::vector<std::string>{"/pubsub/a", "/pubsub/b", "/pubsub/c", "/pubsub/d", "/pubsub/a"}), result.keys);
+    EXPECT_EQ((std::vector<std::string>{"set", "set", "set", "set", "delete"}), result.actions);
+}
+
+TEST_F(EtcdlibTestSuite, StreamingWatchContinuesAfterStreamEnd) {
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set_directory(lib, "pubsub/fw1", 10, false));
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, "pubsub/fw1/a", "1", 0, false));
+
+    WatchResult result{};
+    long long index = 1;
+    int rc = -1;
+    std::thread watchThread{[&]{
+        rc = etcdlib_watch_stream(lib, "pubsub", index + 1, watchCallback, &result, &index);
+    }};
+    EXPECT_TRUE(waitForEvents(result, 2)); //history
+    etcd.endStreams();
+    watchThread.join();
+    EXPECT_EQ(ETCDLIB_RC_TIMEOUT, rc);
+    EXPECT_EQ(etcd.getIndex(), index);
+
+    //continue from the last index, using the same watch connection
+    result.stopAfter = 3;
+    watchThread = std::thread{[&]{
+        rc = etcdlib_watch_stream(lib, "pubsub", index + 1, watchCallback, &result, &index);
+    }};
+    etcd.expire("/pubsub/fw1");
+    watchThread.join();
+    EXPECT_EQ(ETCDLIB_RC_OK, rc); //stopped by callback
+
+    std::lock_guard<std::mutex> lck{result.mutex};
+    EXPECT_EQ((std::vector<std::string>{"/pubsub/fw1", "/pubsub/fw1/a", "/pubsub/fw1"}), result.keys);
+    EXPECT_EQ((std::vector<std::string>{"create", "set", "expire"}), result.actions);
+    EXPECT_TRUE(result.dirs[2]);
+    EXPECT_EQ(2, etcd.getNrOfConnections()); //one for the requests and one for the streaming watches
+}
+
+TEST_F(EtcdlibTestSuite, StreamingWatchDoesNotBlockWatch) {
+    WatchResult result{};
+    int rc = -1;
+    long long startIndex = etcd.getIndex() + 1;
+    std::thread streamThread{[&]{
+        rc = etcdlib_watch_stream(lib, "pubsub", startIndex, watchCallback, &result, nullptr);
+    }};
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_set(lib, "pubsub/a", "1", 0, false));
+    EXPECT_TRUE(waitForEvents(result, 1)); //stream is active
+
+    //a (long poll) watch on the same instance has its own connection, so it is not blocked by the active stream
+    long long index = etcd.getIndex();
+    std::thread setThread{[&]{
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        etcdlib_set(lib, "other/b", "2", 0, false);
+    }};
+    char *action = nullptr;
+    char *value = nullptr;
+    char *rkey = nullptr;
+    long long modIndex = 0;
+    EXPECT_EQ(ETCDLIB_RC_OK, etcdlib_watch(lib, "other", index + 1, &action, nullptr, &value, &rkey, &modIndex));
+    EXPECT_STREQ("set", action);
+    EXPECT_STREQ("/other/b", rkey);
+    EXPECT_STREQ("2", value);
+    EXPECT_EQ(index + 1, modIndex);
+    free(action);
+    free(value);
+    free(rkey);
+    setThread.join();
+
+    etcdlib_interrupt_watch(lib);
+    streamThread.join();
+    EXPECT_EQ(ETCDLIB_RC_INTERRUPTED, rc);
+    EXPECT_EQ(3, etcd.getNrOfConnections()); //requests, streaming watch and watch
+}
+
+TEST_F(EtcdlibTestSuite, StreamingWatchOnClearedIndex) {
+    etcd.clearHistory(10);
+    WatchResult result{};
+    long long index = 0;
+    EXPECT_EQ(ETCDLIB_RC_ERROR, etcdlib_watch_stream(lib, "pubsub", 2, watchCallback, &result, &index));
+    EXPECT_EQ(1, index);
+    EXPECT_TRUE(result.keys.empty());
+}
+
+TEST_F(EtcdlibTestSuite, InterruptBeforeWatch) {
+    etcdlib_interrupt_watch(lib);
+    WatchResult result{};
+    EXPECT_EQ(ETCDLIB_RC_INTERRUPTED, etcdlib_watch_stream(lib, "pubsub", 0, watchCallback, &result, nullptr));
+}
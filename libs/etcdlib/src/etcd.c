@@ -36,6 +36,7 @@
 #define ETCD_JSON_MODIFIEDINDEX         "modifiedIndex"
 #define ETCD_JSON_INDEX                 "index"
 #define ETCD_JSON_ERRORCODE				"errorCode"
+#define ETCD_JSON_MESSAGE               "message"
 
 #define ETCD_HEADER_INDEX               "X-Etcd-Index: "
 
@@ -48,6 +49,13 @@ struct etcdlib_struct {
 	int port;
 	CURL *curl;
     pthread_mutex_t mutex;
+
+    //separate (persistent) connections for watches, so that a long poll or stream does not block the other requests
+    CURL *watchCurl;
+    pthread_mutex_t watchMutex;
+    CURL *streamCurl;
+    pthread_mutex_t streamMutex;
+    int watchInterrupted; //atomic, interrupts the streaming watch
 };
 
 typedef enum {
@@ -65,12 +73,28 @@ struct MemoryStruct {
     size_t headerSize;
 };
 
+struct WatchStream {
+    etcdlib_t *etcdlib;
+    etcdlib_watch_callback callback;
+    void *arg;
+    char *buffer; //received data which is not yet a complete (newline terminated) event
+    size_t bufferSize;
+    long long lastIndex;
+    int nrOfEvents;
+    bool stopped; //callback returned false
+    bool error; //etcd error object received
+};
+
 
 /**
  * Static function declarations
  */
 static int performRequest(CURL **curl, pthread_mutex_t *mutex, char* url, request_t request, void* reqData, void* repData);
+static int etcdlib_putAndCheckErrorCode(etcdlib_t *etcdlib, const char *key, const char *request);
 static size_t WriteMemoryCallback(void *contents, size_t size, size_t nmemb, void *userp);
+static void setupCurl(CURL **curl, char* url);
+static size_t WriteStreamCallback(void *contents, size_t size, size_t nmemb, void *userp);
+static int WatchInterruptCallback(void *userp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
 /**
  * External function definition
  */
@@ -92,6 +116,11 @@ int etcd_init(const char* server, int port, int flags) {
 	}
     g_etcdlib.curl = NULL;
     pthread_mutex_init(&g_etcdlib.mutex, NULL);
+    g_etcdlib.watchCurl = NULL;
+    pthread_mutex_init(&g_etcdlib.watchMutex, NULL);
+    g_etcdlib.streamCurl = NULL;
+    pthread_mutex_init(&g_etcdlib.streamMutex, NULL);
+    g_etcdlib.watchInterrupted = 0;
 
 	if ((flags & ETCDLIB_NO_CURL_INITIALIZATION) == 0) {
 		//NO_CURL_INITIALIZATION flag not set
@@ -112,6 +141,11 @@ etcdlib_t* etcdlib_create(const char* server, int port, int flags) {
 	lib->port = port;
 	lib->curl = NULL;
     pthread_mutex_init(&lib->mutex, NULL);
+    lib->watchCurl = NULL;
+    pthread_mutex_init(&lib->watchMutex, NULL);
+    lib->streamCurl = NULL;
+    pthread_mutex_init(&lib->streamMutex, NULL);
+    lib->watchInterrupted = 0;
 
 	return lib;
 }
@@ -123,7 +157,17 @@ void etcdlib_destroy(etcdlib_t *etcdlib) {
             curl_easy_cleanup(etcdlib->curl);
             etcdlib->curl = NULL;
         }
+        if(etcdlib->watchCurl != NULL) {
+            curl_easy_cleanup(etcdlib->watchCurl);
+            etcdlib->watchCurl = NULL;
+        }
+        if(etcdlib->streamCurl != NULL) {
+            curl_easy_cleanup(etcdlib->streamCurl);
+            etcdlib->streamCurl = NULL;
+        }
         pthread_mutex_destroy(&etcdlib->mutex);
+        pthread_mutex_destroy(&etcdlib->watchMutex);
+        pthread_mutex_destroy(&etcdlib->streamMutex);
     }
     free(etcdlib);
 }
@@ -363,11 +407,11 @@ int etcdlib_set(etcdlib_t *etcdlib, const char* key, const char* value, int ttl,
 
 	requestPtr += snprintf(requestPtr, req_len, "value=%s", value);
 	if (ttl > 0) {
-		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";ttl=%d", ttl);
+		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), "&ttl=%d", ttl);
 	}
 
 	if (prevExist) {
-		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), ";prevExist=true");
+		requestPtr += snprintf(requestPtr, req_len-(requestPtr-request), "&prevExist=true");
 	}
 
 	res = performRequest(&etcdlib->curl, &etcdlib->mutex, url, PUT, request, (void*) &reply);
@@ -407,10 +451,41 @@ int etcd_refresh(const char* key, int ttl) {
 }
 
 int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl) {
+	char request[MAX_OVERHEAD_LENGTH];
+	snprintf(request, sizeof(request), "ttl=%d&prevExist=true&refresh=true", ttl);
+	return etcdlib_putAndCheckErrorCode(etcdlib, key, request);
+}
+
+int etcd_set_directory(const char* directory, int ttl, bool prevExist) {
+	return etcdlib_set_directory(&g_etcdlib, directory, ttl, prevExist);
+}
+
+int etcdlib_set_directory(etcdlib_t *etcdlib, const char* directory, int ttl, bool prevExist) {
+	char request[MAX_OVERHEAD_LENGTH];
+	if (ttl > 0) {
+		snprintf(request, sizeof(request), "dir=true&ttl=%d&prevExist=%s", ttl, prevExist ? "true" : "false");
+	} else {
+		snprintf(request, sizeof(request), "dir=true&prevExist=%s", prevExist ? "true" : "false");
+	}
+	return etcdlib_putAndCheckErrorCode(etcdlib, directory, request);
+}
+
+int etcd_refresh_directory(const char* directory, int ttl) {
+	return etcdlib_refresh_directory(&g_etcdlib, directory, ttl);
+}
+
+int etcdlib_refresh_directory(etcdlib_t *etcdlib, const char* directory, int ttl) {
+	char request[MAX_OVERHEAD_LENGTH];
+	snprintf(request, sizeof(request), "dir=true&ttl=%d&prevExist=true&refresh=true", ttl);
+	return etcdlib_putAndCheckErrorCode(etcdlib, directory, request);
+}
+
+/**
+ * Performs a PUT request for the key and returns ETCDLIB_RC_OK if the reply is json without etcd errorCode.
+ */
+static int etcdlib_putAndCheckErrorCode(etcdlib_t *etcdlib, const char *key, const char *request) {
 	int retVal = ETCDLIB_RC_ERROR;
 	char *url;
-	size_t req_len = MAX_OVERHEAD_LENGTH;
-	char request[req_len];
 
 	int res;
 	struct MemoryStruct reply;
@@ -426,9 +501,8 @@ int etcdlib_refresh(etcdlib_t *etcdlib, const char *key, int ttl) {
     reply.headerSize = 0; /* no data at this point */
 
 	asprintf(&url, "http://%s:%d/v2/keys/%s", etcdlib->host, etcdlib->port, key);
-	snprintf(request, req_len, "ttl=%d;prevExists=true;refresh=true", ttl);
 
-	res = performRequest(&etcdlib->curl, &etcdlib->mutex, url, PUT, request, (void*) &reply);
+	res = performRequest(&etcdlib->curl, &etcdlib->mutex, url, PUT, (void*)request, (void*) &reply);
 	if(url) {
 		free(url);
 	}
@@ -517,11 +591,7 @@ int etcdlib_watch(etcdlib_t *etcdlib, const char* key, long long index, char** a
 		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true", etcdlib->host, etcdlib->port, key);
 
 	// don't use shared curl/mutex for watch, that will lock everything.
-	CURL *curl = NULL;
-
-	res = performRequest(&curl, NULL, url, GET, NULL, (void*) &reply);
-
-    curl_easy_cleanup(curl);
+	res = performRequest(&etcdlib->watchCurl, &etcdlib->watchMutex, url, GET, NULL, (void*) &reply);
 
 	if(url)
 		free(url);
@@ -584,6 +654,74 @@ int etcdlib_watch(etcdlib_t *etcdlib, const char* key, long long index, char** a
 }
 
 
+int etcd_watch_stream(const char* key, long long index, etcdlib_watch_callback callback, void *arg, long long* modifiedIndex) {
+	return etcdlib_watch_stream(&g_etcdlib, key, index, callback, arg, modifiedIndex);
+}
+
+int etcdlib_watch_stream(etcdlib_t *etcdlib, const char* key, long long index, etcdlib_watch_callback callback, void *arg, long long* modifiedIndex) {
+	int retVal = ETCDLIB_RC_OK;
+	char *url = NULL;
+	struct WatchStream stream;
+	memset(&stream, 0, sizeof(stream));
+	stream.etcdlib = etcdlib;
+	stream.callback = callback;
+	stream.arg = arg;
+	stream.lastIndex = index > 0 ? index - 1 : 0;
+
+	if (index != 0) {
+		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true&stream=true&waitIndex=%lld", etcdlib->host, etcdlib->port, key, index);
+	} else {
+		asprintf(&url, "http://%s:%d/v2/keys/%s?wait=true&recursive=true&stream=true", etcdlib->host, etcdlib->port, key);
+	}
+
+	pthread_mutex_lock(&etcdlib->streamMutex);
+	setupCurl(&etcdlib->streamCurl, url);
+	//no (total) timeout, the stream stays open till the server closes it or the watch is interrupted
+	curl_easy_setopt(etcdlib->streamCurl, CURLOPT_WRITEFUNCTION, WriteStreamCallback);
+	curl_easy_setopt(etcdlib->streamCurl, CURLOPT_WRITEDATA, &stream);
+	curl_easy_setopt(etcdlib->streamCurl, CURLOPT_NOPROGRESS, 0L);
+	curl_easy_setopt(etcdlib->streamCurl, CURLOPT_XFERINFOFUNCTION, WatchInterruptCallback);
+	curl_easy_setopt(etcdlib->streamCurl, CURLOPT_XFERINFODATA, etcdlib);
+	curl_easy_setopt(etcdlib->streamCurl, CURLOPT_CUSTOMREQUEST, "GET");
+
+	CURLcode res = CURLE_ABORTED_BY_CALLBACK;
+	if (__atomic_load_n(&etcdlib->watchInterrupted, __ATOMIC_ACQUIRE) == 0) {
+		res = curl_easy_perform(etcdlib->streamCurl);
+	}
+	long httpCode = 0;
+	curl_easy_getinfo(etcdlib->streamCurl, CURLINFO_RESPONSE_CODE, &httpCode);
+
+	if (stream.stopped) {
+		retVal = ETCDLIB_RC_OK;
+	} else if (res == CURLE_ABORTED_BY_CALLBACK) {
+		__atomic_store_n(&etcdlib->watchInterrupted, 0, __ATOMIC_RELEASE);
+		retVal = ETCDLIB_RC_INTERRUPTED;
+	} else if (stream.error || (res == CURLE_OK && httpCode != 200)) {
+		retVal = ETCDLIB_RC_ERROR;
+	} else if (res == CURLE_OK) {
+		//server ended the stream
+		retVal = ETCDLIB_RC_TIMEOUT;
+	} else {
+		fprintf(stderr, "[ETCDLIB] Curl error for watch stream %s: %s\n", url, curl_easy_strerror(res));
+		curl_easy_cleanup(etcdlib->streamCurl);
+		etcdlib->streamCurl = NULL;
+		retVal = ETCDLIB_RC_ERROR;
+	}
+	pthread_mutex_unlock(&etcdlib->streamMutex);
+
+	if (modifiedIndex != NULL) {
+		*modifiedIndex = stream.lastIndex;
+	}
+	free(stream.buffer);
+	free(url);
+	return retVal;
+}
+
+void etcdlib_interrupt_watch(etcdlib_t *etcdlib) {
+	__atomic_store_n(&etcdlib->watchInterrupted, 1, __ATOMIC_RELEASE);
+}
+
+
 int etcd_del(const char* key) {
 	return etcdlib_del(&g_etcdlib, key);
 }
@@ -664,23 +802,121 @@ static size_t WriteHeaderCallback(void *contents, size_t size, size_t nmemb, voi
     return realsize;
 }
 
+static int WatchInterruptCallback(void *userp, curl_off_t dltotal __attribute__((unused)), curl_off_t dlnow __attribute__((unused)), curl_off_t ultotal __attribute__((unused)), curl_off_t ulnow __attribute__((unused))) {
+	etcdlib_t *etcdlib = userp;
+	return __atomic_load_n(&etcdlib->watchInterrupted, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Parses a single watch event line. Returns false if the line is an etcd error object.
+ */
+static bool parseWatchEvent(json_t *js_root, etcdlib_watch_event_t *event) {
+	if (json_object_get(js_root, ETCD_JSON_ERRORCODE) != NULL) {
+		json_t *js_message = json_object_get(js_root, ETCD_JSON_MESSAGE);
+		fprintf(stderr, "[ETCDLIB] Watch stream error %lli: %s\n", json_integer_value(json_object_get(js_root, ETCD_JSON_ERRORCODE)),
+				js_message != NULL ? json_string_value(js_message) : "");
+		return false;
+	}
+	json_t *js_node = json_object_get(js_root, ETCD_JSON_NODE);
+	json_t *js_prevNode = json_object_get(js_root, ETCD_JSON_PREVNODE);
+	memset(event, 0, sizeof(*event));
+	event->action = json_string_value(json_object_get(js_root, ETCD_JSON_ACTION));
+	event->key = json_string_value(json_object_get(js_node, ETCD_JSON_KEY));
+	event->value = json_string_value(json_object_get(js_node, ETCD_JSON_VALUE));
+	event->dir = json_is_true(json_object_get(js_node, ETCD_JSON_DIR));
+	event->modifiedIndex = json_integer_value(json_object_get(js_node, ETCD_JSON_MODIFIEDINDEX));
+	if (js_prevNode != NULL) {
+		event->prevValue = json_string_value(json_object_get(js_prevNode, ETCD_JSON_VALUE));
+	}
+	return true;
+}
+
+/**
+ * Collects the newline terminated watch events received in a chunk and delivers them to the callback as one batch.
+ */
+static size_t WriteStreamCallback(void *contents, size_t size, size_t nmemb, void *userp) {
+	size_t realsize = size * nmemb;
+	struct WatchStream *stream = userp;
+
+	char *buffer = realloc(stream->buffer, stream->bufferSize + realsize + 1);
+	if (buffer == NULL) {
+		fprintf(stderr, "[ETCDLIB] Error: not enough memory for watch stream (realloc returned NULL)\n");
+		return 0;
+	}
+	stream->buffer = buffer;
+	memcpy(&stream->buffer[stream->bufferSize], contents, realsize);
+	stream->bufferSize += realsize;
+	stream->buffer[stream->bufferSize] = '\0';
+
+	int capacity = 0;
+	int nrOfEvents = 0;
+	json_t **roots = NULL;
+	etcdlib_watch_event_t *events = NULL;
+
+	char *line = stream->buffer;
+	char *end = strchr(line, '\n');
+	while (end != NULL && !stream->error) {
+		*end = '\0';
+		json_error_t error;
+		json_t *js_root = line[0] != '\0' && line[0] != '\r' ? json_loads(line, 0, &error) : NULL;
+		if (js_root != NULL) {
+			if (nrOfEvents == capacity) {
+				capacity = capacity == 0 ? 8 : capacity * 2;
+				json_t **newRoots = realloc(roots, capacity * sizeof(*roots));
+				if (newRoots != NULL) {
+					roots = newRoots;
+				}
+				etcdlib_watch_event_t *newEvents = realloc(events, capacity * sizeof(*events));
+				if (newEvents != NULL) {
+					events = newEvents;
+				}
+				if (newRoots == NULL || newEvents == NULL) {
+					fprintf(stderr, "[ETCDLIB] Error: not enough memory for watch events (realloc returned NULL)\n");
+					stream->error = true;
+					json_decref(js_root);
+					break;
+				}
+			}
+			if (parseWatchEvent(js_root, &events[nrOfEvents])) {
+				roots[nrOfEvents++] = js_root;
+			} else {
+				stream->error = true;
+				json_decref(js_root);
+			}
+		}
+		line = end + 1;
+		end = strchr(line, '\n');
+	}
+
+	//keep the incomplete event
+	size_t remaining = stream->bufferSize - (size_t)(line - stream->buffer);
+	memmove(stream->buffer, line, remaining);
+	stream->bufferSize = remaining;
+	stream->buffer[remaining] = '\0';
+
+	if (nrOfEvents > 0) {
+		stream->nrOfEvents += nrOfEvents;
+		stream->lastIndex = events[nrOfEvents - 1].modifiedIndex;
+		if (!stream->callback(events, nrOfEvents, stream->arg)) {
+			stream->stopped = true;
+		}
+	}
+	for (int i = 0; i < nrOfEvents; ++i) {
+		json_decref(roots[i]);
+	}
+	free(roots);
+	free(events);
+
+	return (stream->stopped || stream->error) ? 0 : realsize;
+}
+
 static int performRequest(CURL **curl, pthread_mutex_t *mutex, char* url, request_t request, void* reqData, void* repData) {
 	CURLcode res = 0;
 	if(mutex != NULL) {
         pthread_mutex_lock(mutex);
     }
-	if(*curl == NULL) {
-        *curl = curl_easy_init();
-    } else {
-	    curl_easy_reset(*curl);
-    }
-
-    curl_easy_setopt(*curl, CURLOPT_NOSIGNAL, 1);
+    setupCurl(curl, url);
     curl_easy_setopt(*curl, CURLOPT_TIMEOUT, DEFAULT_CURL_TIMEOUT);
-    curl_easy_setopt(*curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
-    curl_easy_setopt(*curl, CURLOPT_FOLLOWLOCATION, 1L);
-    //curl_easy_setopt(*curl, CURLOPT_VERBOSE, 1L);
-    curl_easy_setopt(*curl, CURLOPT_URL, url);
     curl_easy_setopt(*curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback);
     curl_easy_setopt(*curl, CURLOPT_WRITEDATA, repData);
     if (((struct MemoryStruct*)repData)->header) {
@@ -714,3 +950,22 @@ static int performRequest(CURL **curl, pthread_mutex_t *mutex, char* url, reques
 
     return res;
 }
+
+/**
+ * Creates or resets the curl handle. Note that curl_easy_reset keeps the open connections of the handle, so requests
+ * to the same etcd server reuse the (keep-alive) connection.
+ */
+static void setupCurl(CURL **curl, char* url) {
+	if(*curl == NULL) {
+        *curl = curl_easy_init();
+    } else {
+	    curl_easy_reset(*curl);
+    }
+
+    curl_easy_setopt(*curl, CURLOPT_NOSIGNAL, 1);
+    curl_easy_setopt(*curl, CURLOPT_CONNECTTIMEOUT, DEFAULT_CURL_CONNECT_TIMEOUT);
+    curl_easy_setopt(*curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(*curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    //curl_easy_setopt(*curl, CURLOPT_VERBOSE, 1L);
+    curl_easy_setopt(*curl, CURLOPT_URL, url);
+}
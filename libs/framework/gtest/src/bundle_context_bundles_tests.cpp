@@ -25,6 +25,11 @@
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <celix_log_utils.h>
 
 #include "celix_api.h"
@@ -471,3 +476,140 @@ TEST_F(CelixBundleContextBundlesTests, bundleInfoTests) {
     celix_bundleContext_unregisterService(ctx, svcId);
     celix_bundleContext_stopTracker(ctx, trackerId);
 }
+
+TEST_F(CelixBundleContextBundlesTests, parallelAutoStartTest) {
+    auto *props = properties_create();
+    properties_set(props, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+    properties_set(props, "org.osgi.framework.storage.clean", "onFirstInit");
+    properties_set(props, "org.osgi.framework.storage", ".cacheParallelAutoStartTestFramework");
+    properties_set(props, CELIX_AUTO_START_PARALLEL, "true");
+    properties_set(props, CELIX_AUTO_START_PARALLEL_NR_OF_THREADS, "2");
+    std::string level1 = std::string{TEST_BND1_LOC} + " " + TEST_BND2_LOC + " " + TEST_BND1_LOC; //note bnd1 twice
+    std::string level2 = std::string{TEST_BND_WITH_EXCEPTION_LOC} + " non-existing.zip " + TEST_BND3_LOC;
+    properties_set(props, CELIX_AUTO_START_1, level1.c_str());
+    properties_set(props, CELIX_AUTO_START_2, level2.c_str());
+
+    auto *parallelFw = celix_frameworkFactory_createFramework(props);
+    ASSERT_TRUE(parallelFw != nullptr);
+    auto *parallelCtx = celix_framework_getFrameworkContext(parallelFw);
+
+    //only the started bundles are listed
+    celix_array_list_t *bndIds = celix_bundleContext_listBundles(parallelCtx);
+    ASSERT_EQ(3, celix_arrayList_size(bndIds));
+    celix_arrayList_destroy(bndIds);
+    EXPECT_FALSE(celix_bundleContext_isBundleInstalled(parallelCtx, 5));
+
+    struct expected {
+        long bndId;
+        const char *symbolicName;
+        celix_bundle_state_e state;
+    };
+    std::vector<expected> expectedBundles{
+            {1, "simple_test_bundle1", OSGI_FRAMEWORK_BUNDLE_ACTIVE},
+            {2, "simple_test_bundle2", OSGI_FRAMEWORK_BUNDLE_ACTIVE},
+            {3, "bundle_with_exception", OSGI_FRAMEWORK_BUNDLE_RESOLVED}, //start fails, but libraries are loaded
+            {4, "simple_test_bundle3", OSGI_FRAMEWORK_BUNDLE_ACTIVE}};
+    //bundle ids follow the configured order, as for a sequential auto start
+    for (auto &exp : expectedBundles) {
+        bool called = celix_framework_useBundle(parallelFw, false, exp.bndId, &exp, [](void *handle, const celix_bundle_t *bnd) {
+            auto *exp = static_cast<expected*>(handle);
+            EXPECT_STREQ(exp->symbolicName, celix_bundle_getSymbolicName(bnd));
+            EXPECT_EQ(exp->state, celix_bundle_getState(bnd));
+            celix_bundle_startup_timing_t timing = celix_bundle_getStartupTiming(bnd);
+            EXPECT_TRUE(timing.preparedInParallel);
+            EXPECT_GT(timing.installDurationInMs, 0.0);
+            if (exp->bndId == 3) {
+                EXPECT_GT(timing.loadDurationInMs, 0.0);
+                EXPECT_GT(timing.startDurationInMs, 0.0);
+            }
+        });
+        EXPECT_TRUE(called);
+    }
+
+    celix_frameworkFactory_destroyFramework(parallelFw);
+}
+
+TEST_F(CelixBundleContextBundlesTests, startupTimingTest) {
+    long bndId = celix_bundleContext_installBundle(ctx, TEST_BND_WITH_EXCEPTION_LOC, true);
+    ASSERT_TRUE(bndId >= 0);
+
+    bool called = celix_framework_useBundle(fw, false, bndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        celix_bundle_startup_timing_t timing = celix_bundle_getStartupTiming(bnd);
+        EXPECT_FALSE(timing.preparedInParallel);
+        EXPECT_GT(timing.installDurationInMs, 0.0);
+        EXPECT_GT(timing.loadDurationInMs, 0.0);
+        EXPECT_GT(timing.startDurationInMs, 0.0);
+    });
+    EXPECT_TRUE(called);
+
+    celix_bundle_startup_timing_t fwTiming = celix_bundle_getStartupTiming(nullptr);
+    EXPECT_EQ(0.0, fwTiming.installDurationInMs);
+}
+
+TEST_F(CelixBundleContextBundlesTests, extractionCacheTest) {
+    const char *extractionCacheDir = ".cacheBundleExtractionTest";
+    auto createFw = [extractionCacheDir](const char *storage) {
+        auto *props = properties_create();
+        properties_set(props, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(props, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(props, "org.osgi.framework.storage", storage);
+        properties_set(props, CELIX_BUNDLE_EXTRACTION_CACHE_DIR, extractionCacheDir);
+        return celix_frameworkFactory_createFramework(props);
+    };
+
+    auto *fw1 = createFw(".cacheExtractionTestFramework1");
+    auto *ctx1 = celix_framework_getFrameworkContext(fw1);
+    long bndId = celix_bundleContext_installBundle(ctx1, TEST_BND_WITH_EXCEPTION_LOC, true);
+    ASSERT_TRUE(bndId >= 0);
+
+    //the bundle archive links the extraction cache entry
+    std::string manifestDir = std::string{".cacheExtractionTestFramework1/bundle"} + std::to_string(bndId) + "/version0.0/META-INF";
+    struct stat st{};
+    ASSERT_EQ(0, lstat(manifestDir.c_str(), &st));
+    EXPECT_TRUE(S_ISLNK(st.st_mode));
+    char *entryDir = realpath(manifestDir.c_str(), nullptr);
+    ASSERT_TRUE(entryDir != nullptr);
+    std::string cacheEntry = std::string{entryDir}.substr(0, strlen(entryDir) - strlen("/META-INF"));
+    free(entryDir);
+
+    //the extraction cache entry is shared, so it is read-only
+    std::string manifest = cacheEntry + "/META-INF/MANIFEST.MF";
+    ASSERT_EQ(0, stat(manifest.c_str(), &st));
+    EXPECT_EQ(0, st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH));
+
+    //a second framework in the same process extracts the bundle, so the bundle libraries are not shared
+    auto *fw2 = createFw(".cacheExtractionTestFramework2");
+    auto *ctx2 = celix_framework_getFrameworkContext(fw2);
+    long bndId2 = celix_bundleContext_installBundle(ctx2, TEST_BND_WITH_EXCEPTION_LOC, false);
+    ASSERT_TRUE(bndId2 >= 0);
+    manifestDir = std::string{".cacheExtractionTestFramework2/bundle"} + std::to_string(bndId2) + "/version0.0/META-INF";
+    ASSERT_EQ(0, lstat(manifestDir.c_str(), &st));
+    EXPECT_TRUE(S_ISDIR(st.st_mode));
+
+    //uninstalling removes the links, not the extraction cache entry
+    EXPECT_TRUE(celix_bundleContext_uninstallBundle(ctx1, bndId));
+    EXPECT_EQ(0, access(manifest.c_str(), F_OK));
+
+    //the uninstalled bundle released the extraction cache entry, so the entry can be used again
+    long bndId3 = celix_bundleContext_installBundle(ctx1, TEST_BND_WITH_EXCEPTION_LOC, false);
+    ASSERT_TRUE(bndId3 >= 0);
+    manifestDir = std::string{".cacheExtractionTestFramework1/bundle"} + std::to_string(bndId3) + "/version0.0/META-INF";
+    ASSERT_EQ(0, lstat(manifestDir.c_str(), &st));
+    EXPECT_TRUE(S_ISLNK(st.st_mode));
+    EXPECT_TRUE(celix_bundleContext_uninstallBundle(ctx1, bndId3));
+
+    //an extracted bundle dir can be installed directly
+    long dirBndId = celix_bundleContext_installBundle(ctx1, cacheEntry.c_str(), false);
+    ASSERT_TRUE(dirBndId >= 0);
+    EXPECT_FALSE(celix_bundleContext_startBundle(ctx1, dirBndId)); //activator start fails
+    bool called = celix_framework_useBundle(fw1, false, dirBndId, nullptr, [](void *, const celix_bundle_t *bnd) {
+        EXPECT_STREQ("bundle_with_exception", celix_bundle_getSymbolicName(bnd));
+        EXPECT_EQ(OSGI_FRAMEWORK_BUNDLE_RESOLVED, celix_bundle_getState(bnd)); //libraries are loaded
+    });
+    EXPECT_TRUE(called);
+    EXPECT_TRUE(celix_bundleContext_uninstallBundle(ctx1, dirBndId));
+    EXPECT_EQ(0, access(manifest.c_str(), F_OK));
+
+    celix_frameworkFactory_destroyFramework(fw2);
+    celix_frameworkFactory_destroyFramework(fw1);
+}
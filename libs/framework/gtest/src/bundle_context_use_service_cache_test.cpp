@@ -0,0 +1,185 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+
+class UseServiceCacheTests : public ::testing::Test {
+public:
+    celix_framework_t* fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    int dummySvc = 42;
+
+    UseServiceCacheTests() {
+        fw = createFramework(nullptr);
+        ctx = framework_getContext(fw);
+    }
+
+    ~UseServiceCacheTests() override {
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    static celix_framework_t* createFramework(const char *cacheSize) {
+        auto *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        if (cacheSize != nullptr) {
+            properties_set(properties, "org.osgi.framework.storage", ".cacheUseServiceCacheTestsWithConfiguredSize");
+            properties_set(properties, CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE, cacheSize);
+        } else {
+            properties_set(properties, "org.osgi.framework.storage", ".cacheUseServiceCacheTests");
+        }
+        return celix_frameworkFactory_createFramework(properties);
+    }
+
+    static long useServiceId(celix_bundle_context_t *context, const char *serviceName) {
+        long svcId = -1L;
+        celix_service_use_options_t opts{};
+        opts.filter.serviceName = serviceName;
+        opts.callbackHandle = &svcId;
+        opts.useWithProperties = [](void *handle, void *, const celix_properties_t *props) {
+            auto *id = static_cast<long*>(handle);
+            *id = celix_properties_getAsLong(props, OSGI_FRAMEWORK_SERVICE_ID, -1L);
+        };
+        celix_bundleContext_useServiceWithOptions(context, &opts);
+        return svcId;
+    }
+
+    /**
+     * Returns the average duration in ns of a celix_bundleContext_useService call.
+     */
+    static double measureUseService(celix_bundle_context_t *context) {
+        const int nrOfCalls = 10000;
+        int count = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nrOfCalls; ++i) {
+            celix_bundleContext_useService(context, "target", &count, [](void *handle, void *) {
+                auto *c = static_cast<int*>(handle);
+                *c += 1;
+            });
+        }
+        auto end = std::chrono::steady_clock::now();
+        EXPECT_EQ(nrOfCalls, count);
+        return std::chrono::duration<double, std::nano>(end - start).count() / nrOfCalls;
+    }
+
+    UseServiceCacheTests(UseServiceCacheTests&&) = delete;
+    UseServiceCacheTests(const UseServiceCacheTests&) = delete;
+    UseServiceCacheTests& operator=(UseServiceCacheTests&&) = delete;
+    UseServiceCacheTests& operator=(const UseServiceCacheTests&) = delete;
+};
+
+TEST_F(UseServiceCacheTests, CachedTrackerFollowsServiceEvents) {
+    EXPECT_EQ(-1L, useServiceId(ctx, "target")); //creates cached tracker without services
+
+    long svcId1 = celix_bundleContext_registerService(ctx, &dummySvc, "target", nullptr);
+    EXPECT_EQ(svcId1, useServiceId(ctx, "target"));
+
+    auto *props = celix_properties_create();
+    celix_properties_setLong(props, OSGI_FRAMEWORK_SERVICE_RANKING, 100);
+    long svcId2 = celix_bundleContext_registerService(ctx, &dummySvc, "target", props);
+    EXPECT_EQ(svcId2, useServiceId(ctx, "target")); //higher ranking
+    EXPECT_EQ(2, celix_bundleContext_useServices(ctx, "target", nullptr, [](void *, void *) {}));
+
+    celix_bundleContext_unregisterService(ctx, svcId2);
+    EXPECT_EQ(svcId1, useServiceId(ctx, "target"));
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    EXPECT_EQ(-1L, useServiceId(ctx, "target"));
+    EXPECT_EQ(0, celix_bundleContext_useServices(ctx, "target", nullptr, [](void *, void *) {}));
+}
+
+TEST_F(UseServiceCacheTests, MoreLookupsThanCacheSize) {
+    const int nrOfServices = (int)CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE_DEFAULT * 3;
+    std::vector<long> svcIds{};
+    for (int i = 0; i < nrOfServices; ++i) {
+        std::string name = "service" + std::to_string(i);
+        svcIds.push_back(celix_bundleContext_registerService(ctx, &dummySvc, name.c_str(), nullptr));
+    }
+    for (int round = 0; round < 2; ++round) {
+        for (int i = 0; i < nrOfServices; ++i) {
+            std::string name = "service" + std::to_string(i);
+            EXPECT_EQ(svcIds[i], useServiceId(ctx, name.c_str()));
+            EXPECT_EQ(svcIds[i], celix_bundleContext_findService(ctx, name.c_str()));
+        }
+    }
+    for (auto svcId : svcIds) {
+        celix_bundleContext_unregisterService(ctx, svcId);
+    }
+    EXPECT_EQ(-1L, useServiceId(ctx, "service0"));
+}
+
+TEST_F(UseServiceCacheTests, UseServiceFromServiceEvent) {
+    //fill the cache, so that a use service call from a service event callback cannot add an entry without evicting one
+    for (int i = 0; i < (int)CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE_DEFAULT; ++i) {
+        std::string name = "service" + std::to_string(i);
+        useServiceId(ctx, name.c_str());
+    }
+    long targetSvcId = celix_bundleContext_registerService(ctx, &dummySvc, "target", nullptr);
+
+    struct callback_data {
+        celix_bundle_context_t *ctx;
+        long targetSvcId;
+        int count;
+    } data{ctx, targetSvcId, 0};
+
+    celix_service_tracking_options_t opts{};
+    opts.filter.serviceName = "trigger";
+    opts.callbackHandle = &data;
+    opts.add = [](void *handle, void *) {
+        auto *d = static_cast<callback_data*>(handle);
+        EXPECT_EQ(d->targetSvcId, useServiceId(d->ctx, "target"));
+        EXPECT_EQ(-1L, useServiceId(d->ctx, "service0"));
+        d->count += 1;
+    };
+    long trkId = celix_bundleContext_trackServicesWithOptions(ctx, &opts);
+    long triggerSvcId = celix_bundleContext_registerService(ctx, &dummySvc, "trigger", nullptr);
+    EXPECT_EQ(1, data.count);
+
+    celix_bundleContext_unregisterService(ctx, triggerSvcId);
+    celix_bundleContext_stopTracker(ctx, trkId);
+    celix_bundleContext_unregisterService(ctx, targetSvcId);
+}
+
+TEST_F(UseServiceCacheTests, CachedVersusUncachedUseServiceBenchmark) {
+    celix_framework_t *uncachedFw = createFramework("0");
+    celix_bundle_context_t *uncachedCtx = framework_getContext(uncachedFw);
+
+    long svcId = celix_bundleContext_registerService(ctx, &dummySvc, "target", nullptr);
+    long uncachedSvcId = celix_bundleContext_registerService(uncachedCtx, &dummySvc, "target", nullptr);
+
+    double cached = measureUseService(ctx);
+    double uncached = measureUseService(uncachedCtx);
+
+    std::cout << "Avg useService with use service cache:    " << cached << " ns" << std::endl;
+    std::cout << "Avg useService without use service cache: " << uncached << " ns" << std::endl;
+
+    //no tracker creation, listener registration and registry lookup for a cached use service call.
+    EXPECT_LT(cached, uncached);
+
+    celix_bundleContext_unregisterService(uncachedCtx, uncachedSvcId);
+    celix_bundleContext_unregisterService(ctx, svcId);
+    celix_frameworkFactory_destroyFramework(uncachedFw);
+}
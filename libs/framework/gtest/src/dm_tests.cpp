@@ -19,6 +19,11 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
 #include "celix_api.h"
 
 class DepenencyManagerTests : public ::testing::Test {
@@ -75,3 +80,379 @@ TEST_F(DepenencyManagerTests, TestCheckActive) {
     celix_dependencyManager_add(mng, cmp);
     ASSERT_FALSE(celix_dependencyManager_areComponentsActive(mng));
 }
+
+TEST_F(DepenencyManagerTests, CoalesceServiceEventsWithoutExecutorPool) {
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    struct cmp_data {
+        int nrOfSetCalls{0};
+        int nrOfAddCalls{0};
+        int nrOfRemoveCalls{0};
+    } data{};
+
+    auto *cmp = celix_dmComponent_create(ctx, "cmp");
+    celix_dmComponent_setImplementation(cmp, &data);
+    celix_dmComponent_setServiceEventCoalescing(cmp, true, 500);
+    auto *dep = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep, "test_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep, true);
+    celix_dm_service_dependency_callback_options_t opts{};
+    opts.set = [](void *handle, void *) -> int {
+        static_cast<cmp_data*>(handle)->nrOfSetCalls += 1;
+        return CELIX_SUCCESS;
+    };
+    opts.add = [](void *handle, void *) -> int {
+        static_cast<cmp_data*>(handle)->nrOfAddCalls += 1;
+        return CELIX_SUCCESS;
+    };
+    opts.remove = [](void *handle, void *) -> int {
+        static_cast<cmp_data*>(handle)->nrOfRemoveCalls += 1;
+        return CELIX_SUCCESS;
+    };
+    celix_dmServiceDependency_setCallbacksWithOptions(dep, &opts);
+    celix_dmComponent_addServiceDependency(cmp, dep);
+    celix_dependencyManager_add(mng, cmp);
+
+    //without an executor pool every batch is handled directly by the registering thread, without the window delay
+    int svc = 42;
+    const int nrOfServices = 10;
+    std::vector<long> svcIds{};
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < nrOfServices; ++i) {
+        svcIds.push_back(celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr));
+        EXPECT_EQ(i + 1, data.nrOfAddCalls);
+        EXPECT_TRUE(celix_dependencyManager_areComponentsActive(mng));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds{500});
+    EXPECT_GE(data.nrOfSetCalls, 1);
+
+    for (long id : svcIds) {
+        celix_bundleContext_unregisterService(ctx, id);
+    }
+    EXPECT_EQ(nrOfServices, data.nrOfRemoveCalls);
+    EXPECT_FALSE(celix_dependencyManager_areComponentsActive(mng));
+}
+
+class DependencyManagerExecutorPoolTests : public ::testing::Test {
+public:
+    celix_framework_t* fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+
+    DependencyManagerExecutorPoolTests() {
+        auto *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheDependencyManagerExecutorPoolTests");
+        properties_set(properties, CELIX_DM_EXECUTOR_NR_OF_THREADS, "4");
+
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+    }
+
+    ~DependencyManagerExecutorPoolTests() override {
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    bool waitForComponentsActive(celix_dependency_manager_t *mng) {
+        auto start = std::chrono::steady_clock::now();
+        while (!celix_dependencyManager_areComponentsActive(mng)) {
+            if (std::chrono::steady_clock::now() - start > std::chrono::seconds{5}) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        return true;
+    }
+
+    DependencyManagerExecutorPoolTests(DependencyManagerExecutorPoolTests&&) = delete;
+    DependencyManagerExecutorPoolTests(const DependencyManagerExecutorPoolTests&) = delete;
+    DependencyManagerExecutorPoolTests& operator=(DependencyManagerExecutorPoolTests&&) = delete;
+    DependencyManagerExecutorPoolTests& operator=(const DependencyManagerExecutorPoolTests&) = delete;
+};
+
+struct dm_executor_test_cmp {
+    std::atomic<int> *nrOfStarting;
+    bool startedConcurrently;
+    std::atomic<bool> started;
+};
+
+TEST_F(DependencyManagerExecutorPoolTests, StartComponentsInParallel) {
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    std::atomic<int> nrOfStarting{0};
+    dm_executor_test_cmp impl1{&nrOfStarting, false, {false}};
+    dm_executor_test_cmp impl2{&nrOfStarting, false, {false}};
+
+    auto start = [](void *handle) -> int {
+        auto *impl = static_cast<dm_executor_test_cmp*>(handle);
+        *impl->nrOfStarting += 1;
+        //wait till the other component is also starting, only possible if the start callbacks run in parallel
+        auto begin = std::chrono::steady_clock::now();
+        while (impl->nrOfStarting->load() < 2 && std::chrono::steady_clock::now() - begin < std::chrono::seconds{2}) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        impl->startedConcurrently = impl->nrOfStarting->load() == 2;
+        impl->started = true;
+        return CELIX_SUCCESS;
+    };
+
+    //note adding a component is synchronous, so the components depend on a service which is registered afterwards.
+    //The added service events are handled on the executor pool.
+    auto *cmp1 = celix_dmComponent_create(ctx, "cmp1");
+    celix_dmComponent_setImplementation(cmp1, &impl1);
+    celix_dmComponent_setCallbacks(cmp1, nullptr, start, nullptr, nullptr);
+    auto *dep1 = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep1, "test_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep1, true);
+    celix_dmComponent_addServiceDependency(cmp1, dep1);
+    auto *cmp2 = celix_dmComponent_create(ctx, "cmp2");
+    celix_dmComponent_setImplementation(cmp2, &impl2);
+    celix_dmComponent_setCallbacks(cmp2, nullptr, start, nullptr, nullptr);
+    auto *dep2 = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep2, "test_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep2, true);
+    celix_dmComponent_addServiceDependency(cmp2, dep2);
+
+    celix_dependencyManager_add(mng, cmp1);
+    celix_dependencyManager_add(mng, cmp2);
+    EXPECT_FALSE(celix_dependencyManager_areComponentsActive(mng));
+    int svc = 42;
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+    ASSERT_TRUE(waitForComponentsActive(mng));
+    auto begin = std::chrono::steady_clock::now();
+    while (!(impl1.started && impl2.started) && std::chrono::steady_clock::now() - begin < std::chrono::seconds{5}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_TRUE(impl1.startedConcurrently);
+    EXPECT_TRUE(impl2.startedConcurrently);
+
+    //note the start task is done shortly after the start callback returned
+    celix_dm_component_info_t *info = nullptr;
+    begin = std::chrono::steady_clock::now();
+    do {
+        celix_dmComponent_destroyComponentInfo(info);
+        celix_dmComponent_getComponentInfo(cmp1, &info);
+        ASSERT_NE(nullptr, info);
+    } while (info->nrOfTasks == 0 && std::chrono::steady_clock::now() - begin < std::chrono::seconds{5});
+    EXPECT_GE(info->nrOfTransitions, 3); //inactive -> waiting for required -> instantiated -> tracking optional
+    EXPECT_GT(info->maxTransitionTimeInMs, 0.0);
+    EXPECT_GE(info->nrOfTasks, 1);
+    celix_dmComponent_destroyComponentInfo(info);
+
+    celix_dependencyManager_removeAllComponents(mng);
+    EXPECT_EQ(0, celix_dependencyManager_nrOfComponents(mng));
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST_F(DependencyManagerExecutorPoolTests, RemovedServiceIsHandledBeforeUnregisterReturns) {
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    struct cmp_data {
+        std::atomic<void*> svc{nullptr};
+    } data{};
+
+    auto *cmp = celix_dmComponent_create(ctx, "cmp");
+    celix_dmComponent_setImplementation(cmp, &data);
+    auto *dep = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep, "test_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep, true);
+    celix_dm_service_dependency_callback_options_t opts{};
+    opts.set = [](void *handle, void *svc) -> int {
+        static_cast<cmp_data*>(handle)->svc = svc;
+        return CELIX_SUCCESS;
+    };
+    celix_dmServiceDependency_setCallbacksWithOptions(dep, &opts);
+    celix_dmComponent_addServiceDependency(cmp, dep);
+    celix_dependencyManager_add(mng, cmp);
+
+    int svc = 42;
+    for (int i = 0; i < 10; ++i) {
+        long svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+        ASSERT_TRUE(waitForComponentsActive(mng));
+        EXPECT_EQ(&svc, data.svc.load());
+
+        celix_bundleContext_unregisterService(ctx, svcId);
+        EXPECT_EQ(nullptr, data.svc.load());
+        EXPECT_FALSE(celix_dependencyManager_areComponentsActive(mng));
+    }
+}
+
+TEST_F(DependencyManagerExecutorPoolTests, RemovedServiceIsHandledBeforeUnregisterReturnsOnPoolThread) {
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    struct cmp_data {
+        celix_bundle_context_t *ctx{nullptr};
+        long svcId{-1L};
+        std::atomic<void*> svc{nullptr};
+        std::atomic<bool> svcRemovedBeforeReturn{false};
+        std::atomic<bool> started{false};
+    } data{};
+    data.ctx = ctx;
+
+    //cmp2 depends on test_service
+    auto *cmp2 = celix_dmComponent_create(ctx, "cmp2");
+    celix_dmComponent_setImplementation(cmp2, &data);
+    auto *dep2 = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep2, "test_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep2, true);
+    celix_dm_service_dependency_callback_options_t opts{};
+    opts.set = [](void *handle, void *svc) -> int {
+        static_cast<cmp_data*>(handle)->svc = svc;
+        return CELIX_SUCCESS;
+    };
+    celix_dmServiceDependency_setCallbacksWithOptions(dep2, &opts);
+    celix_dmComponent_addServiceDependency(cmp2, dep2);
+    celix_dependencyManager_add(mng, cmp2);
+
+    int svc = 42;
+    data.svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+    ASSERT_TRUE(waitForComponentsActive(mng));
+    EXPECT_EQ(&svc, data.svc.load());
+
+    //cmp1 is started on a pool thread when trigger_service is added and unregisters test_service in its start callback
+    auto *cmp1 = celix_dmComponent_create(ctx, "cmp1");
+    celix_dmComponent_setImplementation(cmp1, &data);
+    celix_dmComponent_setCallbacks(cmp1, nullptr, [](void *handle) -> int {
+        auto *d = static_cast<cmp_data*>(handle);
+        celix_bundleContext_unregisterService(d->ctx, d->svcId);
+        d->svcRemovedBeforeReturn = d->svc.load() == nullptr;
+        d->started = true;
+        return CELIX_SUCCESS;
+    }, nullptr, nullptr);
+    auto *dep1 = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep1, "trigger_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep1, true);
+    celix_dmComponent_addServiceDependency(cmp1, dep1);
+    celix_dependencyManager_add(mng, cmp1);
+
+    long triggerSvcId = celix_bundleContext_registerService(ctx, &svc, "trigger_service", nullptr);
+    auto begin = std::chrono::steady_clock::now();
+    while (!data.started && std::chrono::steady_clock::now() - begin < std::chrono::seconds{5}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_TRUE(data.started);
+    EXPECT_TRUE(data.svcRemovedBeforeReturn);
+
+    celix_dependencyManager_removeAllComponents(mng);
+    celix_bundleContext_unregisterService(ctx, triggerSvcId);
+}
+
+TEST_F(DependencyManagerExecutorPoolTests, ComponentsUnregisteringEachOthersDependenciesDoNotDeadlock) {
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    struct cmp_data {
+        celix_bundle_context_t *ctx{nullptr};
+        std::atomic<int> *nrOfStarting{nullptr};
+        long otherSvcId{-1L}; //service the other component depends on
+        std::atomic<bool> started{false};
+    };
+    std::atomic<int> nrOfStarting{0};
+    cmp_data dataA{};
+    cmp_data dataB{};
+    dataA.ctx = dataB.ctx = ctx;
+    dataA.nrOfStarting = dataB.nrOfStarting = &nrOfStarting;
+
+    //both start callbacks run on a pool thread and unregister the service the other (starting) component depends on
+    auto start = [](void *handle) -> int {
+        auto *d = static_cast<cmp_data*>(handle);
+        *d->nrOfStarting += 1;
+        auto begin = std::chrono::steady_clock::now();
+        while (d->nrOfStarting->load() < 2 && std::chrono::steady_clock::now() - begin < std::chrono::seconds{2}) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        celix_bundleContext_unregisterService(d->ctx, d->otherSvcId);
+        d->started = true;
+        return CELIX_SUCCESS;
+    };
+
+    auto createCmp = [&](const char *name, cmp_data *data, const char *svcName) {
+        auto *cmp = celix_dmComponent_create(ctx, name);
+        celix_dmComponent_setImplementation(cmp, data);
+        celix_dmComponent_setCallbacks(cmp, nullptr, start, nullptr, nullptr);
+        for (const char *dependency : {svcName, "trigger_service"}) {
+            auto *dep = celix_dmServiceDependency_create();
+            celix_dmServiceDependency_setService(dep, dependency, nullptr, nullptr);
+            celix_dmServiceDependency_setRequired(dep, true);
+            celix_dmComponent_addServiceDependency(cmp, dep);
+        }
+        celix_dependencyManager_add(mng, cmp);
+    };
+    createCmp("cmpA", &dataA, "service_a");
+    createCmp("cmpB", &dataB, "service_b");
+
+    int svc = 42;
+    dataB.otherSvcId = celix_bundleContext_registerService(ctx, &svc, "service_a", nullptr);
+    dataA.otherSvcId = celix_bundleContext_registerService(ctx, &svc, "service_b", nullptr);
+    long triggerSvcId = celix_bundleContext_registerService(ctx, &svc, "trigger_service", nullptr);
+
+    auto begin = std::chrono::steady_clock::now();
+    while (!(dataA.started && dataB.started) && std::chrono::steady_clock::now() - begin < std::chrono::seconds{5}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    ASSERT_TRUE(dataA.started);
+    ASSERT_TRUE(dataB.started);
+
+    //the removed events are handled by the pool threads after the start callbacks returned
+    begin = std::chrono::steady_clock::now();
+    while (celix_dependencyManager_areComponentsActive(mng) && std::chrono::steady_clock::now() - begin < std::chrono::seconds{5}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_FALSE(celix_dependencyManager_areComponentsActive(mng));
+
+    celix_dependencyManager_removeAllComponents(mng);
+    celix_bundleContext_unregisterService(ctx, triggerSvcId);
+}
+
+TEST_F(DependencyManagerExecutorPoolTests, CoalesceServiceEvents) {
+    auto *mng = celix_bundleContext_getDependencyManager(ctx);
+    struct cmp_data {
+        std::atomic<int> nrOfSetCalls{0};
+        std::atomic<int> nrOfAddCalls{0};
+        std::atomic<int> nrOfRemoveCalls{0};
+    } data{};
+
+    auto *cmp = celix_dmComponent_create(ctx, "cmp");
+    celix_dmComponent_setImplementation(cmp, &data);
+    celix_dmComponent_setServiceEventCoalescing(cmp, true, 500);
+    auto *dep = celix_dmServiceDependency_create();
+    celix_dmServiceDependency_setService(dep, "test_service", nullptr, nullptr);
+    celix_dmServiceDependency_setRequired(dep, true);
+    celix_dmServiceDependency_setStrategy(dep, DM_SERVICE_DEPENDENCY_STRATEGY_LOCKING);
+    celix_dm_service_dependency_callback_options_t opts{};
+    opts.set = [](void *handle, void *) -> int {
+        static_cast<cmp_data*>(handle)->nrOfSetCalls += 1;
+        return CELIX_SUCCESS;
+    };
+    opts.add = [](void *handle, void *) -> int {
+        static_cast<cmp_data*>(handle)->nrOfAddCalls += 1;
+        return CELIX_SUCCESS;
+    };
+    opts.remove = [](void *handle, void *) -> int {
+        static_cast<cmp_data*>(handle)->nrOfRemoveCalls += 1;
+        return CELIX_SUCCESS;
+    };
+    celix_dmServiceDependency_setCallbacksWithOptions(dep, &opts);
+    celix_dmComponent_addServiceDependency(cmp, dep);
+    celix_dependencyManager_add(mng, cmp);
+
+    //an added and removed service in the same batch cancel each other
+    int svc = 42;
+    long svcId = celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr);
+    celix_bundleContext_unregisterService(ctx, svcId);
+
+    const int nrOfServices = 50;
+    std::vector<long> svcIds{};
+    for (int i = 0; i < nrOfServices; ++i) {
+        svcIds.push_back(celix_bundleContext_registerService(ctx, &svc, "test_service", nullptr));
+    }
+    ASSERT_TRUE(waitForComponentsActive(mng));
+    auto begin = std::chrono::steady_clock::now();
+    while (data.nrOfAddCalls.load() < nrOfServices && std::chrono::steady_clock::now() - begin < std::chrono::seconds{5}) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_EQ(nrOfServices, data.nrOfAddCalls.load());
+    EXPECT_EQ(0, data.nrOfRemoveCalls.load());
+    //note without coalescing set is called for every added service
+    EXPECT_LT(data.nrOfSetCalls.load(), nrOfServices / 2);
+
+    for (long id : svcIds) {
+        celix_bundleContext_unregisterService(ctx, id);
+    }
+    EXPECT_EQ(nrOfServices, data.nrOfRemoveCalls.load());
+    EXPECT_FALSE(celix_dependencyManager_areComponentsActive(mng));
+}
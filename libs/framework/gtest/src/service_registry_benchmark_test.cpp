@@ -0,0 +1,165 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+
+class ServiceRegistryBenchmarkTests : public ::testing::Test {
+public:
+    celix_framework_t* fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    std::vector<long> svcIds{};
+    int dummySvc = 42;
+
+    ServiceRegistryBenchmarkTests() {
+        auto *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheServiceRegistryBenchmarkTests");
+
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+    }
+
+    ~ServiceRegistryBenchmarkTests() override {
+        for (auto svcId : svcIds) {
+            celix_bundleContext_unregisterService(ctx, svcId);
+        }
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    void growRegistryTo(size_t nrOfServices) {
+        while (svcIds.size() < nrOfServices) {
+            std::string name = "benchmark_service_" + std::to_string(svcIds.size());
+            svcIds.push_back(celix_bundleContext_registerService(ctx, &dummySvc, name.c_str(), nullptr));
+        }
+    }
+
+    /**
+     * Returns the average duration in ns of a findService with a service name and a service reference lookup with
+     * only a filter on the service id.
+     */
+    double measureLookup(long expectedSvcId) {
+        const int nrOfLookups = 1000;
+        std::string svcIdFilter = std::string{"(service.id="} + std::to_string(expectedSvcId) + ")";
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nrOfLookups; ++i) {
+            long svcId = celix_bundleContext_findService(ctx, "target");
+            EXPECT_EQ(expectedSvcId, svcId);
+
+            array_list_pt refs = nullptr;
+            bundleContext_getServiceReferences(ctx, nullptr, svcIdFilter.c_str(), &refs);
+            EXPECT_EQ(1, celix_arrayList_size(refs));
+            for (int k = 0; k < celix_arrayList_size(refs); ++k) {
+                bundleContext_ungetServiceReference(ctx, (service_reference_pt)celix_arrayList_get(refs, k));
+            }
+            celix_arrayList_destroy(refs);
+        }
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / (nrOfLookups * 2);
+    }
+
+    ServiceRegistryBenchmarkTests(ServiceRegistryBenchmarkTests&&) = delete;
+    ServiceRegistryBenchmarkTests(const ServiceRegistryBenchmarkTests&) = delete;
+    ServiceRegistryBenchmarkTests& operator=(ServiceRegistryBenchmarkTests&&) = delete;
+    ServiceRegistryBenchmarkTests& operator=(const ServiceRegistryBenchmarkTests&) = delete;
+};
+
+TEST_F(ServiceRegistryBenchmarkTests, FindServiceWithGrowingRegistry) {
+    long targetSvcId = celix_bundleContext_registerService(ctx, &dummySvc, "target", nullptr);
+    ASSERT_GE(targetSvcId, 0);
+
+    growRegistryTo(100);
+    double small = measureLookup(targetSvcId);
+
+    growRegistryTo(5000);
+    double large = measureLookup(targetSvcId);
+
+    //with indexed lookups the lookup cost should not grow (linear) with the registry size (50x the services).
+    //note only printed, wall clock timings are not reliable enough for an assertion on a loaded (CI) machine.
+    std::cout << "Avg lookup with 100 registered services:  " << small << " ns" << std::endl;
+    std::cout << "Avg lookup with 5000 registered services: " << large << " ns" << std::endl;
+
+    //the indexed lookups should still find exactly the matching services and the highest ranking service
+    auto* found = celix_bundleContext_findServices(ctx, "benchmark_service_4999");
+    ASSERT_EQ(1, celix_arrayList_size(found));
+    EXPECT_EQ(svcIds[4999], celix_arrayList_getLong(found, 0));
+    celix_arrayList_destroy(found);
+
+    celix_service_registration_options_t opts{};
+    opts.svc = &dummySvc;
+    opts.serviceName = "target";
+    opts.properties = celix_properties_create();
+    celix_properties_setLong(opts.properties, OSGI_FRAMEWORK_SERVICE_RANKING, 10);
+    long highRankingSvcId = celix_bundleContext_registerServiceWithOptions(ctx, &opts);
+    ASSERT_GE(highRankingSvcId, 0);
+    EXPECT_EQ(highRankingSvcId, celix_bundleContext_findService(ctx, "target"));
+    found = celix_bundleContext_findServices(ctx, "target");
+    ASSERT_EQ(2, celix_arrayList_size(found));
+    long foundIds[2] = {celix_arrayList_getLong(found, 0), celix_arrayList_getLong(found, 1)};
+    EXPECT_TRUE(foundIds[0] == targetSvcId || foundIds[1] == targetSvcId);
+    EXPECT_TRUE(foundIds[0] == highRankingSvcId || foundIds[1] == highRankingSvcId);
+    celix_arrayList_destroy(found);
+    celix_bundleContext_unregisterService(ctx, highRankingSvcId);
+
+    celix_bundleContext_unregisterService(ctx, targetSvcId);
+    EXPECT_LT(celix_bundleContext_findService(ctx, "target"), 0);
+}
+
+TEST_F(ServiceRegistryBenchmarkTests, IndexedLookupsMatchFilterSemantics) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "service.version", "1.2.3");
+    long svcId1 = celix_bundleContext_registerService(ctx, &dummySvc, "target", props);
+    long svcId2 = celix_bundleContext_registerService(ctx, &dummySvc, "target", nullptr);
+    growRegistryTo(10);
+
+    celix_service_filter_options_t opts{};
+    opts.serviceName = "target";
+    opts.filter = "(service.version=1.2.3)";
+    celix_array_list_t *ids = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    ASSERT_EQ(1, celix_arrayList_size(ids));
+    EXPECT_EQ(svcId1, celix_arrayList_getLong(ids, 0));
+    celix_arrayList_destroy(ids);
+
+    opts.filter = "(service.version=1.2.4)";
+    ids = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    EXPECT_EQ(0, celix_arrayList_size(ids));
+    celix_arrayList_destroy(ids);
+
+    opts.filter = "(|(service.version=1.2.3)(service.version=1.2.4))";
+    ids = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    EXPECT_EQ(1, celix_arrayList_size(ids));
+    celix_arrayList_destroy(ids);
+
+    opts.filter = "(!(service.version=1.2.3))";
+    ids = celix_bundleContext_findServicesWithOptions(ctx, &opts);
+    ASSERT_EQ(1, celix_arrayList_size(ids));
+    EXPECT_EQ(svcId2, celix_arrayList_getLong(ids, 0));
+    celix_arrayList_destroy(ids);
+
+    celix_bundleContext_unregisterService(ctx, svcId1);
+    celix_bundleContext_unregisterService(ctx, svcId2);
+}
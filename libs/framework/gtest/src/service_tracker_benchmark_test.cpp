@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "celix_api.h"
+#include "celix_framework_factory.h"
+#include "service_tracker.h"
+
+class ServiceTrackerBenchmarkTests : public ::testing::Test {
+public:
+    celix_framework_t* fw = nullptr;
+    celix_bundle_context_t *ctx = nullptr;
+    int dummySvc = 42;
+
+    ServiceTrackerBenchmarkTests() {
+        auto *properties = properties_create();
+        properties_set(properties, "LOGHELPER_ENABLE_STDOUT_FALLBACK", "true");
+        properties_set(properties, "org.osgi.framework.storage.clean", "onFirstInit");
+        properties_set(properties, "org.osgi.framework.storage", ".cacheServiceTrackerBenchmarkTests");
+
+        fw = celix_frameworkFactory_createFramework(properties);
+        ctx = framework_getContext(fw);
+    }
+
+    ~ServiceTrackerBenchmarkTests() override {
+        celix_frameworkFactory_destroyFramework(fw);
+    }
+
+    /**
+     * Returns the nr of celix_serviceTracker_useHighestRankingService calls per second for the provided nr of
+     * threads. Every thread does the same nr of calls.
+     */
+    double measureUseHighestRanking(celix_service_tracker_t *tracker, int nrOfThreads) {
+        const int nrOfCallsPerThread = 200000;
+        std::atomic<long> nrOfCalled{0};
+        std::vector<std::thread> threads{};
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < nrOfThreads; ++t) {
+            threads.emplace_back([&]{
+                long called = 0;
+                for (int i = 0; i < nrOfCallsPerThread; ++i) {
+                    called += celix_serviceTracker_useHighestRankingService(tracker, "benchmark", 0, nullptr, [](void *, void *svc) {
+                        EXPECT_EQ(42, *static_cast<int*>(svc));
+                    }, nullptr, nullptr) ? 1 : 0;
+                }
+                nrOfCalled += called;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto end = std::chrono::steady_clock::now();
+        EXPECT_EQ((long)nrOfThreads * nrOfCallsPerThread, nrOfCalled.load());
+        double seconds = std::chrono::duration<double>(end - start).count();
+        return nrOfThreads * nrOfCallsPerThread / seconds;
+    }
+
+    ServiceTrackerBenchmarkTests(ServiceTrackerBenchmarkTests&&) = delete;
+    ServiceTrackerBenchmarkTests(const ServiceTrackerBenchmarkTests&) = delete;
+    ServiceTrackerBenchmarkTests& operator=(ServiceTrackerBenchmarkTests&&) = delete;
+    ServiceTrackerBenchmarkTests& operator=(const ServiceTrackerBenchmarkTests&) = delete;
+};
+
+TEST_F(ServiceTrackerBenchmarkTests, UseHighestRankingServiceWithMultipleThreads) {
+    long svcId = celix_bundleContext_registerService(ctx, &dummySvc, "benchmark", nullptr);
+    ASSERT_GE(svcId, 0);
+    celix_service_tracker_t *tracker = celix_serviceTracker_create(ctx, "benchmark", nullptr, nullptr);
+    ASSERT_EQ(1, serviceTracker_nrOfTrackedServices(tracker));
+
+    int maxThreads = (int)std::max(4u, std::thread::hardware_concurrency());
+    double single = measureUseHighestRanking(tracker, 1);
+    std::cout << "Use highest ranking service with 1 thread(s): " << single << " calls/s" << std::endl;
+    for (int nrOfThreads = 2; nrOfThreads <= maxThreads; nrOfThreads *= 2) {
+        double multi = measureUseHighestRanking(tracker, nrOfThreads);
+        //note readers do not share a lock, so on a multi core machine the throughput should scale with the nr of cores
+        std::cout << "Use highest ranking service with " << nrOfThreads << " thread(s): " << multi << " calls/s (x"
+                  << multi / single << ")" << std::endl;
+    }
+
+    celix_serviceTracker_destroy(tracker);
+    celix_bundleContext_unregisterService(ctx, svcId);
+}
+
+TEST_F(ServiceTrackerBenchmarkTests, UseServicesWhileTrackedServicesChange) {
+    celix_service_tracker_t *tracker = celix_serviceTracker_create(ctx, "benchmark", nullptr, nullptr);
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers{};
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&]{
+            while (!stop) {
+                celix_serviceTracker_useServices(tracker, "benchmark", nullptr, [](void *, void *svc) {
+                    EXPECT_EQ(42, *static_cast<int*>(svc));
+                }, nullptr, nullptr);
+                celix_serviceTracker_useHighestRankingService(tracker, "benchmark", 0, nullptr, [](void *, void *svc) {
+                    EXPECT_EQ(42, *static_cast<int*>(svc));
+                }, nullptr, nullptr);
+            }
+        });
+    }
+
+    //register and unregister services while the readers use the tracked services
+    for (int i = 0; i < 200; ++i) {
+        long svcId1 = celix_bundleContext_registerService(ctx, &dummySvc, "benchmark", nullptr);
+        long svcId2 = celix_bundleContext_registerService(ctx, &dummySvc, "benchmark", nullptr);
+        EXPECT_EQ(2, serviceTracker_nrOfTrackedServices(tracker));
+        celix_bundleContext_unregisterService(ctx, svcId1);
+        celix_bundleContext_unregisterService(ctx, svcId2);
+        EXPECT_EQ(0, serviceTracker_nrOfTrackedServices(tracker));
+    }
+
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    celix_serviceTracker_destroy(tracker);
+}
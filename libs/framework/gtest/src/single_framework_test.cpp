@@ -19,6 +19,10 @@
 
 #include <gtest/gtest.h>
 
+#include <iostream>
+#include <thread>
+#include <vector>
+
 extern "C" {
 
 #include <stdio.h>
@@ -29,6 +33,8 @@ extern "C" {
 
 #include "celix_launcher.h"
 #include "celix_framework_factory.h"
+#include "celix_framework.h"
+#include "celix_bundle_context.h"
 
 
     static celix_framework_t *framework = nullptr;
@@ -173,3 +179,39 @@ TEST_F(FrameworkFactory, restartFramework) {
     framework_destroy(fw);
 }
 
+
+TEST_F(FrameworkFactory, eventQueueStats) {
+    framework_t* fw = celix_frameworkFactory_createFramework(nullptr);
+    ASSERT_TRUE(fw != nullptr);
+    celix_bundle_context_t *ctx = celix_framework_getFrameworkContext(fw);
+
+    //bundle churn from multiple threads, every install/start/stop/uninstall fires events
+    std::vector<std::thread> threads{};
+    for (const char *loc : {SIMPLE_TEST_BUNDLE1_LOCATION, SIMPLE_TEST_BUNDLE2_LOCATION, SIMPLE_TEST_BUNDLE3_LOCATION}) {
+        threads.emplace_back([ctx, loc] {
+            for (int i = 0; i < 10; ++i) {
+                long bndId = celix_bundleContext_installBundle(ctx, loc, true);
+                EXPECT_GE(bndId, 0);
+                celix_bundleContext_uninstallBundle(ctx, bndId);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    celix_framework_waitForEmptyEventQueue(fw);
+
+    celix_framework_event_queue_stats_t stats;
+    celix_framework_getEventQueueStats(fw, &stats);
+    EXPECT_EQ(0, stats.queueSize);
+    EXPECT_GE(stats.maxQueueSize, 1);
+    EXPECT_GE(stats.nrOfHandledEvents, 3 * 10 * 2); //at least installed and uninstalled events
+    EXPECT_GE(stats.nrOfHandledEvents, stats.nrOfBatches);
+    EXPECT_GE(stats.maxEventLatencyInSeconds, stats.avgEventLatencyInSeconds);
+    std::cout << "Handled " << stats.nrOfHandledEvents << " events in " << stats.nrOfBatches << " batches, max queue size "
+              << stats.maxQueueSize << ", avg latency " << stats.avgEventLatencyInSeconds * 1e6 << " us" << std::endl;
+
+    framework_stop(fw);
+    framework_waitForStop(fw);
+    framework_destroy(fw);
+}
@@ -73,6 +73,22 @@ const char* celix_bundle_getSymbolicName(const celix_bundle_t *bnd);
  */
 bool celix_bundle_isSystemBundle(const celix_bundle_t *bnd);
 
+/**
+ * Startup timing of a bundle. Durations of steps which are not (yet) executed are 0.
+ */
+typedef struct celix_bundle_startup_timing {
+    double installDurationInMs; //creating the bundle archive, including extracting the bundle zip
+    double loadDurationInMs;    //loading the bundle libraries
+    double startDurationInMs;   //creating and starting the bundle activator
+    bool preparedInParallel;    //whether the archive and libraries were prepared by the parallel auto start workers
+} celix_bundle_startup_timing_t;
+
+/**
+ * Returns the startup timing of the bundle.
+ * See also CELIX_AUTO_START_PARALLEL.
+ */
+celix_bundle_startup_timing_t celix_bundle_getStartupTiming(const celix_bundle_t *bnd);
+
 typedef struct celix_bundle_service_list_entry {
     long serviceId;
     long bundleOwner;
@@ -78,6 +78,15 @@ static const char *const CELIX_BUNDLES_PATH_DEFAULT = "bundles";
 
 static const char *const CELIX_LOAD_BUNDLES_WITH_NODELETE = "CELIX_LOAD_BUNDLES_WITH_NODELETE";
 
+/**
+ * Directory of the bundle extraction cache. If configured, bundle zip files are extracted once into a content
+ * addressed (hash of the zip file) entry in this directory and the bundle archives link to the extracted entry instead
+ * of extracting the bundle again. The directory can be shared by multiple frameworks on the same host.
+ * Entries are read-only, because they are shared by the bundle archives linking them.
+ * Default not configured (extraction cache disabled).
+ */
+static const char *const CELIX_BUNDLE_EXTRACTION_CACHE_DIR = "CELIX_BUNDLE_EXTRACTION_CACHE_DIR";
+
 /**
  * The path used getting entries from the framework bundle.
  * Normal bundles have an archive directory.
@@ -85,6 +94,14 @@ static const char *const CELIX_LOAD_BUNDLES_WITH_NODELETE = "CELIX_LOAD_BUNDLES_
  */
 static const char *const CELIX_SYSTEM_BUNDLE_ARCHIVE_PATH = "CELIX_SYSTEM_BUNDLE_ARCHIVE_PATH";
 
+/**
+ * The max nr of service trackers a bundle context keeps alive to speed up repeated
+ * celix_bundleContext_useService(s)WithOptions / celix_bundleContext_findService(s)WithOptions calls.
+ * The least recently used tracker is closed if the cache is full. A value of 0 disables the cache.
+ */
+static const char *const CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE = "CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE";
+static const long        CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE_DEFAULT = 16;
+
 
 #define CELIX_AUTO_START_0 "CELIX_AUTO_START_0"
 #define CELIX_AUTO_START_1 "CELIX_AUTO_START_1"
@@ -94,6 +111,55 @@ static const char *const CELIX_SYSTEM_BUNDLE_ARCHIVE_PATH = "CELIX_SYSTEM_BUNDLE
 #define CELIX_AUTO_START_5 "CELIX_AUTO_START_5"
 #define CELIX_AUTO_START_6 "CELIX_AUTO_START_6"
 
+/**
+ * Whether the auto start bundles (CELIX_AUTO_START_0 .. CELIX_AUTO_START_6) are prepared in parallel.
+ * If enabled, a pool of worker threads extracts the bundle archives concurrently.
+ * Loading the bundle libraries, installing and starting the bundles (calling the bundle activators) is still done
+ * sequentially by the framework thread and in the configured run level order.
+ */
+static const char *const CELIX_AUTO_START_PARALLEL = "CELIX_AUTO_START_PARALLEL";
+static const bool        CELIX_AUTO_START_PARALLEL_DEFAULT = false;
+
+/**
+ * The nr of worker threads used when CELIX_AUTO_START_PARALLEL is enabled.
+ * A value <= 0 (default) means the nr of online processors.
+ */
+static const char *const CELIX_AUTO_START_PARALLEL_NR_OF_THREADS = "CELIX_AUTO_START_PARALLEL_NR_OF_THREADS";
+static const long        CELIX_AUTO_START_PARALLEL_NR_OF_THREADS_DEFAULT = 0;
+
+/**
+ * The nr of threads of the executor pool shared by the dependency manager components of the framework.
+ * If > 0, component transitions (e.g. the init/start callbacks) triggered by added or changed service dependencies
+ * run on the executor pool, so that transitions of independent components can run in parallel.
+ * The transitions of a single component are always executed in order and never concurrently.
+ * Starting and stopping components, removing service dependencies and handling removed services still wait till
+ * the component handled the change, also when called from an executor pool thread. The exception is a thread which is
+ * already running a component transition (or the framework event thread) while another thread runs the transitions of
+ * the changed component. That change is left to the other thread, as without an executor pool, to prevent deadlocks.
+ * Default (0) is no executor pool; component transitions run on the thread that triggered them.
+ */
+static const char *const CELIX_DM_EXECUTOR_NR_OF_THREADS = "CELIX_DM_EXECUTOR_NR_OF_THREADS";
+static const long        CELIX_DM_EXECUTOR_NR_OF_THREADS_DEFAULT = 0;
+
+/**
+ * Whether dependency manager components coalesce the added/changed service events of their service dependencies.
+ * If enabled, service events arriving while a batch is pending are handled in one go: the set callback is called once
+ * with the highest ranking service and the component state is recalculated once per batch.
+ * An added event followed by a removed event of the same service in the same batch cancel each other.
+ * Can be overridden per component with celix_dmComponent_setServiceEventCoalescing.
+ */
+static const char *const CELIX_DM_COALESCE_SERVICE_EVENTS = "CELIX_DM_COALESCE_SERVICE_EVENTS";
+static const bool        CELIX_DM_COALESCE_SERVICE_EVENTS_DEFAULT = false;
+
+/**
+ * The time in ms a batch of coalesced service events stays open after its first event.
+ * Default (0) is no window; a batch contains the events arriving before the component handles it.
+ * The window is only used with an executor pool (CELIX_DM_EXECUTOR_NR_OF_THREADS) and does not occupy a pool thread.
+ * Without an executor pool the batch is handled directly by the thread adding the service.
+ */
+static const char *const CELIX_DM_COALESCE_SERVICE_EVENTS_WINDOW_MS = "CELIX_DM_COALESCE_SERVICE_EVENTS_WINDOW_MS";
+static const long        CELIX_DM_COALESCE_SERVICE_EVENTS_WINDOW_MS_DEFAULT = 0;
+
 
 #ifdef __cplusplus
 }
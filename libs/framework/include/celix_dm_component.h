@@ -63,6 +63,14 @@ void celix_dmComponent_destroy(celix_dm_component_t *cmp);
  */
 celix_status_t celix_dmComponent_setCLanguageProperty(celix_dm_component_t *component, bool setCLangProp);
 
+/**
+ * Specify if the added/changed service events of the service dependencies should be handled in batches.
+ * If enabled the set callback is called once per batch and the component state is recalculated once per batch.
+ * windowInMs is the time a batch stays open after its first event (0 is no window).
+ * Default is configured with the CELIX_DM_COALESCE_SERVICE_EVENTS(_WINDOW_MS) framework properties.
+ */
+celix_status_t celix_dmComponent_setServiceEventCoalescing(celix_dm_component_t *component, bool coalesce, long windowInMs);
+
 
 /**
  * Adds a C interface to provide as service to the Celix framework.
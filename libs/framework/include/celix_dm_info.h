@@ -56,6 +56,12 @@ struct celix_dm_component_info_struct {
     char * state;
     celix_array_list_t *interfaces;   // type dm_interface_info_pt
     celix_array_list_t *dependency_list;  // type dm_service_dependency_info_pt
+    size_t nrOfTransitions; //nr of component state transitions
+    double avgTransitionTimeInMs; //including the component init/start/stop/deinit callbacks
+    double maxTransitionTimeInMs;
+    size_t nrOfTasks; //nr of executed component tasks (e.g. start, stop, service dependency events)
+    double avgTaskLatencyInMs; //time between scheduling and executing a component task
+    double maxTaskLatencyInMs;
 };
 typedef struct celix_dm_component_info_struct *dm_component_info_pt; //deprecated
 typedef struct celix_dm_component_info_struct dm_component_info_t; //deprecated
@@ -146,6 +146,27 @@ bool celix_framework_startBundle(celix_framework_t *fw, long bndId);
  */
 void celix_framework_waitForEmptyEventQueue(celix_framework_t *fw);
 
+/**
+ * Statistics of the framework event queue.
+ */
+typedef struct celix_framework_event_queue_stats {
+    size_t queueSize; //nr of fired events which are not yet handled
+    size_t maxQueueSize; //the max nr of fired and not yet handled events
+    size_t nrOfHandledEvents;
+    size_t nrOfBatches; //nr of times the event dispatcher took (a batch of) events from the queue
+    double avgEventLatencyInSeconds; //avg time between firing and handling an event
+    double maxEventLatencyInSeconds; //max time between firing and handling an event
+} celix_framework_event_queue_stats_t;
+
+/**
+ * Returns the statistics of the framework event queue, e.g. to monitor the queue depth and event latency
+ * during bundle churn.
+ *
+ * @param fw The Celix Framework
+ * @param stats The output statistics.
+ */
+void celix_framework_getEventQueueStats(celix_framework_t *fw, celix_framework_event_queue_stats_t *stats);
+
 /**
  * Sets the log function for this framework.
  * Default the celix framework will log to stdout/stderr.
@@ -644,6 +644,15 @@ bool celix_bundle_isSystemBundle(const celix_bundle_t *bnd) {
     return bnd != NULL && celix_bundle_getId(bnd) == 0;
 }
 
+celix_bundle_startup_timing_t celix_bundle_getStartupTiming(const celix_bundle_t *bnd) {
+    celix_bundle_startup_timing_t timing;
+    memset(&timing, 0, sizeof(timing));
+    if (bnd != NULL) {
+        timing = bnd->startupTiming;
+    }
+    return timing;
+}
+
 celix_array_list_t* celix_bundle_listRegisteredServices(const celix_bundle_t *bnd) {
     long bndId = celix_bundle_getId(bnd);
     celix_array_list_t* result = celix_arrayList_create();
@@ -756,7 +756,8 @@ static celix_status_t bundleArchive_deleteTree(bundle_archive_pt archive, const
 				snprintf(subdir, 512, "%s/%s", directory, dent->d_name);
 
 				struct stat st;
-				if (stat(subdir, &st) == 0) {
+				//note lstat, links to a bundle dir or extraction cache entry are removed, not followed
+				if (lstat(subdir, &st) == 0) {
 					if (S_ISDIR (st.st_mode)) {
 						status = bundleArchive_deleteTree(archive, subdir);
 					} else {
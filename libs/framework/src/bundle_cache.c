@@ -25,6 +25,10 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/errno.h>
+#include <sys/mman.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <zlib.h>
 
 #include "bundle_cache_private.h"
 #include "bundle_archive.h"
@@ -32,8 +36,20 @@
 #include "celix_log.h"
 #include "celix_properties.h"
 #include "celix_utils_api.h"
+#include "archive.h"
 
 static celix_status_t bundleCache_deleteTree(bundle_cache_pt cache, char * directory, bool root);
+static celix_status_t bundleCache_getExtractedBundle(bundle_cache_pt cache, const char *bundleFile, char **extractedDir);
+
+/**
+ * The extraction cache entries used in this process.
+ * An entry is used once per process, because libraries loaded from the same file are shared by the dynamic loader.
+ * Using an entry a second time (e.g. for a second framework in the same process) would share the library state of
+ * the bundles; in that case the bundle is extracted as usual.
+ */
+static pthread_mutex_t g_extractionCacheMutex = PTHREAD_MUTEX_INITIALIZER;
+static celix_array_list_t *g_extractionCacheEntriesInUse = NULL; //protected by g_extractionCacheMutex
+static long g_extractionCacheTmpCounter = 0; //protected by g_extractionCacheMutex
 
 static const char* bundleCache_progamName() {
 #if defined(__APPLE__) || defined(__FreeBSD__)
@@ -78,6 +94,9 @@ celix_status_t bundleCache_create(const char *fwUUID, celix_properties_t *config
 			cache->deleteOnDestroy = false;
 		}
 
+		const char *extractionCacheDir = celix_properties_get(configurationMap, CELIX_BUNDLE_EXTRACTION_CACHE_DIR, NULL);
+		cache->extractionCacheDir = extractionCacheDir == NULL || strlen(extractionCacheDir) == 0 ? NULL : strdup(extractionCacheDir);
+
 		*bundle_cache = cache;
 		status = CELIX_SUCCESS;
 	}
@@ -92,6 +111,7 @@ celix_status_t bundleCache_destroy(bundle_cache_pt *cache) {
 		bundleCache_delete(*cache);
 	}
 	free((*cache)->cacheDir);
+	free((*cache)->extractionCacheDir);
 	free(*cache);
 	*cache = NULL;
 
@@ -187,7 +207,16 @@ celix_status_t bundleCache_createArchive(bundle_cache_pt cache, long id, const c
 
 	if (cache && location) {
 		snprintf(archiveRoot, sizeof(archiveRoot), "%s/bundle%ld",  cache->cacheDir, id);
-		status = bundleArchive_create(archiveRoot, id, location, inputFile, bundle_archive);
+		char *extractedDir = NULL;
+		if (cache->extractionCacheDir != NULL) {
+			const char *bundleFile = inputFile != NULL ? inputFile : location;
+			if (bundleCache_getExtractedBundle(cache, bundleFile, &extractedDir) != CELIX_SUCCESS) {
+				fw_log(celix_frameworkLogger_globalLogger(), CELIX_LOG_LEVEL_TRACE, "Not using extraction cache for %s", bundleFile);
+			}
+		}
+		//note an extracted bundle dir is used as input file; the bundle revision links the extracted entries.
+		status = bundleArchive_create(archiveRoot, id, location, extractedDir != NULL ? extractedDir : inputFile, bundle_archive);
+		free(extractedDir);
 	}
 
 	framework_logIfError(celix_frameworkLogger_globalLogger(), status, NULL, "Failed to create archive");
@@ -248,3 +277,145 @@ static celix_status_t bundleCache_deleteTree(bundle_cache_pt cache, char * direc
 
 	return status;
 }
+
+/**
+ * Removes the write permissions of the files and dirs in the provided dir (recursive, links are not followed).
+ */
+static void bundleCache_makeReadOnly(const char *directory) {
+	DIR *dir = opendir(directory);
+	if (dir != NULL) {
+		struct dirent *dent = readdir(dir);
+		while (dent != NULL) {
+			if ((strcmp((dent->d_name), ".") != 0) && (strcmp((dent->d_name), "..") != 0)) {
+				char path[512];
+				struct stat st;
+				snprintf(path, sizeof(path), "%s/%s", directory, dent->d_name);
+				if (lstat(path, &st) == 0) {
+					if (S_ISDIR(st.st_mode)) {
+						bundleCache_makeReadOnly(path);
+					} else if (S_ISREG(st.st_mode)) {
+						chmod(path, st.st_mode & ~(S_IWUSR | S_IWGRP | S_IWOTH));
+					}
+				}
+			}
+			dent = readdir(dir);
+		}
+		closedir(dir);
+		struct stat st;
+		if (stat(directory, &st) == 0) {
+			chmod(directory, st.st_mode & ~(S_IWUSR | S_IWGRP | S_IWOTH));
+		}
+	}
+}
+
+void bundleCache_releaseExtractedBundle(const char *extractedDir) {
+	pthread_mutex_lock(&g_extractionCacheMutex);
+	for (int i = 0; g_extractionCacheEntriesInUse != NULL && i < celix_arrayList_size(g_extractionCacheEntriesInUse); ++i) {
+		char *inUse = celix_arrayList_get(g_extractionCacheEntriesInUse, i);
+		if (strcmp(extractedDir, inUse) == 0) {
+			celix_arrayList_removeAt(g_extractionCacheEntriesInUse, i);
+			free(inUse);
+			break;
+		}
+	}
+	if (g_extractionCacheEntriesInUse != NULL && celix_arrayList_size(g_extractionCacheEntriesInUse) == 0) {
+		celix_arrayList_destroy(g_extractionCacheEntriesInUse);
+		g_extractionCacheEntriesInUse = NULL;
+	}
+	pthread_mutex_unlock(&g_extractionCacheMutex);
+}
+
+static bool bundleCache_isExtractedBundle(const char *dir) {
+	char manifest[512];
+	snprintf(manifest, sizeof(manifest), "%s/META-INF/MANIFEST.MF", dir);
+	return access(manifest, F_OK) == 0;
+}
+
+/**
+ * Returns the extraction cache entry for the provided bundle zip file; extracts the bundle if the entry does not exist.
+ * Entries are content addressed (hash and size of the zip file), so an entry can be shared by multiple frameworks on
+ * the same host. An entry is created in a temporary dir and renamed into place, so concurrently starting frameworks
+ * never see a partially extracted entry.
+ */
+static celix_status_t bundleCache_getExtractedBundle(bundle_cache_pt cache, const char *bundleFile, char **extractedDir) {
+	celix_status_t status = CELIX_SUCCESS;
+
+	//hash the memory mapped zip file
+	int fd = open(bundleFile, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+		status = CELIX_ILLEGAL_ARGUMENT; //not a bundle zip file (e.g. a bundle dir)
+	}
+	void *data = MAP_FAILED;
+	if (status == CELIX_SUCCESS) {
+		data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (data == MAP_FAILED) {
+			status = CELIX_FILE_IO_EXCEPTION;
+		}
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	char entry[512];
+	if (status == CELIX_SUCCESS) {
+		const unsigned char *bytes = data;
+		uint64_t hash = 14695981039346656037ULL;
+		for (off_t i = 0; i < st.st_size; ++i) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+		uLong crc = crc32(0L, data, (uInt)st.st_size);
+		munmap(data, (size_t)st.st_size);
+		int written = snprintf(entry, sizeof(entry), "%s/%016" PRIx64 "%08lx-%lld", cache->extractionCacheDir, hash, (unsigned long)crc, (long long)st.st_size);
+		if (written >= sizeof(entry)) {
+			status = CELIX_ILLEGAL_ARGUMENT;
+		}
+	}
+
+	long tmpCounter = 0;
+	if (status == CELIX_SUCCESS) {
+		pthread_mutex_lock(&g_extractionCacheMutex);
+		if (g_extractionCacheEntriesInUse == NULL) {
+			g_extractionCacheEntriesInUse = celix_arrayList_create();
+		}
+		for (int i = 0; i < celix_arrayList_size(g_extractionCacheEntriesInUse); ++i) {
+			if (strcmp(entry, celix_arrayList_get(g_extractionCacheEntriesInUse, i)) == 0) {
+				status = CELIX_ILLEGAL_STATE;
+				break;
+			}
+		}
+		if (status == CELIX_SUCCESS) {
+			celix_arrayList_add(g_extractionCacheEntriesInUse, strdup(entry));
+		}
+		tmpCounter = g_extractionCacheTmpCounter++;
+		pthread_mutex_unlock(&g_extractionCacheMutex);
+	}
+
+	if (status == CELIX_SUCCESS && !bundleCache_isExtractedBundle(entry)) {
+		char tmpDir[600];
+		snprintf(tmpDir, sizeof(tmpDir), "%s.tmp-%li-%li", entry, (long)getpid(), tmpCounter);
+		mkdir(cache->extractionCacheDir, S_IRWXU);
+		if (mkdir(tmpDir, S_IRWXU) != 0) {
+			status = CELIX_FILE_IO_EXCEPTION;
+		}
+		status = CELIX_DO_IF(status, extractBundle(bundleFile, tmpDir));
+		if (status == CELIX_SUCCESS && rename(tmpDir, entry) != 0) {
+			//another framework was first; use its entry
+			status = bundleCache_isExtractedBundle(entry) ? CELIX_SUCCESS : CELIX_FILE_IO_EXCEPTION;
+		}
+		if (access(tmpDir, F_OK) == 0) {
+			bundleCache_deleteTree(cache, tmpDir, false);
+		} else if (status == CELIX_SUCCESS) {
+			//note the entry is shared by all frameworks using it (through links), so it should not be changed
+			bundleCache_makeReadOnly(entry);
+		}
+		if (status != CELIX_SUCCESS) {
+			bundleCache_releaseExtractedBundle(entry);
+		}
+	}
+
+	if (status == CELIX_SUCCESS) {
+		*extractedDir = strdup(entry);
+	}
+	return status;
+}
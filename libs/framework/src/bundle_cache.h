@@ -107,6 +107,15 @@ celix_status_t bundleCache_createArchive(bundle_cache_pt cache, long id, const c
  */
 celix_status_t bundleCache_delete(bundle_cache_pt cache);
 
+/**
+ * Releases the use of an extraction cache entry, so that the entry can be used again in this process.
+ * Called when the bundle revision linking the entry is destroyed. Does nothing if the dir is not an extraction cache
+ * entry in use.
+ *
+ * @param extractedDir The extracted bundle dir used as input file of the bundle revision.
+ */
+void bundleCache_releaseExtractedBundle(const char *extractedDir);
+
 /**
  * @}
  */
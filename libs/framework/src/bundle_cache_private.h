@@ -34,6 +34,7 @@ struct bundleCache {
 	properties_pt configurationMap;
 	char * cacheDir;
 	bool deleteOnDestroy;
+	char * extractionCacheDir; //NULL if the extraction cache is disabled
 };
 
 
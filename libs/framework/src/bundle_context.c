@@ -34,11 +34,15 @@
 #include "dm_dependency_manager_impl.h"
 #include "celix_array_list.h"
 #include "module.h"
+#include "service_registry_private.h"
+#include "service_tracker_private.h"
 
 static celix_status_t bundleContext_bundleChanged(void *handle, bundle_event_t *event);
 static void bundleContext_cleanupBundleTrackers(bundle_context_t *ct);
 static void bundleContext_cleanupServiceTrackers(bundle_context_t *ctx);
 static void bundleContext_cleanupServiceTrackerTrackers(bundle_context_t *ctx);
+static celix_bundle_context_use_service_entry_t* bundleContext_retainUseServiceEntry(celix_bundle_context_t *ctx, const celix_service_filter_options_t *filter);
+static void bundleContext_releaseUseServiceEntry(celix_bundle_context_t *ctx, celix_bundle_context_use_service_entry_t *entry);
 
 celix_status_t bundleContext_create(framework_pt framework, celix_framework_logger_t*  logger, bundle_pt bundle, bundle_context_pt *bundle_context) {
 	celix_status_t status = CELIX_SUCCESS;
@@ -63,6 +67,12 @@ celix_status_t bundleContext_create(framework_pt framework, celix_framework_logg
             context->metaTrackers =  hashMap_create(NULL,NULL,NULL,NULL);
             context->nextTrackerId = 1L;
 
+            celixThreadMutex_create(&context->useServiceCache.mutex, NULL);
+            context->useServiceCache.entries = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+            context->useServiceCache.maxSize = -1;
+            context->useServiceCache.tick = 0;
+            context->useServiceCache.stopping = false;
+
             *bundle_context = context;
 
         }
@@ -77,6 +87,10 @@ celix_status_t bundleContext_destroy(bundle_context_pt context) {
 	celix_status_t status = CELIX_SUCCESS;
 
 	if (context != NULL) {
+	    celix_bundleContext_clearUseServiceCache(context);
+	    hashMap_destroy(context->useServiceCache.entries, false, false);
+	    celixThreadMutex_destroy(&context->useServiceCache.mutex);
+
 	    celixThreadMutex_lock(&context->mutex);
 
 
@@ -761,28 +775,11 @@ bool celix_bundleContext_useServiceWithOptions(
         celix_bundle_context_t *ctx,
         const celix_service_use_options_t *opts) {
     bool called = false;
-    celix_service_tracking_options_t trkOpts;
-    memset(&trkOpts, 0, sizeof(trkOpts));
-
     if (opts != NULL) {
-        trkOpts.filter.serviceName = opts->filter.serviceName;
-        trkOpts.filter = opts->filter;
-        trkOpts.filter.versionRange = opts->filter.versionRange;
-        trkOpts.filter.serviceLanguage = opts->filter.serviceLanguage;
-
-        service_tracker_t *trk = celix_serviceTracker_createWithOptions(ctx, &trkOpts);
-        if (trk != NULL) {
-            if (opts->use != NULL) {
-
-            }
-            if (opts->useWithProperties != NULL) {
-
-            }
-            if (opts->useWithOwner != NULL) {
-
-            }
-            called = celix_serviceTracker_useHighestRankingService(trk, opts->filter.serviceName, opts->waitTimeoutInSeconds, opts->callbackHandle, opts->use, opts->useWithProperties, opts->useWithOwner);
-            celix_serviceTracker_destroy(trk);
+        celix_bundle_context_use_service_entry_t *entry = bundleContext_retainUseServiceEntry(ctx, &opts->filter);
+        if (entry != NULL) {
+            called = celix_serviceTracker_useHighestRankingService(entry->tracker, opts->filter.serviceName, opts->waitTimeoutInSeconds, opts->callbackHandle, opts->use, opts->useWithProperties, opts->useWithOwner);
+            bundleContext_releaseUseServiceEntry(ctx, entry);
         }
     }
     return called;
@@ -794,21 +791,185 @@ size_t celix_bundleContext_useServicesWithOptions(
         celix_bundle_context_t *ctx,
         const celix_service_use_options_t *opts) {
     size_t count = 0;
-    celix_service_tracking_options_t trkOpts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
     if (opts != NULL) {
-        trkOpts.filter.serviceName = opts->filter.serviceName;
-        trkOpts.filter.filter = opts->filter.filter;
-        trkOpts.filter.versionRange = opts->filter.versionRange;
-        trkOpts.filter.serviceLanguage = opts->filter.serviceLanguage;
-        trkOpts.filter.ignoreServiceLanguage = opts->filter.ignoreServiceLanguage;
+        celix_bundle_context_use_service_entry_t *entry = bundleContext_retainUseServiceEntry(ctx, &opts->filter);
+        if (entry != NULL) {
+            count = celix_serviceTracker_useServices(entry->tracker, opts->filter.serviceName, opts->callbackHandle, opts->use, opts->useWithProperties, opts->useWithOwner);
+            bundleContext_releaseUseServiceEntry(ctx, entry);
+        }
+    }
+    return count;
+}
+
+/**
+ * Creates the use service cache key for the provided filter options.
+ * The key is written in buf if it fits, otherwise a new string is allocated (and should be freed by the caller).
+ */
+static char* bundleContext_useServiceKey(const celix_service_filter_options_t *filter, char *buf, size_t bufSize) {
+    const char *name = filter->serviceName == NULL ? "" : filter->serviceName;
+    const char *flt = filter->filter == NULL ? "" : filter->filter;
+    const char *range = filter->versionRange == NULL ? "" : filter->versionRange;
+    const char *lang = filter->serviceLanguage == NULL ? "" : filter->serviceLanguage;
+    int ignoreLang = filter->ignoreServiceLanguage ? 1 : 0;
+    int len = snprintf(buf, bufSize, "%s\n%s\n%s\n%s\n%i", name, flt, range, lang, ignoreLang);
+    if (len < 0) {
+        return NULL;
+    } else if ((size_t)len >= bufSize) {
+        char *key = NULL;
+        asprintf(&key, "%s\n%s\n%s\n%s\n%i", name, flt, range, lang, ignoreLang);
+        return key;
+    }
+    return buf;
+}
+
+static void bundleContext_destroyUseServiceEntry(celix_bundle_context_use_service_entry_t *entry) {
+    if (entry != NULL) {
+        celix_serviceTracker_destroy(entry->tracker);
+        free(entry->key);
+        free(entry);
+    }
+}
+
+/**
+ * Returns a use service entry with a service tracker for the provided filter options.
+ *
+ * If possible a cached (long lived) service tracker is used, so that a repeated use service call does not need to
+ * create/open a service tracker. The returned entry must be released with bundleContext_releaseUseServiceEntry.
+ *
+ * Entries are only cached for starting/active bundles, because the cached trackers must be closed before the
+ * service references of a stopping bundle are cleared. Note that the cache is not evicted during a service event
+ * callback, because closing a tracker - i.e. removing its service listener - during a service event can deadlock.
+ */
+static celix_bundle_context_use_service_entry_t* bundleContext_retainUseServiceEntry(celix_bundle_context_t *ctx, const celix_service_filter_options_t *filter) {
+    celix_bundle_context_use_service_entry_t *result = NULL;
+    celix_bundle_context_use_service_entry_t *evicted = NULL;
+
+    celix_bundle_state_e bndState = celix_bundle_getState(ctx->bundle);
+    bool cacheAllowed = bndState == OSGI_FRAMEWORK_BUNDLE_ACTIVE || bndState == OSGI_FRAMEWORK_BUNDLE_STARTING;
+
+    char buf[256];
+    char *key = NULL;
+    if (cacheAllowed) {
+        key = bundleContext_useServiceKey(filter, buf, sizeof(buf));
+    }
+
+    if (key != NULL) {
+        celixThreadMutex_lock(&ctx->useServiceCache.mutex);
+        if (ctx->useServiceCache.maxSize < 0) {
+            ctx->useServiceCache.maxSize = celix_bundleContext_getPropertyAsLong(ctx, CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE, CELIX_BUNDLE_CONTEXT_USE_SERVICE_CACHE_SIZE_DEFAULT);
+        }
+        result = hashMap_get(ctx->useServiceCache.entries, key);
+        if (result != NULL) {
+            result->useCount += 1;
+            result->lastUsed = ++ctx->useServiceCache.tick;
+        }
+        bool cacheEnabled = ctx->useServiceCache.maxSize > 0 && !ctx->useServiceCache.stopping;
+        celixThreadMutex_unlock(&ctx->useServiceCache.mutex);
+        if (result != NULL || !cacheEnabled) {
+            if (key != buf) {
+                free(key);
+            }
+            key = NULL;
+        }
+    }
 
-        service_tracker_t *trk = celix_serviceTracker_createWithOptions(ctx, &trkOpts);
+    if (result == NULL) {
+        celix_service_tracking_options_t trkOpts = CELIX_EMPTY_SERVICE_TRACKING_OPTIONS;
+        trkOpts.filter.serviceName = filter->serviceName;
+        trkOpts.filter.filter = filter->filter;
+        trkOpts.filter.versionRange = filter->versionRange;
+        trkOpts.filter.serviceLanguage = filter->serviceLanguage;
+        trkOpts.filter.ignoreServiceLanguage = filter->ignoreServiceLanguage;
+        celix_service_tracker_t *trk = celix_serviceTracker_createWithOptions(ctx, &trkOpts);
         if (trk != NULL) {
-            count = celix_serviceTracker_useServices(trk, opts->filter.serviceName, opts->callbackHandle, opts->use, opts->useWithProperties, opts->useWithOwner);
-            celix_serviceTracker_destroy(trk);
+            result = calloc(1, sizeof(*result));
+            result->tracker = trk;
+            result->useCount = 1;
         }
     }
-    return count;
+
+    if (key != NULL && result != NULL) {
+        //try to add the new entry to the cache
+        celixThreadMutex_lock(&ctx->useServiceCache.mutex);
+        celix_bundle_context_use_service_entry_t *existing = hashMap_get(ctx->useServiceCache.entries, key);
+        if (existing != NULL) {
+            //added concurrently, use the existing entry
+            existing->useCount += 1;
+            existing->lastUsed = ++ctx->useServiceCache.tick;
+            evicted = result;
+            result = existing;
+        } else if (!ctx->useServiceCache.stopping) {
+            if (hashMap_size(ctx->useServiceCache.entries) >= ctx->useServiceCache.maxSize && !celix_serviceRegistry_isHandlingServiceEvent()) {
+                //evict least recently used entry, if not in use
+                hash_map_iterator_t iter = hashMapIterator_construct(ctx->useServiceCache.entries);
+                while (hashMapIterator_hasNext(&iter)) {
+                    celix_bundle_context_use_service_entry_t *candidate = hashMapIterator_nextValue(&iter);
+                    if (candidate->useCount == 0 && (evicted == NULL || candidate->lastUsed < evicted->lastUsed)) {
+                        evicted = candidate;
+                    }
+                }
+                if (evicted != NULL) {
+                    hashMap_remove(ctx->useServiceCache.entries, evicted->key);
+                }
+            }
+            if (hashMap_size(ctx->useServiceCache.entries) < ctx->useServiceCache.maxSize) {
+                result->key = key == buf ? strdup(buf) : key;
+                key = NULL;
+                result->lastUsed = ++ctx->useServiceCache.tick;
+                hashMap_put(ctx->useServiceCache.entries, result->key, result);
+            }
+        }
+        celixThreadMutex_unlock(&ctx->useServiceCache.mutex);
+    }
+
+    if (key != NULL && key != buf) {
+        free(key);
+    }
+    bundleContext_destroyUseServiceEntry(evicted);
+    return result;
+}
+
+static void bundleContext_releaseUseServiceEntry(celix_bundle_context_t *ctx, celix_bundle_context_use_service_entry_t *entry) {
+    //services from a service factory are not kept in the cache, so that the service is still ungot after a use call
+    bool uncache = !celix_serviceRegistry_isHandlingServiceEvent() && celix_serviceTracker_isTrackingServiceFactory(entry->tracker);
+    bool destroy;
+    celixThreadMutex_lock(&ctx->useServiceCache.mutex);
+    entry->useCount -= 1;
+    if (uncache && entry->key != NULL) {
+        hashMap_remove(ctx->useServiceCache.entries, entry->key);
+        free(entry->key);
+        entry->key = NULL;
+    }
+    destroy = entry->key == NULL && entry->useCount == 0; //not cached
+    celixThreadMutex_unlock(&ctx->useServiceCache.mutex);
+    if (destroy) {
+        bundleContext_destroyUseServiceEntry(entry);
+    }
+}
+
+void celix_bundleContext_clearUseServiceCache(celix_bundle_context_t *ctx) {
+    celix_array_list_t *entries = celix_arrayList_create();
+    celixThreadMutex_lock(&ctx->useServiceCache.mutex);
+    ctx->useServiceCache.stopping = true; //note set under the lock, so a concurrent use call cannot add an entry after the clear
+    hash_map_iterator_t iter = hashMapIterator_construct(ctx->useServiceCache.entries);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_arrayList_add(entries, hashMapIterator_nextValue(&iter));
+    }
+    hashMap_clear(ctx->useServiceCache.entries, false, false);
+    for (int i = 0; i < celix_arrayList_size(entries); ++i) {
+        celix_bundle_context_use_service_entry_t *entry = celix_arrayList_get(entries, i);
+        free(entry->key);
+        entry->key = NULL; //no longer cached, so entries still in use will be destroyed on release
+        if (entry->useCount > 0) {
+            celix_arrayList_removeAt(entries, i--);
+        }
+    }
+    celixThreadMutex_unlock(&ctx->useServiceCache.mutex);
+
+    for (int i = 0; i < celix_arrayList_size(entries); ++i) {
+        bundleContext_destroyUseServiceEntry(celix_arrayList_get(entries, i));
+    }
+    celix_arrayList_destroy(entries);
 }
 
 
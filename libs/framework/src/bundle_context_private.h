@@ -25,6 +25,7 @@
 #include "bundle_listener.h"
 #include "celix_bundle_context.h"
 #include "listener_hook_service.h"
+#include "service_tracker.h"
 
 typedef struct celix_bundle_context_bundle_tracker_entry {
 	celix_bundle_context_t *ctx;
@@ -45,6 +46,13 @@ typedef struct celix_bundle_context_service_tracker_tracker_entry {
 	void (*remove)(void *handle, const celix_service_tracker_info_t *info);
 } celix_bundle_context_service_tracker_tracker_entry_t;
 
+typedef struct celix_bundle_context_use_service_entry {
+	char *key; //service name, filter, version range and service language; NULL if not cached
+	celix_service_tracker_t *tracker;
+	unsigned long lastUsed; //use service cache tick of the last use (LRU)
+	unsigned int useCount; //nr of ongoing use calls, entries in use are not evicted
+} celix_bundle_context_use_service_entry_t;
+
 struct celix_bundle_context {
 	celix_framework_t *framework;
 	celix_bundle_t *bundle;
@@ -56,7 +64,22 @@ struct celix_bundle_context {
 	hash_map_t *bundleTrackers; //key = trackerId, value = celix_bundle_context_bundle_tracker_entry_t*
 	hash_map_t *serviceTrackers; //key = trackerId, value = celix_service_tracker_t*
 	hash_map_t *metaTrackers; //key = trackerId, value = celix_bundle_context_service_tracker_tracker_entry_t*
+
+	struct {
+		celix_thread_mutex_t mutex; //protects fields below (separate from the context mutex, used in the use service path)
+		hash_map_t *entries; //key = use service key, value = celix_bundle_context_use_service_entry_t*
+		long maxSize; //-1 if not yet read from the framework config
+		unsigned long tick;
+		bool stopping; //set when the cache is cleared, no entries are added to the cache afterwards
+	} useServiceCache;
 };
 
+/**
+ * Closes all the service trackers kept in the use service cache.
+ * Called when the bundle is stopped, before the service references of the bundle are cleared.
+ * After this call no new entries are added to the cache.
+ */
+void celix_bundleContext_clearUseServiceCache(celix_bundle_context_t *ctx);
+
 
 #endif /* BUNDLE_CONTEXT_PRIVATE_H_ */
@@ -36,6 +36,8 @@ struct celix_bundle {
 	manifest_pt manifest;
 
 	celix_framework_t *framework;
+
+	celix_bundle_startup_timing_t startupTiming; //updated by the framework during install, resolve and start.
 };
 
 #endif /* BUNDLE_PRIVATE_H_ */
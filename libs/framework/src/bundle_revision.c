@@ -23,9 +23,64 @@
 #include <archive.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <dirent.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
 
 
 #include "bundle_revision_private.h"
+#include "bundle_cache.h"
+
+/**
+ * Links the top level entries of an (already extracted) bundle dir in the revision root, so that the bundle
+ * does not need to be extracted.
+ */
+static celix_status_t bundleRevision_linkBundleDir(const char *bundleDir, const char *root) {
+    celix_status_t status = CELIX_SUCCESS;
+    char *absBundleDir = realpath(bundleDir, NULL);
+    DIR *dir = absBundleDir == NULL ? NULL : opendir(absBundleDir);
+    if (dir == NULL) {
+        status = CELIX_FILE_IO_EXCEPTION;
+    } else {
+        struct dirent *dent = readdir(dir);
+        while (status == CELIX_SUCCESS && dent != NULL) {
+            if ((strcmp((dent->d_name), ".") != 0) && (strcmp((dent->d_name), "..") != 0)) {
+                char target[PATH_MAX];
+                char link[PATH_MAX];
+                snprintf(target, sizeof(target), "%s/%s", absBundleDir, dent->d_name);
+                snprintf(link, sizeof(link), "%s/%s", root, dent->d_name);
+                if (symlink(target, link) != 0 && errno != EEXIST) {
+                    status = CELIX_FILE_IO_EXCEPTION;
+                }
+            }
+            dent = readdir(dir);
+        }
+        closedir(dir);
+    }
+    free(absBundleDir);
+    return status;
+}
+
+/**
+ * Releases the linked bundle dir, which can be an extraction cache entry.
+ */
+static void bundleRevision_releaseLinkedBundleDir(bundle_revision_pt revision) {
+    if (revision->linkedBundleDir != NULL) {
+        bundleCache_releaseExtractedBundle(revision->linkedBundleDir);
+        free(revision->linkedBundleDir);
+        revision->linkedBundleDir = NULL;
+    }
+}
+
+static celix_status_t bundleRevision_extractOrLinkBundle(bundle_revision_pt revision, const char *bundle, const char *root) {
+    struct stat st;
+    if (stat(bundle, &st) == 0 && S_ISDIR(st.st_mode)) {
+        revision->linkedBundleDir = strdup(bundle);
+        return bundleRevision_linkBundleDir(bundle, root);
+    }
+    return extractBundle(bundle, root);
+}
 
 celix_status_t bundleRevision_create(const char *root, const char *location, long revisionNr, const char *inputFile, bundle_revision_pt *bundle_revision) {
     celix_status_t status = CELIX_SUCCESS;
@@ -40,11 +95,12 @@ celix_status_t bundleRevision_create(const char *root, const char *location, lon
             free(revision);
             status = CELIX_FILE_IO_EXCEPTION;
         } else {
+            revision->linkedBundleDir = NULL;
             if (inputFile != NULL) {
-                status = extractBundle(inputFile, root);
+                status = bundleRevision_extractOrLinkBundle(revision, inputFile, root);
             } else if (strcmp(location, "inputstream:") != 0) {
             	// If location != inputstream, extract it, else ignore it and assume this is a cache entry.
-                status = extractBundle(location, root);
+                status = bundleRevision_extractOrLinkBundle(revision, location, root);
             }
 
             status = CELIX_DO_IF(status, arrayList_create(&(revision->libraryHandles)));
@@ -60,6 +116,7 @@ celix_status_t bundleRevision_create(const char *root, const char *location, lon
 				status = manifest_createFromFile(manifest, &revision->manifest);
             }
             else {
+                bundleRevision_releaseLinkedBundleDir(revision);
             	free(revision);
             }
 
@@ -72,6 +129,7 @@ celix_status_t bundleRevision_create(const char *root, const char *location, lon
 }
 
 celix_status_t bundleRevision_destroy(bundle_revision_pt revision) {
+    bundleRevision_releaseLinkedBundleDir(revision);
     arrayList_destroy(revision->libraryHandles);
     manifest_destroy(revision->manifest);
     free(revision->root);
@@ -34,6 +34,7 @@ struct bundleRevision {
 	char *root;
 	char *location;
 	manifest_pt manifest;
+	char *linkedBundleDir; //the bundle dir linked in the root, NULL if the bundle is extracted
 
 	array_list_pt libraryHandles;
 };
@@ -24,11 +24,16 @@
 #include <uuid/uuid.h>
 
 #include "celix_constants.h"
+#include "celix_utils.h"
 #include "filter.h"
 #include "dm_component_impl.h"
+#include "dm_executor_pool.h"
+#include "bundle_context_private.h"
+#include "framework_private.h"
 
 
 typedef struct dm_executor_struct * dm_executor_pt;
+typedef struct dm_event_batch_struct dm_event_batch_t;
 
 struct celix_dm_component_struct {
     char id[DM_COMPONENT_MAX_ID_LENGTH];
@@ -55,6 +60,10 @@ struct celix_dm_component_struct {
     hash_map_pt dependencyEvents; //protected by mutex
 
     dm_executor_pt executor;
+
+    bool coalesceServiceEvents;
+    long coalesceWindowInMs;
+    dm_event_batch_t *pendingEventBatch; //protected by mutex, batch of coalesced service events not yet handled
 };
 
 typedef struct dm_interface_struct {
@@ -64,17 +73,46 @@ typedef struct dm_interface_struct {
     long svcId;
 } dm_interface_t;
 
+/**
+ * Whether the caller of executor_executeTask waits for the task.
+ * Waiting is only needed if the tasks of the component run on the executor pool. Without a pool the tasks are run
+ * by the calling thread, unless another thread is already running the tasks of the component.
+ */
+typedef enum dm_executor_wait_mode {
+    DM_EXECUTOR_NO_WAIT,            //the task can run asynchronously on the executor pool
+    DM_EXECUTOR_WAIT_FOR_TASK,      //wait till the task is done
+    DM_EXECUTOR_WAIT_FOR_IDLE,      //wait till the task is done and no tasks are running anymore
+} dm_executor_wait_mode_e;
+
 struct dm_executor_struct {
     pthread_t runningThread;
     bool runningThreadSet;
+    bool running; //true if the tasks are being run by a thread or are submitted to the executor pool
     celix_array_list_t *workQueue;
     pthread_mutex_t mutex;
+    pthread_cond_t cond; //broadcast when a task is done or the executor is idle
+
+    celix_dm_executor_pool_t *pool; //NULL if the tasks are run by the calling thread
+    celix_framework_t *fw; //used to check for the framework event thread, can be NULL
+    size_t nrOfScheduledTasks;
+    size_t nrOfDoneTasks;
+
+    struct {
+        size_t nrOfTransitions;
+        double totalTransitionTime;
+        double maxTransitionTime;
+        double totalTaskLatency;
+        double maxTaskLatency;
+    } metrics; //protected by mutex, durations in seconds
 };
 
 typedef struct dm_executor_task_struct {
     celix_dm_component_t *component;
     void (*command)(void *command_ptr, void *data);
     void *data;
+    struct timespec scheduleTime;
+    bool delayed; //if true, a pool thread does not run the task before runAfter
+    struct timespec runAfter;
 } dm_executor_task_t;
 
 typedef struct dm_handle_event_type_struct {
@@ -83,12 +121,23 @@ typedef struct dm_handle_event_type_struct {
 	dm_event_pt newEvent;
 } *dm_handle_event_type_pt;
 
-static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t  currentThread __attribute__((unused)));
-static celix_status_t executor_execute(dm_executor_pt executor);
-static celix_status_t executor_executeTask(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data);
-static celix_status_t executor_schedule(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data);
+//executor whose tasks are run by the current thread, NULL if the current thread is not running component tasks
+static __thread dm_executor_pt g_currentExecutor = NULL;
+
+struct dm_event_batch_struct {
+    celix_array_list_t *items; //value = dm_handle_event_type_pt, only added and changed events
+    struct timespec firstEventTime;
+};
+
+static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t  currentThread __attribute__((unused)), bool honorDelay);
+static void executor_runPoolJob(void *data);
+static celix_status_t executor_execute(dm_executor_pt executor, dm_executor_wait_mode_e waitMode, size_t taskNr);
+static celix_status_t executor_executeTask(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data, dm_executor_wait_mode_e waitMode);
+static celix_status_t executor_executeTaskAfter(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data, const struct timespec *runAfter);
+static celix_status_t executor_schedule(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data, const struct timespec *runAfter, size_t *taskNr);
 static celix_status_t executor_create(celix_dm_component_t *component __attribute__((unused)), dm_executor_pt *executor);
 static void executor_destroy(dm_executor_pt executor);
+static void executor_addTransitionTime(dm_executor_pt executor, double transitionTime);
 
 static celix_status_t component_invokeRemoveRequiredDependencies(celix_dm_component_t *component);
 static celix_status_t component_invokeRemoveInstanceBoundDependencies(celix_dm_component_t *component);
@@ -115,6 +164,9 @@ static celix_status_t component_startTask(celix_dm_component_t *component, void
 static celix_status_t component_stopTask(celix_dm_component_t *component, void * data __attribute__((unused)));
 static celix_status_t component_removeTask(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency);
 static celix_status_t component_handleEventTask(celix_dm_component_t *component, dm_handle_event_type_pt data);
+static celix_status_t component_handleEventBatchTask(celix_dm_component_t *component, dm_event_batch_t *batch);
+static bool component_coalesceEvent(celix_dm_component_t *component, dm_handle_event_type_pt data);
+static void component_destroyEventBatch(dm_event_batch_t *batch);
 
 static celix_status_t component_handleAdded(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency, dm_event_pt event);
 static celix_status_t component_handleChanged(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency, dm_event_pt event);
@@ -158,6 +210,12 @@ celix_dm_component_t* celix_dmComponent_create(bundle_context_t *context, const
 
     component->executor = NULL;
     executor_create(component, &component->executor);
+
+    component->pendingEventBatch = NULL;
+    if (context != NULL) {
+        component->coalesceServiceEvents = celix_bundleContext_getPropertyAsBool(context, CELIX_DM_COALESCE_SERVICE_EVENTS, CELIX_DM_COALESCE_SERVICE_EVENTS_DEFAULT);
+        component->coalesceWindowInMs = celix_bundleContext_getPropertyAsLong(context, CELIX_DM_COALESCE_SERVICE_EVENTS_WINDOW_MS, CELIX_DM_COALESCE_SERVICE_EVENTS_WINDOW_MS_DEFAULT);
+    }
     return component;
 }
 
@@ -192,6 +250,7 @@ void celix_dmComponent_destroy(celix_dm_component_t *component) {
 		arrayList_destroy(component->dm_interfaces);
 
 		executor_destroy(component->executor);
+		component_destroyEventBatch(component->pendingEventBatch);
 
 		hash_map_iterator_pt iter = hashMapIterator_create(component->dependencyEvents);
 		while(hashMapIterator_hasNext(iter)){
@@ -220,7 +279,7 @@ celix_status_t celix_dmComponent_addServiceDependency(celix_dm_component_t *comp
 
     celix_status_t status = CELIX_SUCCESS;
 
-	executor_executeTask(component->executor, component, component_addTask, dep);
+	executor_executeTask(component->executor, component, component_addTask, dep, DM_EXECUTOR_NO_WAIT);
 
     return status;
 }
@@ -285,7 +344,7 @@ celix_status_t component_removeServiceDependency(celix_dm_component_t *component
 celix_status_t celix_dmComponent_removeServiceDependency(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency) {
     celix_status_t status = CELIX_SUCCESS;
 
-    executor_executeTask(component->executor, component, component_removeTask, dependency);
+    executor_executeTask(component->executor, component, component_removeTask, dependency, DM_EXECUTOR_WAIT_FOR_TASK);
 
     return status;
 }
@@ -322,7 +381,7 @@ celix_status_t celix_private_dmComponent_start(celix_dm_component_t *component)
     celix_status_t status = CELIX_SUCCESS;
 
     component->active = true;
-    executor_executeTask(component->executor, component, component_startTask, NULL);
+    executor_executeTask(component->executor, component, component_startTask, NULL, DM_EXECUTOR_WAIT_FOR_TASK);
 
     return status;
 }
@@ -340,7 +399,8 @@ celix_status_t celix_private_dmComponent_stop(celix_dm_component_t *component) {
     celix_status_t status = CELIX_SUCCESS;
 
     component->active = false;
-    executor_executeTask(component->executor, component, component_stopTask, NULL);
+    //wait till idle, the component is normally destroyed after it is stopped
+    executor_executeTask(component->executor, component, component_stopTask, NULL, DM_EXECUTOR_WAIT_FOR_IDLE);
 
     return status;
 }
@@ -364,6 +424,14 @@ celix_status_t celix_dmComponent_setCLanguageProperty(celix_dm_component_t *comp
     return CELIX_SUCCESS;
 }
 
+celix_status_t celix_dmComponent_setServiceEventCoalescing(celix_dm_component_t *component, bool coalesce, long windowInMs) {
+    celixThreadMutex_lock(&component->mutex);
+    component->coalesceServiceEvents = coalesce;
+    component->coalesceWindowInMs = windowInMs;
+    celixThreadMutex_unlock(&component->mutex);
+    return CELIX_SUCCESS;
+}
+
 celix_status_t component_addInterface(celix_dm_component_t *component, const char* serviceName, const char* serviceVersion, const void* service, properties_pt properties) {
     return celix_dmComponent_addInterface(component, serviceName, serviceVersion, service, properties);
 }
@@ -471,7 +539,14 @@ celix_status_t celix_private_dmComponent_handleEvent(celix_dm_component_t *compo
 	data->event = event;
 	data->newEvent = NULL;
 
-	status = executor_executeTask(component->executor, component, component_handleEventTask, data);
+	if (component_coalesceEvent(component, data)) {
+	    return status;
+	}
+
+	//note that a removed service can only be unregistered after the component handled the removal
+	dm_executor_wait_mode_e waitMode = event->event_type == DM_EVENT_ADDED || event->event_type == DM_EVENT_CHANGED ?
+	        DM_EXECUTOR_NO_WAIT : DM_EXECUTOR_WAIT_FOR_TASK;
+	status = executor_executeTask(component->executor, component, component_handleEventTask, data, waitMode);
 //	component_handleEventTask(component, data);
 
 	return status;
@@ -502,6 +577,197 @@ static celix_status_t component_handleEventTask(celix_dm_component_t *component,
 	return status;
 }
 
+static void component_destroyEventBatch(dm_event_batch_t *batch) {
+    if (batch != NULL) {
+        for (int i = 0; i < celix_arrayList_size(batch->items); ++i) {
+            dm_handle_event_type_pt item = celix_arrayList_get(batch->items, i);
+            event_destroy(&item->event);
+            free(item);
+        }
+        celix_arrayList_destroy(batch->items);
+        free(batch);
+    }
+}
+
+/**
+ * Adds added and changed service events to the pending batch of the component, if service event coalescing is enabled.
+ * A removed service event for a service added in the pending batch cancels the added event.
+ * Other (removed, swapped) events close the pending batch, so that later events are handled after the removal.
+ * Returns true if the event is coalesced and should not be handled separately.
+ */
+static bool component_coalesceEvent(celix_dm_component_t *component, dm_handle_event_type_pt data) {
+    bool coalesced = false;
+    dm_event_batch_t *newBatch = NULL;
+    long windowInMs = 0;
+
+    celixThreadMutex_lock(&component->mutex);
+    if (component->coalesceServiceEvents) {
+        dm_event_batch_t *batch = component->pendingEventBatch;
+        dm_event_type_e type = data->event->event_type;
+        if (type == DM_EVENT_ADDED || type == DM_EVENT_CHANGED) {
+            if (batch == NULL) {
+                batch = calloc(1, sizeof(*batch));
+                batch->items = celix_arrayList_create();
+                clock_gettime(CLOCK_MONOTONIC, &batch->firstEventTime);
+                component->pendingEventBatch = batch;
+                newBatch = batch;
+                windowInMs = component->coalesceWindowInMs;
+            }
+            celix_arrayList_add(batch->items, data);
+            coalesced = true;
+        } else if (batch != NULL) {
+            bool addedInBatch = false;
+            for (int i = celix_arrayList_size(batch->items) - 1; i >= 0; --i) {
+                dm_handle_event_type_pt item = celix_arrayList_get(batch->items, i);
+                if (item->dependency == data->dependency && item->event->serviceId == data->event->serviceId) {
+                    addedInBatch = addedInBatch || item->event->event_type == DM_EVENT_ADDED;
+                    celix_arrayList_removeAt(batch->items, i);
+                    event_destroy(&item->event);
+                    free(item);
+                }
+            }
+            if (addedInBatch) {
+                //the component never saw the service, nothing to remove
+                event_destroy(&data->event);
+                free(data);
+                coalesced = true;
+            } else {
+                component->pendingEventBatch = NULL;
+            }
+        }
+    }
+    celixThreadMutex_unlock(&component->mutex);
+
+    if (newBatch != NULL && windowInMs > 0 && component->executor->pool != NULL) {
+        //give events arriving shortly after the first event the chance to join the batch.
+        //note only on the executor pool, without a pool the batch task runs on the calling (event) thread, so
+        //delaying would only delay that thread and no events can join the batch meanwhile
+        struct timespec runAfter = newBatch->firstEventTime;
+        runAfter.tv_sec += windowInMs / 1000;
+        runAfter.tv_nsec += (windowInMs % 1000) * 1000000L;
+        if (runAfter.tv_nsec >= 1000000000L) {
+            runAfter.tv_sec += 1;
+            runAfter.tv_nsec -= 1000000000L;
+        }
+        executor_executeTaskAfter(component->executor, component, component_handleEventBatchTask, newBatch, &runAfter);
+    } else if (newBatch != NULL) {
+        executor_executeTask(component->executor, component, component_handleEventBatchTask, newBatch, DM_EXECUTOR_NO_WAIT);
+    }
+    return coalesced;
+}
+
+/**
+ * Handles the added services of a dependency in a batch. In contrast with component_handleAdded the set callback
+ * is called once (with the highest ranking service) and the instance is updated once.
+ * Returns whether the component state should be recalculated.
+ */
+static bool component_handleAddedBatch(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency, celix_array_list_t *items) {
+    bool required = false;
+    serviceDependency_isRequired(dependency, &required);
+    bool instanceBound = false;
+    serviceDependency_isInstanceBound(dependency, &instanceBound);
+
+    dm_event_pt lastEvent = NULL;
+    for (int i = 0; i < celix_arrayList_size(items); ++i) {
+        dm_handle_event_type_pt item = celix_arrayList_get(items, i);
+        if (item->dependency == dependency && item->event != NULL && item->event->event_type == DM_EVENT_ADDED) {
+            lastEvent = item->event;
+        }
+    }
+
+    bool handleChange = false;
+    switch (component->state) {
+        case DM_CMP_STATE_WAITING_FOR_REQUIRED:
+            serviceDependency_invokeSet(dependency, lastEvent);
+            handleChange = required;
+            break;
+        case DM_CMP_STATE_INSTANTIATED_AND_WAITING_FOR_REQUIRED:
+        case DM_CMP_STATE_TRACKING_OPTIONAL: {
+            bool optional = component->state == DM_CMP_STATE_TRACKING_OPTIONAL;
+            if (optional || !instanceBound) {
+                if (optional) {
+                    component_suspend(component, dependency);
+                }
+                if (optional || required) {
+                    serviceDependency_invokeSet(dependency, lastEvent);
+                    for (int i = 0; i < celix_arrayList_size(items); ++i) {
+                        dm_handle_event_type_pt item = celix_arrayList_get(items, i);
+                        if (item->dependency == dependency && item->event != NULL && item->event->event_type == DM_EVENT_ADDED) {
+                            serviceDependency_invokeAdd(dependency, item->event);
+                        }
+                    }
+                }
+                if (optional) {
+                    component_resume(component, dependency);
+                }
+                dm_event_pt event = NULL;
+                component_getDependencyEvent(component, dependency, &event);
+                component_updateInstance(component, dependency, event, false, true);
+            }
+            handleChange = !optional && required;
+            break;
+        }
+        default:
+            break;
+    }
+    return handleChange;
+}
+
+static celix_status_t component_handleEventBatchTask(celix_dm_component_t *component, dm_event_batch_t *batch) {
+    celix_status_t status = CELIX_SUCCESS;
+
+    //close the batch and add the added services to the dependency events
+    celix_array_list_t *dependencies = celix_arrayList_create(); //dependencies with added services
+    celixThreadMutex_lock(&component->mutex);
+    if (component->pendingEventBatch == batch) {
+        component->pendingEventBatch = NULL;
+    }
+    for (int i = 0; i < celix_arrayList_size(batch->items); ++i) {
+        dm_handle_event_type_pt item = celix_arrayList_get(batch->items, i);
+        array_list_pt events = hashMap_get(component->dependencyEvents, item->dependency);
+        if (events == NULL) {
+            //dependency is already removed
+            event_destroy(&item->event);
+        } else if (item->event->event_type == DM_EVENT_ADDED) {
+            arrayList_add(events, item->event);
+            celix_array_list_entry_t entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.voidPtrVal = item->dependency;
+            if (celix_arrayList_indexOf(dependencies, entry) < 0) {
+                celix_arrayList_add(dependencies, item->dependency);
+            }
+        }
+    }
+    celixThreadMutex_unlock(&component->mutex);
+
+    bool handleChange = false;
+    for (int i = 0; i < celix_arrayList_size(dependencies); ++i) {
+        celix_dm_service_dependency_t *dependency = celix_arrayList_get(dependencies, i);
+        serviceDependency_setAvailable(dependency, true);
+    }
+    for (int i = 0; i < celix_arrayList_size(dependencies); ++i) {
+        celix_dm_service_dependency_t *dependency = celix_arrayList_get(dependencies, i);
+        if (component_handleAddedBatch(component, dependency, batch->items)) {
+            handleChange = true;
+        }
+    }
+    for (int i = 0; i < celix_arrayList_size(batch->items); ++i) {
+        dm_handle_event_type_pt item = celix_arrayList_get(batch->items, i);
+        if (item->event != NULL && item->event->event_type == DM_EVENT_CHANGED) {
+            component_handleChanged(component, item->dependency, item->event);
+        }
+        free(item);
+    }
+    if (handleChange) {
+        component_handleChange(component);
+    }
+
+    celix_arrayList_destroy(dependencies);
+    celix_arrayList_destroy(batch->items);
+    free(batch);
+    return status;
+}
+
 static celix_status_t component_suspend(celix_dm_component_t *component, celix_dm_service_dependency_t *dependency) {
 	celix_status_t status = CELIX_SUCCESS;
 
@@ -814,8 +1080,15 @@ static celix_status_t component_handleChange(celix_dm_component_t *component) {
         oldState = component->state;
         status = component_calculateNewState(component, oldState, &newState);
         if (status == CELIX_SUCCESS) {
+            struct timespec start;
+            clock_gettime(CLOCK_MONOTONIC, &start);
             component->state = newState;
             status = component_performTransition(component, oldState, newState, &transition);
+            if (transition) {
+                struct timespec end;
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                executor_addTransitionTime(component->executor, celix_difftime(&start, &end));
+            }
         }
 
         if (status != CELIX_SUCCESS) {
@@ -1337,13 +1610,19 @@ celix_bundle_context_t* celix_dmComponent_getBundleContext(celix_dm_component_t
 static celix_status_t executor_create(celix_dm_component_t *component __attribute__((unused)), dm_executor_pt *executor) {
     celix_status_t status = CELIX_SUCCESS;
 
-    *executor = malloc(sizeof(**executor));
+    *executor = calloc(1, sizeof(**executor));
     if (!*executor) {
         status = CELIX_ENOMEM;
     } else {
         (*executor)->workQueue = celix_arrayList_create();
         pthread_mutex_init(&(*executor)->mutex, NULL);
+        pthread_cond_init(&(*executor)->cond, NULL);
         (*executor)->runningThreadSet = false;
+        (*executor)->running = false;
+        if (component != NULL && component->context != NULL && component->context->framework != NULL) {
+            (*executor)->pool = component->context->framework->dmExecutorPool;
+            (*executor)->fw = component->context->framework;
+        }
     }
 
     return status;
@@ -1352,14 +1631,22 @@ static celix_status_t executor_create(celix_dm_component_t *component __attribut
 static void executor_destroy(dm_executor_pt executor) {
 
 	if (executor) {
+	    //ensure the (pool) thread running the tasks is done
+	    pthread_mutex_lock(&executor->mutex);
+	    while (executor->running && !(executor->runningThreadSet && pthread_equal(executor->runningThread, pthread_self()))) {
+	        pthread_cond_wait(&executor->cond, &executor->mutex);
+	    }
+	    pthread_mutex_unlock(&executor->mutex);
+
 		pthread_mutex_destroy(&executor->mutex);
+		pthread_cond_destroy(&executor->cond);
 		celix_arrayList_destroy(executor->workQueue);
 
 		free(executor);
 	}
 }
 
-static celix_status_t executor_schedule(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data) {
+static celix_status_t executor_schedule(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data, const struct timespec *runAfter, size_t *taskNr) {
     celix_status_t status = CELIX_SUCCESS;
 
     dm_executor_task_t *task = NULL;
@@ -1370,16 +1657,23 @@ static celix_status_t executor_schedule(dm_executor_pt executor, celix_dm_compon
         task->component = component;
         task->command = command;
         task->data = data;
+        clock_gettime(CLOCK_MONOTONIC, &task->scheduleTime);
+        task->delayed = runAfter != NULL;
+        if (runAfter != NULL) {
+            task->runAfter = *runAfter;
+        }
 
         pthread_mutex_lock(&executor->mutex);
         celix_arrayList_add(executor->workQueue, task);
+        executor->nrOfScheduledTasks += 1;
+        *taskNr = executor->nrOfScheduledTasks;
         pthread_mutex_unlock(&executor->mutex);
     }
 
     return status;
 }
 
-static celix_status_t executor_executeTask(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data) {
+static celix_status_t executor_executeTask(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data, dm_executor_wait_mode_e waitMode) {
     celix_status_t status = CELIX_SUCCESS;
 
     // Check thread and executor thread, if the same, execute immediately.
@@ -1392,66 +1686,154 @@ static celix_status_t executor_executeTask(dm_executor_pt executor, celix_dm_com
 //    pthread_mutex_unlock(&executor->mutex);
 
     // For now, just schedule.
-    executor_schedule(executor, component, command, data);
-    executor_execute(executor);
+    size_t taskNr = 0;
+    status = executor_schedule(executor, component, command, data, NULL, &taskNr);
+    if (status == CELIX_SUCCESS) {
+        executor_execute(executor, waitMode, taskNr);
+    }
 
     return status;
 }
 
-static celix_status_t executor_execute(dm_executor_pt executor) {
+/**
+ * Schedules a task which is not run by a pool thread before runAfter. Waiting for runAfter does not occupy a pool
+ * thread. Note a thread waiting for the tasks of the component runs the task directly.
+ */
+static celix_status_t executor_executeTaskAfter(dm_executor_pt executor, celix_dm_component_t *component, void (*command), void *data, const struct timespec *runAfter) {
+    size_t taskNr = 0;
+    celix_status_t status = executor_schedule(executor, component, command, data, runAfter, &taskNr);
+    if (status == CELIX_SUCCESS) {
+        executor_execute(executor, DM_EXECUTOR_NO_WAIT, taskNr);
+    }
+    return status;
+}
+
+static celix_status_t executor_execute(dm_executor_pt executor, dm_executor_wait_mode_e waitMode, size_t taskNr) {
     celix_status_t status = CELIX_SUCCESS;
     pthread_t currentThread = pthread_self();
 
     pthread_mutex_lock(&executor->mutex);
     bool execute = false;
-    if (!executor->runningThreadSet) {
-        executor->runningThread = currentThread;
-        executor->runningThreadSet = true;
-        execute = true;
+    bool submit = false;
+    if (!executor->running) {
+        executor->running = true;
+        if (executor->pool != NULL && waitMode == DM_EXECUTOR_NO_WAIT) {
+            //run the tasks on the executor pool, the pool thread will set the running thread
+            submit = true;
+        } else {
+            executor->runningThread = currentThread;
+            executor->runningThreadSet = true;
+            execute = true;
+        }
     }
+    bool runByCurrentThread = executor->runningThreadSet && pthread_equal(executor->runningThread, currentThread);
     pthread_mutex_unlock(&executor->mutex);
-    if (execute) {
-        executor_runTasks(executor, currentThread);
+
+    if (submit) {
+        celix_dmExecutorPool_submit(executor->pool, executor_runPoolJob, executor);
+    } else if (execute) {
+        executor_runTasks(executor, currentThread, false);
+    } else if (executor->pool != NULL && !runByCurrentThread && waitMode != DM_EXECUTOR_NO_WAIT) {
+        //tasks are run by another thread or are submitted to the executor pool. Note that a submitted job which is
+        //not yet taken by a pool thread is cancelled and the tasks are run by the calling thread instead, so that
+        //(pool) threads never wait for a pool thread to become available.
+        //A thread already running component tasks (or the framework event thread) does not block on the thread
+        //running the tasks of this component, because that thread could be waiting for it (AB-BA deadlock). The
+        //task is then left to the running thread, as is done without an executor pool.
+        bool mayBlock = g_currentExecutor == NULL &&
+                (executor->fw == NULL || !celixThread_equals(celixThread_self(), executor->fw->dispatcher.thread));
+        pthread_mutex_lock(&executor->mutex);
+        while (executor->nrOfDoneTasks < taskNr || (waitMode == DM_EXECUTOR_WAIT_FOR_IDLE && executor->running)) {
+            if (executor->running && !executor->runningThreadSet && celix_dmExecutorPool_cancel(executor->pool, executor_runPoolJob, executor)) {
+                executor->runningThread = currentThread;
+                executor->runningThreadSet = true;
+                pthread_mutex_unlock(&executor->mutex);
+                executor_runTasks(executor, currentThread, false);
+                pthread_mutex_lock(&executor->mutex);
+            } else if (mayBlock) {
+                pthread_cond_wait(&executor->cond, &executor->mutex);
+            } else {
+                break;
+            }
+        }
+        pthread_mutex_unlock(&executor->mutex);
     }
 
     return status;
 }
 
-static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t currentThread __attribute__((unused))) {
+static void executor_runPoolJob(void *data) {
+    dm_executor_pt executor = data;
+    pthread_t currentThread = pthread_self();
+    pthread_mutex_lock(&executor->mutex);
+    executor->runningThread = currentThread;
+    executor->runningThreadSet = true;
+    pthread_mutex_unlock(&executor->mutex);
+    executor_runTasks(executor, currentThread, true);
+}
+
+static celix_status_t executor_runTasks(dm_executor_pt executor, pthread_t currentThread __attribute__((unused)), bool honorDelay) {
     celix_status_t status = CELIX_SUCCESS;
-//    bool execute = false;
 
     dm_executor_task_t *entry = NULL;
+    dm_executor_pt previousExecutor = g_currentExecutor; //note tasks of another component can be run inline
+    g_currentExecutor = executor;
 
     pthread_mutex_lock(&executor->mutex);
-    if (celix_arrayList_size(executor->workQueue) > 0) {
-	    entry = celix_arrayList_get(executor->workQueue, 0);
-	    celix_arrayList_removeAt(executor->workQueue, 0);
-    }
-    pthread_mutex_unlock(&executor->mutex);
+    while (celix_arrayList_size(executor->workQueue) > 0) {
+        entry = celix_arrayList_get(executor->workQueue, 0);
+        if (honorDelay && entry->delayed) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            double remaining = celix_difftime(&now, &entry->runAfter);
+            if (remaining > 0) {
+                //the executor stays running and the tasks are continued by a delayed pool job. Note the job can be
+                //cancelled by a waiting thread, which then runs the tasks directly.
+                executor->runningThreadSet = false;
+                celix_dmExecutorPool_submitDelayed(executor->pool, executor_runPoolJob, executor, (long)(remaining * 1000.0) + 1);
+                pthread_cond_broadcast(&executor->cond);
+                pthread_mutex_unlock(&executor->mutex);
+                g_currentExecutor = previousExecutor;
+                return status;
+            }
+        }
+        celix_arrayList_removeAt(executor->workQueue, 0);
+        pthread_mutex_unlock(&executor->mutex);
 
-    while (entry != NULL) {
-	    entry->command(entry->component, entry->data);
-	    free(entry);
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        double latency = celix_difftime(&entry->scheduleTime, &start);
 
-	    pthread_mutex_lock(&executor->mutex);
-	    if (celix_arrayList_size(executor->workQueue) > 0) {
-		    entry = celix_arrayList_get(executor->workQueue, 0);
-		    celix_arrayList_removeAt(executor->workQueue, 0);
-	    } else {
-		    entry = NULL;
-	    }
-	    pthread_mutex_unlock(&executor->mutex);
-    }
+        entry->command(entry->component, entry->data);
+        free(entry);
 
-
-    pthread_mutex_lock(&executor->mutex);
+        pthread_mutex_lock(&executor->mutex);
+        executor->nrOfDoneTasks += 1;
+        executor->metrics.totalTaskLatency += latency;
+        if (latency > executor->metrics.maxTaskLatency) {
+            executor->metrics.maxTaskLatency = latency;
+        }
+        pthread_cond_broadcast(&executor->cond);
+    }
     executor->runningThreadSet = false;
+    executor->running = false;
+    pthread_cond_broadcast(&executor->cond);
     pthread_mutex_unlock(&executor->mutex);
 
+    g_currentExecutor = previousExecutor;
     return status;
 }
 
+static void executor_addTransitionTime(dm_executor_pt executor, double transitionTime) {
+    pthread_mutex_lock(&executor->mutex);
+    executor->metrics.nrOfTransitions += 1;
+    executor->metrics.totalTransitionTime += transitionTime;
+    if (transitionTime > executor->metrics.maxTransitionTime) {
+        executor->metrics.maxTransitionTime = transitionTime;
+    }
+    pthread_mutex_unlock(&executor->mutex);
+}
+
 celix_status_t component_getComponentInfo(celix_dm_component_t *component, dm_component_info_pt *out) {
     return celix_dmComponent_getComponentInfo(component, out);
 }
@@ -1473,6 +1855,19 @@ celix_status_t celix_dmComponent_getComponentInfo(celix_dm_component_t *componen
     memcpy(info->id, component->id, DM_COMPONENT_MAX_ID_LENGTH);
     memcpy(info->name, component->name, DM_COMPONENT_MAX_NAME_LENGTH);
 
+    pthread_mutex_lock(&component->executor->mutex);
+    info->nrOfTransitions = component->executor->metrics.nrOfTransitions;
+    info->nrOfTasks = component->executor->nrOfDoneTasks;
+    if (info->nrOfTransitions > 0) {
+        info->avgTransitionTimeInMs = component->executor->metrics.totalTransitionTime * 1000.0 / (double)info->nrOfTransitions;
+    }
+    info->maxTransitionTimeInMs = component->executor->metrics.maxTransitionTime * 1000.0;
+    if (info->nrOfTasks > 0) {
+        info->avgTaskLatencyInMs = component->executor->metrics.totalTaskLatency * 1000.0 / (double)info->nrOfTasks;
+    }
+    info->maxTaskLatencyInMs = component->executor->metrics.maxTaskLatency * 1000.0;
+    pthread_mutex_unlock(&component->executor->mutex);
+
     switch (component->state) {
         case DM_CMP_STATE_INACTIVE :
             info->state = strdup("INACTIVE");
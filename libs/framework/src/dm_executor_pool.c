@@ -0,0 +1,284 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#include "celix_threads.h"
+#include "celix_utils.h"
+#include "celix_array_list.h"
+#include "dm_executor_pool.h"
+
+typedef struct celix_dm_executor_job {
+    void (*job)(void *data);
+    void *data;
+} celix_dm_executor_job_t;
+
+typedef struct celix_dm_executor_delayed_job {
+    celix_dm_executor_job_t *job;
+    struct timespec dueTime; //monotonic
+} celix_dm_executor_delayed_job_t;
+
+typedef struct celix_dm_executor_worker {
+    celix_dm_executor_pool_t *pool;
+    int index;
+    celix_thread_t thread;
+    celix_thread_mutex_t mutex; //protects jobs
+    celix_array_list_t *jobs; //value = celix_dm_executor_job_t*
+} celix_dm_executor_worker_t;
+
+struct celix_dm_executor_pool {
+    int nrOfWorkers;
+    celix_dm_executor_worker_t *workers;
+
+    celix_thread_mutex_t sharedMutex; //protects sharedJobs
+    celix_array_list_t *sharedJobs; //value = celix_dm_executor_job_t*, jobs submitted from non worker threads
+
+    celix_thread_mutex_t mutex; //protects nrOfQueuedJobs, delayedJobs and running
+    celix_thread_cond_t cond;
+    size_t nrOfQueuedJobs;
+    celix_array_list_t *delayedJobs; //value = celix_dm_executor_delayed_job_t*, queued when due by a waiting worker
+    bool running;
+};
+
+static __thread celix_dm_executor_worker_t *g_currentWorker = NULL;
+
+static celix_dm_executor_job_t* celix_dmExecutorPool_takeFrom(celix_thread_mutex_t *mutex, celix_array_list_t *jobs, bool last) {
+    celix_dm_executor_job_t *job = NULL;
+    celixThreadMutex_lock(mutex);
+    int size = celix_arrayList_size(jobs);
+    if (size > 0) {
+        int index = last ? size - 1 : 0;
+        job = celix_arrayList_get(jobs, index);
+        celix_arrayList_removeAt(jobs, index);
+    }
+    celixThreadMutex_unlock(mutex);
+    return job;
+}
+
+static celix_dm_executor_job_t* celix_dmExecutorPool_take(celix_dm_executor_worker_t *worker) {
+    celix_dm_executor_pool_t *pool = worker->pool;
+
+    //own jobs, newest first
+    celix_dm_executor_job_t *job = celix_dmExecutorPool_takeFrom(&worker->mutex, worker->jobs, true);
+    if (job == NULL) {
+        job = celix_dmExecutorPool_takeFrom(&pool->sharedMutex, pool->sharedJobs, false);
+    }
+    for (int i = 1; job == NULL && i < pool->nrOfWorkers; ++i) {
+        //steal oldest job of another worker
+        celix_dm_executor_worker_t *victim = &pool->workers[(worker->index + i) % pool->nrOfWorkers];
+        job = celix_dmExecutorPool_takeFrom(&victim->mutex, victim->jobs, false);
+    }
+    if (job != NULL) {
+        celixThreadMutex_lock(&pool->mutex);
+        pool->nrOfQueuedJobs -= 1;
+        celixThreadMutex_unlock(&pool->mutex);
+    }
+    return job;
+}
+
+/**
+ * Moves the due (or if the pool is stopped all) delayed jobs to the shared queue.
+ * Note pool->mutex should be locked. Returns the seconds till the next delayed job is due or -1 if there is none.
+ */
+static double celix_dmExecutorPool_queueDueJobs(celix_dm_executor_pool_t *pool) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double next = -1.0;
+    for (int i = celix_arrayList_size(pool->delayedJobs) - 1; i >= 0; --i) {
+        celix_dm_executor_delayed_job_t *delayed = celix_arrayList_get(pool->delayedJobs, i);
+        double remaining = celix_difftime(&now, &delayed->dueTime);
+        if (remaining <= 0 || !pool->running) {
+            celixThreadMutex_lock(&pool->sharedMutex);
+            celix_arrayList_add(pool->sharedJobs, delayed->job);
+            celixThreadMutex_unlock(&pool->sharedMutex);
+            celix_arrayList_removeAt(pool->delayedJobs, i);
+            free(delayed);
+            pool->nrOfQueuedJobs += 1;
+        } else if (next < 0 || remaining < next) {
+            next = remaining;
+        }
+    }
+    return next;
+}
+
+static void* celix_dmExecutorPool_run(void *data) {
+    celix_dm_executor_worker_t *worker = data;
+    celix_dm_executor_pool_t *pool = worker->pool;
+    g_currentWorker = worker;
+
+    bool running = true;
+    while (running) {
+        celix_dm_executor_job_t *job = celix_dmExecutorPool_take(worker);
+        if (job != NULL) {
+            job->job(job->data);
+            free(job);
+        } else {
+            celixThreadMutex_lock(&pool->mutex);
+            double next = celix_dmExecutorPool_queueDueJobs(pool);
+            while (pool->nrOfQueuedJobs == 0 && pool->running) {
+                if (next < 0) {
+                    celixThreadCondition_wait(&pool->cond, &pool->mutex);
+                } else {
+                    long seconds = (long)next;
+                    long nanoseconds = (long)((next - (double)seconds) * 1000000000.0);
+                    celixThreadCondition_timedwaitRelative(&pool->cond, &pool->mutex, seconds, nanoseconds);
+                }
+                next = celix_dmExecutorPool_queueDueJobs(pool);
+            }
+            running = pool->nrOfQueuedJobs > 0 || pool->running;
+            celixThreadMutex_unlock(&pool->mutex);
+        }
+    }
+
+    g_currentWorker = NULL;
+    return NULL;
+}
+
+celix_dm_executor_pool_t* celix_dmExecutorPool_create(int nrOfThreads) {
+    if (nrOfThreads <= 0) {
+        return NULL;
+    }
+    celix_dm_executor_pool_t *pool = calloc(1, sizeof(*pool));
+    pool->nrOfWorkers = nrOfThreads;
+    pool->workers = calloc(nrOfThreads, sizeof(*pool->workers));
+    pool->sharedJobs = celix_arrayList_create();
+    pool->delayedJobs = celix_arrayList_create();
+    pool->running = true;
+    celixThreadMutex_create(&pool->sharedMutex, NULL);
+    celixThreadMutex_create(&pool->mutex, NULL);
+    celixThreadCondition_init(&pool->cond, NULL);
+
+    for (int i = 0; i < nrOfThreads; ++i) {
+        celix_dm_executor_worker_t *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->index = i;
+        worker->jobs = celix_arrayList_create();
+        celixThreadMutex_create(&worker->mutex, NULL);
+    }
+    for (int i = 0; i < nrOfThreads; ++i) {
+        celixThread_create(&pool->workers[i].thread, NULL, celix_dmExecutorPool_run, &pool->workers[i]);
+        celixThread_setName(&pool->workers[i].thread, "CelixDmExecutor");
+    }
+    return pool;
+}
+
+void celix_dmExecutorPool_destroy(celix_dm_executor_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+    celixThreadMutex_lock(&pool->mutex);
+    pool->running = false;
+    celixThreadCondition_broadcast(&pool->cond);
+    celixThreadMutex_unlock(&pool->mutex);
+
+    for (int i = 0; i < pool->nrOfWorkers; ++i) {
+        celixThread_join(pool->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < pool->nrOfWorkers; ++i) {
+        celixThreadMutex_destroy(&pool->workers[i].mutex);
+        celix_arrayList_destroy(pool->workers[i].jobs);
+    }
+    free(pool->workers);
+    celixThreadMutex_destroy(&pool->sharedMutex);
+    celix_arrayList_destroy(pool->sharedJobs);
+    celix_arrayList_destroy(pool->delayedJobs);
+    celixThreadMutex_destroy(&pool->mutex);
+    celixThreadCondition_destroy(&pool->cond);
+    free(pool);
+}
+
+void celix_dmExecutorPool_submit(celix_dm_executor_pool_t *pool, void (*job)(void *data), void *data) {
+    celix_dm_executor_job_t *entry = malloc(sizeof(*entry));
+    entry->job = job;
+    entry->data = data;
+
+    celix_dm_executor_worker_t *worker = g_currentWorker;
+    if (worker != NULL && worker->pool == pool) {
+        celixThreadMutex_lock(&worker->mutex);
+        celix_arrayList_add(worker->jobs, entry);
+        celixThreadMutex_unlock(&worker->mutex);
+    } else {
+        celixThreadMutex_lock(&pool->sharedMutex);
+        celix_arrayList_add(pool->sharedJobs, entry);
+        celixThreadMutex_unlock(&pool->sharedMutex);
+    }
+
+    celixThreadMutex_lock(&pool->mutex);
+    pool->nrOfQueuedJobs += 1;
+    celixThreadCondition_signal(&pool->cond);
+    celixThreadMutex_unlock(&pool->mutex);
+}
+
+void celix_dmExecutorPool_submitDelayed(celix_dm_executor_pool_t *pool, void (*job)(void *data), void *data, long delayInMs) {
+    celix_dm_executor_delayed_job_t *delayed = malloc(sizeof(*delayed));
+    delayed->job = malloc(sizeof(*delayed->job));
+    delayed->job->job = job;
+    delayed->job->data = data;
+    clock_gettime(CLOCK_MONOTONIC, &delayed->dueTime);
+    delayed->dueTime.tv_sec += delayInMs / 1000;
+    delayed->dueTime.tv_nsec += (delayInMs % 1000) * 1000000L;
+    if (delayed->dueTime.tv_nsec >= 1000000000L) {
+        delayed->dueTime.tv_sec += 1;
+        delayed->dueTime.tv_nsec -= 1000000000L;
+    }
+
+    celixThreadMutex_lock(&pool->mutex);
+    celix_arrayList_add(pool->delayedJobs, delayed);
+    //note wake up a worker, so that the wait timeout is updated for the new delayed job
+    celixThreadCondition_signal(&pool->cond);
+    celixThreadMutex_unlock(&pool->mutex);
+}
+
+static bool celix_dmExecutorPool_removeFrom(celix_thread_mutex_t *mutex, celix_array_list_t *jobs, void (*job)(void *data), void *data) {
+    bool removed = false;
+    celixThreadMutex_lock(mutex);
+    for (int i = 0; !removed && i < celix_arrayList_size(jobs); ++i) {
+        celix_dm_executor_job_t *entry = celix_arrayList_get(jobs, i);
+        if (entry->job == job && entry->data == data) {
+            celix_arrayList_removeAt(jobs, i);
+            free(entry);
+            removed = true;
+        }
+    }
+    celixThreadMutex_unlock(mutex);
+    return removed;
+}
+
+bool celix_dmExecutorPool_cancel(celix_dm_executor_pool_t *pool, void (*job)(void *data), void *data) {
+    bool removed = celix_dmExecutorPool_removeFrom(&pool->sharedMutex, pool->sharedJobs, job, data);
+    for (int i = 0; !removed && i < pool->nrOfWorkers; ++i) {
+        removed = celix_dmExecutorPool_removeFrom(&pool->workers[i].mutex, pool->workers[i].jobs, job, data);
+    }
+    celixThreadMutex_lock(&pool->mutex);
+    if (removed) {
+        pool->nrOfQueuedJobs -= 1;
+    }
+    for (int i = 0; !removed && i < celix_arrayList_size(pool->delayedJobs); ++i) {
+        celix_dm_executor_delayed_job_t *delayed = celix_arrayList_get(pool->delayedJobs, i);
+        if (delayed->job->job == job && delayed->job->data == data) {
+            celix_arrayList_removeAt(pool->delayedJobs, i);
+            free(delayed->job);
+            free(delayed);
+            removed = true;
+        }
+    }
+    celixThreadMutex_unlock(&pool->mutex);
+    return removed;
+}
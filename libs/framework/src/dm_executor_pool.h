@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef CELIX_DM_EXECUTOR_POOL_H_
+#define CELIX_DM_EXECUTOR_POOL_H_
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Thread pool shared by the dependency manager components of a framework.
+ *
+ * Components submit a job (draining their own task queue) when tasks are scheduled for an idle component. A component
+ * is submitted at most once at a time, which keeps the transitions of a single component serial while the transitions
+ * of independent components run in parallel.
+ *
+ * Every worker has its own job queue. Jobs submitted from a worker thread are added to the queue of that worker,
+ * jobs submitted from other threads are added to a shared queue. Idle workers first take jobs from their own queue,
+ * then from the shared queue and then steal jobs from the queues of the other workers.
+ */
+typedef struct celix_dm_executor_pool celix_dm_executor_pool_t;
+
+/**
+ * Creates a pool with the provided nr of worker threads. Returns NULL if nrOfThreads <= 0.
+ */
+celix_dm_executor_pool_t* celix_dmExecutorPool_create(int nrOfThreads);
+
+/**
+ * Waits till all submitted jobs are done, stops the worker threads and destroys the pool.
+ */
+void celix_dmExecutorPool_destroy(celix_dm_executor_pool_t *pool);
+
+/**
+ * Submits a job to the pool.
+ */
+void celix_dmExecutorPool_submit(celix_dm_executor_pool_t *pool, void (*job)(void *data), void *data);
+
+/**
+ * Submits a job to the pool, which is queued when the delay has passed. Waiting for the delay does not occupy
+ * a worker thread.
+ */
+void celix_dmExecutorPool_submitDelayed(celix_dm_executor_pool_t *pool, void (*job)(void *data), void *data, long delayInMs);
+
+/**
+ * Removes a submitted (or delayed) job from the pool if it is not yet taken by a worker thread.
+ * Returns true if the job is removed and will not be run by the pool.
+ */
+bool celix_dmExecutorPool_cancel(celix_dm_executor_pool_t *pool, void (*job)(void *data), void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CELIX_DM_EXECUTOR_POOL_H_
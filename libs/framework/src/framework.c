@@ -24,7 +24,13 @@
 #include "celixbool.h"
 #include <uuid/uuid.h>
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <celix_log_utils.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
 
 #include "celix_dependency_manager.h"
 #include "framework_private.h"
@@ -40,6 +46,7 @@
 #include "service_tracker.h"
 #include "celix_library_loader.h"
 #include "celix_log_constants.h"
+#include "celix_utils.h"
 
 typedef celix_status_t (*create_function_fp)(bundle_context_t *context, void **userData);
 typedef celix_status_t (*start_function_fp)(void *userData, bundle_context_t *context);
@@ -162,6 +169,10 @@ celix_status_t fw_populateDependentGraph(framework_pt framework, bundle_pt expor
 celix_status_t fw_fireBundleEvent(framework_pt framework, bundle_event_type_e, celix_framework_bundle_entry_t* entry);
 celix_status_t fw_fireFrameworkEvent(framework_pt framework, framework_event_type_e eventType, celix_status_t errorCode);
 static void *fw_eventDispatcher(void *fw);
+static celix_status_t fw_createDispatcherWakeup(celix_framework_t *framework);
+static void fw_wakeupDispatcher(celix_framework_t *framework);
+static void fw_queueRequest(celix_framework_t *framework, struct request *request);
+static void fw_cancelQueuedRequest(celix_framework_t *framework);
 
 celix_status_t fw_invokeBundleListener(framework_pt framework, bundle_listener_pt listener, bundle_event_pt event, bundle_pt bundle);
 celix_status_t fw_invokeFrameworkListener(framework_pt framework, framework_listener_pt listener, framework_event_pt event, bundle_pt bundle);
@@ -169,6 +180,8 @@ celix_status_t fw_invokeFrameworkListener(framework_pt framework, framework_list
 static celix_status_t framework_loadBundleLibraries(framework_pt framework, bundle_pt bundle);
 static celix_status_t framework_loadLibraries(framework_pt framework, const char* libraries, const char* activator, bundle_archive_pt archive, void **activatorHandle);
 static celix_status_t framework_loadLibrary(framework_pt framework, const char* library, bundle_archive_pt archive, void **handle);
+static celix_status_t framework_getLibraryPath(bundle_archive_pt archive, const char *library, char *libraryPath, size_t libraryPathSize);
+static char* resolveBundleLocation(celix_framework_t *fw, const char *bndLoc, const char *p);
 
 static celix_status_t frameworkActivator_start(void * userData, bundle_context_t *context);
 static celix_status_t frameworkActivator_stop(void * userData, bundle_context_t *context);
@@ -177,6 +190,32 @@ static celix_status_t frameworkActivator_destroy(void * userData, bundle_context
 static void framework_autoStartConfiguredBundles(bundle_context_t *fwCtx);
 static void framework_autoInstallConfiguredBundlesForList(bundle_context_t *fwCtx, const char *autoStart, celix_array_list_t *installedBundles);
 static void framework_autoStartConfiguredBundlesForList(bundle_context_t *fwCtx, const celix_array_list_t *installedBundles);
+static void framework_autoPrepareConfiguredBundlesForList(bundle_context_t *fwCtx, const char *autoStart, celix_array_list_t *jobs);
+static void framework_autoPrepareBundles(bundle_context_t *fwCtx, const celix_array_list_t *jobs);
+static void framework_autoInstallPreparedBundles(bundle_context_t *fwCtx, const celix_array_list_t *jobs, celix_array_list_t *installedBundles);
+static void framework_autoDestroyPreparedBundles(const celix_array_list_t *jobs);
+
+/**
+ * A bundle prepared by the parallel auto start.
+ * The archive is created by a worker thread, the bundle libraries are then preloaded by the framework thread.
+ * The preloaded library handles only keep the libraries loaded until the bundle is started by the framework,
+ * which loads them again.
+ */
+typedef struct celix_framework_auto_start_job {
+    char *location; //resolved bundle location
+    long bndId; //reserved bundle id or -1 if the bundle is not prepared
+    bundle_archive_pt archive;
+    celix_status_t status;
+    celix_array_list_t *preloadedHandles;
+    double installDurationInMs;
+    double loadDurationInMs;
+} celix_framework_auto_start_job_t;
+
+typedef struct celix_framework_auto_start_pool {
+    celix_framework_t *fw;
+    const celix_array_list_t *jobs;
+    int nextJob; //atomic
+} celix_framework_auto_start_pool_t;
 
 struct fw_refreshHelper {
     framework_pt framework;
@@ -255,6 +294,9 @@ struct request {
 
 	char *filter;
 	celix_framework_bundle_entry_t* bndEntry;
+
+	struct timespec firedTime;
+	struct request *next; //next request in the dispatcher queue
 };
 
 typedef struct request request_t;
@@ -276,20 +318,24 @@ celix_status_t framework_create(framework_pt *framework, properties_pt config) {
         status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->bundleListenerLock, NULL));
         status = CELIX_DO_IF(status, celixThreadMutex_create(&(*framework)->installedBundles.mutex, NULL));
         status = CELIX_DO_IF(status, celixThreadCondition_init(&(*framework)->dispatcher.cond, NULL));
+        status = CELIX_DO_IF(status, fw_createDispatcherWakeup(*framework));
         if (status == CELIX_SUCCESS) {
             (*framework)->bundle = NULL;
             (*framework)->registry = NULL;
             (*framework)->shutdown.done = false;
             (*framework)->shutdown.initialized = false;
             (*framework)->dispatcher.active = true;
+            (*framework)->dispatcher.pending = NULL;
+            (*framework)->dispatcher.queueSize = 0;
+            (*framework)->dispatcher.maxQueueSize = 0;
+            (*framework)->dispatcher.waiting = false;
+            memset(&(*framework)->dispatcher.stats, 0, sizeof((*framework)->dispatcher.stats));
             (*framework)->nextBundleId = 1L; //system bundle is 0
             (*framework)->cache = NULL;
             (*framework)->installRequestMap = hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
             (*framework)->installedBundles.entries = celix_arrayList_create();
             (*framework)->bundleListeners = NULL;
             (*framework)->frameworkListeners = NULL;
-            (*framework)->dispatcher.requests = NULL;
-            (*framework)->dispatcher.nrOfLocalRequest = 0;
             (*framework)->configurationMap = config;
 
             const char* logStr = getenv(CELIX_LOGGING_DEFAULT_ACTIVE_LOG_LEVEL_CONFIG_NAME);
@@ -298,6 +344,12 @@ celix_status_t framework_create(framework_pt *framework, properties_pt config) {
             }
             (*framework)->logger = celix_frameworkLogger_create(celix_logUtils_logLevelFromString(logStr, CELIX_LOG_LEVEL_INFO));
 
+            long nrOfDmThreads = celix_properties_getAsLong(config, CELIX_DM_EXECUTOR_NR_OF_THREADS, CELIX_DM_EXECUTOR_NR_OF_THREADS_DEFAULT);
+            (*framework)->dmExecutorPool = celix_dmExecutorPool_create((int)nrOfDmThreads);
+            if ((*framework)->dmExecutorPool != NULL) {
+                fw_log((*framework)->logger, CELIX_LOG_LEVEL_DEBUG, "Using a dependency manager executor pool with %li threads", nrOfDmThreads);
+            }
+
             status = CELIX_DO_IF(status, bundle_create(&(*framework)->bundle));
             status = CELIX_DO_IF(status, bundle_getBundleId((*framework)->bundle, &(*framework)->bundleId));
             status = CELIX_DO_IF(status, bundle_setFramework((*framework)->bundle, (*framework)));
@@ -340,10 +392,8 @@ celix_status_t framework_destroy(framework_pt framework) {
         if (count > 0) {
             const char *bndName = celix_bundle_getSymbolicName(bnd);
             fw_log(framework->logger, CELIX_LOG_LEVEL_FATAL, "Cannot destroy framework. The use count of bundle %s (bnd id %li) is not 0, but %u.", bndName, entry->bndId, count);
-            celixThreadMutex_lock(&framework->dispatcher.mutex);
-            int nrOfRequests = celix_arrayList_size(framework->dispatcher.requests);
-            celixThreadMutex_unlock(&framework->dispatcher.mutex);
-            fw_log(framework->logger, CELIX_LOG_LEVEL_WARNING, "nr of request left: %i (should be 0).", nrOfRequests);
+            size_t nrOfRequests = __atomic_load_n(&framework->dispatcher.queueSize, __ATOMIC_ACQUIRE);
+            fw_log(framework->logger, CELIX_LOG_LEVEL_WARNING, "nr of request left: %zu (should be 0).", nrOfRequests);
         }
         fw_bundleEntry_destroy(entry, true);
 
@@ -378,6 +428,8 @@ celix_status_t framework_destroy(framework_pt framework) {
     celix_arrayList_destroy(framework->installedBundles.entries);
     celixThreadMutex_destroy(&framework->installedBundles.mutex);
 
+    celix_dmExecutorPool_destroy(framework->dmExecutorPool);
+
 	hashMap_destroy(framework->installRequestMap, false, false);
 
     if (framework->bundleListeners) {
@@ -387,8 +439,11 @@ celix_status_t framework_destroy(framework_pt framework) {
         arrayList_destroy(framework->frameworkListeners);
     }
 
-    assert(celix_arrayList_size(framework->dispatcher.requests) == 0);
-    celix_arrayList_destroy(framework->dispatcher.requests);
+    assert(framework->dispatcher.pending == NULL);
+    close(framework->dispatcher.wakeupReadFd);
+    if (framework->dispatcher.wakeupWriteFd != framework->dispatcher.wakeupReadFd) {
+        close(framework->dispatcher.wakeupWriteFd);
+    }
 
 	bundleCache_destroy(&framework->cache);
 
@@ -428,7 +483,6 @@ celix_status_t fw_init(framework_pt framework) {
 	celix_status_t status = CELIX_SUCCESS;
 	status = CELIX_DO_IF(status, arrayList_create(&framework->bundleListeners));
 	status = CELIX_DO_IF(status, arrayList_create(&framework->frameworkListeners));
-	status = CELIX_DO_IF(status, arrayList_create(&framework->dispatcher.requests));
 	status = CELIX_DO_IF(status, celixThread_create(&framework->dispatcher.thread, NULL, fw_eventDispatcher, framework));
 	status = CELIX_DO_IF(status, bundle_getState(framework->bundle, &state));
 	if (status == CELIX_SUCCESS) {
@@ -588,18 +642,45 @@ celix_status_t framework_start(framework_pt framework) {
 static void framework_autoStartConfiguredBundles(bundle_context_t *fwCtx) {
     const char* cosgiKeys[] = {"cosgi.auto.start.0","cosgi.auto.start.1","cosgi.auto.start.2","cosgi.auto.start.3","cosgi.auto.start.4","cosgi.auto.start.5","cosgi.auto.start.6"};
     const char* celixKeys[] = {CELIX_AUTO_START_0, CELIX_AUTO_START_1, CELIX_AUTO_START_2, CELIX_AUTO_START_3, CELIX_AUTO_START_4, CELIX_AUTO_START_5, CELIX_AUTO_START_6};
+    bool parallel = celix_bundleContext_getPropertyAsBool(fwCtx, CELIX_AUTO_START_PARALLEL, CELIX_AUTO_START_PARALLEL_DEFAULT);
     celix_array_list_t *installedBundles = celix_arrayList_create();
+    celix_array_list_t *jobs = parallel ? celix_arrayList_create() : NULL;
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
     size_t len = 7;
     for (int i = 0; i < len; ++i) {
         const char *autoStart = celix_bundleContext_getProperty(fwCtx, celixKeys[i], NULL);
         if (autoStart == NULL) {
             autoStart = celix_bundleContext_getProperty(fwCtx, cosgiKeys[i], NULL);
         }
-        if (autoStart != NULL) {
+        if (autoStart != NULL && parallel) {
+            framework_autoPrepareConfiguredBundlesForList(fwCtx, autoStart, jobs);
+        } else if (autoStart != NULL) {
             framework_autoInstallConfiguredBundlesForList(fwCtx, autoStart, installedBundles);
         }
     }
+    if (parallel) {
+        framework_autoPrepareBundles(fwCtx, jobs);
+        framework_autoInstallPreparedBundles(fwCtx, jobs, installedBundles);
+    }
     framework_autoStartConfiguredBundlesForList(fwCtx, installedBundles);
+    if (parallel) {
+        framework_autoDestroyPreparedBundles(jobs);
+        celix_arrayList_destroy(jobs);
+    }
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int nrOfBundles = celix_arrayList_size(installedBundles);
+    if (nrOfBundles > 0) {
+        fw_log(fwCtx->framework->logger, CELIX_LOG_LEVEL_INFO, "Auto started %i bundles in %.3f ms%s", nrOfBundles, celix_difftime(&begin, &end) * 1000.0, parallel ? " (parallel)" : "");
+        for (int i = 0; i < nrOfBundles; ++i) {
+            const celix_bundle_t *bnd = celix_arrayList_get(installedBundles, i);
+            celix_bundle_startup_timing_t timing = celix_bundle_getStartupTiming(bnd);
+            fw_log(fwCtx->framework->logger, CELIX_LOG_LEVEL_DEBUG, "Bundle %s [%li] install %.3f ms, load %.3f ms, start %.3f ms",
+                   celix_bundle_getSymbolicName(bnd), celix_bundle_getId(bnd), timing.installDurationInMs, timing.loadDurationInMs, timing.startDurationInMs);
+        }
+    }
     celix_arrayList_destroy(installedBundles);
 }
 
@@ -626,6 +707,185 @@ static void framework_autoInstallConfiguredBundlesForList(bundle_context_t *fwCt
     free(autoStart);
 }
 
+static void framework_autoPrepareConfiguredBundlesForList(bundle_context_t *fwCtx, const char *autoStartIn, celix_array_list_t *jobs) {
+    celix_framework_t *fw = fwCtx->framework;
+    const char *paths = NULL;
+    fw_getProperty(fw, CELIX_BUNDLES_PATH_NAME, CELIX_BUNDLES_PATH_DEFAULT, &paths);
+
+    char delims[] = " ";
+    char *save_ptr = NULL;
+    char *autoStart = celix_utils_strdup(autoStartIn);
+
+    if (autoStart != NULL) {
+        char *location = strtok_r(autoStart, delims, &save_ptr);
+        while (location != NULL) {
+            char *resolvedLocation = resolveBundleLocation(fw, location, paths);
+            if (resolvedLocation == NULL) {
+                fw_log(fw->logger, CELIX_LOG_LEVEL_WARNING, "Cannot find bundle %s. Using %s=%s", location, CELIX_BUNDLES_PATH_NAME, paths);
+                printf("Could not install bundle '%s'\n", location);
+            } else {
+                //ids are reserved in the configured order, so bundle ids are the same as for a sequential auto start
+                bool prepare = framework_getBundle(fw, resolvedLocation) == NULL;
+                for (int i = 0; prepare && i < celix_arrayList_size(jobs); ++i) {
+                    celix_framework_auto_start_job_t *other = celix_arrayList_get(jobs, i);
+                    prepare = strcmp(other->location, resolvedLocation) != 0;
+                }
+                celix_framework_auto_start_job_t *job = calloc(1, sizeof(*job));
+                job->location = resolvedLocation;
+                job->bndId = prepare ? framework_getNextBundleId(fw) : -1L;
+                job->status = CELIX_SUCCESS;
+                job->preloadedHandles = celix_arrayList_create();
+                celix_arrayList_add(jobs, job);
+            }
+            location = strtok_r(NULL, delims, &save_ptr);
+        }
+    }
+    free(autoStart);
+}
+
+static void framework_autoPrepareBundle(celix_framework_auto_start_pool_t *pool, celix_framework_auto_start_job_t *job) {
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    job->status = bundleCache_createArchive(pool->fw->cache, job->bndId, job->location, NULL, &job->archive);
+    if (job->status != CELIX_SUCCESS) {
+        bundleArchive_destroy(job->archive);
+        job->archive = NULL;
+    }
+    struct timespec archived;
+    clock_gettime(CLOCK_MONOTONIC, &archived);
+    job->installDurationInMs = celix_difftime(&begin, &archived) * 1000.0;
+}
+
+/**
+ * Preloads the bundle libraries of a prepared bundle.
+ * Note called on the framework thread in the configured order, so that library constructors run in the same order
+ * and on the same thread as for a sequential auto start.
+ */
+static void framework_autoPreloadBundleLibraries(bundle_context_t *fwCtx, celix_framework_auto_start_job_t *job) {
+    struct timespec begin;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    bundle_revision_pt revision = NULL;
+    manifest_pt manifest = NULL;
+    celix_status_t status = job->status;
+    status = CELIX_DO_IF(status, bundleArchive_getCurrentRevision(job->archive, &revision));
+    status = CELIX_DO_IF(status, bundleRevision_getManifest(revision, &manifest));
+    if (status == CELIX_SUCCESS) {
+        //preloading is best effort, load errors are reported when the bundle is resolved
+        const char *libraryHeaders[] = {OSGI_FRAMEWORK_EXPORT_LIBRARY, OSGI_FRAMEWORK_PRIVATE_LIBRARY};
+        for (int i = 0; i < 2; ++i) {
+            const char *value = manifest_getValue(manifest, libraryHeaders[i]);
+            char *libraries = value == NULL ? NULL : celix_utils_strdup(value);
+            char *last = NULL;
+            char *token = libraries == NULL ? NULL : strtok_r(libraries, ",", &last);
+            while (token != NULL) {
+                char *savePtr = NULL;
+                char *lib = utils_stringTrim(strtok_r(token, ";", &savePtr));
+                char libraryPath[256];
+                if (framework_getLibraryPath(job->archive, lib, libraryPath, sizeof(libraryPath)) == CELIX_SUCCESS) {
+                    celix_library_handle_t *handle = celix_libloader_open(fwCtx, libraryPath);
+                    if (handle != NULL) {
+                        celix_arrayList_add(job->preloadedHandles, handle);
+                    }
+                }
+                token = strtok_r(NULL, ",", &last);
+            }
+            free(libraries);
+        }
+    }
+    struct timespec loaded;
+    clock_gettime(CLOCK_MONOTONIC, &loaded);
+    job->loadDurationInMs = celix_difftime(&begin, &loaded) * 1000.0;
+}
+
+static void* framework_autoPrepareBundlesThread(void *data) {
+    celix_framework_auto_start_pool_t *pool = data;
+    int size = celix_arrayList_size(pool->jobs);
+    int i = __atomic_fetch_add(&pool->nextJob, 1, __ATOMIC_RELAXED);
+    while (i < size) {
+        celix_framework_auto_start_job_t *job = celix_arrayList_get(pool->jobs, i);
+        if (job->bndId >= 0) {
+            framework_autoPrepareBundle(pool, job);
+        }
+        i = __atomic_fetch_add(&pool->nextJob, 1, __ATOMIC_RELAXED);
+    }
+    return NULL;
+}
+
+static void framework_autoPrepareBundles(bundle_context_t *fwCtx, const celix_array_list_t *jobs) {
+    celix_framework_auto_start_pool_t pool;
+    pool.fw = fwCtx->framework;
+    pool.jobs = jobs;
+    pool.nextJob = 0;
+
+    long nrOfThreads = celix_bundleContext_getPropertyAsLong(fwCtx, CELIX_AUTO_START_PARALLEL_NR_OF_THREADS, CELIX_AUTO_START_PARALLEL_NR_OF_THREADS_DEFAULT);
+    if (nrOfThreads <= 0) {
+        nrOfThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (nrOfThreads > celix_arrayList_size(jobs)) {
+        nrOfThreads = celix_arrayList_size(jobs);
+    }
+
+    //the calling thread is also used as worker
+    celix_thread_t threads[nrOfThreads > 1 ? nrOfThreads - 1 : 1];
+    int nrOfStartedThreads = 0;
+    for (long i = 0; i < nrOfThreads - 1; ++i) {
+        if (celixThread_create(&threads[nrOfStartedThreads], NULL, framework_autoPrepareBundlesThread, &pool) == CELIX_SUCCESS) {
+            celixThread_setName(&threads[nrOfStartedThreads], "CelixAutoStart");
+            nrOfStartedThreads += 1;
+        }
+    }
+    framework_autoPrepareBundlesThread(&pool);
+    for (int i = 0; i < nrOfStartedThreads; ++i) {
+        celixThread_join(threads[i], NULL);
+    }
+
+    //dlopen is not parallelized, library constructors can depend on the load order
+    for (int i = 0; i < celix_arrayList_size(jobs); ++i) {
+        celix_framework_auto_start_job_t *job = celix_arrayList_get(jobs, i);
+        if (job->archive != NULL) {
+            framework_autoPreloadBundleLibraries(fwCtx, job);
+        }
+    }
+    fw_log(fwCtx->framework->logger, CELIX_LOG_LEVEL_DEBUG, "Prepared %i auto start bundles using %i threads", celix_arrayList_size(jobs), nrOfStartedThreads + 1);
+}
+
+static void framework_autoInstallPreparedBundles(bundle_context_t *fwCtx, const celix_array_list_t *jobs, celix_array_list_t *installedBundles) {
+    for (int i = 0; i < celix_arrayList_size(jobs); ++i) {
+        celix_framework_auto_start_job_t *job = celix_arrayList_get(jobs, i);
+        bundle_t *bnd = NULL;
+        celix_status_t rc = job->status;
+        if (rc == CELIX_SUCCESS) {
+            //note if the bundle is not prepared (archive is NULL), the bundle is installed as usual
+            rc = fw_installBundle2(fwCtx->framework, &bnd, job->bndId, job->location, NULL, job->archive);
+        }
+        if (rc == CELIX_SUCCESS && job->archive != NULL) {
+            bnd->startupTiming.installDurationInMs = job->installDurationInMs;
+            bnd->startupTiming.loadDurationInMs = job->loadDurationInMs;
+            bnd->startupTiming.preparedInParallel = true;
+        }
+        if (rc == CELIX_SUCCESS) {
+            celix_arrayList_add(installedBundles, bnd);
+        } else {
+            if (rc == CELIX_FRAMEWORK_SHUTDOWN && job->archive != NULL) {
+                bundleArchive_closeAndDelete(job->archive);
+            }
+            printf("Could not install bundle '%s'\n", job->location);
+        }
+    }
+}
+
+static void framework_autoDestroyPreparedBundles(const celix_array_list_t *jobs) {
+    for (int i = 0; i < celix_arrayList_size(jobs); ++i) {
+        celix_framework_auto_start_job_t *job = celix_arrayList_get(jobs, i);
+        for (int k = 0; k < celix_arrayList_size(job->preloadedHandles); ++k) {
+            celix_libloader_close(celix_arrayList_get(job->preloadedHandles, k));
+        }
+        celix_arrayList_destroy(job->preloadedHandles);
+        free(job->location);
+        free(job);
+    }
+}
+
 static void framework_autoStartConfiguredBundlesForList(bundle_context_t *fwCtx, const celix_array_list_t *installedBundles) {
     for (int i = 0; i < celix_arrayList_size(installedBundles); ++i) {
         long bndId = -1;
@@ -739,10 +999,16 @@ celix_status_t fw_installBundle2(framework_pt framework, bundle_pt * bundle, lon
             return CELIX_SUCCESS;
         }
 
+        double installDurationInMs = 0.0;
         if (archive == NULL) {
             id = framework_getNextBundleId(framework);
 
+            struct timespec installBegin;
+            clock_gettime(CLOCK_MONOTONIC, &installBegin);
             status = CELIX_DO_IF(status, bundleCache_createArchive(framework->cache, id, location, inputFile, &archive));
+            struct timespec installEnd;
+            clock_gettime(CLOCK_MONOTONIC, &installEnd);
+            installDurationInMs = celix_difftime(&installBegin, &installEnd) * 1000.0;
 
             if (status != CELIX_SUCCESS) {
             	bundleArchive_destroy(archive);
@@ -757,6 +1023,7 @@ celix_status_t fw_installBundle2(framework_pt framework, bundle_pt * bundle, lon
         }
 
         if (status == CELIX_SUCCESS) {
+            (*bundle)->startupTiming.installDurationInMs = installDurationInMs;
             long bndId = -1L;
             bundle_getBundleId(*bundle, &bndId);
             celix_framework_bundle_entry_t *bEntry = fw_bundleEntry_create(*bundle);
@@ -908,6 +1175,8 @@ celix_status_t fw_startBundle(framework_pt framework, long bndId, int options __
 
                         status = CELIX_DO_IF(status, bundle_getContext(entry->bnd, &context));
 
+                        struct timespec startBegin;
+                        clock_gettime(CLOCK_MONOTONIC, &startBegin);
                         if (status == CELIX_SUCCESS) {
                             if (create != NULL) {
                                 status = CELIX_DO_IF(status, create(context, &userData));
@@ -921,6 +1190,9 @@ celix_status_t fw_startBundle(framework_pt framework, long bndId, int options __
                                 status = CELIX_DO_IF(status, start(userData, context));
                             }
                         }
+                        struct timespec startEnd;
+                        clock_gettime(CLOCK_MONOTONIC, &startEnd);
+                        entry->bnd->startupTiming.startDurationInMs = celix_difftime(&startBegin, &startEnd) * 1000.0;
 
                         status = CELIX_DO_IF(status, framework_setBundleStateAndNotify(framework, entry->bnd, OSGI_FRAMEWORK_BUNDLE_ACTIVE));
                         status = CELIX_DO_IF(status, fw_fireBundleEvent(framework, OSGI_FRAMEWORK_BUNDLE_EVENT_STARTED, entry));
@@ -1101,6 +1373,9 @@ celix_status_t fw_stopBundle(framework_pt framework, long bndId, bool record) {
                     status = CELIX_DO_IF(status, activator->destroy(activator->userData, context));
                 }
 	        }
+            if (context != NULL) {
+                celix_bundleContext_clearUseServiceCache(context);
+            }
 
             if (bndId > 0) {
 	            celix_serviceTracker_syncForContext(entry->bnd->context);
@@ -1758,7 +2033,12 @@ celix_status_t framework_markBundleResolved(framework_pt framework, module_pt mo
             bool isSystemBundle = false;
             bundle_isSystemBundle(bundle, &isSystemBundle);
             if (!isSystemBundle) {
+                struct timespec loadBegin;
+                clock_gettime(CLOCK_MONOTONIC, &loadBegin);
                 status = CELIX_DO_IF(status, framework_loadBundleLibraries(framework, bundle));
+                struct timespec loadEnd;
+                clock_gettime(CLOCK_MONOTONIC, &loadEnd);
+                bundle->startupTiming.loadDurationInMs += celix_difftime(&loadBegin, &loadEnd) * 1000.0;
             }
 
             status = CELIX_DO_IF(status, framework_setBundleStateAndNotify(framework, bundle, OSGI_FRAMEWORK_BUNDLE_RESOLVED));
@@ -1945,11 +2225,11 @@ celix_status_t fw_fireBundleEvent(framework_pt framework, bundle_event_type_e ev
         request->error = NULL;
         request->bndEntry = entry;
 
-        celixThreadMutex_lock(&framework->dispatcher.mutex);
-        if (framework->dispatcher.active) {
+        //note queue size is increased before checking active, see fw_eventDispatcher
+        __atomic_add_fetch(&framework->dispatcher.queueSize, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&framework->dispatcher.active, __ATOMIC_SEQ_CST)) {
             //fw_log(framework->logger, CELIX_LOG_LEVEL_TRACE, "Adding dispatcher bundle event request for bnd id %li with event type %i", entry->bndId, eventType);
-            celix_arrayList_add(framework->dispatcher.requests, request);
-            celixThreadCondition_broadcast(&framework->dispatcher.cond);
+            fw_queueRequest(framework, request);
         } else {
             /*
              * NOTE because stopping the framework is done through stopping the framework bundle,
@@ -1958,10 +2238,10 @@ celix_status_t fw_fireBundleEvent(framework_pt framework, bundle_event_type_e ev
              * TBD if this needs to addressed.
              */
             fw_log(framework->logger, CELIX_LOG_LEVEL_TRACE, "Cannot fire event dispatcher not active. Event is %x for bundle %s", eventType, celix_bundle_getSymbolicName(entry->bnd));
+            fw_cancelQueuedRequest(framework);
             fw_bundleEntry_decreaseUseCount(entry);
             free(request);
         }
-        celixThreadMutex_unlock(&framework->dispatcher.mutex);
     }
 
     framework_logIfError(framework->logger, status, NULL, "Failed to fire bundle event");
@@ -1986,15 +2266,14 @@ celix_status_t fw_fireFrameworkEvent(framework_pt framework, framework_event_typ
             request->error = celix_strerror(errorCode);
         }
 
-        celixThreadMutex_lock(&framework->dispatcher.mutex);
-        if (framework->dispatcher.active) {
+        __atomic_add_fetch(&framework->dispatcher.queueSize, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&framework->dispatcher.active, __ATOMIC_SEQ_CST)) {
             //fw_log(framework->logger, CELIX_LOG_LEVEL_TRACE, "Adding dispatcher framework event request for event type %i", eventType);
-            celix_arrayList_add(framework->dispatcher.requests, request);
-            celixThreadCondition_broadcast(&framework->dispatcher.cond);
+            fw_queueRequest(framework, request);
         } else {
+            fw_cancelQueuedRequest(framework);
             free(request);
         }
-        celixThreadMutex_unlock(&framework->dispatcher.mutex);
     }
 
     framework_logIfError(framework->logger, status, NULL, "Failed to fire framework event");
@@ -2042,71 +2321,160 @@ static void fw_handleEventRequest(celix_framework_t *framework, request_t* reque
     }
 }
 
-static inline void fw_handleEvents(celix_framework_t* framework, celix_array_list_t* localRequests) {
-    celixThreadMutex_lock(&framework->dispatcher.mutex);
-    if (celix_arrayList_size(framework->dispatcher.requests) == 0) {
-        //TODO needs a timed wait, because this loop sometimes misses the active=false/broadcast.
-        //FIXME an go back to 'normal' cond wait.
-        celixThreadCondition_timedwaitRelative(&framework->dispatcher.cond, &framework->dispatcher.mutex, 1, 0);
-    }
-    for (int i = 0; i < celix_arrayList_size(framework->dispatcher.requests); ++i) {
-        request_t* r = celix_arrayList_get(framework->dispatcher.requests, i);
-        celix_arrayList_add(localRequests, r);
-//        if (r->type == BUNDLE_EVENT_TYPE) {
-//            fw_log(framework->logger, CELIX_LOG_LEVEL_TRACE,
-//                   "Removing dispatcher bundle event request for bnd id %li with event type %i", r->bndEntry->bndId, r->eventType);
-//        } else {
-//            fw_log(framework->logger, CELIX_LOG_LEVEL_TRACE,
-//                   "Removing dispatcher framework event request for event type %i", r->eventType);
-//        }
+static celix_status_t fw_createDispatcherWakeup(celix_framework_t *framework) {
+    celix_status_t status = CELIX_SUCCESS;
+#ifdef __linux__
+    int fd = eventfd(0, EFD_CLOEXEC);
+    framework->dispatcher.wakeupReadFd = fd;
+    framework->dispatcher.wakeupWriteFd = fd;
+    if (fd < 0) {
+        status = CELIX_FRAMEWORK_EXCEPTION;
+    }
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+        framework->dispatcher.wakeupReadFd = fds[0];
+        framework->dispatcher.wakeupWriteFd = fds[1];
+        fcntl(fds[1], F_SETFL, O_NONBLOCK); //a full pipe already means a pending wakeup
+    } else {
+        framework->dispatcher.wakeupReadFd = -1;
+        framework->dispatcher.wakeupWriteFd = -1;
+        status = CELIX_FRAMEWORK_EXCEPTION;
     }
-    celix_arrayList_clear(framework->dispatcher.requests);
-    framework->dispatcher.nrOfLocalRequest = celix_arrayList_size(localRequests);
+#endif
+    return status;
+}
+
+static void fw_wakeupDispatcher(celix_framework_t *framework) {
+    uint64_t count = 1;
+    ssize_t rc;
+    do {
+        rc = write(framework->dispatcher.wakeupWriteFd, &count, sizeof(count));
+    } while (rc < 0 && errno == EINTR);
+}
+
+/**
+ * Waits till the dispatcher is woken up, unless there are already pending requests or the dispatcher is stopped.
+ *
+ * The waiting flag ensures that producers only need to write to the wakeup fd if the dispatcher thread is
+ * (about to be) waiting. Because both the waiting flag and the pending requests are accessed sequential consistent,
+ * either the dispatcher sees the new request or the producer sees the waiting flag.
+ */
+static void fw_waitForRequests(celix_framework_t *framework) {
+    __atomic_store_n(&framework->dispatcher.waiting, true, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&framework->dispatcher.pending, __ATOMIC_SEQ_CST) == NULL && __atomic_load_n(&framework->dispatcher.active, __ATOMIC_SEQ_CST)) {
+        uint64_t count;
+        ssize_t rc;
+        do {
+            rc = read(framework->dispatcher.wakeupReadFd, &count, sizeof(count));
+        } while (rc < 0 && errno == EINTR);
+    }
+    __atomic_store_n(&framework->dispatcher.waiting, false, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Adds a request to the lock-free dispatcher queue. The queue size should already be increased.
+ */
+static void fw_queueRequest(celix_framework_t *framework, request_t *request) {
+    clock_gettime(CLOCK_MONOTONIC, &request->firedTime);
+
+    size_t size = __atomic_load_n(&framework->dispatcher.queueSize, __ATOMIC_RELAXED);
+    size_t max = __atomic_load_n(&framework->dispatcher.maxQueueSize, __ATOMIC_RELAXED);
+    while (size > max && !__atomic_compare_exchange_n(&framework->dispatcher.maxQueueSize, &max, size, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        //retry, max is updated
+    }
+
+    request_t *head = __atomic_load_n(&framework->dispatcher.pending, __ATOMIC_RELAXED);
+    do {
+        request->next = head;
+    } while (!__atomic_compare_exchange_n(&framework->dispatcher.pending, &head, request, true, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    if (__atomic_load_n(&framework->dispatcher.waiting, __ATOMIC_SEQ_CST)) {
+        fw_wakeupDispatcher(framework);
+    }
+}
+
+/**
+ * Decreases the queue size for a request which is not added to the queue, because the dispatcher is not active.
+ */
+static void fw_cancelQueuedRequest(celix_framework_t *framework) {
+    celixThreadMutex_lock(&framework->dispatcher.mutex);
+    __atomic_sub_fetch(&framework->dispatcher.queueSize, 1, __ATOMIC_SEQ_CST);
+    celixThreadCondition_broadcast(&framework->dispatcher.cond);
     celixThreadMutex_unlock(&framework->dispatcher.mutex);
+}
+
+/**
+ * Takes all pending requests from the queue and handles them in the order they were fired.
+ * Returns the nr of handled requests.
+ */
+static size_t fw_handleEvents(celix_framework_t* framework) {
+    request_t *batch = __atomic_exchange_n(&framework->dispatcher.pending, NULL, __ATOMIC_SEQ_CST);
+    if (batch == NULL) {
+        return 0;
+    }
+
+    //the pending requests are a stack (newest first), reverse to get the fired order
+    request_t *ordered = NULL;
+    while (batch != NULL) {
+        request_t *next = batch->next;
+        batch->next = ordered;
+        ordered = batch;
+        batch = next;
+    }
+
+    size_t count = 0;
+    double totalLatency = 0.0;
+    double maxLatency = 0.0;
+    while (ordered != NULL) {
+        request_t *request = ordered;
+        ordered = request->next;
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double latency = celix_difftime(&request->firedTime, &now);
+        totalLatency += latency;
+        maxLatency = latency > maxLatency ? latency : maxLatency;
 
-    for (int i = 0; i < celix_arrayList_size(localRequests); ++i) {
-        request_t* request = celix_arrayList_get(localRequests, i);
         fw_handleEventRequest(framework, request);
         if (request->bndEntry != NULL) {
             fw_bundleEntry_decreaseUseCount(request->bndEntry);
         }
         free(request);
+        count += 1;
     }
-    celix_arrayList_clear(localRequests);
 
     celixThreadMutex_lock(&framework->dispatcher.mutex);
-    framework->dispatcher.nrOfLocalRequest = 0;
+    framework->dispatcher.stats.nrOfHandledEvents += count;
+    framework->dispatcher.stats.nrOfBatches += 1;
+    framework->dispatcher.stats.totalEventLatency += totalLatency;
+    if (maxLatency > framework->dispatcher.stats.maxEventLatency) {
+        framework->dispatcher.stats.maxEventLatency = maxLatency;
+    }
+    __atomic_sub_fetch(&framework->dispatcher.queueSize, count, __ATOMIC_SEQ_CST);
+    celixThreadCondition_broadcast(&framework->dispatcher.cond); //trigger threads waiting for an empty event queue
     celixThreadMutex_unlock(&framework->dispatcher.mutex);
+
+    return count;
 }
 
 static void *fw_eventDispatcher(void *fw) {
     framework_pt framework = (framework_pt) fw;
 
-    celixThreadMutex_lock(&framework->dispatcher.mutex);
-    bool active = framework->dispatcher.active;
-    celixThreadMutex_unlock(&framework->dispatcher.mutex);
-
-    celix_array_list_t *localRequests = celix_arrayList_create();
-
-    while (active) {
-        fw_handleEvents(framework, localRequests);
-
-        celixThreadMutex_lock(&framework->dispatcher.mutex);
-        celixThreadCondition_broadcast(&framework->dispatcher.cond); //trigger threads waiting for an empty event queue (after local events are handled)
-        active = framework->dispatcher.active;
-        celixThreadMutex_unlock(&framework->dispatcher.mutex);
+    while (__atomic_load_n(&framework->dispatcher.active, __ATOMIC_SEQ_CST)) {
+        if (fw_handleEvents(framework) == 0) {
+            fw_waitForRequests(framework);
+        }
     }
 
-    //not active any more, last run for possible request left overs
-    celixThreadMutex_lock(&framework->dispatcher.mutex);
-    bool needLastRun = celix_arrayList_size(framework->dispatcher.requests) > 0;
-    celixThreadMutex_unlock(&framework->dispatcher.mutex);
-    if (needLastRun) {
-        fw_handleEvents(framework, localRequests);
+    //not active any more, last runs for possible request left overs.
+    //Producers increase the queue size before checking active, so a queue size of 0 means no request can be added anymore.
+    while (__atomic_load_n(&framework->dispatcher.queueSize, __ATOMIC_SEQ_CST) > 0) {
+        if (fw_handleEvents(framework) == 0) {
+            sched_yield();
+        }
     }
 
-
-    celix_arrayList_destroy(localRequests);
     celixThread_exit(NULL);
     return NULL;
 
@@ -2153,10 +2521,8 @@ static celix_status_t frameworkActivator_stop(void * userData, bundle_context_t
         celixThreadMutex_unlock(&framework->shutdown.mutex);
 
         if (!alreadyInitialized) {
-            celixThreadMutex_lock(&framework->dispatcher.mutex);
-            framework->dispatcher.active = false;
-            celixThreadCondition_broadcast(&framework->dispatcher.cond);
-            celixThreadMutex_unlock(&framework->dispatcher.mutex);
+            __atomic_store_n(&framework->dispatcher.active, false, __ATOMIC_SEQ_CST);
+            fw_wakeupDispatcher(framework);
             celixThread_join(framework->dispatcher.thread, NULL);
             fw_log(framework->logger, CELIX_LOG_LEVEL_TRACE, "Joined shutdown thread for framework %s", celix_framework_getUUID(framework));
 
@@ -2265,9 +2631,8 @@ static celix_status_t framework_loadLibraries(framework_pt framework, const char
     return status;
 }
 
-static celix_status_t framework_loadLibrary(framework_pt framework, const char *library, bundle_archive_pt archive, void **handle) {
+static celix_status_t framework_getLibraryPath(bundle_archive_pt archive, const char *library, char *libraryPath, size_t libraryPathSize) {
     celix_status_t status = CELIX_SUCCESS;
-    const char *error = NULL;
 
 #ifdef __linux__
     char * library_prefix = "lib";
@@ -2280,7 +2645,6 @@ static celix_status_t framework_loadLibrary(framework_pt framework, const char *
         char * library_extension = ".dll";
 #endif
 
-    char libraryPath[256];
     long refreshCount = 0;
     const char *archiveRoot = NULL;
     long revisionNumber = 0;
@@ -2289,17 +2653,29 @@ static celix_status_t framework_loadLibrary(framework_pt framework, const char *
     status = CELIX_DO_IF(status, bundleArchive_getArchiveRoot(archive, &archiveRoot));
     status = CELIX_DO_IF(status, bundleArchive_getCurrentRevisionNumber(archive, &revisionNumber));
 
-    memset(libraryPath, 0, 256);
+    memset(libraryPath, 0, libraryPathSize);
     int written = 0;
     if (strncmp("lib", library, 3) == 0) {
-        written = snprintf(libraryPath, 256, "%s/version%ld.%ld/%s", archiveRoot, refreshCount, revisionNumber, library);
+        written = snprintf(libraryPath, libraryPathSize, "%s/version%ld.%ld/%s", archiveRoot, refreshCount, revisionNumber, library);
     } else {
-        written = snprintf(libraryPath, 256, "%s/version%ld.%ld/%s%s%s", archiveRoot, refreshCount, revisionNumber, library_prefix, library, library_extension);
+        written = snprintf(libraryPath, libraryPathSize, "%s/version%ld.%ld/%s%s%s", archiveRoot, refreshCount, revisionNumber, library_prefix, library, library_extension);
     }
 
-    if (written >= 256) {
-        error = "library path is too long";
+    if (status == CELIX_SUCCESS && written >= libraryPathSize) {
         status = CELIX_FRAMEWORK_EXCEPTION;
+    }
+    return status;
+}
+
+static celix_status_t framework_loadLibrary(framework_pt framework, const char *library, bundle_archive_pt archive, void **handle) {
+    celix_status_t status = CELIX_SUCCESS;
+    const char *error = NULL;
+
+    char libraryPath[256];
+    status = framework_getLibraryPath(archive, library, libraryPath, sizeof(libraryPath));
+
+    if (status != CELIX_SUCCESS) {
+        error = "library path is too long";
     } else {
         celix_bundle_context_t *fwCtx = NULL;
         bundle_getContext(framework->bundle, &fwCtx);
@@ -2530,12 +2906,26 @@ bool celix_framework_startBundle(celix_framework_t *fw, long bndId) {
 
 void celix_framework_waitForEmptyEventQueue(celix_framework_t *fw) {
     celixThreadMutex_lock(&fw->dispatcher.mutex);
-    while ((celix_arrayList_size(fw->dispatcher.requests) + fw->dispatcher.nrOfLocalRequest) != 0) {
+    while (__atomic_load_n(&fw->dispatcher.queueSize, __ATOMIC_SEQ_CST) != 0) {
         celixThreadCondition_wait(&fw->dispatcher.cond, &fw->dispatcher.mutex);
     }
     celixThreadMutex_unlock(&fw->dispatcher.mutex);
 }
 
+void celix_framework_getEventQueueStats(celix_framework_t *fw, celix_framework_event_queue_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->queueSize = __atomic_load_n(&fw->dispatcher.queueSize, __ATOMIC_ACQUIRE);
+    stats->maxQueueSize = __atomic_load_n(&fw->dispatcher.maxQueueSize, __ATOMIC_ACQUIRE);
+    celixThreadMutex_lock(&fw->dispatcher.mutex);
+    stats->nrOfHandledEvents = fw->dispatcher.stats.nrOfHandledEvents;
+    stats->nrOfBatches = fw->dispatcher.stats.nrOfBatches;
+    if (fw->dispatcher.stats.nrOfHandledEvents > 0) {
+        stats->avgEventLatencyInSeconds = fw->dispatcher.stats.totalEventLatency / (double)fw->dispatcher.stats.nrOfHandledEvents;
+    }
+    stats->maxEventLatencyInSeconds = fw->dispatcher.stats.maxEventLatency;
+    celixThreadMutex_unlock(&fw->dispatcher.mutex);
+}
+
 void celix_framework_setLogCallback(celix_framework_t* fw, void* logHandle, void (*logFunction)(void* handle, celix_log_level_e level, const char* file, const char *function, int line, const char *format, va_list formatArgs)) {
     celix_frameworkLogger_setLogCallback(fw->logger, logHandle, logFunction);
 }
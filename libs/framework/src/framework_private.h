@@ -40,6 +40,9 @@
 
 #include "celix_threads.h"
 #include "service_registry.h"
+#include "dm_executor_pool.h"
+
+struct request;
 
 struct celix_framework {
 #ifdef WITH_APR
@@ -78,15 +81,28 @@ struct celix_framework {
 
 
     struct {
-        celix_thread_cond_t cond;
         celix_thread_t thread;
-        celix_thread_mutex_t mutex; //protect active and requests
-        bool active;
-        celix_array_list_t *requests;
-        size_t nrOfLocalRequest;
+        bool active; //atomic, if false fired events are ignored
+        struct request *pending; //atomic, lock-free stack of fired events (newest first), taken as batch by the dispatcher thread
+        size_t queueSize; //atomic, nr of fired and not yet handled events
+        size_t maxQueueSize; //atomic
+        bool waiting; //atomic, true if the dispatcher thread waits (or is about to wait) on the wakeup fd
+        int wakeupReadFd; //eventfd (or pipe if eventfd is not available) used to wake up the dispatcher thread
+        int wakeupWriteFd;
+
+        celix_thread_mutex_t mutex; //protects cond and stats
+        celix_thread_cond_t cond; //broadcast when events are handled, used to wait for an empty event queue
+        struct {
+            size_t nrOfHandledEvents;
+            size_t nrOfBatches;
+            double totalEventLatency;
+            double maxEventLatency;
+        } stats;
     } dispatcher;
 
     celix_framework_logger_t* logger;
+
+    celix_dm_executor_pool_t *dmExecutorPool; //NULL if CELIX_DM_EXECUTOR_NR_OF_THREADS is not configured
 };
 
 FRAMEWORK_EXPORT celix_status_t fw_getProperty(framework_pt framework, const char* name, const char* defaultValue, const char** value);
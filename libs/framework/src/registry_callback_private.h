@@ -35,6 +35,7 @@ typedef struct registry_callback_struct {
 	void *handle;
     celix_status_t (*getUsingBundles)(void *handle, service_registration_pt reg, array_list_pt *bundles);
 	celix_status_t (*unregister)(void *handle, bundle_pt bundle, service_registration_pt reg);
+	celix_status_t (*modified)(void *handle, service_registration_pt reg);
 } registry_callback_t;
 
 #endif /* REGISTRY_CALLBACK_H_ */
@@ -230,11 +230,18 @@ celix_status_t serviceRegistration_getProperties(service_registration_pt registr
 
 celix_status_t serviceRegistration_setProperties(service_registration_pt registration, properties_pt properties) {
     celix_status_t status;
+    registry_callback_t callback;
 
     celixThreadRwlock_writeLock(&registration->lock);
     status = serviceRegistration_initializeProperties(registration, properties);
+    callback = registration->callback;
     celixThreadRwlock_unlock(&registration->lock);
 
+    if (status == CELIX_SUCCESS && callback.modified != NULL) {
+        //note called outside of the registration lock, the registry will lock the registry and the registration
+        callback.modified(callback.handle, registration);
+    }
+
 	return status;
 }
 
@@ -65,6 +65,33 @@ static void celix_increasePendingRegisteredEvent(celix_service_registry_t *regis
 static void celix_decreasePendingRegisteredEvent(celix_service_registry_t *registry, long svcId);
 static void celix_waitForPendingRegisteredEvents(celix_service_registry_t *registry, long svcId);
 
+static celix_status_t serviceRegistry_serviceModified(service_registry_pt registry, service_registration_pt registration);
+static void serviceRegistry_addToIndexes(service_registry_pt registry, service_registration_pt registration);
+static void serviceRegistry_removeFromIndexes(service_registry_pt registry, service_registration_pt registration);
+static void serviceRegistry_addToPropertyIndexes(service_registry_pt registry, service_registration_pt registration);
+static void serviceRegistry_removeFromPropertyIndexes(service_registry_pt registry, service_registration_pt registration);
+static bool serviceRegistry_findCandidates(service_registry_pt registry, const char *serviceName, const celix_filter_t *filter, celix_array_list_t **candidates);
+static void serviceRegistry_destroyIndex(hash_map_t *index);
+
+/**
+ * Nr of service listener callbacks currently active on the calling thread.
+ * See celix_serviceRegistry_isHandlingServiceEvent.
+ */
+static __thread unsigned int g_serviceEventCallbackDepth = 0;
+
+/**
+ * The service properties for which the service registry keeps an index (property value -> registrations).
+ * These properties are commonly used in equal filter criteria (e.g. (service.id=42) or (service.lang=C))
+ * and can be used to narrow down the registrations which needs to be matched for a service lookup.
+ */
+static const char * const SERVICE_REGISTRY_INDEXED_PROPERTIES[] = {
+        "objectClass", /*OSGI_FRAMEWORK_OBJECTCLASS*/
+        "service.id", /*OSGI_FRAMEWORK_SERVICE_ID*/
+        "service.lang", /*CELIX_FRAMEWORK_SERVICE_LANGUAGE*/
+        "service.version", /*CELIX_FRAMEWORK_SERVICE_VERSION*/
+        NULL
+};
+
 celix_status_t serviceRegistry_create(framework_pt framework, service_registry_pt *out) {
 	celix_status_t status;
 
@@ -76,8 +103,15 @@ celix_status_t serviceRegistry_create(framework_pt framework, service_registry_p
         reg->callback.handle = reg;
         reg->callback.getUsingBundles = (void *)serviceRegistry_getUsingBundles;
         reg->callback.unregister = (void *) serviceRegistry_unregisterService;
+        reg->callback.modified = (void *) serviceRegistry_serviceModified;
 
 		reg->serviceRegistrations = hashMap_create(NULL, NULL, NULL, NULL);
+		reg->serviceRegistrationsByName = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+		reg->propertyIndexes = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+		for (int i = 0; SERVICE_REGISTRY_INDEXED_PROPERTIES[i] != NULL; ++i) {
+		    hash_map_t *index = hashMap_create(utils_stringHash, NULL, utils_stringEquals, NULL);
+		    hashMap_put(reg->propertyIndexes, (void*)SERVICE_REGISTRY_INDEXED_PROPERTIES[i], index);
+		}
 		reg->framework = framework;
 		reg->nextServiceId = 1L;
 		reg->serviceReferences = hashMap_create(NULL, NULL, NULL, NULL);
@@ -140,6 +174,15 @@ celix_status_t serviceRegistry_destroy(service_registry_pt registry) {
     assert(size == 0);
     hashMap_destroy(registry->serviceRegistrations, false, false);
 
+    //destroy service registration indexes
+    serviceRegistry_destroyIndex(registry->serviceRegistrationsByName);
+    iter = hashMapIterator_construct(registry->propertyIndexes);
+    while (hashMapIterator_hasNext(&iter)) {
+        hash_map_t *index = hashMapIterator_nextValue(&iter);
+        serviceRegistry_destroyIndex(index);
+    }
+    hashMap_destroy(registry->propertyIndexes, false, false);
+
     //destroy service references (double) map);
     size = hashMap_size(registry->serviceReferences);
     if (size > 0) {
@@ -230,6 +273,7 @@ static celix_status_t serviceRegistry_registerServiceInternal(service_registry_p
         hashMap_put(registry->serviceRegistrations, bundle, regs);
     }
 	arrayList_add(regs, *registration);
+	serviceRegistry_addToIndexes(registry, *registration);
 
     //update pending register event
     celix_increasePendingRegisteredEvent(registry, svcId);
@@ -271,6 +315,7 @@ celix_status_t serviceRegistry_unregisterService(service_registry_pt registry, b
             hashMap_remove(registry->serviceRegistrations, bundle);
         }
 	}
+	serviceRegistry_removeFromIndexes(registry, registration);
 	celixThreadRwlock_unlock(&registry->lock);
 
 
@@ -394,56 +439,58 @@ static celix_status_t serviceRegistry_getServiceReference_internal(service_regis
 	return status;
 }
 
+/**
+ * Returns whether the registration matches the (optional) service name and (optional) filter.
+ * Note for service name the registration service name is used and not the objectClass service property.
+ */
+static bool serviceRegistry_matchRegistration(service_registration_pt registration, const char *serviceName, const celix_filter_t *filter) {
+    bool matched = true;
+    if (serviceName != NULL) {
+        const char *className = NULL;
+        serviceRegistration_getServiceName(registration, &className);
+        matched = className != NULL && strcmp(className, serviceName) == 0;
+    }
+    if (matched && filter != NULL) {
+        properties_pt props = NULL;
+        serviceRegistration_getProperties(registration, &props);
+        matched = celix_filter_match(filter, props);
+    }
+    return matched && serviceRegistration_isValid(registration);
+}
+
 celix_status_t serviceRegistry_getServiceReferences(service_registry_pt registry, bundle_pt owner, const char *serviceName, filter_pt filter, array_list_pt *out) {
 	celix_status_t status;
-	hash_map_iterator_pt iterator;
     array_list_pt references = NULL;
 	array_list_pt matchingRegistrations = NULL;
-    bool matchResult;
+	celix_array_list_t *candidates = NULL;
 
     status = arrayList_create(&references);
     status = CELIX_DO_IF(status, arrayList_create(&matchingRegistrations));
 
     celixThreadRwlock_readLock(&registry->lock);
-	iterator = hashMapIterator_create(registry->serviceRegistrations);
-	while (status == CELIX_SUCCESS && hashMapIterator_hasNext(iterator)) {
-		array_list_pt regs = (array_list_pt) hashMapIterator_nextValue(iterator);
-		unsigned int regIdx;
-		for (regIdx = 0; (regs != NULL) && regIdx < arrayList_size(regs); regIdx++) {
-			service_registration_pt registration = (service_registration_pt) arrayList_get(regs, regIdx);
-			properties_pt props = NULL;
-
-			status = serviceRegistration_getProperties(registration, &props);
-			if (status == CELIX_SUCCESS) {
-				bool matched = false;
-				matchResult = false;
-				if (filter != NULL) {
-					filter_match(filter, props, &matchResult);
-				}
-				if ((serviceName == NULL) && ((filter == NULL) || matchResult)) {
-					matched = true;
-				} else if (serviceName != NULL) {
-					const char *className = NULL;
-					matchResult = false;
-					serviceRegistration_getServiceName(registration, &className);
-					if (filter != NULL) {
-						filter_match(filter, props, &matchResult);
-					}
-					if ((strcmp(className, serviceName) == 0) && ((filter == NULL) || matchResult)) {
-						matched = true;
-					}
-				}
-				if (matched) {
-					if (serviceRegistration_isValid(registration)) {
-                        serviceRegistration_retain(registration);
-                        arrayList_add(matchingRegistrations, registration);
-					}
-				}
-			}
-		}
-	}
+    if (status == CELIX_SUCCESS && serviceRegistry_findCandidates(registry, serviceName, filter, &candidates)) {
+        //indexes narrowed the lookup, only match the candidate registrations (if any)
+        for (int i = 0; candidates != NULL && i < celix_arrayList_size(candidates); ++i) {
+            service_registration_pt registration = celix_arrayList_get(candidates, i);
+            if (serviceRegistry_matchRegistration(registration, serviceName, filter)) {
+                serviceRegistration_retain(registration);
+                arrayList_add(matchingRegistrations, registration);
+            }
+        }
+    } else if (status == CELIX_SUCCESS) {
+        hash_map_iterator_t iter = hashMapIterator_construct(registry->serviceRegistrations);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_array_list_t *regs = hashMapIterator_nextValue(&iter);
+            for (int regIdx = 0; (regs != NULL) && regIdx < celix_arrayList_size(regs); ++regIdx) {
+                service_registration_pt registration = celix_arrayList_get(regs, regIdx);
+                if (serviceRegistry_matchRegistration(registration, serviceName, filter)) {
+                    serviceRegistration_retain(registration);
+                    arrayList_add(matchingRegistrations, registration);
+                }
+            }
+        }
+    }
     celixThreadRwlock_unlock(&registry->lock);
-	hashMapIterator_destroy(iterator);
 
     if (status == CELIX_SUCCESS) {
         unsigned int i;
@@ -1127,19 +1174,29 @@ celix_status_t celix_serviceRegistry_addServiceListener(celix_service_registry_t
     celix_arrayList_add(registry->serviceListeners, entry); //use count 1
 
     //find already registered services
-    hash_map_iterator_t iter = hashMapIterator_construct(registry->serviceRegistrations);
-    while (hashMapIterator_hasNext(&iter)) {
-        celix_array_list_t *regs = (array_list_pt) hashMapIterator_nextValue(&iter);
-        for (int regIdx = 0; (regs != NULL) && regIdx < celix_arrayList_size(regs); ++regIdx) {
-            service_registration_pt registration = celix_arrayList_get(regs, regIdx);
-            properties_pt props = NULL;
-            serviceRegistration_getProperties(registration, &props);
-            if (celix_filter_match(filter, props)) {
+    celix_array_list_t *candidates = NULL;
+    if (serviceRegistry_findCandidates(registry, NULL, filter, &candidates)) {
+        for (int i = 0; candidates != NULL && i < celix_arrayList_size(candidates); ++i) {
+            service_registration_pt registration = celix_arrayList_get(candidates, i);
+            if (serviceRegistry_matchRegistration(registration, NULL, filter)) {
                 serviceRegistration_retain(registration);
-                long svcId = serviceRegistration_getServiceId(registration);
                 celix_arrayList_add(registrations, registration);
                 //update pending register event count
-                celix_increasePendingRegisteredEvent(registry, svcId);
+                celix_increasePendingRegisteredEvent(registry, serviceRegistration_getServiceId(registration));
+            }
+        }
+    } else {
+        hash_map_iterator_t iter = hashMapIterator_construct(registry->serviceRegistrations);
+        while (hashMapIterator_hasNext(&iter)) {
+            celix_array_list_t *regs = (array_list_pt) hashMapIterator_nextValue(&iter);
+            for (int regIdx = 0; (regs != NULL) && regIdx < celix_arrayList_size(regs); ++regIdx) {
+                service_registration_pt registration = celix_arrayList_get(regs, regIdx);
+                if (serviceRegistry_matchRegistration(registration, NULL, filter)) {
+                    serviceRegistration_retain(registration);
+                    celix_arrayList_add(registrations, registration);
+                    //update pending register event count
+                    celix_increasePendingRegisteredEvent(registry, serviceRegistration_getServiceId(registration));
+                }
             }
         }
     }
@@ -1247,7 +1304,9 @@ static void celix_serviceRegistry_serviceChanged(celix_service_registry_t *regis
         serviceRegistry_getServiceReference(registry, entry->bundle, registration, &reference);
         event.type = eventType;
         event.reference = reference;
+        g_serviceEventCallbackDepth += 1;
         entry->listener->serviceChanged(entry->listener->handle, &event);
+        g_serviceEventCallbackDepth -= 1;
         serviceRegistry_ungetServiceReference(registry, entry->bundle, reference);
         celix_decreaseCountServiceListener(entry); //decrease usage, so that the listener can be destroyed (if use count is now 0)
     }
@@ -1255,6 +1314,10 @@ static void celix_serviceRegistry_serviceChanged(celix_service_registry_t *regis
 }
 
 
+bool celix_serviceRegistry_isHandlingServiceEvent(void) {
+    return g_serviceEventCallbackDepth > 0;
+}
+
 static void celix_increasePendingRegisteredEvent(celix_service_registry_t *registry, long svcId) {
     celixThreadMutex_lock(&registry->pendingRegisterEvents.mutex);
     long count = (long)hashMap_get(registry->pendingRegisterEvents.map, (void*)svcId);
@@ -1290,4 +1353,148 @@ static void celix_waitForPendingRegisteredEvents(celix_service_registry_t *regis
 long celix_serviceRegistry_nextSvcId(celix_service_registry_t* registry) {
     long scvId = __atomic_fetch_add(&registry->nextServiceId, 1, __ATOMIC_SEQ_CST);
     return scvId;
-}
\ No newline at end of file
+}
+
+static celix_status_t serviceRegistry_serviceModified(service_registry_pt registry, service_registration_pt registration) {
+    celixThreadRwlock_writeLock(&registry->lock);
+    serviceRegistry_removeFromPropertyIndexes(registry, registration);
+    serviceRegistry_addToPropertyIndexes(registry, registration);
+    celixThreadRwlock_unlock(&registry->lock);
+    return CELIX_SUCCESS;
+}
+
+static void serviceRegistry_addToIndex(hash_map_t *index, const char *key, service_registration_pt registration) {
+    celix_array_list_t *regs = hashMap_get(index, key);
+    if (regs == NULL) {
+        regs = celix_arrayList_create();
+        hashMap_put(index, celix_utils_strdup(key), regs);
+    }
+    celix_arrayList_add(regs, registration);
+}
+
+/**
+ * Removes the registration from the index list for the provided key.
+ * Returns false if the registration was not found in the list for the key.
+ */
+static bool serviceRegistry_removeFromIndex(hash_map_t *index, const char *key, service_registration_pt registration) {
+    bool removed = false;
+    celix_array_list_t *regs = key != NULL ? hashMap_get(index, key) : NULL;
+    if (regs != NULL) {
+        int size = celix_arrayList_size(regs);
+        celix_arrayList_remove(regs, registration);
+        removed = celix_arrayList_size(regs) != size;
+        if (celix_arrayList_size(regs) == 0) {
+            hash_map_entry_t *entry = hashMap_getEntry(index, key);
+            char *entryKey = hashMapEntry_getKey(entry);
+            hashMap_remove(index, key);
+            free(entryKey);
+            celix_arrayList_destroy(regs);
+        }
+    }
+    return removed;
+}
+
+static void serviceRegistry_addToIndexes(service_registry_pt registry, service_registration_pt registration) {
+    //only call after locked registry RWlock
+    const char *svcName = NULL;
+    serviceRegistration_getServiceName(registration, &svcName);
+    if (svcName != NULL) {
+        serviceRegistry_addToIndex(registry->serviceRegistrationsByName, svcName, registration);
+    }
+    serviceRegistry_addToPropertyIndexes(registry, registration);
+}
+
+static void serviceRegistry_removeFromIndexes(service_registry_pt registry, service_registration_pt registration) {
+    //only call after locked registry RWlock
+    const char *svcName = NULL;
+    serviceRegistration_getServiceName(registration, &svcName);
+    serviceRegistry_removeFromIndex(registry->serviceRegistrationsByName, svcName, registration);
+    serviceRegistry_removeFromPropertyIndexes(registry, registration);
+}
+
+static void serviceRegistry_addToPropertyIndexes(service_registry_pt registry, service_registration_pt registration) {
+    //only call after locked registry RWlock
+    properties_pt props = NULL;
+    serviceRegistration_getProperties(registration, &props);
+    for (int i = 0; props != NULL && SERVICE_REGISTRY_INDEXED_PROPERTIES[i] != NULL; ++i) {
+        const char *val = celix_properties_get(props, SERVICE_REGISTRY_INDEXED_PROPERTIES[i], NULL);
+        if (val != NULL) {
+            hash_map_t *index = hashMap_get(registry->propertyIndexes, SERVICE_REGISTRY_INDEXED_PROPERTIES[i]);
+            serviceRegistry_addToIndex(index, val, registration);
+        }
+    }
+}
+
+static void serviceRegistry_removeFromPropertyIndexes(service_registry_pt registry, service_registration_pt registration) {
+    //only call after locked registry RWlock
+    properties_pt props = NULL;
+    serviceRegistration_getProperties(registration, &props);
+    for (int i = 0; SERVICE_REGISTRY_INDEXED_PROPERTIES[i] != NULL; ++i) {
+        hash_map_t *index = hashMap_get(registry->propertyIndexes, SERVICE_REGISTRY_INDEXED_PROPERTIES[i]);
+        const char *val = props != NULL ? celix_properties_get(props, SERVICE_REGISTRY_INDEXED_PROPERTIES[i], NULL) : NULL;
+        if (!serviceRegistry_removeFromIndex(index, val, registration)) {
+            //property value changed after indexing (e.g. properties updated), search all index entries.
+            const char *indexedVal = NULL;
+            hash_map_iterator_t iter = hashMapIterator_construct(index);
+            while (indexedVal == NULL && hashMapIterator_hasNext(&iter)) {
+                hash_map_entry_t *entry = hashMapIterator_nextEntry(&iter);
+                celix_array_list_t *regs = hashMapEntry_getValue(entry);
+                if (arrayList_contains(regs, registration)) {
+                    indexedVal = hashMapEntry_getKey(entry);
+                }
+            }
+            if (indexedVal != NULL) {
+                serviceRegistry_removeFromIndex(index, indexedVal, registration);
+            }
+        }
+    }
+}
+
+/**
+ * Tries to find the candidate registrations for the provided service name and filter using the registry indexes.
+ * Only equal criteria on indexed properties in the root of the filter or in a root AND filter are used.
+ * If multiple criteria can be used, the smallest candidate list is used.
+ *
+ * Returns true if the lookup could be narrowed down, in that case the candidates output is the list of candidates
+ * or NULL if there are no candidates at all. If false is returned all registrations need to be considered.
+ * Should only be called with the registry lock taken and the candidate list is only valid while the lock is taken.
+ */
+static bool serviceRegistry_findCandidates(service_registry_pt registry, const char *serviceName, const celix_filter_t *filter, celix_array_list_t **candidates) {
+    bool narrowed = false;
+    celix_array_list_t *result = NULL;
+
+    if (serviceName != NULL) {
+        narrowed = true;
+        result = hashMap_get(registry->serviceRegistrationsByName, serviceName);
+    }
+
+    bool isAnd = filter != NULL && filter->operand == CELIX_FILTER_OPERAND_AND && filter->children != NULL;
+    int nrOfCriteria = isAnd ? celix_arrayList_size(filter->children) : (filter != NULL ? 1 : 0);
+
+    for (int i = 0; i < nrOfCriteria && (!narrowed || result != NULL); ++i) {
+        const celix_filter_t *criterion = isAnd ? celix_arrayList_get(filter->children, i) : filter;
+        if (criterion->operand != CELIX_FILTER_OPERAND_EQUAL || criterion->attribute == NULL || criterion->value == NULL) {
+            continue;
+        }
+        hash_map_t *index = hashMap_get(registry->propertyIndexes, criterion->attribute);
+        if (index != NULL) {
+            celix_array_list_t *regs = hashMap_get(index, criterion->value);
+            if (!narrowed || regs == NULL || celix_arrayList_size(regs) < celix_arrayList_size(result)) {
+                result = regs;
+            }
+            narrowed = true;
+        }
+    }
+
+    *candidates = result;
+    return narrowed;
+}
+
+static void serviceRegistry_destroyIndex(hash_map_t *index) {
+    hash_map_iterator_t iter = hashMapIterator_construct(index);
+    while (hashMapIterator_hasNext(&iter)) {
+        celix_array_list_t *regs = hashMapIterator_nextValue(&iter);
+        celix_arrayList_destroy(regs);
+    }
+    hashMap_destroy(index, true, false);
+}
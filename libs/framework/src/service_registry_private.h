@@ -39,6 +39,8 @@ struct celix_serviceRegistry {
     celix_thread_rwlock_t lock; //protect below
 
 	hash_map_t *serviceRegistrations; //key = bundle (reg owner), value = list ( registration )
+	hash_map_t *serviceRegistrationsByName; //key = service name, value = list ( registration )
+	hash_map_t *propertyIndexes; //key = indexed property name, value = map (key = property value, value = list ( registration ))
 	hash_map_t *serviceReferences; //key = bundle, value = map (key = serviceId, value = reference)
 
 	bool checkDeletedReferences; //If enabled. check if provided service references are still valid
@@ -97,4 +99,11 @@ struct usageCount {
 
 typedef struct usageCount * usage_count_pt;
 
+/**
+ * Returns whether the calling thread is currently handling a service event (i.e. is inside a service listener callback).
+ * Removing a service listener which is also matched by the ongoing event can deadlock
+ * (see celix_serviceRegistry_serviceChanged), so callers can use this to postpone the removal of service listeners.
+ */
+bool celix_serviceRegistry_isHandlingServiceEvent(void);
+
 #endif /* SERVICE_REGISTRY_PRIVATE_H_ */
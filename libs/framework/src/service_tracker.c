@@ -47,6 +47,12 @@ static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracke
                                                             void (*use)(void *handle, void *svc),
                                                             void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
                                                             void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner));
+static celix_tracked_entry_t* serviceTracker_retainHighestRankingEntry(celix_tracked_snapshot_t *snapshot, const char *serviceName);
+static bool serviceTracker_useAndReleaseEntry(celix_tracked_entry_t *tracked,
+                                              void *callbackHandle,
+                                              void (*use)(void *handle, void *svc),
+                                              void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
+                                              void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner));
 
 #ifdef CELIX_SERVICE_TRACKER_USE_SHUTDOWN_THREAD
 static void serviceTracker_addInstanceFromShutdownList(celix_service_tracker_instance_t *instance);
@@ -64,11 +70,36 @@ static celix_thread_cond_t g_shutdownCond;
 static celix_array_list_t *g_shutdownInstances = NULL; //value = celix_service_tracker_instance -> used for syncing with shutdown threads
 
 
+
 static void serviceTracker_once(void) {
     celixThreadMutex_create(&g_shutdownMutex, NULL);
     celixThreadCondition_init(&g_shutdownCond, NULL);
 }
 
+/**
+ * Loads the snapshot of the current tracker instance. Should be called inside a read section.
+ */
+static inline celix_tracked_snapshot_t* serviceTracker_loadSnapshot(celix_service_tracker_t *tracker) {
+    celix_service_tracker_instance_t *instance = __atomic_load_n(&tracker->instance, __ATOMIC_SEQ_CST);
+    return instance == NULL ? NULL : __atomic_load_n(&instance->snapshot, __ATOMIC_SEQ_CST);
+}
+
+/**
+ * Publishes a new snapshot of the trackedServices and frees the previous one when no reader can use it anymore.
+ * Should be called with the instance->lock write locked.
+ */
+static void serviceTracker_publishSnapshot(celix_service_tracker_instance_t *instance) {
+    unsigned int size = celix_arrayList_size(instance->trackedServices);
+    celix_tracked_snapshot_t *snapshot = malloc(sizeof(*snapshot) + size * sizeof(snapshot->entries[0]));
+    snapshot->size = size;
+    for (unsigned int i = 0; i < size; ++i) {
+        snapshot->entries[i] = celix_arrayList_get(instance->trackedServices, i);
+    }
+    celix_tracked_snapshot_t *old = __atomic_exchange_n(&instance->snapshot, snapshot, __ATOMIC_SEQ_CST);
+    celix_epoch_synchronize(instance->epoch);
+    free(old);
+}
+
 static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, void *svc, celix_properties_t *props, celix_bundle_t *bnd) {
     celix_tracked_entry_t *tracked = calloc(1, sizeof(*tracked));
     tracked->reference = ref;
@@ -84,22 +115,30 @@ static inline celix_tracked_entry_t* tracked_create(service_reference_pt ref, vo
 }
 
 static inline void tracked_retain(celix_tracked_entry_t *tracked) {
-    celixThreadMutex_lock(&tracked->mutex);
-    tracked->useCount += 1;
-    celixThreadMutex_unlock(&tracked->mutex);
+    __atomic_add_fetch(&tracked->useCount, 1, __ATOMIC_RELAXED);
 }
 
 static inline void tracked_release(celix_tracked_entry_t *tracked) {
+    size_t count = __atomic_load_n(&tracked->useCount, __ATOMIC_RELAXED);
+    while (count > 1) {
+        //not the last user, no need to signal
+        if (__atomic_compare_exchange_n(&tracked->useCount, &count, count - 1, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+    //possible last user, decrease under lock so that tracked_waitAndDestroy cannot destroy the entry while signaling
     celixThreadMutex_lock(&tracked->mutex);
-    assert(tracked->useCount > 0);
-    tracked->useCount -= 1;
-    celixThreadCondition_signal(&tracked->useCond);
+    size_t prev = __atomic_fetch_sub(&tracked->useCount, 1, __ATOMIC_RELEASE);
+    assert(prev > 0);
+    if (prev == 1) {
+        celixThreadCondition_broadcast(&tracked->useCond);
+    }
     celixThreadMutex_unlock(&tracked->mutex);
 }
 
 static inline void tracked_waitAndDestroy(celix_tracked_entry_t *tracked) {
     celixThreadMutex_lock(&tracked->mutex);
-    while (tracked->useCount != 0) {
+    while (__atomic_load_n(&tracked->useCount, __ATOMIC_ACQUIRE) != 0) {
         celixThreadCondition_wait(&tracked->useCond, &tracked->mutex);
     }
     celixThreadMutex_unlock(&tracked->mutex);
@@ -137,6 +176,7 @@ celix_status_t serviceTracker_createWithFilter(bundle_context_pt context, const
 		(*tracker)->context = context;
 		(*tracker)->filter = strdup(filter);
         (*tracker)->customizer = customizer;
+        celix_epoch_init(&(*tracker)->epoch);
 	}
 
 	framework_logIfError(celix_frameworkLogger_globalLogger(), status, NULL, "Cannot create service tracker [filter=%s]", filter);
@@ -149,6 +189,7 @@ celix_status_t serviceTracker_destroy(service_tracker_pt tracker) {
 	    serviceTrackerCustomizer_destroy(tracker->customizer);
 	}
 
+    celix_epoch_destroy(&tracker->epoch);
     free(tracker->serviceName);
 	free(tracker->filter);
 	free(tracker);
@@ -176,6 +217,8 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
 
         celixThreadRwlock_create(&instance->lock, NULL);
         instance->trackedServices = celix_arrayList_create();
+        instance->epoch = &tracker->epoch;
+        instance->snapshot = calloc(1, sizeof(*instance->snapshot));
 
         celixThreadMutex_create(&instance->mutex, NULL);
         instance->currentHighestServiceId = -1;
@@ -199,7 +242,7 @@ celix_status_t serviceTracker_open(service_tracker_pt tracker) {
         instance->removeWithProperties = tracker->removeWithProperties;
         instance->removeWithOwner = tracker->removeWithOwner;
 
-        tracker->instance = instance;
+        __atomic_store_n(&tracker->instance, instance, __ATOMIC_SEQ_CST);
 
         addListener = true;
     } else {
@@ -221,7 +264,7 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
 
     celixThreadRwlock_writeLock(&tracker->instanceLock);
     celix_service_tracker_instance_t *instance = tracker->instance;
-    tracker->instance = NULL;
+    __atomic_store_n(&tracker->instance, NULL, __ATOMIC_SEQ_CST);
     if (instance != NULL) {
         celixThreadMutex_lock(&instance->closingLock);
         //prevent service listener events
@@ -231,6 +274,9 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
     celixThreadRwlock_unlock(&tracker->instanceLock);
 
     if (instance != NULL) {
+        //wait till no lock-free reader uses the instance anymore
+        celix_epoch_synchronize(instance->epoch);
+
         celixThreadRwlock_writeLock(&instance->lock);
         unsigned int size = celix_arrayList_size(instance->trackedServices);
         if(size > 0) {
@@ -239,6 +285,7 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
                 trackedEntries[i] = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
             }
             arrayList_clear(instance->trackedServices);
+            serviceTracker_publishSnapshot(instance);
             celixThreadRwlock_unlock(&instance->lock);
 
             //loop trough tracked entries an untrack
@@ -275,6 +322,7 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
         celixThreadMutex_destroy(&instance->mutex);
         celixThreadRwlock_destroy(&instance->lock);
         celix_arrayList_destroy(instance->trackedServices);
+        free(instance->snapshot);
         free(instance->filter);
         free(instance);
 #endif
@@ -284,115 +332,79 @@ celix_status_t serviceTracker_close(service_tracker_pt tracker) {
 }
 
 service_reference_pt serviceTracker_getServiceReference(service_tracker_pt tracker) {
-    //TODO deprecated warning -> not locked
-	celix_tracked_entry_t *tracked;
+    //note the reference is read from the snapshot, but not retained
     service_reference_pt result = NULL;
-	unsigned int i;
-
-	celixThreadRwlock_readLock(&tracker->instanceLock);
-	celix_service_tracker_instance_t *instance = tracker->instance;
-	if (instance != NULL) {
-        celixThreadRwlock_readLock(&instance->lock);
-        for (i = 0; i < arrayList_size(instance->trackedServices); ++i) {
-            tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
-            result = tracked->reference;
-            break;
-        }
-        celixThreadRwlock_unlock(&instance->lock);
+
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    if (snapshot != NULL && snapshot->size > 0) {
+        result = snapshot->entries[0]->reference;
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    celix_epoch_exitRead(readers);
 
 	return result;
 }
 
 array_list_pt serviceTracker_getServiceReferences(service_tracker_pt tracker) {
-    //TODO deprecated warning -> not locked
-    celix_tracked_entry_t *tracked;
-	unsigned int i;
+    //note the references are read from the snapshot, but not retained
 	array_list_pt references = NULL;
 	arrayList_create(&references);
 
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-	celix_service_tracker_instance_t *instance = tracker->instance;
-	if (instance != NULL) {
-        celixThreadRwlock_readLock(&instance->lock);
-        for (i = 0; i < arrayList_size(instance->trackedServices); i++) {
-            tracked = (celix_tracked_entry_t*) arrayList_get(instance->trackedServices, i);
-            arrayList_add(references, tracked->reference);
-        }
-        celixThreadRwlock_unlock(&instance->lock);
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    for (unsigned int i = 0; snapshot != NULL && i < snapshot->size; i++) {
+        arrayList_add(references, snapshot->entries[i]->reference);
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    celix_epoch_exitRead(readers);
 
 	return references;
 }
 
 void *serviceTracker_getService(service_tracker_pt tracker) {
-    //TODO deprecated warning -> not locked
-    celix_tracked_entry_t* tracked;
+    //note not retained, the service can be removed after the call; prefer celix_serviceTracker_useHighestRankingService
     void *service = NULL;
-	unsigned int i;
-
-	celixThreadRwlock_readLock(&tracker->instanceLock);
-	celix_service_tracker_instance_t *instance = tracker->instance;
-	if (instance != NULL) {
-        celixThreadRwlock_readLock(&instance->lock);
-        for (i = 0; i < arrayList_size(instance->trackedServices); i++) {
-            tracked = (celix_tracked_entry_t*) arrayList_get(instance->trackedServices, i);
-            service = tracked->service;
-            break;
-        }
-        celixThreadRwlock_unlock(&instance->lock);
+
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    if (snapshot != NULL && snapshot->size > 0) {
+        service = snapshot->entries[0]->service;
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    celix_epoch_exitRead(readers);
 
     return service;
 }
 
 array_list_pt serviceTracker_getServices(service_tracker_pt tracker) {
-    //TODO deprecated warning -> not locked, also make locked variant
-    celix_tracked_entry_t *tracked;
-	unsigned int i;
+    //note not retained, the services can be removed after the call; prefer celix_serviceTracker_useServices
 	array_list_pt references = NULL;
 	arrayList_create(&references);
 
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-    celix_service_tracker_instance_t *instance = tracker->instance;
-    if (instance != NULL) {
-        celixThreadRwlock_readLock(&instance->lock);
-        for (i = 0; i < arrayList_size(instance->trackedServices); i++) {
-            tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
-            arrayList_add(references, tracked->service);
-        }
-        celixThreadRwlock_unlock(&instance->lock);
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    for (unsigned int i = 0; snapshot != NULL && i < snapshot->size; i++) {
+        arrayList_add(references, snapshot->entries[i]->service);
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    celix_epoch_exitRead(readers);
 
     return references;
 }
 
 void *serviceTracker_getServiceByReference(service_tracker_pt tracker, service_reference_pt reference) {
-    //TODO deprecated warning -> not locked
-    celix_tracked_entry_t *tracked;
+    //note not retained, the service can be removed after the call
     void *service = NULL;
-	unsigned int i;
 
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-    celix_service_tracker_instance_t *instance = tracker->instance;
-    if (instance != NULL) {
-        celixThreadRwlock_readLock(&instance->lock);
-        for (i = 0; i < arrayList_size(instance->trackedServices); i++) {
-            bool equals = false;
-            tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
-            serviceReference_equals(reference, tracked->reference, &equals);
-            if (equals) {
-                service = tracked->service;
-                break;
-            }
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    for (unsigned int i = 0; snapshot != NULL && i < snapshot->size; i++) {
+        bool equals = false;
+        celix_tracked_entry_t *tracked = snapshot->entries[i];
+        serviceReference_equals(reference, tracked->reference, &equals);
+        if (equals) {
+            service = tracked->service;
+            break;
         }
-        celixThreadRwlock_unlock(&instance->lock);
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    celix_epoch_exitRead(readers);
 
 	return service;
 }
@@ -434,11 +446,12 @@ static void serviceTracker_serviceChanged(void *handle, celix_service_event_t *e
 
 size_t serviceTracker_nrOfTrackedServices(service_tracker_t *tracker) {
     size_t result = 0;
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-    celixThreadRwlock_readLock(&tracker->instance->lock);
-    result = (size_t) arrayList_size(tracker->instance->trackedServices);
-    celixThreadRwlock_unlock(&tracker->instance->lock);
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    if (snapshot != NULL) {
+        result = snapshot->size;
+    }
+    celix_epoch_exitRead(readers);
     return result;
 }
 
@@ -484,6 +497,7 @@ static celix_status_t serviceTracker_track(celix_service_tracker_instance_t *ins
 
             celixThreadRwlock_writeLock(&instance->lock);
             arrayList_add(instance->trackedServices, tracked);
+            serviceTracker_publishSnapshot(instance);
             celixThreadRwlock_unlock(&instance->lock);
 
             serviceTracker_invokeAddService(instance, tracked);
@@ -599,6 +613,10 @@ static celix_status_t serviceTracker_untrack(celix_service_tracker_instance_t* i
         }
     }
     size = arrayList_size(instance->trackedServices); //updated size
+    if (remove != NULL) {
+        //note that after publishing, no reader can retain the removed entry anymore
+        serviceTracker_publishSnapshot(instance);
+    }
     celixThreadRwlock_unlock(&instance->lock);
 
     if (size == 0) {
@@ -706,6 +724,7 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
             tracker->removeWithOwner = opts->removeWithOwner;
 
             celixThreadRwlock_create(&tracker->instanceLock, NULL);
+            celix_epoch_init(&tracker->epoch);
 
             //setting lang
             const char *lang = opts->filter.serviceLanguage;
@@ -721,6 +740,7 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
                     framework_log(tracker->context->framework->logger, CELIX_LOG_LEVEL_ERROR, __FUNCTION__, __BASE_FILE__, __LINE__,
                     "Error incorrect version range.");
                     celixThreadRwlock_destroy(&tracker->instanceLock);
+                    celix_epoch_destroy(&tracker->epoch);
                     free(tracker);
                     return NULL;
                 }
@@ -730,6 +750,7 @@ celix_service_tracker_t* celix_serviceTracker_createWithOptions(
                     framework_log(tracker->context->framework->logger, CELIX_LOG_LEVEL_ERROR, __FUNCTION__, __BASE_FILE__, __LINE__,
                                   "Error creating LDAP filter.");
                     celixThreadRwlock_destroy(&tracker->instanceLock);
+                    celix_epoch_destroy(&tracker->epoch);
                     free(tracker);
                     return NULL;
                 }
@@ -782,24 +803,16 @@ void celix_serviceTracker_destroy(celix_service_tracker_t *tracker) {
     }
 }
 
-static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracker_instance_t *instance,
-                                                            const char *serviceName /*sanity*/,
-                                                            void *callbackHandle,
-                                                            void (*use)(void *handle, void *svc),
-                                                            void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
-                                                            void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
-    bool called = false;
-    celix_tracked_entry_t *tracked = NULL;
+/**
+ * Finds the highest ranking entry in the snapshot and increases its use count.
+ * Should be called inside a read section.
+ */
+static celix_tracked_entry_t* serviceTracker_retainHighestRankingEntry(celix_tracked_snapshot_t *snapshot, const char *serviceName) {
     celix_tracked_entry_t *highest = NULL;
     long highestRank = 0;
-    unsigned int i;
 
-    //first lock tracker and get highest tracked entry
-    celixThreadRwlock_readLock(&instance->lock);
-    unsigned int size = arrayList_size(instance->trackedServices);
-
-    for (i = 0; i < size; i++) {
-        tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
+    for (unsigned int i = 0; snapshot != NULL && i < snapshot->size; i++) {
+        celix_tracked_entry_t *tracked = snapshot->entries[i];
         if (serviceName != NULL && tracked->serviceName != NULL && strncmp(tracked->serviceName, serviceName, 10*1024) == 0) {
             const char *val = properties_getWithDefault(tracked->properties, OSGI_FRAMEWORK_SERVICE_RANKING, "0");
             long rank = strtol(val, NULL, 10);
@@ -809,28 +822,49 @@ static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracke
         }
     }
     if (highest != NULL) {
-        //highest found lock tracked entry and increase use count
+        //highest found, increase use count so that the entry is not destroyed when it is untracked.
         tracked_retain(highest);
     }
-    //unlock tracker so that the tracked entry can be removed from the trackedServices list if unregistered.
-    celixThreadRwlock_unlock(&instance->lock);
+    return highest;
+}
 
-    if (highest != NULL) {
-        //got service, call, decrease use count an signal useCond after.
-        if (use != NULL) {
-            use(callbackHandle, highest->service);
-        }
-        if (useWithProperties != NULL) {
-            useWithProperties(callbackHandle, highest->service, highest->properties);
-        }
-        if (useWithOwner != NULL) {
-            useWithOwner(callbackHandle, highest->service, highest->properties, highest->serviceOwner);
-        }
-        called = true;
-        tracked_release(highest);
+/**
+ * Calls the use callbacks for the (retained) tracked entry and decreases the use count of the entry.
+ * Should be called outside a read section.
+ */
+static bool serviceTracker_useAndReleaseEntry(celix_tracked_entry_t *tracked,
+                                              void *callbackHandle,
+                                              void (*use)(void *handle, void *svc),
+                                              void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
+                                              void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
+    if (tracked == NULL) {
+        return false;
+    }
+    if (use != NULL) {
+        use(callbackHandle, tracked->service);
+    }
+    if (useWithProperties != NULL) {
+        useWithProperties(callbackHandle, tracked->service, tracked->properties);
     }
+    if (useWithOwner != NULL) {
+        useWithOwner(callbackHandle, tracked->service, tracked->properties, tracked->serviceOwner);
+    }
+    tracked_release(tracked);
+    return true;
+}
 
-    return called;
+static bool serviceTracker_useHighestRankingServiceInternal(celix_service_tracker_instance_t *instance,
+                                                            const char *serviceName /*sanity*/,
+                                                            void *callbackHandle,
+                                                            void (*use)(void *handle, void *svc),
+                                                            void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
+                                                            void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
+    //first get and retain the highest tracked entry, then use it outside the read section
+    size_t *readers = celix_epoch_enterRead(instance->epoch);
+    celix_tracked_entry_t *highest = serviceTracker_retainHighestRankingEntry(__atomic_load_n(&instance->snapshot, __ATOMIC_SEQ_CST), serviceName);
+    celix_epoch_exitRead(readers);
+
+    return serviceTracker_useAndReleaseEntry(highest, callbackHandle, use, useWithProperties, useWithOwner);
 }
 
 
@@ -847,11 +881,10 @@ bool celix_serviceTracker_useHighestRankingService(
     struct timespec start, now;
     clock_gettime(CLOCK_MONOTONIC, &start);
     do {
-        celixThreadRwlock_readLock(&tracker->instanceLock);
-        if (tracker->instance != NULL) {
-            called = serviceTracker_useHighestRankingServiceInternal(tracker->instance, serviceName, callbackHandle, use, useWithProperties, useWithOwner);
-        }
-        celixThreadRwlock_unlock(&tracker->instanceLock);
+        size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+        celix_tracked_entry_t *highest = serviceTracker_retainHighestRankingEntry(serviceTracker_loadSnapshot(tracker), serviceName);
+        celix_epoch_exitRead(readers);
+        called = serviceTracker_useAndReleaseEntry(highest, callbackHandle, use, useWithProperties, useWithOwner);
 
         if (waitTimeoutInSeconds <= 0) {
             break;
@@ -867,6 +900,20 @@ bool celix_serviceTracker_useHighestRankingService(
     return called;
 }
 
+bool celix_serviceTracker_isTrackingServiceFactory(celix_service_tracker_t *tracker) {
+    bool result = false;
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    for (unsigned int i = 0; !result && snapshot != NULL && i < snapshot->size; ++i) {
+        celix_tracked_entry_t *tracked = snapshot->entries[i];
+        service_registration_t *reg = NULL;
+        serviceReference_getServiceRegistration(tracked->reference, &reg);
+        result = reg != NULL && serviceRegistration_isFactoryService(reg);
+    }
+    celix_epoch_exitRead(readers);
+    return result;
+}
+
 size_t celix_serviceTracker_useServices(
         service_tracker_t *tracker,
         const char* serviceName /*sanity*/,
@@ -875,40 +922,27 @@ size_t celix_serviceTracker_useServices(
         void (*useWithProperties)(void *handle, void *svc, const celix_properties_t *props),
         void (*useWithOwner)(void *handle, void *svc, const celix_properties_t *props, const celix_bundle_t *owner)) {
     size_t count = 0;
-    celixThreadRwlock_readLock(&tracker->instanceLock);
-    celix_service_tracker_instance_t *instance = tracker->instance;
-    if (instance != NULL) {
-        //first lock tracker, get tracked entries and increase use count
-        celixThreadRwlock_readLock(&instance->lock);
-        int size = celix_arrayList_size(instance->trackedServices);
-        count = (size_t)size;
-        celix_tracked_entry_t *entries[size];
-        for (int i = 0; i < size; i++) {
-            celix_tracked_entry_t *tracked = (celix_tracked_entry_t *) arrayList_get(instance->trackedServices, i);
-            tracked_retain(tracked);
-            entries[i] = tracked;
+    celix_tracked_entry_t **entries = NULL;
+
+    //first get tracked entries from the snapshot and increase use count
+    size_t *readers = celix_epoch_enterRead(&tracker->epoch);
+    celix_tracked_snapshot_t *snapshot = serviceTracker_loadSnapshot(tracker);
+    if (snapshot != NULL && snapshot->size > 0) {
+        count = snapshot->size;
+        entries = malloc(count * sizeof(*entries));
+        for (size_t i = 0; i < count; i++) {
+            tracked_retain(snapshot->entries[i]);
+            entries[i] = snapshot->entries[i];
         }
-        //unlock tracker so that the tracked entry can be removed from the trackedServices list if unregistered.
-        celixThreadRwlock_unlock(&instance->lock);
-
-        //then use entries and decrease use count
-        for (int i = 0; i < size; i++) {
-            celix_tracked_entry_t *entry = entries[i];
-            //got service, call, decrease use count an signal useCond after.
-            if (use != NULL) {
-                use(callbackHandle, entry->service);
-            }
-            if (useWithProperties != NULL) {
-                useWithProperties(callbackHandle, entry->service, entry->properties);
-            }
-            if (useWithOwner != NULL) {
-                useWithOwner(callbackHandle, entry->service, entry->properties, entry->serviceOwner);
-            }
+    }
+    //exit read section before calling back, so that tracked entries can be untracked while being used.
+    celix_epoch_exitRead(readers);
 
-            tracked_release(entry);
-        }
+    //then use entries and decrease use count
+    for (size_t i = 0; i < count; i++) {
+        serviceTracker_useAndReleaseEntry(entries[i], callbackHandle, use, useWithProperties, useWithOwner);
     }
-    celixThreadRwlock_unlock(&tracker->instanceLock);
+    free(entries);
     return count;
 }
 
@@ -1005,6 +1039,7 @@ static void* shutdownServiceTrackerInstanceHandler(void *data) {
     celixThreadMutex_destroy(&instance->mutex);
     celixThreadRwlock_destroy(&instance->lock);
     celix_arrayList_destroy(instance->trackedServices);
+    free(instance->snapshot);
     free(instance->filter);
 
     serviceTracker_remInstanceFromShutdownList(instance);
@@ -22,6 +22,18 @@
 
 #include "service_tracker.h"
 #include "celix_types.h"
+#include "celix_epoch.h"
+
+typedef struct celix_tracked_entry celix_tracked_entry_t;
+
+/**
+ * Immutable snapshot of the tracked services. Published by the writers (track, untrack and close) and read without
+ * locking.
+ */
+typedef struct celix_tracked_snapshot {
+	unsigned int size;
+	celix_tracked_entry_t *entries[];
+} celix_tracked_snapshot_t;
 
 //instance for an active per open statement and removed per close statement
 typedef struct celix_service_tracker_instance {
@@ -53,9 +65,12 @@ typedef struct celix_service_tracker_instance {
 	void (*removeWithOwner)(void *handle, void *svc, const properties_t *props, const bundle_t *owner);
 	void (*modifiedWithOwner)(void *handle, void *svc, const properties_t *props, const bundle_t *owner);
 
-	celix_thread_rwlock_t lock; //projects trackedServices
+	celix_thread_rwlock_t lock; //projects trackedServices, serializes the snapshot writers
 	array_list_t *trackedServices;
 
+	celix_epoch_t *epoch; //epoch of the tracker
+	celix_tracked_snapshot_t *snapshot; //atomic, snapshot of trackedServices
+
 	celix_thread_mutex_t mutex; //protect current highest service id
 	long currentHighestServiceId;
 
@@ -86,22 +101,29 @@ struct celix_serviceTracker {
 	void (*removeWithOwner)(void *handle, void *svc, const properties_t *props, const bundle_t *owner);
 	void (*modifiedWithOwner)(void *handle, void *svc, const properties_t *props, const bundle_t *owner);
 
-	celix_thread_rwlock_t instanceLock;
-	celix_service_tracker_instance_t *instance; /*NULL -> close, !NULL->open*/
+	celix_thread_rwlock_t instanceLock; //serializes open and close
+	celix_service_tracker_instance_t *instance; /*atomic, NULL -> close, !NULL->open*/
+
+	celix_epoch_t epoch;
 
 };
 
-typedef struct celix_tracked_entry {
+struct celix_tracked_entry {
 	service_reference_pt reference;
 	void *service;
 	const char *serviceName;
 	properties_t *properties;
 	bundle_t *serviceOwner;
 
-    celix_thread_mutex_t mutex; //protects useCount
+    celix_thread_mutex_t mutex; //used to signal useCount == 0
 	celix_thread_cond_t useCond;
-    size_t useCount;
-} celix_tracked_entry_t;
+    size_t useCount; //atomic
+};
+
+/**
+ * Returns whether one of the services tracked by the service tracker is provided by a service factory.
+ */
+bool celix_serviceTracker_isTrackingServiceFactory(celix_service_tracker_t *tracker);
 
 
 #endif /* SERVICE_TRACKER_PRIVATE_H_ */
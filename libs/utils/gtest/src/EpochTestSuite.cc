@@ -0,0 +1,87 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "celix_epoch.h"
+
+class EpochTestSuite : public ::testing::Test {};
+
+TEST_F(EpochTestSuite, SynchronizeWithoutReaders) {
+    celix_epoch_t epoch;
+    celix_epoch_init(&epoch);
+    celix_epoch_synchronize(&epoch);
+    celix_epoch_synchronize(&epoch);
+    celix_epoch_destroy(&epoch);
+}
+
+TEST_F(EpochTestSuite, SynchronizeWaitsForReaders) {
+    celix_epoch_t epoch;
+    celix_epoch_init(&epoch);
+
+    size_t *readers = celix_epoch_enterRead(&epoch);
+    std::atomic<bool> synchronized{false};
+    std::thread writer{[&]{
+        celix_epoch_synchronize(&epoch);
+        synchronized = true;
+    }};
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    EXPECT_FALSE(synchronized.load());
+    celix_epoch_exitRead(readers);
+    writer.join();
+    EXPECT_TRUE(synchronized.load());
+
+    celix_epoch_destroy(&epoch);
+}
+
+TEST_F(EpochTestSuite, ReclaimPublishedData) {
+    celix_epoch_t epoch;
+    celix_epoch_init(&epoch);
+    std::atomic<int*> data{new int{0}};
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> readerThreads{};
+    for (int i = 0; i < 4; ++i) {
+        readerThreads.emplace_back([&]{
+            while (!stop) {
+                size_t *readers = celix_epoch_enterRead(&epoch);
+                int *value = data.load();
+                EXPECT_GE(*value, 0); //data is not reclaimed inside a read section
+                celix_epoch_exitRead(readers);
+            }
+        });
+    }
+
+    for (int i = 1; i <= 1000; ++i) {
+        int *old = data.exchange(new int{i});
+        celix_epoch_synchronize(&epoch);
+        *old = -1;
+        delete old;
+    }
+    stop = true;
+    for (auto& t : readerThreads) {
+        t.join();
+    }
+    delete data.load();
+    celix_epoch_destroy(&epoch);
+}
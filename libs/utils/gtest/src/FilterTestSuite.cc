@@ -0,0 +1,130 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "celix_filter.h"
+#include "celix_properties.h"
+
+class FilterTestSuite : public ::testing::Test {};
+
+static bool matchFilter(const char *filterStr, const celix_properties_t *props) {
+    celix_filter_t *filter = celix_filter_create(filterStr);
+    EXPECT_TRUE(filter != nullptr);
+    bool result = celix_filter_match(filter, props);
+    celix_filter_destroy(filter);
+    return result;
+}
+
+TEST_F(FilterTestSuite, OrderedComparatorsUseTypedValues) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "long", "10");
+    celix_properties_set(props, "double", "1.5");
+    celix_properties_set(props, "negative", "-1.5");
+    celix_properties_set(props, "version", "1.10.0");
+    celix_properties_set(props, "string", "abc");
+
+    EXPECT_TRUE(matchFilter("(long>9)", props));
+    EXPECT_TRUE(matchFilter("(long>=10)", props));
+    EXPECT_FALSE(matchFilter("(long<9)", props));
+    EXPECT_TRUE(matchFilter("(long<=10)", props));
+
+    EXPECT_TRUE(matchFilter("(double>1.25)", props));
+    EXPECT_FALSE(matchFilter("(double<=1.25)", props));
+    EXPECT_TRUE(matchFilter("(double<10.0)", props));
+    EXPECT_TRUE(matchFilter("(negative>-1.75)", props));
+
+    EXPECT_TRUE(matchFilter("(version>1.9.0)", props));
+    EXPECT_TRUE(matchFilter("(&(version>=1.0.0)(version<2.0.0))", props));
+    EXPECT_FALSE(matchFilter("(version<1.9.9.qualifier)", props));
+
+    //a <major>.<minor> value is a decimal, not a version
+    celix_properties_set(props, "decimal", "1.10");
+    EXPECT_FALSE(matchFilter("(decimal>1.9)", props));
+    EXPECT_TRUE(matchFilter("(decimal<1.9)", props));
+
+    //not convertible -> string compare
+    EXPECT_TRUE(matchFilter("(string>abb)", props));
+    EXPECT_FALSE(matchFilter("(string<abb)", props));
+    EXPECT_TRUE(matchFilter("(long<abc)", props));
+
+    //equal stays a exact string compare
+    EXPECT_TRUE(matchFilter("(long=10)", props));
+    EXPECT_FALSE(matchFilter("(long=010)", props));
+
+    celix_properties_destroy(props);
+}
+
+TEST_F(FilterTestSuite, SubstringMatch) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "name", "celix_framework_service");
+
+    EXPECT_TRUE(matchFilter("(name=celix*)", props));
+    EXPECT_TRUE(matchFilter("(name=*service)", props));
+    EXPECT_TRUE(matchFilter("(name=*frame*)", props));
+    EXPECT_TRUE(matchFilter("(name=celix*work*service)", props));
+    EXPECT_TRUE(matchFilter("(name=c*_*_*e)", props));
+    EXPECT_FALSE(matchFilter("(name=celix*charsNotPresent)", props));
+    EXPECT_FALSE(matchFilter("(name=framework*)", props));
+    EXPECT_FALSE(matchFilter("(name=*celix)", props));
+    EXPECT_FALSE(matchFilter("(name=celix*xilec*)", props));
+    EXPECT_FALSE(matchFilter("(name=celix_framework*framework_service)", props));
+    EXPECT_FALSE(matchFilter("(missing=celix*)", props));
+
+    celix_properties_destroy(props);
+}
+
+TEST_F(FilterTestSuite, MatchBenchmark) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "objectClass", "org.example.Calculator");
+    celix_properties_set(props, "service.id", "42");
+    celix_properties_set(props, "service.lang", "C");
+    celix_properties_set(props, "service.version", "1.2.3");
+    celix_properties_set(props, "service.ranking", "100");
+    celix_properties_set(props, "endpoint.id", "4c8c5d43-1c7b-4c1a-8a1d-b6d4bc0e0d0e");
+
+    const char* shapes[] = {
+            "(objectClass=org.example.Calculator)",
+            "(&(objectClass=org.example.Calculator)(service.lang=C))",
+            "(&(objectClass=org.example.Calculator)(service.lang=C)(&(service.version>=1.0.0)(service.version<2.0.0)))",
+            "(|(service.lang=C++)(service.lang=C))",
+            "(&(objectClass=org.example.*)(!(service.ranking<10)))",
+            "(endpoint.id=*-8a1d-*)",
+            "(service.ranking=*)",
+    };
+
+    const int nrOfMatches = 100000;
+    for (auto *shape : shapes) {
+        celix_filter_t *filter = celix_filter_create(shape);
+        ASSERT_TRUE(filter != nullptr);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < nrOfMatches; ++i) {
+            EXPECT_TRUE(celix_filter_match(filter, props));
+        }
+        auto end = std::chrono::steady_clock::now();
+        double avg = std::chrono::duration<double, std::nano>(end - start).count() / nrOfMatches;
+        std::cout << "Avg match for " << shape << ": " << avg << " ns" << std::endl;
+        celix_filter_destroy(filter);
+    }
+
+    celix_properties_destroy(props);
+}
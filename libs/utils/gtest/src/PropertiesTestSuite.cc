@@ -0,0 +1,216 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "celix_properties.h"
+#include "celix_version.h"
+
+class PropertiesTestSuite : public ::testing::Test {};
+
+TEST_F(PropertiesTestSuite, SetGetUnset) {
+    celix_properties_t *props = celix_properties_create();
+    EXPECT_EQ(0, celix_properties_size(props));
+
+    celix_properties_set(props, "key1", "value1");
+    celix_properties_set(props, "key2", "a value which is too long to be stored inline in a property entry");
+    EXPECT_EQ(2, celix_properties_size(props));
+    EXPECT_STREQ("value1", celix_properties_get(props, "key1", nullptr));
+    EXPECT_STREQ("a value which is too long to be stored inline in a property entry", celix_properties_get(props, "key2", nullptr));
+    EXPECT_STREQ("default", celix_properties_get(props, "key3", "default"));
+
+    //update short -> long -> short, including setting a value with the current value
+    celix_properties_set(props, "key1", "another value which is too long to be stored inline");
+    EXPECT_STREQ("another value which is too long to be stored inline", celix_properties_get(props, "key1", nullptr));
+    celix_properties_set(props, "key1", celix_properties_get(props, "key1", nullptr));
+    EXPECT_STREQ("another value which is too long to be stored inline", celix_properties_get(props, "key1", nullptr));
+    celix_properties_set(props, "key1", "short");
+    EXPECT_STREQ("short", celix_properties_get(props, "key1", nullptr));
+    EXPECT_EQ(2, celix_properties_size(props));
+
+    celix_properties_unset(props, "key1");
+    celix_properties_unset(props, "key3");
+    EXPECT_EQ(1, celix_properties_size(props));
+    EXPECT_EQ(nullptr, celix_properties_get(props, "key1", nullptr));
+
+    //reuse of unset entries
+    for (int i = 0; i < 100; ++i) {
+        celix_properties_set(props, "key1", "a value which is too long to be stored inline in a property entry");
+        celix_properties_unset(props, "key1");
+    }
+    EXPECT_EQ(1, celix_properties_size(props));
+
+    char *value4 = strdup("value4");
+    celix_properties_setWithoutCopy(props, strdup("key4"), value4);
+    EXPECT_EQ(value4, celix_properties_get(props, "key4", nullptr));
+    celix_properties_setWithoutCopy(props, strdup("key4"), strdup("updated"));
+    EXPECT_STREQ("updated", celix_properties_get(props, "key4", nullptr));
+    celix_properties_unset(props, "key4");
+    celix_properties_set(props, "key4", "reused");
+    EXPECT_STREQ("reused", celix_properties_get(props, "key4", nullptr));
+
+    celix_properties_destroy(props);
+}
+
+TEST_F(PropertiesTestSuite, LargeValuesAreNotTruncated) {
+    celix_properties_t *props = celix_properties_create();
+    std::string large(2 * 1024 * 1024 + 1, 'x');
+    celix_properties_set(props, "large", large.c_str());
+    celix_properties_set(props, "small", "value");
+    EXPECT_EQ(large.size(), strlen(celix_properties_get(props, "large", "")));
+    EXPECT_STREQ("value", celix_properties_get(props, "small", nullptr));
+
+    large.append("y");
+    celix_properties_set(props, "large", large.c_str());
+    EXPECT_EQ(large, celix_properties_get(props, "large", ""));
+
+    celix_properties_t *copy = celix_properties_copy(props);
+    EXPECT_EQ(large, celix_properties_get(copy, "large", ""));
+    celix_properties_destroy(copy);
+    celix_properties_destroy(props);
+}
+
+TEST_F(PropertiesTestSuite, ManyEntriesAndIteration) {
+    celix_properties_t *props = celix_properties_create();
+    const int nrOfEntries = 1000;
+    for (int i = 0; i < nrOfEntries; ++i) {
+        std::string key = "key" + std::to_string(i);
+        std::string val = "value" + std::to_string(i);
+        celix_properties_set(props, key.c_str(), val.c_str());
+    }
+    for (int i = 0; i < nrOfEntries; i += 2) {
+        std::string key = "key" + std::to_string(i);
+        celix_properties_unset(props, key.c_str());
+    }
+    EXPECT_EQ(nrOfEntries / 2, celix_properties_size(props));
+
+    std::set<std::string> keys{};
+    const char *key = nullptr;
+    CELIX_PROPERTIES_FOR_EACH(props, key) {
+        keys.insert(key);
+    }
+    EXPECT_EQ(nrOfEntries / 2, (int)keys.size());
+    for (int i = 1; i < nrOfEntries; i += 2) {
+        std::string k = "key" + std::to_string(i);
+        std::string val = "value" + std::to_string(i);
+        EXPECT_EQ(1, (int)keys.count(k));
+        EXPECT_STREQ(val.c_str(), celix_properties_get(props, k.c_str(), nullptr));
+    }
+
+    celix_properties_t *copy = celix_properties_copy(props);
+    EXPECT_EQ(nrOfEntries / 2, celix_properties_size(copy));
+    celix_properties_destroy(props);
+    for (int i = 1; i < nrOfEntries; i += 2) {
+        std::string k = "key" + std::to_string(i);
+        std::string val = "value" + std::to_string(i);
+        EXPECT_STREQ(val.c_str(), celix_properties_get(copy, k.c_str(), nullptr));
+    }
+    celix_properties_set(copy, "extra", "a value which is too long to be stored inline in a property entry");
+    EXPECT_EQ(nrOfEntries / 2 + 1, celix_properties_size(copy));
+    celix_properties_destroy(copy);
+}
+
+TEST_F(PropertiesTestSuite, TypedValues) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_setLong(props, "long", -42);
+    celix_properties_setDouble(props, "double", 3.25);
+    celix_properties_setBool(props, "bool", true);
+    celix_properties_set(props, "longStr", "123");
+    celix_properties_set(props, "doubleStr", "1.5");
+    celix_properties_set(props, "boolStr", "FALSE");
+    celix_properties_set(props, "partial", "12abc");
+
+    EXPECT_STREQ("-42", celix_properties_get(props, "long", nullptr));
+    EXPECT_EQ(-42, celix_properties_getAsLong(props, "long", 0));
+    EXPECT_EQ(3.25, celix_properties_getAsDouble(props, "double", 0.0));
+    EXPECT_TRUE(celix_properties_getAsBool(props, "bool", false));
+    EXPECT_STREQ("true", celix_properties_get(props, "bool", nullptr));
+    EXPECT_EQ(123, celix_properties_getAsLong(props, "longStr", 0));
+    EXPECT_EQ(123.0, celix_properties_getAsDouble(props, "longStr", 0.0));
+    EXPECT_EQ(1.5, celix_properties_getAsDouble(props, "doubleStr", 0.0));
+    EXPECT_EQ(1, celix_properties_getAsLong(props, "doubleStr", 0));
+    EXPECT_FALSE(celix_properties_getAsBool(props, "boolStr", true));
+    EXPECT_EQ(12, celix_properties_getAsLong(props, "partial", 0));
+    EXPECT_EQ(7, celix_properties_getAsLong(props, "missing", 7));
+
+    //typed value is updated with a string value
+    celix_properties_set(props, "long", "not a long");
+    EXPECT_EQ(7, celix_properties_getAsLong(props, "long", 7));
+
+    celix_version_t *version = celix_version_createVersion(1, 2, 3, "qualifier");
+    celix_properties_setVersion(props, "version", version);
+    EXPECT_STREQ("1.2.3.qualifier", celix_properties_get(props, "version", nullptr));
+    celix_properties_t *copy = celix_properties_copy(props);
+    celix_version_t *result = celix_properties_getAsVersion(copy, "version", nullptr);
+    ASSERT_TRUE(result != nullptr);
+    EXPECT_EQ(0, celix_version_compareTo(version, result));
+    celix_version_destroy(result);
+
+    celix_properties_set(copy, "invalidVersion", "a.b.c");
+    result = celix_properties_getAsVersion(copy, "invalidVersion", version);
+    EXPECT_EQ(0, celix_version_compareTo(version, result));
+    celix_version_destroy(result);
+    celix_properties_set(copy, "versionStr", "2.0.0");
+    result = celix_properties_getAsVersion(copy, "versionStr", nullptr);
+    ASSERT_TRUE(result != nullptr);
+    EXPECT_EQ(2, celix_version_getMajor(result));
+    celix_version_destroy(result);
+    EXPECT_EQ(nullptr, celix_properties_getAsVersion(copy, "missing", nullptr));
+
+    celix_version_destroy(version);
+    celix_properties_destroy(copy);
+    celix_properties_destroy(props);
+}
+
+TEST_F(PropertiesTestSuite, CopyAndLookupBenchmark) {
+    celix_properties_t *props = celix_properties_create();
+    celix_properties_set(props, "objectClass", "org.example.benchmark.Service");
+    celix_properties_setLong(props, "service.id", 42);
+    celix_properties_set(props, "service.lang", "C");
+    celix_properties_set(props, "service.version", "1.0.0");
+    celix_properties_setLong(props, "service.ranking", 10);
+    celix_properties_set(props, "endpoint.framework.uuid", "4ec32b84-54b6-4fd7-8a69-21e8e0f0dba5");
+
+    const int nrOfIterations = 100000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nrOfIterations; ++i) {
+        celix_properties_t *copy = celix_properties_copy(props);
+        celix_properties_destroy(copy);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double copyNs = std::chrono::duration<double, std::nano>(end - start).count() / nrOfIterations;
+
+    long total = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nrOfIterations; ++i) {
+        total += celix_properties_getAsLong(props, "service.ranking", 0);
+    }
+    end = std::chrono::steady_clock::now();
+    double getNs = std::chrono::duration<double, std::nano>(end - start).count() / nrOfIterations;
+    EXPECT_EQ(10L * nrOfIterations, total);
+
+    std::cout << "Avg properties copy+destroy: " << copyNs << " ns" << std::endl;
+    std::cout << "Avg properties getAsLong:    " << getNs << " ns" << std::endl;
+    celix_properties_destroy(props);
+}
@@ -0,0 +1,75 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#ifndef CELIX_EPOCH_H
+#define CELIX_EPOCH_H
+
+#include <stddef.h>
+
+#include "celix_threads.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CELIX_EPOCH_NR_OF_READ_STRIPES 16
+
+typedef struct celix_epoch_read_stripe {
+    size_t readers[2]; //atomic, nr of active readers per epoch
+    char padding[128 - 2 * sizeof(size_t)]; //keep stripes on separate cache lines
+} celix_epoch_read_stripe_t;
+
+/**
+ * Epoch based reclamation for lock-free read paths.
+ *
+ * Readers register themselves in the reader count of the current epoch (striped over cache lines, so that readers
+ * on different cores do not contend). A writer publishes a new version of the data (e.g. with an atomic exchange)
+ * and calls celix_epoch_synchronize, after which no reader can use the previous version anymore and it can be freed.
+ */
+typedef struct celix_epoch {
+    unsigned int current; //atomic
+    char padding[128 - sizeof(unsigned int)];
+    celix_epoch_read_stripe_t stripes[CELIX_EPOCH_NR_OF_READ_STRIPES];
+    celix_thread_mutex_t syncMutex; //serializes writers waiting for the readers
+} celix_epoch_t;
+
+void celix_epoch_init(celix_epoch_t *epoch);
+
+void celix_epoch_destroy(celix_epoch_t *epoch);
+
+/**
+ * Enters a read section. Data loaded between enter and exit will not be reclaimed by writers.
+ * Read sections should be short and should not call back into user code.
+ * Returns the reader count to pass to celix_epoch_exitRead.
+ */
+size_t* celix_epoch_enterRead(celix_epoch_t *epoch);
+
+void celix_epoch_exitRead(size_t *readers);
+
+/**
+ * Waits till all read sections which could have seen previously published data are exited.
+ * Can be called concurrently, but should not be called inside a read section.
+ */
+void celix_epoch_synchronize(celix_epoch_t *epoch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //CELIX_EPOCH_H
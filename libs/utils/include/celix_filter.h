@@ -43,6 +43,7 @@ typedef enum celix_filter_operand_enum
 } celix_filter_operand_t;
 
 typedef struct celix_filter_struct celix_filter_t;
+typedef struct celix_filter_internal celix_filter_internal_t;
 
 struct celix_filter_struct {
     celix_filter_operand_t operand;
@@ -53,6 +54,10 @@ struct celix_filter_struct {
     //type is celix_filter_t* for AND, OR and NOT operator and char* for SUBSTRING
     //for other operands children is NULL
     celix_array_list_t *children;
+
+    //prepared form of the filter (pre-hashed attribute, pre-parsed value), created by celix_filter_create.
+    //for internal use only, can be NULL.
+    celix_filter_internal_t *internal;
 };
 
 
@@ -22,6 +22,7 @@
 #include "hash_map.h"
 #include "exports.h"
 #include "celix_errno.h"
+#include "celix_version.h"
 
 #ifndef CELIX_PROPERTIES_H_
 #define CELIX_PROPERTIES_H_
@@ -30,8 +31,13 @@
 extern "C" {
 #endif
 
-typedef hash_map_t celix_properties_t;
-typedef hash_map_iterator_t celix_properties_iterator_t;
+typedef struct celix_properties celix_properties_t;
+
+typedef struct celix_properties_iterator {
+    //private data, use the celix_propertiesIterator_* functions
+    const celix_properties_t *_properties;
+    unsigned int _index;
+} celix_properties_iterator_t;
 
 
 /**********************************************************************************************************************
@@ -72,6 +78,17 @@ void celix_properties_setBool(celix_properties_t *props, const char *key, bool v
 void celix_properties_setDouble(celix_properties_t *props, const char *key, double val);
 double celix_properties_getAsDouble(const celix_properties_t *props, const char *key, double defaultValue);
 
+/**
+ * Sets a version property. The string value is the celix_version_toString representation.
+ */
+void celix_properties_setVersion(celix_properties_t *props, const char *key, const celix_version_t *version);
+
+/**
+ * Returns a new version for the property value or a copy of the defaultValue if the property is not present or
+ * not a valid version. The caller is owner of the returned version (can be NULL).
+ */
+celix_version_t* celix_properties_getAsVersion(const celix_properties_t *props, const char *key, const celix_version_t *defaultValue);
+
 int celix_properties_size(const celix_properties_t *properties);
 
 celix_properties_iterator_t celix_propertiesIterator_construct(const celix_properties_t *properties);
@@ -79,7 +96,7 @@ bool celix_propertiesIterator_hasNext(celix_properties_iterator_t *iter);
 const char* celix_propertiesIterator_nextKey(celix_properties_iterator_t *iter);
 
 #define CELIX_PROPERTIES_FOR_EACH(props, key) \
-    for(hash_map_iterator_t iter = celix_propertiesIterator_construct(props); \
+    for(celix_properties_iterator_t iter = celix_propertiesIterator_construct(props); \
         celix_propertiesIterator_hasNext(&iter), (key) = celix_propertiesIterator_nextKey(&iter);)
 
 
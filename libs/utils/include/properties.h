@@ -44,8 +44,8 @@ extern "C" {
 #define CELIX_DEPRECATED_ATTR
 #endif
 
-typedef hash_map_pt properties_pt CELIX_DEPRECATED_ATTR;
-typedef hash_map_t properties_t CELIX_DEPRECATED_ATTR;
+typedef celix_properties_t* properties_pt CELIX_DEPRECATED_ATTR;
+typedef celix_properties_t properties_t CELIX_DEPRECATED_ATTR;
 
 UTILS_EXPORT celix_properties_t* properties_create(void);
 
@@ -70,8 +70,8 @@ UTILS_EXPORT void properties_unset(celix_properties_t *properties, const char *k
 UTILS_EXPORT celix_status_t properties_copy(celix_properties_t *properties, celix_properties_t **copy);
 
 #define PROPERTIES_FOR_EACH(props, key) \
-    for(hash_map_iterator_t iter = hashMapIterator_construct(props); \
-        hashMapIterator_hasNext(&iter), (key) = (const char*)hashMapIterator_nextKey(&iter);)
+    for(celix_properties_iterator_t iter = celix_propertiesIterator_construct(props); \
+        celix_propertiesIterator_hasNext(&iter), (key) = celix_propertiesIterator_nextKey(&iter);)
 
 
 #ifdef __cplusplus
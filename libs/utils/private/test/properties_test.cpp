@@ -66,7 +66,7 @@ TEST(properties, create) {
 TEST(properties, load) {
     char propertiesFile[] = "resources-test/properties.txt";
     properties = celix_properties_load(propertiesFile);
-    LONGS_EQUAL(4, hashMap_size(properties));
+    LONGS_EQUAL(4, celix_properties_size(properties));
 
     const char keyA[] = "a";
     const char *valueA = celix_properties_get(properties, keyA, NULL);
@@ -129,7 +129,7 @@ TEST(properties, store) {
 TEST(properties, copy) {
     char propertiesFile[] = "resources-test/properties.txt";
     properties = celix_properties_load(propertiesFile);
-    LONGS_EQUAL(4, hashMap_size(properties));
+    LONGS_EQUAL(4, celix_properties_size(properties));
 
     celix_properties_t *copy = celix_properties_copy(properties);
 
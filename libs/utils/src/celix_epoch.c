@@ -0,0 +1,66 @@
+/**
+ *Licensed to the Apache Software Foundation (ASF) under one
+ *or more contributor license agreements.  See the NOTICE file
+ *distributed with this work for additional information
+ *regarding copyright ownership.  The ASF licenses this file
+ *to you under the Apache License, Version 2.0 (the
+ *"License"); you may not use this file except in compliance
+ *with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *Unless required by applicable law or agreed to in writing,
+ *software distributed under the License is distributed on an
+ *"AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ *specific language governing permissions and limitations
+ *under the License.
+ */
+
+#include "celix_epoch.h"
+
+#include <string.h>
+#include <sched.h>
+
+static unsigned int g_nextReadStripe = 0; //atomic
+static __thread int g_readStripe = -1; //read stripe of the current thread, assigned round robin on first use
+
+void celix_epoch_init(celix_epoch_t *epoch) {
+    memset(epoch, 0, sizeof(*epoch));
+    celixThreadMutex_create(&epoch->syncMutex, NULL);
+}
+
+void celix_epoch_destroy(celix_epoch_t *epoch) {
+    celixThreadMutex_destroy(&epoch->syncMutex);
+}
+
+size_t* celix_epoch_enterRead(celix_epoch_t *epoch) {
+    if (g_readStripe < 0) {
+        g_readStripe = (int)(__atomic_fetch_add(&g_nextReadStripe, 1, __ATOMIC_RELAXED) % CELIX_EPOCH_NR_OF_READ_STRIPES);
+    }
+    unsigned int idx = __atomic_load_n(&epoch->current, __ATOMIC_SEQ_CST) & 1u;
+    size_t *readers = &epoch->stripes[g_readStripe].readers[idx];
+    __atomic_add_fetch(readers, 1, __ATOMIC_SEQ_CST);
+    return readers;
+}
+
+void celix_epoch_exitRead(size_t *readers) {
+    __atomic_sub_fetch(readers, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Two epoch flips are needed, because a reader can load the epoch index just before a flip and increase the reader
+ * count of that (old) epoch after the writer already waited for it.
+ */
+void celix_epoch_synchronize(celix_epoch_t *epoch) {
+    celixThreadMutex_lock(&epoch->syncMutex);
+    for (int round = 0; round < 2; ++round) {
+        unsigned int old = __atomic_fetch_xor(&epoch->current, 1u, __ATOMIC_SEQ_CST) & 1u;
+        for (int i = 0; i < CELIX_EPOCH_NR_OF_READ_STRIPES; ++i) {
+            while (__atomic_load_n(&epoch->stripes[i].readers[old], __ATOMIC_SEQ_CST) != 0) {
+                sched_yield();
+            }
+        }
+    }
+    celixThreadMutex_unlock(&epoch->syncMutex);
+}
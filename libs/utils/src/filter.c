@@ -22,11 +22,42 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <assert.h>
+#include <errno.h>
 #include <utils.h>
 
 #include "celix_filter.h"
 #include "filter.h"
 #include "celix_errno.h"
+#include "properties_private.h"
+
+/**
+ * Version parsed from a filter or property value, without allocating memory.
+ * The qualifier points to the parsed string.
+ */
+typedef struct celix_filter_version {
+    long major;
+    long minor;
+    long micro;
+    const char *qualifier;
+    size_t qualifierLen;
+} celix_filter_version_t;
+
+/**
+ * The prepared form of a filter node. Created once in celix_filter_create, so that celix_filter_match
+ * does not need to hash the attribute, re-parse the filter value or allocate memory per match.
+ */
+struct celix_filter_internal {
+    unsigned int attributeHash;
+
+    bool convertedToLong;
+    long longValue;
+    bool convertedToDouble;
+    double doubleValue;
+    bool convertedToVersion;
+    celix_filter_version_t versionValue;
+
+    size_t *substringLengths; //for SUBSTRING: the length of every children entry (0 for a '*' wildcard)
+};
 
 static void filter_skipWhiteSpace(char* filterString, int* pos);
 static celix_filter_t * filter_parseFilter(char* filterString, int* pos);
@@ -39,6 +70,8 @@ static char * filter_parseValue(char* filterString, int* pos);
 static celix_array_list_t* filter_parseSubstring(char* filterString, int* pos);
 
 static celix_status_t filter_compare(const celix_filter_t* filter, const char *propertyValue, bool *result);
+static bool filter_compile(celix_filter_t *filter);
+static void filter_destroyInternal(celix_filter_t *filter);
 
 static void filter_skipWhiteSpace(char * filterString, int * pos) {
     int length;
@@ -412,6 +445,167 @@ celix_status_t filter_match(celix_filter_t * filter, celix_properties_t *propert
     return CELIX_SUCCESS;
 }
 
+static bool filter_parseLong(const char *str, long *out) {
+    char *end = NULL;
+    errno = 0;
+    long val = strtol(str, &end, 10);
+    if (end == str || *end != '\0' || errno != 0) {
+        return false;
+    }
+    *out = val;
+    return true;
+}
+
+static bool filter_parseDouble(const char *str, double *out) {
+    if (!isdigit((unsigned char)str[0]) && str[0] != '-' && str[0] != '+' && str[0] != '.') {
+        return false; //note prevent parsing of inf, nan, etc
+    }
+    char *end = NULL;
+    errno = 0;
+    double val = strtod(str, &end);
+    if (end == str || *end != '\0' || errno != 0) {
+        return false;
+    }
+    *out = val;
+    return true;
+}
+
+static bool filter_parseVersionPart(const char **str, long *out) {
+    const char *begin = *str;
+    long val = 0;
+    while (isdigit((unsigned char)**str)) {
+        val = val * 10 + (**str - '0');
+        (*str)++;
+    }
+    *out = val;
+    return *str != begin;
+}
+
+/**
+ * Parses a <major>.<minor>.<micro>[.<qualifier>] version, without allocating memory.
+ * Note a <major>.<minor> value is not parsed as version, because it is indistinguishable from a decimal.
+ */
+static bool filter_parseVersion(const char *str, celix_filter_version_t *out) {
+    celix_filter_version_t version = {0, 0, 0, "", 0};
+    const char *pos = str;
+    if (!filter_parseVersionPart(&pos, &version.major) || *pos != '.') {
+        return false;
+    }
+    pos++;
+    if (!filter_parseVersionPart(&pos, &version.minor) || *pos != '.') {
+        return false;
+    }
+    pos++;
+    if (!filter_parseVersionPart(&pos, &version.micro)) {
+        return false;
+    }
+    if (*pos == '.') {
+        pos++;
+        version.qualifier = pos;
+        while (isalnum((unsigned char)*pos) || *pos == '_' || *pos == '-') {
+            pos++;
+        }
+        version.qualifierLen = pos - version.qualifier;
+    }
+    if (*pos != '\0') {
+        return false;
+    }
+    *out = version;
+    return true;
+}
+
+static int filter_compareVersion(const celix_filter_version_t *v1, const celix_filter_version_t *v2) {
+    if (v1->major != v2->major) {
+        return v1->major < v2->major ? -1 : 1;
+    } else if (v1->minor != v2->minor) {
+        return v1->minor < v2->minor ? -1 : 1;
+    } else if (v1->micro != v2->micro) {
+        return v1->micro < v2->micro ? -1 : 1;
+    }
+    size_t len = v1->qualifierLen < v2->qualifierLen ? v1->qualifierLen : v2->qualifierLen;
+    int cmp = strncmp(v1->qualifier, v2->qualifier, len);
+    if (cmp == 0 && v1->qualifierLen != v2->qualifierLen) {
+        cmp = v1->qualifierLen < v2->qualifierLen ? -1 : 1;
+    }
+    return cmp;
+}
+
+/**
+ * Compares the property value with the filter value for the ordering operands (<, <=, > and >=).
+ * If the filter value is a long, version or double and the property value can be parsed as the same type
+ * the values are compared as long, version or double. Only values with (at least) three parts are versions, so
+ * "1.10.0" > "1.9.0" and "1.5" > "1.25". Otherwise the values are compared as strings.
+ */
+static int filter_compareOrdered(const celix_filter_t *filter, const char *propertyValue) {
+    const celix_filter_internal_t *internal = filter->internal;
+    if (internal != NULL && internal->convertedToLong) {
+        long val;
+        if (filter_parseLong(propertyValue, &val)) {
+            return val < internal->longValue ? -1 : (val > internal->longValue ? 1 : 0);
+        }
+    }
+    if (internal != NULL && internal->convertedToVersion) {
+        celix_filter_version_t val;
+        if (filter_parseVersion(propertyValue, &val)) {
+            return filter_compareVersion(&val, &internal->versionValue);
+        }
+    }
+    if (internal != NULL && internal->convertedToDouble) {
+        double val;
+        if (filter_parseDouble(propertyValue, &val)) {
+            return val < internal->doubleValue ? -1 : (val > internal->doubleValue ? 1 : 0);
+        }
+    }
+    return strcmp(propertyValue, filter->value);
+}
+
+/**
+ * Matches a substring filter. The children of a substring filter are strings, with a NULL entry for every '*'.
+ * e.g. "(attr=a*b*c)" -> ["a", NULL, "b", NULL, "c"].
+ */
+static bool filter_matchSubstring(const celix_filter_t *filter, const char *propertyValue) {
+    int size = filter->children != NULL ? celix_arrayList_size(filter->children) : 0;
+    if (size == 0) {
+        return false;
+    }
+    const size_t *lengths = filter->internal != NULL ? filter->internal->substringLengths : NULL;
+    const char *pos = propertyValue;
+    int i = 0;
+
+    const char *initial = celix_arrayList_get(filter->children, 0);
+    if (initial != NULL) {
+        size_t len = lengths != NULL ? lengths[0] : strlen(initial);
+        if (strncmp(pos, initial, len) != 0) {
+            return false;
+        }
+        pos += len;
+        i = 1;
+    }
+
+    int last = size - 1;
+    const char *final = size > 1 ? celix_arrayList_get(filter->children, last) : NULL;
+    int end = final != NULL ? last : size;
+    for (; i < end; ++i) {
+        const char *any = celix_arrayList_get(filter->children, i);
+        if (any != NULL) {
+            const char *found = strstr(pos, any);
+            if (found == NULL) {
+                return false;
+            }
+            pos = found + (lengths != NULL ? lengths[i] : strlen(any));
+        }
+    }
+
+    if (final != NULL) {
+        size_t len = lengths != NULL ? lengths[last] : strlen(final);
+        size_t remaining = strlen(pos);
+        if (remaining < len || strcmp(pos + remaining - len, final) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
 static celix_status_t filter_compare(const celix_filter_t* filter, const char *propertyValue, bool *out) {
     celix_status_t  status = CELIX_SUCCESS;
     bool result = false;
@@ -423,80 +617,29 @@ static celix_status_t filter_compare(const celix_filter_t* filter, const char *p
 
     switch (filter->operand) {
         case CELIX_FILTER_OPERAND_SUBSTRING: {
-            int pos = 0;
-            unsigned int i;
-            int size = celix_arrayList_size(filter->children);
-            for (i = 0; i < size; i++) {
-                char * substr = (char *) celix_arrayList_get(filter->children, i);
-
-                if (i + 1 < size) {
-                    if (substr == NULL) {
-                        unsigned int index;
-                        char * substr2 = (char *) celix_arrayList_get(filter->children, i + 1);
-                        if (substr2 == NULL) {
-                            continue;
-                        }
-                        index = strcspn(propertyValue+pos, substr2);
-                        if (index == strlen(propertyValue+pos)) {
-                            *out = false;
-                            return CELIX_SUCCESS;
-                        }
-
-                        pos = index + strlen(substr2);
-                        if (i + 2 < size) {
-                            i++;
-                        }
-                    } else {
-                        unsigned int len = strlen(substr);
-                        char * region = (char *)calloc(1, len+1);
-                        strncpy(region, propertyValue+pos, len);
-                        region[len]    = '\0';
-                        if (strcmp(region, substr) == 0) {
-                            pos += len;
-                        } else {
-                            free(region);
-                            *out = false;
-                            return CELIX_SUCCESS;
-                        }
-                        free(region);
-                    }
-                } else {
-                    unsigned int len;
-                    int begin;
-
-                    if (substr == NULL) {
-                        *out = true;
-                        return CELIX_SUCCESS;
-                    }
-                    len = strlen(substr);
-                    begin = strlen(propertyValue)-len;
-                    *out = (strcmp(propertyValue+begin, substr) == 0);
-                    return CELIX_SUCCESS;
-                }
-            }
-            *out = true;
-            return CELIX_SUCCESS;
+            result = filter_matchSubstring(filter, propertyValue);
+            break;
         }
         case CELIX_FILTER_OPERAND_APPROX: //TODO: Implement strcmp with ignorecase and ignorespaces
         case CELIX_FILTER_OPERAND_EQUAL: {
-            *out = (strcmp(propertyValue, filter->value) == 0);
-            return CELIX_SUCCESS;
+            result = (strcmp(propertyValue, filter->value) == 0);
+            break;
         }
         case CELIX_FILTER_OPERAND_GREATER: {
-            *out = (strcmp(propertyValue, filter->value) > 0);
-            return CELIX_SUCCESS;
+            result = filter_compareOrdered(filter, propertyValue) > 0;
+            break;
         }
         case CELIX_FILTER_OPERAND_GREATEREQUAL: {
-            *out = (strcmp(propertyValue, filter->value) >= 0);
-            return CELIX_SUCCESS;
+            result = filter_compareOrdered(filter, propertyValue) >= 0;
+            break;
         }
         case CELIX_FILTER_OPERAND_LESS: {
-            *out = (strcmp(propertyValue, filter->value) < 0);
-            return CELIX_SUCCESS;
+            result = filter_compareOrdered(filter, propertyValue) < 0;
+            break;
         }
         case CELIX_FILTER_OPERAND_LESSEQUAL: {
-            *out = (strcmp(propertyValue, filter->value) <= 0);
-            return CELIX_SUCCESS;
+            result = filter_compareOrdered(filter, propertyValue) <= 0;
+            break;
         }
         case CELIX_FILTER_OPERAND_AND:
         case CELIX_FILTER_OPERAND_NOT:
@@ -512,6 +655,61 @@ static celix_status_t filter_compare(const celix_filter_t* filter, const char *p
     return status;
 }
 
+/**
+ * Creates the prepared form of the filter (and its children). Returns false if memory could not be allocated.
+ */
+static bool filter_compile(celix_filter_t *filter) {
+    if (filter->operand == CELIX_FILTER_OPERAND_AND || filter->operand == CELIX_FILTER_OPERAND_OR || filter->operand == CELIX_FILTER_OPERAND_NOT) {
+        for (int i = 0; filter->children != NULL && i < celix_arrayList_size(filter->children); ++i) {
+            celix_filter_t *child = celix_arrayList_get(filter->children, i);
+            if (child == NULL || !filter_compile(child)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    filter->internal = calloc(1, sizeof(*filter->internal));
+    if (filter->internal == NULL) {
+        return false;
+    }
+    filter->internal->attributeHash = filter->attribute != NULL ? celix_properties_keyHash(filter->attribute) : 0;
+
+    if (filter->operand == CELIX_FILTER_OPERAND_SUBSTRING && filter->children != NULL) {
+        int size = celix_arrayList_size(filter->children);
+        filter->internal->substringLengths = calloc(size, sizeof(size_t));
+        if (filter->internal->substringLengths == NULL) {
+            return false;
+        }
+        for (int i = 0; i < size; ++i) {
+            const char *sub = celix_arrayList_get(filter->children, i);
+            filter->internal->substringLengths[i] = sub == NULL ? 0 : strlen(sub);
+        }
+    } else if (filter->value != NULL) {
+        filter->internal->convertedToLong = filter_parseLong(filter->value, &filter->internal->longValue);
+        filter->internal->convertedToDouble = filter_parseDouble(filter->value, &filter->internal->doubleValue);
+        filter->internal->convertedToVersion = filter_parseVersion(filter->value, &filter->internal->versionValue);
+    }
+    return true;
+}
+
+static void filter_destroyInternal(celix_filter_t *filter) {
+    if (filter->internal != NULL) {
+        free(filter->internal->substringLengths);
+        free(filter->internal);
+        filter->internal = NULL;
+    }
+}
+
+static const char* filter_getPropertyValue(const celix_filter_t *filter, const celix_properties_t *properties) {
+    if (properties == NULL) {
+        return NULL;
+    } else if (filter->internal != NULL) {
+        return celix_properties_getWithKeyHash(properties, filter->attribute, filter->internal->attributeHash);
+    }
+    return celix_properties_get(properties, filter->attribute, NULL);
+}
+
 celix_status_t filter_getString(celix_filter_t * filter, const char **filterStr) {
     if (filter != NULL) {
         *filterStr = filter->filterStr;
@@ -548,6 +746,12 @@ celix_filter_t* celix_filter_create(const char *filterString) {
         }
     }
 
+    if (filter != NULL && !filter_compile(filter)) {
+        fprintf(stderr, "Filter Error: Cannot prepare filter.\n");
+        filter_destroy(filter);
+        filter = NULL;
+    }
+
     if (filter == NULL) {
         free(filterStr);
     } else {
@@ -582,6 +786,7 @@ void celix_filter_destroy(celix_filter_t *filter) {
                 fprintf(stderr, "Filter Error: Corrupt filter. children has a value, but not an expected operand\n");
             }
         }
+        filter_destroyInternal(filter);
         free((char*)filter->value);
         filter->value = NULL;
         free((char*)filter->attribute);
@@ -631,12 +836,12 @@ bool celix_filter_match(const celix_filter_t *filter, const celix_properties_t*
         case CELIX_FILTER_OPERAND_LESS :
         case CELIX_FILTER_OPERAND_LESSEQUAL :
         case CELIX_FILTER_OPERAND_APPROX : {
-            char * value = (properties == NULL) ? NULL: (char*)celix_properties_get(properties, filter->attribute, NULL);
+            const char *value = filter_getPropertyValue(filter, properties);
             filter_compare(filter, value, &result);
             return result;
         }
         case CELIX_FILTER_OPERAND_PRESENT: {
-            char * value = (properties == NULL) ? NULL: (char*)celix_properties_get(properties, filter->attribute, NULL);
+            const char *value = filter_getPropertyValue(filter, properties);
             return value != NULL;
         }
     }
@@ -112,7 +112,6 @@ bool hashMap_isEmpty(hash_map_pt map) {
 }
 
 void * hashMap_get(hash_map_pt map, const void* key) {
-    unsigned int hash;
     if (key == NULL) {
         hash_map_entry_pt entry;
         for (entry = map->table[0]; entry != NULL; entry = entry->next) {
@@ -123,7 +122,11 @@ void * hashMap_get(hash_map_pt map, const void* key) {
         return NULL;
     }
 
-    hash = hashMap_hash(map->hashKey(key));
+    return hashMap_getWithKeyHash(map, key, map->hashKey(key));
+}
+
+void * hashMap_getWithKeyHash(hash_map_pt map, const void* key, unsigned int keyHash) {
+    unsigned int hash = hashMap_hash(keyHash);
     hash_map_entry_pt entry = NULL;
     for (entry = map->table[hashMap_indexFor(hash, map->tablelength)]; entry != NULL; entry = entry->next) {
         if (entry->hash == hash && (entry->key == key || map->equalsKey(key, entry->key))) {
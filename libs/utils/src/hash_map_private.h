@@ -33,6 +33,12 @@
 UTILS_EXPORT unsigned int hashMap_hashCode(const void* toHash);
 UTILS_EXPORT int hashMap_equals(const void* toCompare, const void* compare);
 
+/**
+ * Returns the value for the key, using an already calculated key hash (as returned by the map key hash function).
+ * Key should not be NULL.
+ */
+void* hashMap_getWithKeyHash(hash_map_pt map, const void* key, unsigned int keyHash);
+
 void hashMap_resize(hash_map_pt map, int newCapacity);
 hash_map_entry_pt hashMap_removeEntryForKey(hash_map_pt map, const void* key);
 UTILS_EXPORT hash_map_entry_pt hashMap_removeMapping(hash_map_pt map, hash_map_entry_pt entry);
@@ -32,12 +32,88 @@
 #include "properties.h"
 #include "celix_properties.h"
 #include "utils.h"
-#include "hash_map_private.h"
+#include "celix_version.h"
+#include "properties_private.h"
 #include <errno.h>
 
 
 #define MALLOC_BLOCK_SIZE        5
 
+/**
+ * Values shorter than this are stored inline in the property entry (no extra allocation).
+ * Large enough for longs, bools, versions and most service property values.
+ */
+#define CELIX_PROPERTIES_SHORT_VALUE_SIZE   24
+#define CELIX_PROPERTIES_INITIAL_INDEX_SIZE 16
+#define CELIX_PROPERTIES_INITIAL_ARENA_SIZE 512
+#define CELIX_PROPERTIES_MAX_ARENA_GROWTH   (64 * 1024)
+#define CELIX_PROPERTIES_ARENA_ALIGNMENT    8
+
+typedef enum celix_properties_value_type {
+    CELIX_PROPERTIES_VALUE_TYPE_STRING  = 0,
+    CELIX_PROPERTIES_VALUE_TYPE_LONG    = 1,
+    CELIX_PROPERTIES_VALUE_TYPE_DOUBLE  = 2,
+    CELIX_PROPERTIES_VALUE_TYPE_BOOL    = 3,
+    CELIX_PROPERTIES_VALUE_TYPE_VERSION = 4
+} celix_properties_value_type_e;
+
+typedef union celix_properties_typed_value {
+    long longValue;
+    double doubleValue;
+    bool boolValue;
+    struct {
+        int major;
+        int minor;
+        int micro;
+        unsigned int qualifierOffset; //offset of the qualifier in the string value
+    } versionValue;
+} celix_properties_typed_value_t;
+
+typedef struct celix_properties_entry celix_properties_entry_t;
+
+struct celix_properties_entry {
+    const char *key;
+    const char *value; //points to shortValue, arena memory or heapValue
+    char *heapValue; //only used for long values replacing an existing value (so that updates do not grow the arena) and for large values
+    unsigned int hash;
+    unsigned int keyCapacity; //size of the key storage, used when an unset entry is reused
+    bool ownsKey; //key is heap allocated and owned by the entry (see celix_properties_setWithoutCopy)
+    celix_properties_value_type_e valueType;
+    celix_properties_typed_value_t typed;
+    celix_properties_entry_t *nextFree;
+    char shortValue[CELIX_PROPERTIES_SHORT_VALUE_SIZE];
+};
+
+typedef struct celix_properties_arena_block celix_properties_arena_block_t;
+
+struct celix_properties_arena_block {
+    celix_properties_arena_block_t *next;
+    size_t size;
+    size_t used;
+    bool embedded; //part of the properties allocation, not freed separately
+    char data[] __attribute__((aligned(CELIX_PROPERTIES_ARENA_ALIGNMENT)));
+};
+
+/**
+ * Properties are stored in an open addressing (linear probing) index of entry pointers.
+ * The entries, keys and (long) values are allocated from an per instance arena. The
+ * properties struct, initial index and initial arena block are a single allocation, so
+ * creating, copying and destroying properties normally is one malloc/free.
+ * Entries never move, so returned keys and values stay valid until the entry is updated or unset.
+ */
+struct celix_properties {
+    celix_properties_entry_t **index;
+    unsigned int indexSize; //power of 2
+    unsigned int size; //nr of entries
+    unsigned int used; //nr of entries + nr of tombstones in the index
+    bool indexEmbedded;
+    celix_properties_entry_t *freeEntries; //unset entries, reused for new keys
+    celix_properties_arena_block_t *arena; //current arena block, older blocks are linked with next
+};
+
+static celix_properties_entry_t celix_properties_tombstone;
+#define CELIX_PROPERTIES_TOMBSTONE (&celix_properties_tombstone)
+
 static void parseLine(const char* line, celix_properties_t *props);
 
 properties_pt properties_create(void) {
@@ -217,19 +293,343 @@ static void parseLine(const char* line, celix_properties_t *props) {
 
 
 
+static size_t celix_properties_align(size_t size) {
+    return (size + CELIX_PROPERTIES_ARENA_ALIGNMENT - 1) & ~((size_t)CELIX_PROPERTIES_ARENA_ALIGNMENT - 1);
+}
+
+/**
+ * Spreads the bits of the (djb2) key hash, so that the lower bits can be used as index position.
+ */
+static unsigned int celix_properties_indexHash(unsigned int hash) {
+    hash ^= hash >> 16;
+    hash *= 0x45d9f3bU;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+/**
+ * Returns the index size needed to add a entry to nrOfEntries entries while keeping the load factor <= 0.75.
+ */
+static unsigned int celix_properties_indexSizeFor(unsigned int nrOfEntries) {
+    unsigned int size = CELIX_PROPERTIES_INITIAL_INDEX_SIZE;
+    while (size * 3 < (nrOfEntries + 1) * 4) {
+        size *= 2;
+    }
+    return size;
+}
+
+static celix_properties_t* celix_properties_createWithSizes(unsigned int indexSize, size_t arenaSize) {
+    size_t indexOffset = celix_properties_align(sizeof(celix_properties_t));
+    size_t arenaOffset = celix_properties_align(indexOffset + indexSize * sizeof(celix_properties_entry_t*));
+    char *mem = malloc(arenaOffset + sizeof(celix_properties_arena_block_t) + arenaSize);
+    if (mem == NULL) {
+        return NULL;
+    }
+
+    celix_properties_t *props = (celix_properties_t*)mem;
+    props->index = (celix_properties_entry_t**)(mem + indexOffset);
+    memset(props->index, 0, indexSize * sizeof(celix_properties_entry_t*));
+    props->indexSize = indexSize;
+    props->size = 0;
+    props->used = 0;
+    props->indexEmbedded = true;
+    props->freeEntries = NULL;
+    props->arena = (celix_properties_arena_block_t*)(mem + arenaOffset);
+    props->arena->next = NULL;
+    props->arena->size = arenaSize;
+    props->arena->used = 0;
+    props->arena->embedded = true;
+    return props;
+}
+
+static void* celix_properties_arenaAlloc(celix_properties_t *props, size_t size, size_t alignment) {
+    celix_properties_arena_block_t *block = props->arena;
+    size_t offset = (block->used + alignment - 1) & ~(alignment - 1);
+    if (offset + size > block->size) {
+        size_t blockSize = block->size * 2;
+        if (blockSize < CELIX_PROPERTIES_INITIAL_ARENA_SIZE) {
+            blockSize = CELIX_PROPERTIES_INITIAL_ARENA_SIZE;
+        } else if (blockSize > CELIX_PROPERTIES_MAX_ARENA_GROWTH) {
+            blockSize = CELIX_PROPERTIES_MAX_ARENA_GROWTH;
+        }
+        if (blockSize < size) {
+            blockSize = size;
+        }
+        block = malloc(sizeof(*block) + blockSize);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = props->arena;
+        block->size = blockSize;
+        block->used = 0;
+        block->embedded = false;
+        props->arena = block;
+        offset = 0;
+    }
+    block->used = offset + size;
+    return block->data + offset;
+}
+
+static celix_properties_entry_t* celix_properties_findEntry(const celix_properties_t *props, const char *key, unsigned int hash) {
+    unsigned int mask = props->indexSize - 1;
+    for (unsigned int i = celix_properties_indexHash(hash) & mask; ; i = (i + 1) & mask) {
+        celix_properties_entry_t *entry = props->index[i];
+        if (entry == NULL) {
+            return NULL;
+        } else if (entry != CELIX_PROPERTIES_TOMBSTONE && entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+    }
+}
+
+static celix_properties_entry_t* celix_properties_getEntry(const celix_properties_t *props, const char *key) {
+    if (props == NULL || key == NULL) {
+        return NULL;
+    }
+    return celix_properties_findEntry(props, key, celix_properties_keyHash(key));
+}
+
+static bool celix_properties_resizeIndex(celix_properties_t *props, unsigned int newSize) {
+    celix_properties_entry_t **newIndex = calloc(newSize, sizeof(celix_properties_entry_t*));
+    if (newIndex == NULL) {
+        return false;
+    }
+    unsigned int mask = newSize - 1;
+    for (unsigned int i = 0; i < props->indexSize; ++i) {
+        celix_properties_entry_t *entry = props->index[i];
+        if (entry != NULL && entry != CELIX_PROPERTIES_TOMBSTONE) {
+            unsigned int k = celix_properties_indexHash(entry->hash) & mask;
+            while (newIndex[k] != NULL) {
+                k = (k + 1) & mask;
+            }
+            newIndex[k] = entry;
+        }
+    }
+    if (!props->indexEmbedded) {
+        free(props->index);
+    }
+    props->index = newIndex;
+    props->indexSize = newSize;
+    props->used = props->size;
+    props->indexEmbedded = false;
+    return true;
+}
+
+static void celix_properties_addToIndex(celix_properties_t *props, celix_properties_entry_t *entry) {
+    unsigned int mask = props->indexSize - 1;
+    unsigned int i = celix_properties_indexHash(entry->hash) & mask;
+    while (props->index[i] != NULL && props->index[i] != CELIX_PROPERTIES_TOMBSTONE) {
+        i = (i + 1) & mask;
+    }
+    if (props->index[i] == NULL) {
+        props->used += 1;
+    }
+    props->index[i] = entry;
+    props->size += 1;
+}
+
+/**
+ * Adds a new entry (without value) for a key which is not yet present.
+ * If ownedKey is not NULL, the entry takes ownership of ownedKey instead of copying key.
+ * freshEntry is set to true if the entry is newly allocated from the arena and false if a unset entry is reused.
+ */
+static celix_properties_entry_t* celix_properties_addEntry(celix_properties_t *props, const char *key, char *ownedKey, unsigned int hash, bool *freshEntry) {
+    if ((props->used + 1) * 4 > props->indexSize * 3) {
+        if (!celix_properties_resizeIndex(props, celix_properties_indexSizeFor(props->size * 2))) {
+            return NULL;
+        }
+    }
+
+    size_t keyLen = strlen(key);
+    celix_properties_entry_t *entry = props->freeEntries;
+    if (entry != NULL) {
+        props->freeEntries = entry->nextFree;
+        *freshEntry = false;
+    } else {
+        entry = celix_properties_arenaAlloc(props, sizeof(*entry), CELIX_PROPERTIES_ARENA_ALIGNMENT);
+        if (entry == NULL) {
+            return NULL;
+        }
+        entry->key = NULL;
+        entry->keyCapacity = 0;
+        *freshEntry = true;
+    }
+    if (ownedKey != NULL) {
+        entry->key = ownedKey;
+        entry->keyCapacity = 0; //note entry key storage is not reused
+        entry->ownsKey = true;
+    } else {
+        char *keyStorage = entry->keyCapacity > keyLen ? (char*)entry->key : celix_properties_arenaAlloc(props, keyLen + 1, 1);
+        if (keyStorage == NULL) {
+            entry->keyCapacity = 0;
+            entry->nextFree = props->freeEntries;
+            props->freeEntries = entry;
+            return NULL;
+        }
+        memcpy(keyStorage, key, keyLen + 1);
+        if (entry->keyCapacity <= keyLen) {
+            entry->keyCapacity = (unsigned int)(keyLen + 1);
+        }
+        entry->key = keyStorage;
+        entry->ownsKey = false;
+    }
+    entry->value = NULL;
+    entry->heapValue = NULL;
+    entry->hash = hash;
+    entry->valueType = CELIX_PROPERTIES_VALUE_TYPE_STRING;
+    entry->nextFree = NULL;
+    celix_properties_addToIndex(props, entry);
+    return entry;
+}
+
+static void celix_properties_removeEntry(celix_properties_t *props, celix_properties_entry_t *entry) {
+    unsigned int mask = props->indexSize - 1;
+    unsigned int i = celix_properties_indexHash(entry->hash) & mask;
+    while (props->index[i] != entry) {
+        i = (i + 1) & mask;
+    }
+    if (props->index[(i + 1) & mask] == NULL) {
+        //end of a probe sequence, no tombstone needed
+        props->index[i] = NULL;
+        props->used -= 1;
+    } else {
+        props->index[i] = CELIX_PROPERTIES_TOMBSTONE;
+    }
+    props->size -= 1;
+
+    free(entry->heapValue);
+    entry->heapValue = NULL;
+    entry->value = NULL;
+    if (entry->ownsKey) {
+        free((char*)entry->key);
+        entry->key = NULL;
+        entry->keyCapacity = 0;
+        entry->ownsKey = false;
+    }
+    entry->nextFree = props->freeEntries;
+    props->freeEntries = entry;
+}
+
+static bool celix_properties_setEntryValue(celix_properties_t *props, celix_properties_entry_t *entry, const char *value, bool freshEntry) {
+    char *oldHeapValue = entry->heapValue;
+    char *storage = NULL;
+    if (value == NULL) {
+        entry->heapValue = NULL;
+        entry->value = NULL;
+        free(oldHeapValue);
+        return true;
+    }
+
+    size_t len = strlen(value);
+    if (len < CELIX_PROPERTIES_SHORT_VALUE_SIZE) {
+        storage = entry->shortValue;
+        entry->heapValue = NULL;
+    } else if (freshEntry && len < CELIX_PROPERTIES_MAX_ARENA_GROWTH) {
+        storage = celix_properties_arenaAlloc(props, len + 1, 1);
+    } else {
+        //note updating an existing entry uses the heap, so that frequent updates do not grow the arena.
+        //large values also use the heap, so that they do not end up in (and waste) a dedicated arena block.
+        storage = malloc(len + 1);
+        entry->heapValue = storage;
+    }
+    if (storage == NULL) {
+        entry->heapValue = oldHeapValue;
+        return false;
+    }
+    memmove(storage, value, len); //note value can point to the current value
+    storage[len] = '\0';
+    entry->value = storage;
+    free(oldHeapValue);
+    return true;
+}
+
+static void celix_properties_setInternal(celix_properties_t *properties, const char *key, const char *value, celix_properties_value_type_e valueType, const celix_properties_typed_value_t *typed) {
+    if (properties == NULL || key == NULL) {
+        return;
+    }
+    unsigned int hash = celix_properties_keyHash(key);
+    bool added = false;
+    bool freshEntry = false;
+    celix_properties_entry_t *entry = celix_properties_findEntry(properties, key, hash);
+    if (entry == NULL) {
+        entry = celix_properties_addEntry(properties, key, NULL, hash, &freshEntry);
+        added = true;
+    }
+    if (entry == NULL) {
+        fprintf(stderr, "Cannot allocate memory for property '%s'\n", key);
+        return;
+    }
+    if (celix_properties_setEntryValue(properties, entry, value, freshEntry)) {
+        entry->valueType = value == NULL ? CELIX_PROPERTIES_VALUE_TYPE_STRING : valueType;
+        entry->typed = *typed;
+    } else {
+        fprintf(stderr, "Cannot allocate memory for value of property '%s'\n", key);
+        if (added) {
+            celix_properties_removeEntry(properties, entry);
+        }
+    }
+}
+
+/**
+ * Detect whether a string value is a long, double or bool, so that the typed getters do not need to parse the value.
+ * Only values which are parsed completely are typed, the typed getters fall back to parsing the string value.
+ */
+static celix_properties_value_type_e celix_properties_detectType(const char *value, celix_properties_typed_value_t *typed) {
+    celix_properties_value_type_e type = CELIX_PROPERTIES_VALUE_TYPE_STRING;
+    if (strcasecmp("true", value) == 0) {
+        typed->boolValue = true;
+        type = CELIX_PROPERTIES_VALUE_TYPE_BOOL;
+    } else if (strcasecmp("false", value) == 0) {
+        typed->boolValue = false;
+        type = CELIX_PROPERTIES_VALUE_TYPE_BOOL;
+    } else if (isdigit((unsigned char)value[0]) || value[0] == '-' || value[0] == '+' || value[0] == '.') {
+        int savedErrno = errno;
+        char *end = NULL;
+        errno = 0;
+        long l = strtol(value, &end, 10);
+        if (end != value && *end == '\0' && errno == 0) {
+            typed->longValue = l;
+            type = CELIX_PROPERTIES_VALUE_TYPE_LONG;
+        } else {
+            errno = 0;
+            double d = strtod(value, &end);
+            if (end != value && *end == '\0' && errno == 0) {
+                typed->doubleValue = d;
+                type = CELIX_PROPERTIES_VALUE_TYPE_DOUBLE;
+            }
+        }
+        errno = savedErrno;
+    }
+    return type;
+}
+
 celix_properties_t* celix_properties_create(void) {
-    return hashMap_create(utils_stringHash, utils_stringHash, utils_stringEquals, utils_stringEquals);
+    return celix_properties_createWithSizes(CELIX_PROPERTIES_INITIAL_INDEX_SIZE, CELIX_PROPERTIES_INITIAL_ARENA_SIZE);
 }
 
 void celix_properties_destroy(celix_properties_t *properties) {
     if (properties != NULL) {
-        hash_map_iterator_pt iter = hashMapIterator_create(properties);
-        while (hashMapIterator_hasNext(iter)) {
-            hash_map_entry_pt entry = hashMapIterator_nextEntry(iter);
-            hashMapEntry_clear(entry, true, true);
+        for (unsigned int i = 0; i < properties->indexSize; ++i) {
+            celix_properties_entry_t *entry = properties->index[i];
+            if (entry != NULL && entry != CELIX_PROPERTIES_TOMBSTONE) {
+                free(entry->heapValue);
+                if (entry->ownsKey) {
+                    free((char*)entry->key);
+                }
+            }
+        }
+        celix_properties_arena_block_t *block = properties->arena;
+        while (block != NULL) {
+            celix_properties_arena_block_t *next = block->next;
+            if (!block->embedded) {
+                free(block);
+            }
+            block = next;
+        }
+        if (!properties->indexEmbedded) {
+            free(properties->index);
         }
-        hashMapIterator_destroy(iter);
-        hashMap_destroy(properties, false, false);
+        free(properties);
     }
 }
 
@@ -306,37 +706,28 @@ celix_properties_t* celix_properties_loadFromString(const char *input) {
     return props;
 }
 
+
+static void celix_properties_storeEscaped(FILE *file, const char *str) {
+    for (int i = 0; str != NULL && str[i] != '\0'; i += 1) {
+        if (str[i] == '#' || str[i] == '!' || str[i] == '=' || str[i] == ':') {
+            fputc('\\', file);
+        }
+        fputc(str[i], file);
+    }
+}
+
 void celix_properties_store(celix_properties_t *properties, const char *filename, const char *header) {
     FILE *file = fopen (filename, "w+" );
-    char *str;
 
     if (file != NULL) {
-        if (hashMap_size(properties) > 0) {
-            hash_map_iterator_pt iterator = hashMapIterator_create(properties);
-            while (hashMapIterator_hasNext(iterator)) {
-                hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
-                str = hashMapEntry_getKey(entry);
-                for (int i = 0; i < strlen(str); i += 1) {
-                    if (str[i] == '#' || str[i] == '!' || str[i] == '=' || str[i] == ':') {
-                        fputc('\\', file);
-                    }
-                    fputc(str[i], file);
-                }
-
+        for (unsigned int i = 0; properties != NULL && i < properties->indexSize; ++i) {
+            const celix_properties_entry_t *entry = properties->index[i];
+            if (entry != NULL && entry != CELIX_PROPERTIES_TOMBSTONE) {
+                celix_properties_storeEscaped(file, entry->key);
                 fputc('=', file);
-
-                str = hashMapEntry_getValue(entry);
-                for (int i = 0; i < strlen(str); i += 1) {
-                    if (str[i] == '#' || str[i] == '!' || str[i] == '=' || str[i] == ':') {
-                        fputc('\\', file);
-                    }
-                    fputc(str[i], file);
-                }
-
+                celix_properties_storeEscaped(file, entry->value);
                 fputc('\n', file);
-
             }
-            hashMapIterator_destroy(iterator);
         }
         fclose(file);
     } else {
@@ -345,67 +736,123 @@ void celix_properties_store(celix_properties_t *properties, const char *filename
 }
 
 celix_properties_t* celix_properties_copy(const celix_properties_t *properties) {
-    celix_properties_t *copy = celix_properties_create();
-    if (copy != NULL) {
-        hash_map_iterator_t iter = hashMapIterator_construct((hash_map_t*)properties);
-        while (hashMapIterator_hasNext(&iter)) {
-            hash_map_entry_pt entry = hashMapIterator_nextEntry(&iter);
-            char *key = hashMapEntry_getKey(entry);
-            char *value = hashMapEntry_getValue(entry);
-            celix_properties_set(copy, key, value);
+    if (properties == NULL) {
+        return celix_properties_create();
+    }
+
+    //calculate the exact arena size needed, so that the copy is a single allocation
+    size_t arenaSize = 0;
+    for (unsigned int i = 0; i < properties->indexSize; ++i) {
+        const celix_properties_entry_t *entry = properties->index[i];
+        if (entry != NULL && entry != CELIX_PROPERTIES_TOMBSTONE) {
+            arenaSize += celix_properties_align(sizeof(*entry));
+            arenaSize += celix_properties_align(strlen(entry->key) + 1);
+            if (entry->value != NULL && entry->value != entry->shortValue) {
+                arenaSize += celix_properties_align(strlen(entry->value) + 1);
+            }
+        }
+    }
+
+    celix_properties_t *copy = celix_properties_createWithSizes(celix_properties_indexSizeFor(properties->size), arenaSize);
+    for (unsigned int i = 0; copy != NULL && i < properties->indexSize; ++i) {
+        const celix_properties_entry_t *entry = properties->index[i];
+        if (entry != NULL && entry != CELIX_PROPERTIES_TOMBSTONE) {
+            celix_properties_entry_t *copyEntry = celix_properties_arenaAlloc(copy, sizeof(*copyEntry), CELIX_PROPERTIES_ARENA_ALIGNMENT);
+            size_t keyLen = strlen(entry->key);
+            char *key = celix_properties_arenaAlloc(copy, keyLen + 1, 1);
+            memcpy(key, entry->key, keyLen + 1);
+            copyEntry->key = key;
+            copyEntry->keyCapacity = (unsigned int)(keyLen + 1);
+            copyEntry->ownsKey = false;
+            copyEntry->heapValue = NULL;
+            copyEntry->hash = entry->hash;
+            copyEntry->valueType = entry->valueType;
+            copyEntry->typed = entry->typed;
+            copyEntry->nextFree = NULL;
+            if (entry->value == NULL) {
+                copyEntry->value = NULL;
+            } else if (entry->value == entry->shortValue) {
+                memcpy(copyEntry->shortValue, entry->shortValue, CELIX_PROPERTIES_SHORT_VALUE_SIZE);
+                copyEntry->value = copyEntry->shortValue;
+            } else {
+                size_t valueLen = strlen(entry->value);
+                char *value = celix_properties_arenaAlloc(copy, valueLen + 1, 1);
+                memcpy(value, entry->value, valueLen + 1);
+                copyEntry->value = value;
+            }
+            celix_properties_addToIndex(copy, copyEntry);
         }
     }
     return copy;
 }
 
 const char* celix_properties_get(const celix_properties_t *properties, const char *key, const char *defaultValue) {
+    const celix_properties_entry_t *entry = celix_properties_getEntry(properties, key);
+    return entry == NULL || entry->value == NULL ? defaultValue : entry->value;
+}
+
+unsigned int celix_properties_keyHash(const char *key) {
+    return utils_stringHash(key);
+}
+
+const char* celix_properties_getWithKeyHash(const celix_properties_t *properties, const char *key, unsigned int keyHash) {
     const char* value = NULL;
-    if (properties != NULL) {
-        value = hashMap_get((hash_map_t*)properties, (void*)key);
+    if (properties != NULL && key != NULL) {
+        const celix_properties_entry_t *entry = celix_properties_findEntry(properties, key, keyHash);
+        value = entry == NULL ? NULL : entry->value;
     }
-    return value == NULL ? defaultValue : value;
+    return value;
 }
 
 void celix_properties_set(celix_properties_t *properties, const char *key, const char *value) {
-    if (properties != NULL) {
-        hash_map_entry_pt entry = hashMap_getEntry(properties, key);
-        char *oldVal = NULL;
-        char *newVal = value == NULL ? NULL : strndup(value, 1024 * 1024);
-        if (entry != NULL) {
-            char *oldKey = hashMapEntry_getKey(entry);
-            oldVal = hashMapEntry_getValue(entry);
-            hashMap_put(properties, oldKey, newVal);
-        } else {
-            hashMap_put(properties, strndup(key, 1024 * 1024), newVal);
-        }
-        free(oldVal);
-    }
+    celix_properties_typed_value_t typed;
+    memset(&typed, 0, sizeof(typed));
+    celix_properties_value_type_e valueType = value == NULL ? CELIX_PROPERTIES_VALUE_TYPE_STRING : celix_properties_detectType(value, &typed);
+    celix_properties_setInternal(properties, key, value, valueType, &typed);
 }
 
 void celix_properties_setWithoutCopy(celix_properties_t *properties, char *key, char *value) {
-    if (properties != NULL) {
-        hash_map_entry_pt entry = hashMap_getEntry(properties, key);
-        char *oldVal = NULL;
+    if (properties != NULL && key != NULL) {
+        celix_properties_typed_value_t typed;
+        memset(&typed, 0, sizeof(typed));
+        celix_properties_value_type_e valueType = value == NULL ? CELIX_PROPERTIES_VALUE_TYPE_STRING : celix_properties_detectType(value, &typed);
+        unsigned int hash = celix_properties_keyHash(key);
+        bool freshEntry = false;
+        celix_properties_entry_t *entry = celix_properties_findEntry(properties, key, hash);
+        if (entry != NULL) {
+            free(key); //existing key is kept
+        } else {
+            entry = celix_properties_addEntry(properties, key, key, hash, &freshEntry);
+        }
         if (entry != NULL) {
-            char *oldKey = hashMapEntry_getKey(entry);
-            oldVal = hashMapEntry_getValue(entry);
-            hashMap_put(properties, oldKey, value);
+            //the value is adopted as heap value of the entry
+            free(entry->heapValue);
+            entry->heapValue = value;
+            entry->value = value;
+            entry->valueType = valueType;
+            entry->typed = typed;
         } else {
-            hashMap_put(properties, key, value);
+            fprintf(stderr, "Cannot allocate memory for property '%s'\n", key);
+            free(key);
+            free(value);
         }
-        free(oldVal);
     }
 }
 
 void celix_properties_unset(celix_properties_t *properties, const char *key) {
-    char* oldValue = hashMap_remove(properties, key);
-    free(oldValue);
+    celix_properties_entry_t *entry = celix_properties_getEntry(properties, key);
+    if (entry != NULL) {
+        celix_properties_removeEntry(properties, entry);
+    }
 }
 
 long celix_properties_getAsLong(const celix_properties_t *props, const char *key, long defaultValue) {
     long result = defaultValue;
-    const char *val = celix_properties_get(props, key, NULL);
-    if (val != NULL) {
+    const celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL && entry->valueType == CELIX_PROPERTIES_VALUE_TYPE_LONG) {
+        result = entry->typed.longValue;
+    } else if (entry != NULL && entry->value != NULL) {
+        const char *val = entry->value;
         char *enptr = NULL;
         errno = 0;
         long r = strtol(val, &enptr, 10);
@@ -420,7 +867,10 @@ void celix_properties_setLong(celix_properties_t *props, const char *key, long v
     char buf[32]; //should be enough to store long long int
     int writen = snprintf(buf, 32, "%li", value);
     if (writen <= 31) {
-        celix_properties_set(props, key, buf);
+        celix_properties_typed_value_t typed;
+        memset(&typed, 0, sizeof(typed));
+        typed.longValue = value;
+        celix_properties_setInternal(props, key, buf, CELIX_PROPERTIES_VALUE_TYPE_LONG, &typed);
     } else {
         fprintf(stderr,"buf to small for value '%li'\n", value);
     }
@@ -428,8 +878,11 @@ void celix_properties_setLong(celix_properties_t *props, const char *key, long v
 
 double celix_properties_getAsDouble(const celix_properties_t *props, const char *key, double defaultValue) {
     double result = defaultValue;
-    const char *val = celix_properties_get(props, key, NULL);
-    if (val != NULL) {
+    const celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL && entry->valueType == CELIX_PROPERTIES_VALUE_TYPE_DOUBLE) {
+        result = entry->typed.doubleValue;
+    } else if (entry != NULL && entry->value != NULL) {
+        const char *val = entry->value;
         char *enptr = NULL;
         errno = 0;
         double r = strtod(val, &enptr);
@@ -444,7 +897,10 @@ void celix_properties_setDouble(celix_properties_t *props, const char *key, doub
     char buf[32]; //should be enough to store long long int
     int writen = snprintf(buf, 32, "%f", val);
     if (writen <= 31) {
-        celix_properties_set(props, key, buf);
+        celix_properties_typed_value_t typed;
+        memset(&typed, 0, sizeof(typed));
+        typed.doubleValue = val;
+        celix_properties_setInternal(props, key, buf, CELIX_PROPERTIES_VALUE_TYPE_DOUBLE, &typed);
     } else {
         fprintf(stderr,"buf to small for value '%f'\n", val);
     }
@@ -452,10 +908,12 @@ void celix_properties_setDouble(celix_properties_t *props, const char *key, doub
 
 bool celix_properties_getAsBool(const celix_properties_t *props, const char *key, bool defaultValue) {
     bool result = defaultValue;
-    const char *val = celix_properties_get(props, key, NULL);
-    if (val != NULL) {
+    const celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL && entry->valueType == CELIX_PROPERTIES_VALUE_TYPE_BOOL) {
+        result = entry->typed.boolValue;
+    } else if (entry != NULL && entry->value != NULL) {
         char buf[32];
-        snprintf(buf, 32, "%s", val);
+        snprintf(buf, 32, "%s", entry->value);
         char *trimmed = utils_stringTrim(buf);
         if (strncasecmp("true", trimmed, strlen("true")) == 0) {
             result = true;
@@ -467,19 +925,70 @@ bool celix_properties_getAsBool(const celix_properties_t *props, const char *key
 }
 
 void celix_properties_setBool(celix_properties_t *props, const char *key, bool val) {
-    celix_properties_set(props, key, val ? "true" : "false");
+    celix_properties_typed_value_t typed;
+    memset(&typed, 0, sizeof(typed));
+    typed.boolValue = val;
+    celix_properties_setInternal(props, key, val ? "true" : "false", CELIX_PROPERTIES_VALUE_TYPE_BOOL, &typed);
+}
+
+void celix_properties_setVersion(celix_properties_t *props, const char *key, const celix_version_t *version) {
+    char *str = version == NULL ? NULL : celix_version_toString(version);
+    if (str != NULL) {
+        const char *qualifier = celix_version_getQualifier(version);
+        celix_properties_typed_value_t typed;
+        memset(&typed, 0, sizeof(typed));
+        typed.versionValue.major = celix_version_getMajor(version);
+        typed.versionValue.minor = celix_version_getMinor(version);
+        typed.versionValue.micro = celix_version_getMicro(version);
+        typed.versionValue.qualifierOffset = (unsigned int)(strlen(str) - strlen(qualifier));
+        celix_properties_setInternal(props, key, str, CELIX_PROPERTIES_VALUE_TYPE_VERSION, &typed);
+        free(str);
+    }
+}
+
+celix_version_t* celix_properties_getAsVersion(const celix_properties_t *props, const char *key, const celix_version_t *defaultValue) {
+    celix_version_t *result = NULL;
+    const celix_properties_entry_t *entry = celix_properties_getEntry(props, key);
+    if (entry != NULL && entry->valueType == CELIX_PROPERTIES_VALUE_TYPE_VERSION) {
+        result = celix_version_createVersion(entry->typed.versionValue.major, entry->typed.versionValue.minor,
+                                             entry->typed.versionValue.micro, entry->value + entry->typed.versionValue.qualifierOffset);
+    } else if (entry != NULL && entry->value != NULL) {
+        result = celix_version_createVersionFromString(entry->value);
+    }
+    if (result == NULL && defaultValue != NULL) {
+        result = celix_version_copy(defaultValue);
+    }
+    return result;
 }
 
 int celix_properties_size(const celix_properties_t *properties) {
-    return hashMap_size((hash_map_t*)properties);
+    return properties == NULL ? 0 : (int)properties->size;
 }
 
 celix_properties_iterator_t celix_propertiesIterator_construct(const celix_properties_t *properties) {
-    return hashMapIterator_construct((hash_map_t*)properties);
+    celix_properties_iterator_t iter;
+    iter._properties = properties;
+    iter._index = 0;
+    return iter;
 }
+
 bool celix_propertiesIterator_hasNext(celix_properties_iterator_t *iter) {
-    return hashMapIterator_hasNext(iter);
+    const celix_properties_t *props = iter->_properties;
+    while (props != NULL && iter->_index < props->indexSize) {
+        const celix_properties_entry_t *entry = props->index[iter->_index];
+        if (entry != NULL && entry != CELIX_PROPERTIES_TOMBSTONE) {
+            return true;
+        }
+        iter->_index += 1;
+    }
+    return false;
 }
+
 const char* celix_propertiesIterator_nextKey(celix_properties_iterator_t *iter) {
-    return (const char*)hashMapIterator_nextKey(iter);
+    const char *key = NULL;
+    if (celix_propertiesIterator_hasNext(iter)) {
+        key = iter->_properties->index[iter->_index]->key;
+        iter->_index += 1;
+    }
+    return key;
 }
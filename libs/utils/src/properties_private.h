@@ -0,0 +1,37 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ *  KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PROPERTIES_PRIVATE_H_
+#define PROPERTIES_PRIVATE_H_
+
+#include "celix_properties.h"
+
+/**
+ * Returns the hash of a property key. The hash can be calculated once and used for
+ * repeated lookups with celix_properties_getWithKeyHash (e.g. for filter attributes).
+ */
+unsigned int celix_properties_keyHash(const char *key);
+
+/**
+ * Returns the value for the key using a key hash calculated with celix_properties_keyHash.
+ * Returns NULL if the key is not present.
+ */
+const char* celix_properties_getWithKeyHash(const celix_properties_t *properties, const char *key, unsigned int keyHash);
+
+#endif /* PROPERTIES_PRIVATE_H_ */
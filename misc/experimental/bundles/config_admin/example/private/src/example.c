@@ -62,11 +62,9 @@ celix_status_t example_stop(example_pt component) {
 
 celix_status_t example_updated(example_pt component, properties_pt updatedProperties) {
     printf("updated called\n");
-    hash_map_pt map = (hash_map_pt)updatedProperties;
-    if (map != NULL) {
-        hash_map_iterator_pt iter = hashMapIterator_create(map);
-        while(hashMapIterator_hasNext(iter)) {
-            char *key = hashMapIterator_nextKey(iter);
+    if (updatedProperties != NULL) {
+        const char *key = NULL;
+        CELIX_PROPERTIES_FOR_EACH(updatedProperties, key) {
             const char *value = properties_get(updatedProperties, key);
             printf("got property %s:%s\n", key, value);
         }
@@ -246,20 +246,17 @@ celix_status_t configurationStore_getConfigurationFile(char *pid, char* storePat
 
 celix_status_t configurationStore_writeConfigurationFile(int file, properties_pt properties) {
 
-    if (properties == NULL || hashMap_size(properties) <= 0) {
+    if (properties == NULL || celix_properties_size(properties) <= 0) {
         return CELIX_SUCCESS;
     }
     // size >0
 
     char buffer[256];
 
-    hash_map_iterator_pt iterator = hashMapIterator_create(properties);
-    while (hashMapIterator_hasNext(iterator)) {
+    const char *key = NULL;
+    CELIX_PROPERTIES_FOR_EACH(properties, key) {
 
-        hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
-
-        char* key = hashMapEntry_getKey(entry);
-        char* val = hashMapEntry_getValue(entry);
+        const char* val = celix_properties_get(properties, key, "");
 
         snprintf(buffer, 256, "%s=%s\n", key, val);
 
@@ -270,7 +267,6 @@ celix_status_t configurationStore_writeConfigurationFile(int file, properties_pt
             return CELIX_FILE_IO_EXCEPTION;
         }
     }
-    hashMapIterator_destroy(iterator);
     return CELIX_SUCCESS;
 
 }
@@ -408,7 +404,7 @@ celix_status_t configurationStore_parseDataConfigurationFile(char *data, propert
         token = strtok_r(NULL, "=\n", &saveptr);
     }
 
-    if (hashMap_isEmpty(properties)) {
+    if (celix_properties_size(properties) == 0) {
         return CELIX_ILLEGAL_ARGUMENT;
     }
 
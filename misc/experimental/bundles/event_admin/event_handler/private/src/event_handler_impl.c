@@ -62,13 +62,9 @@ celix_status_t eventHandlerHandleEvent(event_handler_pt *event_handler, event_pt
 		array_list_pt propertyNames;
 		arrayList_create(&propertyNames);
         properties_pt properties = event->properties;
-        if (hashMap_size(properties) > 0) {
-            hash_map_iterator_pt iterator = hashMapIterator_create(properties);
-            while (hashMapIterator_hasNext(iterator)) {
-                hash_map_entry_pt entry = hashMapIterator_nextEntry(iterator);
-                char *key = hashMapEntry_getKey(entry);
-                arrayList_add(propertyNames, key);
-            }
+        const char *propertyKey = NULL;
+        CELIX_PROPERTIES_FOR_EACH(properties, propertyKey) {
+            arrayList_add(propertyNames, (char*)propertyKey);
         }
 		array_list_iterator_pt propertyIter = arrayListIterator_create(propertyNames);
 		while (arrayListIterator_hasNext(propertyIter)) {